@@ -311,6 +311,47 @@ xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
 
        */
 
+     PyAPI_FUNC(PyObject *) _PyObject_FastCall(PyObject *callable_object,
+                                               PyObject **args,
+                                               Py_ssize_t nargs,
+                                               PyObject *kwnames);
+
+       /*
+     Call callable_object with nargs positional arguments in args[0]
+     to args[nargs-1], followed by the values of the keyword arguments
+     whose names are in the tuple kwnames (NULL if there are none).
+     Types with a tp_fastcall slot are called without building an
+     argument tuple.  args may be NULL if there are no arguments.
+
+       */
+
+     PyAPI_FUNC(PyObject *) _PyStack_AsTuple(PyObject **stack,
+                                             Py_ssize_t nargs);
+
+     PyAPI_FUNC(PyObject *) _PyStack_AsDict(PyObject **values,
+                                            PyObject *kwnames);
+
+       /*
+     Helpers for tp_fastcall implementations that need the classic
+     calling convention: a new tuple of stack[0..nargs-1], and a new
+     dict mapping kwnames to values.
+
+       */
+
+     PyAPI_FUNC(PyObject **) _PyStack_UnpackDict(PyObject **args,
+                                                 Py_ssize_t nargs,
+                                                 PyObject *kwargs,
+                                                 PyObject **p_kwnames);
+
+       /*
+     The reverse, for calling a METH_FASTCALL function from a tuple and
+     a dict: return a PyMem_Malloc()ed array of the nargs positional
+     arguments followed by the values of kwargs, and store a new tuple
+     of the keys of kwargs (or NULL if kwargs is NULL or empty) in
+     *p_kwnames.  The items of the array are borrowed.
+
+       */
+
      PyAPI_FUNC(PyObject *) PyObject_CallObject(PyObject *callable_object,
                                                PyObject *args);
 
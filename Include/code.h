@@ -6,6 +6,31 @@
 extern "C" {
 #endif
 
+/* Per-instruction inline caches (see Python/ceval.c).  Every entry holds
+   borrowed references only; it is trusted only while the version tags it
+   recorded still match. */
+typedef struct {
+    PyObject *ptr;              /* value found (borrowed) */
+    PY_UINT64_T globals_ver;    /* ma_version_tag of globals */
+    PY_UINT64_T builtins_ver;   /* ma_version_tag of builtins */
+} _PyOpcache_LoadGlobal;
+
+typedef struct {
+    PyTypeObject *type;         /* type of the owner (borrowed) */
+    unsigned int tp_version;    /* tp_version_tag of type */
+    PyObject *descr;            /* _PyType_Lookup() result (borrowed) */
+    Py_ssize_t hint;            /* slot of the name in the instance dict */
+} _PyOpcache_LoadAttr;
+
+typedef struct _PyOpcache {
+    union {
+        _PyOpcache_LoadGlobal lg;
+        _PyOpcache_LoadAttr la;
+    } u;
+    char optimized;             /* 1: entry filled, 0: empty, -1: disabled */
+    unsigned char misses;       /* refills so far, see OPCACHE_MAX_MISSES */
+} _PyOpcache;
+
 /* Bytecode object */
 typedef struct {
     PyObject_HEAD
@@ -27,6 +52,22 @@ typedef struct {
 				   Objects/lnotab_notes.txt for details. */
     void *co_zombieframe;     /* for optimization only (see frameobject.c) */
     PyObject *co_weakreflist;   /* to support weakrefs to code objects */
+
+    /* Inline caches, allocated once the code object gets hot.
+       co_opcache_map is indexed by the offset of an instruction in
+       co_code and holds a 1-based index into co_opcache (0: no cache). */
+    unsigned char *co_opcache_map;
+    _PyOpcache *co_opcache;
+
+    /* Quickened copy of co_code, run instead of it once the code object
+       gets hot, and how often each of its instructions was deoptimized
+       (indexed like co_code). */
+    unsigned char *co_quickened;
+    unsigned char *co_quickened_deopts;
+
+    int co_opcache_flag;        /* warm-up counter */
+    unsigned char co_opcache_size;
+    unsigned char co_frame_made; /* a frame was made for it (frameobject.c) */
 } PyCodeObject;
 
 /* Masks for co_flags above */
@@ -98,6 +139,12 @@ typedef struct _addr_pair {
 PyAPI_FUNC(int) _PyCode_CheckLineNumber(PyCodeObject* co,
                                         int lasti, PyAddrPair *bounds);
 
+/* Allocate the inline caches of a code object (see Python/ceval.c). */
+PyAPI_FUNC(void) _PyCode_InitOpcache(PyCodeObject *);
+
+/* Make the quickened copy of co_code (see Python/ceval.c). */
+PyAPI_FUNC(void) _PyCode_Quicken(PyCodeObject *);
+
 PyAPI_FUNC(PyObject*) PyCode_Optimize(PyObject *code, PyObject* consts,
                                       PyObject *names, PyObject *lineno_obj);
 
@@ -14,31 +14,31 @@ extern "C" {
 */
 
 /*
-There are three kinds of slots in the table:
-
-1. Unused.  me_key == me_value == NULL
-   Does not hold an active (key, value) pair now and never did.  Unused can
-   transition to Active upon key insertion.  This is the only case in which
-   me_key is NULL, and is each slot's initial state.
-
-2. Active.  me_key != NULL and me_key != dummy and me_value != NULL
-   Holds an active (key, value) pair.  Active can transition to Dummy upon
-   key deletion.  This is the only case in which me_value != NULL.
-
-3. Dummy.  me_key == dummy and me_value == NULL
-   Previously held an active (key, value) pair, but that was deleted and an
-   active pair has not yet overwritten the slot.  Dummy can transition to
-   Active upon key insertion.  Dummy slots cannot be made Unused again
-   (cannot have me_key set to NULL), else the probe sequence in case of
-   collision would have no way to know they were once active.
-
-Note: .popitem() abuses the me_hash field of an Unused or Dummy slot to
-hold a search finger.  The me_hash field of Unused or Dummy slots has no
-meaning otherwise.
+The table is in two parts.  The entries hold the (hash, key, value)
+triples, in the order they were inserted; ma_fill of them have been used.
+The index table, of ma_mask + 1 slots, maps the hash of a key to the entry
+holding it.  Each slot of the index table is
+
+1. Unused (DKIX_EMPTY).  It never pointed to an entry.  This is each slot's
+   initial state, and probing for a key stops at an Unused slot.
+
+2. Active (>= 0).  The index of the entry holding a key.
+
+3. Dummy (DKIX_DUMMY).  It pointed to an entry whose key was deleted (that
+   entry now has NULL me_key and me_value).  Dummy slots cannot be made
+   Unused again, else the probe sequence in case of collision would have no
+   way to know they were once active; they are cleared out, and the deleted
+   entries dropped, when the table is resized.
+
+The slots of the index table are as wide as needed to hold an entry index:
+1 byte for tables of up to 128 slots, 2 bytes up to 32768 slots, and so on,
+so the index table costs little compared to the entries, of which there
+are only two thirds as many as slots.
 */
 
 /* PyDict_MINSIZE is the minimum size of a dictionary.  This many slots are
- * allocated directly in the dict object (in the ma_smalltable member).
+ * allocated directly in the dict object (in the ma_smallindices member, with
+ * the entries in ma_smalltable).
  * It must be a power of 2, and at least 4.  8 allows dicts with no more
  * than 5 active entries to live in ma_smalltable (and so avoid an
  * additional malloc); instrumentation suggested this suffices for the
@@ -47,10 +47,22 @@ meaning otherwise.
  */
 #define PyDict_MINSIZE 8
 
+/* The number of entries of a table with n slots: resizing when the index
+ * table is two-thirds full avoids slowing down lookups.
+ */
+#define PyDict_USABLE(n) (((n) << 1) / 3)
+
+/* Values of the slots of the index table that aren't entry indices, and
+ * results of the ma_lookup functions.
+ */
+#define DKIX_EMPTY (-1)
+#define DKIX_DUMMY (-2)
+#define DKIX_ERROR (-3)
+
 typedef struct {
     /* Cached hash code of me_key.  Note that hash codes are C longs.
      * We have to use Py_ssize_t instead because dict_popitem() abuses
-     * me_hash to hold a search finger.
+     * me_hash of deleted entries to hold a search finger.
      */
     Py_ssize_t me_hash;
     PyObject *me_key;
@@ -58,36 +70,88 @@ typedef struct {
 } PyDictEntry;
 
 /*
-To ensure the lookup algorithm terminates, there must be at least one Unused
-slot (NULL key) in the table.
-The value ma_fill is the number of non-NULL keys (sum of Active and Dummy);
-ma_used is the number of non-NULL, non-dummy keys (== the number of non-NULL
-values == the number of Active items).
-To avoid slowing down lookups on a near-full table, we resize the table when
-it's two-thirds full.
+The instance dicts of a class usually all hold the same keys, so they can
+share them.  A split table keeps its keys (and their hashes) in a
+PyDictKeysObject owned jointly with the other instance dicts of the class,
+and only the values in the dict itself: the value of entry i is
+ma_values[i], and me_value of the shared entries is unused.  Keys are only
+ever added to a shared table, never deleted.  A dict only uses the first
+ma_fill entries of the shared table, and its values must stay in the order
+it was given its keys: adding a key whose entry comes before the last one
+the dict uses makes it combined.  When a shared table
+fills up, a larger copy is made and linked from dk_next, and the dicts move
+on to the copy as they add keys.  A split table also becomes an ordinary
+(combined) one as soon as it gets a key that isn't a string, or too many
+keys to share.
 */
+typedef struct _dictkeysobject {
+    Py_ssize_t dk_refcnt;   /* # dicts and types using the table */
+    Py_ssize_t dk_mask;     /* the index table has dk_mask + 1 slots */
+    Py_ssize_t dk_nkeys;    /* # entries used */
+    struct _dictkeysobject *dk_next;  /* larger copy, or NULL */
+    PyDictEntry *dk_table;  /* the entries, stored after the index table */
+    char dk_indices[8];     /* the index table (really dk_mask + 1 slots) */
+} PyDictKeysObject;
+
 typedef struct _dictobject PyDictObject;
 struct _dictobject {
     PyObject_HEAD
-    Py_ssize_t ma_fill;  /* # Active + # Dummy */
+    Py_ssize_t ma_fill;  /* # entries used (Active and deleted) */
     Py_ssize_t ma_used;  /* # Active */
 
-    /* The table contains ma_mask + 1 slots, and that's a power of 2.
+    /* The index table contains ma_mask + 1 slots, and that's a power of 2.
      * We store the mask instead of the size because the mask is more
      * frequently needed.
      */
     Py_ssize_t ma_mask;
 
-    /* ma_table points to ma_smalltable for small tables, else to
-     * additional malloc'ed memory.  ma_table is never NULL!  This rule
+    /* ma_table points to the PyDict_USABLE(ma_mask + 1) entries:
+     * ma_smalltable for small tables, else to additional malloc'ed memory,
+     * just after the index table.  ma_table is never NULL!  This rule
      * saves repeated runtime null-tests in the workhorse getitem and
      * setitem calls.
      */
     PyDictEntry *ma_table;
-    PyDictEntry *(*ma_lookup)(PyDictObject *mp, PyObject *key, long hash);
-    PyDictEntry ma_smalltable[PyDict_MINSIZE];
+
+    /* Return the index of the entry holding key, DKIX_EMPTY if there is
+     * none, or DKIX_ERROR if an exception was raised.  If hashpos isn't
+     * NULL, *hashpos is set to the slot of the index table where the key
+     * was found, or where it should go.
+     */
+    Py_ssize_t (*ma_lookup)(PyDictObject *mp, PyObject *key, long hash,
+                            Py_ssize_t *hashpos);
+
+    /* Dictionary version: globally unique, value changes each time
+     * the dictionary is created or its content is modified.  Resizing
+     * does not change it, since the (key, value) pairs stay the same.
+     * Used by the per-instruction caches in Python/ceval.c to tell that
+     * a previous lookup result is still valid with a single compare.
+     */
+    PY_UINT64_T ma_version_tag;
+
+    /* For a split table, ma_keys is the shared keys table (and ma_table
+     * and ma_indices point into it) and ma_values the array of values;
+     * otherwise ma_values is NULL.  Split tables are allocated without
+     * ma_smallindices and ma_smalltable, so ma_keys stays non-NULL when
+     * they become combined (it then points to a placeholder that is never
+     * looked at); it is NULL for all other dicts.
+     */
+    PyDictKeysObject *ma_keys;
+    PyObject **ma_values;
+
+    /* The index table: ma_smallindices for small tables, else the start
+     * of the memory block holding the index table and the entries.
+     */
+    void *ma_indices;
+    char ma_smallindices[PyDict_MINSIZE];
+    PyDictEntry ma_smalltable[PyDict_USABLE(PyDict_MINSIZE)];
 };
 
+/* The value of entry ix of dict mp */
+#define _PyDict_VALUE(mp, ix) \
+    ((mp)->ma_values != NULL ? \
+     (mp)->ma_values[ix] : (mp)->ma_table[ix].me_value)
+
 PyAPI_DATA(PyTypeObject) PyDict_Type;
 PyAPI_DATA(PyTypeObject) PyDictIterKey_Type;
 PyAPI_DATA(PyTypeObject) PyDictIterValue_Type;
@@ -122,9 +186,16 @@ PyAPI_FUNC(Py_ssize_t) PyDict_Size(PyObject *mp);
 PyAPI_FUNC(PyObject *) PyDict_Copy(PyObject *mp);
 PyAPI_FUNC(int) PyDict_Contains(PyObject *mp, PyObject *key);
 PyAPI_FUNC(int) _PyDict_Contains(PyObject *mp, PyObject *key, long hash);
+PyAPI_FUNC(PyObject *) _PyDict_GetStoredKey(PyObject *mp, PyObject *key,
+                                            long hash);
 PyAPI_FUNC(PyObject *) _PyDict_NewPresized(Py_ssize_t minused);
 PyAPI_FUNC(void) _PyDict_MaybeUntrack(PyObject *mp);
 
+/* Instance dicts sharing their keys with the other instances of a class */
+PyAPI_FUNC(PyDictKeysObject *) _PyDict_NewKeysForClass(void);
+PyAPI_FUNC(void) _PyDictKeys_DecRef(PyDictKeysObject *keys);
+PyAPI_FUNC(PyObject *) _PyObjectDict_New(PyTypeObject *tp);
+
 /* PyDict_Update(mp, other) is equivalent to PyDict_Merge(mp, other, 1). */
 PyAPI_FUNC(int) PyDict_Update(PyObject *mp, PyObject *other);
 
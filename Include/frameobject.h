@@ -37,6 +37,7 @@ typedef struct _frame {
     PyObject *f_exc_type, *f_exc_value, *f_exc_traceback;
 
     PyThreadState *f_tstate;
+    struct _frame_chunk *f_chunk; /* arena chunk holding the frame, or NULL */
     int f_lasti;		/* Last instruction if called */
     /* Call PyFrame_GetLineNumber() instead of reading this field
        directly.  As of 2.3 f_lineno is only valid when tracing is
@@ -80,6 +81,10 @@ PyAPI_FUNC(void) PyFrame_FastToLocals(PyFrameObject *);
 
 PyAPI_FUNC(int) PyFrame_ClearFreeList(void);
 
+/* Give up a thread's frame arena; chunks still holding frames are freed
+   along with their last frame */
+PyAPI_FUNC(void) _PyFrame_DetachArena(PyThreadState *);
+
 /* Return the line of code the frame is currently executing. */
 PyAPI_FUNC(int) PyFrame_GetLineNumber(PyFrameObject *);
 
@@ -50,6 +50,11 @@ PyAPI_FUNC(int) PyFunction_SetDefaults(PyObject *, PyObject *);
 PyAPI_FUNC(PyObject *) PyFunction_GetClosure(PyObject *);
 PyAPI_FUNC(int) PyFunction_SetClosure(PyObject *, PyObject *);
 
+/* Call a function with an argument array (see fastcallfunc); defined in
+   ceval.c */
+PyAPI_FUNC(PyObject *) _PyFunction_FastCall(PyObject *, PyObject **,
+                                            Py_ssize_t, PyObject *);
+
 /* Macros for direct access to these values. Type checks are *not*
    done, so use with care. */
 #define PyFunction_GET_CODE(func) \
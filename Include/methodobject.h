@@ -19,6 +19,8 @@ typedef PyObject *(*PyCFunction)(PyObject *, PyObject *);
 typedef PyObject *(*PyCFunctionWithKeywords)(PyObject *, PyObject *,
 					     PyObject *);
 typedef PyObject *(*PyNoArgsFunction)(PyObject *);
+typedef PyObject *(*_PyCFunctionFast)(PyObject *, PyObject **, Py_ssize_t,
+                                      PyObject *);
 
 PyAPI_FUNC(PyCFunction) PyCFunction_GetFunction(PyObject *);
 PyAPI_FUNC(PyObject *) PyCFunction_GetSelf(PyObject *);
@@ -33,6 +35,8 @@ PyAPI_FUNC(int) PyCFunction_GetFlags(PyObject *);
 #define PyCFunction_GET_FLAGS(func) \
 	(((PyCFunctionObject *)func) -> m_ml -> ml_flags)
 PyAPI_FUNC(PyObject *) PyCFunction_Call(PyObject *, PyObject *, PyObject *);
+PyAPI_FUNC(PyObject *) _PyCFunction_FastCall(PyObject *, PyObject **,
+                                             Py_ssize_t, PyObject *);
 
 struct PyMethodDef {
     const char	*ml_name;	/* The name of the built-in function/method */
@@ -70,6 +74,13 @@ PyAPI_FUNC(PyObject *) PyCFunction_NewEx(PyMethodDef *, PyObject *,
 
 #define METH_COEXIST   0x0040
 
+/* METH_FASTCALL functions are _PyCFunctionFast: they get the arguments
+   as a C array, a count and a tuple of keyword names (see fastcallfunc
+   in object.h), so that calling them doesn't need an argument tuple.
+   Like METH_NOARGS and METH_O, it can't be combined with METH_VARARGS
+   or METH_KEYWORDS. */
+#define METH_FASTCALL  0x0080
+
 typedef struct PyMethodChain {
     PyMethodDef *methods;		/* Methods of this type */
     struct PyMethodChain *link;	/* NULL or base type */
@@ -87,6 +98,11 @@ typedef struct {
 
 PyAPI_FUNC(int) PyCFunction_ClearFreeList(void);
 
+/* Call the C function of ml, as bound to self, with an argument array */
+PyAPI_FUNC(PyObject *) _PyMethodDef_FastCall(PyMethodDef *, PyObject *,
+                                             PyObject **, Py_ssize_t,
+                                             PyObject *);
+
 #ifdef __cplusplus
 }
 #endif
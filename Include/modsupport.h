@@ -17,6 +17,8 @@ extern "C" {
 #define PyArg_ParseTupleAndKeywords	_PyArg_ParseTupleAndKeywords_SizeT
 #define PyArg_VaParse			_PyArg_VaParse_SizeT
 #define PyArg_VaParseTupleAndKeywords	_PyArg_VaParseTupleAndKeywords_SizeT
+#define _PyArg_ParseTupleAndKeywordsFast	_PyArg_ParseTupleAndKeywordsFast_SizeT
+#define _PyArg_ParseStack		_PyArg_ParseStack_SizeT
 #define Py_BuildValue			_Py_BuildValue_SizeT
 #define Py_VaBuildValue			_Py_VaBuildValue_SizeT
 #else
@@ -31,6 +33,34 @@ PyAPI_FUNC(int) PyArg_UnpackTuple(PyObject *, const char *, Py_ssize_t, Py_ssize
 PyAPI_FUNC(PyObject *) Py_BuildValue(const char *, ...);
 PyAPI_FUNC(PyObject *) _Py_BuildValue_SizeT(const char *, ...);
 PyAPI_FUNC(int) _PyArg_NoKeywords(const char *funcname, PyObject *kw);
+PyAPI_FUNC(int) _PyArg_UnpackStack(PyObject **, Py_ssize_t, const char *,
+                                   Py_ssize_t, Py_ssize_t, ...);
+PyAPI_FUNC(int) _PyArg_NoStackKeywords(const char *funcname,
+                                       PyObject *kwnames);
+
+/* A keyword argument parser, declared static by the function using it:
+
+       static const char * const _keywords[] = {"x", "y", NULL};
+       static _PyArg_Parser _parser = {"O|O:func", _keywords, 0};
+
+   The first call analyses the format once, and interns the keywords in
+   kwtuple so that they are then looked up by identity.  The parsers are
+   linked together to be released at finalization. */
+typedef struct _PyArg_Parser {
+    const char *format;
+    const char * const *keywords;
+    const char *fname;
+    const char *custom_msg;
+    int min;                    /* number of required arguments */
+    int max;                    /* number of keywords */
+    PyObject *kwtuple;          /* interned keywords, NULL until used */
+    struct _PyArg_Parser *next;
+} _PyArg_Parser;
+
+PyAPI_FUNC(int) _PyArg_ParseTupleAndKeywordsFast(PyObject *, PyObject *,
+                                                 struct _PyArg_Parser *, ...);
+PyAPI_FUNC(int) _PyArg_ParseStack(PyObject **, Py_ssize_t, PyObject *,
+                                  struct _PyArg_Parser *, ...);
 
 PyAPI_FUNC(int) PyArg_VaParse(PyObject *, const char *, va_list);
 PyAPI_FUNC(int) PyArg_VaParseTupleAndKeywords(PyObject *, PyObject *,
@@ -321,6 +321,11 @@ typedef int (*descrsetfunc) (PyObject *, PyObject *, PyObject *);
 typedef int (*initproc)(PyObject *, PyObject *, PyObject *);
 typedef PyObject *(*newfunc)(struct _typeobject *, PyObject *, PyObject *);
 typedef PyObject *(*allocfunc)(struct _typeobject *, Py_ssize_t);
+/* Call (callable, args, nargs, kwnames): the positional arguments are
+   args[0..nargs-1], followed by the values of the keyword arguments named
+   in the kwnames tuple (NULL if there are none).  args is borrowed. */
+typedef PyObject *(*fastcallfunc)(PyObject *, PyObject **, Py_ssize_t,
+                                  PyObject *);
 
 typedef struct _typeobject {
     PyObject_VAR_HEAD
@@ -476,6 +481,11 @@ typedef struct _typeobject {
     /* Type attribute cache version tag. Added in version 2.6 */
     unsigned int tp_version_tag;
 
+    /* Call an instance with an array of arguments (see fastcallfunc);
+       only looked at with Py_TPFLAGS_HAVE_FASTCALL, and not inherited,
+       since a subclass may override __call__. */
+    fastcallfunc tp_fastcall;
+
 #ifdef COUNT_ALLOCS
     /* these must be last and never explicitly initialized */
     Py_ssize_t tp_allocs;
@@ -501,6 +511,9 @@ typedef struct _heaptypeobject {
                                       see add_operators() in typeobject.c . */
     PyBufferProcs as_buffer;
     PyObject *ht_name, *ht_slots;
+    /* Keys table shared by the __dict__ of the instances, or NULL; see
+       _PyObjectDict_New() in dictobject.c */
+    struct _dictkeysobject *ht_cached_keys;
     /* here are optional user slots, followed by the members. */
 } PyHeapTypeObject;
 
@@ -595,9 +608,33 @@ PyAPI_FUNC(void) Py_ReprLeave(PyObject *);
 PyAPI_FUNC(long) _Py_HashDouble(double);
 PyAPI_FUNC(long) _Py_HashPointer(void*);
 
+/* The hash of str, unicode and buffer objects.  _Py_HashChars() hashes
+   len characters of charsize bytes each (1, 2 or 4), and gives the same
+   result as _Py_HashBytes() when they are all below 256, so that equal
+   str and unicode objects hash the same.  Neither returns -1, and the
+   hash of an empty string is 0. */
+PyAPI_FUNC(long) _Py_HashBytes(const void *src, Py_ssize_t len);
+PyAPI_FUNC(long) _Py_HashChars(const void *src, Py_ssize_t len,
+                               int charsize);
+
+/* The string hash algorithms, picked with configure
+   --with-hash-algorithm:
+   Py_HASH_FNV        the historical loop, one multiplication per
+                      character (the default)
+   Py_HASH_WORD       one multiplication per 8 bytes
+   Py_HASH_SIPHASH24  SipHash-2-4 keyed with a random per-process key,
+                      resistant to collision attacks on dicts */
+#define Py_HASH_FNV 1
+#define Py_HASH_WORD 2
+#define Py_HASH_SIPHASH24 3
+#ifndef Py_HASH_ALGORITHM
+#define Py_HASH_ALGORITHM Py_HASH_FNV
+#endif
+
 typedef struct {
     long prefix;
     long suffix;
+    unsigned char siphash_key[16];
 } _Py_HashSecret_t;
 PyAPI_DATA(_Py_HashSecret_t) _Py_HashSecret;
 
@@ -717,6 +754,9 @@ manually remove this flag though!
 /* Has the new buffer protocol */
 #define Py_TPFLAGS_HAVE_NEWBUFFER (1L<<21)
 
+/* Objects support tp_fastcall */
+#define Py_TPFLAGS_HAVE_FASTCALL (1L<<22)
+
 /* These flags are used to determine if a type is a subclass. */
 /// 用于标记某个类型（对象）是否是（某个）系统内置类型的派生类型
 #define Py_TPFLAGS_INT_SUBCLASS         (1L<<23)
@@ -743,7 +783,8 @@ manually remove this flag though!
                  Py_TPFLAGS_HAVE_INDEX | \
                  0)
 #define Py_TPFLAGS_DEFAULT_CORE (Py_TPFLAGS_DEFAULT_EXTERNAL | \
-                 Py_TPFLAGS_HAVE_VERSION_TAG)
+                 Py_TPFLAGS_HAVE_VERSION_TAG | \
+                 Py_TPFLAGS_HAVE_FASTCALL)
 
 #ifdef Py_BUILD_CORE
 #define Py_TPFLAGS_DEFAULT Py_TPFLAGS_DEFAULT_CORE
@@ -802,7 +843,6 @@ environment the global variable trick is not safe.)
 PyAPI_DATA(Py_ssize_t) _Py_RefTotal;
 PyAPI_FUNC(void) _Py_NegativeRefcount(const char *fname,
                                             int lineno, PyObject *op);
-PyAPI_FUNC(PyObject *) _PyDict_Dummy(void);
 PyAPI_FUNC(PyObject *) _PySet_Dummy(void);
 PyAPI_FUNC(Py_ssize_t) _Py_GetRefTotal(void);
 #define _Py_INC_REFTOTAL        _Py_RefTotal++
@@ -150,6 +150,19 @@ extern "C" {
 #define SET_ADD         146
 #define MAP_ADD         147
 
+#define LOAD_METHOD     160     /* Index in name list */
+#define CALL_METHOD     161     /* #args */
+
+/* Specialized instructions.  The interpreter rewrites hot instructions
+   into these in its quickened copy of co_code (see Python/ceval.c);
+   they never appear in code objects.  Keep in sync with
+   _specialized_opmap in Lib/opcode.py. */
+#define BINARY_ADD_INT          34
+#define BINARY_ADD_FLOAT        35
+#define BINARY_SUBSCR_LIST_INT  36
+#define COMPARE_OP_INT          148
+#define CALL_FUNCTION_PY        149
+
 
 enum cmp_op {PyCmp_LT=Py_LT, PyCmp_LE=Py_LE, PyCmp_EQ=Py_EQ, PyCmp_NE=Py_NE, PyCmp_GT=Py_GT, PyCmp_GE=Py_GE,
 	     PyCmp_IN, PyCmp_NOT_IN, PyCmp_IS, PyCmp_IS_NOT, PyCmp_EXC_MATCH, PyCmp_BAD};
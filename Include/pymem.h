@@ -31,9 +31,22 @@ extern "C" {
    what to do with that stuff, and the Python wrappers have no idea what to do
    with raw blocks obtained directly by the system routines then.
 
-   The GIL must be held when using these APIs.
+   The GIL must be held when using these APIs, except where PYMALLOC_TCACHE
+   is defined (see below).
 */
 
+/* PYMALLOC_TCACHE is defined on platforms where pymalloc keeps per-thread
+   caches of free blocks and guards its shared state with a lock of its own.
+   pymalloc can then be called without holding the GIL, and serves the
+   PyMem_ family as well as the PyObject_ family.  Define PYMALLOC_NO_TCACHE
+   to build without it.
+*/
+#if defined(WITH_PYMALLOC) && defined(WITH_THREAD) && \
+    defined(_POSIX_THREADS) && defined(__GNUC__) && defined(__ELF__) && \
+    !defined(PYMALLOC_NO_TCACHE)
+#define PYMALLOC_TCACHE
+#endif
+
 /*
  * Raw memory interface
  * ====================
@@ -63,7 +76,14 @@ PyAPI_FUNC(void) PyMem_Free(void *);
 #define PyMem_REALLOC		_PyMem_DebugRealloc
 #define PyMem_FREE		_PyMem_DebugFree
 
-#else	/* ! PYMALLOC_DEBUG */
+#elif defined(PYMALLOC_TCACHE)
+/* Serve small requests from pymalloc; it handles the 0 and
+   > PY_SSIZE_T_MAX cases the same way as the definitions below. */
+#define PyMem_MALLOC		PyObject_Malloc
+#define PyMem_REALLOC		PyObject_Realloc
+#define PyMem_FREE		PyObject_Free
+
+#else	/* ! PYMALLOC_DEBUG && ! PYMALLOC_TCACHE */
 
 /* PyMem_MALLOC(0) means malloc(1). Some systems would return NULL
    for malloc(0), which would be treated as an error. Some platforms
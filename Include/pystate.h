@@ -40,6 +40,7 @@ typedef struct _is {
 /* State unique per thread */
 
 struct _frame; /* Avoid including frameobject.h */
+struct _frame_chunk;
 
 /* Py_tracefunc return -1 when raising an exception, or 0 for success. */
 typedef int (*Py_tracefunc)(PyObject *, struct _frame *, int, PyObject *);
@@ -95,6 +96,8 @@ typedef struct _ts {
     PyObject *async_exc; /* Asynchronous exception to raise */
     long thread_id; /* Thread id where this tstate was created */
 
+    struct _frame_chunk *frame_chunk; /* Newest chunk of the frame arena */
+
     /* XXX signal handlers should also be here */
 
 } PyThreadState;
@@ -133,6 +133,7 @@ PyAPI_FUNC(void) _PyRandom_Init(void);
 /* Various internal finalizers */
 PyAPI_FUNC(void) _PyExc_Fini(void);
 PyAPI_FUNC(void) _PyImport_Fini(void);
+PyAPI_FUNC(void) _PyArg_Fini(void);
 PyAPI_FUNC(void) PyMethod_Fini(void);
 PyAPI_FUNC(void) PyFrame_Fini(void);
 PyAPI_FUNC(void) PyCFunction_Fini(void);
@@ -42,15 +42,30 @@ typedef struct {
      *     ob_sval contains space for 'ob_size+1' elements.
      *     ob_sval[ob_size] == 0.
      *     ob_shash is the hash of the string or -1 if not computed yet.
-     *     ob_sstate != 0 iff the string object is in stringobject.c's
-     *       'interned' dictionary; in this case the two references
-     *       from 'interned' to this object are *not counted* in ob_refcnt.
+     *     ob_sstate & SSTATE_INTERNED_MASK != 0 iff the string object is
+     *       in stringobject.c's 'interned' dictionary; in this case the
+     *       two references from 'interned' to this object are *not
+     *       counted* in ob_refcnt.
+     *     if ob_sstate & SSTATE_LAZY, the string is the concatenation of
+     *       pieces that haven't been copied into ob_sval yet, and ob_sval
+     *       holds a PyStringLazyHeader instead (see _PyString_Flatten).
      */
 } PyStringObject;
 
 #define SSTATE_NOT_INTERNED 0
 #define SSTATE_INTERNED_MORTAL 1
 #define SSTATE_INTERNED_IMMORTAL 2
+#define SSTATE_INTERNED_MASK 3
+#define SSTATE_LAZY 4
+
+/* What a lazy string keeps at the start of ob_sval: the first 'count'
+   items of the list 'pieces' are the strings that it is made of.  The
+   list may be shared with other lazy strings, which only ever append to
+   it. */
+typedef struct {
+    PyObject *pieces;
+    Py_ssize_t count;
+} PyStringLazyHeader;
 
 PyAPI_DATA(PyTypeObject) PyBaseString_Type;
 PyAPI_DATA(PyTypeObject) PyString_Type;
@@ -72,6 +87,8 @@ PyAPI_FUNC(void) PyString_Concat(PyObject **, PyObject *);
 PyAPI_FUNC(void) PyString_ConcatAndDel(PyObject **, PyObject *);
 PyAPI_FUNC(int) _PyString_Resize(PyObject **, Py_ssize_t);
 PyAPI_FUNC(int) _PyString_Eq(PyObject *, PyObject*);
+PyAPI_FUNC(PyObject *) _PyString_ConcatLazy(PyObject *, PyObject *);
+PyAPI_FUNC(char *) _PyString_Flatten(PyObject *);
 PyAPI_FUNC(PyObject *) PyString_Format(PyObject *, PyObject *);
 PyAPI_FUNC(PyObject *) _PyString_FormatLong(PyObject*, int, int,
 						  int, char**, int*);
@@ -85,16 +102,30 @@ PyAPI_FUNC(PyObject *) PyString_InternFromString(const char *);
 PyAPI_FUNC(void) _Py_ReleaseInternedStrings(void);
 
 /* Use only if you know it's a string */
-#define PyString_CHECK_INTERNED(op) (((PyStringObject *)(op))->ob_sstate)
-
-/* Macro, trading safety for speed */
-#define PyString_AS_STRING(op) (((PyStringObject *)(op))->ob_sval)
+#define PyString_CHECK_INTERNED(op) \
+    (((PyStringObject *)(op))->ob_sstate & SSTATE_INTERNED_MASK)
+#define PyString_CHECK_LAZY(op) \
+    (((PyStringObject *)(op))->ob_sstate & SSTATE_LAZY)
+
+/* Macro, trading safety for speed.  A lazy string gets its characters
+   copied in on first use, which writes to the object and may free its
+   list of pieces: PyString_AS_STRING() needs the GIL, unlike when it was
+   a plain dereference.  Take the pointer before Py_BEGIN_ALLOW_THREADS. */
+#define PyString_AS_STRING(op) \
+    (PyString_CHECK_LAZY(op) ? _PyString_Flatten((PyObject *)(op)) \
+                             : ((PyStringObject *)(op))->ob_sval)
 #define PyString_GET_SIZE(op)  Py_SIZE(op)
 
 /* _PyString_Join(sep, x) is like sep.join(x).  sep must be PyStringObject*,
    x must be an iterable object. */
 PyAPI_FUNC(PyObject *) _PyString_Join(PyObject *sep, PyObject *x);
 
+/* fastsearch() on s[0:n] and the pattern p[0:m], as used by find
+   (mode 1), rfind (2) and count (0); s[n] must be readable */
+PyAPI_FUNC(Py_ssize_t) _PyString_FastSearch(const char *s, Py_ssize_t n,
+                                            const char *p, Py_ssize_t m,
+                                            Py_ssize_t maxcount, int mode);
+
 /* --- Generic Codecs ----------------------------------------------------- */
 
 /* Create an object by decoding the encoded string s of the
@@ -212,7 +212,10 @@ typedef PY_UNICODE_TYPE Py_UNICODE;
 # define PyUnicode_Translate PyUnicodeUCS2_Translate
 # define PyUnicode_TranslateCharmap PyUnicodeUCS2_TranslateCharmap
 # define _PyUnicode_AsDefaultEncodedString _PyUnicodeUCS2_AsDefaultEncodedString
+# define _PyUnicode_AsWide _PyUnicodeUCS2_AsWide
+# define _PyUnicode_ConcatLazy _PyUnicodeUCS2_ConcatLazy
 # define _PyUnicode_Fini _PyUnicodeUCS2_Fini
+# define _PyUnicode_Flatten _PyUnicodeUCS2_Flatten
 # define _PyUnicode_Init _PyUnicodeUCS2_Init
 # define _PyUnicode_IsAlpha _PyUnicodeUCS2_IsAlpha
 # define _PyUnicode_IsDecimalDigit _PyUnicodeUCS2_IsDecimalDigit
@@ -299,7 +302,10 @@ typedef PY_UNICODE_TYPE Py_UNICODE;
 # define PyUnicode_Translate PyUnicodeUCS4_Translate
 # define PyUnicode_TranslateCharmap PyUnicodeUCS4_TranslateCharmap
 # define _PyUnicode_AsDefaultEncodedString _PyUnicodeUCS4_AsDefaultEncodedString
+# define _PyUnicode_AsWide _PyUnicodeUCS4_AsWide
+# define _PyUnicode_ConcatLazy _PyUnicodeUCS4_ConcatLazy
 # define _PyUnicode_Fini _PyUnicodeUCS4_Fini
+# define _PyUnicode_Flatten _PyUnicodeUCS4_Flatten
 # define _PyUnicode_Init _PyUnicodeUCS4_Init
 # define _PyUnicode_IsAlpha _PyUnicodeUCS4_IsAlpha
 # define _PyUnicode_IsDecimalDigit _PyUnicodeUCS4_IsDecimalDigit
@@ -402,9 +408,9 @@ typedef PY_UNICODE_TYPE Py_UNICODE;
    valid, and the substring must not be empty */
 
 #define Py_UNICODE_MATCH(string, offset, substring) \
-    ((*((string)->str + (offset)) == *((substring)->str)) && \
-    ((*((string)->str + (offset) + (substring)->length-1) == *((substring)->str + (substring)->length-1))) && \
-     !memcmp((string)->str + (offset), (substring)->str, (substring)->length*sizeof(Py_UNICODE)))
+    ((*(PyUnicode_AS_UNICODE(string) + (offset)) == *(PyUnicode_AS_UNICODE(substring))) && \
+    ((*(PyUnicode_AS_UNICODE(string) + (offset) + (substring)->length-1) == *(PyUnicode_AS_UNICODE(substring) + (substring)->length-1))) && \
+     !memcmp(PyUnicode_AS_UNICODE(string) + (offset), PyUnicode_AS_UNICODE(substring), (substring)->length*sizeof(Py_UNICODE)))
 
 #ifdef __cplusplus
 extern "C" {
@@ -415,11 +421,15 @@ extern "C" {
 typedef struct {
     PyObject_HEAD
     Py_ssize_t length;          /* Length of raw Unicode data in buffer */
-    Py_UNICODE *str;            /* Raw Unicode buffer */
+    Py_UNICODE *str;            /* Raw Unicode buffer; for a compact
+                                   object, a copy made on first use */
     long hash;                  /* Hash value; -1 if not set */
     PyObject *defenc;           /* (Default) Encoded version as Python
                                    string, or NULL; this is used for
-                                   implementing the buffer protocol */
+                                   implementing the buffer protocol.
+                                   A list while the object is lazy. */
+    int kind;                   /* Bytes per character of a compact
+                                   object, 0 for the others */
 } PyUnicodeObject;
 
 PyAPI_DATA(PyTypeObject) PyUnicode_Type;
@@ -434,9 +444,30 @@ PyAPI_DATA(PyTypeObject) PyUnicode_Type;
 #define PyUnicode_GET_DATA_SIZE(op) \
     (((PyUnicodeObject *)(op))->length * sizeof(Py_UNICODE))
 #define PyUnicode_AS_UNICODE(op) \
-    (((PyUnicodeObject *)(op))->str)
+    (((PyUnicodeObject *)(op))->str == NULL || PyUnicode_CHECK_LAZY(op) ? \
+     _PyUnicode_AsWide((PyObject *)(op)) : ((PyUnicodeObject *)(op))->str)
 #define PyUnicode_AS_DATA(op) \
-    ((const char *)((PyUnicodeObject *)(op))->str)
+    ((const char *)PyUnicode_AS_UNICODE(op))
+
+/* A lazy unicode object is the concatenation of the strings in the list
+   kept in defenc, up to a count stored at the start of str.  They are
+   copied into str, which is allocated at the full size already, the
+   first time PyUnicode_AS_UNICODE() is used on it. */
+#define PyUnicode_CHECK_LAZY(op) \
+    (((PyUnicodeObject *)(op))->defenc != NULL && \
+     PyList_CheckExact(((PyUnicodeObject *)(op))->defenc))
+
+/* A compact unicode object keeps its characters right after the object,
+   one byte each when they are all below 256, or, in a UCS4 build, two
+   bytes each when they are all below 0x10000.  The decoders make them
+   for the text they return.  Their str is only allocated, and filled
+   with a copy of the characters, when PyUnicode_AS_UNICODE() is first
+   used on them, which may fail for lack of memory and return NULL:
+   callers that may be handed a decoded string must check for it, and
+   must take the pointer before releasing the GIL.  That copy must not
+   be modified. */
+#define _PyUnicode_KIND(op) (((PyUnicodeObject *)(op))->kind)
+#define _PyUnicode_COMPACT_DATA(op) ((void *)((PyUnicodeObject *)(op) + 1))
 
 /* --- Constants ---------------------------------------------------------- */
 
@@ -656,6 +687,17 @@ PyAPI_FUNC(int) PyUnicode_ClearFreeList(void);
 PyAPI_FUNC(PyObject *) _PyUnicode_AsDefaultEncodedString(
     PyObject *, const char *);
 
+/* Deferred concatenation of two exact unicode objects, used by the
+   interpreter for u += v; see PyUnicode_CHECK_LAZY() */
+
+PyAPI_FUNC(PyObject *) _PyUnicode_ConcatLazy(PyObject *, PyObject *);
+PyAPI_FUNC(Py_UNICODE *) _PyUnicode_Flatten(PyObject *);
+
+/* The slow path of PyUnicode_AS_UNICODE(), for lazy and compact
+   objects */
+
+PyAPI_FUNC(Py_UNICODE *) _PyUnicode_AsWide(PyObject *);
+
 /* Returns the currently active default encoding.
 
    The default encoding is currently implemented as run-time settable
@@ -189,4 +189,19 @@ EXTENDED_ARG = 145
 def_op('SET_ADD', 146)
 def_op('MAP_ADD', 147)
 
+name_op('LOAD_METHOD', 160)     # Index in name list
+def_op('CALL_METHOD', 161)      # #args
+
 del def_op, name_op, jrel_op, jabs_op
+
+# Specialized forms of the instructions above.  The interpreter rewrites
+# hot instructions into these in its private copy of the bytecode, so
+# they never show up in co_code.  Listed here for the jump table
+# generator (Python/makeopcodetargets.py).
+_specialized_opmap = {
+    'BINARY_ADD_INT': 34,
+    'BINARY_ADD_FLOAT': 35,
+    'BINARY_SUBSCR_LIST_INT': 36,
+    'COMPARE_OP_INT': 148,
+    'CALL_FUNCTION_PY': 149,
+}
@@ -139,17 +139,65 @@ def tabulate(r):
         doit(L) # !sort
         print
 
+def doit_wallclock(L, parallel):
+    # time.clock() is processor time on Unix, which adds up the threads
+    t0 = time.time()
+    L.sort(parallel=parallel)
+    t1 = time.time()
+    print "%6.2f" % (t1-t0),
+    flush()
+
+def tabulate_parallel(r):
+    """Tabulate sort speed with and without parallel=True.
+
+    The sizes are 2**i for i in r (the argument, a list).
+
+    The output displays i, 2**i, and the time to sort arrays of 2**i
+    random elements of each of these types:
+
+    int:   ints
+    float: floats
+    str:   strings
+
+    as *sort, without parallel=True, and as ||sort, with it.  These times
+    are wall-clock times.
+
+    """
+    kinds = ("int", "float", "str")
+    cases = []
+    for kind in kinds:
+        cases.extend([kind + " *sort", kind + " ||sort"])
+    fmt = ("%2s %7s" + " %6s"*len(cases))
+    print "%2s %7s" % ("i", "2**i"), " ".join("%13s" % k for k in kinds)
+    print fmt % (("", "") + tuple(c.split()[1] for c in cases))
+    for i in r:
+        n = 1 << i
+        floats = randfloats(n)
+        print "%2d %7d" % (i, n),
+        flush()
+        for L in (map(lambda x: int(x * n), floats), floats,
+                  map(str, floats)):
+            doit_wallclock(L[:], False)
+            doit_wallclock(L[:], True)
+        print
+
 def main():
     """Main program when invoked as a script.
 
     One argument: tabulate a single row.
     Two arguments: tabulate a range (inclusive).
     Extra arguments are used to seed the random generator.
+    With -p as the first argument, compare sorts with and without
+    parallel=True instead.
 
     """
     # default range (inclusive)
     k1 = 15
     k2 = 20
+    table = tabulate
+    if sys.argv[1:2] == ["-p"]:
+        table = tabulate_parallel
+        del sys.argv[1]
     if sys.argv[1:]:
         # one argument: single point
         k1 = k2 = int(sys.argv[1])
@@ -163,7 +211,7 @@ def main():
                     x = 69069 * x + hash(a)
                 random.seed(x)
     r = range(k1, k2+1)                 # include the end point
-    tabulate(r)
+    table(r)
 
 if __name__ == '__main__':
     main()
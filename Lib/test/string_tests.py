@@ -2,7 +2,7 @@
 Common tests shared by test_str, test_unicode, test_userstring and test_string.
 """
 
-import unittest, string, sys, struct
+import unittest, string, sys, struct, pickle, marshal
 from test import test_support
 from UserList import UserList
 
@@ -302,6 +302,29 @@ class CommonTest(unittest.TestCase):
         self.checkraises(TypeError, 'hello', 'rindex')
         self.checkraises(TypeError, 'hello', 'rindex', 42)
 
+    def test_find_long(self):
+        # long strings are searched many characters at a time; put the
+        # pattern at every position around the edges of those steps
+        for n in (15, 16, 17, 32, 33, 64, 65, 128, 129):
+            self.checkequal(0, 'x' * n, 'find', 'x')
+            self.checkequal(n - 1, 'x' * n, 'rfind', 'x')
+            self.checkequal(n, 'x' * n, 'count', 'x')
+            self.checkequal(n // 2, 'x' * n, 'count', 'xx')
+            for sub in ('x', 'xy', 'xyz', 'x' + 'y' * 30 + 'z'):
+                for i in xrange(n - len(sub) + 1):
+                    s = '.' * i + sub + '.' * (n - len(sub) - i)
+                    parts = [s[:i], s[i + len(sub):]]
+                    self.checkequal(i, s, 'find', sub)
+                    self.checkequal(i, s, 'rfind', sub)
+                    self.checkequal(1, s, 'count', sub)
+                    self.checkequal(parts, s, 'split', sub)
+                    self.checkequal(parts, s, 'rsplit', sub)
+                    if len(sub) > 1:
+                        s = s[:i] + sub[:-1] + s[i + len(sub):] + '.'
+                        self.checkequal(-1, s, 'find', sub)
+                        self.checkequal(-1, s, 'rfind', sub)
+                        self.checkequal(0, s, 'count', sub)
+
     def test_lower(self):
         self.checkequal('hello', 'HeLLo', 'lower')
         self.checkequal('hello', 'hello', 'lower')
@@ -874,6 +897,12 @@ class MixinStrUnicodeUserStringTest:
         self.checkequal(['abc', 'def', 'ghi', ''], "abc\ndef\r\nghi\n\r", 'splitlines')
         self.checkequal(['', 'abc', 'def', 'ghi', ''], "\nabc\ndef\r\nghi\n\r", 'splitlines')
         self.checkequal(['\n', 'abc\n', 'def\r\n', 'ghi\n', '\r'], "\nabc\ndef\r\nghi\n\r", 'splitlines', 1)
+        for n in (15, 16, 17, 32, 33, 64, 65):
+            line = 'x' * n
+            for eol in ('\n', '\r', '\r\n'):
+                s = eol.join([line] * 3)
+                self.checkequal([line] * 3, s, 'splitlines')
+                self.checkequal([line + eol] * 2 + [line], s, 'splitlines', 1)
 
         self.checkraises(TypeError, 'abc', 'splitlines', 42, 42)
 
@@ -1331,3 +1360,51 @@ class MixinStrUnicodeTest:
 
         else:
             self.fail("unexpected type for MixinStrUnicodeTest %r" % t)
+
+    def test_concat_lazy(self):
+        # A long string built with += while something else refers to it
+        # keeps its pieces until its characters are first needed
+        t = self.type2test
+        piece = t('ab\tc' * 100) if t is str else t(u'ab\t\u20ac' * 100)
+        def build(n):
+            s = t()
+            prefixes = []
+            for i in range(n):
+                prefixes.append(s)
+                s += piece
+            return s, prefixes
+        expected = piece * 20
+        checks = [
+            len, hash, repr, str if t is str else unicode, buffer,
+            lambda s: s[5:900], lambda s: s[7], lambda s: s[::-3],
+            lambda s: s.upper(), lambda s: s.split(piece[0]),
+            lambda s: s.replace(piece[:2], piece[3]),
+            lambda s: s.find(piece[1:4], 1000), lambda s: s + piece,
+            lambda s: s * 2, lambda s: (s + s).count(s),
+            lambda s: s.encode('utf-8'), lambda s: s.expandtabs(),
+            lambda s: s.__getnewargs__(), lambda s: {s: 1}.get(expected),
+            lambda s: {expected: 1}.get(s), lambda s: s == expected,
+            lambda s: s < expected, lambda s: s.startswith(piece),
+            lambda s: pickle.loads(pickle.dumps(s)),
+            lambda s: marshal.loads(marshal.dumps(s)),
+            lambda s: t('%s') % s,
+        ]
+        for check in checks:
+            s, prefixes = build(20)
+            self.assertEqual(check(s), check(expected))
+        for i, s in enumerate(prefixes):
+            self.assertEqual(s, piece * i)
+
+        # the results of += on the same string share their pieces
+        s, prefixes = build(10)
+        a = b = c = s
+        a += piece[:3]
+        b += piece[5:]
+        c += a
+        self.assertEqual(a, piece * 10 + piece[:3])
+        self.assertEqual(b, piece * 10 + piece[5:])
+        self.assertEqual(c, piece * 10 + a)
+        self.assertEqual(s, piece * 10)
+        if t is str:
+            s, prefixes = build(10)
+            self.assertEqual(intern(s), piece * 10)
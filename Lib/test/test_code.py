@@ -110,6 +110,36 @@ class CodeTest(unittest.TestCase):
         self.assertEqual(co.co_name, "funcname")
         self.assertEqual(co.co_firstlineno, 15)
 
+    def test_specialized_opcodes_in_co_code(self):
+        # The interpreter only writes specialized instructions into its
+        # quickened copy of co_code; met in co_code itself, their guards
+        # fall back to the generic instruction
+        import opcode, types
+        def make(op, arg=None):
+            code = chr(opcode.opmap['LOAD_FAST']) + '\x00\x00'
+            code += chr(opcode.opmap['LOAD_FAST']) + '\x01\x00'
+            code += chr(opcode._specialized_opmap[op])
+            if arg is not None:
+                code += chr(arg) + '\x00'
+            code += chr(opcode.opmap['RETURN_VALUE'])
+            co = types.CodeType(2, 2, 2, 3, code, (None,), (), ('a', 'b'),
+                                'test', 'f', 1, '')
+            return types.FunctionType(co, {}), code
+        cases = [('BINARY_ADD_INT', None, 'a', 'b', 'ab'),
+                 ('BINARY_ADD_INT', None, 1, 2, 3),
+                 ('BINARY_ADD_FLOAT', None, [1], [2], [1, 2]),
+                 ('BINARY_ADD_FLOAT', None, 1.5, 2.0, 3.5),
+                 ('BINARY_SUBSCR_LIST_INT', None, 'abc', 1, 'b'),
+                 ('BINARY_SUBSCR_LIST_INT', None, [7, 8], -1, 8),
+                 ('COMPARE_OP_INT', 2, 'x', 'x', True),
+                 ('COMPARE_OP_INT', 0, 1, 2, True)]
+        for op, arg, a, b, expected in cases:
+            f, code = make(op, arg)
+            # past the warm-up too, when the quickened copy is made
+            for i in range(100):
+                self.assertEqual(f(a, b), expected)
+            self.assertEqual(f.__code__.co_code, code)
+
 
 class CodeWeakRefTest(unittest.TestCase):
 
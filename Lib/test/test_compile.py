@@ -141,6 +141,23 @@ def f(x):
         exec code
         self.assertEqual(f(5), 0)
 
+    def test_method_call_with_255_args(self):
+        # obj.m(...) passes obj as one more argument, which must not
+        # overflow the positional count of the call
+        class C(object):
+            def m(self, *args):
+                return args
+            @staticmethod
+            def s(*args):
+                return args
+        o = C()
+        for n in (253, 254, 255):
+            args = ', '.join(map(str, range(n)))
+            self.assertEqual(eval('o.m(%s)' % args), tuple(range(n)))
+            self.assertEqual(eval('o.s(%s)' % args), tuple(range(n)))
+            self.assertEqual(eval("'{%d}'.format(%s)" % (n - 1, args)),
+                             str(n - 1))
+
     def test_complex_args(self):
 
         with test_support.check_py3k_warnings(
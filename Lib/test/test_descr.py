@@ -1663,6 +1663,51 @@ order (MRO) for bases """
         self.assertEqual(E().foo, C.foo) # i.e., unbound
         self.assertTrue(repr(C.foo.__get__(C(1))).startswith("<bound method "))
 
+    def test_method_call_lookup(self):
+        # obj.name(...) calls skip creating the bound method; the lookup
+        # must still follow the usual attribute rules
+        class C(object):
+            def f(self, *args):
+                return 'method', args
+            s = staticmethod(lambda *args: ('static', args))
+            c = classmethod(lambda cls, *args: ('class', cls, args))
+        c = C()
+        self.assertEqual(c.f(1, 2), ('method', (1, 2)))
+        self.assertEqual(c.s(1), ('static', (1,)))
+        self.assertEqual(c.c(1), ('class', C, (1,)))
+        c.f = lambda *args: ('instance', args)
+        self.assertEqual(c.f(1), ('instance', (1,)))
+        del c.f
+        self.assertEqual(c.f(), ('method', ()))
+        C.f = lambda self: 'replaced'
+        self.assertEqual(c.f(), 'replaced')
+        self.assertRaises(AttributeError, lambda: c.nosuchmethod())
+
+        class D(C):
+            def __getattribute__(self, name):
+                return lambda *args: ('getattribute', name, args)
+        self.assertEqual(D().f(1), ('getattribute', 'f', (1,)))
+        class E(C):
+            __slots__ = ()
+            def __getattr__(self, name):
+                return lambda: name
+        self.assertEqual(E().spam(), 'spam')
+        self.assertEqual(E().f(), 'replaced')
+
+        # Method descriptors of builtin types, also in subclasses
+        class L(list):
+            pass
+        l = L()
+        l.append(3)
+        l.extend([1, 2])
+        l.sort()
+        self.assertEqual(l, [1, 2, 3])
+        self.assertEqual(', '.join(['a', 'b']), 'a, b')
+        self.assertRaises(TypeError, lambda: [].append())
+        # Modules keep their attributes in the instance dict
+        import os
+        self.assertEqual(os.path.join('a', 'b'), 'a' + os.sep + 'b')
+
     def test_special_method_lookup(self):
         # The lookup of special methods bypasses __getattr__ and
         # __getattribute__, but they still can be descriptors.
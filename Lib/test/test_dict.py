@@ -2,7 +2,7 @@ import unittest
 from test import test_support
 
 import UserDict, random, string
-import gc, weakref
+import gc, sys, weakref
 
 
 class DictTest(unittest.TestCase):
@@ -650,6 +650,108 @@ class DictTest(unittest.TestCase):
             pass
         self._tracked(MyDict())
 
+    def test_instance_dicts(self):
+        # The __dict__ of instances of a class share their keys; make
+        # sure each one still behaves as a dict of its own.
+        class C(object):
+            def __init__(self, a, b):
+                self.a = a
+                self.b = b
+        x, y = C(1, 2), C(3, 4)
+        self.assertEqual(x.__dict__, {'a': 1, 'b': 2})
+        self.assertEqual(y.__dict__, {'a': 3, 'b': 4})
+        x.c = 5
+        self.assertFalse(hasattr(y, 'c'))
+        self.assertEqual(C(6, 7).__dict__, {'a': 6, 'b': 7})
+        del x.a
+        self.assertEqual(x.__dict__, {'b': 2, 'c': 5})
+        self.assertEqual(y.a, 3)
+        self.assertRaises(AttributeError, delattr, x, 'a')
+        self.assertRaises(KeyError, x.__dict__.pop, 'a')
+        self.assertEqual(x.__dict__.pop('b'), 2)
+        x.a = 8
+        self.assertEqual(sorted(x.__dict__.items()), [('a', 8), ('c', 5)])
+        self.assertEqual(sorted(x.__dict__.iterkeys()), ['a', 'c'])
+        self.assertEqual(sorted(x.__dict__.itervalues()), [5, 8])
+        self.assertEqual(x.__dict__.copy(), {'a': 8, 'c': 5})
+        self.assertEqual(x.__dict__.popitem()[0] in 'ac', True)
+        y.__dict__.clear()
+        self.assertEqual(y.__dict__, {})
+        y.b = 9
+        self.assertEqual(y.__dict__, {'b': 9})
+
+    def test_instance_dicts_growth(self):
+        # Many attributes, or keys that aren't strings, make the
+        # instance dicts leave the shared table.
+        class C(object):
+            pass
+        objs = [C() for i in range(3)]
+        for i, obj in enumerate(objs):
+            for j in range(50):
+                setattr(obj, 'a%d' % j, i * j)
+        for i, obj in enumerate(objs):
+            self.assertEqual(len(obj.__dict__), 50)
+            for j in range(50):
+                self.assertEqual(getattr(obj, 'a%d' % j), i * j)
+        x, y = C(), C()
+        x.a = y.a = 1
+        x.__dict__[1] = 2
+        x.__dict__[u'b'] = 3
+        self.assertEqual(x.__dict__, {'a': 1, 1: 2, 'b': 3})
+        self.assertEqual(y.__dict__, {'a': 1})
+        y.__dict__.update({'c': 4, 'd': 5})
+        self.assertEqual(y.__dict__, {'a': 1, 'c': 4, 'd': 5})
+
+    @test_support.cpython_only
+    def test_instance_dicts_size(self):
+        class C(object):
+            def __init__(self):
+                self.a = self.b = self.c = 1
+        x = C()
+        self.assertLess(sys.getsizeof(x.__dict__), sys.getsizeof({}))
+
+    def test_insertion_order(self):
+        keys = [str(i) for i in range(100, 0, -1)] + range(100)
+        d = {}
+        for k in keys:
+            d[k] = k
+        self.assertEqual(d.keys(), keys)
+        self.assertEqual(d.values(), keys)
+        self.assertEqual(list(d.iteritems()), zip(keys, keys))
+        # Deleted keys drop out; added ones go to the end, even when
+        # the table gets compacted
+        for k in keys[::2]:
+            del d[k]
+        for k in keys[::4]:
+            d[k] = k
+        expected = keys[1::2] + keys[::4]
+        self.assertEqual(d.keys(), expected)
+        self.assertEqual(dict(d).keys(), expected)
+        self.assertEqual(d.copy().keys(), expected)
+        # Replacing a value doesn't move its key
+        d[keys[1]] = 0
+        self.assertEqual(d.keys(), expected)
+        # popitem() takes the last item
+        self.assertEqual(d.popitem(), (keys[-4], keys[-4]))
+        while d:
+            k, v = d.popitem()
+        self.assertEqual(k, keys[1])
+
+    def test_instance_dicts_order(self):
+        class C(object):
+            pass
+        x = C()
+        x.b = 1
+        x.a = 2
+        y = C()
+        y.a = 3
+        y.b = 4
+        self.assertEqual(x.__dict__.keys(), ['b', 'a'])
+        self.assertEqual(y.__dict__.keys(), ['a', 'b'])
+        del x.b
+        x.b = 5
+        self.assertEqual(x.__dict__.items(), [('a', 2), ('b', 5)])
+
 
 from test import mapping_tests
 
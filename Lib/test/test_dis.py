@@ -22,6 +22,29 @@ dis_f = """\
      _f.func_code.co_firstlineno + 2)
 
 
+def _g(a):
+    a.append(1)
+    a.sort(key=None)
+
+dis_g = """\
+ %-4d         0 LOAD_FAST                0 (a)
+              3 LOAD_METHOD              0 (append)
+              6 LOAD_CONST               1 (1)
+              9 CALL_METHOD              1
+             12 POP_TOP
+
+ %-4d        13 LOAD_FAST                0 (a)
+             16 LOAD_ATTR                1 (sort)
+             19 LOAD_CONST               2 ('key')
+             22 LOAD_CONST               0 (None)
+             25 CALL_FUNCTION          256
+             28 POP_TOP
+             29 LOAD_CONST               0 (None)
+             32 RETURN_VALUE
+"""%(_g.func_code.co_firstlineno + 1,
+     _g.func_code.co_firstlineno + 2)
+
+
 def bug708901():
     for res in range(1,
                      10):
@@ -117,6 +140,10 @@ class DisTests(unittest.TestCase):
     def test_dis(self):
         self.do_disassembly_test(_f, dis_f)
 
+    def test_method_call(self):
+        # Only calls without keyword or star arguments use LOAD_METHOD
+        self.do_disassembly_test(_g, dis_g)
+
     def test_bug_708901(self):
         self.do_disassembly_test(bug708901, dis_bug708901)
 
@@ -310,6 +310,76 @@ class ExtCallTest(unittest.TestCase):
         else:
             self.fail("duplicate arguments didn't raise")
 
+    def test_fastcall_builtins(self):
+        # Builtins taking an argument array reject keywords and check
+        # their argument count like the tuple-based ones did.
+        self.assertEqual(getattr(1, 'real'), 1)
+        self.assertEqual(getattr(1, 'spam', 42), 42)
+        self.assertRaises(TypeError, getattr, 1, 'real', x=1)
+        self.assertRaises(TypeError, getattr, 1)
+        self.assertRaises(TypeError, divmod, 1, 2, 3)
+        self.assertEqual(pow(2, 10, 1000), 24)
+        self.assertEqual(apply(divmod, (7, 2)), (3, 1))
+        d = {1: 2}
+        self.assertEqual(dict.get(d, 1), 2)
+        self.assertEqual(dict.get(d, 3, 4), 4)
+        self.assertRaises(TypeError, dict.get)
+        self.assertRaises(TypeError, dict.get, [], 1)
+        self.assertRaises(TypeError, d.get, 1, default=4)
+        self.assertEqual(d.pop(1), 2)
+        self.assertEqual(d.setdefault(5, 6), 6)
+        for f, args in ((d.get, (1,)), (d.pop, (1,)), (getattr, (1, 'real')),
+                        (next, (iter([1]),)), (divmod, (1, 2)),
+                        (cmp, (1, 2)), (isinstance, (1, int))):
+            with self.assertRaises(TypeError) as cm:
+                f(*args, x=1)
+            self.assertEqual(str(cm.exception),
+                             '%s() takes no keyword arguments' % f.__name__)
+
+    def test_fastcall_methods(self):
+        class A(object):
+            def f(self, *args, **kwargs):
+                return self, args, kwargs
+        class B(object):
+            pass
+        a = A()
+        args = tuple(range(20))
+        # Unbound and bound methods with more arguments than fit in the
+        # small stack buffer used to prepend self
+        self.assertEqual(A.f(a, *args), (a, args, {}))
+        m = a.f
+        self.assertEqual(map(m, [1]), [(a, (1,), {})])
+        self.assertEqual(m(*args), (a, args, {}))
+        self.assertEqual(m(1, x=2), (a, (1,), {'x': 2}))
+        self.assertRaises(TypeError, A.f, B())
+        self.assertRaises(TypeError, A.f)
+
+    def test_fastcall_types(self):
+        # The one-argument shortcuts of type calls must agree with
+        # tp_new/tp_init, and must not be taken for subclasses.
+        self.assertIs(type(1), int)
+        self.assertEqual(int('12'), 12)
+        self.assertEqual(float('1.5'), 1.5)
+        self.assertIs(bool([]), False)
+        self.assertEqual(str(12), '12')
+        self.assertEqual(tuple('ab'), ('a', 'b'))
+        self.assertEqual(list('ab'), ['a', 'b'])
+        self.assertRaises(TypeError, type, 1, 2)
+        self.assertRaises(ValueError, int, 'x')
+        class MyList(list):
+            def __init__(self, arg):
+                list.__init__(self, arg)
+                self.inited = True
+        l = MyList('ab')
+        self.assertEqual(l, ['a', 'b'])
+        self.assertTrue(l.inited)
+        class Meta(type):
+            def __call__(cls, *args):
+                return args
+        class C(object):
+            __metaclass__ = Meta
+        self.assertEqual(C(1, 2), (1, 2))
+
 
 def test_main():
     test_support.run_doctest(sys.modules[__name__], True)
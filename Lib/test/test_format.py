@@ -289,6 +289,46 @@ class FormatTest(unittest.TestCase):
             else:
                 raise TestFailed, '"%*d"%(maxsize, -127) should fail'
 
+    def test_reused_format(self):
+        # the parsed form of a format string is kept between calls
+        for fmt in ['%s:%5d:%-4s|%%', u'%s:%5d:%-4s|%%']:
+            for i in range(3):
+                self.assertEqual(fmt % ('a', -i, 3), '%s:%5d:%-4s|%%' % (
+                                 'a', -i, 3))
+                self.assertEqual(fmt % (i, 12345678, 'x'),
+                                 str(i) + ':12345678:x   |%')
+            self.assertRaises(TypeError, fmt.__mod__, (1, 2))
+            self.assertRaises(TypeError, fmt.__mod__, (1, 'x', 3))
+            self.assertEqual(fmt % ('b', 1, 2), 'b:    1:2   |%')
+        for fmt in ['%(a)s%(b)+05d', u'%(a)s%(b)+05d']:
+            for i in range(3):
+                self.assertEqual(fmt % {'a': i, 'b': i}, '%d+000%d' % (i, i))
+            self.assertRaises(KeyError, fmt.__mod__, {'b': 1})
+            self.assertRaises(TypeError, fmt.__mod__, (1, 2))
+        # errors are raised at the same point every time
+        for i in range(2):
+            self.assertRaises(TypeError, '%s %(a'.__mod__, ())
+            self.assertRaises(ValueError, '%s %(a'.__mod__, {})
+            self.assertRaises(TypeError, '%s %5'.__mod__, ())
+            self.assertRaises(ValueError, '%s %5'.__mod__, (1,))
+            self.assertRaises(ValueError, '%d %k'.__mod__, (1, 2))
+        # the same format with other contents, built in place
+        for empty in ['', u'']:
+            fmt = empty
+            for i in range(20):
+                fmt += '%d'
+                self.assertEqual(fmt % tuple(range(i + 1)),
+                                 ''.join(map(str, range(i + 1))))
+        # a str format continued in unicode
+        fmt = 'ab%d%s%5d'
+        for i in range(2):
+            self.assertEqual(fmt % (1, 'x', 2), 'ab1x    2')
+            self.assertEqual(fmt % (1, u'x', 2), u'ab1x    2')
+        class U(unicode):
+            pass
+        self.assertEqual(U(u'%s-%d') % (u'a', 1), u'a-1')
+
+
 def test_main():
     test_support.run_unittest(FormatTest)
 
@@ -264,6 +264,39 @@ class GCTests(unittest.TestCase):
         gc.collect(2)
         assertEqual(gc.get_count(), (0, 0, 0))
 
+    def test_pause_budget(self):
+        budget = gc.get_pause_budget()
+        try:
+            gc.set_pause_budget(0.005)
+            self.assertEqual(gc.get_pause_budget(), 0.005)
+            gc.set_pause_budget(0)
+            self.assertEqual(gc.get_pause_budget(), 0.0)
+            self.assertRaises(ValueError, gc.set_pause_budget, -1)
+            self.assertRaises(TypeError, gc.set_pause_budget, "1")
+        finally:
+            gc.set_pause_budget(budget)
+
+    def test_get_stats(self):
+        stats = gc.get_stats()
+        self.assertEqual(len(stats), 3)
+        for st in stats:
+            self.assertEqual(sorted(st), ['collected', 'collections',
+                                          'increments', 'passes',
+                                          'pause_last', 'pause_max',
+                                          'pause_total', 'truncated',
+                                          'uncollectable'])
+        gc.collect(0)
+        new = gc.get_stats()
+        self.assertEqual(new[0]['collections'], stats[0]['collections'] + 1)
+        self.assertEqual(new[2]['collections'], stats[2]['collections'])
+        gc.collect()
+        new = gc.get_stats()
+        self.assertEqual(new[2]['collections'], stats[2]['collections'] + 1)
+        for st in new:
+            self.assertGreaterEqual(st['pause_last'], 0.0)
+            self.assertGreaterEqual(st['pause_max'], st['pause_last'])
+            self.assertGreaterEqual(st['pause_total'], st['pause_max'])
+
     def test_trashcan(self):
         class Ouch:
             n = 0
@@ -477,6 +510,38 @@ class GCTogglingTests(unittest.TestCase):
     def tearDown(self):
         gc.disable()
 
+    def test_incremental(self):
+        # With a pause budget, the oldest generation is collected in slices
+        # as part of automatic collection; they must still find its cycles.
+        thresholds = gc.get_threshold()
+        budget = gc.get_pause_budget()
+        gc.set_threshold(100, 1, 1)
+        gc.set_pause_budget(1e-9) # the smallest slices there are
+        try:
+            live = [[] for i in range(5000)]
+            trash = [C1055820(i) for i in range(3000)]
+            wrs = map(weakref.ref, trash)
+            gc.collect() # everything is in the oldest generation now
+            self.assertTrue(any(o is live for o in gc.get_objects()))
+            del trash
+            start = gc.get_stats()[2]
+            junk = []
+            for i in xrange(10000):
+                if gc.get_stats()[2]['passes'] >= start['passes'] + 2:
+                    break
+                junk.append([[] for j in range(10)])
+                if len(junk) > 100:
+                    junk = []
+            stats = gc.get_stats()[2]
+            self.assertGreater(stats['increments'], start['increments'])
+            self.assertGreaterEqual(stats['passes'], start['passes'] + 2)
+            self.assertEqual([wr for wr in wrs if wr() is not None], [])
+            self.assertTrue(all(gc.is_tracked(l) for l in live))
+            self.assertTrue(any(o is live for o in gc.get_objects()))
+        finally:
+            gc.set_threshold(*thresholds)
+            gc.set_pause_budget(budget)
+
     def test_bug1055820c(self):
         # Corresponds to temp2c.py in the bug report.  This is pretty
         # elaborate.
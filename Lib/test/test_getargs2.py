@@ -1,6 +1,7 @@
 import unittest
 from test import test_support
-from _testcapi import getargs_keywords
+from _testcapi import getargs_keywords, getargs_keywords_fast, \
+     getargs_keywords_stack
 import warnings
 
 """
@@ -273,41 +274,43 @@ class Tuple_TestCase(unittest.TestCase):
         self.assertRaises(TypeError, getargs_tuple, 1, seq())
 
 class Keywords_TestCase(unittest.TestCase):
+    getargs_keywords = staticmethod(getargs_keywords)
+
     def test_positional_args(self):
         # using all positional args
         self.assertEqual(
-            getargs_keywords((1,2), 3, (4,(5,6)), (7,8,9), 10),
+            self.getargs_keywords((1,2), 3, (4,(5,6)), (7,8,9), 10),
             (1, 2, 3, 4, 5, 6, 7, 8, 9, 10)
             )
     def test_mixed_args(self):
         # positional and keyword args
         self.assertEqual(
-            getargs_keywords((1,2), 3, (4,(5,6)), arg4=(7,8,9), arg5=10),
+            self.getargs_keywords((1,2), 3, (4,(5,6)), arg4=(7,8,9), arg5=10),
             (1, 2, 3, 4, 5, 6, 7, 8, 9, 10)
             )
     def test_keyword_args(self):
         # all keywords
         self.assertEqual(
-            getargs_keywords(arg1=(1,2), arg2=3, arg3=(4,(5,6)), arg4=(7,8,9), arg5=10),
+            self.getargs_keywords(arg1=(1,2), arg2=3, arg3=(4,(5,6)), arg4=(7,8,9), arg5=10),
             (1, 2, 3, 4, 5, 6, 7, 8, 9, 10)
             )
     def test_optional_args(self):
         # missing optional keyword args, skipping tuples
         self.assertEqual(
-            getargs_keywords(arg1=(1,2), arg2=3, arg5=10),
+            self.getargs_keywords(arg1=(1,2), arg2=3, arg5=10),
             (1, 2, 3, -1, -1, -1, -1, -1, -1, 10)
             )
     def test_required_args(self):
         # required arg missing
         try:
-            getargs_keywords(arg1=(1,2))
+            self.getargs_keywords(arg1=(1,2))
         except TypeError, err:
             self.assertEqual(str(err), "Required argument 'arg2' (pos 2) not found")
         else:
             self.fail('TypeError should have been raised')
     def test_too_many_args(self):
         try:
-            getargs_keywords((1,2),3,(4,(5,6)),(7,8,9),10,111)
+            self.getargs_keywords((1,2),3,(4,(5,6)),(7,8,9),10,111)
         except TypeError, err:
             self.assertEqual(str(err), "function takes at most 5 arguments (6 given)")
         else:
@@ -315,14 +318,43 @@ class Keywords_TestCase(unittest.TestCase):
     def test_invalid_keyword(self):
         # extraneous keyword arg
         try:
-            getargs_keywords((1,2),3,arg5=10,arg666=666)
+            self.getargs_keywords((1,2),3,arg5=10,arg666=666)
         except TypeError, err:
             self.assertEqual(str(err), "'arg666' is an invalid keyword argument for this function")
         else:
             self.fail('TypeError should have been raised')
 
+class KeywordsFast_TestCase(Keywords_TestCase):
+    # the same with a static parser
+    getargs_keywords = staticmethod(getargs_keywords_fast)
+
+    def test_positional_and_keyword(self):
+        try:
+            self.getargs_keywords((1,2), 3, arg2=3)
+        except TypeError, err:
+            self.assertEqual(str(err), "Argument given by name ('arg2') and position (2)")
+        else:
+            self.fail('TypeError should have been raised')
+    def test_unicode_keyword(self):
+        self.assertEqual(
+            self.getargs_keywords((1,2), **{u'arg2': 3, u'arg5': 10}),
+            (1, 2, 3, -1, -1, -1, -1, -1, -1, 10)
+            )
+    def test_repeated_calls(self):
+        # the parser is set up by the first call only
+        for i in range(3):
+            self.assertEqual(
+                self.getargs_keywords(arg2=i, arg1=(1,2)),
+                (1, 2, i, -1, -1, -1, -1, -1, -1, -1)
+                )
+
+class KeywordsStack_TestCase(KeywordsFast_TestCase):
+    # the same for a METH_FASTCALL function
+    getargs_keywords = staticmethod(getargs_keywords_stack)
+
 def test_main():
-    tests = [Signed_TestCase, Unsigned_TestCase, Tuple_TestCase, Keywords_TestCase]
+    tests = [Signed_TestCase, Unsigned_TestCase, Tuple_TestCase,
+             Keywords_TestCase, KeywordsFast_TestCase, KeywordsStack_TestCase]
     try:
         from _testcapi import getargs_L, getargs_K
     except ImportError:
@@ -7,6 +7,7 @@ import os
 import sys
 import struct
 import datetime
+import sysconfig
 import unittest
 import subprocess
 
@@ -15,6 +16,10 @@ from collections import Hashable
 
 IS_64BIT = (struct.calcsize('l') == 8)
 
+# the string hash picked with configure --with-hash-algorithm
+FNV, WORD, SIPHASH24 = 1, 2, 3
+HASH_ALGORITHM = sysconfig.get_config_var('Py_HASH_ALGORITHM') or FNV
+
 
 class HashEqualityTestCase(unittest.TestCase):
 
@@ -49,6 +54,21 @@ class HashEqualityTestCase(unittest.TestCase):
         self.same_hash(long(1.23e300), float(1.23e300))
         self.same_hash(float(0.5), complex(0.5, 0.0))
 
+    def test_string_types(self):
+        # the algorithms hashing several characters at a time have to
+        # give the same result for every length of the last partial word
+        for n in range(41):
+            s = ''.join([chr(32 + (i * 7) % 95) for i in range(n)])
+            self.same_hash(s, unicode(s), buffer(s))
+            s = ''.join([chr(160 + i % 96) for i in range(n)])
+            self.same_hash(s, unicode(s, 'latin-1'), buffer(s))
+
+    def test_wide_characters(self):
+        # characters above 255 are not truncated to their low byte
+        for n in range(1, 20):
+            self.assertNotEqual(hash(u'\u0141' * n), hash(u'\u0241' * n))
+            self.assertNotEqual(hash(u'\u0141' * n), hash('A' * n))
+
 
 _default_hash = object.__hash__
 class DefaultHash(object): pass
@@ -173,13 +193,24 @@ class HashRandomizationTests(unittest.TestCase):
 class StringlikeHashRandomizationTests(HashRandomizationTests):
     def test_null_hash(self):
         # PYTHONHASHSEED=0 disables the randomized hash
-        if IS_64BIT:
+        if HASH_ALGORITHM == SIPHASH24:
+            if IS_64BIT:
+                known_hash_of_obj = 4596069200710135518
+            else:
+                known_hash_of_obj = 1198583518
+        elif HASH_ALGORITHM == WORD:
+            if IS_64BIT:
+                known_hash_of_obj = -1697871019865778988
+            else:
+                known_hash_of_obj = -1703389996
+        elif IS_64BIT:
             known_hash_of_obj = 1453079729188098211
         else:
             known_hash_of_obj = -1600925533
 
-        # Randomization is disabled by default:
-        self.assertEqual(self.get_hash(self.repr_), known_hash_of_obj)
+        # Randomization is disabled by default, except with SipHash:
+        if HASH_ALGORITHM != SIPHASH24:
+            self.assertEqual(self.get_hash(self.repr_), known_hash_of_obj)
 
         # It can also be disabled by setting the seed to 0:
         self.assertEqual(self.get_hash(self.repr_, seed=0), known_hash_of_obj)
@@ -187,7 +218,15 @@ class StringlikeHashRandomizationTests(HashRandomizationTests):
     def test_fixed_hash(self):
         # test a fixed seed for the randomized hash
         # Note that all types share the same values:
-        if IS_64BIT:
+        if HASH_ALGORITHM == SIPHASH24:
+            # the key is read as bytes, whatever the byte order
+            if IS_64BIT:
+                h = -4101847242062932714
+            else:
+                h = 180561618
+        elif HASH_ALGORITHM == WORD:
+            self.skipTest("no known values for the word hash")
+        elif IS_64BIT:
             if sys.byteorder == 'little':
                 h = -4410911502303878509
             else:
@@ -19,6 +19,11 @@ SHIFT = sys.long_info.bits_per_digit
 BASE = 2 ** SHIFT
 MASK = BASE - 1
 KARATSUBA_CUTOFF = 70   # from longobject.c
+TOOM3_CUTOFF = 5000     # ditto
+NTT_CUTOFF = 2000       # ditto
+BZ_DIV_CUTOFF = 2 * KARATSUBA_CUTOFF    # ditto
+DC_TO_DECIMAL_CUTOFF = 1000             # ditto
+DC_FROM_STRING_CUTOFF = 6000            # ditto
 
 # Max number of base BASE digits to use in test cases.  Doubling
 # this will more than double the runtime.
@@ -170,7 +175,28 @@ class LongTest(unittest.TestCase):
         self.check_division(710031681576388032L, 26769404391308L)
         self.check_division(1933622614268221L, 30212853348836L)
 
-
+    def test_burnikel_ziegler(self):
+        # both the divisor and the quotient need more than BZ_DIV_CUTOFF
+        # digits for the recursive division to kick in
+        digits = [BZ_DIV_CUTOFF + 1, 2 * BZ_DIV_CUTOFF + 1,
+                  5 * BZ_DIV_CUTOFF, 9 * BZ_DIV_CUTOFF + 3]
+        for leny in digits:
+            for lenq in digits:
+                y = self.getran(leny) or 1L
+                x = self.getran(leny + lenq)
+                self.check_division(x, y)
+                # remainders of 0 and of y - 1
+                self.check_division(y * x, y)
+                self.check_division(y * x - 1, y)
+        # quotient digits of all ones, and divisors with a single top bit,
+        # exercise the corrections of the quotient estimates
+        for n in digits:
+            y = (1L << (n * SHIFT)) - 1
+            self.check_division((y << (2 * n * SHIFT)) - 1, y)
+            self.check_division(y * y, y)
+            y = 1L << (n * SHIFT - 1)
+            self.check_division((1L << (3 * n * SHIFT)) - 1, y)
+            self.check_division((1L << (3 * n * SHIFT)) - 1, y + 1)
 
     def test_karatsuba(self):
         digits = range(1, 5) + range(KARATSUBA_CUTOFF, KARATSUBA_CUTOFF + 10)
@@ -194,6 +220,40 @@ class LongTest(unittest.TestCase):
                 self.assertEqual(x, y,
                     Frm("bad result for a*b: a=%r, b=%r, x=%r, y=%r", a, b, x, y))
 
+    def test_toom3_and_ntt(self):
+        digits = [NTT_CUTOFF + 1, 3 * NTT_CUTOFF + 7, TOOM3_CUTOFF + 1]
+        bits = [digit * SHIFT for digit in digits]
+
+        # Products of long strings of 1 bits, which make the biggest
+        # coefficients for the NTT; see test_karatsuba.
+        for abits in bits:
+            a = (1L << abits) - 1
+            for bbits in bits + [abits * 5]:
+                b = (1L << bbits) - 1
+                x = a * b
+                y = ((1L << (abits + bbits)) -
+                     (1L << abits) -
+                     (1L << bbits) +
+                     1)
+                self.assertEqual(x, y,
+                    Frm("bad result for a*b: a=%r, b=%r, x=%r, y=%r", a, b, x, y))
+
+        # Random products and squares, compared with sums of products of
+        # a with slices of b small enough for schoolbook multiplication.
+        step = KARATSUBA_CUTOFF * SHIFT
+        for digit in digits:
+            a = self.getran(digit)
+            for b in self.getran(digit - 2), self.getran(3 * digit), a:
+                expected = 0L
+                rest = abs(b)
+                for shift in xrange(0, abs(b).bit_length(), step):
+                    piece = rest & ((1L << step) - 1)
+                    rest >>= step
+                    expected += (a * piece) << shift
+                if b < 0:
+                    expected = -expected
+                self.assertEqual(a * b, expected)
+
     def check_bitop_identities_1(self, x):
         eq = self.assertEqual
         eq(x & 0, 0, Frm("x & 0 != 0 for x=%r", x))
@@ -305,6 +365,44 @@ class LongTest(unittest.TestCase):
                 x = self.getran(lenx)
                 self.check_format_1(x)
 
+    def test_big_format(self):
+        # str() and long() of numbers big enough to be split in halves,
+        # compared with conversions 9 digits at a time
+        def slow_str(x):
+            chunks = []
+            sign, x = '-'[:x < 0], abs(x)
+            while x >= 10**9:
+                x, r = divmod(x, 10**9)
+                chunks.append('%09d' % r)
+            chunks.append(str(x))
+            return sign + ''.join(reversed(chunks))
+        def slow_long(s, base):
+            x = 0L
+            for i in xrange(0, len(s), 5):
+                x = x * base ** len(s[i:i+5]) + int(s[i:i+5], base)
+            return x
+        for ndigits in (DC_TO_DECIMAL_CUTOFF + 1, 3 * DC_TO_DECIMAL_CUTOFF,
+                        8 * DC_TO_DECIMAL_CUTOFF + 7):
+            for x in (self.getran(ndigits), 1L << (ndigits * SHIFT - 1),
+                      (1L << (ndigits * SHIFT)) - 1):
+                s = slow_str(x)
+                self.assertEqual(str(x), s)
+                self.assertEqual(repr(x), s + 'L')
+                self.assertEqual(long(s), x)
+            for x in (10L ** (ndigits * 9), 10L ** (ndigits * 9) - 1):
+                self.assertEqual(str(x), slow_str(x))
+        alphabet = '0123456789abcdefghijklmnopqrstuvwxyz'
+        for base in 3, 10, 36:
+            for n in (DC_FROM_STRING_CUTOFF + 1, 4 * DC_FROM_STRING_CUTOFF,
+                      9 * DC_FROM_STRING_CUTOFF - 1):
+                digits = ''.join(random.choice(alphabet[:base])
+                                 for i in xrange(n))
+                for s in (digits, '0' * (n // 2) + digits[n // 2:],
+                          alphabet[base - 1] * n):
+                    self.assertEqual(long(s, base), slow_long(s, base))
+                    self.assertEqual(long(' -' + s + ' ', base),
+                                     -slow_long(s, base))
+
     def test_long(self):
         self.assertEqual(long(314), 314L)
         self.assertEqual(long(3.14), 3L)
@@ -2,6 +2,7 @@
 
 from test.test_support import run_unittest, check_py3k_warnings
 import unittest
+import sys
 
 class OpcodeTest(unittest.TestCase):
 
@@ -108,6 +109,89 @@ class OpcodeTest(unittest.TestCase):
                 return 42
         self.assertEqual(MyString() % 3, 42)
 
+    def test_load_global_cache(self):
+        # Enough calls to give the code object its inline caches, then
+        # check that changes to globals and builtins are still seen.
+        ns = {}
+        exec "def f():\n    return (g, len(()))\n" in ns
+        f = ns['f']
+        ns['g'] = 1
+        for i in range(2000):
+            self.assertEqual(f(), (1, 0))
+        ns['g'] = 2
+        self.assertEqual(f(), (2, 0))
+        ns['len'] = lambda x: 42
+        self.assertEqual(f(), (2, 42))
+        del ns['len']
+        self.assertEqual(f(), (2, 0))
+        del ns['g']
+        self.assertRaises(NameError, f)
+        # Same code, different globals
+        ns2 = {'g': 3, '__builtins__': ns['__builtins__']}
+        f2 = type(f)(f.func_code, ns2)
+        self.assertEqual(f2(), (3, 0))
+
+    def test_load_attr_cache(self):
+        class C(object):
+            a = 'class'
+            def __init__(self):
+                self.x = 1
+            @property
+            def p(self):
+                return 'property'
+        class Old:
+            a = 'old'
+            x = 2
+            p = 'oldp'
+        def get(o):
+            return o.a, o.x, o.p
+        c = C()
+        for i in range(2000):
+            self.assertEqual(get(c), ('class', 1, 'property'))
+        c.a = 'instance'
+        self.assertEqual(get(c), ('instance', 1, 'property'))
+        del c.a
+        C.a = 'changed'
+        self.assertEqual(get(c), ('changed', 1, 'property'))
+        C.p = 'plain'
+        self.assertEqual(get(c), ('changed', 1, 'plain'))
+        c.x = 5
+        self.assertEqual(get(c), ('changed', 5, 'plain'))
+        self.assertEqual(get(Old()), ('old', 2, 'oldp'))
+        del c.x
+        self.assertRaises(AttributeError, get, c)
+        # Enough different types to switch the caches off
+        for i in range(100):
+            T = type('T%d' % i, (object,), {'a': i, 'x': i, 'p': i})
+            self.assertEqual(get(T()), (i, i, i))
+        self.assertEqual(get(C()), ('changed', 1, 'plain'))
+
+    def test_specialized_instructions(self):
+        # Once hot, the instructions below run in specialized forms.
+        # Feeding them other types must fall back to the generic ones.
+        import marshal
+        def f(a, b, seq, func):
+            return a + b, seq[a], a < b, func(a)
+        def ident(x):
+            return x
+        code = f.func_code.co_code
+        dumped = marshal.dumps(f.func_code)
+        for i in range(2000):
+            self.assertEqual(f(1, 2, [5, 6], ident), (3, 6, True, 1))
+        self.assertEqual(f(1.5, 2.0, {1.5: 6}, ident), (3.5, 6, True, 1.5))
+        self.assertEqual(f(sys.maxint, 1, {sys.maxint: 'x'}, str),
+                         (sys.maxint + 1, 'x', False, str(sys.maxint)))
+        self.assertEqual(f(-1, 2, [5, 6], abs), (1, 6, True, 1))
+        self.assertRaises(TypeError, f, 1, 2, [5, 6], len)
+        self.assertEqual(f(True, True, [5, 6], ident), (2, 6, False, True))
+        self.assertRaises(IndexError, f, 5, 2, [5, 6], ident)
+        self.assertEqual(f('a', 'b', {'a': 1}, ident), ('ab', 1, True, 'a'))
+        for i in range(2000):
+            self.assertEqual(f(2.0, 0.5, {2.0: 1}, float)[:3],
+                             (2.5, 1, False))
+        self.assertEqual(f.func_code.co_code, code)
+        self.assertEqual(marshal.dumps(f.func_code), dumped)
+
 
 def test_main():
     with check_py3k_warnings(("exceptions must derive from BaseException",
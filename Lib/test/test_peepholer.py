@@ -54,6 +54,19 @@ class TestTranforms(unittest.TestCase):
         self.assertIn('LOAD_CONST', disassemble(f))
         self.assertNotIn('LOAD_GLOBAL', disassemble(f))
 
+    def test_method_call(self):
+        # Arguments of LOAD_METHOD/CALL_METHOD still get folded
+        asm = dis_single('x.f(2*3, None)')
+        self.assertIn('LOAD_METHOD', asm)
+        self.assertIn('(6)', asm)
+        self.assertIn('CALL_METHOD              2', asm)
+        self.assertNotIn('BINARY_MULTIPLY', asm)
+        def f(x):
+            return x.f(None)
+        asm = disassemble(f)
+        self.assertNotIn('LOAD_GLOBAL', asm)
+        self.assertIn('CALL_METHOD', asm)
+
     def test_while_one(self):
         # Skip over:  LOAD_CONST trueconst  POP_JUMP_IF_FALSE xx
         def f():
@@ -117,6 +117,24 @@ class TestJointOps(unittest.TestCase):
         else:
             self.assertNotEqual(id(s), id(z))
 
+    def test_intersection_kept_element(self):
+        # Of two equal elements, the intersection keeps other's unless
+        # other is the larger set, and always a dict's key
+        def kept(s):
+            self.assertEqual(len(s), 1)
+            x, = s
+            return repr(x), type(x)
+        self.assertEqual(kept(self.thetype([0, 5]) & frozenset([-0.0, 7])),
+                         ('-0.0', float))
+        self.assertEqual(kept(self.thetype([1, 2]) & set([1.0, 3.0, 4.0])),
+                         ('1', int))
+        self.assertEqual(kept(self.thetype(['x']).intersection(
+                             {u'x': 1, 'q': 2})), (repr(u'x'), unicode))
+        self.assertEqual(kept(self.thetype([1]).intersection(
+                             {1.0: None, 2: 0, 3: 0})), ('1.0', float))
+        self.assertEqual(kept(self.thetype([1, 2, 3]).intersection(
+                             {1.0: None})), ('1.0', float))
+
     def test_isdisjoint(self):
         def f(s1, s2):
             'Pure python equivalent of isdisjoint()'
@@ -328,6 +346,60 @@ class TestJointOps(unittest.TestCase):
         self.assertEqual(sum(elem.hash_count for elem in d), n)
         self.assertEqual(d3, dict.fromkeys(d, 123))
 
+    def test_do_not_rehash_set_keys(self):
+        n = 10
+        keys = map(HashCountingInt, xrange(2 * n))
+        s = self.thetype(keys[:n])
+        others = [set(keys[n // 2:]), frozenset(keys[::3]),
+                  dict.fromkeys(keys[1:3])]
+        hashes = lambda: sum(elem.hash_count for elem in keys)
+        count = hashes()
+        s.union(*others)
+        s.intersection(*others[:2])
+        for other in others:
+            s | set(other)
+            s & set(other)
+            s - set(other)
+            s.intersection(other)
+            s.difference(other)
+        s.copy()
+        self.assertEqual(hashes(), count)
+
+    def test_bulk_ops_of_differing_sizes(self):
+        # Both the smaller and the larger operand get walked
+        for m in 0, 1, 7, 100, 1000:
+            s = self.thetype(range(m))
+            for n in 0, 3, 50, 900, 5000:
+                keys = range(m // 2, m // 2 + n)
+                for C in set, frozenset, dict.fromkeys, list:
+                    t = C(keys)
+                    a, b = set(range(m)), set(keys)
+                    self.assertEqual(s.union(t), a | b)
+                    self.assertEqual(s.intersection(t), a & b)
+                    self.assertEqual(s.difference(t), a - b)
+                    u = C(range(0, 2 * m, 3))
+                    c = set(u)
+                    self.assertEqual(s.union(t, u), a | b | c)
+                    self.assertEqual(s.intersection(t, u), a & b & c)
+                    self.assertEqual(s.intersection(u, s, t), a & b & c)
+                    self.assertEqual(s.difference(t, u), a - b - c)
+                    self.assertEqual(type(s.union(t, u)), self.thetype)
+                    self.assertEqual(type(s.intersection(t, u)), self.thetype)
+                    self.assertEqual(type(s.difference(t, u)), self.thetype)
+
+    @test_support.cpython_only
+    def test_small_result_table(self):
+        # Results keep no more table than they turn out to need, even
+        # when presized for their largest possible size
+        s = self.thetype(range(10000))
+        t = set(range(10000, 20000))
+        small = sys.getsizeof(self.thetype())
+        self.assertEqual(sys.getsizeof(s.intersection(t, set(s))), small)
+        self.assertEqual(sys.getsizeof(s & t), small)
+        self.assertEqual(sys.getsizeof(s - set(s)), small)
+        self.assertEqual(sys.getsizeof(s.union(s, s, s, s)),
+                         sys.getsizeof(s.union(s)))
+
     def test_container_iterator(self):
         # Bug #3680: tp_traverse was not implemented for set iterator object
         class C(object):
@@ -428,6 +500,32 @@ class TestSet(TestJointOps):
             self.assertNotIn(elem, self.s)
         self.assertRaises(KeyError, self.s.pop)
 
+    def test_colliding_hashes(self):
+        # Hashes alike in their low bits collide in the same probes
+        keys = [i << 20 for i in xrange(2000)]
+        s = self.thetype(keys)
+        for i in xrange(0, 2000, 2):
+            s.remove(i << 20)
+        for i in xrange(2000):
+            self.assertEqual((i << 20) in s, i % 2 == 1)
+            self.assertNotIn((i << 20) + 1, s)
+        s.update(keys)
+        self.assertEqual(s, set(keys))
+        # alike in all but their top bits, some of them negative
+        keys = [-(i << 40) for i in xrange(1, 2000)]
+        keys += [i << 50 for i in xrange(1, 2000)]
+        s = self.thetype(keys)
+        self.assertEqual(len(s), len(keys))
+        for k in keys:
+            self.assertIn(k, s)
+            self.assertNotIn(k + (1 << 30), s)
+        # equal ints of different objects
+        s = self.thetype(xrange(1000, 3000))
+        for i in xrange(1000, 3000):
+            self.assertIn(int(str(i)), s)
+        self.assertNotIn(-1, self.thetype([-2]))
+        self.assertIn(-2, self.thetype([-2]))
+
     def test_update(self):
         retval = self.s.update(self.otherword)
         self.assertEqual(retval, None)
@@ -510,6 +608,12 @@ class TestSet(TestJointOps):
                 s.difference_update(C('cdc'), C('aba'))
                 self.assertEqual(s, self.thetype('efghih'))
 
+    def test_intersection_update_kept_element(self):
+        s = self.thetype([1, 2])
+        s.intersection_update(set([1.0, 3.0]))
+        x, = s
+        self.assertEqual((repr(x), type(x)), ('1.0', float))
+
     def test_isub(self):
         self.s -= set(self.otherword)
         for c in (self.word + self.otherword):
@@ -635,6 +739,17 @@ class TestFrozenSet(TestJointOps):
         f = self.thetype('abcdcda')
         self.assertEqual(hash(f), hash(f))
 
+    @test_support.cpython_only
+    def test_compact_table(self):
+        # A frozenset needs no room to grow
+        keys = range(1400)
+        f = self.thetype(keys)
+        self.assertLess(sys.getsizeof(f), sys.getsizeof(set(keys)))
+        self.assertEqual(f, set(keys))
+        for i in keys:
+            self.assertIn(i, f)
+        self.assertNotIn(1400, f)
+
     def test_hash_effectiveness(self):
         n = 13
         hashvalues = set()
@@ -267,11 +267,157 @@ class TestDecorateSortUndecorate(unittest.TestCase):
 
 #==============================================================================
 
+class TestOptimizedCompares(unittest.TestCase):
+    # list.sort() picks a faster compare when the keys all have the same
+    # type; the results must be the same as with the generic compare.
+
+    def check_against_cmp(self, L, **kwds):
+        expected = sorted(L, cmp=lambda x, y: cmp(x, y), **kwds)
+        self.assertEqual(sorted(L, **kwds), expected)
+        self.assertEqual(sorted(L, reverse=True, **kwds),
+                         sorted(L, cmp=lambda x, y: cmp(x, y), reverse=True,
+                                **kwds))
+
+    def test_same_type(self):
+        for n in (2, 10, 100, 1000):
+            ints = [random.randrange(-n, n) for i in xrange(n)]
+            self.check_against_cmp(ints)
+            self.check_against_cmp([long(x) << 70 for x in ints])
+            self.check_against_cmp([x / 3.0 for x in ints])
+            self.check_against_cmp([str(x) for x in ints])
+            self.check_against_cmp([str(x) + '\0' for x in ints])
+            self.check_against_cmp([unicode(x) + u'\u20ac' for x in ints])
+            self.check_against_cmp([(x % 3, str(x)) for x in ints])
+            self.check_against_cmp([((x,), x) for x in ints])
+            self.check_against_cmp([(x,) for x in ints] + [()])
+            self.check_against_cmp(ints, key=lambda x: (str(x), x))
+
+    def test_mixed_types(self):
+        L = [1, 2L, 3.0, 4, 5L, 6.5] * 10
+        random.shuffle(L)
+        self.check_against_cmp(L)
+        L = [(1, 'a'), (1L, 'b'), (0.5, 'c'), [1], (2,)]
+        self.check_against_cmp(L)
+        L = ['a', u'b', 'c', u'a']
+        self.check_against_cmp(L)
+
+    def test_float_nan(self):
+        nan = float('nan')
+        L = [3.0, nan, 1.0, 2.0, nan, 0.0]
+        self.assertEqual(sorted(L, key=lambda x: 0), L)
+        self.assertEqual(repr(sorted(L)),
+                         repr(sorted(L, cmp=lambda x, y: -(x < y) or (y < x))))
+
+    def test_subclass_and_custom_lt(self):
+        class S(str):
+            def __lt__(self, other):
+                return len(self) < len(other)
+        L = [S('ccc'), S('a'), S('bb'), S('')]
+        self.assertEqual(sorted(L), ['', 'a', 'bb', 'ccc'])
+
+        class N(object):
+            def __init__(self, x):
+                self.x = x
+            def __lt__(self, other):
+                if self.x == 2:
+                    # a compare may change the type of a key
+                    other.__class__ = M
+                return self.x < other.x
+        class M(N):
+            def __lt__(self, other):
+                return other.x < self.x
+        L = [N(x) for x in range(10)]
+        sorted(L)
+
+    def test_errors(self):
+        class Bad(object):
+            def __lt__(self, other):
+                raise ZeroDivisionError
+        self.assertRaises(ZeroDivisionError, sorted, [Bad(), Bad()])
+        self.assertRaises(ZeroDivisionError, sorted, [(Bad(),), (Bad(),)])
+        self.assertRaises(UnicodeDecodeError, sorted,
+                          [u'a', u'b', '\xff'], key=unicode)
+
+#==============================================================================
+
+class TestParallel(unittest.TestCase):
+    # Large enough for list.sort(parallel=True) to sort natively.
+    n = 70001
+
+    def check_same(self, L, **kwds):
+        for reverse in (False, True):
+            expected = sorted(L, reverse=reverse, **kwds)
+            got = sorted(L, reverse=reverse, parallel=True, **kwds)
+            self.assertEqual(len(got), len(expected))
+            for x, y in zip(got, expected):
+                self.assertIs(x, y)
+
+    def test_ints(self):
+        L = [random.randrange(-1000, 1000) for i in xrange(self.n)]
+        self.check_same(L)
+        self.check_same(L, key=abs)
+        L.sort()
+        self.check_same(L)
+
+    def test_floats(self):
+        # 0.0 and -0.0 are equal, and must stay in order
+        choices = [0.0, -0.0, 1.5, -1e300]
+        L = [random.choice(choices) * random.randrange(1, 3)
+             for i in xrange(self.n)]
+        self.check_same(L)
+        self.check_same(range(self.n), key=float)
+
+    def test_strs(self):
+        L = [str(random.randrange(5000)) + '\0' * random.randrange(2)
+             for i in xrange(self.n)]
+        self.check_same(L)
+        self.check_same(range(self.n), key=str)
+        # Strings built with += while something else refers to them are
+        # copied together only when first used; here by the parallel sort
+        def build():
+            keep = []
+            L = []
+            for i in xrange(40000):
+                s = str(random.randrange(5000))
+                if i % 100 == 0:
+                    t = 'z' * 1100
+                    keep.append(t)
+                    t += s
+                    s = t
+                L.append(s)
+            return L
+        random.seed(7)
+        L = build()
+        random.seed(7)
+        expected = sorted(build())
+        L.sort(parallel=True)
+        self.assertEqual(L, expected)
+
+    def test_not_native(self):
+        L = [float(i % 100) for i in xrange(self.n)] + [float('nan')]
+        self.assertEqual(repr(sorted(L, parallel=True)), repr(sorted(L)))
+        L = range(self.n)
+        L[5] = 3L
+        self.check_same(L)
+        L = [(i % 10, str(i)) for i in xrange(self.n)]
+        self.check_same(L)
+
+    def test_list_sort(self):
+        L = range(self.n, 0, -1)
+        L.sort(None, None, False, True)
+        self.assertEqual(L, range(1, self.n + 1))
+        L.sort(parallel=1, reverse=True)
+        self.assertEqual(L, range(self.n, 0, -1))
+
+#==============================================================================
+
 def test_main(verbose=None):
     test_classes = (
         TestBase,
         TestDecorateSortUndecorate,
         TestBugs,
+        TestOptimizedCompares,
+        TestParallel,
     )
 
     with test_support.check_py3k_warnings(
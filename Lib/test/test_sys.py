@@ -215,6 +215,23 @@ class SysModuleTest(unittest.TestCase):
             sys.setcheckinterval(n)
             self.assertEqual(sys.getcheckinterval(), n)
 
+    @unittest.skipUnless(hasattr(sys, "setswitchinterval"),
+                         "requires a build with threads")
+    def test_switchinterval(self):
+        self.assertRaises(TypeError, sys.setswitchinterval)
+        self.assertRaises(TypeError, sys.setswitchinterval, "a")
+        self.assertRaises(ValueError, sys.setswitchinterval, -1.0)
+        self.assertRaises(ValueError, sys.setswitchinterval, 0.0)
+        orig = sys.getswitchinterval()
+        # sanity check
+        self.assertTrue(orig < 0.5, orig)
+        try:
+            for n in 0.00001, 0.05, 3.0, orig:
+                sys.setswitchinterval(n)
+                self.assertAlmostEqual(sys.getswitchinterval(), n)
+        finally:
+            sys.setswitchinterval(orig)
+
     def test_recursionlimit(self):
         self.assertRaises(TypeError, sys.getrecursionlimit, 42)
         oldlimit = sys.getrecursionlimit()
@@ -299,6 +316,37 @@ class SysModuleTest(unittest.TestCase):
             is sys._getframe().f_code
         )
 
+    def test_escaping_frames(self):
+        # Frames that outlive their call, interleaved with frames that
+        # don't, and enough of them to span several frame arena chunks.
+        def rec(n):
+            if n == 0:
+                return sys._getframe()
+            return rec(n - 1)
+        rec(0)
+        frames = [rec(n) for n in range(0, 500, 7)]
+        for n, f in zip(range(0, 500, 7), frames):
+            depth = 0
+            while f.f_code is rec.func_code:
+                f = f.f_back
+                depth += 1
+            self.assertEqual(depth, n + 1)
+        del frames[::2]
+        self.assertEqual(rec(200).f_locals['n'], 0)
+
+        # A frame made in one thread and freed in another, after the
+        # first thread has gone away.
+        try:
+            import threading
+        except ImportError:
+            return
+        held = []
+        t = threading.Thread(target=lambda: held.append(rec(300)))
+        t.start()
+        t.join()
+        self.assertIs(held[0].f_back.f_code, rec.func_code)
+        del held[:]
+
     # sys._current_frames() is a CPython-only gimmick.
     def test_current_frames(self):
         have_threads = True
@@ -447,6 +495,39 @@ class SysModuleTest(unittest.TestCase):
     def test_clear_type_cache(self):
         sys._clear_type_cache()
 
+    @unittest.skipUnless(hasattr(sys, "_debugmallocstats"),
+                         "needs pymalloc")
+    def test_debugmallocstats(self):
+        from test.script_helper import assert_python_ok
+        ret, out, err = assert_python_ok(
+            '-c', 'import sys; sys._debugmallocstats()')
+        self.assertIn("# arenas allocated current", err)
+        self.assertIn("returned pools", err)
+        self.assertRaises(TypeError, sys._debugmallocstats, True)
+
+    @unittest.skipUnless(hasattr(sys, "_debugmallocstats") and
+                         sys.platform.startswith("linux"),
+                         "needs pymalloc on Linux")
+    def test_pymalloc_returns_pools(self):
+        # Dropping most of a big heap leaves its arenas mostly, but not
+        # wholly, free; their free pools must go back to the OS.
+        from test.script_helper import assert_python_ok
+        code = """if 1:
+            import sys
+            x = [str(i) * 3 for i in xrange(300000)]
+            keep = x[::500]
+            del x
+            sys._debugmallocstats()
+            """
+        ret, out, err = assert_python_ok('-c', code)
+        line = [l for l in err.splitlines()
+                if l.startswith("# pools returned to the OS total")][0]
+        self.assertGreater(int(line.split("=")[1].replace(",", "")), 0)
+
+        ret, out, err = assert_python_ok('-c', code,
+                                         PYTHONMALLOCHUGEPAGES='1')
+        self.assertIn("arenas * 2097152 bytes/arena", err)
+
     def test_ioencoding(self):
         import subprocess
         env = dict(os.environ)
@@ -587,7 +668,7 @@ class SizeofTest(unittest.TestCase):
         # complex
         check(complex(0,1), size(h + '2d'))
         # code
-        check(get_cell().func_code, size(h + '4i8Pi3P'))
+        check(get_cell().func_code, size(h + '4i8Pi3P4Picc'))
         # BaseException
         check(BaseException(), size(h + '3P'))
         # UnicodeEncodeError
@@ -614,9 +695,18 @@ class SizeofTest(unittest.TestCase):
         # method-wrapper (descriptor object)
         check({}.__iter__, size(h + '2P'))
         # dict
-        check({}, size(h + '3P2P' + 8*'P2P'))
+        check({}, size(h + '3P2PQ3P8c' + 5*'P2P'))
         x = {1:1, 2:2, 3:3, 4:4, 5:5, 6:6, 7:7, 8:8}
-        check(x, size(h + '3P2P' + 8*'P2P') + 16*size('P2P'))
+        check(x, size(h + '3P2PQ3P8c' + 5*'P2P') + 16 + 10*size('P2P'))
+        # split dict (an instance __dict__ sharing its keys)
+        class Point(object):
+            def __init__(self):
+                self.a = 1
+        x = Point()
+        check(x.__dict__, size(h + '3P2PQ3P') + 5*self.P)
+        # ... which becomes combined when given a non-string key
+        x.__dict__[1] = 2
+        check(x.__dict__, size(h + '3P2PQ3P') + 8 + 5*size('P2P'))
         # dictionary-keyiterator
         check({}.iterkeys(), size(h + 'P2PPP'))
         # dictionary-valueiterator
@@ -645,7 +735,7 @@ class SizeofTest(unittest.TestCase):
         nfrees = len(x.f_code.co_freevars)
         extras = x.f_code.co_stacksize + x.f_code.co_nlocals +\
                  ncells + nfrees - 1
-        check(x, size(vh + '12P3i' + CO_MAXBLOCKS*'3i' + 'P' + extras*'P'))
+        check(x, size(vh + '13P3i' + CO_MAXBLOCKS*'3i' + 'P' + extras*'P'))
         # function
         def func(): pass
         check(func, size(h + '9P'))
@@ -747,8 +837,8 @@ class SizeofTest(unittest.TestCase):
         check(iter(()), size(h + 'lP'))
         # type
         # (PyTypeObject + PyNumberMethods +  PyMappingMethods +
-        #  PySequenceMethods + PyBufferProcs)
-        s = size(vh + 'P2P15Pl4PP9PP11PI') + size('41P 10P 3P 6P')
+        #  PySequenceMethods + PyBufferProcs + ht_cached_keys)
+        s = size(vh + 'P2P15Pl4PP9PP11PIP') + size('41P 10P 3P 6P P')
         class newstyleclass(object):
             pass
         check(newstyleclass, s)
@@ -763,7 +853,9 @@ class SizeofTest(unittest.TestCase):
         # we need to test for both sizes, because we don't know if the string
         # has been cached
         for s in samples:
-            check(s, size(h + 'PPlP') + usize * (len(s) + 1))
+            check(s, size(h + 'PPlPi0P') + usize * (len(s) + 1))
+        # decoded text below 256 is kept one byte per character
+        check(('1'*100).decode('ascii'), size(h + 'PPlPi0P') + 101)
         # weakref
         import weakref
         check(weakref.ref(int), size(h + '2Pl2P'))
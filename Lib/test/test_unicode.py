@@ -133,6 +133,12 @@ class UnicodeTest(
 
         self.assertRaises(TypeError, u'hello'.find)
         self.assertRaises(TypeError, u'hello'.find, 42)
+        # code units with the high bit set
+        s = u'\u8085\uffff' * 20 + u'\x85\xff'
+        self.assertEqual(s.find(u'\x85\xff'), 40)
+        self.assertEqual(s.find(u'\xff'), 41)
+        self.assertEqual(s.rfind(u'\uffff\u8085'), 37)
+        self.assertEqual(s.count(u'\uffff'), 20)
 
     def test_rfind(self):
         string_tests.CommonTest.test_rfind(self)
@@ -169,6 +175,17 @@ class UnicodeTest(
             self.assertRaises(ValueError, t1('abcdefghi').rindex,  t2('ghi'), 0, 8)
             self.assertRaises(ValueError, t1('abcdefghi').rindex,  t2('ghi'), 0, -1)
 
+    def test_splitlines_long(self):
+        # every unicode line break at every position of a long string,
+        # and characters next to them that aren't line breaks
+        for br in u'\n\x0b\x0c\r\x1c\x1d\x1e\x85\u2028\u2029':
+            for i in xrange(40):
+                s = u'x' * i + br + u'y' * (40 - i)
+                self.assertEqual(s.splitlines(), [s[:i], s[i + 1:]])
+        for other in u'\t\x1f\x84\x86\u2027\u202a':
+            s = u'x' * 20 + other + u'y' * 20
+            self.assertEqual(s.splitlines(), [s])
+
     def test_translate(self):
         self.checkequalnofix(u'bbbc', u'abababc', 'translate', {ord('a'):None})
         self.checkequalnofix(u'iiic', u'abababc', 'translate', {ord('a'):None, ord('b'):ord('i')})
@@ -835,6 +852,62 @@ class UnicodeTest(
         # * strict decoding testing for all of the
         #   UTF8_ERROR cases in PyUnicode_DecodeUTF8
 
+    def test_codecs_ascii_runs(self):
+        # runs of ASCII are copied a word at a time; check every offset
+        # and alignment of a non-ASCII character among them
+        for n in range(20):
+            for i in range(n):
+                u = u'a' * i + u'\xe9' + u'b' * (n - i - 1)
+                b = u.encode('utf-8')
+                self.assertEqual(b.decode('utf-8'), u)
+                self.assertEqual(b[1:].decode('utf-8', 'ignore'), u[1:])
+                self.assertEqual(u.encode('latin-1').decode('latin-1'), u)
+                self.assertEqual(
+                    u.encode('latin-1').decode('ascii', 'replace'),
+                    u.replace(u'\xe9', u'\ufffd'))
+                self.assertEqual(u.encode('ascii', 'replace'),
+                                 u.replace(u'\xe9', u'?').encode('ascii'))
+                self.assertEqual(
+                    (u + u'\u20ac').encode('latin-1', 'ignore'),
+                    u.encode('latin-1'))
+                with self.assertRaises(UnicodeDecodeError) as cm:
+                    b.decode('ascii')
+                self.assertEqual(cm.exception.start, i)
+                with self.assertRaises(UnicodeEncodeError) as cm:
+                    u.encode('ascii')
+                self.assertEqual(cm.exception.start, i)
+                with self.assertRaises(UnicodeDecodeError) as cm:
+                    (b[:i] + b'\xff' + b[i+2:]).decode('utf-8')
+                self.assertEqual(cm.exception.start, i)
+        u = (u'x' * 37 + u'\u20ac') * 30
+        self.assertEqual(u.encode('utf-8').decode('utf-8'), u)
+        self.assertEqual(u.encode('utf-8'), ('x' * 37 + '\xe2\x82\xac') * 30)
+
+    def test_codecs_utf8_multibyte_runs(self):
+        # runs of 2- and 3-byte sequences are validated a block at a time;
+        # check every offset of a bad sequence among them
+        bad = ['\xff', '\x80', '\xc0\x80', '\xc1\xbf', '\xe0\x80\x80',
+               '\xe0\x9f\xbf', '\xe4\xb8', '\xd0', 'x', '\xf0\x9f\x98\x80']
+        for c in (u'\u043f', u'\u4e2d'):
+            for n in range(12):
+                u = c * n
+                b = u.encode('utf-8')
+                self.assertEqual(b.decode('utf-8'), u)
+                for i in range(n + 1):
+                    k = i * len(c.encode('utf-8'))
+                    for x in bad:
+                        self.assertEqual(
+                            (b[:k] + x + b[k:]).decode('utf-8', 'replace'),
+                            u[:i] + x.decode('utf-8', 'replace') + u[i:])
+                        if x in ('x', '\xf0\x9f\x98\x80'):
+                            continue
+                        with self.assertRaises(UnicodeDecodeError) as cm:
+                            (b[:k] + x + b[k:]).decode('utf-8')
+                        self.assertEqual(cm.exception.start, k)
+        # surrogates still decode
+        u = u'\u4e2d' * 5 + u'\ud800' + u'\u4e2d' * 5
+        self.assertEqual(u.encode('utf-8').decode('utf-8'), u)
+
     def test_utf8_decode_valid_sequences(self):
         sequences = [
             # single byte
@@ -1631,6 +1704,87 @@ class UnicodeTest(
         self.assertEqual(unicode_encodedecimal(u"123\u20ac\u0660", "replace"),
                          b'123?0')
 
+    def test_compact(self):
+        # the decoders keep text below 256 one byte per character; it
+        # must behave as the same text built character by character
+        wide = u''.join(map(unichr, range(32, 256))) * 3
+        compact = wide.encode('latin-1').decode('latin-1')
+        self.assertLess(sys.getsizeof(compact), sys.getsizeof(wide))
+        self.assertEqual(compact, wide)
+        self.assertEqual(hash(compact), hash(wide))
+        self.assertEqual(compact.encode('utf-8').decode('utf-8'), wide)
+        self.assertEqual(compact.encode('utf-8'), wide.encode('utf-8'))
+        self.assertRaises(UnicodeEncodeError, compact.encode, 'ascii')
+        self.assertEqual(compact[5:40], wide[5:40])
+        self.assertEqual(compact[::-3], wide[::-3])
+        self.assertEqual(compact[100], wide[100])
+        self.assertEqual(list(compact), list(wide))
+        for sub in [u'', u'a', u'\xe9', u'\u20ac', u'xyz', u'xyz'.encode(
+                    'ascii').decode('ascii')]:
+            for start, end in [(0, None), (10, 500), (-300, -20),
+                               (600, 700)]:
+                self.assertEqual(compact.find(sub, start, end),
+                                 wide.find(sub, start, end))
+                self.assertEqual(compact.rfind(sub, start, end),
+                                 wide.rfind(sub, start, end))
+                self.assertEqual(compact.count(sub, start, end),
+                                 wide.count(sub, start, end))
+            self.assertEqual(sub in compact, sub in wide)
+        ascii = 'spam and eggs'.decode('ascii')
+        self.assertLess(ascii, ascii + u'\u20ac')
+        self.assertGreater(ascii, ascii[:-1])
+        self.assertLess(ascii, u'spam and eggz')
+        self.assertEqual(ascii + u'\u20ac', u'spam and eggs\u20ac')
+        self.assertEqual(ascii + ascii, u'spam and eggsspam and eggs')
+        self.assertEqual(u'-'.join([ascii, u'\u20ac', ascii]),
+                         u'spam and eggs-\u20ac-spam and eggs')
+        self.assertEqual(ascii.replace(u'and', u'\u20ac'),
+                         u'spam \u20ac eggs')
+        self.assertEqual(ascii.upper(), u'SPAM AND EGGS')
+        self.assertTrue(ascii.startswith(u'spam'))
+        self.assertTrue(ascii.endswith('eggs'.decode('ascii')))
+        self.assertFalse(ascii.endswith(u'\u20acggs'))
+        self.assertEqual(ascii.split(), [u'spam', u'and', u'eggs'])
+        self.assertEqual(ascii.encode('utf-16-le'),
+                         u'spam and eggs'.encode('utf-16-le'))
+        s = ascii
+        s += u'\u20ac'
+        self.assertEqual(s, u'spam and eggs\u20ac')
+        class U(unicode):
+            pass
+        self.assertEqual(U(ascii), ascii)
+        self.assertEqual(type(U(ascii)), U)
+        # in a UCS4 build, characters below 0x10000 take two bytes each
+        bmp = u'\u20ac\xe9spam' * 10
+        self.assertEqual(bmp.encode('utf-8').decode('utf-8'), bmp)
+        self.assertEqual(hash(bmp.encode('utf-8').decode('utf-8')),
+                         hash(bmp))
+        self.assertEqual(bmp.encode('utf-8').decode('utf-8')[1:5],
+                         u'\xe9spa')
+
+    def test_compact_read_in_place(self):
+        # these read a compact argument where it is, without making the
+        # wide copy, which could fail for lack of memory
+        def fresh(s):
+            return s.encode('latin-1').decode('latin-1')
+        def unchanged(s, f):
+            size = sys.getsizeof(s)
+            result = f(s)
+            self.assertEqual(sys.getsizeof(s), size)
+            return result
+        table = fresh(u''.join(map(unichr, range(255, -1, -1))))
+        self.assertEqual(unchanged(table, lambda t:
+                                   codecs.charmap_decode('\x00\x9e', 'strict',
+                                                         t)[0]),
+                         u'\xff\x61')
+        rep = fresh(u'<\xe9>' * 2)
+        self.assertEqual(unchanged(rep, lambda r:
+                                   u'a\u20acb'.translate({0x20ac: r})),
+                         u'a<\xe9><\xe9>b')
+        self.assertEqual(unchanged(rep, lambda r: r * 2), u'<\xe9>' * 4)
+        self.assertEqual(unchanged(rep, lambda r: r.center(8, u'-')),
+                         u'-<\xe9><\xe9>-')
+
 
 def test_main():
     test_support.run_unittest(__name__)
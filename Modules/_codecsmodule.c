@@ -671,6 +671,10 @@ utf_7_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeUTF7(PyUnicode_AS_UNICODE(str),
                                          PyUnicode_GET_SIZE(str),
                                          0,
@@ -695,9 +699,8 @@ utf_8_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
-    v = codec_tuple(PyUnicode_EncodeUTF8(PyUnicode_AS_UNICODE(str),
-                                         PyUnicode_GET_SIZE(str),
-                                         errors),
+    /* the UTF-8 encoder never fails, whatever errors is */
+    v = codec_tuple(PyUnicode_AsUTF8String(str),
                     PyUnicode_GET_SIZE(str));
     Py_DECREF(str);
     return v;
@@ -725,6 +728,10 @@ utf_16_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeUTF16(PyUnicode_AS_UNICODE(str),
                                           PyUnicode_GET_SIZE(str),
                                           errors,
@@ -748,6 +755,10 @@ utf_16_le_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeUTF16(PyUnicode_AS_UNICODE(str),
                                              PyUnicode_GET_SIZE(str),
                                              errors,
@@ -771,6 +782,10 @@ utf_16_be_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeUTF16(PyUnicode_AS_UNICODE(str),
                                           PyUnicode_GET_SIZE(str),
                                           errors,
@@ -802,6 +817,10 @@ utf_32_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeUTF32(PyUnicode_AS_UNICODE(str),
                                           PyUnicode_GET_SIZE(str),
                                           errors,
@@ -825,6 +844,10 @@ utf_32_le_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeUTF32(PyUnicode_AS_UNICODE(str),
                                              PyUnicode_GET_SIZE(str),
                                              errors,
@@ -848,6 +871,10 @@ utf_32_be_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeUTF32(PyUnicode_AS_UNICODE(str),
                                           PyUnicode_GET_SIZE(str),
                                           errors,
@@ -871,6 +898,10 @@ unicode_escape_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeUnicodeEscape(PyUnicode_AS_UNICODE(str),
                                                   PyUnicode_GET_SIZE(str)),
                     PyUnicode_GET_SIZE(str));
@@ -892,6 +923,10 @@ raw_unicode_escape_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeRawUnicodeEscape(
                                PyUnicode_AS_UNICODE(str),
                                PyUnicode_GET_SIZE(str)),
@@ -914,6 +949,10 @@ latin_1_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeLatin1(
                                PyUnicode_AS_UNICODE(str),
                                PyUnicode_GET_SIZE(str),
@@ -937,6 +976,10 @@ ascii_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeASCII(
                                PyUnicode_AS_UNICODE(str),
                                PyUnicode_GET_SIZE(str),
@@ -963,6 +1006,10 @@ charmap_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeCharmap(
                                PyUnicode_AS_UNICODE(str),
                                PyUnicode_GET_SIZE(str),
@@ -998,6 +1045,10 @@ mbcs_encode(PyObject *self,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        return NULL;
+    }
     v = codec_tuple(PyUnicode_EncodeMBCS(
                                PyUnicode_AS_UNICODE(str),
                                PyUnicode_GET_SIZE(str),
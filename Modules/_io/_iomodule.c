@@ -287,9 +287,10 @@ PyDoc_STRVAR(open_doc,
 static PyObject *
 io_open(PyObject *self, PyObject *args, PyObject *kwds)
 {
-    char *kwlist[] = {"file", "mode", "buffering",
-                      "encoding", "errors", "newline",
-                      "closefd", NULL};
+    static const char * const kwlist[] = {"file", "mode", "buffering",
+                                          "encoding", "errors", "newline",
+                                          "closefd", NULL};
+    static _PyArg_Parser _parser = {"O|sizzzi:open", kwlist, 0};
     PyObject *file;
     char *mode = "r";
     int buffering = -1, closefd = 1;
@@ -304,10 +305,10 @@ io_open(PyObject *self, PyObject *args, PyObject *kwds)
 
     PyObject *raw, *modeobj = NULL, *buffer = NULL, *wrapper = NULL;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|sizzzi:open", kwlist,
-                                     &file, &mode, &buffering,
-                                     &encoding, &errors, &newline,
-                                     &closefd)) {
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &file, &mode, &buffering,
+                                          &encoding, &errors, &newline,
+                                          &closefd)) {
         return NULL;
     }
 
@@ -1233,15 +1233,16 @@ static void _bufferedreader_reset_buf(buffered *self)
 static int
 bufferedreader_init(buffered *self, PyObject *args, PyObject *kwds)
 {
-    char *kwlist[] = {"raw", "buffer_size", NULL};
+    static const char * const kwlist[] = {"raw", "buffer_size", NULL};
+    static _PyArg_Parser _parser = {"O|n:BufferedReader", kwlist, 0};
     Py_ssize_t buffer_size = DEFAULT_BUFFER_SIZE;
     PyObject *raw;
 
     self->ok = 0;
     self->detached = 0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|n:BufferedReader", kwlist,
-                                     &raw, &buffer_size)) {
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &raw, &buffer_size)) {
         return -1;
     }
 
@@ -1651,7 +1652,9 @@ static int
 bufferedwriter_init(buffered *self, PyObject *args, PyObject *kwds)
 {
     /* TODO: properly deprecate max_buffer_size */
-    char *kwlist[] = {"raw", "buffer_size", "max_buffer_size", NULL};
+    static const char * const kwlist[] = {"raw", "buffer_size",
+                                          "max_buffer_size", NULL};
+    static _PyArg_Parser _parser = {"O|nn:BufferedReader", kwlist, 0};
     Py_ssize_t buffer_size = DEFAULT_BUFFER_SIZE;
     Py_ssize_t max_buffer_size = -234;
     PyObject *raw;
@@ -1659,8 +1662,9 @@ bufferedwriter_init(buffered *self, PyObject *args, PyObject *kwds)
     self->ok = 0;
     self->detached = 0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|nn:BufferedReader", kwlist,
-                                     &raw, &buffer_size, &max_buffer_size)) {
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &raw, &buffer_size,
+                                          &max_buffer_size)) {
         return -1;
     }
 
@@ -2283,7 +2287,9 @@ PyDoc_STRVAR(bufferedrandom_doc,
 static int
 bufferedrandom_init(buffered *self, PyObject *args, PyObject *kwds)
 {
-    char *kwlist[] = {"raw", "buffer_size", "max_buffer_size", NULL};
+    static const char * const kwlist[] = {"raw", "buffer_size",
+                                          "max_buffer_size", NULL};
+    static _PyArg_Parser _parser = {"O|nn:BufferedReader", kwlist, 0};
     Py_ssize_t buffer_size = DEFAULT_BUFFER_SIZE;
     Py_ssize_t max_buffer_size = -234;
     PyObject *raw;
@@ -2291,8 +2297,9 @@ bufferedrandom_init(buffered *self, PyObject *args, PyObject *kwds)
     self->ok = 0;
     self->detached = 0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|nn:BufferedReader", kwlist,
-                                     &raw, &buffer_size, &max_buffer_size)) {
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &raw, &buffer_size,
+                                          &max_buffer_size)) {
         return -1;
     }
 
@@ -771,11 +771,12 @@ bytesio_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 static int
 bytesio_init(bytesio *self, PyObject *args, PyObject *kwds)
 {
-    char *kwlist[] = {"initial_bytes", NULL};
+    static const char * const kwlist[] = {"initial_bytes", NULL};
+    static _PyArg_Parser _parser = {"|O:BytesIO", kwlist, 0};
     PyObject *initvalue = NULL;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:BytesIO", kwlist,
-                                     &initvalue))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &initvalue))
         return -1;
 
     /* In case, __init__ is called multiple times. */
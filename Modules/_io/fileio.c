@@ -182,7 +182,8 @@ static int
 fileio_init(PyObject *oself, PyObject *args, PyObject *kwds)
 {
     fileio *self = (fileio *) oself;
-    static char *kwlist[] = {"file", "mode", "closefd", NULL};
+    static const char * const kwlist[] = {"file", "mode", "closefd", NULL};
+    static _PyArg_Parser _parser = {"O|si:fileio", kwlist, 0};
     const char *name = NULL;
     PyObject *nameobj, *stringobj = NULL;
     char *mode = "r";
@@ -203,8 +204,8 @@ fileio_init(PyObject *oself, PyObject *args, PyObject *kwds)
             return -1;
     }
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|si:fileio",
-                                     kwlist, &nameobj, &mode, &closefd))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &nameobj, &mode, &closefd))
         return -1;
 
     if (PyFloat_Check(nameobj)) {
@@ -224,8 +225,11 @@ fileio_init(PyObject *oself, PyObject *args, PyObject *kwds)
     }
 
 #ifdef MS_WINDOWS
-    if (PyUnicode_Check(nameobj))
+    if (PyUnicode_Check(nameobj)) {
         widename = PyUnicode_AS_UNICODE(nameobj);
+        if (widename == NULL)
+            return -1;
+    }
     if (widename == NULL)
 #endif
     if (fd < 0)
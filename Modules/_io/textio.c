@@ -202,10 +202,13 @@ incrementalnewlinedecoder_init(nldecoder_object *self,
     PyObject *decoder;
     int translate;
     PyObject *errors = NULL;
-    char *kwlist[] = {"decoder", "translate", "errors", NULL};
+    static const char * const kwlist[] = {"decoder", "translate", "errors",
+                                          NULL};
+    static _PyArg_Parser _parser = {"Oi|O:IncrementalNewlineDecoder",
+                                    kwlist, 0};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Oi|O:IncrementalNewlineDecoder",
-                                     kwlist, &decoder, &translate, &errors))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &decoder, &translate, &errors))
         return -1;
 
     self->decoder = decoder;
@@ -273,6 +276,9 @@ _PyIncrementalNewlineDecoder_decode(PyObject *_self,
                         "decoder should return a string result");
         goto error;
     }
+    /* everything below reads the wide characters */
+    if (PyUnicode_AS_UNICODE(output) == NULL)
+        goto error;
 
     output_len = PyUnicode_GET_SIZE(output);
     if (self->pendingcr && (final || output_len > 0)) {
@@ -396,11 +402,12 @@ _PyIncrementalNewlineDecoder_decode(PyObject *_self,
             PyObject *translated = NULL;
             Py_UNICODE *out_str;
             Py_UNICODE *in, *out, *end;
-            if (Py_REFCNT(output) != 1) {
+            if (Py_REFCNT(output) != 1 || _PyUnicode_KIND(output)) {
                 /* We could try to optimize this so that we only do a copy
                    when there is something to translate. On the other hand,
                    most decoders should only output non-shared strings, i.e.
-                   translation is done in place. */
+                   translation is done in place, unless the characters are
+                   compact, and their Py_UNICODE buffer is a copy. */
                 translated = PyUnicode_FromUnicode(NULL, len);
                 if (translated == NULL)
                     goto error;
@@ -463,12 +470,14 @@ static PyObject *
 incrementalnewlinedecoder_decode(nldecoder_object *self,
                                  PyObject *args, PyObject *kwds)
 {
-    char *kwlist[] = {"input", "final", NULL};
+    static const char * const kwlist[] = {"input", "final", NULL};
+    static _PyArg_Parser _parser = {"O|i:IncrementalNewlineDecoder",
+                                    kwlist, 0};
     PyObject *input;
     int final = 0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|i:IncrementalNewlineDecoder",
-                                     kwlist, &input, &final))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &input, &final))
         return NULL;
     return _PyIncrementalNewlineDecoder_decode((PyObject *) self, input, final);
 }
@@ -807,9 +816,10 @@ static encodefuncentry encodefuncs[] = {
 static int
 textiowrapper_init(textio *self, PyObject *args, PyObject *kwds)
 {
-    char *kwlist[] = {"buffer", "encoding", "errors",
-                      "newline", "line_buffering",
-                      NULL};
+    static const char * const kwlist[] = {"buffer", "encoding", "errors",
+                                          "newline", "line_buffering",
+                                          NULL};
+    static _PyArg_Parser _parser = {"O|zzzi:fileio", kwlist, 0};
     PyObject *buffer, *raw;
     char *encoding = NULL;
     char *errors = NULL;
@@ -821,9 +831,9 @@ textiowrapper_init(textio *self, PyObject *args, PyObject *kwds)
 
     self->ok = 0;
     self->detached = 0;
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|zzzi:fileio",
-                                     kwlist, &buffer, &encoding, &errors,
-                                     &newline, &line_buffering))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &buffer, &encoding, &errors,
+                                          &newline, &line_buffering))
         return -1;
 
     if (newline && newline[0] != '\0'
@@ -1235,6 +1245,9 @@ textiowrapper_write(textio *self, PyObject *args)
         return NULL;
     }
 
+    /* findchar() and the encodefuncs read the wide characters */
+    if (PyUnicode_AS_UNICODE(text) == NULL)
+        return NULL;
     Py_INCREF(text);
 
     textlen = PyUnicode_GetSize(text);
@@ -1337,6 +1350,8 @@ textiowrapper_get_decoded_chars(textio *self, Py_ssize_t n)
         n = avail;
 
     if (self->decoded_chars_used > 0 || n < avail) {
+        if (PyUnicode_AS_UNICODE(self->decoded_chars) == NULL)
+            return NULL;
         chars = PyUnicode_FromUnicode(
             PyUnicode_AS_UNICODE(self->decoded_chars)
             + self->decoded_chars_used, n);
@@ -1698,6 +1713,8 @@ _textiowrapper_readline(textio *self, Py_ssize_t limit)
         }
 
         ptr = PyUnicode_AS_UNICODE(line);
+        if (ptr == NULL)
+            goto error;
         line_len = PyUnicode_GET_SIZE(line);
 
         endpos = _PyIO_find_line_ending(
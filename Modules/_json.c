@@ -209,6 +209,8 @@ ascii_escape_unicode(PyObject *pystr)
 
     input_chars = PyUnicode_GET_SIZE(pystr);
     input_unicode = PyUnicode_AS_UNICODE(pystr);
+    if (input_unicode == NULL)
+        return NULL;
 
     /* One char input can be up to 6 chars output, estimate 4 of these */
     output_size = 2 + (MIN_EXPANSION * 4) + input_chars;
@@ -607,7 +609,10 @@ scanstring_unicode(PyObject *pystr, Py_ssize_t end, int strict, Py_ssize_t *next
     Py_ssize_t begin = end - 1;
     Py_ssize_t next;
     const Py_UNICODE *buf = PyUnicode_AS_UNICODE(pystr);
-    PyObject *chunks = PyList_New(0);
+    PyObject *chunks;
+    if (buf == NULL)
+        return NULL;
+    chunks = PyList_New(0);
     if (chunks == NULL) {
         goto bail;
     }
@@ -1578,6 +1583,8 @@ scan_once_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ssize_
     PyObject *res;
     Py_UNICODE *str = PyUnicode_AS_UNICODE(pystr);
     Py_ssize_t length = PyUnicode_GET_SIZE(pystr);
+    if (str == NULL)
+        return NULL;
     if (idx >= length) {
         PyErr_SetNone(PyExc_StopIteration);
         return NULL;
@@ -1659,11 +1666,12 @@ scanner_call(PyObject *self, PyObject *args, PyObject *kwds)
     PyObject *rval;
     Py_ssize_t idx;
     Py_ssize_t next_idx = -1;
-    static char *kwlist[] = {"string", "idx", NULL};
+    static const char * const kwlist[] = {"string", "idx", NULL};
+    static _PyArg_Parser _parser = {"OO&:scan_once", kwlist, 0};
     PyScannerObject *s;
     assert(PyScanner_Check(self));
     s = (PyScannerObject *)self;
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO&:scan_once", kwlist, &pystr, _convertPyInt_AsSsize_t, &idx))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser, &pystr, _convertPyInt_AsSsize_t, &idx))
         return NULL;
 
     if (PyString_Check(pystr)) {
@@ -1703,13 +1711,14 @@ scanner_init(PyObject *self, PyObject *args, PyObject *kwds)
 {
     /* Initialize Scanner object */
     PyObject *ctx;
-    static char *kwlist[] = {"context", NULL};
+    static const char * const kwlist[] = {"context", NULL};
+    static _PyArg_Parser _parser = {"O:make_scanner", kwlist, 0};
     PyScannerObject *s;
 
     assert(PyScanner_Check(self));
     s = (PyScannerObject *)self;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O:make_scanner", kwlist, &ctx))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser, &ctx))
         return -1;
 
     /* PyString_AS_STRING is used on encoding */
@@ -1836,7 +1845,8 @@ static int
 encoder_init(PyObject *self, PyObject *args, PyObject *kwds)
 {
     /* initialize Encoder object */
-    static char *kwlist[] = {"markers", "default", "encoder", "indent", "key_separator", "item_separator", "sort_keys", "skipkeys", "allow_nan", NULL};
+    static const char * const kwlist[] = {"markers", "default", "encoder", "indent", "key_separator", "item_separator", "sort_keys", "skipkeys", "allow_nan", NULL};
+    static _PyArg_Parser _parser = {"OOOOOOOOO:make_encoder", kwlist, 0};
 
     PyEncoderObject *s;
     PyObject *markers, *defaultfn, *encoder, *indent, *key_separator;
@@ -1845,7 +1855,7 @@ encoder_init(PyObject *self, PyObject *args, PyObject *kwds)
     assert(PyEncoder_Check(self));
     s = (PyEncoderObject *)self;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOOOOOOOO:make_encoder", kwlist,
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
         &markers, &defaultfn, &encoder, &indent, &key_separator, &item_separator,
         &sort_keys, &skipkeys, &allow_nan))
         return -1;
@@ -1876,14 +1886,15 @@ static PyObject *
 encoder_call(PyObject *self, PyObject *args, PyObject *kwds)
 {
     /* Python callable interface to encode_listencode_obj */
-    static char *kwlist[] = {"obj", "_current_indent_level", NULL};
+    static const char * const kwlist[] = {"obj", "_current_indent_level", NULL};
+    static _PyArg_Parser _parser = {"OO&:_iterencode", kwlist, 0};
     PyObject *obj;
     PyObject *rval;
     Py_ssize_t indent_level;
     PyEncoderObject *s;
     assert(PyEncoder_Check(self));
     s = (PyEncoderObject *)self;
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO&:_iterencode", kwlist,
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
         &obj, _convertPyInt_AsSsize_t, &indent_level))
         return NULL;
     rval = PyList_New(0);
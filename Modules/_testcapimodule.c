@@ -856,6 +856,43 @@ static PyObject *getargs_keywords(PyObject *self, PyObject *args, PyObject *kwar
         int_args[5], int_args[6], int_args[7], int_args[8], int_args[9]);
 }
 
+/* The same with a static parser, for a tuple and a dict of arguments */
+static PyObject *
+getargs_keywords_fast(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static const char * const keywords[] = {"arg1", "arg2", "arg3",
+                                            "arg4", "arg5", NULL};
+    static _PyArg_Parser parser = {"(ii)i|(i(ii))(iii)i", keywords, 0};
+    int int_args[10]={-1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwargs, &parser,
+        &int_args[0], &int_args[1], &int_args[2], &int_args[3], &int_args[4],
+        &int_args[5], &int_args[6], &int_args[7], &int_args[8], &int_args[9]))
+        return NULL;
+    return Py_BuildValue("iiiiiiiiii",
+        int_args[0], int_args[1], int_args[2], int_args[3], int_args[4],
+        int_args[5], int_args[6], int_args[7], int_args[8], int_args[9]);
+}
+
+/* ... and for the arguments of a METH_FASTCALL function */
+static PyObject *
+getargs_keywords_stack(PyObject *self, PyObject **args, Py_ssize_t nargs,
+                       PyObject *kwnames)
+{
+    static const char * const keywords[] = {"arg1", "arg2", "arg3",
+                                            "arg4", "arg5", NULL};
+    static _PyArg_Parser parser = {"(ii)i|(i(ii))(iii)i", keywords, 0};
+    int int_args[10]={-1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+
+    if (!_PyArg_ParseStack(args, nargs, kwnames, &parser,
+        &int_args[0], &int_args[1], &int_args[2], &int_args[3], &int_args[4],
+        &int_args[5], &int_args[6], &int_args[7], &int_args[8], &int_args[9]))
+        return NULL;
+    return Py_BuildValue("iiiiiiiiii",
+        int_args[0], int_args[1], int_args[2], int_args[3], int_args[4],
+        int_args[5], int_args[6], int_args[7], int_args[8], int_args[9]);
+}
+
 /* Functions to call PyArg_ParseTuple with integer format codes,
    and return the result.
 */
@@ -1383,6 +1420,154 @@ test_thread_state(PyObject *self, PyObject *args)
     Py_RETURN_NONE;
 }
 
+#ifdef PYMALLOC_TCACHE
+
+/* test_pymem_threads has several threads hammer the PyMem_ and PyObject_
+ * allocators at once without holding the GIL, each checking that no other
+ * thread scribbles over its blocks.  Every thread also frees blocks that
+ * the main thread allocated, so blocks move between thread caches.
+ */
+#define PYMEM_NTHREADS  4
+#define PYMEM_ROUNDS    50
+#define PYMEM_NBLOCKS   1000
+
+struct pymem_worker {
+    PyThread_type_lock done;
+    unsigned char **foreign;    /* allocated by the main thread */
+    int id;
+    int failed;
+};
+
+static int
+pymem_check(unsigned char *p, size_t n, unsigned char c)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+        if (p[i] != c)
+            return 0;
+    return 1;
+}
+
+static void
+pymem_thread(void *arg)
+{
+    struct pymem_worker *w = (struct pymem_worker *)arg;
+    unsigned char **blocks;
+    int round, i;
+
+    blocks = (unsigned char **)malloc(PYMEM_NBLOCKS * sizeof(*blocks));
+    if (blocks == NULL) {
+        w->failed = 1;
+        goto done;
+    }
+    for (round = 0; round < PYMEM_ROUNDS && !w->failed; ++round) {
+        int nblocks;
+
+        for (nblocks = 0; nblocks < PYMEM_NBLOCKS; ++nblocks) {
+            size_t n = (size_t)(nblocks * 7 + round) % 300 + 1;
+            unsigned char *p;
+            if (nblocks & 1)
+                p = (unsigned char *)PyMem_Malloc(n);
+            else
+                p = (unsigned char *)PyObject_Malloc(n);
+            if (p == NULL) {
+                w->failed = 1;
+                break;
+            }
+            memset(p, (unsigned char)(w->id * 64 + nblocks), n);
+            blocks[nblocks] = p;
+        }
+        /* Free every other block first, then grow the rest. */
+        for (i = 0; i < nblocks; i += 2) {
+            size_t n = (size_t)(i * 7 + round) % 300 + 1;
+            if (!pymem_check(blocks[i], n, (unsigned char)(w->id * 64 + i)))
+                w->failed = 1;
+            PyObject_Free(blocks[i]);
+        }
+        for (i = 1; i < nblocks; i += 2) {
+            size_t n = (size_t)(i * 7 + round) % 300 + 1;
+            unsigned char *p = (unsigned char *)PyMem_Realloc(blocks[i],
+                                                              n + 40);
+            if (p == NULL) {
+                w->failed = 1;
+                p = blocks[i];
+            }
+            else if (!pymem_check(p, n, (unsigned char)(w->id * 64 + i)))
+                w->failed = 1;
+            PyMem_Free(p);
+        }
+    }
+    free(blocks);
+  done:
+    for (i = 0; i < PYMEM_NBLOCKS; ++i) {
+        if (!pymem_check(w->foreign[i], 16, (unsigned char)w->id))
+            w->failed = 1;
+        PyMem_Free(w->foreign[i]);
+    }
+    PyThread_release_lock(w->done);
+}
+
+static PyObject *
+test_pymem_threads(PyObject *self)
+{
+    struct pymem_worker workers[PYMEM_NTHREADS];
+    unsigned char *foreign[PYMEM_NTHREADS][PYMEM_NBLOCKS];
+    int i, j, started = 0, failed = 0;
+
+    for (i = 0; i < PYMEM_NTHREADS; ++i) {
+        workers[i].id = i;
+        workers[i].failed = 0;
+        workers[i].foreign = foreign[i];
+        for (j = 0; j < PYMEM_NBLOCKS; ++j) {
+            foreign[i][j] = (unsigned char *)PyMem_Malloc(16);
+            if (foreign[i][j] == NULL) {
+                while (--j >= 0)
+                    PyMem_Free(foreign[i][j]);
+                goto nomemory;
+            }
+            memset(foreign[i][j], i, 16);
+        }
+        workers[i].done = PyThread_allocate_lock();
+        if (workers[i].done == NULL) {
+            for (j = 0; j < PYMEM_NBLOCKS; ++j)
+                PyMem_Free(foreign[i][j]);
+            goto nomemory;
+        }
+        PyThread_acquire_lock(workers[i].done, 1);
+        ++started;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    for (i = 0; i < started; ++i) {
+        if (PyThread_start_new_thread(pymem_thread, &workers[i]) == -1)
+            pymem_thread(&workers[i]);
+    }
+    for (i = 0; i < started; ++i) {
+        PyThread_acquire_lock(workers[i].done, 1);
+        PyThread_release_lock(workers[i].done);
+        PyThread_free_lock(workers[i].done);
+        failed |= workers[i].failed;
+    }
+    Py_END_ALLOW_THREADS
+
+    if (failed)
+        return raiseTestError("test_pymem_threads",
+                              "blocks were corrupted by another thread");
+    Py_RETURN_NONE;
+
+  nomemory:
+    for (i = 0; i < started; ++i) {
+        PyThread_release_lock(workers[i].done);
+        PyThread_free_lock(workers[i].done);
+        for (j = 0; j < PYMEM_NBLOCKS; ++j)
+            PyMem_Free(foreign[i][j]);
+    }
+    return PyErr_NoMemory();
+}
+
+#endif /* PYMALLOC_TCACHE */
+
 /* test Py_AddPendingCalls using threads */
 static int _pending_callback(void *arg)
 {
@@ -1709,6 +1894,10 @@ static PyMethodDef TestMethods[] = {
     {"getargs_tuple",           getargs_tuple,                   METH_VARARGS},
     {"getargs_keywords", (PyCFunction)getargs_keywords,
       METH_VARARGS|METH_KEYWORDS},
+    {"getargs_keywords_fast", (PyCFunction)getargs_keywords_fast,
+      METH_VARARGS|METH_KEYWORDS},
+    {"getargs_keywords_stack", (PyCFunction)getargs_keywords_stack,
+      METH_FASTCALL},
     {"getargs_b",               getargs_b,                       METH_VARARGS},
     {"getargs_B",               getargs_B,                       METH_VARARGS},
     {"getargs_h",               getargs_h,                       METH_VARARGS},
@@ -1738,6 +1927,9 @@ static PyMethodDef TestMethods[] = {
 #ifdef WITH_THREAD
     {"_test_thread_state",  test_thread_state,                   METH_VARARGS},
     {"_pending_threadfunc",     pending_threadfunc,              METH_VARARGS},
+#endif
+#ifdef PYMALLOC_TCACHE
+    {"test_pymem_threads",      (PyCFunction)test_pymem_threads, METH_NOARGS},
 #endif
     {"test_capsule", (PyCFunction)test_capsule, METH_NOARGS},
     {"traceback_print", traceback_print,                 METH_VARARGS},
@@ -960,6 +960,10 @@ BZ2File_writelines(BZ2FileObject *self, PyObject *seq)
                 Py_DECREF(v);
                 PyList_SET_ITEM(list, i, line);
             }
+            else
+                /* copy in the characters of a lazy string while
+                   the lock is still held */
+                (void)PyString_AS_STRING(v);
         }
 
         self->f_softspace = 0;
@@ -1378,6 +1378,8 @@ save_unicode(Picklerobject *self, PyObject *args, int doput)
         char *repr_str;
         static char string = UNICODE;
 
+        if (PyUnicode_AS_UNICODE(args) == NULL)
+            return -1;
         repr = modified_EncodeRawUnicodeEscape(
             PyUnicode_AS_UNICODE(args), PyUnicode_GET_SIZE(args));
         if (!repr)
@@ -3091,7 +3093,8 @@ newPicklerobject(PyObject *file, int proto)
 static PyObject *
 get_Pickler(PyObject *self, PyObject *args, PyObject *kwds)
 {
-    static char *kwlist[] = {"file", "protocol", NULL};
+    static const char * const kwlist[] = {"file", "protocol", NULL};
+    static _PyArg_Parser _parser = {"O|i:Pickler", kwlist, 0};
     PyObject *file = NULL;
     int proto = 0;
 
@@ -3105,8 +3108,8 @@ get_Pickler(PyObject *self, PyObject *args, PyObject *kwds)
     if (!PyArg_ParseTuple(args, "|i:Pickler", &proto)) {
         PyErr_Clear();
         proto = 0;
-        if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|i:Pickler",
-                    kwlist, &file, &proto))
+        if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                              &file, &proto))
             return NULL;
     }
     return (PyObject *)newPicklerobject(file, proto);
@@ -5640,12 +5643,13 @@ Unpickler_setattr(Unpicklerobject *self, char *name, PyObject *value)
 static PyObject *
 cpm_dump(PyObject *self, PyObject *args, PyObject *kwds)
 {
-    static char *kwlist[] = {"obj", "file", "protocol", NULL};
+    static const char * const kwlist[] = {"obj", "file", "protocol", NULL};
+    static _PyArg_Parser _parser = {"OO|i", kwlist, 0};
     PyObject *ob, *file, *res = NULL;
     Picklerobject *pickler = 0;
     int proto = 0;
 
-    if (!( PyArg_ParseTupleAndKeywords(args, kwds, "OO|i", kwlist,
+    if (!( _PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
                &ob, &file, &proto)))
         goto finally;
 
@@ -5669,12 +5673,13 @@ cpm_dump(PyObject *self, PyObject *args, PyObject *kwds)
 static PyObject *
 cpm_dumps(PyObject *self, PyObject *args, PyObject *kwds)
 {
-    static char *kwlist[] = {"obj", "protocol", NULL};
+    static const char * const kwlist[] = {"obj", "protocol", NULL};
+    static _PyArg_Parser _parser = {"O|i:dumps", kwlist, 0};
     PyObject *ob, *file = 0, *res = NULL;
     Picklerobject *pickler = 0;
     int proto = 0;
 
-    if (!( PyArg_ParseTupleAndKeywords(args, kwds, "O|i:dumps", kwlist,
+    if (!( _PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
                &ob, &proto)))
         goto finally;
 
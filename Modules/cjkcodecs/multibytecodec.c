@@ -319,6 +319,8 @@ multibytecodec_encerror(MultibyteCodec *codec,
     {
         const Py_UNICODE *uraw = PyUnicode_AS_UNICODE(tobj);
 
+        if (uraw == NULL)
+            goto errorexit;
         retstr = multibytecodec_encode(codec, state, &uraw,
                         PyUnicode_GET_SIZE(tobj), ERROR_STRICT,
                         MBENC_FLUSH);
@@ -566,6 +568,10 @@ MultibyteCodec_Encode(MultibyteCodecObject *self,
     }
 
     data = PyUnicode_AS_UNICODE(arg);
+    if (data == NULL) {
+        Py_XDECREF(ucvt);
+        return NULL;
+    }
     datalen = PyUnicode_GET_SIZE(arg);
 
     errorcb = internal_error_callback(errors);
@@ -748,6 +754,8 @@ encoder_encode_stateful(MultibyteStatefulEncoderContext *ctx,
             return NULL;
         }
     }
+    if (PyUnicode_AS_UNICODE(unistr) == NULL)
+        goto errorexit;
 
     datalen = PyUnicode_GET_SIZE(unistr);
     origpending = ctx->pendingsize;
@@ -164,17 +164,113 @@ GC_TENTATIVELY_UNREACHABLE
     Only objects with GC_TENTATIVELY_UNREACHABLE still set are candidates
     for collection.  If it's decided not to collect such an object (e.g.,
     it has a __del__ method), its gc_refs is restored to GC_REACHABLE again.
+
+When the oldest generation is collected incrementally, its objects carry
+one of two more values between collections:
+
+GC_OLD_SPACE_A, GC_OLD_SPACE_B
+    Like GC_REACHABLE, but also telling whether the object is still pending
+    in the current incremental pass or has been visited already; see
+    pending_mark and visited_mark below.  Either value may also be seen in
+    a younger generation (a weakref moved there by handle_weakrefs()), and
+    is harmless there.
 ----------------------------------------------------------------------------
 */
 #define GC_UNTRACKED                    _PyGC_REFS_UNTRACKED
 #define GC_REACHABLE                    _PyGC_REFS_REACHABLE
 #define GC_TENTATIVELY_UNREACHABLE      _PyGC_REFS_TENTATIVELY_UNREACHABLE
+#define GC_OLD_SPACE_A                  (-5)
+#define GC_OLD_SPACE_B                  (-6)
 
+#define IS_OLD_MARK(refs) ((refs) == GC_OLD_SPACE_A || (refs) == GC_OLD_SPACE_B)
 #define IS_TRACKED(o) ((AS_GC(o))->gc.gc_refs != GC_UNTRACKED)
-#define IS_REACHABLE(o) ((AS_GC(o))->gc.gc_refs == GC_REACHABLE)
+#define IS_REACHABLE(o) ((AS_GC(o))->gc.gc_refs == GC_REACHABLE || \
+                         IS_OLD_MARK((AS_GC(o))->gc.gc_refs))
 #define IS_TENTATIVELY_UNREACHABLE(o) ( \
     (AS_GC(o))->gc.gc_refs == GC_TENTATIVELY_UNREACHABLE)
 
+/*--------------------------------------------------------------------------
+Incremental collection of the oldest generation.
+
+The cost of a full collection is proportional to the number of long-lived
+objects, and the whole of it is a single pause.  When a pause budget is set
+(gc.set_pause_budget()), the collections of the oldest generation are
+instead done in slices ("increments"), each sized to fit in the budget.
+
+The oldest generation is then kept in two lists: GEN_HEAD(2) holds the
+objects still pending in the current pass, old_visited those that a slice
+has already examined, plus everything promoted since the pass began.  A
+slice takes the young generations and a set of pending objects, grown
+breadth-first from the oldest pending object along its references into
+other pending objects, and runs the usual algorithm on that set.  Objects
+outside the set act as external roots, so a slice is exactly as safe as a
+collection of a young generation.  Each slice recomputes the refcounts it
+needs from scratch, so nothing has to be tracked between slices and no
+write barrier is needed: mutations made in between are simply seen by the
+slice that next examines the objects involved.
+
+A garbage cycle is found when all of it falls into one slice, which is what
+following the references from the seeds achieves: a slice only takes
+whole closures, and a seed whose closure doesn't fit in what is left of the
+size limit waits for the next slice.  Only a first seed can be cut short,
+when its closure alone is bigger than the limit; since garbage is not
+reachable from live objects, that can only split a garbage cycle when the
+garbage itself leads to that many pending objects.  Such cycles may wait
+for a later pass, in which the large live structures they point to have
+usually been visited already; a cycle bigger than the limit can't be
+found by a slice at all.  So, once some slice was cut short, a full
+collection still runs when the objects promoted into the oldest generation
+since the last one outnumber those that survived it: the garbage the
+slices miss can't grow without bound, and a program whose old generation
+doesn't keep growing never pays for it.  gc.collect() always does a full
+collection too.  Once nothing is left pending the pass is over, and the
+visited objects become the pending ones of the next pass.
+
+Whether an old object is pending or visited is told by its gc_refs: the
+two marks swap meaning at the end of a pass, which relabels the whole
+visited list at once.  Objects without a mark in the pending list (e.g.
+when the budget has just been set) are still examined, as seeds.
+----------------------------------------------------------------------------
+*/
+
+/* seconds; 0 means the oldest generation is collected all at once */
+static double pause_budget = 0.0;
+
+static PyGC_Head old_visited = {{&old_visited, &old_visited, 0}};
+
+static Py_ssize_t pending_mark = GC_OLD_SPACE_A;
+static Py_ssize_t visited_mark = GC_OLD_SPACE_B;
+
+/* measured cost of a slice per object taken */
+static double secs_per_object = 0.0;
+
+/* Whether a slice was cut short in the current pass, and since the last
+ * full collection (or pass that counted as one).
+ */
+static int pass_truncated = 0;
+static int truncated_since_full = 0;
+
+/* objects moved to the visited list by the slices of the current pass */
+static Py_ssize_t pass_survivors = 0;
+
+/* smallest size limit of a slice, in objects */
+#define INCREMENT_MIN 1000
+
+/* Collection statistics, reported by gc.get_stats(). */
+struct gc_generation_stats {
+    Py_ssize_t collections;     /* complete collections */
+    Py_ssize_t increments;      /* slices (oldest generation only) */
+    Py_ssize_t passes;          /* completed incremental passes */
+    Py_ssize_t truncated;       /* slices that cut a seed's closure short */
+    Py_ssize_t collected;
+    Py_ssize_t uncollectable;
+    double pause_total;         /* seconds spent in these collections */
+    double pause_max;
+    double pause_last;
+};
+
+static struct gc_generation_stats generation_stats[NUM_GENERATIONS];
+
 /*** list functions ***/
 
 static void
@@ -247,6 +343,21 @@ gc_list_merge(PyGC_Head *from, PyGC_Head *to)
     gc_list_init(from);
 }
 
+/* Move `node` and all the nodes after it in `list` to the end of `to`. */
+static void
+gc_list_split(PyGC_Head *list, PyGC_Head *node, PyGC_Head *to)
+{
+    PyGC_Head *last = list->gc.gc_prev;
+    PyGC_Head *prev = node->gc.gc_prev;
+    assert(node != list);
+    prev->gc.gc_next = list;
+    list->gc.gc_prev = prev;
+    node->gc.gc_prev = to->gc.gc_prev;
+    node->gc.gc_prev->gc.gc_next = node;
+    last->gc.gc_next = to;
+    to->gc.gc_prev = last;
+}
+
 static Py_ssize_t
 gc_list_size(PyGC_Head *list)
 {
@@ -288,7 +399,7 @@ update_refs(PyGC_Head *containers)
 {
     PyGC_Head *gc = containers->gc.gc_next;
     for (; gc != containers; gc = gc->gc.gc_next) {
-        assert(gc->gc.gc_refs == GC_REACHABLE);
+        assert(IS_REACHABLE(FROM_GC(gc)));
         gc->gc.gc_refs = Py_REFCNT(FROM_GC(gc));
         /* Python's cyclic gc should never see an incoming refcount
          * of 0:  if something decref'ed to 0, it should have been
@@ -379,12 +490,13 @@ visit_reachable(PyObject *op, PyGC_Head *reachable)
          * list, and move_unreachable will eventually get to it.
          * If gc_refs == GC_REACHABLE, it's either in some other
          * generation so we don't care about it, or move_unreachable
-         * already dealt with it.
+         * already dealt with it.  The same goes for the old space marks.
          * If gc_refs == GC_UNTRACKED, it must be ignored.
          */
          else {
             assert(gc_refs > 0
                    || gc_refs == GC_REACHABLE
+                   || IS_OLD_MARK(gc_refs)
                    || gc_refs == GC_UNTRACKED);
          }
     }
@@ -815,20 +927,82 @@ get_time(void)
     return result;
 }
 
-/* This is the main function.  Read this to understand how the
- * collection process works. */
-static Py_ssize_t
-collect(int generation)
+/* Wall clock for the pause statistics; unlike get_time() it must not run
+ * any Python code, as it is also used before the gc module is imported.
+ */
+static double
+gc_clock(void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+    struct timeval t;
+#ifdef GETTIMEOFDAY_NO_TZ
+    if (gettimeofday(&t) == 0)
+#else
+    if (gettimeofday(&t, (struct timezone *)NULL) == 0)
+#endif
+        return (double)t.tv_sec + t.tv_usec * 0.000001;
+#endif
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static void
+debug_collecting(char *what)
 {
     int i;
+    PySys_WriteStderr("gc: collecting %s...\n", what);
+    PySys_WriteStderr("gc: objects in each generation:");
+    for (i = 0; i < NUM_GENERATIONS; i++) {
+        Py_ssize_t n = gc_list_size(GEN_HEAD(i));
+        if (i == NUM_GENERATIONS-1)
+            n += gc_list_size(&old_visited);
+        PySys_WriteStderr(" %" PY_FORMAT_SIZE_T "d", n);
+    }
+    PySys_WriteStderr("\n");
+}
+
+static void
+debug_done(Py_ssize_t m, Py_ssize_t n, double t1)
+{
+    double t2 = get_time();
+    if (m == 0 && n == 0)
+        PySys_WriteStderr("gc: done");
+    else
+        PySys_WriteStderr(
+            "gc: done, "
+            "%" PY_FORMAT_SIZE_T "d unreachable, "
+            "%" PY_FORMAT_SIZE_T "d uncollectable",
+            n+m, n);
+    if (t1 && t2) {
+        PySys_WriteStderr(", %.4fs elapsed", t2-t1);
+    }
+    PySys_WriteStderr(".\n");
+}
+
+static void
+record_pause(struct gc_generation_stats *stats, double pause,
+             Py_ssize_t collected, Py_ssize_t uncollectable)
+{
+    stats->collected += collected;
+    stats->uncollectable += uncollectable;
+    stats->pause_total += pause;
+    stats->pause_last = pause;
+    if (pause > stats->pause_max)
+        stats->pause_max = pause;
+}
+
+/* Find the unreachable objects in `young` and reclaim those that can be,
+ * leaving everything else in `old` (which may be `young` itself).
+ * Returns the number of unreachable objects found; *uncollectable is set
+ * to the number of those that couldn't be collected.
+ */
+static Py_ssize_t
+collect_set(PyGC_Head *young, PyGC_Head *old, Py_ssize_t *uncollectable)
+{
     Py_ssize_t m = 0; /* # objects collected */
     Py_ssize_t n = 0; /* # unreachable objects that couldn't be collected */
-    PyGC_Head *young; /* the generation we are examining */
-    PyGC_Head *old; /* next older generation */
     PyGC_Head unreachable; /* non-problematic unreachable trash */
     PyGC_Head finalizers;  /* objects with, & reachable from, __del__ */
     PyGC_Head *gc;
-    double t1 = 0.0;
 
     if (delstr == NULL) {
         delstr = PyString_InternFromString("__del__");
@@ -836,35 +1010,6 @@ collect(int generation)
             Py_FatalError("gc couldn't allocate \"__del__\"");
     }
 
-    if (debug & DEBUG_STATS) {
-        PySys_WriteStderr("gc: collecting generation %d...\n",
-                          generation);
-        PySys_WriteStderr("gc: objects in each generation:");
-        for (i = 0; i < NUM_GENERATIONS; i++)
-            PySys_WriteStderr(" %" PY_FORMAT_SIZE_T "d",
-                              gc_list_size(GEN_HEAD(i)));
-        t1 = get_time();
-        PySys_WriteStderr("\n");
-    }
-
-    /* update collection and allocation counters */
-    if (generation+1 < NUM_GENERATIONS)
-        generations[generation+1].count += 1;
-    for (i = 0; i <= generation; i++)
-        generations[i].count = 0;
-
-    /* merge younger generations with one we are currently collecting */
-    for (i = 0; i < generation; i++) {
-        gc_list_merge(GEN_HEAD(i), GEN_HEAD(generation));
-    }
-
-    /* handy references */
-    young = GEN_HEAD(generation);
-    if (generation < NUM_GENERATIONS-1)
-        old = GEN_HEAD(generation+1);
-    else
-        old = young;
-
     /* Using ob_refcnt and gc_refs, calculate which objects in the
      * container set are reachable from outside the set (i.e., have a
      * refcount greater than 0 when all the references within the
@@ -883,16 +1028,8 @@ collect(int generation)
     move_unreachable(young, &unreachable);
 
     /* Move reachable objects to next generation. */
-    if (young != old) {
-        if (generation == NUM_GENERATIONS - 2) {
-            long_lived_pending += gc_list_size(young);
-        }
+    if (young != old)
         gc_list_merge(young, old);
-    }
-    else {
-        long_lived_pending = 0;
-        long_lived_total = gc_list_size(young);
-    }
 
     /* All objects in unreachable are trash, but objects reachable from
      * finalizers can't safely be deleted.  Python programmers should take
@@ -938,21 +1075,6 @@ collect(int generation)
         if (debug & DEBUG_UNCOLLECTABLE)
             debug_cycle("uncollectable", FROM_GC(gc));
     }
-    if (debug & DEBUG_STATS) {
-        double t2 = get_time();
-        if (m == 0 && n == 0)
-            PySys_WriteStderr("gc: done");
-        else
-            PySys_WriteStderr(
-                "gc: done, "
-                "%" PY_FORMAT_SIZE_T "d unreachable, "
-                "%" PY_FORMAT_SIZE_T "d uncollectable",
-                n+m, n);
-        if (t1 && t2) {
-            PySys_WriteStderr(", %.4fs elapsed", t2-t1);
-        }
-        PySys_WriteStderr(".\n");
-    }
 
     /* Append instances in the uncollectable set to a Python
      * reachable list of garbage.  The programmer has to deal with
@@ -960,19 +1082,327 @@ collect(int generation)
      */
     (void)handle_finalizers(&finalizers, old);
 
-    /* Clear free list only during the collection of the highest
-     * generation */
-    if (generation == NUM_GENERATIONS-1) {
-        clear_freelists();
-    }
+    *uncollectable = n;
+    return n+m;
+}
 
+static void
+check_collect_error(void)
+{
     if (PyErr_Occurred()) {
         if (gc_str == NULL)
             gc_str = PyString_FromString("garbage collection");
         PyErr_WriteUnraisable(gc_str);
         Py_FatalError("unexpected exception during garbage collection");
     }
-    return n+m;
+}
+
+/* Move the survivors of a collection of generation 1 into the oldest
+ * generation, and return their number.  In incremental mode they join the
+ * visited objects, so that a pass only ever scans what it started with.
+ */
+static Py_ssize_t
+promote(PyGC_Head *survivors)
+{
+    Py_ssize_t n = 0;
+    PyGC_Head *gc;
+
+    if (pause_budget > 0.0) {
+        for (gc = survivors->gc.gc_next; gc != survivors;
+             gc = gc->gc.gc_next) {
+            gc->gc.gc_refs = visited_mark;
+            n++;
+        }
+        gc_list_merge(survivors, &old_visited);
+        pass_survivors += n;
+    }
+    else {
+        n = gc_list_size(survivors);
+        gc_list_merge(survivors, GEN_HEAD(NUM_GENERATIONS-1));
+    }
+    return n;
+}
+
+/* This is the main function.  Read this to understand how the
+ * collection process works. */
+static Py_ssize_t
+collect(int generation)
+{
+    int i;
+    Py_ssize_t n; /* # unreachable objects that couldn't be collected */
+    Py_ssize_t unreachable; /* # unreachable objects found */
+    PyGC_Head *young; /* the generation we are examining */
+    PyGC_Head *old; /* where the survivors go */
+    PyGC_Head survivors;
+    double t1 = 0.0;
+    double start = gc_clock();
+
+    if (debug & DEBUG_STATS) {
+        char what[40];
+        PyOS_snprintf(what, sizeof(what), "generation %d", generation);
+        debug_collecting(what);
+        t1 = get_time();
+    }
+
+    /* update collection and allocation counters */
+    if (generation+1 < NUM_GENERATIONS)
+        generations[generation+1].count += 1;
+    for (i = 0; i <= generation; i++)
+        generations[i].count = 0;
+
+    /* merge younger generations with one we are currently collecting */
+    for (i = 0; i < generation; i++) {
+        gc_list_merge(GEN_HEAD(i), GEN_HEAD(generation));
+    }
+    if (generation == NUM_GENERATIONS-1) {
+        /* a full collection ends any incremental pass */
+        gc_list_merge(&old_visited, GEN_HEAD(generation));
+        truncated_since_full = 0;
+        pass_truncated = 0;
+        pass_survivors = 0;
+    }
+
+    /* handy references */
+    young = GEN_HEAD(generation);
+    if (generation < NUM_GENERATIONS-1) {
+        gc_list_init(&survivors);
+        old = &survivors;
+    }
+    else
+        old = young;
+
+    unreachable = collect_set(young, old, &n);
+
+    if (generation == NUM_GENERATIONS - 2) {
+        long_lived_pending += promote(&survivors);
+    }
+    else if (young != old) {
+        gc_list_merge(&survivors, GEN_HEAD(generation+1));
+    }
+    else {
+        long_lived_pending = 0;
+        if (pause_budget > 0.0)
+            long_lived_total = promote(young);
+        else
+            long_lived_total = gc_list_size(young);
+    }
+
+    if (debug & DEBUG_STATS)
+        debug_done(unreachable - n, n, t1);
+
+    /* Clear free list only during the collection of the highest
+     * generation */
+    if (generation == NUM_GENERATIONS-1) {
+        clear_freelists();
+    }
+
+    generation_stats[generation].collections++;
+    record_pause(&generation_stats[generation], gc_clock() - start,
+                 unreachable - n, n);
+
+    check_collect_error();
+    return unreachable;
+}
+
+struct expand_state {
+    PyGC_Head *list;            /* where taken objects go */
+    Py_ssize_t taken;
+    Py_ssize_t limit;
+    int full;                   /* a pending referent had to be left out */
+};
+
+/* A traversal callback for take_increment. */
+static int
+visit_expand(PyObject *op, struct expand_state *state)
+{
+    if (PyObject_IS_GC(op)) {
+        PyGC_Head *gc = AS_GC(op);
+        if (gc->gc.gc_refs == pending_mark) {
+            if (state->taken >= state->limit) {
+                state->full = 1;
+                return 1;
+            }
+            gc_list_move(gc, state->list);
+            gc->gc.gc_refs = GC_REACHABLE;
+            state->taken++;
+        }
+    }
+    return 0;
+}
+
+/* Move the next slice of the pending list to `increment`: the oldest
+ * pending object (the seed), the pending objects it refers to, those they
+ * refer to, and so on, then the next seed and everything it leads to, as
+ * long as they fit in `limit` objects.  A seed whose pending closure
+ * doesn't fit is put back with it, unless it is the first one, which is
+ * then cut short; *truncated tells whether that happened.  Returns the
+ * number of objects taken.
+ */
+static Py_ssize_t
+take_increment(PyGC_Head *increment, Py_ssize_t limit, int *truncated)
+{
+    PyGC_Head *pending = GEN_HEAD(NUM_GENERATIONS-1);
+    PyGC_Head taken;
+    PyGC_Head rollback;
+    PyGC_Head *gc;
+    PyGC_Head *seed = NULL;
+    struct expand_state state;
+
+    gc_list_init(&taken);
+    state.list = &taken;
+    state.taken = 0;
+    state.limit = limit;
+    state.full = 0;
+    *truncated = 0;
+
+    /* gc is the next object in taken whose references to follow */
+    gc = &taken;
+    for (;;) {
+        PyObject *op;
+        if (gc == &taken) {
+            if (state.taken >= limit || gc_list_is_empty(pending))
+                break;
+            gc = pending->gc.gc_next;
+            seed = state.taken ? gc : NULL;
+            gc_list_move(gc, &taken);
+            gc->gc.gc_refs = GC_REACHABLE;
+            state.taken++;
+        }
+        op = FROM_GC(gc);
+        (void) Py_TYPE(op)->tp_traverse(op, (visitproc)visit_expand,
+                                        (void *)&state);
+        if (state.full)
+            break;
+        gc = gc->gc.gc_next;
+    }
+
+    if (state.full) {
+        if (seed == NULL)
+            *truncated = 1;
+        else {
+            /* Put the last seed and what it led to back where they were. */
+            gc_list_init(&rollback);
+            gc_list_split(&taken, seed, &rollback);
+            for (gc = rollback.gc.gc_next; gc != &rollback;
+                 gc = gc->gc.gc_next) {
+                gc->gc.gc_refs = pending_mark;
+                state.taken--;
+            }
+            gc_list_merge(pending, &rollback);
+            gc_list_merge(&rollback, pending);
+        }
+    }
+    gc_list_merge(&taken, increment);
+    return state.taken;
+}
+
+/* How many pending objects the next slice may take, given that `young`
+ * objects will be collected along with them.
+ */
+static Py_ssize_t
+increment_limit(Py_ssize_t young)
+{
+    double limit = INCREMENT_MIN;
+
+    if (secs_per_object > 0.0 &&
+        pause_budget / secs_per_object - young > limit)
+        limit = pause_budget / secs_per_object - young;
+    if (limit > (double)(PY_SSIZE_T_MAX / 2))
+        return PY_SSIZE_T_MAX / 2;
+    return (Py_ssize_t)limit;
+}
+
+/* Collect the young generations together with the next slice of the
+ * oldest one.  See "Incremental collection of the oldest generation" at
+ * the top of this file.
+ */
+static Py_ssize_t
+collect_increment(void)
+{
+    int i;
+    PyGC_Head *pending = GEN_HEAD(NUM_GENERATIONS-1);
+    PyGC_Head increment; /* the set being collected */
+    PyGC_Head survivors;
+    PyGC_Head *gc;
+    Py_ssize_t young, taken, n, unreachable;
+    Py_ssize_t nsurvivors = 0;
+    int truncated;
+    struct gc_generation_stats *stats = &generation_stats[NUM_GENERATIONS-1];
+    double t1 = 0.0;
+    double start = gc_clock();
+    double pause;
+
+    if (debug & DEBUG_STATS) {
+        debug_collecting("an increment of the oldest generation");
+        t1 = get_time();
+    }
+
+    for (i = 0; i < NUM_GENERATIONS; i++)
+        generations[i].count = 0;
+
+    gc_list_init(&increment);
+    for (i = 0; i < NUM_GENERATIONS-1; i++)
+        gc_list_merge(GEN_HEAD(i), &increment);
+    young = gc_list_size(&increment);
+    taken = take_increment(&increment, increment_limit(young), &truncated);
+    if (truncated) {
+        stats->truncated++;
+        pass_truncated = 1;
+    }
+
+    gc_list_init(&survivors);
+    unreachable = collect_set(&increment, &survivors, &n);
+
+    for (gc = survivors.gc.gc_next; gc != &survivors; gc = gc->gc.gc_next) {
+        gc->gc.gc_refs = visited_mark;
+        nsurvivors++;
+    }
+    gc_list_merge(&survivors, &old_visited);
+    pass_survivors += nsurvivors;
+    if (nsurvivors > taken)
+        long_lived_pending += nsurvivors - taken;
+
+    if (gc_list_is_empty(pending)) {
+        /* The pass is over; what was visited is pending again.  Unless
+         * a slice was cut short, the pass found all the garbage a full
+         * collection would have, and counts as one for the heuristic
+         * in collect_generations().  The very first pass counts
+         * anyway, to give that heuristic something to start from.
+         */
+        Py_ssize_t mark = pending_mark;
+        gc_list_merge(&old_visited, pending);
+        pending_mark = visited_mark;
+        visited_mark = mark;
+        if (!pass_truncated || long_lived_total == 0) {
+            long_lived_total = pass_survivors;
+            long_lived_pending = 0;
+            truncated_since_full = 0;
+        }
+        truncated_since_full |= pass_truncated;
+        pass_truncated = 0;
+        pass_survivors = 0;
+        stats->passes++;
+    }
+
+    if (debug & DEBUG_STATS)
+        debug_done(unreachable - n, n, t1);
+
+    pause = gc_clock() - start;
+    /* A slice cut short is dominated by its one oversized seed, which
+     * says little about the next slices.
+     */
+    if (!truncated && young + taken > 0) {
+        double sample = pause / (young + taken);
+        if (secs_per_object > 0.0)
+            secs_per_object = (3.0 * secs_per_object + sample) / 4.0;
+        else
+            secs_per_object = sample;
+    }
+    stats->increments++;
+    record_pause(stats, pause, unreachable - n, n);
+
+    check_collect_error();
+    return unreachable;
 }
 
 static Py_ssize_t
@@ -986,6 +1416,19 @@ collect_generations(void)
      * generations younger than it will be collected. */
     for (i = NUM_GENERATIONS-1; i >= 0; i--) {
         if (generations[i].count > generations[i].threshold) {
+            /* With a pause budget, the oldest generation is collected a
+               slice at a time, and a slice costs about the same whatever
+               the number of tracked objects.  See the comments about
+               incremental collection for the exception.
+            */
+            if (i == NUM_GENERATIONS - 1 && pause_budget > 0.0) {
+                if (truncated_since_full
+                    && long_lived_pending > long_lived_total)
+                    n = collect(i);
+                else
+                    n = collect_increment();
+                break;
+            }
             /* Avoid quadratic performance degradation in number
                of tracked objects. See comments at the beginning
                of this file, and issue #4074.
@@ -1160,6 +1603,77 @@ gc_get_count(PyObject *self, PyObject *noargs)
                          generations[2].count);
 }
 
+PyDoc_STRVAR(gc_set_pause_budget__doc__,
+"set_pause_budget(seconds) -> None\n"
+"\n"
+"Collect the oldest generation incrementally, in slices meant to take no\n"
+"longer than the given number of seconds each.  Zero (the default) goes\n"
+"back to collecting it all at once.\n");
+
+static PyObject *
+gc_set_pause_budget(PyObject *self, PyObject *args)
+{
+    double budget;
+    if (!PyArg_ParseTuple(args, "d:set_pause_budget", &budget))
+        return NULL;
+    if (!(budget >= 0.0)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "pause budget must be non-negative");
+        return NULL;
+    }
+    pause_budget = budget;
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(gc_get_pause_budget__doc__,
+"get_pause_budget() -> seconds\n"
+"\n"
+"Return the pause budget of incremental collections (0.0 when disabled).\n");
+
+static PyObject *
+gc_get_pause_budget(PyObject *self, PyObject *noargs)
+{
+    return PyFloat_FromDouble(pause_budget);
+}
+
+PyDoc_STRVAR(gc_get_stats__doc__,
+"get_stats() -> [...]\n"
+"\n"
+"Return a list of dictionaries with statistics about the collections of\n"
+"each generation since the interpreter started.\n");
+
+static PyObject *
+gc_get_stats(PyObject *self, PyObject *noargs)
+{
+    int i;
+    PyObject *result;
+
+    result = PyList_New(NUM_GENERATIONS);
+    if (result == NULL)
+        return NULL;
+    for (i = 0; i < NUM_GENERATIONS; i++) {
+        struct gc_generation_stats *st = &generation_stats[i];
+        PyObject *d = Py_BuildValue(
+            "{snsnsnsnsnsnsdsdsd}",
+            "collections", st->collections,
+            "increments", st->increments,
+            "passes", st->passes,
+            "truncated", st->truncated,
+            "collected", st->collected,
+            "uncollectable", st->uncollectable,
+            "pause_total", st->pause_total,
+            "pause_max", st->pause_max,
+            "pause_last", st->pause_last);
+        if (d == NULL) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyList_SET_ITEM(result, i, d);
+    }
+    return result;
+}
+
 static int
 referrersvisit(PyObject* obj, PyObject *objs)
 {
@@ -1206,6 +1720,10 @@ gc_get_referrers(PyObject *self, PyObject *args)
             return NULL;
         }
     }
+    if (!(gc_referrers_for(args, &old_visited, result))) {
+        Py_DECREF(result);
+        return NULL;
+    }
     return result;
 }
 
@@ -1267,6 +1785,10 @@ gc_get_objects(PyObject *self, PyObject *noargs)
             return NULL;
         }
     }
+    if (append_objects(result, &old_visited)) {
+        Py_DECREF(result);
+        return NULL;
+    }
     return result;
 }
 
@@ -1303,6 +1825,9 @@ PyDoc_STRVAR(gc__doc__,
 "get_debug() -- Get debugging flags.\n"
 "set_threshold() -- Set the collection thresholds.\n"
 "get_threshold() -- Return the current the collection thresholds.\n"
+"set_pause_budget() -- Collect the oldest generation in bounded slices.\n"
+"get_pause_budget() -- Return the pause budget of incremental collections.\n"
+"get_stats() -- Return statistics about the collections of each generation.\n"
 "get_objects() -- Return a list of all objects tracked by the collector.\n"
 "is_tracked() -- Returns true if a given object is tracked.\n"
 "get_referrers() -- Return the list of objects that refer to an object.\n"
@@ -1317,6 +1842,11 @@ static PyMethodDef GcMethods[] = {
     {"get_count",          gc_get_count,  METH_NOARGS,  gc_get_count__doc__},
     {"set_threshold",  gc_set_thresh, METH_VARARGS, gc_set_thresh__doc__},
     {"get_threshold",  gc_get_thresh, METH_NOARGS,  gc_get_thresh__doc__},
+    {"set_pause_budget", gc_set_pause_budget, METH_VARARGS,
+        gc_set_pause_budget__doc__},
+    {"get_pause_budget", gc_get_pause_budget, METH_NOARGS,
+        gc_get_pause_budget__doc__},
+    {"get_stats",      gc_get_stats,  METH_NOARGS,  gc_get_stats__doc__},
     {"collect",            (PyCFunction)gc_collect,
         METH_VARARGS | METH_KEYWORDS,           gc_collect__doc__},
     {"get_objects",    gc_get_objects,METH_NOARGS,  gc_get_objects__doc__},
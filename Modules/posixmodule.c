@@ -574,11 +574,14 @@ convert_to_unicode(PyObject **param)
 {
     if (PyUnicode_CheckExact(*param))
         Py_INCREF(*param);
-    else if (PyUnicode_Check(*param))
+    else if (PyUnicode_Check(*param)) {
         /* For a Unicode subtype that's not a Unicode object,
            return a true Unicode object with the same data. */
-        *param = PyUnicode_FromUnicode(PyUnicode_AS_UNICODE(*param),
-                                       PyUnicode_GET_SIZE(*param));
+        Py_UNICODE *wide = PyUnicode_AS_UNICODE(*param);
+        if (wide == NULL)
+            return 0;
+        *param = PyUnicode_FromUnicode(wide, PyUnicode_GET_SIZE(*param));
+    }
     else
         *param = PyUnicode_FromEncodedObject(*param,
                                              Py_FileSystemDefaultEncoding,
@@ -734,17 +737,22 @@ win32_1str(PyObject* args, char* func,
            char* wformat, BOOL (__stdcall *funcW)(LPWSTR))
 {
     PyObject *uni;
+    Py_UNICODE *wide;
     char *ansi;
     BOOL result;
 
     if (!PyArg_ParseTuple(args, wformat, &uni))
         PyErr_Clear();
     else {
+        /* a compact string gets its wide copy here, with the GIL */
+        wide = PyUnicode_AsUnicode(uni);
+        if (wide == NULL)
+            return NULL;
         Py_BEGIN_ALLOW_THREADS
-        result = funcW(PyUnicode_AsUnicode(uni));
+        result = funcW(wide);
         Py_END_ALLOW_THREADS
         if (!result)
-            return win32_error_unicode(func, PyUnicode_AsUnicode(uni));
+            return win32_error_unicode(func, wide);
         Py_INCREF(Py_None);
         return Py_None;
     }
@@ -1463,9 +1471,9 @@ posix_do_stat(PyObject *self, PyObject *args,
     if (PyArg_ParseTuple(args, wformat, &po)) {
         Py_UNICODE *wpath = PyUnicode_AS_UNICODE(po);
 
+        if (wpath == NULL)
+            return NULL;
         Py_BEGIN_ALLOW_THREADS
-            /* PyUnicode_AS_UNICODE result OK without
-               thread lock as it is a simple dereference. */
         res = wstatfunc(wpath, &st);
         Py_END_ALLOW_THREADS
 
@@ -1521,10 +1529,12 @@ posix_access(PyObject *self, PyObject *args)
     DWORD attr;
     PyUnicodeObject *po;
     if (PyArg_ParseTuple(args, "Ui:access", &po, &mode)) {
+        Py_UNICODE *wpath = PyUnicode_AS_UNICODE(po);
+
+        if (wpath == NULL)
+            return NULL;
         Py_BEGIN_ALLOW_THREADS
-        /* PyUnicode_AS_UNICODE OK without thread lock as
-           it is a simple dereference. */
-        attr = GetFileAttributesW(PyUnicode_AS_UNICODE(po));
+        attr = GetFileAttributesW(wpath);
         Py_END_ALLOW_THREADS
         goto finish;
     }
@@ -1673,14 +1683,18 @@ posix_chmod(PyObject *self, PyObject *args)
     DWORD attr;
     PyUnicodeObject *po;
     if (PyArg_ParseTuple(args, "Ui|:chmod", &po, &i)) {
+        Py_UNICODE *wpath = PyUnicode_AS_UNICODE(po);
+
+        if (wpath == NULL)
+            return NULL;
         Py_BEGIN_ALLOW_THREADS
-        attr = GetFileAttributesW(PyUnicode_AS_UNICODE(po));
+        attr = GetFileAttributesW(wpath);
         if (attr != 0xFFFFFFFF) {
             if (i & _S_IWRITE)
                 attr &= ~FILE_ATTRIBUTE_READONLY;
             else
                 attr |= FILE_ATTRIBUTE_READONLY;
-            res = SetFileAttributesW(PyUnicode_AS_UNICODE(po), attr);
+            res = SetFileAttributesW(wpath, attr);
         }
         else
             res = 0;
@@ -2110,6 +2124,8 @@ posix_listdir(PyObject *self, PyObject *args)
         Py_UNICODE *wnamebuf;
         /* Overallocate for \\*.*\0 */
         len = PyUnicode_GET_SIZE(po);
+        if (PyUnicode_AS_UNICODE(po) == NULL)
+            return NULL;
         wnamebuf = malloc((len + 5) * sizeof(wchar_t));
         if (!wnamebuf) {
             PyErr_NoMemory();
@@ -2426,6 +2442,8 @@ posix__getfullpathname(PyObject *self, PyObject *args)
         Py_UNICODE *wtemp;
         DWORD result;
         PyObject *v;
+        if (wpath == NULL)
+            return NULL;
         result = GetFullPathNameW(wpath,
                                   sizeof(woutbuf)/sizeof(woutbuf[0]),
                                   woutbuf, &wtemp);
@@ -2476,13 +2494,15 @@ posix_mkdir(PyObject *self, PyObject *args)
 #ifdef MS_WINDOWS
     PyUnicodeObject *po;
     if (PyArg_ParseTuple(args, "U|i:mkdir", &po, &mode)) {
+        Py_UNICODE *wpath = PyUnicode_AS_UNICODE(po);
+
+        if (wpath == NULL)
+            return NULL;
         Py_BEGIN_ALLOW_THREADS
-        /* PyUnicode_AS_UNICODE OK without thread lock as
-           it is a simple dereference. */
-        res = CreateDirectoryW(PyUnicode_AS_UNICODE(po), NULL);
+        res = CreateDirectoryW(wpath, NULL);
         Py_END_ALLOW_THREADS
         if (!res)
-            return win32_error_unicode("mkdir", PyUnicode_AS_UNICODE(po));
+            return win32_error_unicode("mkdir", wpath);
         Py_INCREF(Py_None);
         return Py_None;
     }
@@ -2577,6 +2597,7 @@ posix_rename(PyObject *self, PyObject *args)
 {
 #ifdef MS_WINDOWS
     PyObject *o1, *o2;
+    Py_UNICODE *w1, *w2;
     char *p1, *p2;
     BOOL result;
     if (!PyArg_ParseTuple(args, "OO:rename", &o1, &o2))
@@ -2587,9 +2608,15 @@ posix_rename(PyObject *self, PyObject *args)
         Py_DECREF(o1);
         goto error;
     }
+    w1 = PyUnicode_AsUnicode(o1);
+    w2 = PyUnicode_AsUnicode(o2);
+    if (w1 == NULL || w2 == NULL) {
+        Py_DECREF(o1);
+        Py_DECREF(o2);
+        return NULL;
+    }
     Py_BEGIN_ALLOW_THREADS
-    result = MoveFileW(PyUnicode_AsUnicode(o1),
-                       PyUnicode_AsUnicode(o2));
+    result = MoveFileW(w1, w2);
     Py_END_ALLOW_THREADS
     Py_DECREF(o1);
     Py_DECREF(o2);
@@ -2784,6 +2811,8 @@ posix_utime(PyObject *self, PyObject *args)
 
     if (PyArg_ParseTuple(args, "UO|:utime", &obwpath, &arg)) {
         wpath = PyUnicode_AS_UNICODE(obwpath);
+        if (wpath == NULL)
+            return NULL;
         Py_BEGIN_ALLOW_THREADS
         hFile = CreateFileW(wpath, FILE_WRITE_ATTRIBUTES, 0,
                             NULL, OPEN_EXISTING,
@@ -4212,6 +4241,8 @@ posix__isdir(PyObject *self, PyObject *args)
     if (PyArg_ParseTuple(args, "U|:_isdir", &po)) {
         Py_UNICODE *wpath = PyUnicode_AS_UNICODE(po);
 
+        if (wpath == NULL)
+            return NULL;
         attributes = GetFileAttributesW(wpath);
         if (attributes == INVALID_FILE_ATTRIBUTES)
             Py_RETURN_FALSE;
@@ -6435,10 +6466,12 @@ posix_open(PyObject *self, PyObject *args)
 #ifdef MS_WINDOWS
     PyUnicodeObject *po;
     if (PyArg_ParseTuple(args, "Ui|i:mkdir", &po, &flag, &mode)) {
+        Py_UNICODE *wpath = PyUnicode_AS_UNICODE(po);
+
+        if (wpath == NULL)
+            return NULL;
         Py_BEGIN_ALLOW_THREADS
-        /* PyUnicode_AS_UNICODE OK without thread
-           lock as it is a simple dereference. */
-        fd = _wopen(PyUnicode_AS_UNICODE(po), flag, mode);
+        fd = _wopen(wpath, flag, mode);
         Py_END_ALLOW_THREADS
         if (fd < 0)
             return posix_error();
@@ -8468,11 +8501,15 @@ win32_startfile(PyObject *self, PyObject *args)
     HINSTANCE rc;
 
     PyObject *unipath, *woperation = NULL;
+    Py_UNICODE *wpath, *wop = NULL;
     if (!PyArg_ParseTuple(args, "U|s:startfile",
                           &unipath, &operation)) {
         PyErr_Clear();
         goto normal;
     }
+    wpath = PyUnicode_AS_UNICODE(unipath);
+    if (wpath == NULL)
+        return NULL;
 
     if (operation) {
         woperation = PyUnicode_DecodeASCII(operation,
@@ -8482,18 +8519,24 @@ win32_startfile(PyObject *self, PyObject *args)
             operation = NULL;
             goto normal;
         }
+        /* the decoded operation is compact: make its wide copy while
+           the GIL is still held */
+        wop = PyUnicode_AS_UNICODE(woperation);
+        if (wop == NULL) {
+            Py_DECREF(woperation);
+            return NULL;
+        }
     }
 
     Py_BEGIN_ALLOW_THREADS
-    rc = ShellExecuteW((HWND)0, woperation ? PyUnicode_AS_UNICODE(woperation) : 0,
-        PyUnicode_AS_UNICODE(unipath),
+    rc = ShellExecuteW((HWND)0, wop,
+        wpath,
         NULL, NULL, SW_SHOWNORMAL);
     Py_END_ALLOW_THREADS
 
     Py_XDECREF(woperation);
     if (rc <= (HINSTANCE)32) {
-        PyObject *errval = win32_error_unicode("startfile",
-                                               PyUnicode_AS_UNICODE(unipath));
+        PyObject *errval = win32_error_unicode("startfile", wpath);
         return errval;
     }
     Py_INCREF(Py_None);
@@ -2471,7 +2471,8 @@ the remote end is closed and all data is read, return the empty string.");
 static PyObject*
 sock_recv_into(PySocketSockObject *s, PyObject *args, PyObject *kwds)
 {
-    static char *kwlist[] = {"buffer", "nbytes", "flags", 0};
+    static const char * const kwlist[] = {"buffer", "nbytes", "flags", 0};
+    static _PyArg_Parser _parser = {"w*|ii:recv_into", kwlist, 0};
 
     int recvlen = 0, flags = 0;
     ssize_t readlen;
@@ -2479,8 +2480,8 @@ sock_recv_into(PySocketSockObject *s, PyObject *args, PyObject *kwds)
     Py_ssize_t buflen;
 
     /* Get the buffer's memory */
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "w*|ii:recv_into", kwlist,
-                                     &buf, &recvlen, &flags))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &buf, &recvlen, &flags))
         return NULL;
     buflen = buf.len;
     assert(buf.buf != 0 && buflen > 0);
@@ -2651,7 +2652,8 @@ Like recv(buffersize, flags) but also return the sender's address info.");
 static PyObject *
 sock_recvfrom_into(PySocketSockObject *s, PyObject *args, PyObject* kwds)
 {
-    static char *kwlist[] = {"buffer", "nbytes", "flags", 0};
+    static const char * const kwlist[] = {"buffer", "nbytes", "flags", 0};
+    static _PyArg_Parser _parser = {"w*|ii:recvfrom_into", kwlist, 0};
 
     int recvlen = 0, flags = 0;
     ssize_t readlen;
@@ -2660,9 +2662,8 @@ sock_recvfrom_into(PySocketSockObject *s, PyObject *args, PyObject* kwds)
 
     PyObject *addr = NULL;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "w*|ii:recvfrom_into",
-                                     kwlist, &buf,
-                                     &recvlen, &flags))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser, &buf,
+                                          &recvlen, &flags))
         return NULL;
     buflen = buf.len;
     assert(buf.buf != 0 && buflen > 0);
@@ -3097,11 +3098,11 @@ sock_initobj(PyObject *self, PyObject *args, PyObject *kwds)
     PySocketSockObject *s = (PySocketSockObject *)self;
     SOCKET_T fd;
     int family = AF_INET, type = SOCK_STREAM, proto = 0;
-    static char *keywords[] = {"family", "type", "proto", 0};
+    static const char * const keywords[] = {"family", "type", "proto", 0};
+    static _PyArg_Parser _parser = {"|iii:socket", keywords, 0};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds,
-                                     "|iii:socket", keywords,
-                                     &family, &type, &proto))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &family, &type, &proto))
         return -1;
 
     Py_BEGIN_ALLOW_THREADS
@@ -93,6 +93,8 @@ static Py_UCS4 getuchar(PyUnicodeObject *obj)
 {
     Py_UNICODE *v = PyUnicode_AS_UNICODE(obj);
 
+    if (v == NULL)
+        return (Py_UCS4)-1;
     if (PyUnicode_GET_SIZE(obj) == 1)
         return *v;
 #ifndef Py_UNICODE_WIDE
@@ -774,6 +776,9 @@ unicodedata_normalize(PyObject *self, PyObject *args)
     if(!PyArg_ParseTuple(args, "sO!:normalize",
                          &form, &PyUnicode_Type, &input))
         return NULL;
+    /* the normalizers walk the input as Py_UNICODE */
+    if (PyUnicode_AS_UNICODE(input) == NULL)
+        return NULL;
 
     if (PyUnicode_GetSize(input) == 0) {
         /* Special case empty input strings, since resizing
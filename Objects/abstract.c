@@ -1661,10 +1661,13 @@ PyNumber_Int(PyObject *o)
         return int_from_string(PyString_AS_STRING(o),
                                PyString_GET_SIZE(o));
 #ifdef Py_USING_UNICODE
-    if (PyUnicode_Check(o))
+    if (PyUnicode_Check(o)) {
+        if (PyUnicode_AS_UNICODE(o) == NULL)
+            return NULL;
         return PyInt_FromUnicode(PyUnicode_AS_UNICODE(o),
                                  PyUnicode_GET_SIZE(o),
                                  10);
+    }
 #endif
     if (!PyObject_AsCharBuffer(o, &buffer, &buffer_len))
         return int_from_string((char*)buffer, buffer_len);
@@ -1759,11 +1762,14 @@ PyNumber_Long(PyObject *o)
         return long_from_string(PyString_AS_STRING(o),
                                 PyString_GET_SIZE(o));
 #ifdef Py_USING_UNICODE
-    if (PyUnicode_Check(o))
+    if (PyUnicode_Check(o)) {
         /* The above check is done in PyLong_FromUnicode(). */
+        if (PyUnicode_AS_UNICODE(o) == NULL)
+            return NULL;
         return PyLong_FromUnicode(PyUnicode_AS_UNICODE(o),
                                   PyUnicode_GET_SIZE(o),
                                   10);
+    }
 #endif
     if (!PyObject_AsCharBuffer(o, &buffer, &buffer_len))
         return long_from_string(buffer, buffer_len);
@@ -2549,6 +2555,116 @@ PyObject_Call(PyObject *func, PyObject *arg, PyObject *kw)
     return NULL;
 }
 
+PyObject *
+_PyStack_AsTuple(PyObject **stack, Py_ssize_t nargs)
+{
+    PyObject *args;
+    Py_ssize_t i;
+
+    args = PyTuple_New(nargs);
+    if (args == NULL)
+        return NULL;
+    for (i = 0; i < nargs; i++) {
+        PyObject *item = stack[i];
+        Py_INCREF(item);
+        PyTuple_SET_ITEM(args, i, item);
+    }
+    return args;
+}
+
+PyObject *
+_PyStack_AsDict(PyObject **values, PyObject *kwnames)
+{
+    PyObject *kwdict;
+    Py_ssize_t i, nkwargs = PyTuple_GET_SIZE(kwnames);
+
+    kwdict = PyDict_New();
+    if (kwdict == NULL)
+        return NULL;
+    for (i = 0; i < nkwargs; i++) {
+        if (PyDict_SetItem(kwdict, PyTuple_GET_ITEM(kwnames, i),
+                           values[i]) < 0) {
+            Py_DECREF(kwdict);
+            return NULL;
+        }
+    }
+    return kwdict;
+}
+
+PyObject **
+_PyStack_UnpackDict(PyObject **args, Py_ssize_t nargs, PyObject *kwargs,
+                    PyObject **p_kwnames)
+{
+    PyObject **stack, *kwnames, *key, *value;
+    Py_ssize_t nkwargs, pos, i;
+
+    nkwargs = (kwargs == NULL) ? 0 : PyDict_Size(kwargs);
+    stack = PyMem_NEW(PyObject *, nargs + nkwargs);
+    if (stack == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    for (i = 0; i < nargs; i++)
+        stack[i] = args[i];
+
+    kwnames = NULL;
+    if (nkwargs > 0) {
+        kwnames = PyTuple_New(nkwargs);
+        if (kwnames == NULL) {
+            PyMem_FREE(stack);
+            return NULL;
+        }
+        pos = i = 0;
+        while (PyDict_Next(kwargs, &pos, &key, &value)) {
+            Py_INCREF(key);
+            PyTuple_SET_ITEM(kwnames, i, key);
+            stack[nargs + i] = value;
+            i++;
+        }
+    }
+    *p_kwnames = kwnames;
+    return stack;
+}
+
+PyObject *
+_PyObject_FastCall(PyObject *func, PyObject **args, Py_ssize_t nargs,
+                   PyObject *kwnames)
+{
+    PyTypeObject *tp = Py_TYPE(func);
+    PyObject *callargs, *kwdict, *result;
+
+    assert(nargs >= 0);
+    assert(kwnames == NULL || PyTuple_CheckExact(kwnames));
+    if (PyType_HasFeature(tp, Py_TPFLAGS_HAVE_FASTCALL) &&
+        tp->tp_fastcall != NULL) {
+        if (Py_EnterRecursiveCall(" while calling a Python object"))
+            return NULL;
+        result = (*tp->tp_fastcall)(func, args, nargs, kwnames);
+        Py_LeaveRecursiveCall();
+        if (result == NULL && !PyErr_Occurred())
+            PyErr_SetString(
+                PyExc_SystemError,
+                "NULL result without error in _PyObject_FastCall");
+        return result;
+    }
+
+    callargs = _PyStack_AsTuple(args, nargs);
+    if (callargs == NULL)
+        return NULL;
+    kwdict = NULL;
+    if (kwnames != NULL && PyTuple_GET_SIZE(kwnames) > 0) {
+        kwdict = _PyStack_AsDict(args + nargs, kwnames);
+        if (kwdict == NULL) {
+            Py_DECREF(callargs);
+            return NULL;
+        }
+    }
+    result = PyObject_Call(func, callargs, kwdict);
+    Py_DECREF(callargs);
+    Py_XDECREF(kwdict);
+    return result;
+}
+
 static PyObject*
 call_function_tail(PyObject *callable, PyObject *args)
 {
@@ -309,9 +309,6 @@ buffer_hash(PyBufferObject *self)
 {
     void *ptr;
     Py_ssize_t size;
-    register Py_ssize_t len;
-    register unsigned char *p;
-    register long x;
 
     if ( self->b_hash != -1 )
         return self->b_hash;
@@ -332,26 +329,8 @@ buffer_hash(PyBufferObject *self)
 
     if (!get_buf(self, &ptr, &size, ANY_BUFFER))
         return -1;
-    p = (unsigned char *) ptr;
-    len = size;
-    /*
-      We make the hash of the empty buffer be 0, rather than using
-      (prefix ^ suffix), since this slightly obfuscates the hash secret
-    */
-    if (len == 0) {
-        self->b_hash = 0;
-        return 0;
-    }
-    x = _Py_HashSecret.prefix;
-    x ^= *p << 7;
-    while (--len >= 0)
-        x = (1000003*x) ^ *p++;
-    x ^= size;
-    x ^= _Py_HashSecret.suffix;
-    if (x == -1)
-        x = -2;
-    self->b_hash = x;
-    return x;
+    self->b_hash = _Py_HashBytes(ptr, size);
+    return self->b_hash;
 }
 
 static PyObject *
@@ -1538,17 +1538,7 @@ return_self(PyByteArrayObject *self)
 Py_LOCAL_INLINE(Py_ssize_t)
 countchar(const char *target, Py_ssize_t target_len, char c, Py_ssize_t maxcount)
 {
-    Py_ssize_t count=0;
-    const char *start=target;
-    const char *end=target+target_len;
-
-    while ( (start=findchar(start, end-start, c)) != NULL ) {
-        count++;
-        if (count >= maxcount)
-            break;
-        start += 1;
-    }
-    return count;
+    return stringlib_count_char(target, target_len, c, maxcount);
 }
 
 
@@ -2722,6 +2722,39 @@ getinstclassname(PyObject *inst, char *buf, int bufsize)
     Py_XDECREF(klass);
 }
 
+/* Unbound methods must be called with an instance of the class (or a
+   derived class) as first argument.  Return 1 if self (which may be
+   NULL) is one, 0 with an exception set if not, -1 on error. */
+static int
+check_unbound_self(PyObject *func, PyObject *klass, PyObject *self)
+{
+    int ok;
+
+    if (self == NULL)
+        ok = 0;
+    else {
+        ok = PyObject_IsInstance(self, klass);
+        if (ok < 0)
+            return -1;
+    }
+    if (!ok) {
+        char clsbuf[256];
+        char instbuf[256];
+        getclassname(klass, clsbuf, sizeof(clsbuf));
+        getinstclassname(self, instbuf, sizeof(instbuf));
+        PyErr_Format(PyExc_TypeError,
+                     "unbound method %s%s must be called with "
+                     "%s instance as first argument "
+                     "(got %s%s instead)",
+                     PyEval_GetFuncName(func),
+                     PyEval_GetFuncDesc(func),
+                     clsbuf,
+                     instbuf,
+                     self == NULL ? "" : " instance");
+    }
+    return ok;
+}
+
 static PyObject *
 instancemethod_call(PyObject *func, PyObject *arg, PyObject *kw)
 {
@@ -2731,34 +2764,10 @@ instancemethod_call(PyObject *func, PyObject *arg, PyObject *kw)
 
     func = PyMethod_GET_FUNCTION(func);
     if (self == NULL) {
-        /* Unbound methods must be called with an instance of
-           the class (or a derived class) as first argument */
-        int ok;
         if (PyTuple_Size(arg) >= 1)
             self = PyTuple_GET_ITEM(arg, 0);
-        if (self == NULL)
-            ok = 0;
-        else {
-            ok = PyObject_IsInstance(self, klass);
-            if (ok < 0)
-                return NULL;
-        }
-        if (!ok) {
-            char clsbuf[256];
-            char instbuf[256];
-            getclassname(klass, clsbuf, sizeof(clsbuf));
-            getinstclassname(self, instbuf, sizeof(instbuf));
-            PyErr_Format(PyExc_TypeError,
-                         "unbound method %s%s must be called with "
-                         "%s instance as first argument "
-                         "(got %s%s instead)",
-                         PyEval_GetFuncName(func),
-                         PyEval_GetFuncDesc(func),
-                         clsbuf,
-                         instbuf,
-                         self == NULL ? "" : " instance");
+        if (check_unbound_self(func, klass, self) <= 0)
             return NULL;
-        }
         Py_INCREF(arg);
     }
     else {
@@ -2781,6 +2790,46 @@ instancemethod_call(PyObject *func, PyObject *arg, PyObject *kw)
     return result;
 }
 
+/* Number of arguments, self included, that instancemethod_fastcall()
+   passes on without allocating */
+#define METHOD_SMALL_STACK 8
+
+static PyObject *
+instancemethod_fastcall(PyObject *func, PyObject **args, Py_ssize_t nargs,
+                        PyObject *kwnames)
+{
+    PyObject *self = PyMethod_GET_SELF(func);
+    PyObject *small_stack[METHOD_SMALL_STACK];
+    PyObject **stack, *result;
+    Py_ssize_t total;
+
+    if (self == NULL) {
+        if (check_unbound_self(PyMethod_GET_FUNCTION(func),
+                               PyMethod_GET_CLASS(func),
+                               nargs >= 1 ? args[0] : NULL) <= 0)
+            return NULL;
+        return _PyObject_FastCall(PyMethod_GET_FUNCTION(func),
+                                  args, nargs, kwnames);
+    }
+
+    total = nargs + (kwnames == NULL ? 0 : PyTuple_GET_SIZE(kwnames));
+    if (total < METHOD_SMALL_STACK)
+        stack = small_stack;
+    else {
+        stack = PyMem_NEW(PyObject *, total + 1);
+        if (stack == NULL)
+            return PyErr_NoMemory();
+    }
+    stack[0] = self;
+    if (total > 0)
+        memcpy(stack + 1, args, total * sizeof(PyObject *));
+    result = _PyObject_FastCall(PyMethod_GET_FUNCTION(func),
+                                stack, nargs + 1, kwnames);
+    if (stack != small_stack)
+        PyMem_FREE(stack);
+    return result;
+}
+
 static PyObject *
 instancemethod_descr_get(PyObject *meth, PyObject *obj, PyObject *cls)
 {
@@ -2847,6 +2896,16 @@ PyTypeObject PyMethod_Type = {
     0,                                          /* tp_init */
     0,                                          /* tp_alloc */
     instancemethod_new,                         /* tp_new */
+    0,                                          /* tp_free */
+    0,                                          /* tp_is_gc */
+    0,                                          /* tp_bases */
+    0,                                          /* tp_mro */
+    0,                                          /* tp_cache */
+    0,                                          /* tp_subclasses */
+    0,                                          /* tp_weaklist */
+    0,                                          /* tp_del */
+    0,                                          /* tp_version_tag */
+    instancemethod_fastcall,                    /* tp_fastcall */
 };
 
 /* Clear out the free list */
@@ -1,5 +1,6 @@
 #include "Python.h"
 #include "code.h"
+#include "opcode.h"
 #include "structmember.h"
 
 #define NAME_CHARS \
@@ -104,6 +105,13 @@ PyCode_New(int argcount, int nlocals, int stacksize, int flags,
         co->co_lnotab = lnotab;
         co->co_zombieframe = NULL;
         co->co_weakreflist = NULL;
+        co->co_opcache_map = NULL;
+        co->co_opcache = NULL;
+        co->co_quickened = NULL;
+        co->co_quickened_deopts = NULL;
+        co->co_opcache_flag = 0;
+        co->co_opcache_size = 0;
+        co->co_frame_made = 0;
     }
     return co;
 }
@@ -301,6 +309,70 @@ code_new(PyTypeObject *type, PyObject *args, PyObject *kw)
     return co;
 }
 
+/* Give every LOAD_GLOBAL and LOAD_ATTR instruction its own cache entry,
+   up to 255 of them.  This is only an optimization: if memory runs out,
+   the code object simply keeps running without caches. */
+void
+_PyCode_InitOpcache(PyCodeObject *co)
+{
+    Py_ssize_t co_size, i;
+    size_t nbytes;
+    unsigned char *code;
+    int opcode, n = 0;
+
+    if (co->co_opcache_map != NULL || !PyString_Check(co->co_code))
+        return;
+    co_size = PyString_GET_SIZE(co->co_code);
+    code = (unsigned char *)PyString_AS_STRING(co->co_code);
+
+    co->co_opcache_map = (unsigned char *)PyMem_MALLOC(co_size);
+    if (co->co_opcache_map == NULL)
+        return;
+    memset(co->co_opcache_map, 0, co_size);
+
+    for (i = 0; i < co_size; i += HAS_ARG(opcode) ? 3 : 1) {
+        opcode = code[i];
+        if ((opcode == LOAD_GLOBAL || opcode == LOAD_ATTR) && n < 255)
+            co->co_opcache_map[i] = (unsigned char)++n;
+    }
+
+    nbytes = n * sizeof(_PyOpcache);
+    if (n > 0)
+        co->co_opcache = (_PyOpcache *)PyMem_MALLOC(nbytes);
+    if (co->co_opcache == NULL) {
+        PyMem_FREE(co->co_opcache_map);
+        co->co_opcache_map = NULL;
+        return;
+    }
+    memset(co->co_opcache, 0, nbytes);
+    co->co_opcache_size = (unsigned char)n;
+}
+
+/* The quickened copy starts out identical to co_code; ceval.c rewrites
+   its instructions as it learns about the operands.  Like the inline
+   caches, it is simply not made if memory runs out. */
+void
+_PyCode_Quicken(PyCodeObject *co)
+{
+    Py_ssize_t co_size;
+
+    if (co->co_quickened != NULL || !PyString_Check(co->co_code))
+        return;
+    co_size = PyString_GET_SIZE(co->co_code);
+
+    co->co_quickened_deopts = (unsigned char *)PyMem_MALLOC(co_size);
+    if (co->co_quickened_deopts == NULL)
+        return;
+    co->co_quickened = (unsigned char *)PyMem_MALLOC(co_size);
+    if (co->co_quickened == NULL) {
+        PyMem_FREE(co->co_quickened_deopts);
+        co->co_quickened_deopts = NULL;
+        return;
+    }
+    memcpy(co->co_quickened, PyString_AS_STRING(co->co_code), co_size);
+    memset(co->co_quickened_deopts, 0, co_size);
+}
+
 static void
 code_dealloc(PyCodeObject *co)
 {
@@ -315,6 +387,14 @@ code_dealloc(PyCodeObject *co)
     Py_XDECREF(co->co_lnotab);
     if (co->co_zombieframe != NULL)
         PyObject_GC_Del(co->co_zombieframe);
+    if (co->co_opcache_map != NULL)
+        PyMem_FREE(co->co_opcache_map);
+    if (co->co_opcache != NULL)
+        PyMem_FREE(co->co_opcache);
+    if (co->co_quickened != NULL)
+        PyMem_FREE(co->co_quickened);
+    if (co->co_quickened_deopts != NULL)
+        PyMem_FREE(co->co_quickened_deopts);
     if (co->co_weakreflist != NULL)
         PyObject_ClearWeakRefs((PyObject*)co);
     PyObject_DEL(co);
@@ -987,7 +987,8 @@ complex_subtype_from_string(PyTypeObject *type, PyObject *v)
         s_buffer = (char *)PyMem_MALLOC(PyUnicode_GET_SIZE(v)+1);
         if (s_buffer == NULL)
             return PyErr_NoMemory();
-        if (PyUnicode_EncodeDecimal(PyUnicode_AS_UNICODE(v),
+        if (PyUnicode_AS_UNICODE(v) == NULL ||
+            PyUnicode_EncodeDecimal(PyUnicode_AS_UNICODE(v),
                                     PyUnicode_GET_SIZE(v),
                                     s_buffer,
                                     NULL))
@@ -1136,12 +1137,13 @@ complex_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
     int own_r = 0;
     int cr_is_complex = 0;
     int ci_is_complex = 0;
-    static char *kwlist[] = {"real", "imag", 0};
+    static const char * const kwlist[] = {"real", "imag", 0};
+    static _PyArg_Parser _parser = {"|OO:complex", kwlist, 0};
 
     r = Py_False;
     i = NULL;
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OO:complex", kwlist,
-                                     &r, &i))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &r, &i))
         return NULL;
 
     /* Special-case for a single argument when type(arg) is complex. */
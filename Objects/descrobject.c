@@ -5,7 +5,7 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 // 数据类型（对象）`PyWrapperDescr_Type`、`PyMemberDescr_Type`、`PyGetSetDescr_Type`，以及 `PyMethodDescr_Type`、`PyClassMethodDescr_Type` 的定义
-// 其中 `PyMethodDescr_Type`、`PyClassMethodDescr_Type` 是静态私有类型
+// 其中 `PyClassMethodDescr_Type` 是静态私有类型
 ///////////////////////////////////////////////////////////////////////////////
 
 static void
@@ -261,6 +261,39 @@ methoddescr_call(PyMethodDescrObject *descr, PyObject *args, PyObject *kwds)
     return result;
 }
 
+/* Calling the descriptor with an argument array needs neither a bound
+   builtin method nor a slice of the argument tuple: the C function gets
+   args[0] as self and the rest as its arguments. */
+static PyObject *
+methoddescr_fastcall(PyMethodDescrObject *descr, PyObject **args,
+                     Py_ssize_t nargs, PyObject *kwnames)
+{
+    PyObject *self;
+
+    if (nargs < 1) {
+        PyErr_Format(PyExc_TypeError,
+                     "descriptor '%.300s' of '%.100s' "
+                     "object needs an argument",
+                     descr_name((PyDescrObject *)descr),
+                     descr->d_type->tp_name);
+        return NULL;
+    }
+    self = args[0];
+    if (!_PyObject_RealIsSubclass((PyObject *)Py_TYPE(self),
+                                  (PyObject *)(descr->d_type))) {
+        PyErr_Format(PyExc_TypeError,
+                     "descriptor '%.200s' "
+                     "requires a '%.100s' object "
+                     "but received a '%.100s'",
+                     descr_name((PyDescrObject *)descr),
+                     descr->d_type->tp_name,
+                     self->ob_type->tp_name);
+        return NULL;
+    }
+    return _PyMethodDef_FastCall(descr->d_method, self,
+                                 args + 1, nargs - 1, kwnames);
+}
+
 static PyObject *
 classmethoddescr_call(PyMethodDescrObject *descr, PyObject *args,
                       PyObject *kwds)
@@ -399,7 +432,7 @@ descr_traverse(PyObject *self, visitproc visit, void *arg)
     return 0;
 }
 
-static PyTypeObject PyMethodDescr_Type = {
+PyTypeObject PyMethodDescr_Type = {
     PyVarObject_HEAD_INIT(&PyType_Type, 0)
     "method_descriptor",
     sizeof(PyMethodDescrObject),
@@ -434,6 +467,20 @@ static PyTypeObject PyMethodDescr_Type = {
     0,                                          /* tp_dict */
     (descrgetfunc)method_get,                   /* tp_descr_get */
     0,                                          /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    0,                                          /* tp_init */
+    0,                                          /* tp_alloc */
+    0,                                          /* tp_new */
+    0,                                          /* tp_free */
+    0,                                          /* tp_is_gc */
+    0,                                          /* tp_bases */
+    0,                                          /* tp_mro */
+    0,                                          /* tp_cache */
+    0,                                          /* tp_subclasses */
+    0,                                          /* tp_weaklist */
+    0,                                          /* tp_del */
+    0,                                          /* tp_version_tag */
+    (fastcallfunc)methoddescr_fastcall,         /* tp_fastcall */
 };
 
 /* This is for METH_CLASS in C, not for "f = classmethod(f)" in Python! */
@@ -9,6 +9,8 @@
 
 #include "Python.h"
 
+#include <stddef.h>
+
 
 /* Set a key error with the specified argument, wrapping it in a
  * tuple automatically so that tuple keys are not unpacked as the
@@ -134,20 +136,17 @@ practice, this probably won't make a lick of difference for many years (at
 which point everyone will have terabytes of RAM on 64-bit boxes).
 */
 
-/* Object used as dummy key to fill deleted entries */
-static PyObject *dummy = NULL; /* Initialized by first call to newPyDictObject() */
+/* Global counter used to set ma_version_tag field of dictionary.
+ * It is incremented each time that a dictionary is created and each
+ * time that a dictionary is modified. */
+static PY_UINT64_T pydict_global_version = 0;
 
-#ifdef Py_REF_DEBUG
-PyObject *
-_PyDict_Dummy(void)
-{
-    return dummy;
-}
-#endif
+#define DICT_NEXT_VERSION() (++pydict_global_version)
 
 /* forward declarations */
-static PyDictEntry *
-lookdict_string(PyDictObject *mp, PyObject *key, long hash);
+static Py_ssize_t
+lookdict_string(PyDictObject *mp, PyObject *key, long hash,
+                Py_ssize_t *hashpos);
 
 #ifdef SHOW_CONVERSION_COUNTS
 static long created = 0L;
@@ -198,6 +197,77 @@ show_track(void)
 #endif
 
 
+/* The index table.  Its slots are just wide enough to hold the index of
+   any of the PyDict_USABLE(size) entries, or a negative DKIX_* value. */
+
+#if SIZEOF_VOID_P > 4
+#define DK_IXSIZE(size)                                                 \
+    ((size) <= 0x80 ? 1 : (size) <= 0x8000 ? 2 :                        \
+     (size) <= 0x80000000L ? 4 : 8)
+#else
+#define DK_IXSIZE(size)                                                 \
+    ((size) <= 0x80 ? 1 : (size) <= 0x8000 ? 2 : 4)
+#endif
+
+/* Bytes taken by an index table of size slots.  As size is at least
+   PyDict_MINSIZE, this is a multiple of 8, and the entries stored after
+   the index table are aligned. */
+#define DK_INDICES_SIZE(size) ((size) * DK_IXSIZE(size))
+
+Py_LOCAL_INLINE(Py_ssize_t)
+get_index(void *indices, Py_ssize_t size, size_t i)
+{
+    if (size <= 0x80)
+        return ((signed char *)indices)[i];
+    if (size <= 0x8000)
+        return ((short *)indices)[i];
+#if SIZEOF_VOID_P > 4
+    if (size > 0x80000000L)
+        return (Py_ssize_t)((PY_INT64_T *)indices)[i];
+#endif
+    return ((PY_INT32_T *)indices)[i];
+}
+
+Py_LOCAL_INLINE(void)
+set_index(void *indices, Py_ssize_t size, size_t i, Py_ssize_t ix)
+{
+    if (size <= 0x80)
+        ((signed char *)indices)[i] = (signed char)ix;
+    else if (size <= 0x8000)
+        ((short *)indices)[i] = (short)ix;
+#if SIZEOF_VOID_P > 4
+    else if (size > 0x80000000L)
+        ((PY_INT64_T *)indices)[i] = (PY_INT64_T)ix;
+#endif
+    else
+        ((PY_INT32_T *)indices)[i] = (PY_INT32_T)ix;
+}
+
+#define DICT_GET_INDEX(mp, i) \
+    get_index((mp)->ma_indices, (mp)->ma_mask + 1, (i))
+#define DICT_SET_INDEX(mp, i, ix) \
+    set_index((mp)->ma_indices, (mp)->ma_mask + 1, (i), (ix))
+
+/* Return the first Unused slot in the probe sequence of hash.  Only for
+   tables known to hold no Dummy slots in the way, like fresh ones. */
+static size_t
+find_empty_slot(void *indices, Py_ssize_t mask, long hash)
+{
+    register size_t i;
+    register size_t perturb;
+
+    i = (size_t)hash & (size_t)mask;
+    for (perturb = hash;
+         get_index(indices, mask + 1, i & (size_t)mask) != DKIX_EMPTY;
+         perturb >>= PERTURB_SHIFT)
+        i = (i << 2) + i + perturb + 1;
+    return i & (size_t)mask;
+}
+
+/* The value in entry i of the table of mp */
+#define DICT_VALUE(mp, i) _PyDict_VALUE(mp, i)
+
+
 /* Initialization macros.
    There are two ways to create a dict:  PyDict_New() is the main C API
    function, and the tp_new slot maps to dict_new().  In the latter case we
@@ -205,20 +275,29 @@ show_track(void)
    that the PyDictObject struct is already zeroed out.
    Everyone except dict_new() should use EMPTY_TO_MINSIZE (unless they have
    an excellent reason not to).
+   Only the index table needs initializing: the entries past ma_fill are
+   never looked at.
 */
 
 #define INIT_NONZERO_DICT_SLOTS(mp) do {                                \
     (mp)->ma_table = (mp)->ma_smalltable;                               \
+    (mp)->ma_indices = (mp)->ma_smallindices;                           \
     (mp)->ma_mask = PyDict_MINSIZE - 1;                                 \
+    memset((mp)->ma_smallindices, 0xff, sizeof((mp)->ma_smallindices)); \
     } while(0)
 
 #define EMPTY_TO_MINSIZE(mp) do {                                       \
-    memset((mp)->ma_smalltable, 0, sizeof((mp)->ma_smalltable));        \
     (mp)->ma_used = (mp)->ma_fill = 0;                                  \
     INIT_NONZERO_DICT_SLOTS(mp);                                        \
     } while(0)
 
-/* Dictionary reuse scheme to save calls to malloc, free, and memset */
+/* Whether the index table and entries of combined table mp live in a
+   malloc'ed block (which ma_indices points to).  Tables that used to be
+   split have no ma_smallindices to fall back on. */
+#define DICT_IS_MALLOCED(mp) \
+    ((mp)->ma_keys != NULL || (mp)->ma_indices != (mp)->ma_smallindices)
+
+/* Dictionary reuse scheme to save calls to malloc and free */
 #ifndef PyDict_MAXFREELIST
 #define PyDict_MAXFREELIST 80
 #endif
@@ -241,10 +320,11 @@ PyObject *
 PyDict_New(void)
 {
     register PyDictObject *mp;
-    if (dummy == NULL) { /* Auto-initialize dummy */
-        dummy = PyString_FromString("<dummy key>");
-        if (dummy == NULL)
-            return NULL;
+#if defined(SHOW_CONVERSION_COUNTS) || defined(SHOW_ALLOC_COUNT) || \
+    defined(SHOW_TRACK_COUNT)
+    static int registered = 0;
+    if (!registered) {
+        registered = 1;
 #ifdef SHOW_CONVERSION_COUNTS
         Py_AtExit(show_counts);
 #endif
@@ -255,21 +335,16 @@ PyDict_New(void)
         Py_AtExit(show_track);
 #endif
     }
+#endif
     if (numfree) {
         mp = free_list[--numfree];
         assert (mp != NULL);
         assert (Py_TYPE(mp) == &PyDict_Type);
         _Py_NewReference((PyObject *)mp);
-        if (mp->ma_fill) {
-            EMPTY_TO_MINSIZE(mp);
-        } else {
-            /* At least set ma_table and ma_mask; these are wrong
-               if an empty but presized dict is added to freelist */
-            INIT_NONZERO_DICT_SLOTS(mp);
-        }
-        assert (mp->ma_used == 0);
-        assert (mp->ma_table == mp->ma_smalltable);
-        assert (mp->ma_mask == PyDict_MINSIZE - 1);
+        /* ma_table and ma_mask are wrong if an empty but presized
+           dict was added to the freelist */
+        EMPTY_TO_MINSIZE(mp);
+        assert (mp->ma_keys == NULL && mp->ma_values == NULL);
 #ifdef SHOW_ALLOC_COUNT
         count_reuse++;
 #endif
@@ -278,11 +353,14 @@ PyDict_New(void)
         if (mp == NULL)
             return NULL;
         EMPTY_TO_MINSIZE(mp);
+        mp->ma_keys = NULL;
+        mp->ma_values = NULL;
 #ifdef SHOW_ALLOC_COUNT
         count_alloc++;
 #endif
     }
     mp->ma_lookup = lookdict_string;
+    mp->ma_version_tag = DICT_NEXT_VERSION();
 #ifdef SHOW_TRACK_COUNT
     count_untracked++;
 #endif
@@ -292,6 +370,137 @@ PyDict_New(void)
     return (PyObject *)mp;
 }
 
+/* Shared keys tables of split dicts (see Include/dictobject.h) */
+
+/* Shared tables are copied into larger ones up to this many slots; past
+   that, a dict needing a new key becomes combined.  64 slots hold 42 keys,
+   which is plenty for the attributes of an instance. */
+#define SHARED_KEYS_MAX_SIZE 64
+
+#define DK_INCREF(dk) ((dk)->dk_refcnt++)
+#define DK_DECREF(dk) \
+    do { \
+        if (--(dk)->dk_refcnt == 0) \
+            free_keys_object(dk); \
+    } while (0)
+
+/* What ma_keys points to once a split table has become combined */
+static PyDictKeysObject combined_keys = {1, 0, 0, NULL, NULL, {0}};
+
+static PyDictKeysObject *
+new_keys_object(Py_ssize_t size)
+{
+    PyDictKeysObject *keys;
+    Py_ssize_t ixsize = DK_INDICES_SIZE(size);
+
+    assert(size >= PyDict_MINSIZE && (size & (size - 1)) == 0);
+    keys = (PyDictKeysObject *)PyMem_MALLOC(
+        offsetof(PyDictKeysObject, dk_indices) + ixsize +
+        PyDict_USABLE(size) * sizeof(PyDictEntry));
+    if (keys == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    keys->dk_refcnt = 1;
+    keys->dk_mask = size - 1;
+    keys->dk_nkeys = 0;
+    keys->dk_next = NULL;
+    keys->dk_table = (PyDictEntry *)(keys->dk_indices + ixsize);
+    memset(keys->dk_indices, 0xff, ixsize);
+    return keys;
+}
+
+static void
+free_keys_object(PyDictKeysObject *keys)
+{
+    Py_ssize_t i;
+
+    assert(keys != &combined_keys);
+    for (i = 0; i < keys->dk_nkeys; i++)
+        Py_DECREF(keys->dk_table[i].me_key);
+    if (keys->dk_next != NULL)
+        DK_DECREF(keys->dk_next);
+    PyMem_FREE(keys);
+}
+
+/* Return a new keys table for the instance dicts of a class, or NULL
+   without an exception set if there's no memory: sharing keys is merely
+   an optimization. */
+PyDictKeysObject *
+_PyDict_NewKeysForClass(void)
+{
+    PyDictKeysObject *keys = new_keys_object(PyDict_MINSIZE);
+    if (keys == NULL)
+        PyErr_Clear();
+    return keys;
+}
+
+void
+_PyDictKeys_DecRef(PyDictKeysObject *keys)
+{
+    DK_DECREF(keys);
+}
+
+/* Create an empty split table sharing keys.  It is allocated without
+   ma_smallindices and ma_smalltable, so it never goes to the free list. */
+static PyObject *
+new_split_dict(PyDictKeysObject *keys)
+{
+    PyDictObject *mp;
+    PyObject **values;
+    Py_ssize_t n = PyDict_USABLE(keys->dk_mask + 1);
+
+    values = PyMem_NEW(PyObject *, n);
+    if (values == NULL)
+        return PyErr_NoMemory();
+    memset(values, 0, n * sizeof(PyObject *));
+    mp = (PyDictObject *)_PyObject_GC_Malloc(
+        offsetof(PyDictObject, ma_smallindices));
+    if (mp == NULL) {
+        PyMem_FREE(values);
+        return NULL;
+    }
+    PyObject_INIT(mp, &PyDict_Type);
+    DK_INCREF(keys);
+    mp->ma_fill = 0;
+    mp->ma_used = 0;
+    mp->ma_mask = keys->dk_mask;
+    mp->ma_table = keys->dk_table;
+    mp->ma_indices = keys->dk_indices;
+    mp->ma_lookup = lookdict_string;
+    mp->ma_version_tag = DICT_NEXT_VERSION();
+    mp->ma_keys = keys;
+    mp->ma_values = values;
+#ifdef SHOW_TRACK_COUNT
+    count_untracked++;
+#endif
+    return (PyObject *)mp;
+}
+
+/* Create the __dict__ of an instance of tp: a split table if tp shares
+   the keys of its instance dicts, else an ordinary dict. */
+PyObject *
+_PyObjectDict_New(PyTypeObject *tp)
+{
+    PyHeapTypeObject *et = (PyHeapTypeObject *)tp;
+    PyDictKeysObject *keys, *last;
+
+    if (!(tp->tp_flags & Py_TPFLAGS_HEAPTYPE) || et->ht_cached_keys == NULL)
+        return PyDict_New();
+    keys = et->ht_cached_keys;
+    if (keys->dk_next != NULL) {
+        /* Start new instances on the largest copy of the table */
+        for (last = keys->dk_next; last->dk_next != NULL;
+             last = last->dk_next)
+            ;
+        DK_INCREF(last);
+        et->ht_cached_keys = last;
+        DK_DECREF(keys);
+        keys = last;
+    }
+    return new_split_dict(keys);
+}
+
 /*
 The basic lookup function used by all operations.
 This is based on Algorithm D from Knuth Vol. 3, Sec. 6.4.
@@ -307,92 +516,83 @@ All arithmetic on hash should ignore overflow.
 contributions by Reimer Behrends, Jyrki Alakuijala, Vladimir Marangozov and
 Christian Tismer).
 
-lookdict() is general-purpose, and may return NULL if (and only if) a
-comparison raises an exception (this was new in Python 2.5).
+The probes go through the index table, and only Active slots lead to an
+entry whose key is compared.  lookdict() is general-purpose, and may
+return DKIX_ERROR if (and only if) a comparison raises an exception (this
+was new in Python 2.5).
 lookdict_string() below is specialized to string keys, comparison of which can
-never raise an exception; that function can never return NULL.  For both, when
-the key isn't found a PyDictEntry* is returned for which the me_value field is
-NULL; this is the slot in the dict at which the key would have been found, and
-the caller can (if it wishes) add the <key, value> pair to the returned
-PyDictEntry*.
+never raise an exception; that function never returns DKIX_ERROR.  For both,
+when the key isn't found DKIX_EMPTY is returned, and *hashpos is set to the
+slot of the index table where the key would have been found: the first
+Dummy slot met on the way, or the Unused slot that ended the search.  The
+caller can (if it wishes) add the <key, value> pair as a new entry pointed
+to from that slot.
 */
-static PyDictEntry *
-lookdict(PyDictObject *mp, PyObject *key, register long hash)
+static Py_ssize_t
+lookdict(PyDictObject *mp, PyObject *key, register long hash,
+         Py_ssize_t *hashpos)
 {
     register size_t i;
     register size_t perturb;
-    register PyDictEntry *freeslot;
-    register size_t mask = (size_t)mp->ma_mask;
-    PyDictEntry *ep0 = mp->ma_table;
+    register Py_ssize_t ix;
     register PyDictEntry *ep;
-    register int cmp;
+    Py_ssize_t freeslot;
+    size_t mask;
+    PyDictEntry *ep0;
+    int cmp;
     PyObject *startkey;
 
+  top:
+    mask = (size_t)mp->ma_mask;
+    ep0 = mp->ma_table;
+    freeslot = -1;
     i = (size_t)hash & mask;
-    ep = &ep0[i];
-    if (ep->me_key == NULL || ep->me_key == key)
-        return ep;
-
-    if (ep->me_key == dummy)
-        freeslot = ep;
-    else {
-        if (ep->me_hash == hash) {
-            startkey = ep->me_key;
-            Py_INCREF(startkey);
-            cmp = PyObject_RichCompareBool(startkey, key, Py_EQ);
-            Py_DECREF(startkey);
-            if (cmp < 0)
-                return NULL;
-            if (ep0 == mp->ma_table && ep->me_key == startkey) {
-                if (cmp > 0)
-                    return ep;
-            }
-            else {
-                /* The compare did major nasty stuff to the
-                 * dict:  start over.
-                 * XXX A clever adversary could prevent this
-                 * XXX from terminating.
-                 */
-                return lookdict(mp, key, hash);
-            }
-        }
-        freeslot = NULL;
-    }
-
-    /* In the loop, me_key == dummy is by far (factor of 100s) the
-       least likely outcome, so test for that last. */
     for (perturb = hash; ; perturb >>= PERTURB_SHIFT) {
-        i = (i << 2) + i + perturb + 1;
-        ep = &ep0[i & mask];
-        if (ep->me_key == NULL)
-            return freeslot == NULL ? ep : freeslot;
-        if (ep->me_key == key)
-            return ep;
-        if (ep->me_hash == hash && ep->me_key != dummy) {
-            startkey = ep->me_key;
-            Py_INCREF(startkey);
-            cmp = PyObject_RichCompareBool(startkey, key, Py_EQ);
-            Py_DECREF(startkey);
-            if (cmp < 0)
-                return NULL;
-            if (ep0 == mp->ma_table && ep->me_key == startkey) {
-                if (cmp > 0)
-                    return ep;
+        ix = DICT_GET_INDEX(mp, i & mask);
+        if (ix == DKIX_EMPTY) {
+            if (hashpos != NULL)
+                *hashpos = freeslot == -1 ? (Py_ssize_t)(i & mask) : freeslot;
+            return DKIX_EMPTY;
+        }
+        if (ix == DKIX_DUMMY) {
+            if (freeslot == -1)
+                freeslot = (Py_ssize_t)(i & mask);
+        }
+        else {
+            ep = &ep0[ix];
+            if (ep->me_key == key) {
+                if (hashpos != NULL)
+                    *hashpos = (Py_ssize_t)(i & mask);
+                return ix;
             }
-            else {
-                /* The compare did major nasty stuff to the
-                 * dict:  start over.
-                 * XXX A clever adversary could prevent this
-                 * XXX from terminating.
-                 */
-                return lookdict(mp, key, hash);
+            if (ep->me_hash == hash) {
+                startkey = ep->me_key;
+                Py_INCREF(startkey);
+                cmp = PyObject_RichCompareBool(startkey, key, Py_EQ);
+                Py_DECREF(startkey);
+                if (cmp < 0)
+                    return DKIX_ERROR;
+                if (ep0 == mp->ma_table && ep->me_key == startkey) {
+                    if (cmp > 0) {
+                        if (hashpos != NULL)
+                            *hashpos = (Py_ssize_t)(i & mask);
+                        return ix;
+                    }
+                }
+                else {
+                    /* The compare did major nasty stuff to the
+                     * dict:  start over.
+                     * XXX A clever adversary could prevent this
+                     * XXX from terminating.
+                     */
+                    goto top;
+                }
             }
         }
-        else if (ep->me_key == dummy && freeslot == NULL)
-            freeslot = ep;
+        i = (i << 2) + i + perturb + 1;
     }
     assert(0);          /* NOT REACHED */
-    return 0;
+    return DKIX_ERROR;
 }
 
 /*
@@ -404,15 +604,18 @@ lookdict(PyDictObject *mp, PyObject *key, register long hash)
  *
  * This is valuable because dicts with only string keys are very common.
  */
-static PyDictEntry *
-lookdict_string(PyDictObject *mp, PyObject *key, register long hash)
+static Py_ssize_t
+lookdict_string(PyDictObject *mp, PyObject *key, register long hash,
+                Py_ssize_t *hashpos)
 {
     register size_t i;
     register size_t perturb;
-    register PyDictEntry *freeslot;
+    register Py_ssize_t ix;
+    register PyDictEntry *ep;
     register size_t mask = (size_t)mp->ma_mask;
     PyDictEntry *ep0 = mp->ma_table;
-    register PyDictEntry *ep;
+    void *indices = mp->ma_indices;
+    Py_ssize_t freeslot = -1;
 
     /* Make sure this function doesn't have to handle non-string keys,
        including subclasses of str; e.g., one reason to subclass
@@ -423,37 +626,51 @@ lookdict_string(PyDictObject *mp, PyObject *key, register long hash)
         ++converted;
 #endif
         mp->ma_lookup = lookdict;
-        return lookdict(mp, key, hash);
-    }
-    i = hash & mask;
-    ep = &ep0[i];
-    if (ep->me_key == NULL || ep->me_key == key)
-        return ep;
-    if (ep->me_key == dummy)
-        freeslot = ep;
-    else {
-        if (ep->me_hash == hash && _PyString_Eq(ep->me_key, key))
-            return ep;
-        freeslot = NULL;
+        return lookdict(mp, key, hash, hashpos);
     }
-
-    /* In the loop, me_key == dummy is by far (factor of 100s) the
-       least likely outcome, so test for that last. */
+    i = (size_t)hash & mask;
     for (perturb = hash; ; perturb >>= PERTURB_SHIFT) {
+        ix = get_index(indices, mask + 1, i & mask);
+        if (ix == DKIX_EMPTY) {
+            if (hashpos != NULL)
+                *hashpos = freeslot == -1 ? (Py_ssize_t)(i & mask) : freeslot;
+            return DKIX_EMPTY;
+        }
+        if (ix == DKIX_DUMMY) {
+            if (freeslot == -1)
+                freeslot = (Py_ssize_t)(i & mask);
+        }
+        else {
+            ep = &ep0[ix];
+            if (ep->me_key == key
+                || (ep->me_hash == hash && _PyString_Eq(ep->me_key, key))) {
+                if (hashpos != NULL)
+                    *hashpos = (Py_ssize_t)(i & mask);
+                return ix;
+            }
+        }
         i = (i << 2) + i + perturb + 1;
-        ep = &ep0[i & mask];
-        if (ep->me_key == NULL)
-            return freeslot == NULL ? ep : freeslot;
-        if (ep->me_key == key
-            || (ep->me_hash == hash
-            && ep->me_key != dummy
-            && _PyString_Eq(ep->me_key, key)))
-            return ep;
-        if (ep->me_key == dummy && freeslot == NULL)
-            freeslot = ep;
     }
     assert(0);          /* NOT REACHED */
-    return 0;
+    return DKIX_ERROR;
+}
+
+/* Return the slot of the index table of combined table mp that points to
+   entry ix, whose key has the given hash. */
+static Py_ssize_t
+lookdict_index(PyDictObject *mp, long hash, Py_ssize_t ix)
+{
+    register size_t i;
+    register size_t perturb;
+    register size_t mask = (size_t)mp->ma_mask;
+
+    i = (size_t)hash & mask;
+    for (perturb = hash; DICT_GET_INDEX(mp, i & mask) != ix;
+         perturb >>= PERTURB_SHIFT) {
+        assert(DICT_GET_INDEX(mp, i & mask) != DKIX_EMPTY);
+        i = (i << 2) + i + perturb + 1;
+    }
+    return (Py_ssize_t)(i & mask);
 }
 
 #ifdef SHOW_TRACK_COUNT
@@ -482,7 +699,7 @@ _PyDict_MaybeUntrack(PyObject *op)
 {
     PyDictObject *mp;
     PyObject *value;
-    Py_ssize_t mask, i;
+    Py_ssize_t fill, i;
     PyDictEntry *ep;
 
     if (!PyDict_CheckExact(op) || !_PyObject_GC_IS_TRACKED(op))
@@ -490,9 +707,9 @@ _PyDict_MaybeUntrack(PyObject *op)
 
     mp = (PyDictObject *) op;
     ep = mp->ma_table;
-    mask = mp->ma_mask;
-    for (i = 0; i <= mask; i++) {
-        if ((value = ep[i].me_value) == NULL)
+    fill = mp->ma_fill;
+    for (i = 0; i < fill; i++) {
+        if ((value = DICT_VALUE(mp, i)) == NULL)
             continue;
         if (_PyObject_GC_MAY_BE_TRACKED(value) ||
             _PyObject_GC_MAY_BE_TRACKED(ep[i].me_key))
@@ -503,9 +720,130 @@ _PyDict_MaybeUntrack(PyObject *op)
 }
 
 
+static int dictresize(PyDictObject *mp, Py_ssize_t minused);
+
+/*
+Move split table mp on to the larger copy of its keys table (dk_next),
+making the copy first if need be.  The copy holds the same keys in the same
+entries, so the values keep their places.  Returns 0 on success, -1 on
+error, and 1 if the keys table is too large to be copied.
+*/
+static int
+split_move_on(PyDictObject *mp)
+{
+    PyDictKeysObject *oldkeys = mp->ma_keys;
+    PyDictKeysObject *newkeys = oldkeys->dk_next;
+    PyObject **oldvalues = mp->ma_values;
+    PyObject **newvalues;
+    PyDictEntry *ep;
+    Py_ssize_t i, n, newsize;
+
+    if (newkeys == NULL) {
+        newsize = (oldkeys->dk_mask + 1) * 2;
+        if (newsize > SHARED_KEYS_MAX_SIZE)
+            return 1;
+        newkeys = new_keys_object(newsize);
+        if (newkeys == NULL)
+            return -1;
+        for (i = 0; i < oldkeys->dk_nkeys; i++) {
+            ep = &oldkeys->dk_table[i];
+            Py_INCREF(ep->me_key);
+            newkeys->dk_table[i] = *ep;
+            set_index(newkeys->dk_indices, newsize,
+                      find_empty_slot(newkeys->dk_indices, newsize - 1,
+                                      (long)ep->me_hash), i);
+        }
+        newkeys->dk_nkeys = oldkeys->dk_nkeys;
+        oldkeys->dk_next = newkeys;
+    }
+    n = PyDict_USABLE(newkeys->dk_mask + 1);
+    newvalues = PyMem_NEW(PyObject *, n);
+    if (newvalues == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    memset(newvalues, 0, n * sizeof(PyObject *));
+    memcpy(newvalues, oldvalues, mp->ma_fill * sizeof(PyObject *));
+    DK_INCREF(newkeys);
+    mp->ma_keys = newkeys;
+    mp->ma_values = newvalues;
+    mp->ma_table = newkeys->dk_table;
+    mp->ma_indices = newkeys->dk_indices;
+    mp->ma_mask = newkeys->dk_mask;
+    PyMem_FREE(oldvalues);
+    DK_DECREF(oldkeys);
+    return 0;
+}
+
+/*
+insertdict() for a split table.  Returns 0 on success and -1 on error,
+having eaten the references to key and value, or 1 if the table had to be
+made combined first, leaving the insertion to the caller.
+*/
+static int
+insertdict_split(PyDictObject *mp, PyObject *key, long hash, PyObject *value)
+{
+    PyObject *old_value;
+    PyDictKeysObject *keys;
+    PyDictEntry *ep;
+    Py_ssize_t ix, hashpos;
+    int res;
+
+    if (!PyString_CheckExact(key))
+        goto combine;
+    for (;;) {
+        /* The shared keys are all strings, so this can't fail */
+        ix = lookdict_string(mp, key, hash, &hashpos);
+        if (ix >= 0)
+            break;
+        keys = mp->ma_keys;
+        if (keys->dk_nkeys < PyDict_USABLE(keys->dk_mask + 1)) {
+            /* A new key: add it to the shared table */
+            ix = keys->dk_nkeys++;
+            ep = &keys->dk_table[ix];
+            ep->me_key = key;           /* the keys table takes the reference */
+            ep->me_hash = (Py_ssize_t)hash;
+            set_index(keys->dk_indices, keys->dk_mask + 1, hashpos, ix);
+            key = NULL;
+            break;
+        }
+        res = split_move_on(mp);
+        if (res < 0)
+            goto error;
+        if (res > 0)
+            goto combine;
+    }
+    old_value = mp->ma_values[ix];
+    /* Giving the dict a key that comes before its last one would put
+       it out of insertion order */
+    if (old_value == NULL && ix < mp->ma_fill)
+        goto combine;
+    MAINTAIN_TRACKING(mp, mp->ma_table[ix].me_key, value);
+    mp->ma_version_tag = DICT_NEXT_VERSION();
+    Py_XDECREF(key);
+    mp->ma_values[ix] = value;
+    if (old_value == NULL) {
+        mp->ma_used++;
+        mp->ma_fill = ix + 1;
+    }
+    else
+        Py_DECREF(old_value); /* which **CAN** re-enter */
+    return 0;
+
+  combine:
+    if (dictresize(mp, (mp->ma_used + 1) * 2) == 0)
+        return 1;
+  error:
+    Py_DECREF(key);
+    Py_DECREF(value);
+    return -1;
+}
+
 /*
 Internal routine to insert a new item into the table.
 Used both by the internal resize routine and by the public insert routine.
+A new key is appended to the entries, which are first compacted into a
+larger (or, if many keys were deleted, smaller) table when they're used up.
 Eats a reference to key and one to value.
 Returns -1 if an error occurred, or 0 on success.
 */
@@ -514,34 +852,58 @@ insertdict(register PyDictObject *mp, PyObject *key, long hash, PyObject *value)
 {
     PyObject *old_value;
     register PyDictEntry *ep;
-    typedef PyDictEntry *(*lookupfunc)(PyDictObject *, PyObject *, long);
+    Py_ssize_t ix, hashpos;
 
+    if (mp->ma_values != NULL) {
+        int res = insertdict_split(mp, key, hash, value);
+        if (res <= 0)
+            return res;
+    }
     assert(mp->ma_lookup != NULL);
-    ep = mp->ma_lookup(mp, key, hash);
-    if (ep == NULL) {
+    ix = mp->ma_lookup(mp, key, hash, &hashpos);
+    if (ix == DKIX_ERROR) {
         Py_DECREF(key);
         Py_DECREF(value);
         return -1;
     }
     MAINTAIN_TRACKING(mp, key, value);
-    if (ep->me_value != NULL) {
+    if (ix >= 0) {
+        mp->ma_version_tag = DICT_NEXT_VERSION();
+        ep = &mp->ma_table[ix];
         old_value = ep->me_value;
         ep->me_value = value;
         Py_DECREF(old_value); /* which **CAN** re-enter */
         Py_DECREF(key);
+        return 0;
     }
-    else {
-        if (ep->me_key == NULL)
-            mp->ma_fill++;
-        else {
-            assert(ep->me_key == dummy);
-            Py_DECREF(dummy);
+    if (mp->ma_fill >= PyDict_USABLE(mp->ma_mask + 1)) {
+        /* Normally, this doubles or quadruples the size, but it's also
+         * possible for the dict to shrink (if ma_fill is much larger than
+         * ma_used, meaning a lot of dict keys have been deleted).
+         *
+         * Quadrupling the size improves average dictionary sparseness
+         * (reducing collisions) at the cost of some memory.  It also halves
+         * the number of expensive resize operations in a growing dictionary.
+         *
+         * Very large dictionaries (over 50K items) use doubling instead.
+         * This may help applications with severe memory constraints.
+         */
+        if (dictresize(mp, (mp->ma_used > 50000 ? 2 : 4) * mp->ma_used)) {
+            Py_DECREF(key);
+            Py_DECREF(value);
+            return -1;
         }
-        ep->me_key = key;
-        ep->me_hash = (Py_ssize_t)hash;
-        ep->me_value = value;
-        mp->ma_used++;
+        hashpos = find_empty_slot(mp->ma_indices, mp->ma_mask, hash);
     }
+    mp->ma_version_tag = DICT_NEXT_VERSION();
+    ix = mp->ma_fill;
+    ep = &mp->ma_table[ix];
+    DICT_SET_INDEX(mp, hashpos, ix);
+    ep->me_key = key;
+    ep->me_hash = (Py_ssize_t)hash;
+    ep->me_value = value;
+    mp->ma_fill++;
+    mp->ma_used++;
     return 0;
 }
 
@@ -557,40 +919,36 @@ static void
 insertdict_clean(register PyDictObject *mp, PyObject *key, long hash,
                  PyObject *value)
 {
-    register size_t i;
-    register size_t perturb;
-    register size_t mask = (size_t)mp->ma_mask;
-    PyDictEntry *ep0 = mp->ma_table;
     register PyDictEntry *ep;
 
     MAINTAIN_TRACKING(mp, key, value);
-    i = hash & mask;
-    ep = &ep0[i];
-    for (perturb = hash; ep->me_key != NULL; perturb >>= PERTURB_SHIFT) {
-        i = (i << 2) + i + perturb + 1;
-        ep = &ep0[i & mask];
-    }
-    assert(ep->me_value == NULL);
-    mp->ma_fill++;
+    ep = &mp->ma_table[mp->ma_fill];
+    DICT_SET_INDEX(mp, find_empty_slot(mp->ma_indices, mp->ma_mask, hash),
+                   mp->ma_fill);
     ep->me_key = key;
     ep->me_hash = (Py_ssize_t)hash;
     ep->me_value = value;
+    mp->ma_fill++;
     mp->ma_used++;
 }
 
 /*
 Restructure the table by allocating a new table and reinserting all
-items again.  When entries have been deleted, the new table may
-actually be smaller than the old one.
+items again, in the same order.  When entries have been deleted, the new
+table may actually be smaller than the old one.  A split table becomes
+combined.
 */
 static int
 dictresize(PyDictObject *mp, Py_ssize_t minused)
 {
-    Py_ssize_t newsize;
+    Py_ssize_t newsize, ixsize;
     PyDictEntry *oldtable, *newtable, *ep;
-    Py_ssize_t i;
+    void *oldindices, *newindices;
+    PyDictKeysObject *oldkeys;
+    PyObject **oldvalues;
+    Py_ssize_t i, oldfill;
     int is_oldtable_malloced;
-    PyDictEntry small_copy[PyDict_MINSIZE];
+    PyDictEntry small_copy[PyDict_USABLE(PyDict_MINSIZE)];
 
     assert(minused >= 0);
 
@@ -607,62 +965,83 @@ dictresize(PyDictObject *mp, Py_ssize_t minused)
     /* Get space for a new table. */
     oldtable = mp->ma_table;
     assert(oldtable != NULL);
-    is_oldtable_malloced = oldtable != mp->ma_smalltable;
+    oldindices = mp->ma_indices;
+    oldvalues = mp->ma_values;
+    oldfill = mp->ma_fill;
+    is_oldtable_malloced = oldvalues == NULL && DICT_IS_MALLOCED(mp);
 
-    if (newsize == PyDict_MINSIZE) {
+    if (newsize == PyDict_MINSIZE && mp->ma_keys == NULL) {
         /* A large table is shrinking, or we can't get any smaller. */
         newtable = mp->ma_smalltable;
+        newindices = mp->ma_smallindices;
         if (newtable == oldtable) {
             if (mp->ma_fill == mp->ma_used) {
-                /* No dummies, so no point doing anything. */
+                /* No deleted entries, so no point doing anything. */
                 return 0;
             }
             /* We're not going to resize it, but rebuild the
-               table anyway to purge old dummy entries.
-               Subtle:  This is *necessary* if fill==size,
-               as lookdict needs at least one virgin slot to
-               terminate failing searches.  If fill < size, it's
-               merely desirable, as dummies slow searches. */
+               table anyway to drop the deleted entries and purge
+               the dummy slots.
+               Subtle:  This is *necessary* if the entries are used
+               up, as there is no room for another one. */
             assert(mp->ma_fill > mp->ma_used);
             memcpy(small_copy, oldtable, sizeof(small_copy));
             oldtable = small_copy;
         }
     }
     else {
-        newtable = PyMem_NEW(PyDictEntry, newsize);
-        if (newtable == NULL) {
+        ixsize = DK_INDICES_SIZE(newsize);
+        if ((size_t)PyDict_USABLE(newsize) >
+            ((size_t)PY_SSIZE_T_MAX - ixsize) / sizeof(PyDictEntry)) {
             PyErr_NoMemory();
             return -1;
         }
+        newindices = PyMem_MALLOC(ixsize +
+                                  PyDict_USABLE(newsize) * sizeof(PyDictEntry));
+        if (newindices == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        newtable = (PyDictEntry *)((char *)newindices + ixsize);
     }
 
     /* Make the dict empty, using the new table. */
     assert(newtable != oldtable);
     mp->ma_table = newtable;
+    mp->ma_indices = newindices;
     mp->ma_mask = newsize - 1;
-    memset(newtable, 0, sizeof(PyDictEntry) * newsize);
+    memset(newindices, 0xff, DK_INDICES_SIZE(newsize));
     mp->ma_used = 0;
-    i = mp->ma_fill;
     mp->ma_fill = 0;
 
+    if (oldvalues != NULL) {
+        /* Combine a split table.  The keys stay in the shared table, so
+           the dict needs references of its own. */
+        oldkeys = mp->ma_keys;
+        mp->ma_keys = &combined_keys;
+        mp->ma_values = NULL;
+        for (i = 0; i < oldfill; i++) {
+            if (oldvalues[i] != NULL) {
+                Py_INCREF(oldtable[i].me_key);
+                insertdict_clean(mp, oldtable[i].me_key,
+                                 (long)oldtable[i].me_hash, oldvalues[i]);
+            }
+        }
+        PyMem_FREE(oldvalues);
+        DK_DECREF(oldkeys);
+        return 0;
+    }
+
     /* Copy the data over; this is refcount-neutral for active entries;
-       dummy entries aren't copied over, of course */
-    for (ep = oldtable; i > 0; ep++) {
-        if (ep->me_value != NULL) {             /* active entry */
-            --i;
+       deleted entries hold no references */
+    for (ep = oldtable, i = 0; i < oldfill; ep++, i++) {
+        if (ep->me_value != NULL)
             insertdict_clean(mp, ep->me_key, (long)ep->me_hash,
                              ep->me_value);
-        }
-        else if (ep->me_key != NULL) {          /* dummy entry */
-            --i;
-            assert(ep->me_key == dummy);
-            Py_DECREF(ep->me_key);
-        }
-        /* else key == value == NULL:  nothing to do */
     }
 
     if (is_oldtable_malloced)
-        PyMem_DEL(oldtable);
+        PyMem_FREE(oldindices);
     return 0;
 }
 
@@ -698,7 +1077,7 @@ PyDict_GetItem(PyObject *op, PyObject *key)
 {
     long hash;
     PyDictObject *mp = (PyDictObject *)op;
-    PyDictEntry *ep;
+    Py_ssize_t ix;
     PyThreadState *tstate;
     if (!PyDict_Check(op))
         return NULL;
@@ -722,20 +1101,21 @@ PyDict_GetItem(PyObject *op, PyObject *key)
         /* preserve the existing exception */
         PyObject *err_type, *err_value, *err_tb;
         PyErr_Fetch(&err_type, &err_value, &err_tb);
-        ep = (mp->ma_lookup)(mp, key, hash);
+        ix = (mp->ma_lookup)(mp, key, hash, NULL);
         /* ignore errors */
         PyErr_Restore(err_type, err_value, err_tb);
-        if (ep == NULL)
+        if (ix < 0)
             return NULL;
     }
     else {
-        ep = (mp->ma_lookup)(mp, key, hash);
-        if (ep == NULL) {
-            PyErr_Clear();
+        ix = (mp->ma_lookup)(mp, key, hash, NULL);
+        if (ix < 0) {
+            if (ix == DKIX_ERROR)
+                PyErr_Clear();
             return NULL;
         }
     }
-    return ep->me_value;
+    return DICT_VALUE(mp, ix);
 }
 
 /* CAUTION: PyDict_SetItem() must guarantee that it won't resize the
@@ -749,7 +1129,6 @@ PyDict_SetItem(register PyObject *op, PyObject *key, PyObject *value)
 {
     register PyDictObject *mp;
     register long hash;
-    register Py_ssize_t n_used;
 
     if (!PyDict_Check(op)) {
         PyErr_BadInternalCall();
@@ -768,29 +1147,42 @@ PyDict_SetItem(register PyObject *op, PyObject *key, PyObject *value)
         if (hash == -1)
             return -1;
     }
-    assert(mp->ma_fill <= mp->ma_mask);  /* at least one empty slot */
-    n_used = mp->ma_used;
+    assert(mp->ma_fill <= PyDict_USABLE(mp->ma_mask + 1));
     Py_INCREF(value);
     Py_INCREF(key);
-    if (insertdict(mp, key, hash, value) != 0)
-        return -1;
-    /* If we added a key, we can safely resize.  Otherwise just return!
-     * If fill >= 2/3 size, adjust size.  Normally, this doubles or
-     * quaduples the size, but it's also possible for the dict to shrink
-     * (if ma_fill is much larger than ma_used, meaning a lot of dict
-     * keys have been * deleted).
-     *
-     * Quadrupling the size improves average dictionary sparseness
-     * (reducing collisions) at the cost of some memory and iteration
-     * speed (which loops over every possible entry).  It also halves
-     * the number of expensive resize operations in a growing dictionary.
-     *
-     * Very large dictionaries (over 50K items) use doubling instead.
-     * This may help applications with severe memory constraints.
-     */
-    if (!(mp->ma_used > n_used && mp->ma_fill*3 >= (mp->ma_mask+1)*2))
-        return 0;
-    return dictresize(mp, (mp->ma_used > 50000 ? 2 : 4) * mp->ma_used);
+    return insertdict(mp, key, hash, value);
+}
+
+/* Delete the item in entry ix of mp, which slot hashpos of the index table
+   points to (unused for a split table).  The references to the key and
+   value are handed to the caller; the key is NULL for a split table, whose
+   keys stay in the shared table. */
+static void
+delitem_common(PyDictObject *mp, Py_ssize_t hashpos, Py_ssize_t ix,
+               PyObject **pkey, PyObject **pvalue)
+{
+    PyDictEntry *ep;
+
+    mp->ma_used--;
+    mp->ma_version_tag = DICT_NEXT_VERSION();
+    if (mp->ma_values != NULL) {
+        *pkey = NULL;
+        *pvalue = mp->ma_values[ix];
+        mp->ma_values[ix] = NULL;
+        /* The dict may take its last keys again without becoming
+           combined */
+        while (mp->ma_fill > 0 && mp->ma_values[mp->ma_fill - 1] == NULL)
+            mp->ma_fill--;
+        return;
+    }
+    assert(DICT_GET_INDEX(mp, hashpos) == ix);
+    DICT_SET_INDEX(mp, hashpos, DKIX_DUMMY);
+    ep = &mp->ma_table[ix];
+    *pkey = ep->me_key;
+    *pvalue = ep->me_value;
+    ep->me_key = NULL;
+    ep->me_value = NULL;
+    ep->me_hash = -1;
 }
 
 int
@@ -798,7 +1190,7 @@ PyDict_DelItem(PyObject *op, PyObject *key)
 {
     register PyDictObject *mp;
     register long hash;
-    register PyDictEntry *ep;
+    Py_ssize_t ix, hashpos;
     PyObject *old_value, *old_key;
 
     if (!PyDict_Check(op)) {
@@ -813,46 +1205,62 @@ PyDict_DelItem(PyObject *op, PyObject *key)
             return -1;
     }
     mp = (PyDictObject *)op;
-    ep = (mp->ma_lookup)(mp, key, hash);
-    if (ep == NULL)
+    ix = (mp->ma_lookup)(mp, key, hash, &hashpos);
+    if (ix == DKIX_ERROR)
         return -1;
-    if (ep->me_value == NULL) {
+    if (ix == DKIX_EMPTY || DICT_VALUE(mp, ix) == NULL) {
         set_key_error(key);
         return -1;
     }
-    old_key = ep->me_key;
-    Py_INCREF(dummy);
-    ep->me_key = dummy;
-    old_value = ep->me_value;
-    ep->me_value = NULL;
-    mp->ma_used--;
+    delitem_common(mp, hashpos, ix, &old_key, &old_value);
     Py_DECREF(old_value);
-    Py_DECREF(old_key);
+    Py_XDECREF(old_key);
     return 0;
 }
 
+/* Clear a dict that has no ma_smalltable to fall back on, by deleting
+   the items one at a time.  Decrefs can mutate the dict, so the table is
+   looked at again for every entry. */
+static void
+dict_clear_in_place(PyDictObject *mp)
+{
+    Py_ssize_t i, hashpos;
+    PyObject *old_key, *old_value;
+
+    mp->ma_version_tag = DICT_NEXT_VERSION();
+    for (i = 0; i < mp->ma_fill; i++) {
+        if (DICT_VALUE(mp, i) == NULL)
+            continue;
+        hashpos = -1;
+        if (mp->ma_values == NULL)
+            hashpos = lookdict_index(mp, (long)mp->ma_table[i].me_hash, i);
+        delitem_common(mp, hashpos, i, &old_key, &old_value);
+        Py_DECREF(old_value);
+        Py_XDECREF(old_key);
+    }
+}
+
 void
 PyDict_Clear(PyObject *op)
 {
     PyDictObject *mp;
     PyDictEntry *ep, *table;
+    void *indices;
     int table_is_malloced;
     Py_ssize_t fill;
-    PyDictEntry small_copy[PyDict_MINSIZE];
-#ifdef Py_DEBUG
-    Py_ssize_t i, n;
-#endif
+    PyDictEntry small_copy[PyDict_USABLE(PyDict_MINSIZE)];
 
     if (!PyDict_Check(op))
         return;
     mp = (PyDictObject *)op;
-#ifdef Py_DEBUG
-    n = mp->ma_mask + 1;
-    i = 0;
-#endif
+    if (mp->ma_keys != NULL) {
+        dict_clear_in_place(mp);
+        return;
+    }
 
     table = mp->ma_table;
     assert(table != NULL);
+    indices = mp->ma_indices;
     table_is_malloced = table != mp->ma_smalltable;
 
     /* This is delicate.  During the process of clearing the dict,
@@ -862,6 +1270,7 @@ PyDict_Clear(PyObject *op)
      * clearing.
      */
     fill = mp->ma_fill;
+    mp->ma_version_tag = DICT_NEXT_VERSION();
     if (table_is_malloced)
         EMPTY_TO_MINSIZE(mp);
 
@@ -870,7 +1279,7 @@ PyDict_Clear(PyObject *op)
          * Afraid the only safe way is to copy the dict entries into
          * another small table first.
          */
-        memcpy(small_copy, table, sizeof(small_copy));
+        memcpy(small_copy, table, fill * sizeof(PyDictEntry));
         table = small_copy;
         EMPTY_TO_MINSIZE(mp);
     }
@@ -880,24 +1289,17 @@ PyDict_Clear(PyObject *op)
      * assert that the refcount on table is 1 now, i.e. that this function
      * has unique access to it, so decref side-effects can't alter it.
      */
-    for (ep = table; fill > 0; ++ep) {
-#ifdef Py_DEBUG
-        assert(i < n);
-        ++i;
-#endif
+    for (ep = table; fill > 0; ++ep, --fill) {
         if (ep->me_key) {
-            --fill;
             Py_DECREF(ep->me_key);
-            Py_XDECREF(ep->me_value);
+            Py_DECREF(ep->me_value);
         }
-#ifdef Py_DEBUG
         else
             assert(ep->me_value == NULL);
-#endif
     }
 
     if (table_is_malloced)
-        PyMem_DEL(table);
+        PyMem_FREE(indices);
 }
 
 /*
@@ -910,6 +1312,8 @@ PyDict_Clear(PyObject *op)
  *              Refer to borrowed references in key and value.
  *     }
  *
+ * The items come in the order their keys were inserted.
+ *
  * CAUTION:  In general, it isn't safe to use PyDict_Next in a loop that
  * mutates the dict.  One exception:  it is safe if the loop merely changes
  * the values associated with the keys (but doesn't insert new keys or
@@ -919,25 +1323,27 @@ int
 PyDict_Next(PyObject *op, Py_ssize_t *ppos, PyObject **pkey, PyObject **pvalue)
 {
     register Py_ssize_t i;
-    register Py_ssize_t mask;
+    register Py_ssize_t fill;
     register PyDictEntry *ep;
+    PyDictObject *mp;
 
     if (!PyDict_Check(op))
         return 0;
     i = *ppos;
     if (i < 0)
         return 0;
-    ep = ((PyDictObject *)op)->ma_table;
-    mask = ((PyDictObject *)op)->ma_mask;
-    while (i <= mask && ep[i].me_value == NULL)
+    mp = (PyDictObject *)op;
+    ep = mp->ma_table;
+    fill = mp->ma_fill;
+    while (i < fill && DICT_VALUE(mp, i) == NULL)
         i++;
     *ppos = i+1;
-    if (i > mask)
+    if (i >= fill)
         return 0;
     if (pkey)
         *pkey = ep[i].me_key;
     if (pvalue)
-        *pvalue = ep[i].me_value;
+        *pvalue = DICT_VALUE(mp, i);
     return 1;
 }
 
@@ -946,26 +1352,28 @@ int
 _PyDict_Next(PyObject *op, Py_ssize_t *ppos, PyObject **pkey, PyObject **pvalue, long *phash)
 {
     register Py_ssize_t i;
-    register Py_ssize_t mask;
+    register Py_ssize_t fill;
     register PyDictEntry *ep;
+    PyDictObject *mp;
 
     if (!PyDict_Check(op))
         return 0;
     i = *ppos;
     if (i < 0)
         return 0;
-    ep = ((PyDictObject *)op)->ma_table;
-    mask = ((PyDictObject *)op)->ma_mask;
-    while (i <= mask && ep[i].me_value == NULL)
+    mp = (PyDictObject *)op;
+    ep = mp->ma_table;
+    fill = mp->ma_fill;
+    while (i < fill && DICT_VALUE(mp, i) == NULL)
         i++;
     *ppos = i+1;
-    if (i > mask)
+    if (i >= fill)
         return 0;
     *phash = (long)(ep[i].me_hash);
     if (pkey)
         *pkey = ep[i].me_key;
     if (pvalue)
-        *pvalue = ep[i].me_value;
+        *pvalue = DICT_VALUE(mp, i);
     return 1;
 }
 
@@ -975,19 +1383,27 @@ static void
 dict_dealloc(register PyDictObject *mp)
 {
     register PyDictEntry *ep;
-    Py_ssize_t fill = mp->ma_fill;
+    Py_ssize_t i, fill = mp->ma_fill;
     PyObject_GC_UnTrack(mp);
     Py_TRASHCAN_SAFE_BEGIN(mp)
-    for (ep = mp->ma_table; fill > 0; ep++) {
-        if (ep->me_key) {
-            --fill;
-            Py_DECREF(ep->me_key);
-            Py_XDECREF(ep->me_value);
+    if (mp->ma_values != NULL) {
+        for (i = 0; i < fill; i++)
+            Py_XDECREF(mp->ma_values[i]);
+        PyMem_FREE(mp->ma_values);
+        DK_DECREF(mp->ma_keys);
+    }
+    else {
+        for (ep = mp->ma_table; fill > 0; ep++, fill--) {
+            if (ep->me_key) {
+                Py_DECREF(ep->me_key);
+                Py_XDECREF(ep->me_value);
+            }
         }
+        if (DICT_IS_MALLOCED(mp))
+            PyMem_FREE(mp->ma_indices);
     }
-    if (mp->ma_table != mp->ma_smalltable)
-        PyMem_DEL(mp->ma_table);
-    if (numfree < PyDict_MAXFREELIST && Py_TYPE(mp) == &PyDict_Type)
+    if (numfree < PyDict_MAXFREELIST && Py_TYPE(mp) == &PyDict_Type &&
+        mp->ma_keys == NULL)
         free_list[numfree++] = mp;
     else
         Py_TYPE(mp)->tp_free((PyObject *)mp);
@@ -1015,9 +1431,9 @@ dict_print(register PyDictObject *mp, register FILE *fp, register int flags)
     fprintf(fp, "{");
     Py_END_ALLOW_THREADS
     any = 0;
-    for (i = 0; i <= mp->ma_mask; i++) {
+    for (i = 0; i < mp->ma_fill; i++) {
         PyDictEntry *ep = mp->ma_table + i;
-        PyObject *pvalue = ep->me_value;
+        PyObject *pvalue = DICT_VALUE(mp, i);
         if (pvalue != NULL) {
             /* Prevent PyObject_Repr from deleting value during
                key format */
@@ -1140,7 +1556,7 @@ dict_subscript(PyDictObject *mp, register PyObject *key)
 {
     PyObject *v;
     long hash;
-    PyDictEntry *ep;
+    Py_ssize_t ix;
     assert(mp->ma_table != NULL);
     if (!PyString_CheckExact(key) ||
         (hash = ((PyStringObject *) key)->ob_shash) == -1) {
@@ -1148,10 +1564,10 @@ dict_subscript(PyDictObject *mp, register PyObject *key)
         if (hash == -1)
             return NULL;
     }
-    ep = (mp->ma_lookup)(mp, key, hash);
-    if (ep == NULL)
+    ix = (mp->ma_lookup)(mp, key, hash, NULL);
+    if (ix == DKIX_ERROR)
         return NULL;
-    v = ep->me_value;
+    v = ix == DKIX_EMPTY ? NULL : DICT_VALUE(mp, ix);
     if (v == NULL) {
         if (!PyDict_CheckExact(mp)) {
             /* Look up __missing__ method if we're a subclass. */
@@ -1198,7 +1614,7 @@ dict_keys(register PyDictObject *mp)
     register PyObject *v;
     register Py_ssize_t i, j;
     PyDictEntry *ep;
-    Py_ssize_t mask, n;
+    Py_ssize_t fill, n;
 
   again:
     n = mp->ma_used;
@@ -1213,9 +1629,9 @@ dict_keys(register PyDictObject *mp)
         goto again;
     }
     ep = mp->ma_table;
-    mask = mp->ma_mask;
-    for (i = 0, j = 0; i <= mask; i++) {
-        if (ep[i].me_value != NULL) {
+    fill = mp->ma_fill;
+    for (i = 0, j = 0; i < fill; i++) {
+        if (DICT_VALUE(mp, i) != NULL) {
             PyObject *key = ep[i].me_key;
             Py_INCREF(key);
             PyList_SET_ITEM(v, j, key);
@@ -1231,8 +1647,7 @@ dict_values(register PyDictObject *mp)
 {
     register PyObject *v;
     register Py_ssize_t i, j;
-    PyDictEntry *ep;
-    Py_ssize_t mask, n;
+    Py_ssize_t fill, n;
 
   again:
     n = mp->ma_used;
@@ -1246,11 +1661,10 @@ dict_values(register PyDictObject *mp)
         Py_DECREF(v);
         goto again;
     }
-    ep = mp->ma_table;
-    mask = mp->ma_mask;
-    for (i = 0, j = 0; i <= mask; i++) {
-        if (ep[i].me_value != NULL) {
-            PyObject *value = ep[i].me_value;
+    fill = mp->ma_fill;
+    for (i = 0, j = 0; i < fill; i++) {
+        PyObject *value = DICT_VALUE(mp, i);
+        if (value != NULL) {
             Py_INCREF(value);
             PyList_SET_ITEM(v, j, value);
             j++;
@@ -1265,7 +1679,7 @@ dict_items(register PyDictObject *mp)
 {
     register PyObject *v;
     register Py_ssize_t i, j, n;
-    Py_ssize_t mask;
+    Py_ssize_t fill;
     PyObject *item, *key, *value;
     PyDictEntry *ep;
 
@@ -1295,9 +1709,9 @@ dict_items(register PyDictObject *mp)
     }
     /* Nothing we do below makes any function calls. */
     ep = mp->ma_table;
-    mask = mp->ma_mask;
-    for (i = 0, j = 0; i <= mask; i++) {
-        if ((value=ep[i].me_value) != NULL) {
+    fill = mp->ma_fill;
+    for (i = 0, j = 0; i < fill; i++) {
+        if ((value = DICT_VALUE(mp, i)) != NULL) {
             key = ep[i].me_key;
             item = PyList_GET_ITEM(v, j);
             Py_INCREF(key);
@@ -1550,22 +1964,25 @@ PyDict_Merge(PyObject *a, PyObject *b, int override)
             override = 1;
         /* Do one big resize at the start, rather than
          * incrementally resizing as we insert new items.  Expect
-         * that there will be no (or few) overlapping keys.
+         * that there will be no (or few) overlapping keys.  A split
+         * table is left alone, so that it stays split if it can.
          */
-        if ((mp->ma_fill + other->ma_used)*3 >= (mp->ma_mask+1)*2) {
+        if (mp->ma_values == NULL &&
+            mp->ma_fill + other->ma_used > PyDict_USABLE(mp->ma_mask+1)) {
            if (dictresize(mp, (mp->ma_used + other->ma_used)*2) != 0)
                return -1;
         }
-        for (i = 0; i <= other->ma_mask; i++) {
+        for (i = 0; i < other->ma_fill; i++) {
+            PyObject *value = DICT_VALUE(other, i);
             entry = &other->ma_table[i];
-            if (entry->me_value != NULL &&
+            if (value != NULL &&
                 (override ||
                  PyDict_GetItem(a, entry->me_key) == NULL)) {
                 Py_INCREF(entry->me_key);
-                Py_INCREF(entry->me_value);
+                Py_INCREF(value);
                 if (insertdict(mp, entry->me_key,
                                (long)entry->me_hash,
-                               entry->me_value) != 0)
+                               value) != 0)
                     return -1;
             }
         }
@@ -1697,9 +2114,9 @@ characterize(PyDictObject *a, PyDictObject *b, PyObject **pval)
     Py_ssize_t i;
     int cmp;
 
-    for (i = 0; i <= a->ma_mask; i++) {
+    for (i = 0; i < a->ma_fill; i++) {
         PyObject *thiskey, *thisaval, *thisbval;
-        if (a->ma_table[i].me_value == NULL)
+        if (DICT_VALUE(a, i) == NULL)
             continue;
         thiskey = a->ma_table[i].me_key;
         Py_INCREF(thiskey);  /* keep alive across compares */
@@ -1710,8 +2127,8 @@ characterize(PyDictObject *a, PyDictObject *b, PyObject **pval)
                 goto Fail;
             }
             if (cmp > 0 ||
-                i > a->ma_mask ||
-                a->ma_table[i].me_value == NULL)
+                i >= a->ma_fill ||
+                DICT_VALUE(a, i) == NULL)
             {
                 /* Not the *smallest* a key; or maybe it is
                  * but the compare shrunk the dict so we can't
@@ -1725,7 +2142,7 @@ characterize(PyDictObject *a, PyDictObject *b, PyObject **pval)
         }
 
         /* Compare a[thiskey] to b[thiskey]; cmp <- true iff equal. */
-        thisaval = a->ma_table[i].me_value;
+        thisaval = DICT_VALUE(a, i);
         assert(thisaval);
         Py_INCREF(thisaval);   /* keep alive */
         thisbval = PyDict_GetItem((PyObject *)b, thiskey);
@@ -1825,8 +2242,8 @@ dict_equal(PyDictObject *a, PyDictObject *b)
         return 0;
 
     /* Same # of entries -- check all of 'em.  Exit early on any diff. */
-    for (i = 0; i <= a->ma_mask; i++) {
-        PyObject *aval = a->ma_table[i].me_value;
+    for (i = 0; i < a->ma_fill; i++) {
+        PyObject *aval = DICT_VALUE(a, i);
         if (aval != NULL) {
             int cmp;
             PyObject *bval;
@@ -1882,7 +2299,7 @@ static PyObject *
 dict_contains(register PyDictObject *mp, PyObject *key)
 {
     long hash;
-    PyDictEntry *ep;
+    Py_ssize_t ix;
 
     if (!PyString_CheckExact(key) ||
         (hash = ((PyStringObject *) key)->ob_shash) == -1) {
@@ -1890,10 +2307,10 @@ dict_contains(register PyDictObject *mp, PyObject *key)
         if (hash == -1)
             return NULL;
     }
-    ep = (mp->ma_lookup)(mp, key, hash);
-    if (ep == NULL)
+    ix = (mp->ma_lookup)(mp, key, hash, NULL);
+    if (ix == DKIX_ERROR)
         return NULL;
-    return PyBool_FromLong(ep->me_value != NULL);
+    return PyBool_FromLong(ix >= 0 && DICT_VALUE(mp, ix) != NULL);
 }
 
 static PyObject *
@@ -1906,15 +2323,17 @@ dict_has_key(register PyDictObject *mp, PyObject *key)
 }
 
 static PyObject *
-dict_get(register PyDictObject *mp, PyObject *args)
+dict_get(register PyDictObject *mp, PyObject **args, Py_ssize_t nargs,
+         PyObject *kwnames)
 {
     PyObject *key;
     PyObject *failobj = Py_None;
     PyObject *val = NULL;
     long hash;
-    PyDictEntry *ep;
+    Py_ssize_t ix;
 
-    if (!PyArg_UnpackTuple(args, "get", 1, 2, &key, &failobj))
+    if (!_PyArg_NoStackKeywords("get", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "get", 1, 2, &key, &failobj))
         return NULL;
 
     if (!PyString_CheckExact(key) ||
@@ -1923,10 +2342,11 @@ dict_get(register PyDictObject *mp, PyObject *args)
         if (hash == -1)
             return NULL;
     }
-    ep = (mp->ma_lookup)(mp, key, hash);
-    if (ep == NULL)
+    ix = (mp->ma_lookup)(mp, key, hash, NULL);
+    if (ix == DKIX_ERROR)
         return NULL;
-    val = ep->me_value;
+    if (ix >= 0)
+        val = DICT_VALUE(mp, ix);
     if (val == NULL)
         val = failobj;
     Py_INCREF(val);
@@ -1935,15 +2355,17 @@ dict_get(register PyDictObject *mp, PyObject *args)
 
 
 static PyObject *
-dict_setdefault(register PyDictObject *mp, PyObject *args)
+dict_setdefault(register PyDictObject *mp, PyObject **args, Py_ssize_t nargs,
+                PyObject *kwnames)
 {
     PyObject *key;
     PyObject *failobj = Py_None;
     PyObject *val = NULL;
     long hash;
-    PyDictEntry *ep;
+    Py_ssize_t ix;
 
-    if (!PyArg_UnpackTuple(args, "setdefault", 1, 2, &key, &failobj))
+    if (!_PyArg_NoStackKeywords("setdefault", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "setdefault", 1, 2, &key, &failobj))
         return NULL;
 
     if (!PyString_CheckExact(key) ||
@@ -1952,10 +2374,11 @@ dict_setdefault(register PyDictObject *mp, PyObject *args)
         if (hash == -1)
             return NULL;
     }
-    ep = (mp->ma_lookup)(mp, key, hash);
-    if (ep == NULL)
+    ix = (mp->ma_lookup)(mp, key, hash, NULL);
+    if (ix == DKIX_ERROR)
         return NULL;
-    val = ep->me_value;
+    if (ix >= 0)
+        val = DICT_VALUE(mp, ix);
     if (val == NULL) {
         val = failobj;
         if (PyDict_SetItem((PyObject*)mp, key, failobj))
@@ -1974,14 +2397,16 @@ dict_clear(register PyDictObject *mp)
 }
 
 static PyObject *
-dict_pop(PyDictObject *mp, PyObject *args)
+dict_pop(PyDictObject *mp, PyObject **args, Py_ssize_t nargs,
+         PyObject *kwnames)
 {
     long hash;
-    PyDictEntry *ep;
+    Py_ssize_t ix, hashpos;
     PyObject *old_value, *old_key;
     PyObject *key, *deflt = NULL;
 
-    if(!PyArg_UnpackTuple(args, "pop", 1, 2, &key, &deflt))
+    if (!_PyArg_NoStackKeywords("pop", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "pop", 1, 2, &key, &deflt))
         return NULL;
     if (mp->ma_used == 0) {
         if (deflt) {
@@ -1997,10 +2422,10 @@ dict_pop(PyDictObject *mp, PyObject *args)
         if (hash == -1)
             return NULL;
     }
-    ep = (mp->ma_lookup)(mp, key, hash);
-    if (ep == NULL)
+    ix = (mp->ma_lookup)(mp, key, hash, &hashpos);
+    if (ix == DKIX_ERROR)
         return NULL;
-    if (ep->me_value == NULL) {
+    if (ix == DKIX_EMPTY || DICT_VALUE(mp, ix) == NULL) {
         if (deflt) {
             Py_INCREF(deflt);
             return deflt;
@@ -2008,13 +2433,8 @@ dict_pop(PyDictObject *mp, PyObject *args)
         set_key_error(key);
         return NULL;
     }
-    old_key = ep->me_key;
-    Py_INCREF(dummy);
-    ep->me_key = dummy;
-    old_value = ep->me_value;
-    ep->me_value = NULL;
-    mp->ma_used--;
-    Py_DECREF(old_key);
+    delitem_common(mp, hashpos, ix, &old_key, &old_value);
+    Py_XDECREF(old_key);
     return old_value;
 }
 
@@ -2043,36 +2463,42 @@ dict_popitem(PyDictObject *mp)
                         "popitem(): dictionary is empty");
         return NULL;
     }
-    /* Set ep to "the first" dict entry with a value.  We abuse the hash
-     * field of slot 0 to hold a search finger:
-     * If slot 0 has a value, use slot 0.
-     * Else slot 0 is being used to hold a search finger,
-     * and we use its hash value as the first index to look.
+    /* The search finger needs a combined table */
+    if (mp->ma_values != NULL && dictresize(mp, mp->ma_used * 2) != 0) {
+        Py_DECREF(res);
+        return NULL;
+    }
+    /* Pop the last item, so that repeated popitems empty the dict from
+     * the end.  Set i to the last entry with a value.  We abuse the hash
+     * field of the last entry to hold a search finger:
+     * If the last entry has a value, use it.
+     * Else its hash field may hold a search finger, and we use it as
+     * the first index to look.
      */
-    ep = &mp->ma_table[0];
+    i = mp->ma_fill - 1;
+    ep = &mp->ma_table[i];
     if (ep->me_value == NULL) {
-        i = ep->me_hash;
-        /* The hash field may be a real hash value, or it may be a
-         * legit search finger, or it may be a once-legit search
-         * finger that's out of bounds now because it wrapped around
-         * or the table shrunk -- simply make sure it's in bounds now.
+        /* The hash field is -1 if the entry was deleted by other means,
+         * or it may be a once-legit search finger that's out of bounds
+         * now because the table was compacted -- simply make sure it's
+         * in bounds now.
          */
-        if (i > mp->ma_mask || i < 1)
-            i = 1;              /* skip slot 0 */
-        while ((ep = &mp->ma_table[i])->me_value == NULL) {
-            i++;
-            if (i > mp->ma_mask)
-                i = 1;
-        }
+        if (ep->me_hash >= 0 && ep->me_hash < i)
+            i = ep->me_hash;
+        while (mp->ma_table[i].me_value == NULL)
+            i--;
     }
+    ep = &mp->ma_table[i];
     PyTuple_SET_ITEM(res, 0, ep->me_key);
     PyTuple_SET_ITEM(res, 1, ep->me_value);
-    Py_INCREF(dummy);
-    ep->me_key = dummy;
+    ep->me_key = NULL;
     ep->me_value = NULL;
+    DICT_SET_INDEX(mp, lookdict_index(mp, (long)ep->me_hash, i), DKIX_DUMMY);
+    ep->me_hash = -1;
     mp->ma_used--;
-    assert(mp->ma_table[0].me_value == NULL);
-    mp->ma_table[0].me_hash = i + 1;  /* next place to start */
+    mp->ma_version_tag = DICT_NEXT_VERSION();
+    /* next place to start */
+    mp->ma_table[mp->ma_fill - 1].me_hash = i > 0 ? i - 1 : -1;
     return res;
 }
 
@@ -2082,7 +2508,14 @@ dict_traverse(PyObject *op, visitproc visit, void *arg)
     Py_ssize_t i = 0;
     PyObject *pk;
     PyObject *pv;
+    PyDictObject *mp = (PyDictObject *)op;
 
+    if (mp->ma_values != NULL) {
+        /* The keys belong to the shared table */
+        for (i = 0; i < mp->ma_fill; i++)
+            Py_VISIT(mp->ma_values[i]);
+        return 0;
+    }
     while (PyDict_Next(op, &i, &pk, &pv)) {
         Py_VISIT(pk);
         Py_VISIT(pv);
@@ -2124,11 +2557,25 @@ dict_iteritems(PyDictObject *dict)
 static PyObject *
 dict_sizeof(PyDictObject *mp)
 {
-    Py_ssize_t res;
+    Py_ssize_t res, size = mp->ma_mask + 1;
 
-    res = sizeof(PyDictObject);
-    if (mp->ma_table != mp->ma_smalltable)
-        res = res + (mp->ma_mask + 1) * sizeof(PyDictEntry);
+    if (mp->ma_values != NULL) {
+        res = offsetof(PyDictObject, ma_smallindices) +
+            PyDict_USABLE(size) * sizeof(PyObject *);
+        /* The keys only count if no other dict or type shares them */
+        if (mp->ma_keys->dk_refcnt == 1)
+            res += offsetof(PyDictKeysObject, dk_indices) +
+                DK_INDICES_SIZE(size) +
+                PyDict_USABLE(size) * sizeof(PyDictEntry);
+        return PyInt_FromSsize_t(res);
+    }
+    if (mp->ma_keys != NULL)
+        res = offsetof(PyDictObject, ma_smallindices);
+    else
+        res = sizeof(PyDictObject);
+    if (DICT_IS_MALLOCED(mp))
+        res += DK_INDICES_SIZE(size) +
+            PyDict_USABLE(size) * sizeof(PyDictEntry);
     return PyInt_FromSsize_t(res);
 }
 
@@ -2212,11 +2659,11 @@ static PyMethodDef mapp_methods[] = {
      sizeof__doc__},
     {"has_key",         (PyCFunction)dict_has_key,      METH_O,
      has_key__doc__},
-    {"get",         (PyCFunction)dict_get,          METH_VARARGS,
+    {"get",         (PyCFunction)dict_get,          METH_FASTCALL,
      get__doc__},
-    {"setdefault",  (PyCFunction)dict_setdefault,   METH_VARARGS,
+    {"setdefault",  (PyCFunction)dict_setdefault,   METH_FASTCALL,
      setdefault_doc__},
-    {"pop",         (PyCFunction)dict_pop,          METH_VARARGS,
+    {"pop",         (PyCFunction)dict_pop,          METH_FASTCALL,
      pop__doc__},
     {"popitem",         (PyCFunction)dict_popitem,      METH_NOARGS,
      popitem__doc__},
@@ -2255,7 +2702,7 @@ PyDict_Contains(PyObject *op, PyObject *key)
 {
     long hash;
     PyDictObject *mp = (PyDictObject *)op;
-    PyDictEntry *ep;
+    Py_ssize_t ix;
 
     if (!PyString_CheckExact(key) ||
         (hash = ((PyStringObject *) key)->ob_shash) == -1) {
@@ -2263,8 +2710,10 @@ PyDict_Contains(PyObject *op, PyObject *key)
         if (hash == -1)
             return -1;
     }
-    ep = (mp->ma_lookup)(mp, key, hash);
-    return ep == NULL ? -1 : (ep->me_value != NULL);
+    ix = (mp->ma_lookup)(mp, key, hash, NULL);
+    if (ix == DKIX_ERROR)
+        return -1;
+    return ix >= 0 && DICT_VALUE(mp, ix) != NULL;
 }
 
 /* Internal version of PyDict_Contains used when the hash value is already known */
@@ -2272,10 +2721,27 @@ int
 _PyDict_Contains(PyObject *op, PyObject *key, long hash)
 {
     PyDictObject *mp = (PyDictObject *)op;
-    PyDictEntry *ep;
+    Py_ssize_t ix;
 
-    ep = (mp->ma_lookup)(mp, key, hash);
-    return ep == NULL ? -1 : (ep->me_value != NULL);
+    ix = (mp->ma_lookup)(mp, key, hash, NULL);
+    if (ix == DKIX_ERROR)
+        return -1;
+    return ix >= 0 && DICT_VALUE(mp, ix) != NULL;
+}
+
+/* Like _PyDict_Contains, but return the key stored in the dict, which may
+   be another object equal to key (a borrowed reference).  Returns NULL
+   without an exception set if there is none, and with one on error. */
+PyObject *
+_PyDict_GetStoredKey(PyObject *op, PyObject *key, long hash)
+{
+    PyDictObject *mp = (PyDictObject *)op;
+    Py_ssize_t ix;
+
+    ix = (mp->ma_lookup)(mp, key, hash, NULL);
+    if (ix < 0 || DICT_VALUE(mp, ix) == NULL)
+        return NULL;
+    return mp->ma_table[ix].me_key;
 }
 
 /* Hack to implement "key in dict" */
@@ -2305,6 +2771,7 @@ dict_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
         assert(d->ma_table == NULL && d->ma_fill == 0 && d->ma_used == 0);
         INIT_NONZERO_DICT_SLOTS(d);
         d->ma_lookup = lookdict_string;
+        d->ma_version_tag = DICT_NEXT_VERSION();
         /* The object has been implicitly tracked by tp_alloc */
         if (type == &PyDict_Type)
             _PyObject_GC_UNTRACK(d);
@@ -2499,7 +2966,7 @@ static PyMethodDef dictiter_methods[] = {
 static PyObject *dictiter_iternextkey(dictiterobject *di)
 {
     PyObject *key;
-    register Py_ssize_t i, mask;
+    register Py_ssize_t i, fill;
     register PyDictEntry *ep;
     PyDictObject *d = di->di_dict;
 
@@ -2518,11 +2985,11 @@ static PyObject *dictiter_iternextkey(dictiterobject *di)
     if (i < 0)
         goto fail;
     ep = d->ma_table;
-    mask = d->ma_mask;
-    while (i <= mask && ep[i].me_value == NULL)
+    fill = d->ma_fill;
+    while (i < fill && DICT_VALUE(d, i) == NULL)
         i++;
     di->di_pos = i+1;
-    if (i > mask)
+    if (i >= fill)
         goto fail;
     di->len--;
     key = ep[i].me_key;
@@ -2571,8 +3038,7 @@ PyTypeObject PyDictIterKey_Type = {
 static PyObject *dictiter_iternextvalue(dictiterobject *di)
 {
     PyObject *value;
-    register Py_ssize_t i, mask;
-    register PyDictEntry *ep;
+    register Py_ssize_t i, fill;
     PyDictObject *d = di->di_dict;
 
     if (d == NULL)
@@ -2587,13 +3053,12 @@ static PyObject *dictiter_iternextvalue(dictiterobject *di)
     }
 
     i = di->di_pos;
-    mask = d->ma_mask;
-    if (i < 0 || i > mask)
+    fill = d->ma_fill;
+    if (i < 0 || i >= fill)
         goto fail;
-    ep = d->ma_table;
-    while ((value=ep[i].me_value) == NULL) {
+    while ((value = DICT_VALUE(d, i)) == NULL) {
         i++;
-        if (i > mask)
+        if (i >= fill)
             goto fail;
     }
     di->di_pos = i+1;
@@ -2643,7 +3108,7 @@ PyTypeObject PyDictIterValue_Type = {
 static PyObject *dictiter_iternextitem(dictiterobject *di)
 {
     PyObject *key, *value, *result = di->di_result;
-    register Py_ssize_t i, mask;
+    register Py_ssize_t i, fill;
     register PyDictEntry *ep;
     PyDictObject *d = di->di_dict;
 
@@ -2662,11 +3127,11 @@ static PyObject *dictiter_iternextitem(dictiterobject *di)
     if (i < 0)
         goto fail;
     ep = d->ma_table;
-    mask = d->ma_mask;
-    while (i <= mask && ep[i].me_value == NULL)
+    fill = d->ma_fill;
+    while (i < fill && DICT_VALUE(d, i) == NULL)
         i++;
     di->di_pos = i+1;
-    if (i > mask)
+    if (i >= fill)
         goto fail;
 
     if (result->ob_refcnt == 1) {
@@ -2680,7 +3145,7 @@ static PyObject *dictiter_iternextitem(dictiterobject *di)
     }
     di->len--;
     key = ep[i].me_key;
-    value = ep[i].me_value;
+    value = DICT_VALUE(d, i);
     Py_INCREF(key);
     Py_INCREF(value);
     PyTuple_SET_ITEM(result, 0, key);
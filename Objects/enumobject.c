@@ -16,10 +16,11 @@ enum_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
     enumobject *en;
     PyObject *seq = NULL;
     PyObject *start = NULL;
-    static char *kwlist[] = {"sequence", "start", 0};
+    static const char * const kwlist[] = {"sequence", "start", 0};
+    static _PyArg_Parser _parser = {"O|O:enumerate", kwlist, 0};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O:enumerate", kwlist,
-                                     &seq, &start))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &seq, &start))
         return NULL;
 
     en = (enumobject *)type->tp_alloc(type, 0);
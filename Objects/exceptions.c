@@ -1658,6 +1658,8 @@ UnicodeEncodeError_str(PyObject *self)
     if (encoding_str == NULL)
         goto done;
 
+    if (PyUnicode_AS_UNICODE(uself->object) == NULL)
+        goto done;
     if (uself->start < PyUnicode_GET_SIZE(uself->object) && uself->end == uself->start+1) {
         int badchar = (int)PyUnicode_AS_UNICODE(uself->object)[uself->start];
         char badchar_str[20];
@@ -1837,6 +1839,8 @@ UnicodeTranslateError_str(PyObject *self)
     if (reason_str == NULL)
         goto done;
 
+    if (PyUnicode_AS_UNICODE(uself->object) == NULL)
+        goto done;
     if (uself->start < PyUnicode_GET_SIZE(uself->object) && uself->end == uself->start+1) {
         int badchar = (int)PyUnicode_AS_UNICODE(uself->object)[uself->start];
         char badchar_str[20];
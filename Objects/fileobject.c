@@ -357,13 +357,19 @@ open_the_file(PyFileObject *f, char *name, char *mode)
 #ifdef MS_WINDOWS
     if (PyUnicode_Check(f->f_name)) {
         PyObject *wmode;
+        Py_UNICODE *wname, *wm;
         wmode = PyUnicode_DecodeASCII(newmode, strlen(newmode), NULL);
         if (f->f_name && wmode) {
+            /* a compact string gets its wide copy here, with the GIL */
+            wname = PyUnicode_AS_UNICODE(f->f_name);
+            wm = PyUnicode_AS_UNICODE(wmode);
+            if (wname == NULL || wm == NULL) {
+                Py_DECREF(wmode);
+                f = NULL;
+                goto cleanup;
+            }
             FILE_BEGIN_ALLOW_THREADS(f)
-            /* PyUnicode_AS_UNICODE OK without thread
-               lock as it is a simple dereference. */
-            f->f_fp = _wfopen(PyUnicode_AS_UNICODE(f->f_name),
-                              PyUnicode_AS_UNICODE(wmode));
+            f->f_fp = _wfopen(wname, wm);
             FILE_END_ALLOW_THREADS(f)
         }
         Py_XDECREF(wmode);
@@ -1555,7 +1561,11 @@ PyFile_GetLine(PyObject *f, int n)
     if (n < 0 && result != NULL && PyUnicode_Check(result)) {
         Py_UNICODE *s = PyUnicode_AS_UNICODE(result);
         Py_ssize_t len = PyUnicode_GET_SIZE(result);
-        if (len == 0) {
+        if (s == NULL) {
+            Py_DECREF(result);
+            result = NULL;
+        }
+        else if (len == 0) {
             Py_DECREF(result);
             result = NULL;
             PyErr_SetString(PyExc_EOFError,
@@ -1886,6 +1896,10 @@ file_writelines(PyFileObject *f, PyObject *seq)
                 Py_DECREF(v);
                 PyList_SET_ITEM(list, i, line);
             }
+            else
+                /* copy in the characters of a lazy string while
+                   the lock is still held */
+                (void)PyString_AS_STRING(v);
         }
 
         /* Since we are releasing the global lock, the
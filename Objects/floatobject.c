@@ -193,7 +193,8 @@ PyFloat_FromString(PyObject *v, char **pend)
         s_buffer = (char *)PyMem_MALLOC(PyUnicode_GET_SIZE(v)+1);
         if (s_buffer == NULL)
             return PyErr_NoMemory();
-        if (PyUnicode_EncodeDecimal(PyUnicode_AS_UNICODE(v),
+        if (PyUnicode_AS_UNICODE(v) == NULL ||
+            PyUnicode_EncodeDecimal(PyUnicode_AS_UNICODE(v),
                                     PyUnicode_GET_SIZE(v),
                                     s_buffer,
                                     NULL))
@@ -1793,11 +1794,12 @@ static PyObject *
 float_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
     PyObject *x = Py_False; /* Integer zero */
-    static char *kwlist[] = {"x", 0};
+    static const char * const kwlist[] = {"x", 0};
+    static _PyArg_Parser _parser = {"|O:float", kwlist, 0};
 
     if (type != &PyFloat_Type)
         return float_subtype_new(type, args, kwds); /* Wimp out */
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:float", kwlist, &x))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser, &x))
         return NULL;
     /* If it's a string, but not a string subclass, use
        PyFloat_FromString. */
@@ -437,6 +437,30 @@ static PyGetSetDef frame_getsetlist[] = {
    Later, PyFrame_MAXFREELIST was added to bound the # of frames saved on
    free_list.  Else programs creating lots of cyclic trash involving
    frames could provoke free_list into growing without bound.
+
+   3. Frames of code that isn't a generator are bump-allocated from a
+   per-thread arena: a chain of FRAME_CHUNK_SIZE chunks hanging off
+   tstate->frame_chunk, used as a stack.  Each frame is preceded by a
+   frame_block header (link to the block below it, and a dead flag) and
+   by its PyGC_Head, so the object looks exactly like one from
+   PyObject_GC_NewVar.  f_chunk tells which chunk a frame lives in, or is
+   NULL for frames from the heap, the free list or a zombie.
+
+   Most frames die in the order they were made, and then freeing one is
+   just moving the chunk top back down.  A frame that escapes its call
+   (sys._getframe(), a traceback, a frame created by C code) simply stays
+   where it is: dying below it only sets the dead flag, and the space is
+   reclaimed once everything above has died too.  Arena frames never
+   become zombies nor go to free_list, so the arena only serves code
+   that already had a frame made for it, as co_frame_made records (and
+   thus owns a zombie, unless that is in use); generator frames, which
+   are made to outlive their creator, and frames too big for a chunk
+   come from the heap as before.
+
+   The chunks are only touched with the GIL held, so a frame may die in
+   a thread other than the one that created it.  When a thread state is
+   cleared, its empty chunks are freed and the others are orphaned; an
+   orphaned chunk is freed with its last frame.
 */
 
 static PyFrameObject *free_list = NULL;
@@ -444,6 +468,137 @@ static int numfree = 0;         /* number of frames currently in free_list */
 /* max value for numfree */
 #define PyFrame_MAXFREELIST 200
 
+typedef union _frame_block {
+    struct {
+        union _frame_block *prev;   /* block below this one, or NULL */
+        int dead;                   /* frame deallocated, space not reused */
+    } b;
+    long double dummy;  /* same alignment as PyGC_Head */
+} frame_block;
+
+typedef struct _frame_chunk {
+    struct _frame_chunk *prev;  /* older chunk of the same thread */
+    PyThreadState *owner;       /* NULL once the thread state is cleared */
+    frame_block *last;          /* topmost block, or NULL if empty */
+    char *top;                  /* first free byte */
+    char *limit;                /* end of the chunk */
+} frame_chunk;
+
+#define FRAME_CHUNK_SIZE (64*1024)
+#define FRAME_ROUND(n) \
+    (((n) + sizeof(frame_block) - 1) / sizeof(frame_block) * sizeof(frame_block))
+#define FRAME_CHUNK_HEADER FRAME_ROUND(sizeof(frame_chunk))
+
+/* One emptied chunk is kept around, so that a call chain going back and
+   forth across a chunk boundary doesn't malloc() and free() each time. */
+static frame_chunk *spare_chunk = NULL;
+
+static void
+frame_chunk_free(frame_chunk *chunk)
+{
+    if (spare_chunk == NULL)
+        spare_chunk = chunk;
+    else
+        PyMem_FREE(chunk);
+}
+
+/* Return an untracked frame with room for extras slots, or NULL if the
+   arena can't hold it; no exception is set in that case. */
+static PyFrameObject *
+frame_arena_alloc(PyThreadState *tstate, Py_ssize_t extras)
+{
+    frame_chunk *chunk = tstate->frame_chunk;
+    frame_block *b;
+    PyGC_Head *g;
+    PyFrameObject *f;
+    size_t size;
+
+    size = FRAME_ROUND(sizeof(frame_block) + sizeof(PyGC_Head) +
+                       _PyObject_VAR_SIZE(&PyFrame_Type, extras));
+    if (chunk == NULL || (size_t)(chunk->limit - chunk->top) < size) {
+        frame_chunk *newchunk;
+
+        if (size > FRAME_CHUNK_SIZE - FRAME_CHUNK_HEADER)
+            return NULL;
+        if (spare_chunk != NULL) {
+            newchunk = spare_chunk;
+            spare_chunk = NULL;
+        }
+        else {
+            newchunk = (frame_chunk *)PyMem_MALLOC(FRAME_CHUNK_SIZE);
+            if (newchunk == NULL)
+                return NULL;
+        }
+        newchunk->prev = chunk;
+        newchunk->owner = tstate;
+        newchunk->last = NULL;
+        newchunk->top = (char *)newchunk + FRAME_CHUNK_HEADER;
+        newchunk->limit = (char *)newchunk + FRAME_CHUNK_SIZE;
+        tstate->frame_chunk = chunk = newchunk;
+    }
+
+    b = (frame_block *)chunk->top;
+    b->b.prev = chunk->last;
+    b->b.dead = 0;
+    chunk->last = b;
+    chunk->top += size;
+
+    g = (PyGC_Head *)(b + 1);
+    g->gc.gc_refs = _PyGC_REFS_UNTRACKED;
+    f = (PyFrameObject *)PyObject_INIT_VAR((PyVarObject *)(g + 1),
+                                           &PyFrame_Type, extras);
+    f->f_chunk = chunk;
+    return f;
+}
+
+static void
+frame_arena_release(PyFrameObject *f)
+{
+    frame_chunk *chunk = f->f_chunk;
+    frame_block *b = (frame_block *)_Py_AS_GC(f) - 1;
+    PyThreadState *tstate;
+
+    b->b.dead = 1;
+    while (chunk->last != NULL && chunk->last->b.dead) {
+        chunk->top = (char *)chunk->last;
+        chunk->last = chunk->last->b.prev;
+    }
+    if (chunk->last != NULL)
+        return;
+
+    tstate = chunk->owner;
+    if (tstate == NULL) {
+        /* Orphaned, and now empty */
+        PyMem_FREE(chunk);
+        return;
+    }
+    /* Step back from the thread's newest chunk once it is empty. */
+    while (chunk == tstate->frame_chunk && chunk->last == NULL &&
+           chunk->prev != NULL) {
+        tstate->frame_chunk = chunk->prev;
+        frame_chunk_free(chunk);
+        chunk = tstate->frame_chunk;
+    }
+}
+
+void
+_PyFrame_DetachArena(PyThreadState *tstate)
+{
+    frame_chunk *chunk = tstate->frame_chunk;
+
+    tstate->frame_chunk = NULL;
+    while (chunk != NULL) {
+        frame_chunk *prev = chunk->prev;
+        if (chunk->last == NULL)
+            PyMem_FREE(chunk);
+        else {
+            chunk->owner = NULL;
+            chunk->prev = NULL;
+        }
+        chunk = prev;
+    }
+}
+
 static void
 frame_dealloc(PyFrameObject *f)
 {
@@ -473,7 +628,9 @@ frame_dealloc(PyFrameObject *f)
     Py_CLEAR(f->f_exc_traceback);
 
     co = f->f_code;
-    if (co->co_zombieframe == NULL)
+    if (f->f_chunk != NULL)
+        frame_arena_release(f);
+    else if (co->co_zombieframe == NULL)
         co->co_zombieframe = f;
     else if (numfree < PyFrame_MAXFREELIST) {
         ++numfree;
@@ -676,29 +833,41 @@ PyFrame_New(PyThreadState *tstate, PyCodeObject *code, PyObject *globals,
         nfrees = PyTuple_GET_SIZE(code->co_freevars);
         extras = code->co_stacksize + code->co_nlocals + ncells +
             nfrees;
-        if (free_list == NULL) {
-            f = PyObject_GC_NewVar(PyFrameObject, &PyFrame_Type,
-            extras);
-            if (f == NULL) {
-                Py_DECREF(builtins);
-                return NULL;
-            }
+        /* The first frame of a code object comes from the heap so
+           that it becomes the zombie; after that, a missing zombie
+           means it is in use, e.g. by a recursive call. */
+        f = NULL;
+        if (!(code->co_flags & CO_GENERATOR)) {
+            if (code->co_frame_made)
+                f = frame_arena_alloc(tstate, extras);
+            else
+                code->co_frame_made = 1;
         }
-        else {
-            assert(numfree > 0);
-            --numfree;
-            f = free_list;
-            free_list = free_list->f_back;
-            if (Py_SIZE(f) < extras) {
-                f = PyObject_GC_Resize(PyFrameObject, f, extras);
+        if (f == NULL) {
+            if (free_list == NULL) {
+                f = PyObject_GC_NewVar(PyFrameObject, &PyFrame_Type,
+                extras);
                 if (f == NULL) {
                     Py_DECREF(builtins);
                     return NULL;
                 }
             }
-            _Py_NewReference((PyObject *)f);
+            else {
+                assert(numfree > 0);
+                --numfree;
+                f = free_list;
+                free_list = free_list->f_back;
+                if (Py_SIZE(f) < extras) {
+                    f = PyObject_GC_Resize(PyFrameObject, f, extras);
+                    if (f == NULL) {
+                        Py_DECREF(builtins);
+                        return NULL;
+                    }
+                }
+                _Py_NewReference((PyObject *)f);
+            }
+            f->f_chunk = NULL;
         }
-
         f->f_code = code;
         extras = code->co_nlocals + ncells + nfrees;
         f->f_valuestack = f->f_localsplus + extras;
@@ -970,6 +1139,10 @@ PyFrame_ClearFreeList(void)
         --numfree;
     }
     assert(numfree == 0);
+    if (spare_chunk != NULL) {
+        PyMem_FREE(spare_chunk);
+        spare_chunk = NULL;
+    }
     return freelist_size;
 }
 
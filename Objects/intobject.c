@@ -1052,13 +1052,14 @@ int_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
     PyObject *x = NULL;
     int base = -909;
-    static char *kwlist[] = {"x", "base", 0};
+    static const char * const kwlist[] = {"x", "base", 0};
+    static _PyArg_Parser _parser = {"|Oi:int", kwlist, 0};
 
     if (type != &PyInt_Type)
         return int_subtype_new(type, args, kwds); /* Wimp out */
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Oi:int", kwlist,
-                                     &x, &base))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &x, &base))
         return NULL;
 
     if (x == NULL)
@@ -1088,10 +1089,13 @@ int_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
     }
 
 #ifdef Py_USING_UNICODE
-    if (PyUnicode_Check(x))
+    if (PyUnicode_Check(x)) {
+        if (PyUnicode_AS_UNICODE(x) == NULL)
+            return NULL;
         return PyInt_FromUnicode(PyUnicode_AS_UNICODE(x),
                                  PyUnicode_GET_SIZE(x),
                                  base);
+    }
 #endif
 
     PyErr_SetString(PyExc_TypeError,
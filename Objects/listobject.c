@@ -8,6 +8,10 @@
 #include <sys/types.h>          /* For size_t */
 #endif
 
+#ifdef WITH_THREAD
+#include "pythread.h"
+#endif
+
 /* Ensure ob_item has room for at least newsize elements, and set
  * ob_size to newsize.  If newsize > ob_size on entry, the content
  * of the new slots at exit is undefined heap trash; it's the caller's
@@ -981,6 +985,144 @@ reverse_slice(PyObject **lo, PyObject **hi)
  * pieces to this algorithm; read listsort.txt for overviews and details.
  */
 
+/* A sortslice contains a pointer to an array of keys and a pointer to
+ * an array of corresponding values.  In other words, keys[i]
+ * corresponds with values[i].  If values == NULL, then the keys are
+ * also the values.
+ *
+ * Several convenience routines are provided here, so that keys and
+ * values are always moved in sync.
+ */
+
+typedef struct {
+    PyObject **keys;
+    PyObject **values;
+} sortslice;
+
+Py_LOCAL_INLINE(void)
+sortslice_copy(sortslice *s1, Py_ssize_t i, sortslice *s2, Py_ssize_t j)
+{
+    s1->keys[i] = s2->keys[j];
+    if (s1->values != NULL)
+        s1->values[i] = s2->values[j];
+}
+
+Py_LOCAL_INLINE(void)
+sortslice_copy_incr(sortslice *dst, sortslice *src)
+{
+    *dst->keys++ = *src->keys++;
+    if (dst->values != NULL)
+        *dst->values++ = *src->values++;
+}
+
+Py_LOCAL_INLINE(void)
+sortslice_copy_decr(sortslice *dst, sortslice *src)
+{
+    *dst->keys-- = *src->keys--;
+    if (dst->values != NULL)
+        *dst->values-- = *src->values--;
+}
+
+
+Py_LOCAL_INLINE(void)
+sortslice_memcpy(sortslice *s1, Py_ssize_t i, sortslice *s2, Py_ssize_t j,
+                 Py_ssize_t n)
+{
+    memcpy(&s1->keys[i], &s2->keys[j], sizeof(PyObject *) * n);
+    if (s1->values != NULL)
+        memcpy(&s1->values[i], &s2->values[j], sizeof(PyObject *) * n);
+}
+
+Py_LOCAL_INLINE(void)
+sortslice_memmove(sortslice *s1, Py_ssize_t i, sortslice *s2, Py_ssize_t j,
+                  Py_ssize_t n)
+{
+    memmove(&s1->keys[i], &s2->keys[j], sizeof(PyObject *) * n);
+    if (s1->values != NULL)
+        memmove(&s1->values[i], &s2->values[j], sizeof(PyObject *) * n);
+}
+
+Py_LOCAL_INLINE(void)
+sortslice_advance(sortslice *slice, Py_ssize_t n)
+{
+    slice->keys += n;
+    if (slice->values != NULL)
+        slice->values += n;
+}
+
+/* The maximum number of entries in a MergeState's pending-runs stack.
+ * This is enough to sort arrays of size up to about
+ *     32 * phi ** MAX_MERGE_PENDING
+ * where phi ~= 1.618.  85 is ridiculouslylarge enough, good for an array
+ * with 2**64 elements.
+ */
+#define MAX_MERGE_PENDING 85
+
+/* When we get into galloping mode, we stay there until both runs win less
+ * often than MIN_GALLOP consecutive times.  See listsort.txt for more info.
+ */
+#define MIN_GALLOP 7
+
+/* Avoid malloc for small temp arrays. */
+#define MERGESTATE_TEMP_SIZE 256
+
+/* One MergeState exists on the stack per invocation of mergesort.  It's just
+ * a convenient way to pass state around among the helper functions.
+ */
+struct s_slice {
+    sortslice base;
+    Py_ssize_t len;
+};
+
+typedef struct s_MergeState MergeState;
+struct s_MergeState {
+    /* The user-supplied comparison function. or NULL if none given. */
+    PyObject *compare;
+
+    /* This controls when we get *into* galloping mode.  It's initialized
+     * to MIN_GALLOP.  merge_lo and merge_hi tend to nudge it higher for
+     * random data, and lower for highly structured data.
+     */
+    Py_ssize_t min_gallop;
+
+    /* 'a' is temp storage to help with merges.  It contains room for
+     * alloced entries.
+     */
+    sortslice a;        /* may point to temparray below */
+    Py_ssize_t alloced;
+
+    /* A stack of n pending runs yet to be merged.  Run #i starts at
+     * address base[i] and extends for len[i] elements.  It's always
+     * true (so long as the indices are in bounds) that
+     *
+     *     pending[i].base + pending[i].len == pending[i+1].base
+     *
+     * so we could cut the storage for this, but it's a minor amount,
+     * and keeping all the info explicit simplifies the code.
+     */
+    int n;
+    struct s_slice pending[MAX_MERGE_PENDING];
+
+    /* 'a' points to this when possible, rather than muck with malloc. */
+    PyObject *temparray[MERGESTATE_TEMP_SIZE];
+
+    /* The function comparing two keys, chosen by listsort() once it knows
+     * what the keys are: the user's cmp function, one of the specialized
+     * compares below, or safe_object_compare if nothing more is known.
+     */
+    int (*key_compare)(PyObject *, PyObject *, MergeState *);
+
+    /* The tp_richcompare slot of the type shared by all the keys, for
+     * unsafe_object_compare.
+     */
+    richcmpfunc key_richcompare;
+
+    /* The function comparing the first items of tuple keys, for
+     * unsafe_tuple_compare.
+     */
+    int (*tuple_elem_compare)(PyObject *, PyObject *, MergeState *);
+};
+
 /* Comparison function.  Takes care of calling a user-supplied
  * comparison function (any callable Python object), which must not be
  * NULL (use the ISLT macro if you don't know, or call PyObject_RichCompareBool
@@ -1021,20 +1163,159 @@ islt(PyObject *x, PyObject *y, PyObject *compare)
     return i < 0;
 }
 
-/* If COMPARE is NULL, calls PyObject_RichCompareBool with Py_LT, else calls
- * islt.  This avoids a layer of function call in the usual case, and
- * sorting does many comparisons.
+/* The key compares.  Each returns -1 on error, 1 if v < w, 0 if v >= w.
+ * All but the first two rely on what listsort() checked before sorting,
+ * and skip the type dispatch of PyObject_RichCompareBool().
+ */
+
+/* Compares with the user's cmp function */
+static int
+user_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    return islt(v, w, ms->compare);
+}
+
+/* Compares any two objects */
+static int
+safe_object_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    return PyObject_RichCompareBool(v, w, Py_LT);
+}
+
+/* All the keys have the same type, whose tp_richcompare slot is
+ * ms->key_richcompare.  This is what PyObject_RichCompare() does for
+ * objects of the same type, short of the checks.
+ */
+static int
+unsafe_object_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    PyObject *res_obj;
+    int res;
+
+    /* a comparison may have assigned to the __class__ of a key */
+    if (Py_TYPE(v)->tp_richcompare != ms->key_richcompare ||
+        Py_TYPE(v) != Py_TYPE(w))
+        return PyObject_RichCompareBool(v, w, Py_LT);
+
+    assert(ms->key_richcompare != NULL);
+    res_obj = (*(ms->key_richcompare))(v, w, Py_LT);
+    if (res_obj == Py_NotImplemented) {
+        Py_DECREF(res_obj);
+        return PyObject_RichCompareBool(v, w, Py_LT);
+    }
+    if (res_obj == NULL)
+        return -1;
+
+    if (PyBool_Check(res_obj))
+        res = (res_obj == Py_True);
+    else
+        res = PyObject_IsTrue(res_obj);
+    Py_DECREF(res_obj);
+    return res;
+}
+
+/* All the keys are exact str objects */
+static int
+unsafe_string_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    Py_ssize_t len_v, len_w;
+    int res;
+
+    assert(PyString_CheckExact(v) && PyString_CheckExact(w));
+    len_v = PyString_GET_SIZE(v);
+    len_w = PyString_GET_SIZE(w);
+    res = memcmp(PyString_AS_STRING(v), PyString_AS_STRING(w),
+                 len_v < len_w ? len_v : len_w);
+    return res != 0 ? res < 0 : len_v < len_w;
+}
+
+#ifdef Py_USING_UNICODE
+/* All the keys are exact unicode objects */
+static int
+unsafe_unicode_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    int res;
+
+    assert(PyUnicode_CheckExact(v) && PyUnicode_CheckExact(w));
+    res = PyUnicode_Compare(v, w);
+    if (res == -1 && PyErr_Occurred())
+        return -1;
+    return res < 0;
+}
+#endif
+
+/* All the keys are exact int objects */
+static int
+unsafe_int_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    assert(PyInt_CheckExact(v) && PyInt_CheckExact(w));
+    return PyInt_AS_LONG(v) < PyInt_AS_LONG(w);
+}
+
+/* All the keys are exact long objects, which only have tp_compare */
+static int
+unsafe_long_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    assert(PyLong_CheckExact(v) && PyLong_CheckExact(w));
+    return (*PyLong_Type.tp_compare)(v, w) < 0;
+}
+
+/* All the keys are exact float objects */
+static int
+unsafe_float_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    assert(PyFloat_CheckExact(v) && PyFloat_CheckExact(w));
+    return PyFloat_AS_DOUBLE(v) < PyFloat_AS_DOUBLE(w);
+}
+
+/* All the keys are non-empty exact tuples, and their first items can be
+ * compared with ms->tuple_elem_compare.  The rest is tuplerichcompare().
+ */
+static int
+unsafe_tuple_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    PyTupleObject *vt, *wt;
+    Py_ssize_t i, vlen, wlen;
+    int k;
+
+    assert(PyTuple_CheckExact(v) && PyTuple_CheckExact(w));
+    assert(Py_SIZE(v) > 0 && Py_SIZE(w) > 0);
+
+    vt = (PyTupleObject *)v;
+    wt = (PyTupleObject *)w;
+    vlen = Py_SIZE(vt);
+    wlen = Py_SIZE(wt);
+
+    for (i = 0; i < vlen && i < wlen; i++) {
+        k = PyObject_RichCompareBool(vt->ob_item[i], wt->ob_item[i], Py_EQ);
+        if (k < 0)
+            return -1;
+        if (!k)
+            break;
+    }
+
+    if (i >= vlen || i >= wlen)
+        return vlen < wlen;
+
+    if (i == 0)
+        return ms->tuple_elem_compare(vt->ob_item[i], wt->ob_item[i], ms);
+    else
+        return PyObject_RichCompareBool(vt->ob_item[i], wt->ob_item[i],
+                                        Py_LT);
+}
+
+/* Compares keys X and Y with the compare chosen for the sort, which all
+ * the functions below get through their MergeState.  This avoids a layer
+ * of function call in the usual case, and sorting does many comparisons.
  * Returns -1 on error, 1 if x < y, 0 if x >= y.
  */
-#define ISLT(X, Y, COMPARE) ((COMPARE) == NULL ?                        \
-                 PyObject_RichCompareBool(X, Y, Py_LT) :                \
-                 islt(X, Y, COMPARE))
+#define ISLT(X, Y) (*(ms->key_compare))(X, Y, ms)
 
 /* Compare X to Y via "<".  Goto "fail" if the comparison raises an
    error.  Else "k" is set to true iff X<Y, and an "if (k)" block is
    started.  It makes more sense in context <wink>.  X and Y are PyObject*s.
 */
-#define IFLT(X, Y) if ((k = ISLT(X, Y, compare)) < 0) goto fail;  \
+#define IFLT(X, Y) if ((k = ISLT(X, Y)) < 0) goto fail;  \
            if (k)
 
 /* binarysort is the best method for sorting small arrays: it does
@@ -1049,20 +1330,19 @@ islt(PyObject *x, PyObject *y, PyObject *compare)
    the input (nothing is lost or duplicated).
 */
 static int
-binarysort(PyObject **lo, PyObject **hi, PyObject **start, PyObject *compare)
-     /* compare -- comparison function object, or NULL for default */
+binarysort(MergeState *ms, sortslice lo, PyObject **hi, PyObject **start)
 {
     register Py_ssize_t k;
     register PyObject **l, **p, **r;
     register PyObject *pivot;
 
-    assert(lo <= start && start <= hi);
+    assert(lo.keys <= start && start <= hi);
     /* assert [lo, start) is sorted */
-    if (lo == start)
+    if (lo.keys == start)
         ++start;
     for (; start < hi; ++start) {
         /* set l to where *start belongs */
-        l = lo;
+        l = lo.keys;
         r = start;
         pivot = *r;
         /* Invariants:
@@ -1089,6 +1369,15 @@ binarysort(PyObject **lo, PyObject **hi, PyObject **start, PyObject *compare)
         for (p = start; p > l; --p)
             *p = *(p-1);
         *l = pivot;
+        if (lo.values != NULL) {
+            Py_ssize_t offset = lo.values - lo.keys;
+            p = start + offset;
+            pivot = *p;
+            l += offset;
+            for (p = start + offset; p > l; --p)
+                *p = *(p-1);
+            *l = pivot;
+        }
     }
     return 0;
 
@@ -1115,7 +1404,7 @@ elements to get out of order).
 Returns -1 in case of error.
 */
 static Py_ssize_t
-count_run(PyObject **lo, PyObject **hi, PyObject *compare, int *descending)
+count_run(MergeState *ms, PyObject **lo, PyObject **hi, int *descending)
 {
     Py_ssize_t k;
     Py_ssize_t n;
@@ -1170,7 +1459,8 @@ key, and the last n-k should follow key.
 Returns -1 on error.  See listsort.txt for info on the method.
 */
 static Py_ssize_t
-gallop_left(PyObject *key, PyObject **a, Py_ssize_t n, Py_ssize_t hint, PyObject *compare)
+gallop_left(MergeState *ms, PyObject *key, PyObject **a, Py_ssize_t n,
+            Py_ssize_t hint)
 {
     Py_ssize_t ofs;
     Py_ssize_t lastofs;
@@ -1261,7 +1551,8 @@ we're sticking to "<" comparisons that it's much harder to follow if
 written as one routine with yet another "left or right?" flag.
 */
 static Py_ssize_t
-gallop_right(PyObject *key, PyObject **a, Py_ssize_t n, Py_ssize_t hint, PyObject *compare)
+gallop_right(MergeState *ms, PyObject *key, PyObject **a, Py_ssize_t n,
+             Py_ssize_t hint)
 {
     Py_ssize_t ofs;
     Py_ssize_t lastofs;
@@ -1337,70 +1628,34 @@ fail:
     return -1;
 }
 
-/* The maximum number of entries in a MergeState's pending-runs stack.
- * This is enough to sort arrays of size up to about
- *     32 * phi ** MAX_MERGE_PENDING
- * where phi ~= 1.618.  85 is ridiculouslylarge enough, good for an array
- * with 2**64 elements.
- */
-#define MAX_MERGE_PENDING 85
-
-/* When we get into galloping mode, we stay there until both runs win less
- * often than MIN_GALLOP consecutive times.  See listsort.txt for more info.
- */
-#define MIN_GALLOP 7
-
-/* Avoid malloc for small temp arrays. */
-#define MERGESTATE_TEMP_SIZE 256
-
-/* One MergeState exists on the stack per invocation of mergesort.  It's just
- * a convenient way to pass state around among the helper functions.
- */
-struct s_slice {
-    PyObject **base;
-    Py_ssize_t len;
-};
-
-typedef struct s_MergeState {
-    /* The user-supplied comparison function. or NULL if none given. */
-    PyObject *compare;
-
-    /* This controls when we get *into* galloping mode.  It's initialized
-     * to MIN_GALLOP.  merge_lo and merge_hi tend to nudge it higher for
-     * random data, and lower for highly structured data.
-     */
-    Py_ssize_t min_gallop;
-
-    /* 'a' is temp storage to help with merges.  It contains room for
-     * alloced entries.
-     */
-    PyObject **a;       /* may point to temparray below */
-    Py_ssize_t alloced;
-
-    /* A stack of n pending runs yet to be merged.  Run #i starts at
-     * address base[i] and extends for len[i] elements.  It's always
-     * true (so long as the indices are in bounds) that
-     *
-     *     pending[i].base + pending[i].len == pending[i+1].base
-     *
-     * so we could cut the storage for this, but it's a minor amount,
-     * and keeping all the info explicit simplifies the code.
-     */
-    int n;
-    struct s_slice pending[MAX_MERGE_PENDING];
-
-    /* 'a' points to this when possible, rather than muck with malloc. */
-    PyObject *temparray[MERGESTATE_TEMP_SIZE];
-} MergeState;
-
 /* Conceptually a MergeState's constructor. */
 static void
-merge_init(MergeState *ms, PyObject *compare)
+merge_init(MergeState *ms, PyObject *compare, Py_ssize_t list_size,
+           int has_keyfunc)
 {
     assert(ms != NULL);
     ms->compare = compare;
-    ms->a = ms->temparray;
-    ms->alloced = MERGESTATE_TEMP_SIZE;
+    if (has_keyfunc) {
+        /* The temporary space for merging will need at most half the list
+         * size rounded up.  Use the minimum possible space so we can use
+         * the rest of temparray for other things.  In particular, if
+         * there is enough extra space, listsort() will use it to store
+         * the keys.
+         */
+        ms->alloced = (list_size + 1) / 2;
+
+        /* ms->alloced describes how many keys will be stored at
+           ms->temparray, but we also need to store the values.  Hence,
+           ms->alloced is capped at half of MERGESTATE_TEMP_SIZE. */
+        if (MERGESTATE_TEMP_SIZE / 2 < ms->alloced)
+            ms->alloced = MERGESTATE_TEMP_SIZE / 2;
+        ms->a.values = &ms->temparray[ms->alloced];
+    }
+    else {
+        ms->alloced = MERGESTATE_TEMP_SIZE;
+        ms->a.values = NULL;
+    }
+    ms->a.keys = ms->temparray;
     ms->n = 0;
     ms->min_gallop = MIN_GALLOP;
 }
@@ -1413,10 +1668,8 @@ static void
 merge_freemem(MergeState *ms)
 {
     assert(ms != NULL);
-    if (ms->a != ms->temparray)
-        PyMem_Free(ms->a);
-    ms->a = ms->temparray;
-    ms->alloced = MERGESTATE_TEMP_SIZE;
+    if (ms->a.keys != ms->temparray)
+        PyMem_Free(ms->a.keys);
 }
 
 /* Ensure enough temp memory for 'need' array slots is available.
@@ -1425,53 +1678,60 @@ merge_freemem(MergeState *ms)
 static int
 merge_getmem(MergeState *ms, Py_ssize_t need)
 {
+    int multiplier;
+
     assert(ms != NULL);
     if (need <= ms->alloced)
         return 0;
+
+    multiplier = ms->a.values != NULL ? 2 : 1;
+
     /* Don't realloc!  That can cost cycles to copy the old data, but
      * we don't care what's in the block.
      */
     merge_freemem(ms);
-    if ((size_t)need > PY_SSIZE_T_MAX / sizeof(PyObject*)) {
+    if ((size_t)need > PY_SSIZE_T_MAX / sizeof(PyObject*) / multiplier) {
         PyErr_NoMemory();
         return -1;
     }
-    ms->a = (PyObject **)PyMem_Malloc(need * sizeof(PyObject*));
-    if (ms->a) {
+    ms->a.keys = (PyObject **)PyMem_Malloc(multiplier * need
+                                           * sizeof(PyObject *));
+    if (ms->a.keys != NULL) {
         ms->alloced = need;
+        if (ms->a.values != NULL)
+            ms->a.values = &ms->a.keys[need];
         return 0;
     }
     PyErr_NoMemory();
-    merge_freemem(ms);          /* reset to sane state */
     return -1;
 }
 #define MERGE_GETMEM(MS, NEED) ((NEED) <= (MS)->alloced ? 0 :   \
                                 merge_getmem(MS, NEED))
 
-/* Merge the na elements starting at pa with the nb elements starting at pb
- * in a stable way, in-place.  na and nb must be > 0, and pa + na == pb.
- * Must also have that *pb < *pa, that pa[na-1] belongs at the end of the
- * merge, and should have na <= nb.  See listsort.txt for more info.
- * Return 0 if successful, -1 if error.
+/* Merge the na elements starting at ssa with the nb elements starting at
+ * ssb.keys = ssa.keys + na in a stable way, in-place.  na and nb must be > 0.
+ * Must also have that ssa.keys[na-1] belongs at the end of the merge, and
+ * should have na <= nb.  See listsort.txt for more info.  Return 0 if
+ * successful, -1 if error.
  */
 static Py_ssize_t
-merge_lo(MergeState *ms, PyObject **pa, Py_ssize_t na,
-                         PyObject **pb, Py_ssize_t nb)
+merge_lo(MergeState *ms, sortslice ssa, Py_ssize_t na,
+         sortslice ssb, Py_ssize_t nb)
 {
     Py_ssize_t k;
-    PyObject *compare;
-    PyObject **dest;
+    sortslice dest;
     int result = -1;            /* guilty until proved innocent */
     Py_ssize_t min_gallop;
 
-    assert(ms && pa && pb && na > 0 && nb > 0 && pa + na == pb);
+    assert(ms && ssa.keys && ssb.keys && na > 0 && nb > 0);
+    assert(ssa.keys + na == ssb.keys);
     if (MERGE_GETMEM(ms, na) < 0)
         return -1;
-    memcpy(ms->a, pa, na * sizeof(PyObject*));
-    dest = pa;
-    pa = ms->a;
+    sortslice_memcpy(&ms->a, 0, &ssa, 0, na);
+    dest = ssa;
+    ssa = ms->a;
 
-    *dest++ = *pb++;
+    sortslice_copy_incr(&dest, &ssb);
     --nb;
     if (nb == 0)
         goto Succeed;
@@ -1479,7 +1739,6 @@ merge_lo(MergeState *ms, PyObject **pa, Py_ssize_t na,
         goto CopyB;
 
     min_gallop = ms->min_gallop;
-    compare = ms->compare;
     for (;;) {
         Py_ssize_t acount = 0;          /* # of times A won in a row */
         Py_ssize_t bcount = 0;          /* # of times B won in a row */
@@ -1489,11 +1748,11 @@ merge_lo(MergeState *ms, PyObject **pa, Py_ssize_t na,
          */
         for (;;) {
             assert(na > 1 && nb > 0);
-            k = ISLT(*pb, *pa, compare);
+            k = ISLT(ssb.keys[0], ssa.keys[0]);
             if (k) {
                 if (k < 0)
                     goto Fail;
-                *dest++ = *pb++;
+                sortslice_copy_incr(&dest, &ssb);
                 ++bcount;
                 acount = 0;
                 --nb;
@@ -1503,7 +1762,7 @@ merge_lo(MergeState *ms, PyObject **pa, Py_ssize_t na,
                     break;
             }
             else {
-                *dest++ = *pa++;
+                sortslice_copy_incr(&dest, &ssa);
                 ++acount;
                 bcount = 0;
                 --na;
@@ -1524,14 +1783,14 @@ merge_lo(MergeState *ms, PyObject **pa, Py_ssize_t na,
             assert(na > 1 && nb > 0);
             min_gallop -= min_gallop > 1;
             ms->min_gallop = min_gallop;
-            k = gallop_right(*pb, pa, na, 0, compare);
+            k = gallop_right(ms, ssb.keys[0], ssa.keys, na, 0);
             acount = k;
             if (k) {
                 if (k < 0)
                     goto Fail;
-                memcpy(dest, pa, k * sizeof(PyObject *));
-                dest += k;
-                pa += k;
+                sortslice_memcpy(&dest, 0, &ssa, 0, k);
+                sortslice_advance(&dest, k);
+                sortslice_advance(&ssa, k);
                 na -= k;
                 if (na == 1)
                     goto CopyB;
@@ -1542,24 +1801,24 @@ merge_lo(MergeState *ms, PyObject **pa, Py_ssize_t na,
                 if (na == 0)
                     goto Succeed;
             }
-            *dest++ = *pb++;
+            sortslice_copy_incr(&dest, &ssb);
             --nb;
             if (nb == 0)
                 goto Succeed;
 
-            k = gallop_left(*pa, pb, nb, 0, compare);
+            k = gallop_left(ms, ssa.keys[0], ssb.keys, nb, 0);
             bcount = k;
             if (k) {
                 if (k < 0)
                     goto Fail;
-                memmove(dest, pb, k * sizeof(PyObject *));
-                dest += k;
-                pb += k;
+                sortslice_memmove(&dest, 0, &ssb, 0, k);
+                sortslice_advance(&dest, k);
+                sortslice_advance(&ssb, k);
                 nb -= k;
                 if (nb == 0)
                     goto Succeed;
             }
-            *dest++ = *pa++;
+            sortslice_copy_incr(&dest, &ssa);
             --na;
             if (na == 1)
                 goto CopyB;
@@ -1571,44 +1830,46 @@ Succeed:
     result = 0;
 Fail:
     if (na)
-        memcpy(dest, pa, na * sizeof(PyObject*));
+        sortslice_memcpy(&dest, 0, &ssa, 0, na);
     return result;
 CopyB:
     assert(na == 1 && nb > 0);
-    /* The last element of pa belongs at the end of the merge. */
-    memmove(dest, pb, nb * sizeof(PyObject *));
-    dest[nb] = *pa;
+    /* The last element of ssa belongs at the end of the merge. */
+    sortslice_memmove(&dest, 0, &ssb, 0, nb);
+    sortslice_copy(&dest, nb, &ssa, 0);
     return 0;
 }
 
-/* Merge the na elements starting at pa with the nb elements starting at pb
- * in a stable way, in-place.  na and nb must be > 0, and pa + na == pb.
- * Must also have that *pb < *pa, that pa[na-1] belongs at the end of the
- * merge, and should have na >= nb.  See listsort.txt for more info.
- * Return 0 if successful, -1 if error.
+/* Merge the na elements starting at pa with the nb elements starting at
+ * ssb.keys = ssa.keys + na in a stable way, in-place.  na and nb must be > 0.
+ * Must also have that ssa.keys[na-1] belongs at the end of the merge, and
+ * should have na >= nb.  See listsort.txt for more info.  Return 0 if
+ * successful, -1 if error.
  */
 static Py_ssize_t
-merge_hi(MergeState *ms, PyObject **pa, Py_ssize_t na, PyObject **pb, Py_ssize_t nb)
+merge_hi(MergeState *ms, sortslice ssa, Py_ssize_t na,
+         sortslice ssb, Py_ssize_t nb)
 {
     Py_ssize_t k;
-    PyObject *compare;
-    PyObject **dest;
+    sortslice dest, basea, baseb;
     int result = -1;            /* guilty until proved innocent */
-    PyObject **basea;
-    PyObject **baseb;
     Py_ssize_t min_gallop;
 
-    assert(ms && pa && pb && na > 0 && nb > 0 && pa + na == pb);
+    assert(ms && ssa.keys && ssb.keys && na > 0 && nb > 0);
+    assert(ssa.keys + na == ssb.keys);
     if (MERGE_GETMEM(ms, nb) < 0)
         return -1;
-    dest = pb + nb - 1;
-    memcpy(ms->a, pb, nb * sizeof(PyObject*));
-    basea = pa;
+    dest = ssb;
+    sortslice_advance(&dest, nb-1);
+    sortslice_memcpy(&ms->a, 0, &ssb, 0, nb);
+    basea = ssa;
     baseb = ms->a;
-    pb = ms->a + nb - 1;
-    pa += na - 1;
+    ssb.keys = ms->a.keys + nb - 1;
+    if (ssb.values != NULL)
+        ssb.values = ms->a.values + nb - 1;
+    sortslice_advance(&ssa, na - 1);
 
-    *dest-- = *pa--;
+    sortslice_copy_decr(&dest, &ssa);
     --na;
     if (na == 0)
         goto Succeed;
@@ -1616,7 +1877,6 @@ merge_hi(MergeState *ms, PyObject **pa, Py_ssize_t na, PyObject **pb, Py_ssize_t
         goto CopyA;
 
     min_gallop = ms->min_gallop;
-    compare = ms->compare;
     for (;;) {
         Py_ssize_t acount = 0;          /* # of times A won in a row */
         Py_ssize_t bcount = 0;          /* # of times B won in a row */
@@ -1626,11 +1886,11 @@ merge_hi(MergeState *ms, PyObject **pa, Py_ssize_t na, PyObject **pb, Py_ssize_t
          */
         for (;;) {
             assert(na > 0 && nb > 1);
-            k = ISLT(*pb, *pa, compare);
+            k = ISLT(ssb.keys[0], ssa.keys[0]);
             if (k) {
                 if (k < 0)
                     goto Fail;
-                *dest-- = *pa--;
+                sortslice_copy_decr(&dest, &ssa);
                 ++acount;
                 bcount = 0;
                 --na;
@@ -1640,7 +1900,7 @@ merge_hi(MergeState *ms, PyObject **pa, Py_ssize_t na, PyObject **pb, Py_ssize_t
                     break;
             }
             else {
-                *dest-- = *pb--;
+                sortslice_copy_decr(&dest, &ssb);
                 ++bcount;
                 acount = 0;
                 --nb;
@@ -1661,33 +1921,33 @@ merge_hi(MergeState *ms, PyObject **pa, Py_ssize_t na, PyObject **pb, Py_ssize_t
             assert(na > 0 && nb > 1);
             min_gallop -= min_gallop > 1;
             ms->min_gallop = min_gallop;
-            k = gallop_right(*pb, basea, na, na-1, compare);
+            k = gallop_right(ms, ssb.keys[0], basea.keys, na, na-1);
             if (k < 0)
                 goto Fail;
             k = na - k;
             acount = k;
             if (k) {
-                dest -= k;
-                pa -= k;
-                memmove(dest+1, pa+1, k * sizeof(PyObject *));
+                sortslice_advance(&dest, -k);
+                sortslice_advance(&ssa, -k);
+                sortslice_memmove(&dest, 1, &ssa, 1, k);
                 na -= k;
                 if (na == 0)
                     goto Succeed;
             }
-            *dest-- = *pb--;
+            sortslice_copy_decr(&dest, &ssb);
             --nb;
             if (nb == 1)
                 goto CopyA;
 
-            k = gallop_left(*pa, baseb, nb, nb-1, compare);
+            k = gallop_left(ms, ssa.keys[0], baseb.keys, nb, nb-1);
             if (k < 0)
                 goto Fail;
             k = nb - k;
             bcount = k;
             if (k) {
-                dest -= k;
-                pb -= k;
-                memcpy(dest+1, pb+1, k * sizeof(PyObject *));
+                sortslice_advance(&dest, -k);
+                sortslice_advance(&ssb, -k);
+                sortslice_memcpy(&dest, 1, &ssb, 1, k);
                 nb -= k;
                 if (nb == 1)
                     goto CopyA;
@@ -1698,7 +1958,7 @@ merge_hi(MergeState *ms, PyObject **pa, Py_ssize_t na, PyObject **pb, Py_ssize_t
                 if (nb == 0)
                     goto Succeed;
             }
-            *dest-- = *pa--;
+            sortslice_copy_decr(&dest, &ssa);
             --na;
             if (na == 0)
                 goto Succeed;
@@ -1710,15 +1970,15 @@ Succeed:
     result = 0;
 Fail:
     if (nb)
-        memcpy(dest-(nb-1), baseb, nb * sizeof(PyObject*));
+        sortslice_memcpy(&dest, -(nb-1), &baseb, 0, nb);
     return result;
 CopyA:
     assert(nb == 1 && na > 0);
-    /* The first element of pb belongs at the front of the merge. */
-    dest -= na;
-    pa -= na;
-    memmove(dest+1, pa+1, na * sizeof(PyObject *));
-    *dest = *pb;
+    /* The first element of ssb belongs at the front of the merge. */
+    sortslice_memmove(&dest, 1-na, &ssa, 1-na, na);
+    sortslice_advance(&dest, -na);
+    sortslice_advance(&ssa, -na);
+    sortslice_copy(&dest, 0, &ssb, 0);
     return 0;
 }
 
@@ -1728,22 +1988,21 @@ CopyA:
 static Py_ssize_t
 merge_at(MergeState *ms, Py_ssize_t i)
 {
-    PyObject **pa, **pb;
+    sortslice ssa, ssb;
     Py_ssize_t na, nb;
     Py_ssize_t k;
-    PyObject *compare;
 
     assert(ms != NULL);
     assert(ms->n >= 2);
     assert(i >= 0);
     assert(i == ms->n - 2 || i == ms->n - 3);
 
-    pa = ms->pending[i].base;
+    ssa = ms->pending[i].base;
     na = ms->pending[i].len;
-    pb = ms->pending[i+1].base;
+    ssb = ms->pending[i+1].base;
     nb = ms->pending[i+1].len;
     assert(na > 0 && nb > 0);
-    assert(pa + na == pb);
+    assert(ssa.keys + na == ssb.keys);
 
     /* Record the length of the combined runs; if i is the 3rd-last
      * run now, also slide over the last run (which isn't involved
@@ -1757,11 +2016,10 @@ merge_at(MergeState *ms, Py_ssize_t i)
     /* Where does b start in a?  Elements in a before that can be
      * ignored (already in place).
      */
-    compare = ms->compare;
-    k = gallop_right(*pb, pa, na, 0, compare);
+    k = gallop_right(ms, *ssb.keys, ssa.keys, na, 0);
     if (k < 0)
         return -1;
-    pa += k;
+    sortslice_advance(&ssa, k);
     na -= k;
     if (na == 0)
         return 0;
@@ -1769,7 +2027,7 @@ merge_at(MergeState *ms, Py_ssize_t i)
     /* Where does a end in b?  Elements in b after that can be
      * ignored (already in place).
      */
-    nb = gallop_left(pa[na-1], pb, nb, nb-1, compare);
+    nb = gallop_left(ms, ssa.keys[na-1], ssb.keys, nb, nb-1);
     if (nb <= 0)
         return nb;
 
@@ -1777,9 +2035,9 @@ merge_at(MergeState *ms, Py_ssize_t i)
      * min(na, nb) elements.
      */
     if (na <= nb)
-        return merge_lo(ms, pa, na, pb, nb);
+        return merge_lo(ms, ssa, na, ssb, nb);
     else
-        return merge_hi(ms, pa, na, pb, nb);
+        return merge_hi(ms, ssa, na, ssb, nb);
 }
 
 /* Examine the stack of runs waiting to be merged, merging adjacent runs
@@ -1860,178 +2118,406 @@ merge_compute_minrun(Py_ssize_t n)
     return n + r;
 }
 
-/* Special wrapper to support stable sorting using the decorate-sort-undecorate
-   pattern.  Holds a key which is used for comparisons and the original record
-   which is returned during the undecorate phase.  By exposing only the key
-   during comparisons, the underlying sort stability characteristics are left
-   unchanged.  Also, if a custom comparison function is used, it will only see
-   the key instead of a full record. */
-
-typedef struct {
-    PyObject_HEAD
-    PyObject *key;
-    PyObject *value;
-} sortwrapperobject;
-
-PyDoc_STRVAR(sortwrapper_doc, "Object wrapper with a custom sort key.");
-static PyObject *
-sortwrapper_richcompare(sortwrapperobject *, sortwrapperobject *, int);
 static void
-sortwrapper_dealloc(sortwrapperobject *);
-
-static PyTypeObject sortwrapper_type = {
-    PyVarObject_HEAD_INIT(&PyType_Type, 0)
-    "sortwrapper",                              /* tp_name */
-    sizeof(sortwrapperobject),                  /* tp_basicsize */
-    0,                                          /* tp_itemsize */
-    /* methods */
-    (destructor)sortwrapper_dealloc,            /* tp_dealloc */
-    0,                                          /* tp_print */
-    0,                                          /* tp_getattr */
-    0,                                          /* tp_setattr */
-    0,                                          /* tp_compare */
-    0,                                          /* tp_repr */
-    0,                                          /* tp_as_number */
-    0,                                          /* tp_as_sequence */
-    0,                                          /* tp_as_mapping */
-    0,                                          /* tp_hash */
-    0,                                          /* tp_call */
-    0,                                          /* tp_str */
-    PyObject_GenericGetAttr,                    /* tp_getattro */
-    0,                                          /* tp_setattro */
-    0,                                          /* tp_as_buffer */
-    Py_TPFLAGS_DEFAULT |
-    Py_TPFLAGS_HAVE_RICHCOMPARE,                /* tp_flags */
-    sortwrapper_doc,                            /* tp_doc */
-    0,                                          /* tp_traverse */
-    0,                                          /* tp_clear */
-    (richcmpfunc)sortwrapper_richcompare,       /* tp_richcompare */
-};
-
+reverse_sortslice(sortslice *s, Py_ssize_t n)
+{
+    reverse_slice(s->keys, &s->keys[n]);
+    if (s->values != NULL)
+        reverse_slice(s->values, &s->values[n]);
+}
 
-static PyObject *
-sortwrapper_richcompare(sortwrapperobject *a, sortwrapperobject *b, int op)
+/* Choose the compare for keys that are all of the same type, or NULL */
+static int (*
+type_compare(PyTypeObject *type, MergeState *ms))(PyObject *, PyObject *,
+                                                   MergeState *)
 {
-    if (!PyObject_TypeCheck(b, &sortwrapper_type)) {
-        PyErr_SetString(PyExc_TypeError,
-            "expected a sortwrapperobject");
-        return NULL;
+    if (type == &PyString_Type)
+        return unsafe_string_compare;
+#ifdef Py_USING_UNICODE
+    if (type == &PyUnicode_Type)
+        return unsafe_unicode_compare;
+#endif
+    if (type == &PyInt_Type)
+        return unsafe_int_compare;
+    if (type == &PyLong_Type)
+        return unsafe_long_compare;
+    if (type == &PyFloat_Type)
+        return unsafe_float_compare;
+    /* Old-style instances compare through their class, which
+       PyObject_RichCompare() handles apart. */
+    if (type != &PyInstance_Type &&
+        PyType_HasFeature(type, Py_TPFLAGS_HAVE_RICHCOMPARE) &&
+        type->tp_richcompare != NULL) {
+        ms->key_richcompare = type->tp_richcompare;
+        return unsafe_object_compare;
     }
-    return PyObject_RichCompare(a->key, b->key, op);
+    return NULL;
 }
 
+/* Set ms->key_compare for the n keys.  Sorting does many comparisons, so
+ * one pass checking whether the keys are all of the same type, or are all
+ * tuples whose first items are of the same type, pays for itself.
+ */
 static void
-sortwrapper_dealloc(sortwrapperobject *so)
+choose_key_compare(MergeState *ms, PyObject **keys, Py_ssize_t n)
 {
-    Py_XDECREF(so->key);
-    Py_XDECREF(so->value);
-    PyObject_Del(so);
+    PyTypeObject *key_type;
+    int keys_are_in_tuples, keys_are_all_same_type = 1;
+    int (*compare)(PyObject *, PyObject *, MergeState *);
+    Py_ssize_t i;
+
+    ms->key_compare = safe_object_compare;
+    if (n < 2)
+        return;
+
+    /* Assume the first key is representative of the whole list. */
+    keys_are_in_tuples = (Py_TYPE(keys[0]) == &PyTuple_Type &&
+                          Py_SIZE(keys[0]) > 0);
+    key_type = keys_are_in_tuples ? Py_TYPE(PyTuple_GET_ITEM(keys[0], 0))
+                                  : Py_TYPE(keys[0]);
+    for (i = 0; i < n; i++) {
+        PyObject *key = keys[i];
+        if (keys_are_in_tuples) {
+            if (Py_TYPE(key) != &PyTuple_Type || Py_SIZE(key) == 0) {
+                keys_are_in_tuples = 0;
+                keys_are_all_same_type = 0;
+                break;
+            }
+            key = PyTuple_GET_ITEM(key, 0);
+        }
+        if (Py_TYPE(key) != key_type) {
+            keys_are_all_same_type = 0;
+            /* the keys could still all be tuples */
+            if (!keys_are_in_tuples)
+                break;
+        }
+    }
+
+    compare = NULL;
+    if (keys_are_all_same_type)
+        compare = type_compare(key_type, ms);
+    if (compare == NULL)
+        compare = safe_object_compare;
+    if (keys_are_in_tuples) {
+        /* unsafe_tuple_compare() only handles non-empty tuples */
+        if (key_type == &PyTuple_Type)
+            compare = safe_object_compare;
+        ms->tuple_elem_compare = compare;
+        compare = unsafe_tuple_compare;
+    }
+    ms->key_compare = compare;
 }
 
-/* Returns a new reference to a sortwrapper.
-   Consumes the references to the two underlying objects. */
+/* Sorting with parallel=True.  When there are many keys, and they are all
+ * int, all float or all str objects, listsort() copies them as C values
+ * into an array of native_item, and sorts that with the GIL released: a
+ * merge sort over slices of the array, by several threads when there are
+ * processors to spare.  Then it moves the items in the order found.
+ *
+ * A stable sort of totally ordered keys has only one possible result, so
+ * the list comes out the same as from the mergesort above.  Floats are
+ * totally ordered short of NaNs, and a NaN key leaves the list to the
+ * mergesort.
+ */
+
+/* Smaller lists are left to the mergesort, and every thread gets at least
+ * this many items.
+ */
+#define PARALLEL_SORT_MIN_SIZE 32768
 
-static PyObject *
-build_sortwrapper(PyObject *key, PyObject *value)
+/* The most threads sharing a sort.  A power of 2. */
+#define PARALLEL_SORT_MAX_THREADS 8
+
+/* Runs of this many items are sorted by insertion before merging. */
+#define NATIVE_MIN_RUN 32
+
+#define NATIVE_INT 0
+#define NATIVE_FLOAT 1
+#define NATIVE_STRING 2
+
+typedef struct {
+    union {
+        long i;
+        double f;
+        struct {
+            const char *p;      /* flattened while the GIL is held */
+            Py_ssize_t len;
+        } s;
+    } key;
+    Py_ssize_t index;           /* of the item, before sorting */
+} native_item;
+
+/* One slice of the sort to be done by one thread: sort src[lo:hi], using
+ * dst[lo:hi] as scratch space if mid is -1, or merge the sorted
+ * src[lo:mid] and src[mid:hi] into dst[lo:hi].
+ */
+typedef struct {
+    native_item *src;
+    native_item *dst;
+    Py_ssize_t lo, mid, hi;
+    int kind;
+#ifdef WITH_THREAD
+    PyThread_type_lock done;    /* held until the thread is done */
+#endif
+} native_job;
+
+Py_LOCAL_INLINE(int)
+native_lt(native_item *a, native_item *b, int kind)
 {
-    sortwrapperobject *so;
+    Py_ssize_t len_a, len_b;
+    int res;
 
-    so = PyObject_New(sortwrapperobject, &sortwrapper_type);
-    if (so == NULL)
-        return NULL;
-    so->key = key;
-    so->value = value;
-    return (PyObject *)so;
+    switch (kind) {
+    case NATIVE_INT:
+        return a->key.i < b->key.i;
+    case NATIVE_FLOAT:
+        return a->key.f < b->key.f;
+    default:
+        /* str objects never change, and the list owns these */
+        len_a = a->key.s.len;
+        len_b = b->key.s.len;
+        res = memcmp(a->key.s.p, b->key.s.p,
+                     len_a < len_b ? len_a : len_b);
+        return res != 0 ? res < 0 : len_a < len_b;
+    }
 }
 
-/* Returns a new reference to the value underlying the wrapper. */
-static PyObject *
-sortwrapper_getvalue(PyObject *so)
+/* Merge the sorted src[lo:mid] and src[mid:hi] into dst[lo:hi], stably */
+static void
+native_merge(native_item *src, native_item *dst, Py_ssize_t lo,
+             Py_ssize_t mid, Py_ssize_t hi, int kind)
 {
-    PyObject *value;
+    Py_ssize_t i = lo, j = mid, k = lo;
 
-    if (!PyObject_TypeCheck(so, &sortwrapper_type)) {
-        PyErr_SetString(PyExc_TypeError,
-            "expected a sortwrapperobject");
-        return NULL;
+    if (lo < mid && mid < hi && native_lt(&src[mid], &src[mid-1], kind)) {
+        while (i < mid && j < hi) {
+            if (native_lt(&src[j], &src[i], kind))
+                dst[k++] = src[j++];
+            else
+                dst[k++] = src[i++];
+        }
     }
-    value = ((sortwrapperobject *)so)->value;
-    Py_INCREF(value);
-    return value;
+    memcpy(&dst[k], &src[i], (mid - i) * sizeof(native_item));
+    k += mid - i;
+    memcpy(&dst[k], &src[j], (hi - j) * sizeof(native_item));
 }
 
-/* Wrapper for user specified cmp functions in combination with a
-   specified key function.  Makes sure the cmp function is presented
-   with the actual key instead of the sortwrapper */
-
-typedef struct {
-    PyObject_HEAD
-    PyObject *func;
-} cmpwrapperobject;
+/* Sort items[lo:hi] stably, using temp[lo:hi] as scratch space */
+static void
+native_sort_slice(native_item *items, native_item *temp, Py_ssize_t lo,
+                  Py_ssize_t hi, int kind)
+{
+    native_item *src = items, *dst = temp, *swap;
+    native_item pivot;
+    Py_ssize_t start, mid, end, width, i, j;
+
+    for (start = lo; start < hi; start += NATIVE_MIN_RUN) {
+        end = hi - start < NATIVE_MIN_RUN ? hi : start + NATIVE_MIN_RUN;
+        for (i = start + 1; i < end; i++) {
+            pivot = items[i];
+            for (j = i; j > start && native_lt(&pivot, &items[j-1], kind); j--)
+                items[j] = items[j-1];
+            items[j] = pivot;
+        }
+    }
+    for (width = NATIVE_MIN_RUN; width < hi - lo; width *= 2) {
+        for (start = lo; start < hi; start = end) {
+            mid = hi - start < width ? hi : start + width;
+            end = hi - mid < width ? hi : mid + width;
+            native_merge(src, dst, start, mid, end, kind);
+        }
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != items)
+        memcpy(&items[lo], &src[lo], (hi - lo) * sizeof(native_item));
+}
 
 static void
-cmpwrapper_dealloc(cmpwrapperobject *co)
+native_job_run(native_job *job)
 {
-    Py_XDECREF(co->func);
-    PyObject_Del(co);
+    if (job->mid < 0)
+        native_sort_slice(job->src, job->dst, job->lo, job->hi, job->kind);
+    else
+        native_merge(job->src, job->dst, job->lo, job->mid, job->hi,
+                     job->kind);
 }
 
-static PyObject *
-cmpwrapper_call(cmpwrapperobject *co, PyObject *args, PyObject *kwds)
+#ifdef WITH_THREAD
+static void
+native_job_thread(void *arg)
 {
-    PyObject *x, *y, *xx, *yy;
+    native_job *job = (native_job *)arg;
 
-    if (!PyArg_UnpackTuple(args, "", 2, 2, &x, &y))
-        return NULL;
-    if (!PyObject_TypeCheck(x, &sortwrapper_type) ||
-        !PyObject_TypeCheck(y, &sortwrapper_type)) {
-        PyErr_SetString(PyExc_TypeError,
-            "expected a sortwrapperobject");
-        return NULL;
+    native_job_run(job);
+    PyThread_release_lock(job->done);
+}
+#endif
+
+/* Run the jobs, each one after the first in a thread of its own when one
+ * can be started, and wait for them all.  Called without the GIL.
+ */
+static void
+native_run_jobs(native_job *jobs, int njobs)
+{
+    int i;
+#ifdef WITH_THREAD
+    int started[PARALLEL_SORT_MAX_THREADS];
+
+    for (i = 1; i < njobs; i++)
+        started[i] = (jobs[i].done != NULL &&
+                      PyThread_start_new_thread(native_job_thread,
+                                                &jobs[i]) != -1);
+    native_job_run(&jobs[0]);
+    for (i = 1; i < njobs; i++) {
+        if (started[i])
+            PyThread_acquire_lock(jobs[i].done, 1);
+        else
+            native_job_run(&jobs[i]);
     }
-    xx = ((sortwrapperobject *)x)->key;
-    yy = ((sortwrapperobject *)y)->key;
-    return PyObject_CallFunctionObjArgs(co->func, xx, yy, NULL);
+#else
+    for (i = 0; i < njobs; i++)
+        native_job_run(&jobs[i]);
+#endif
 }
 
-PyDoc_STRVAR(cmpwrapper_doc, "cmp() wrapper for sort with custom keys.");
+/* The number of threads to sort n items: a power of 2, no more than there
+ * are processors online.
+ */
+static int
+native_thread_count(Py_ssize_t n)
+{
+    long ncpu = 1;
+    int nthreads = 1;
 
-static PyTypeObject cmpwrapper_type = {
-    PyVarObject_HEAD_INIT(&PyType_Type, 0)
-    "cmpwrapper",                               /* tp_name */
-    sizeof(cmpwrapperobject),                   /* tp_basicsize */
-    0,                                          /* tp_itemsize */
-    /* methods */
-    (destructor)cmpwrapper_dealloc,             /* tp_dealloc */
-    0,                                          /* tp_print */
-    0,                                          /* tp_getattr */
-    0,                                          /* tp_setattr */
-    0,                                          /* tp_compare */
-    0,                                          /* tp_repr */
-    0,                                          /* tp_as_number */
-    0,                                          /* tp_as_sequence */
-    0,                                          /* tp_as_mapping */
-    0,                                          /* tp_hash */
-    (ternaryfunc)cmpwrapper_call,               /* tp_call */
-    0,                                          /* tp_str */
-    PyObject_GenericGetAttr,                    /* tp_getattro */
-    0,                                          /* tp_setattro */
-    0,                                          /* tp_as_buffer */
-    Py_TPFLAGS_DEFAULT,                         /* tp_flags */
-    cmpwrapper_doc,                             /* tp_doc */
-};
+#ifdef WITH_THREAD
+#if defined(HAVE_SYSCONF) && defined(_SC_NPROCESSORS_ONLN)
+    ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    ncpu = PARALLEL_SORT_MAX_THREADS / 2;
+#endif
+#endif
+    while (nthreads < PARALLEL_SORT_MAX_THREADS && nthreads * 2 <= ncpu &&
+           n / (nthreads * 2) >= PARALLEL_SORT_MIN_SIZE)
+        nthreads *= 2;
+    return nthreads;
+}
 
-static PyObject *
-build_cmpwrapper(PyObject *cmpfunc)
-{
-    cmpwrapperobject *co;
+/* Sort the n keys of lo, and their values, with native_items.  Returns 1
+ * if lo is sorted, or 0 if the keys are not of a kind handled here or there
+ * is not enough memory, and lo is left as it was for the mergesort.
+ */
+static int
+native_sort(MergeState *ms, sortslice *lo, Py_ssize_t n)
+{
+    native_item *items, *src, *dst, *swap;
+    native_job jobs[PARALLEL_SORT_MAX_THREADS];
+    PyObject **scratch;
+    Py_ssize_t i, bounds[PARALLEL_SORT_MAX_THREADS + 1];
+    int kind, nthreads, njobs, width, k;
+
+    if (ms->key_compare == unsafe_int_compare)
+        kind = NATIVE_INT;
+    else if (ms->key_compare == unsafe_float_compare)
+        kind = NATIVE_FLOAT;
+    else if (ms->key_compare == unsafe_string_compare)
+        kind = NATIVE_STRING;
+    else
+        return 0;
 
-    co = PyObject_New(cmpwrapperobject, &cmpwrapper_type);
-    if (co == NULL)
-        return NULL;
-    Py_INCREF(cmpfunc);
-    co->func = cmpfunc;
-    return (PyObject *)co;
+    /* room for the items and as many again to merge them */
+    if ((size_t)n > PY_SSIZE_T_MAX / (2 * sizeof(native_item)))
+        return 0;
+    items = (native_item *)PyMem_MALLOC(2 * n * sizeof(native_item));
+    if (items == NULL)
+        return 0;
+    for (i = 0; i < n; i++) {
+        PyObject *key = lo->keys[i];
+
+        if (kind == NATIVE_INT)
+            items[i].key.i = PyInt_AS_LONG(key);
+        else if (kind == NATIVE_FLOAT) {
+            items[i].key.f = PyFloat_AS_DOUBLE(key);
+            if (Py_IS_NAN(items[i].key.f)) {
+                PyMem_FREE(items);
+                return 0;
+            }
+        }
+        else {
+            /* a lazy string is flattened here, not by the threads */
+            items[i].key.s.p = PyString_AS_STRING(key);
+            items[i].key.s.len = PyString_GET_SIZE(key);
+        }
+        items[i].index = i;
+    }
+
+    nthreads = native_thread_count(n);
+    for (k = 0; k < nthreads; k++)
+        bounds[k] = n / nthreads * k;
+    bounds[nthreads] = n;
+    for (k = 0; k < nthreads; k++) {
+        jobs[k].kind = kind;
+#ifdef WITH_THREAD
+        jobs[k].done = NULL;
+        if (k > 0) {
+            jobs[k].done = PyThread_allocate_lock();
+            if (jobs[k].done != NULL)
+                PyThread_acquire_lock(jobs[k].done, 1);
+        }
+#endif
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    src = items;
+    dst = items + n;
+    for (k = 0; k < nthreads; k++) {
+        jobs[k].src = src;
+        jobs[k].dst = dst;
+        jobs[k].lo = bounds[k];
+        jobs[k].mid = -1;
+        jobs[k].hi = bounds[k+1];
+    }
+    native_run_jobs(jobs, nthreads);
+    /* merge the slices pairwise, halving the jobs each round */
+    for (width = 1; width < nthreads; width *= 2) {
+        njobs = 0;
+        for (k = 0; k < nthreads; k += 2 * width) {
+            jobs[njobs].src = src;
+            jobs[njobs].dst = dst;
+            jobs[njobs].lo = bounds[k];
+            jobs[njobs].mid = bounds[k + width];
+            jobs[njobs].hi = bounds[k + 2 * width];
+            njobs++;
+        }
+        native_run_jobs(jobs, njobs);
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+    Py_END_ALLOW_THREADS
+
+#ifdef WITH_THREAD
+    for (k = 1; k < nthreads; k++) {
+        if (jobs[k].done != NULL) {
+            PyThread_release_lock(jobs[k].done);
+            PyThread_free_lock(jobs[k].done);
+        }
+    }
+#endif
+
+    /* src has the sorted items; dst is free to hold the old order */
+    scratch = (PyObject **)dst;
+    memcpy(scratch, lo->keys, n * sizeof(PyObject *));
+    for (i = 0; i < n; i++)
+        lo->keys[i] = scratch[src[i].index];
+    if (lo->values != NULL) {
+        memcpy(scratch, lo->values, n * sizeof(PyObject *));
+        for (i = 0; i < n; i++)
+            lo->values[i] = scratch[src[i].index];
+    }
+    PyMem_FREE(items);
+    return 1;
 }
 
 /* An adaptive, stable, natural mergesort.  See listsort.txt.
@@ -2043,25 +2529,28 @@ static PyObject *
 listsort(PyListObject *self, PyObject *args, PyObject *kwds)
 {
     MergeState ms;
-    PyObject **lo, **hi;
     Py_ssize_t nremaining;
     Py_ssize_t minrun;
+    sortslice lo;
     Py_ssize_t saved_ob_size, saved_allocated;
     PyObject **saved_ob_item;
     PyObject **final_ob_item;
     PyObject *compare = NULL;
     PyObject *result = NULL;            /* guilty until proved innocent */
     int reverse = 0;
+    int parallel = 0;
     PyObject *keyfunc = NULL;
     Py_ssize_t i;
-    PyObject *key, *value, *kvpair;
-    static char *kwlist[] = {"cmp", "key", "reverse", 0};
+    PyObject **keys;
+    static const char * const kwlist[] = {"cmp", "key", "reverse",
+                                          "parallel", 0};
+    static _PyArg_Parser _parser = {"|OOii:sort", kwlist, 0};
 
     assert(self != NULL);
     assert (PyList_Check(self));
     if (args != NULL) {
-        if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OOi:sort",
-            kwlist, &compare, &keyfunc, &reverse))
+        if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+            &compare, &keyfunc, &reverse, &parallel))
             return NULL;
     }
     if (compare == Py_None)
@@ -2071,12 +2560,7 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
         return NULL;
     if (keyfunc == Py_None)
         keyfunc = NULL;
-    if (compare != NULL && keyfunc != NULL) {
-        compare = build_cmpwrapper(compare);
-        if (compare == NULL)
-            return NULL;
-    } else
-        Py_XINCREF(compare);
+    Py_XINCREF(compare);
 
     /* The list is temporarily made empty, so that mutations performed
      * by comparison functions can't affect the slice of memory we're
@@ -2090,59 +2574,80 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
     self->ob_item = NULL;
     self->allocated = -1; /* any operation will reset it to >= 0 */
 
-    if (keyfunc != NULL) {
-        for (i=0 ; i < saved_ob_size ; i++) {
-            value = saved_ob_item[i];
-            key = PyObject_CallFunctionObjArgs(keyfunc, value,
-                                               NULL);
-            if (key == NULL) {
-                for (i=i-1 ; i>=0 ; i--) {
-                    kvpair = saved_ob_item[i];
-                    value = sortwrapper_getvalue(kvpair);
-                    saved_ob_item[i] = value;
-                    Py_DECREF(kvpair);
-                }
-                goto dsu_fail;
+    /* The keys are kept in an array of their own, which goes along with
+     * the values when they move.  The compares only see the keys.
+     */
+    if (keyfunc == NULL) {
+        keys = NULL;
+        lo.keys = saved_ob_item;
+        lo.values = NULL;
+    }
+    else {
+        if (saved_ob_size < MERGESTATE_TEMP_SIZE/2)
+            /* Leverage stack space we allocated but won't otherwise use */
+            keys = &ms.temparray[saved_ob_size+1];
+        else {
+            keys = PyMem_MALLOC(sizeof(PyObject *) * saved_ob_size);
+            if (keys == NULL) {
+                PyErr_NoMemory();
+                goto keyfunc_fail;
             }
-            kvpair = build_sortwrapper(key, value);
-            if (kvpair == NULL)
-                goto dsu_fail;
-            saved_ob_item[i] = kvpair;
         }
-    }
 
-    /* Reverse sort stability achieved by initially reversing the list,
-    applying a stable forward sort, then reversing the final result. */
-    if (reverse && saved_ob_size > 1)
-        reverse_slice(saved_ob_item, saved_ob_item + saved_ob_size);
+        for (i = 0; i < saved_ob_size ; i++) {
+            keys[i] = PyObject_CallFunctionObjArgs(keyfunc, saved_ob_item[i],
+                                                   NULL);
+            if (keys[i] == NULL) {
+                for (i=i-1 ; i>=0 ; i--)
+                    Py_DECREF(keys[i]);
+                if (saved_ob_size >= MERGESTATE_TEMP_SIZE/2)
+                    PyMem_FREE(keys);
+                goto keyfunc_fail;
+            }
+        }
+
+        lo.keys = keys;
+        lo.values = saved_ob_item;
+    }
 
-    merge_init(&ms, compare);
+    merge_init(&ms, compare, saved_ob_size, keys != NULL);
+    if (compare != NULL)
+        ms.key_compare = user_compare;
+    else
+        choose_key_compare(&ms, lo.keys, saved_ob_size);
 
     nremaining = saved_ob_size;
     if (nremaining < 2)
         goto succeed;
 
+    /* Reverse sort stability achieved by initially reversing the list,
+    applying a stable forward sort, then reversing the final result. */
+    if (reverse)
+        reverse_sortslice(&lo, saved_ob_size);
+
+    if (parallel && saved_ob_size >= PARALLEL_SORT_MIN_SIZE &&
+        native_sort(&ms, &lo, saved_ob_size))
+        goto succeed;
+
     /* March over the array once, left to right, finding natural runs,
      * and extending short natural runs to minrun elements.
      */
-    lo = saved_ob_item;
-    hi = lo + nremaining;
     minrun = merge_compute_minrun(nremaining);
     do {
         int descending;
         Py_ssize_t n;
 
         /* Identify next run. */
-        n = count_run(lo, hi, compare, &descending);
+        n = count_run(&ms, lo.keys, lo.keys + nremaining, &descending);
         if (n < 0)
             goto fail;
         if (descending)
-            reverse_slice(lo, lo + n);
+            reverse_sortslice(&lo, n);
         /* If short, extend to min(minrun, nremaining). */
         if (n < minrun) {
             const Py_ssize_t force = nremaining <= minrun ?
                               nremaining : minrun;
-            if (binarysort(lo, lo + force, lo + n, compare) < 0)
+            if (binarysort(&ms, lo, lo.keys + force, lo.keys + n) < 0)
                 goto fail;
             n = force;
         }
@@ -2154,27 +2659,27 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
         if (merge_collapse(&ms) < 0)
             goto fail;
         /* Advance to find next run. */
-        lo += n;
+        sortslice_advance(&lo, n);
         nremaining -= n;
     } while (nremaining);
-    assert(lo == hi);
 
     if (merge_force_collapse(&ms) < 0)
         goto fail;
     assert(ms.n == 1);
-    assert(ms.pending[0].base == saved_ob_item);
+    assert(keys == NULL
+           ? ms.pending[0].base.keys == saved_ob_item
+           : ms.pending[0].base.keys == &keys[0]);
     assert(ms.pending[0].len == saved_ob_size);
+    lo = ms.pending[0].base;
 
 succeed:
     result = Py_None;
 fail:
-    if (keyfunc != NULL) {
-        for (i=0 ; i < saved_ob_size ; i++) {
-            kvpair = saved_ob_item[i];
-            value = sortwrapper_getvalue(kvpair);
-            saved_ob_item[i] = value;
-            Py_DECREF(kvpair);
-        }
+    if (keys != NULL) {
+        for (i = 0; i < saved_ob_size; i++)
+            Py_DECREF(keys[i]);
+        if (saved_ob_size >= MERGESTATE_TEMP_SIZE/2)
+            PyMem_FREE(keys);
     }
 
     if (self->allocated != -1 && result != NULL) {
@@ -2190,7 +2695,7 @@ fail:
 
     merge_freemem(&ms);
 
-dsu_fail:
+keyfunc_fail:
     final_ob_item = self->ob_item;
     i = Py_SIZE(self);
     Py_SIZE(self) = saved_ob_size;
@@ -2439,9 +2944,10 @@ static int
 list_init(PyListObject *self, PyObject *args, PyObject *kw)
 {
     PyObject *arg = NULL;
-    static char *kwlist[] = {"sequence", 0};
+    static const char * const kwlist[] = {"sequence", 0};
+    static _PyArg_Parser _parser = {"|O:list", kwlist, 0};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kw, "|O:list", kwlist, &arg))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kw, &_parser, &arg))
         return -1;
 
     /* Verify list invariants established by PyType_GenericAlloc() */
@@ -2501,8 +3007,8 @@ PyDoc_STRVAR(count_doc,
 PyDoc_STRVAR(reverse_doc,
 "L.reverse() -- reverse *IN PLACE*");
 PyDoc_STRVAR(sort_doc,
-"L.sort(cmp=None, key=None, reverse=False) -- stable sort *IN PLACE*;\n\
-cmp(x, y) -> -1, 0, 1");
+"L.sort(cmp=None, key=None, reverse=False, parallel=False) -- stable sort\n\
+*IN PLACE*; cmp(x, y) -> -1, 0, 1");
 
 static PyObject *list_subscript(PyListObject*, PyObject*);
 
@@ -17,6 +17,20 @@
 #define KARATSUBA_CUTOFF 70
 #define KARATSUBA_SQUARE_CUTOFF (2 * KARATSUBA_CUTOFF)
 
+/* Above TOOM3_CUTOFF digits, Toom-3 takes over from Karatsuba.  Above
+ * NTT_CUTOFF digits, multiplication by number-theoretic transform takes over
+ * from both, up to products of NTT_MAX_LENGTH digits; Toom-3 then splits
+ * bigger ones.  The NTT needs exact 32- and 64-bit integer types.
+ */
+#define TOOM3_CUTOFF 5000
+#define TOOM3_SQUARE_CUTOFF TOOM3_CUTOFF
+#define NTT_CUTOFF 2000
+#define NTT_SQUARE_CUTOFF NTT_CUTOFF
+#if defined(HAVE_UINT32_T) && defined(HAVE_UINT64_T)
+#define USE_NTT_MUL
+#define NTT_MAX_LENGTH ((Py_ssize_t)1 << 25)
+#endif
+
 /* For exponentiation, use the binary left-to-right algorithm
  * unless the exponent contains more than FIVEARY_CUTOFF digits.
  * In that case, do 5 bits at a time.  The potential drawback is that
@@ -24,6 +38,23 @@
  */
 #define FIVEARY_CUTOFF 8
 
+/* For long division, use the O(N**2) school algorithm unless both the
+ * divisor and the quotient have more than BZ_DIV_CUTOFF digits.  In that
+ * case, use the recursive algorithm of Burnikel and Ziegler, which leaves
+ * the work to k_mul.
+ */
+#define BZ_DIV_CUTOFF (2 * KARATSUBA_CUTOFF)
+
+/* Converting a long with more than DC_TO_DECIMAL_CUTOFF digits to decimal,
+ * or a string of more than DC_FROM_STRING_CUTOFF characters in a base that
+ * isn't a power of 2 to a long, splits the number in halves recursively
+ * instead of taking quadratic time.  The halves are taken down to pieces
+ * of about DC_LEAF_CHARS characters.
+ */
+#define DC_TO_DECIMAL_CUTOFF 1000
+#define DC_FROM_STRING_CUTOFF 6000
+#define DC_LEAF_CHARS 1000
+
 #define ABS(x) ((x) < 0 ? -(x) : (x))
 
 #undef MIN
@@ -1311,6 +1342,9 @@ divrem1(PyLongObject *a, digit n, digit *prem)
     return long_normalize(z);
 }
 
+/* forward */
+static PyObject *long_to_decimal_dc(PyLongObject *, int);
+
 /* Convert a long integer to a base 10 string.  Returns a new non-shared
    string.  (Return value is non-shared so that callers can modify the
    returned value if necessary.) */
@@ -1332,6 +1366,8 @@ long_to_decimal_string(PyObject *aa, int addL)
     }
     size_a = ABS(Py_SIZE(a));
     negative = Py_SIZE(a) < 0;
+    if (size_a > DC_TO_DECIMAL_CUTOFF)
+        return long_to_decimal_dc(a, addL);
 
     /* quick and dirty upper bound for the number of digits
        required to express a in base _PyLong_DECIMAL_BASE:
@@ -1693,62 +1729,12 @@ long_from_binary_base(char **str, int base)
     return long_normalize(z);
 }
 
-PyObject *
-PyLong_FromString(char *str, char **pend, int base)
-{
-    int sign = 1;
-    char *start, *orig_str = str;
-    PyLongObject *z;
-    PyObject *strobj, *strrepr;
-    Py_ssize_t slen;
-
-    if ((base != 0 && base < 2) || base > 36) {
-        PyErr_SetString(PyExc_ValueError,
-                        "long() arg 2 must be >= 2 and <= 36");
-        return NULL;
-    }
-    while (*str != '\0' && isspace(Py_CHARMASK(*str)))
-        str++;
-    if (*str == '+')
-        ++str;
-    else if (*str == '-') {
-        ++str;
-        sign = -1;
-    }
-    while (*str != '\0' && isspace(Py_CHARMASK(*str)))
-        str++;
-    if (base == 0) {
-        /* No base given.  Deduce the base from the contents
-           of the string */
-        if (str[0] != '0')
-            base = 10;
-        else if (str[1] == 'x' || str[1] == 'X')
-            base = 16;
-        else if (str[1] == 'o' || str[1] == 'O')
-            base = 8;
-        else if (str[1] == 'b' || str[1] == 'B')
-            base = 2;
-        else
-            /* "old" (C-style) octal literal, still valid in
-               2.x, although illegal in 3.x */
-            base = 8;
-    }
-    /* Whether or not we were deducing the base, skip leading chars
-       as needed */
-    if (str[0] == '0' &&
-        ((base == 16 && (str[1] == 'x' || str[1] == 'X')) ||
-         (base == 8  && (str[1] == 'o' || str[1] == 'O')) ||
-         (base == 2  && (str[1] == 'b' || str[1] == 'B'))))
-        str += 2;
-
-    start = str;
-    if ((base & (base - 1)) == 0)
-        z = long_from_binary_base(&str, base);
-    else {
 /***
 Binary bases can be converted in time linear in the number of digits, because
 Python's representation base is binary.  Other bases (including decimal!) use
 the simple quadratic-time algorithm below, complicated by some speed tricks.
+Strings of more than DC_FROM_STRING_CUTOFF digits are first cut into pieces
+by long_from_string_dc(), so that it only sees the short ones.
 
 First some math:  the largest integer that can be expressed in N base-B digits
 is B**N-1.  Consequently, if we have an N-digit input in base B, the worst-
@@ -1832,116 +1818,185 @@ that triggers it(!).  Instead the code was tested by artificially allocating
 just 1 digit at the start, so that the copying code was exercised for every
 digit beyond the first.
 ***/
-        register twodigits c;           /* current input character */
-        Py_ssize_t size_z;
-        int i;
-        int convwidth;
-        twodigits convmultmax, convmult;
-        digit *pz, *pzstop;
-        char* scan;
-
-        static double log_base_PyLong_BASE[37] = {0.0e0,};
-        static int convwidth_base[37] = {0,};
-        static twodigits convmultmax_base[37] = {0,};
-
-        if (log_base_PyLong_BASE[base] == 0.0) {
-            twodigits convmax = base;
-            int i = 1;
-
-            log_base_PyLong_BASE[base] = (log((double)base) /
-                                          log((double)PyLong_BASE));
-            for (;;) {
-                twodigits next = convmax * base;
-                if (next > PyLong_BASE)
-                    break;
-                convmax = next;
-                ++i;
-            }
-            convmultmax_base[base] = convmax;
-            assert(i > 0);
-            convwidth_base[base] = i;
+
+/* Convert the digits from str up to scan, in a base that isn't a power of
+ * 2, the simple way.  Return a new reference.
+ */
+static PyLongObject *
+long_from_nonbinary_base(char *str, char *scan, int base)
+{
+    register twodigits c;           /* current input character */
+    PyLongObject *z;
+    Py_ssize_t size_z;
+    int i;
+    int convwidth;
+    twodigits convmultmax, convmult;
+    digit *pz, *pzstop;
+
+    static double log_base_PyLong_BASE[37] = {0.0e0,};
+    static int convwidth_base[37] = {0,};
+    static twodigits convmultmax_base[37] = {0,};
+
+    if (log_base_PyLong_BASE[base] == 0.0) {
+        twodigits convmax = base;
+        int i = 1;
+
+        log_base_PyLong_BASE[base] = (log((double)base) /
+                                      log((double)PyLong_BASE));
+        for (;;) {
+            twodigits next = convmax * base;
+            if (next > PyLong_BASE)
+                break;
+            convmax = next;
+            ++i;
         }
+        convmultmax_base[base] = convmax;
+        assert(i > 0);
+        convwidth_base[base] = i;
+    }
 
-        /* Find length of the string of numeric characters. */
-        scan = str;
-        while (_PyLong_DigitValue[Py_CHARMASK(*scan)] < base)
-            ++scan;
+    /* Create a long object that can contain the largest possible
+     * integer with this base and length.  Note that there's no
+     * need to initialize z->ob_digit -- no slot is read up before
+     * being stored into.
+     */
+    size_z = (Py_ssize_t)((scan - str) * log_base_PyLong_BASE[base]) + 1;
+    /* Uncomment next line to test exceedingly rare copy code */
+    /* size_z = 1; */
+    assert(size_z > 0);
+    z = _PyLong_New(size_z);
+    if (z == NULL)
+        return NULL;
+    Py_SIZE(z) = 0;
 
-        /* Create a long object that can contain the largest possible
-         * integer with this base and length.  Note that there's no
-         * need to initialize z->ob_digit -- no slot is read up before
-         * being stored into.
-         */
-        size_z = (Py_ssize_t)((scan - str) * log_base_PyLong_BASE[base]) + 1;
-        /* Uncomment next line to test exceedingly rare copy code */
-        /* size_z = 1; */
-        assert(size_z > 0);
-        z = _PyLong_New(size_z);
-        if (z == NULL)
-            return NULL;
-        Py_SIZE(z) = 0;
+    /* `convwidth` consecutive input digits are treated as a single
+     * digit in base `convmultmax`.
+     */
+    convwidth = convwidth_base[base];
+    convmultmax = convmultmax_base[base];
+
+    /* Work ;-) */
+    while (str < scan) {
+        /* grab up to convwidth digits from the input string */
+        c = (digit)_PyLong_DigitValue[Py_CHARMASK(*str++)];
+        for (i = 1; i < convwidth && str != scan; ++i, ++str) {
+            c = (twodigits)(c *  base +
+                            _PyLong_DigitValue[Py_CHARMASK(*str)]);
+            assert(c < PyLong_BASE);
+        }
 
-        /* `convwidth` consecutive input digits are treated as a single
-         * digit in base `convmultmax`.
+        convmult = convmultmax;
+        /* Calculate the shift only if we couldn't get
+         * convwidth digits.
          */
-        convwidth = convwidth_base[base];
-        convmultmax = convmultmax_base[base];
-
-        /* Work ;-) */
-        while (str < scan) {
-            /* grab up to convwidth digits from the input string */
-            c = (digit)_PyLong_DigitValue[Py_CHARMASK(*str++)];
-            for (i = 1; i < convwidth && str != scan; ++i, ++str) {
-                c = (twodigits)(c *  base +
-                                _PyLong_DigitValue[Py_CHARMASK(*str)]);
-                assert(c < PyLong_BASE);
-            }
-
-            convmult = convmultmax;
-            /* Calculate the shift only if we couldn't get
-             * convwidth digits.
-             */
-            if (i != convwidth) {
-                convmult = base;
-                for ( ; i > 1; --i)
-                    convmult *= base;
-            }
+        if (i != convwidth) {
+            convmult = base;
+            for ( ; i > 1; --i)
+                convmult *= base;
+        }
 
-            /* Multiply z by convmult, and add c. */
-            pz = z->ob_digit;
-            pzstop = pz + Py_SIZE(z);
-            for (; pz < pzstop; ++pz) {
-                c += (twodigits)*pz * convmult;
-                *pz = (digit)(c & PyLong_MASK);
-                c >>= PyLong_SHIFT;
+        /* Multiply z by convmult, and add c. */
+        pz = z->ob_digit;
+        pzstop = pz + Py_SIZE(z);
+        for (; pz < pzstop; ++pz) {
+            c += (twodigits)*pz * convmult;
+            *pz = (digit)(c & PyLong_MASK);
+            c >>= PyLong_SHIFT;
+        }
+        /* carry off the current end? */
+        if (c) {
+            assert(c < PyLong_BASE);
+            if (Py_SIZE(z) < size_z) {
+                *pz = (digit)c;
+                ++Py_SIZE(z);
             }
-            /* carry off the current end? */
-            if (c) {
-                assert(c < PyLong_BASE);
-                if (Py_SIZE(z) < size_z) {
-                    *pz = (digit)c;
-                    ++Py_SIZE(z);
-                }
-                else {
-                    PyLongObject *tmp;
-                    /* Extremely rare.  Get more space. */
-                    assert(Py_SIZE(z) == size_z);
-                    tmp = _PyLong_New(size_z + 1);
-                    if (tmp == NULL) {
-                        Py_DECREF(z);
-                        return NULL;
-                    }
-                    memcpy(tmp->ob_digit,
-                           z->ob_digit,
-                           sizeof(digit) * size_z);
+            else {
+                PyLongObject *tmp;
+                /* Extremely rare.  Get more space. */
+                assert(Py_SIZE(z) == size_z);
+                tmp = _PyLong_New(size_z + 1);
+                if (tmp == NULL) {
                     Py_DECREF(z);
-                    z = tmp;
-                    z->ob_digit[size_z] = (digit)c;
-                    ++size_z;
+                    return NULL;
                 }
+                memcpy(tmp->ob_digit,
+                       z->ob_digit,
+                       sizeof(digit) * size_z);
+                Py_DECREF(z);
+                z = tmp;
+                z->ob_digit[size_z] = (digit)c;
+                ++size_z;
             }
         }
     }
+    return z;
+}
+
+/* forward */
+static PyLongObject *long_from_string_dc(char *, char *, int);
+
+PyObject *
+PyLong_FromString(char *str, char **pend, int base)
+{
+    int sign = 1;
+    char *start, *orig_str = str;
+    PyLongObject *z;
+    PyObject *strobj, *strrepr;
+    Py_ssize_t slen;
+
+    if ((base != 0 && base < 2) || base > 36) {
+        PyErr_SetString(PyExc_ValueError,
+                        "long() arg 2 must be >= 2 and <= 36");
+        return NULL;
+    }
+    while (*str != '\0' && isspace(Py_CHARMASK(*str)))
+        str++;
+    if (*str == '+')
+        ++str;
+    else if (*str == '-') {
+        ++str;
+        sign = -1;
+    }
+    while (*str != '\0' && isspace(Py_CHARMASK(*str)))
+        str++;
+    if (base == 0) {
+        /* No base given.  Deduce the base from the contents
+           of the string */
+        if (str[0] != '0')
+            base = 10;
+        else if (str[1] == 'x' || str[1] == 'X')
+            base = 16;
+        else if (str[1] == 'o' || str[1] == 'O')
+            base = 8;
+        else if (str[1] == 'b' || str[1] == 'B')
+            base = 2;
+        else
+            /* "old" (C-style) octal literal, still valid in
+               2.x, although illegal in 3.x */
+            base = 8;
+    }
+    /* Whether or not we were deducing the base, skip leading chars
+       as needed */
+    if (str[0] == '0' &&
+        ((base == 16 && (str[1] == 'x' || str[1] == 'X')) ||
+         (base == 8  && (str[1] == 'o' || str[1] == 'O')) ||
+         (base == 2  && (str[1] == 'b' || str[1] == 'B'))))
+        str += 2;
+
+    start = str;
+    if ((base & (base - 1)) == 0)
+        z = long_from_binary_base(&str, base);
+    else {
+        /* Find length of the string of numeric characters. */
+        char *scan = str;
+        while (_PyLong_DigitValue[Py_CHARMASK(*scan)] < base)
+            ++scan;
+        if (scan - str > DC_FROM_STRING_CUTOFF)
+            z = long_from_string_dc(str, scan, base);
+        else
+            z = long_from_nonbinary_base(str, scan, base);
+        str = scan;
+    }
     if (z == NULL)
         return NULL;
     if (str == start)
@@ -1998,6 +2053,8 @@ PyLong_FromUnicode(Py_UNICODE *u, Py_ssize_t length, int base)
 /* forward */
 static PyLongObject *x_divrem
     (PyLongObject *, PyLongObject *, PyLongObject **);
+static PyLongObject *bz_divrem
+    (PyLongObject *, PyLongObject *, PyLongObject **);
 static PyObject *long_long(PyObject *v);
 
 /* Long division with remainder, top-level routine */
@@ -2036,6 +2093,11 @@ long_divrem(PyLongObject *a, PyLongObject *b,
             return -1;
         }
     }
+    else if (size_b > BZ_DIV_CUTOFF && size_a - size_b > BZ_DIV_CUTOFF) {
+        z = bz_divrem(a, b, prem);
+        if (z == NULL)
+            return -1;
+    }
     else {
         z = x_divrem(a, b, prem);
         if (z == NULL)
@@ -2671,11 +2733,62 @@ kmul_split(PyLongObject *n,
     return 0;
 }
 
+/* Return the number made of digits lo through hi-1 of |a|, where 0 <= lo.
+ * hi may exceed the size of a.
+ */
+static PyLongObject *
+long_slice_digits(PyLongObject *a, Py_ssize_t lo, Py_ssize_t hi)
+{
+    Py_ssize_t size_a = ABS(Py_SIZE(a));
+    PyLongObject *z;
+
+    if (hi > size_a)
+        hi = size_a;
+    if (hi <= lo)
+        return _PyLong_New(0);
+    z = _PyLong_New(hi - lo);
+    if (z == NULL)
+        return NULL;
+    memcpy(z->ob_digit, a->ob_digit + lo, (hi - lo) * sizeof(digit));
+    return long_normalize(z);
+}
+
+/* Return |hi| * PyLong_BASE**n + |lo|, where |lo| < PyLong_BASE**n.  lo may
+ * be NULL, meaning 0.
+ */
+static PyLongObject *
+long_join_digits(PyLongObject *hi, PyLongObject *lo, Py_ssize_t n)
+{
+    Py_ssize_t size_hi = ABS(Py_SIZE(hi));
+    Py_ssize_t size_lo = lo == NULL ? 0 : ABS(Py_SIZE(lo));
+    PyLongObject *z;
+
+    assert(size_lo <= n);
+    if (size_hi == 0) {
+        if (lo == NULL)
+            return _PyLong_New(0);
+        return long_slice_digits(lo, 0, size_lo);
+    }
+    z = _PyLong_New(n + size_hi);
+    if (z == NULL)
+        return NULL;
+    if (size_lo)
+        memcpy(z->ob_digit, lo->ob_digit, size_lo * sizeof(digit));
+    memset(z->ob_digit + size_lo, 0, (n - size_lo) * sizeof(digit));
+    memcpy(z->ob_digit + n, hi->ob_digit, size_hi * sizeof(digit));
+    return z;
+}
+
 static PyLongObject *k_lopsided_mul(PyLongObject *a, PyLongObject *b);
+static PyLongObject *toom3_mul(PyLongObject *a, PyLongObject *b);
+#ifdef USE_NTT_MUL
+static PyLongObject *ntt_mul(PyLongObject *a, PyLongObject *b);
+#endif
 
 /* Karatsuba multiplication.  Ignores the input signs, and returns the
  * absolute value of the product (or NULL if error).
  * See Knuth Vol. 2 Chapter 4.3.3 (Pp. 294-295).
+ * Bigger operands are passed on to toom3_mul or ntt_mul.
  */
 static PyLongObject *
 k_mul(PyLongObject *a, PyLongObject *b)
@@ -2721,6 +2834,13 @@ k_mul(PyLongObject *a, PyLongObject *b)
             return x_mul(a, b);
     }
 
+#ifdef USE_NTT_MUL
+    /* The NTT doesn't mind lopsided operands. */
+    i = a == b ? NTT_SQUARE_CUTOFF : NTT_CUTOFF;
+    if (asize > i && asize + bsize <= NTT_MAX_LENGTH)
+        return ntt_mul(a, b);
+#endif
+
     /* If a is small compared to b, splitting on b gives a degenerate
      * case with ah==0, and Karatsuba may be (even much) less efficient
      * than "grade school" then.  However, we can still win, by viewing
@@ -2730,6 +2850,10 @@ k_mul(PyLongObject *a, PyLongObject *b)
     if (2 * asize <= bsize)
         return k_lopsided_mul(a, b);
 
+    i = a == b ? TOOM3_SQUARE_CUTOFF : TOOM3_CUTOFF;
+    if (asize > i)
+        return toom3_mul(a, b);
+
     /* Split a & b into hi & lo pieces. */
     shift = bsize >> 1;
     if (kmul_split(a, shift, &ah, &al) < 0) goto fail;
@@ -2890,6 +3014,380 @@ clearly >= each of ah*bh and al*bl, there's always enough room to subtract
 ah*bh and al*bl too.
 */
 
+/* Return x divided by a small n that divides it exactly, with x's sign. */
+static PyLongObject *
+long_divexact1(PyLongObject *x, digit n)
+{
+    PyLongObject *z;
+    digit rem;
+
+    z = divrem1(x, n, &rem);
+    assert(z == NULL || rem == 0);
+    if (z != NULL && Py_SIZE(x) < 0)
+        Py_SIZE(z) = -Py_SIZE(z);
+    return z;
+}
+
+/* Split |x| into pieces x2*X**2 + x1*X + x0, with X = PyLong_BASE**k, and
+ * store the values of x2*t**2 + x1*t + x0 for t = 0, 1, -1, -2 and
+ * infinity in v[0:5].  Returns 0 on success, -1 on error; the caller
+ * releases what was stored in v either way.
+ */
+static int
+toom3_eval(PyLongObject *x, Py_ssize_t k, PyLongObject **v)
+{
+    PyLongObject *x1, *p, *t;
+
+    x1 = long_slice_digits(x, k, 2*k);
+    if (x1 == NULL)
+        return -1;
+    if ((v[0] = long_slice_digits(x, 0, k)) == NULL ||
+        (v[4] = long_slice_digits(x, 2*k, PY_SSIZE_T_MAX)) == NULL ||
+        (p = x_add(v[0], v[4])) == NULL) {
+        Py_DECREF(x1);
+        return -1;
+    }
+    v[1] = x_add(p, x1);
+    v[2] = x_sub(p, x1);
+    Py_DECREF(p);
+    Py_DECREF(x1);
+    if (v[1] == NULL || v[2] == NULL)
+        return -1;
+    /* v(-2) = 2*(v(-1) + x2) - x0 */
+    if ((t = (PyLongObject *)long_add(v[2], v[4])) == NULL)
+        return -1;
+    v[3] = (PyLongObject *)long_add(t, t);
+    Py_DECREF(t);
+    if (v[3] == NULL)
+        return -1;
+    t = v[3];
+    v[3] = (PyLongObject *)long_sub(t, v[0]);
+    Py_DECREF(t);
+    return v[3] == NULL ? -1 : 0;
+}
+
+/* Toom-3 multiplication.  Same interface as k_mul, which calls it for
+ * operands too big for Karatsuba to be the fastest, with asize > bsize/2.
+ * Both operands are split into 3 pieces, as polynomials in X, and the
+ * polynomials are evaluated at 0, 1, -1, -2 and infinity.  That makes 5
+ * products of numbers a third the size, from which the 5 coefficients of
+ * the product are interpolated back, following M. Bodrato and A. Zanoni,
+ * "Integer and Polynomial Multiplication: Towards Optimal Toom-Cook
+ * Matrices", ISSAC 2007.  Squares need only one set of values.
+ */
+static PyLongObject *
+toom3_mul(PyLongObject *a, PyLongObject *b)
+{
+    const Py_ssize_t asize = ABS(Py_SIZE(a)), bsize = ABS(Py_SIZE(b));
+    PyLongObject *va[5] = {NULL, NULL, NULL, NULL, NULL};
+    PyLongObject *vb[5] = {NULL, NULL, NULL, NULL, NULL};
+    PyLongObject *r[5] = {NULL, NULL, NULL, NULL, NULL};
+    PyLongObject *ret = NULL, *t, *u;
+    Py_ssize_t k, i;
+
+    k = (MAX(asize, bsize) + 2) / 3;
+    if (toom3_eval(a, k, va) < 0)
+        goto Done;
+    if (a == b) {
+        for (i = 0; i < 5; i++) {
+            vb[i] = va[i];
+            Py_INCREF(vb[i]);
+        }
+    }
+    else if (toom3_eval(b, k, vb) < 0)
+        goto Done;
+    for (i = 0; i < 5; i++) {
+        r[i] = k_mul(va[i], vb[i]);
+        if (r[i] == NULL)
+            goto Done;
+        if ((Py_SIZE(va[i]) < 0) != (Py_SIZE(vb[i]) < 0))
+            Py_SIZE(r[i]) = -Py_SIZE(r[i]);
+        Py_CLEAR(va[i]);
+        Py_CLEAR(vb[i]);
+    }
+
+    /* Interpolate, with r[0:5] the values of the product at 0, 1, -1, -2
+       and infinity:
+           r[3] = (r[3] - r[1]) / 3
+           r[1] = (r[1] - r[2]) / 2
+           r[2] = r[2] - r[0]
+           r[3] = (r[2] - r[3]) / 2 + 2*r[4]
+           r[2] = r[2] + r[1] - r[4]
+           r[1] = r[1] - r[3]
+       leaves r[i] the coefficient of X**i, which can't be negative. */
+    if ((t = (PyLongObject *)long_sub(r[3], r[1])) == NULL)
+        goto Done;
+    Py_DECREF(r[3]);
+    r[3] = long_divexact1(t, 3);
+    Py_DECREF(t);
+    if (r[3] == NULL || (t = (PyLongObject *)long_sub(r[1], r[2])) == NULL)
+        goto Done;
+    Py_DECREF(r[1]);
+    r[1] = long_divexact1(t, 2);
+    Py_DECREF(t);
+    if (r[1] == NULL || (t = (PyLongObject *)long_sub(r[2], r[0])) == NULL)
+        goto Done;
+    Py_DECREF(r[2]);
+    r[2] = t;
+    if ((t = (PyLongObject *)long_sub(r[2], r[3])) == NULL)
+        goto Done;
+    u = long_divexact1(t, 2);
+    Py_DECREF(t);
+    if (u == NULL)
+        goto Done;
+    Py_DECREF(r[3]);
+    r[3] = u;
+    for (i = 0; i < 2; i++) {
+        if ((t = (PyLongObject *)long_add(r[3], r[4])) == NULL)
+            goto Done;
+        Py_DECREF(r[3]);
+        r[3] = t;
+    }
+    if ((t = (PyLongObject *)long_add(r[2], r[1])) == NULL)
+        goto Done;
+    Py_DECREF(r[2]);
+    r[2] = t;
+    if ((t = (PyLongObject *)long_sub(r[2], r[4])) == NULL)
+        goto Done;
+    Py_DECREF(r[2]);
+    r[2] = t;
+    if ((t = (PyLongObject *)long_sub(r[1], r[3])) == NULL)
+        goto Done;
+    Py_DECREF(r[1]);
+    r[1] = t;
+
+    ret = _PyLong_New(asize + bsize);
+    if (ret == NULL)
+        goto Done;
+    memset(ret->ob_digit, 0, Py_SIZE(ret) * sizeof(digit));
+    for (i = 0; i < 5; i++) {
+        assert(Py_SIZE(r[i]) >= 0);
+        if (Py_SIZE(r[i]) > 0)
+            (void)v_iadd(ret->ob_digit + i*k, asize + bsize - i*k,
+                         r[i]->ob_digit, Py_SIZE(r[i]));
+    }
+    ret = long_normalize(ret);
+
+  Done:
+    for (i = 0; i < 5; i++) {
+        Py_XDECREF(va[i]);
+        Py_XDECREF(vb[i]);
+        Py_XDECREF(r[i]);
+    }
+    return ret;
+}
+
+#ifdef USE_NTT_MUL
+
+/* Multiplication by number-theoretic transform.  The digits of each
+ * operand are taken as the coefficients of a polynomial, and the
+ * polynomials are multiplied by a fast Fourier transform modulo three
+ * primes p < 2**31 with p - 1 divisible by a big power of 2, so that
+ * products mod p fit in 64 bits.  The Chinese remainder theorem recovers
+ * the coefficients of the product, which are less than the product of the
+ * primes (about 2**87) as long as the transforms have at most
+ * NTT_MAX_LENGTH points.  Adding them with carries gives the digits of
+ * the product.
+ */
+
+static const PY_UINT32_T ntt_primes[3] = {
+    2013265921U,                /* 15 * 2**27 + 1 */
+    469762049U,                 /* 7 * 2**26 + 1 */
+    167772161U,                 /* 5 * 2**25 + 1 */
+};
+/* and a primitive root modulo each */
+static const PY_UINT32_T ntt_generators[3] = {31, 3, 3};
+
+static PY_UINT32_T
+ntt_pow(PY_UINT32_T x, PY_UINT32_T e, PY_UINT32_T p)
+{
+    PY_UINT64_T r = 1, b = x;
+
+    for (; e; e >>= 1) {
+        if (e & 1)
+            r = r * b % p;
+        b = b * b % p;
+    }
+    return (PY_UINT32_T)r;
+}
+
+/* Fill w[h:2*h], for each power of 2 h < n, with the powers of a primitive
+ * (2*h)-th root of unity modulo ntt_primes[k], or of its inverse; and
+ * ws[i] with floor(w[i] * 2**32 / p), for ntt_mulw.
+ */
+static void
+ntt_roots(PY_UINT32_T *w, PY_UINT32_T *ws, Py_ssize_t n, int k, int inverse)
+{
+    const PY_UINT32_T p = ntt_primes[k];
+    PY_UINT32_T root;
+    Py_ssize_t h, j;
+
+    root = ntt_pow(ntt_generators[k], (PY_UINT32_T)((p - 1) / n), p);
+    if (inverse)
+        root = ntt_pow(root, p - 2, p);
+    h = n >> 1;
+    w[h] = 1;
+    for (j = 1; j < h; j++)
+        w[h + j] = (PY_UINT32_T)((PY_UINT64_T)w[h + j - 1] * root % p);
+    for (h >>= 1; h > 0; h >>= 1)
+        for (j = 0; j < h; j++)
+            w[h + j] = w[2*h + 2*j];
+    for (j = 1; j < n; j++)
+        ws[j] = (PY_UINT32_T)(((PY_UINT64_T)w[j] << 32) / p);
+}
+
+/* Return x * w mod p, for x < 2**32, with ws from ntt_roots.  This is
+ * V. Shoup's method, which replaces the division by a multiplication.
+ */
+Py_LOCAL_INLINE(PY_UINT32_T)
+ntt_mulw(PY_UINT32_T x, PY_UINT32_T w, PY_UINT32_T ws, PY_UINT32_T p)
+{
+    PY_UINT32_T q = (PY_UINT32_T)(((PY_UINT64_T)x * ws) >> 32);
+    PY_UINT32_T r = x * w - q * p;
+
+    return r >= p ? r - p : r;
+}
+
+/* Transform x[0:n] in place, for n a power of 2, with the roots of unity
+ * from ntt_roots.  The forward transform (decimation in frequency) leaves
+ * its output in bit-reversed order, and the inverse one (decimation in
+ * time) takes its input in that order, so neither needs to reorder
+ * anything.  The inverse isn't scaled by 1/n.
+ */
+static void
+ntt_forward(PY_UINT32_T *x, Py_ssize_t n, const PY_UINT32_T *w,
+            const PY_UINT32_T *ws, PY_UINT32_T p)
+{
+    Py_ssize_t half, i, j;
+
+    for (half = n >> 1; half > 0; half >>= 1) {
+        const PY_UINT32_T *wh = w + half, *wsh = ws + half;
+        for (i = 0; i < n; i += 2*half) {
+            PY_UINT32_T *x0 = x + i, *x1 = x + i + half;
+            for (j = 0; j < half; j++) {
+                PY_UINT32_T u = x0[j], v = x1[j];
+                x0[j] = u + v >= p ? u + v - p : u + v;
+                x1[j] = ntt_mulw(u + p - v, wh[j], wsh[j], p);
+            }
+        }
+    }
+}
+
+static void
+ntt_inverse(PY_UINT32_T *x, Py_ssize_t n, const PY_UINT32_T *w,
+            const PY_UINT32_T *ws, PY_UINT32_T p)
+{
+    Py_ssize_t half, i, j;
+
+    for (half = 1; half < n; half <<= 1) {
+        const PY_UINT32_T *wh = w + half, *wsh = ws + half;
+        for (i = 0; i < n; i += 2*half) {
+            PY_UINT32_T *x0 = x + i, *x1 = x + i + half;
+            for (j = 0; j < half; j++) {
+                PY_UINT32_T u = x0[j];
+                PY_UINT32_T v = ntt_mulw(x1[j], wh[j], wsh[j], p);
+                x0[j] = u + v >= p ? u + v - p : u + v;
+                x1[j] = u >= v ? u - v : u + p - v;
+            }
+        }
+    }
+}
+
+/* Load the digits of a, reduced mod p, into x[0:n], padded with zeros. */
+static void
+ntt_load(PY_UINT32_T *x, Py_ssize_t n, PyLongObject *a, PY_UINT32_T p)
+{
+    Py_ssize_t size_a = ABS(Py_SIZE(a)), i;
+
+    for (i = 0; i < size_a; i++)
+        x[i] = a->ob_digit[i] % p;
+    memset(x + size_a, 0, (n - size_a) * sizeof(PY_UINT32_T));
+}
+
+/* NTT multiplication.  Same interface as k_mul, which calls it when the
+ * product has at most NTT_MAX_LENGTH digits.
+ */
+static PyLongObject *
+ntt_mul(PyLongObject *a, PyLongObject *b)
+{
+    const Py_ssize_t asize = ABS(Py_SIZE(a)), bsize = ABS(Py_SIZE(b));
+    const PY_UINT32_T p0 = ntt_primes[0], p1 = ntt_primes[1];
+    const PY_UINT32_T p2 = ntt_primes[2];
+    PY_UINT32_T *buf, *res[3], *fb, *w, *ws, inv, p0inv, p01inv;
+    PY_UINT64_T p01, p01lo, p01hi, carry;
+    PyLongObject *ret;
+    Py_ssize_t n, i;
+    int k;
+
+    n = 1;
+    while (n < asize + bsize)
+        n <<= 1;
+    assert(n <= NTT_MAX_LENGTH);
+    ret = _PyLong_New(asize + bsize);
+    if (ret == NULL)
+        return NULL;
+    /* res[0:3] get the coefficients of the product mod each prime, fb
+       holds the transform of b, and w and ws the roots of unity. */
+    buf = PyMem_New(PY_UINT32_T, 6*n);
+    if (buf == NULL) {
+        Py_DECREF(ret);
+        return (PyLongObject *)PyErr_NoMemory();
+    }
+    fb = buf + 3*n;
+    w = buf + 4*n;
+    ws = buf + 5*n;
+    for (k = 0; k < 3; k++) {
+        const PY_UINT32_T p = ntt_primes[k];
+        PY_UINT32_T *fa = res[k] = buf + k*n;
+
+        ntt_roots(w, ws, n, k, 0);
+        ntt_load(fa, n, a, p);
+        ntt_forward(fa, n, w, ws, p);
+        if (a != b) {
+            ntt_load(fb, n, b, p);
+            ntt_forward(fb, n, w, ws, p);
+        }
+        else
+            fb = fa;
+        inv = ntt_pow((PY_UINT32_T)n, p - 2, p);
+        for (i = 0; i < n; i++)
+            fa[i] = (PY_UINT32_T)((PY_UINT64_T)fa[i] * fb[i] % p *
+                                  inv % p);
+        fb = buf + 3*n;
+        ntt_roots(w, ws, n, k, 1);
+        ntt_inverse(fa, n, w, ws, p);
+    }
+
+    /* Garner's algorithm:  with r0, r1, r2 the residues of a coefficient
+       c mod p0, p1, p2, c = r0 + p0*t1 + p0*p1*t2 where
+           t1 = (r1 - r0) / p0 mod p1,
+           t2 = (r2 - r0 - p0*t1) / (p0*p1) mod p2.
+       To add c in with the carry, split p0*p1 = p01hi*PyLong_BASE + p01lo:
+       then the partial sums stay below 2**61. */
+    p0inv = ntt_pow(p0 % p1, p1 - 2, p1);
+    p01 = (PY_UINT64_T)p0 * p1;
+    p01inv = ntt_pow((PY_UINT32_T)(p01 % p2), p2 - 2, p2);
+    p01lo = p01 & PyLong_MASK;
+    p01hi = p01 >> PyLong_SHIFT;
+    carry = 0;
+    for (i = 0; i < asize + bsize; i++) {
+        PY_UINT64_T r0 = res[0][i], t1, t2, c01;
+
+        t1 = (PY_UINT64_T)(res[1][i] + p1 - (PY_UINT32_T)(r0 % p1)) *
+            p0inv % p1;
+        c01 = r0 + p0 * t1;
+        t2 = (res[2][i] + p2 - c01 % p2) * p01inv % p2;
+        carry += c01 + p01lo * t2;
+        ret->ob_digit[i] = (digit)(carry & PyLong_MASK);
+        carry = (carry >> PyLong_SHIFT) + p01hi * t2;
+    }
+    assert(carry == 0);
+    PyMem_Free(buf);
+    return long_normalize(ret);
+}
+
+#endif /* USE_NTT_MUL */
+
 /* b has at least twice the digits of a, and a is big enough that Karatsuba
  * would pay off *if* the inputs had balanced sizes.  View b as a sequence
  * of slices, each with a->ob_size digits, and multiply the slices by a,
@@ -2971,6 +3469,482 @@ long_mul(PyLongObject *v, PyLongObject *w)
     return (PyObject *)z;
 }
 
+/* Divide-and-conquer division and base conversion.
+ *
+ * x_divrem takes time proportional to the product of the sizes of the
+ * divisor and the quotient, and converting between binary and decimal one
+ * digit at a time is quadratic too.  For big enough numbers, the functions
+ * below split the work in halves instead, so that it all gets done by
+ * k_mul.  Division follows Burnikel and Ziegler, "Fast Recursive Division",
+ * MPI-I-98-1-022, 1998.
+ */
+
+static int bz_div3n2n(PyLongObject *, PyLongObject *, PyLongObject *,
+                      PyLongObject *, PyLongObject *, Py_ssize_t,
+                      PyLongObject **, PyLongObject **);
+
+/* Divide a by b, where b has n digits with the top bit of the top one set,
+ * and a < b * PyLong_BASE**n.  Both are non-negative.  The quotient (less
+ * than PyLong_BASE**n) and the remainder go to *pq and *pr.  Returns 0 on
+ * success, -1 on error.
+ */
+static int
+bz_div2n1n(PyLongObject *a, PyLongObject *b, Py_ssize_t n,
+           PyLongObject **pq, PyLongObject **pr)
+{
+    PyLongObject *b1 = NULL, *b2 = NULL, *a12 = NULL, *a3 = NULL, *a4 = NULL;
+    PyLongObject *q1 = NULL, *q2 = NULL, *r = NULL, *t;
+    Py_ssize_t half;
+    int pad = 0;
+
+    assert(Py_SIZE(a) >= 0 && Py_SIZE(b) == n);
+    if (n <= BZ_DIV_CUTOFF || Py_SIZE(a) - n <= BZ_DIV_CUTOFF)
+        return long_divrem(a, b, pq, pr);
+
+    Py_INCREF(a);
+    Py_INCREF(b);
+    if (n & 1) {
+        /* Scale both by PyLong_BASE so that n splits evenly. */
+        t = long_join_digits(a, NULL, 1);
+        Py_DECREF(a);
+        a = t;
+        t = long_join_digits(b, NULL, 1);
+        Py_DECREF(b);
+        b = t;
+        if (a == NULL || b == NULL)
+            goto Error;
+        pad = 1;
+        ++n;
+    }
+    half = n >> 1;
+    b1 = long_slice_digits(b, half, n);
+    b2 = long_slice_digits(b, 0, half);
+    a12 = long_slice_digits(a, n, PY_SSIZE_T_MAX);
+    a3 = long_slice_digits(a, half, n);
+    a4 = long_slice_digits(a, 0, half);
+    if (b1 == NULL || b2 == NULL || a12 == NULL || a3 == NULL || a4 == NULL)
+        goto Error;
+    if (bz_div3n2n(a12, a3, b, b1, b2, half, &q1, &r) < 0)
+        goto Error;
+    Py_CLEAR(a12);
+    if (bz_div3n2n(r, a4, b, b1, b2, half, &q2, &a12) < 0)
+        goto Error;
+    Py_CLEAR(r);
+    *pq = long_join_digits(q1, q2, half);
+    if (*pq == NULL)
+        goto Error;
+    if (pad) {
+        /* Both were scaled by PyLong_BASE, so the remainder was too. */
+        r = long_slice_digits(a12, 1, PY_SSIZE_T_MAX);
+        if (r == NULL) {
+            Py_DECREF(*pq);
+            goto Error;
+        }
+        Py_DECREF(a12);
+        a12 = r;
+        r = NULL;
+    }
+    *pr = a12;
+    a12 = NULL;
+    Py_DECREF(a);
+    Py_DECREF(b);
+    Py_DECREF(b1);
+    Py_DECREF(b2);
+    Py_DECREF(a3);
+    Py_DECREF(a4);
+    Py_DECREF(q1);
+    Py_DECREF(q2);
+    return 0;
+
+  Error:
+    Py_XDECREF(a);
+    Py_XDECREF(b);
+    Py_XDECREF(b1);
+    Py_XDECREF(b2);
+    Py_XDECREF(a12);
+    Py_XDECREF(a3);
+    Py_XDECREF(a4);
+    Py_XDECREF(q1);
+    Py_XDECREF(q2);
+    Py_XDECREF(r);
+    return -1;
+}
+
+/* Divide a12 * PyLong_BASE**n + a3 by b == b1 * PyLong_BASE**n + b2, where
+ * b has 2*n digits with the top bit set and the quotient is less than
+ * PyLong_BASE**n.  Helper for bz_div2n1n; same conventions.
+ */
+static int
+bz_div3n2n(PyLongObject *a12, PyLongObject *a3, PyLongObject *b,
+           PyLongObject *b1, PyLongObject *b2, Py_ssize_t n,
+           PyLongObject **pq, PyLongObject **pr)
+{
+    PyLongObject *q = NULL, *r = NULL, *t = NULL, *d = NULL, *one = NULL;
+    PyLongObject *tmp;
+    Py_ssize_t i;
+
+    t = long_slice_digits(a12, n, PY_SSIZE_T_MAX);
+    if (t == NULL)
+        return -1;
+    if (long_compare(t, b1) == 0) {
+        /* The quotient estimate a12 // b1 would be PyLong_BASE**n or
+           more; use PyLong_BASE**n - 1, which leaves a12 - q * b1 ==
+           a12 - b1 * PyLong_BASE**n + b1 as the remainder. */
+        Py_CLEAR(t);
+        q = _PyLong_New(n);
+        if (q == NULL)
+            goto Error;
+        for (i = 0; i < n; i++)
+            q->ob_digit[i] = PyLong_MASK;
+        t = long_join_digits(b1, NULL, n);
+        if (t == NULL)
+            goto Error;
+        d = x_sub(a12, t);
+        if (d == NULL)
+            goto Error;
+        r = x_add(d, b1);
+        if (r == NULL)
+            goto Error;
+        Py_CLEAR(d);
+    }
+    else if (bz_div2n1n(a12, b1, n, &q, &r) < 0)
+        goto Error;
+    Py_CLEAR(t);
+
+    /* The estimate q is at most 2 too large: correct it by comparing
+       r * PyLong_BASE**n + a3 with q * b2. */
+    t = long_join_digits(r, a3, n);
+    if (t == NULL)
+        goto Error;
+    Py_CLEAR(r);
+    d = k_mul(q, b2);
+    if (d == NULL)
+        goto Error;
+    if (long_compare(t, d) >= 0) {
+        r = x_sub(t, d);
+        if (r == NULL)
+            goto Error;
+    }
+    else {
+        /* d - t is the deficit, to be made up by adding b to r. */
+        one = (PyLongObject *)PyLong_FromLong(1L);
+        tmp = x_sub(d, t);
+        if (one == NULL || tmp == NULL) {
+            Py_XDECREF(tmp);
+            goto Error;
+        }
+        Py_DECREF(d);
+        d = tmp;
+        for (;;) {
+            tmp = x_sub(q, one);
+            if (tmp == NULL)
+                goto Error;
+            Py_DECREF(q);
+            q = tmp;
+            if (long_compare(d, b) <= 0)
+                break;
+            tmp = x_sub(d, b);
+            if (tmp == NULL)
+                goto Error;
+            Py_DECREF(d);
+            d = tmp;
+        }
+        r = x_sub(b, d);
+        if (r == NULL)
+            goto Error;
+        Py_DECREF(one);
+    }
+    Py_DECREF(t);
+    Py_DECREF(d);
+    *pq = q;
+    *pr = r;
+    return 0;
+
+  Error:
+    Py_XDECREF(q);
+    Py_XDECREF(r);
+    Py_XDECREF(t);
+    Py_XDECREF(d);
+    Py_XDECREF(one);
+    return -1;
+}
+
+/* Unsigned long division with remainder by the Burnikel-Ziegler algorithm.
+ * Same interface as x_divrem; long_divrem only calls it when the divisor
+ * and the quotient both have more than BZ_DIV_CUTOFF digits.
+ */
+static PyLongObject *
+bz_divrem(PyLongObject *a, PyLongObject *b, PyLongObject **prem)
+{
+    Py_ssize_t size_a = ABS(Py_SIZE(a)), n = ABS(Py_SIZE(b));
+    Py_ssize_t i, size_q, size_r;
+    PyLongObject *an, *bn, *q, *r, *x, *chunk, *qi;
+    int d;
+
+    /* Normalize, as x_divrem does, so that the top bit of the divisor is
+       set.  The quotient stays the same and the remainder is scaled. */
+    d = PyLong_SHIFT - bits_in_digit(b->ob_digit[n-1]);
+    bn = _PyLong_New(n);
+    an = _PyLong_New(size_a + 1);
+    if (bn == NULL || an == NULL) {
+        Py_XDECREF(bn);
+        Py_XDECREF(an);
+        return NULL;
+    }
+    (void)v_lshift(bn->ob_digit, b->ob_digit, n, d);
+    an->ob_digit[size_a] = v_lshift(an->ob_digit, a->ob_digit, size_a, d);
+    an = long_normalize(an);
+
+    /* Divide chunks of n digits, from the top, carrying the remainder. */
+    size_q = (Py_SIZE(an) + n - 1) / n * n;
+    q = _PyLong_New(size_q);
+    r = _PyLong_New(0);
+    if (q == NULL || r == NULL)
+        goto Error;
+    for (i = size_q - n; i >= 0; i -= n) {
+        chunk = long_slice_digits(an, i, i + n);
+        if (chunk == NULL)
+            goto Error;
+        x = long_join_digits(r, chunk, n);
+        Py_DECREF(chunk);
+        if (x == NULL)
+            goto Error;
+        Py_CLEAR(r);
+        if (bz_div2n1n(x, bn, n, &qi, &r) < 0) {
+            Py_DECREF(x);
+            goto Error;
+        }
+        Py_DECREF(x);
+        size_r = Py_SIZE(qi);
+        memcpy(q->ob_digit + i, qi->ob_digit, size_r * sizeof(digit));
+        memset(q->ob_digit + i + size_r, 0, (n - size_r) * sizeof(digit));
+        Py_DECREF(qi);
+    }
+    Py_DECREF(an);
+    Py_DECREF(bn);
+
+    /* Unnormalize the remainder. */
+    size_r = Py_SIZE(r);
+    *prem = _PyLong_New(size_r);
+    if (*prem == NULL) {
+        Py_DECREF(q);
+        Py_DECREF(r);
+        return NULL;
+    }
+    (void)v_rshift((*prem)->ob_digit, r->ob_digit, size_r, d);
+    *prem = long_normalize(*prem);
+    Py_DECREF(r);
+    return long_normalize(q);
+
+  Error:
+    Py_DECREF(an);
+    Py_DECREF(bn);
+    Py_XDECREF(q);
+    Py_XDECREF(r);
+    return NULL;
+}
+
+/* Return base**e, for a small base > 0 and e >= 0. */
+static PyLongObject *
+long_small_pow(long base, Py_ssize_t e)
+{
+    PyLongObject *z, *b, *t;
+
+    z = (PyLongObject *)PyLong_FromLong(1L);
+    b = (PyLongObject *)PyLong_FromLong(base);
+    while (z != NULL && b != NULL && e > 0) {
+        if (e & 1) {
+            t = k_mul(z, b);
+            Py_DECREF(z);
+            z = t;
+        }
+        if ((e >>= 1) > 0) {
+            t = k_mul(b, b);
+            Py_DECREF(b);
+            b = t;
+        }
+    }
+    if (b == NULL) {
+        Py_XDECREF(z);
+        return NULL;
+    }
+    Py_DECREF(b);
+    return z;
+}
+
+/* Write 0 <= x < 10**(leaf << k) as exactly leaf << k decimal digits at p,
+ * with leading zeros.  pow10[j] == 10**(leaf << j) for j < k.
+ */
+static int
+dc_decimal_fill(PyLongObject *x, PyLongObject **pow10, int k,
+                Py_ssize_t leaf, char *p)
+{
+    Py_ssize_t width = leaf << k;
+    PyLongObject *hi, *lo;
+    int status;
+
+    if (Py_SIZE(x) == 0) {
+        memset(p, '0', width);
+        return 0;
+    }
+    if (k == 0) {
+        /* Peel off _PyLong_DECIMAL_SHIFT digits at a time. */
+        Py_ssize_t size = Py_SIZE(x);
+        PyLongObject *scratch = _PyLong_New(size);
+        digit *pin = x->ob_digit, rem;
+        int j;
+
+        if (scratch == NULL)
+            return -1;
+        p += width;
+        while (width > 0) {
+            rem = 0;
+            if (size > 0) {
+                rem = inplace_divrem1(scratch->ob_digit, pin, size,
+                                      _PyLong_DECIMAL_BASE);
+                pin = scratch->ob_digit;
+                while (size > 0 && pin[size-1] == 0)
+                    --size;
+            }
+            for (j = 0; j < _PyLong_DECIMAL_SHIFT && width > 0; j++) {
+                *--p = '0' + rem % 10;
+                rem /= 10;
+                --width;
+            }
+        }
+        assert(size == 0);
+        Py_DECREF(scratch);
+        return 0;
+    }
+    if (long_divrem(x, pow10[k-1], &hi, &lo) < 0)
+        return -1;
+    status = dc_decimal_fill(hi, pow10, k-1, leaf, p);
+    if (status == 0)
+        status = dc_decimal_fill(lo, pow10, k-1, leaf, p + (width >> 1));
+    Py_DECREF(hi);
+    Py_DECREF(lo);
+    return status;
+}
+
+/* long_to_decimal_string for longs with more than DC_TO_DECIMAL_CUTOFF
+ * digits:  split the number in halves by dividing by 10**(leaf << k), and
+ * recurse.
+ */
+static PyObject *
+long_to_decimal_dc(PyLongObject *a, int addL)
+{
+    PyLongObject *pow10[8 * SIZEOF_SIZE_T], *x;
+    Py_ssize_t leaf, width, start, strlen, i;
+    PyObject *str = NULL;
+    char *buf, *p;
+    int k = 0, negative = Py_SIZE(a) < 0;
+
+    x = (PyLongObject *)_PyLong_Copy(a);
+    if (x == NULL)
+        return NULL;
+    Py_SIZE(x) = ABS(Py_SIZE(x));
+
+    /* pow10[0] = 10**leaf, with leaf a multiple of _PyLong_DECIMAL_SHIFT */
+    leaf = DC_LEAF_CHARS / _PyLong_DECIMAL_SHIFT * _PyLong_DECIMAL_SHIFT;
+    pow10[0] = long_small_pow(10L, leaf);
+    if (pow10[0] == NULL)
+        goto Done;
+    while (long_compare(x, pow10[k]) >= 0) {
+        pow10[k+1] = k_mul(pow10[k], pow10[k]);
+        if (pow10[++k] == NULL)
+            goto Done;
+    }
+
+    width = leaf << k;
+    buf = PyMem_MALLOC(width);
+    if (buf == NULL) {
+        PyErr_NoMemory();
+        goto Done;
+    }
+    if (dc_decimal_fill(x, pow10, k, leaf, buf) == 0) {
+        for (start = 0; start < width - 1 && buf[start] == '0'; start++)
+            ;
+        strlen = (addL != 0) + negative + width - start;
+        str = PyString_FromStringAndSize(NULL, strlen);
+        if (str != NULL) {
+            p = PyString_AS_STRING(str);
+            if (negative)
+                *p++ = '-';
+            memcpy(p, buf + start, width - start);
+            if (addL)
+                p[width - start] = 'L';
+        }
+    }
+    PyMem_FREE(buf);
+
+  Done:
+    Py_DECREF(x);
+    for (i = 0; i <= k; i++)
+        Py_XDECREF(pow10[i]);
+    return str;
+}
+
+/* Convert the n base `base` digits at s, with n <= leaf << k, to a long.
+ * powb[j] == base**(leaf << j) for j < k.
+ */
+static PyLongObject *
+dc_from_string(char *s, Py_ssize_t n, int base, PyLongObject **powb,
+               int k, Py_ssize_t leaf)
+{
+    PyLongObject *hi, *lo, *z;
+    Py_ssize_t half;
+
+    while (k > 0 && n <= leaf << (k-1))
+        --k;
+    if (k == 0)
+        return long_from_nonbinary_base(s, s + n, base);
+    half = leaf << (k-1);
+    hi = dc_from_string(s, n - half, base, powb, k-1, leaf);
+    if (hi == NULL)
+        return NULL;
+    lo = dc_from_string(s + n - half, half, base, powb, k-1, leaf);
+    if (lo == NULL) {
+        Py_DECREF(hi);
+        return NULL;
+    }
+    z = k_mul(hi, powb[k-1]);
+    Py_DECREF(hi);
+    if (z != NULL) {
+        hi = z;
+        z = x_add(hi, lo);
+        Py_DECREF(hi);
+    }
+    Py_DECREF(lo);
+    return z;
+}
+
+/* Convert a string of more than DC_FROM_STRING_CUTOFF digits in a base that
+ * isn't a power of 2:  the top half times a power of the base, plus the
+ * bottom half, recursively.
+ */
+static PyLongObject *
+long_from_string_dc(char *str, char *scan, int base)
+{
+    PyLongObject *powb[8 * SIZEOF_SIZE_T], *z = NULL;
+    Py_ssize_t n = scan - str, leaf = DC_LEAF_CHARS;
+    int i, k = 0;
+
+    powb[0] = long_small_pow((long)base, leaf);
+    if (powb[0] == NULL)
+        return NULL;
+    while (leaf << (k+1) < n) {
+        powb[k+1] = k_mul(powb[k], powb[k]);
+        if (powb[++k] == NULL)
+            goto Done;
+    }
+    z = dc_from_string(str, n, base, powb, k+1, leaf);
+
+  Done:
+    for (i = 0; i <= k; i++)
+        Py_XDECREF(powb[i]);
+    return z;
+}
+
 /* The / and % operators are now defined in terms of divmod().
    The expression a mod b has the value a - b*floor(a/b).
    The long_divrem function gives the remainder after division of
@@ -3980,12 +4954,13 @@ long_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
     PyObject *x = NULL;
     int base = -909;                         /* unlikely! */
-    static char *kwlist[] = {"x", "base", 0};
+    static const char * const kwlist[] = {"x", "base", 0};
+    static _PyArg_Parser _parser = {"|Oi:long", kwlist, 0};
 
     if (type != &PyLong_Type)
         return long_subtype_new(type, args, kwds); /* Wimp out */
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Oi:long", kwlist,
-                                     &x, &base))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &x, &base))
         return NULL;
     if (x == NULL)
         return PyLong_FromLong(0L);
@@ -4011,10 +4986,13 @@ long_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
         return PyLong_FromString(PyString_AS_STRING(x), NULL, base);
     }
 #ifdef Py_USING_UNICODE
-    else if (PyUnicode_Check(x))
+    else if (PyUnicode_Check(x)) {
+        if (PyUnicode_AS_UNICODE(x) == NULL)
+            return NULL;
         return PyLong_FromUnicode(PyUnicode_AS_UNICODE(x),
                                   PyUnicode_GET_SIZE(x),
                                   base);
+    }
 #endif
     else {
         PyErr_SetString(PyExc_TypeError,
@@ -116,6 +116,23 @@ PyCFunction_Call(PyObject *func, PyObject *arg, PyObject *kw)
             return (*meth)(self, arg);
         }
         break;
+    case METH_FASTCALL:
+    {
+        PyObject **stack, *kwnames, *result;
+
+        size = PyTuple_GET_SIZE(arg);
+        if (kw == NULL || PyDict_Size(kw) == 0)
+            return (*(_PyCFunctionFast)meth)(self, &PyTuple_GET_ITEM(arg, 0),
+                                             size, NULL);
+        stack = _PyStack_UnpackDict(&PyTuple_GET_ITEM(arg, 0), size, kw,
+                                    &kwnames);
+        if (stack == NULL)
+            return NULL;
+        result = (*(_PyCFunctionFast)meth)(self, stack, size, kwnames);
+        PyMem_FREE(stack);
+        Py_XDECREF(kwnames);
+        return result;
+    }
     default:
         PyErr_BadInternalCall();
         return NULL;
@@ -125,6 +142,100 @@ PyCFunction_Call(PyObject *func, PyObject *arg, PyObject *kw)
     return NULL;
 }
 
+/* The same as PyCFunction_Call(), for arguments passed as an array.
+   METH_NOARGS, METH_O and METH_FASTCALL functions are called without
+   building a tuple. */
+PyObject *
+_PyMethodDef_FastCall(PyMethodDef *ml, PyObject *self, PyObject **args,
+                      Py_ssize_t nargs, PyObject *kwnames)
+{
+    PyCFunction meth = ml->ml_meth;
+    PyObject *callargs, *kwdict, *result;
+
+    if (kwnames != NULL && PyTuple_GET_SIZE(kwnames) == 0)
+        kwnames = NULL;
+
+    switch (ml->ml_flags & ~(METH_CLASS | METH_STATIC | METH_COEXIST)) {
+    case METH_FASTCALL:
+        return (*(_PyCFunctionFast)meth)(self, args, nargs, kwnames);
+    case METH_NOARGS:
+        if (kwnames == NULL) {
+            if (nargs == 0)
+                return (*meth)(self, NULL);
+            PyErr_Format(PyExc_TypeError,
+                "%.200s() takes no arguments (%zd given)",
+                ml->ml_name, nargs);
+            return NULL;
+        }
+        break;
+    case METH_O:
+        if (kwnames == NULL) {
+            if (nargs == 1)
+                return (*meth)(self, args[0]);
+            PyErr_Format(PyExc_TypeError,
+                "%.200s() takes exactly one argument (%zd given)",
+                ml->ml_name, nargs);
+            return NULL;
+        }
+        break;
+    case METH_OLDARGS:
+        if (kwnames == NULL) {
+            if (nargs == 1)
+                return (*meth)(self, args[0]);
+            if (nargs == 0)
+                return (*meth)(self, NULL);
+            callargs = _PyStack_AsTuple(args, nargs);
+            if (callargs == NULL)
+                return NULL;
+            result = (*meth)(self, callargs);
+            Py_DECREF(callargs);
+            return result;
+        }
+        break;
+    case METH_VARARGS:
+        if (kwnames != NULL)
+            break;
+        /* fall through */
+    case METH_VARARGS | METH_KEYWORDS:
+    case METH_OLDARGS | METH_KEYWORDS:
+        callargs = _PyStack_AsTuple(args, nargs);
+        if (callargs == NULL)
+            return NULL;
+        if (!(ml->ml_flags & METH_KEYWORDS)) {
+            result = (*meth)(self, callargs);
+            Py_DECREF(callargs);
+            return result;
+        }
+        kwdict = NULL;
+        if (kwnames != NULL) {
+            kwdict = _PyStack_AsDict(args + nargs, kwnames);
+            if (kwdict == NULL) {
+                Py_DECREF(callargs);
+                return NULL;
+            }
+        }
+        result = (*(PyCFunctionWithKeywords)meth)(self, callargs, kwdict);
+        Py_DECREF(callargs);
+        Py_XDECREF(kwdict);
+        return result;
+    default:
+        PyErr_BadInternalCall();
+        return NULL;
+    }
+    PyErr_Format(PyExc_TypeError, "%.200s() takes no keyword arguments",
+                 ml->ml_name);
+    return NULL;
+}
+
+PyObject *
+_PyCFunction_FastCall(PyObject *func, PyObject **args, Py_ssize_t nargs,
+                      PyObject *kwnames)
+{
+    return _PyMethodDef_FastCall(((PyCFunctionObject *)func)->m_ml,
+                                 PyCFunction_GET_SELF(func),
+                                 args, nargs, kwnames);
+}
+
 /* Methods (the standard built-in methods, that is) */
 
 static void
@@ -311,6 +422,22 @@ PyTypeObject PyCFunction_Type = {
     meth_getsets,                               /* tp_getset */
     0,                                          /* tp_base */
     0,                                          /* tp_dict */
+    0,                                          /* tp_descr_get */
+    0,                                          /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    0,                                          /* tp_init */
+    0,                                          /* tp_alloc */
+    0,                                          /* tp_new */
+    0,                                          /* tp_free */
+    0,                                          /* tp_is_gc */
+    0,                                          /* tp_bases */
+    0,                                          /* tp_mro */
+    0,                                          /* tp_cache */
+    0,                                          /* tp_subclasses */
+    0,                                          /* tp_weaklist */
+    0,                                          /* tp_del */
+    0,                                          /* tp_version_tag */
+    _PyCFunction_FastCall,                      /* tp_fastcall */
 };
 
 /* List all methods in a chain -- helper for findmethodinchain */
@@ -21,12 +21,9 @@ _Py_GetRefTotal(void)
 {
     PyObject *o;
     Py_ssize_t total = _Py_RefTotal;
-    /* ignore the references to the dummy object of the dicts and sets
+    /* ignore the references to the dummy object of the sets
        because they are not reliable and not useful (now that the
        hash table code is well-tested) */
-    o = _PyDict_Dummy();
-    if (o != NULL)
-        total -= o->ob_refcnt;
     o = _PySet_Dummy();
     if (o != NULL)
         total -= o->ob_refcnt;
@@ -1125,6 +1122,257 @@ _Py_HashPointer(void *p)
     return x;
 }
 
+/* String hashing.  The historical loop, kept as the default, takes one
+   multiplication per character, each waiting for the one before.  The
+   word hash and SipHash-2-4 read 8 bytes at a time as a little-endian
+   64-bit word, whatever the byte order of the machine, and finish with
+   a word holding the last 0-7 bytes and the length in its top byte.
+
+   unicode objects compare equal to str objects holding the same
+   characters, so _Py_HashChars() packs characters below 256 into the
+   same words as those bytes.  A string with a wider character can't
+   equal a str, but its characters may be stored 2 or 4 bytes each:
+   those below 0x10000 are packed 4 to a word, and only a string with a
+   character beyond them, which is always 4 bytes wide, has its raw
+   bytes hashed. */
+
+/* the characters of wide unicode builds */
+#ifdef Py_USING_UNICODE
+#define HASH_UCS4 Py_UCS4
+#else
+#define HASH_UCS4 unsigned int
+#endif
+
+#if Py_HASH_ALGORITHM == Py_HASH_FNV
+
+#define FNV_LOOP(type)                                  \
+    do {                                                \
+        const type *p = (const type *)src;              \
+        x ^= *p << 7;                                   \
+        while (--len >= 0)                              \
+            x = (1000003*x) ^ *p++;                     \
+    } while (0)
+
+static long
+hash_string(const void *src, Py_ssize_t len, int charsize)
+{
+    register long x = _Py_HashSecret.prefix;
+    Py_ssize_t size = len;
+
+    switch (charsize) {
+    case 1: FNV_LOOP(unsigned char); break;
+    case 2: FNV_LOOP(unsigned short); break;
+    default: FNV_LOOP(HASH_UCS4); break;
+    }
+    x ^= size;
+    x ^= _Py_HashSecret.suffix;
+    return x;
+}
+
+#else /* Py_HASH_ALGORITHM != Py_HASH_FNV */
+
+#ifndef HAVE_UINT64_T
+#error "--with-hash-algorithm needs a 64-bit integer type"
+#endif
+
+#define ROTL64(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+/* the character at p, charsize bytes wide */
+#define HASH_CHAR(p, charsize)                                  \
+    ((charsize) == 1 ? (PY_UINT64_T)*(const unsigned char *)(p) : \
+     (charsize) == 2 ? (PY_UINT64_T)*(const unsigned short *)(p) : \
+     (PY_UINT64_T)*(const HASH_UCS4 *)(p))
+
+/* the 8 characters at p as a word, character i in byte i */
+Py_LOCAL_INLINE(PY_UINT64_T)
+hash_load(const unsigned char *p, int charsize)
+{
+    PY_UINT64_T w;
+    int i;
+
+#ifndef WORDS_BIGENDIAN
+    if (charsize == 1) {
+        memcpy(&w, p, 8);
+        return w;
+    }
+#endif
+    w = 0;
+    for (i = 0; i < 8; i++)
+        w |= HASH_CHAR(p + i * charsize, charsize) << (8 * i);
+    return w;
+}
+
+/* the key and the state are 64-bit even where long is 32-bit */
+#define HASH_KEY(i) ((PY_UINT64_T)(unsigned long)                      \
+                     ((i) ? _Py_HashSecret.suffix : _Py_HashSecret.prefix))
+
+#if Py_HASH_ALGORITHM == Py_HASH_WORD
+
+/* a multiplication and a shift per word, then the finalizer of
+   MurmurHash3 so that the low bits, which index dicts and sets, depend
+   on every byte */
+#define HASH_INIT()                                             \
+    PY_UINT64_T h = HASH_KEY(0) ^ 0x9e3779b97f4a7c15ULL
+#define HASH_WORD(m)                                            \
+    do {                                                        \
+        h = (h ^ (m)) * 0x9fb21c651e98df25ULL;                  \
+        h ^= h >> 32;                                           \
+    } while (0)
+#define HASH_FINAL()                                            \
+    do {                                                        \
+        h ^= HASH_KEY(1);                                       \
+        h ^= h >> 33;                                           \
+        h *= 0xff51afd7ed558ccdULL;                             \
+        h ^= h >> 33;                                           \
+        h *= 0xc4ceb9fe1a85ec53ULL;                             \
+        h ^= h >> 33;                                           \
+    } while (0)
+
+#elif Py_HASH_ALGORITHM == Py_HASH_SIPHASH24
+
+/* SipHash-2-4, Jean-Philippe Aumasson and Daniel J. Bernstein, 2012 */
+Py_LOCAL_INLINE(PY_UINT64_T)
+siphash_key(int i)
+{
+    const unsigned char *k = _Py_HashSecret.siphash_key + 8 * i;
+    return hash_load(k, 1);
+}
+
+#define SIPROUND                                                \
+    do {                                                        \
+        v0 += v1; v1 = ROTL64(v1, 13); v1 ^= v0;                \
+        v0 = ROTL64(v0, 32);                                    \
+        v2 += v3; v3 = ROTL64(v3, 16); v3 ^= v2;                \
+        v0 += v3; v3 = ROTL64(v3, 21); v3 ^= v0;                \
+        v2 += v1; v1 = ROTL64(v1, 17); v1 ^= v2;                \
+        v2 = ROTL64(v2, 32);                                    \
+    } while (0)
+#define HASH_INIT()                                             \
+    PY_UINT64_T k0 = siphash_key(0), k1 = siphash_key(1);       \
+    PY_UINT64_T v0 = k0 ^ 0x736f6d6570736575ULL;                \
+    PY_UINT64_T v1 = k1 ^ 0x646f72616e646f6dULL;                \
+    PY_UINT64_T v2 = k0 ^ 0x6c7967656e657261ULL;                \
+    PY_UINT64_T v3 = k1 ^ 0x7465646279746573ULL;                \
+    PY_UINT64_T h
+#define HASH_WORD(m)                                            \
+    do {                                                        \
+        PY_UINT64_T m_ = (m);                                   \
+        v3 ^= m_;                                               \
+        SIPROUND;                                               \
+        SIPROUND;                                               \
+        v0 ^= m_;                                               \
+    } while (0)
+#define HASH_FINAL()                                            \
+    do {                                                        \
+        v2 ^= 0xff;                                             \
+        SIPROUND;                                               \
+        SIPROUND;                                               \
+        SIPROUND;                                               \
+        SIPROUND;                                               \
+        h = v0 ^ v1 ^ v2 ^ v3;                                  \
+    } while (0)
+
+#else
+#error "unknown Py_HASH_ALGORITHM"
+#endif
+
+Py_LOCAL_INLINE(long)
+hash_words(const unsigned char *p, Py_ssize_t len, int charsize)
+{
+    PY_UINT64_T tail;
+    Py_ssize_t i, n = len & ~(Py_ssize_t)7;
+    HASH_INIT();
+
+    for (i = 0; i < n; i += 8)
+        HASH_WORD(hash_load(p + i * charsize, charsize));
+    tail = (PY_UINT64_T)len << 56;
+    for (; i < len; i++)
+        tail |= HASH_CHAR(p + i * charsize, charsize) << (8 * (i - n));
+    HASH_WORD(tail);
+    HASH_FINAL();
+    return (long)h;
+}
+
+/* the same as hash_words(), for the 2-byte units of characters below
+   0x10000: the words are those of their little-endian bytes */
+Py_LOCAL_INLINE(long)
+hash_words16(const unsigned char *p, Py_ssize_t len, int charsize)
+{
+    PY_UINT64_T m;
+    Py_ssize_t i, j, n = len & ~(Py_ssize_t)3;
+    HASH_INIT();
+
+    for (i = 0; i < n; i += 4) {
+        m = 0;
+        for (j = 0; j < 4; j++)
+            m |= HASH_CHAR(p + (i + j) * charsize, charsize) << (16 * j);
+        HASH_WORD(m);
+    }
+    m = (PY_UINT64_T)(2 * len) << 56;
+    for (; i < len; i++)
+        m |= HASH_CHAR(p + i * charsize, charsize) << (16 * (i - n));
+    HASH_WORD(m);
+    HASH_FINAL();
+    return (long)h;
+}
+
+static long
+hash_string(const void *src, Py_ssize_t len, int charsize)
+{
+    const unsigned char *p = (const unsigned char *)src;
+    Py_ssize_t i;
+    HASH_UCS4 high = 0;
+
+    switch (charsize) {
+    case 1:
+        return hash_words(p, len, 1);
+    case 2:
+        for (i = 0; i < len; i++)
+            high |= ((const unsigned short *)p)[i];
+        if (high < 256)
+            return hash_words(p, len, 2);
+        return hash_words16(p, len, 2);
+    default:
+        for (i = 0; i < len; i++)
+            high |= ((const HASH_UCS4 *)p)[i];
+        if (high < 256)
+            return hash_words(p, len, 4);
+        if (high < 0x10000)
+            return hash_words16(p, len, 4);
+        break;
+    }
+    return hash_words(p, len * charsize, 1);
+}
+
+#endif /* Py_HASH_ALGORITHM != Py_HASH_FNV */
+
+long
+_Py_HashBytes(const void *src, Py_ssize_t len)
+{
+    return _Py_HashChars(src, len, 1);
+}
+
+long
+_Py_HashChars(const void *src, Py_ssize_t len, int charsize)
+{
+    long x;
+
+#ifdef Py_DEBUG
+    assert(_Py_HashSecret_Initialized);
+#endif
+    assert(charsize == 1 || charsize == 2 || charsize == 4);
+    /*
+      We make the hash of the empty string be 0, rather than using
+      (prefix ^ suffix), since this slightly obfuscates the hash secret
+    */
+    if (len == 0)
+        return 0;
+    x = hash_string(src, len, charsize);
+    if (x == -1)
+        x = -2;
+    return x;
+}
+
 long
 PyObject_HashNotImplemented(PyObject *self)
 {
@@ -1591,7 +1839,7 @@ _PyObject_GenericSetAttrWithDict(PyObject *obj, PyObject *name,
         if (dictptr != NULL) {
             dict = *dictptr;
             if (dict == NULL && value != NULL) {
-                dict = PyDict_New();
+                dict = _PyObjectDict_New(tp);
                 if (dict == NULL)
                     goto done;
                 *dictptr = dict;
@@ -182,12 +182,49 @@ static int running_on_valgrind = -1;
  *
  * Therefore, allocating arenas with malloc is not optimal, because there is
  * some address space wastage, but this is the most portable way to request
- * memory from the system across various platforms.
+ * memory from the system across various platforms.  Where anonymous mmap()
+ * is available, arenas are mapped directly instead:  they come page-aligned,
+ * and the pages of pools that fall free can be handed back to the OS while
+ * the rest of the arena is still in use (see release_pools() below).
  */
 #define ARENA_SIZE              (256 << 10)     /* 256KB */
 
+#if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#include <sys/mman.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS           MAP_ANON
+#endif
+#ifdef MAP_ANONYMOUS
+#define ARENAS_USE_MMAP
+#endif
+#endif
+
+#ifdef ARENAS_USE_MMAP
+/*
+ * With PYTHONMALLOCHUGEPAGES set, arenas are 2MB instead, aligned so that
+ * each can be backed by a single (transparent) huge page, which saves TLB
+ * misses on big heaps.  The pools of such arenas are never released one by
+ * one, as that would split the huge page again.
+ */
+#define HUGE_ARENA_SIZE         (2 << 20)       /* 2MB */
+
+/*
+ * MADV_DONTNEED drops the pages at once on Linux, which is what shows up in
+ * the process's RSS; MADV_FREE there only drops them under memory pressure.
+ * Elsewhere MADV_DONTNEED is often a mere hint, and MADV_FREE is the call.
+ */
+#if defined(__linux__) && defined(MADV_DONTNEED)
+#define POOL_MADVISE            MADV_DONTNEED
+#elif defined(MADV_FREE)
+#define POOL_MADVISE            MADV_FREE
+#endif
+#ifdef POOL_MADVISE
+#define ARENAS_RELEASE_POOLS
+#endif
+#endif /* ARENAS_USE_MMAP */
+
 #ifdef WITH_MEMORY_LIMITS
-#define MAX_ARENAS              (SMALL_MEMORY_LIMIT / ARENA_SIZE)
+#define MAX_ARENAS              (SMALL_MEMORY_LIMIT / arena_size)
 #endif
 
 /*
@@ -218,6 +255,21 @@ static int running_on_valgrind = -1;
  * INIT, [LOCK, UNLOCK]*, FINI.
  */
 
+#ifdef PYMALLOC_TCACHE
+/*
+ * With per-thread caches (see below) the allocator may be entered without
+ * the GIL, so the pools and arenas are guarded by a real mutex.  It is only
+ * taken to refill or drain a thread's cache, never on the fast paths.
+ */
+#include <pthread.h>
+#define SIMPLELOCK_DECL(lock)   static pthread_mutex_t lock = \
+                                    PTHREAD_MUTEX_INITIALIZER;
+#define SIMPLELOCK_INIT(lock)   pthread_mutex_init(&(lock), NULL)
+#define SIMPLELOCK_FINI(lock)   pthread_mutex_destroy(&(lock))
+#define SIMPLELOCK_LOCK(lock)   pthread_mutex_lock(&(lock))
+#define SIMPLELOCK_UNLOCK(lock) pthread_mutex_unlock(&(lock))
+
+#else
 /*
  * Python's threads are serialized, so object malloc locking is disabled.
  */
@@ -226,6 +278,7 @@ static int running_on_valgrind = -1;
 #define SIMPLELOCK_FINI(lock)   /* free/destroy an existing lock        */
 #define SIMPLELOCK_LOCK(lock)   /* acquire released lock */
 #define SIMPLELOCK_UNLOCK(lock) /* release acquired lock */
+#endif
 
 /*
  * Basic types
@@ -261,6 +314,14 @@ struct pool_header {
 
 typedef struct pool_header *poolp;
 
+#ifdef ARENAS_RELEASE_POOLS
+/* Number of pools in an ordinary arena, and of 32-bit words in a bitmap
+ * with one bit per pool.
+ */
+#define ARENA_POOLS             (ARENA_SIZE / POOL_SIZE)
+#define ARENA_POOLS_WORDS       ((ARENA_POOLS + 31) / 32)
+#endif
+
 /* Record keeping for arenas. */
 struct arena_object {
     /* The address of the arena, as returned by malloc.  Note that 0
@@ -284,6 +345,22 @@ struct arena_object {
     /* Singly-linked list of available pools. */
     struct pool_header* freepools;
 
+#ifdef ARENAS_RELEASE_POOLS
+    /* The number of pools on the freepools list. */
+    uint ncachedpools;
+
+    /* Free pools whose pages were handed back to the OS, as a bitmap of
+     * pool indices within the arena.  Their headers are gone with their
+     * pages, so they can't be on the freepools list; they still count in
+     * nfreepools.
+     */
+    uint nreturnedpools;
+    uint returnedpools[ARENA_POOLS_WORDS];
+
+    /* Set when trim_arenas() last saw too many cached pools here. */
+    int trimpending;
+#endif
+
     /* Whenever this arena_object is not associated with an allocated
      * arena, the nextarena member is used to link all unassociated
      * arena_objects in the singly-linked `unused_arena_objects` list.
@@ -508,13 +585,76 @@ static struct arena_object* usable_arenas = NULL;
 /* Number of arenas allocated that haven't been free()'d. */
 static size_t narenas_currently_allocated = 0;
 
-#ifdef PYMALLOC_DEBUG
 /* Total number of times malloc() called to allocate an arena. */
 static size_t ntimes_arena_allocated = 0;
 /* High water mark (max value ever seen) for narenas_currently_allocated. */
 static size_t narenas_highwater = 0;
+
+/* Number of wholly free arenas kept mapped by keep_arena(). */
+static size_t narenas_kept = 0;
+
+/* The size of every arena:  ARENA_SIZE, or HUGE_ARENA_SIZE.  Settled when
+ * the first arena is allocated, and never changed after.
+ */
+static uint arena_size = ARENA_SIZE;
+static int huge_arenas = 0;
+
+#ifdef ARENAS_RELEASE_POOLS
+/* Number of pools currently handed back to the OS, and ever handed back. */
+static size_t npools_returned = 0;
+static size_t ntimes_pool_returned = 0;
 #endif
 
+/* Get the memory for a new arena from the system.  Return NULL on failure.
+ */
+static void *
+arena_map(void)
+{
+#ifdef ARENAS_USE_MMAP
+    block *ptr, *aligned;
+    size_t excess;
+
+    if (!huge_arenas) {
+        ptr = (block *)mmap(NULL, arena_size, PROT_READ|PROT_WRITE,
+                            MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        return ptr == (block *)MAP_FAILED ? NULL : ptr;
+    }
+    /* Map twice the size and trim it down to an aligned arena, so that
+     * it can be backed by a huge page.  MAP_HUGETLB isn't used:  its pages
+     * must be set aside by the administrator, and a copy-on-write fault
+     * after a fork() kills the process when they run out.
+     */
+    ptr = (block *)mmap(NULL, 2 * (size_t)arena_size, PROT_READ|PROT_WRITE,
+                        MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (ptr == (block *)MAP_FAILED)
+        return NULL;
+    excess = (size_t)((uptr)ptr & (arena_size - 1));
+    aligned = excess ? ptr + (arena_size - excess) : ptr;
+    if (aligned != ptr)
+        munmap(ptr, aligned - ptr);
+    munmap(aligned + arena_size, excess ? excess : arena_size);
+#ifdef MADV_HUGEPAGE
+    (void)madvise(aligned, arena_size, MADV_HUGEPAGE);
+#endif
+    return aligned;
+#else
+    return malloc(arena_size);
+#endif
+}
+
+/* Give the memory of arena ADDRESS back to the system. */
+static void
+arena_unmap(uptr address)
+{
+#ifdef ARENAS_USE_MMAP
+    munmap((void *)address, arena_size);
+#else
+    free((void *)address);
+#endif
+}
+
+static void malloc_stats(void);
+
 /* Allocate a new arena.  If we run out of memory, return NULL.  Else
  * allocate a new arena, and return the address of an arena_object
  * describing the new arena.  It's expected that the caller will set
@@ -528,7 +668,7 @@ new_arena(void)
 
 #ifdef PYMALLOC_DEBUG
     if (Py_GETENV("PYTHONMALLOCSTATS"))
-        _PyObject_DebugMallocStats();
+        malloc_stats();
 #endif
     if (unused_arena_objects == NULL) {
         uint i;
@@ -546,9 +686,22 @@ new_arena(void)
             return NULL;                /* overflow */
 #endif
         nbytes = numarenas * sizeof(*arenas);
+#ifdef PYMALLOC_TCACHE
+        /* Threads running without the GIL may be reading the old vector
+         * in Py_ADDRESS_IN_RANGE at this very moment, so copy it instead
+         * of realloc'ing, and never free it.  The vector only ever
+         * doubles, so the old copies add up to less than the live one.
+         */
+        arenaobj = (struct arena_object *)malloc(nbytes);
+        if (arenaobj == NULL)
+            return NULL;
+        if (maxarenas != 0)
+            memcpy(arenaobj, arenas, maxarenas * sizeof(*arenas));
+#else
         arenaobj = (struct arena_object *)realloc(arenas, nbytes);
         if (arenaobj == NULL)
             return NULL;
+#endif
         arenas = arenaobj;
 
         /* We might need to fix pointers that were copied.  However,
@@ -567,8 +720,23 @@ new_arena(void)
                                    &arenas[i+1] : NULL;
         }
 
-        /* Update globals. */
+#ifdef ARENAS_USE_MMAP
+        if (maxarenas == 0) {
+            char *p = Py_GETENV("PYTHONMALLOCHUGEPAGES");
+            if (p && *p != '\0') {
+                huge_arenas = 1;
+                arena_size = HUGE_ARENA_SIZE;
+            }
+        }
+#endif
+
+        /* Update globals.  The new vector, and the arena size, must be
+         * visible before the larger maxarenas is.
+         */
         unused_arena_objects = &arenas[maxarenas];
+#ifdef PYMALLOC_TCACHE
+        __sync_synchronize();
+#endif
         maxarenas = numarenas;
     }
 
@@ -577,7 +745,7 @@ new_arena(void)
     arenaobj = unused_arena_objects;
     unused_arena_objects = arenaobj->nextarena;
     assert(arenaobj->address == 0);
-    arenaobj->address = (uptr)malloc(ARENA_SIZE);
+    arenaobj->address = (uptr)arena_map();
     if (arenaobj->address == 0) {
         /* The allocation failed: return NULL after putting the
          * arenaobj back.
@@ -588,17 +756,21 @@ new_arena(void)
     }
 
     ++narenas_currently_allocated;
-#ifdef PYMALLOC_DEBUG
     ++ntimes_arena_allocated;
     if (narenas_currently_allocated > narenas_highwater)
         narenas_highwater = narenas_currently_allocated;
-#endif
     arenaobj->freepools = NULL;
+#ifdef ARENAS_RELEASE_POOLS
+    arenaobj->ncachedpools = 0;
+    arenaobj->nreturnedpools = 0;
+    memset(arenaobj->returnedpools, 0, sizeof(arenaobj->returnedpools));
+    arenaobj->trimpending = 0;
+#endif
     /* pool_address <- first pool-aligned address in the arena
        nfreepools <- number of whole pools that fit after alignment */
     arenaobj->pool_address = (block*)arenaobj->address;
-    arenaobj->nfreepools = ARENA_SIZE / POOL_SIZE;
-    assert(POOL_SIZE * arenaobj->nfreepools == ARENA_SIZE);
+    arenaobj->nfreepools = arena_size / POOL_SIZE;
+    assert(POOL_SIZE * arenaobj->nfreepools == arena_size);
     excess = (uint)(arenaobj->address & POOL_SIZE_MASK);
     if (excess != 0) {
         --arenaobj->nfreepools;
@@ -693,7 +865,7 @@ variable.
 */
 #define Py_ADDRESS_IN_RANGE(P, POOL)                    \
     ((arenaindex_temp = (POOL)->arenaindex) < maxarenas &&              \
-     (uptr)(P) - arenas[arenaindex_temp].address < (uptr)ARENA_SIZE && \
+     (uptr)(P) - arenas[arenaindex_temp].address < (uptr)arena_size && \
      arenas[arenaindex_temp].address != 0)
 
 
@@ -730,11 +902,158 @@ int Py_ADDRESS_IN_RANGE(void *P, poolp pool) Py_NO_INLINE;
 
 /*==========================================================================*/
 
-/* malloc.  Note that nbytes==0 tries to return a non-NULL pointer, distinct
- * from all other currently live pointers.  This may not be possible.
+#ifdef ARENAS_RELEASE_POOLS
+/*
+ * Free pools are kept on their arena's freepools list with their pages
+ * resident, ready for reuse.  Every TRIM_INTERVAL pools freed, trim_arenas()
+ * looks for arenas with more than MAX_CACHED_POOLS of them, and hands all
+ * but the KEEP_CACHED_POOLS most recently freed back to the OS, so that the
+ * RSS of a process goes down again after a spike even if no arena ever
+ * becomes entirely free.
+ *
+ * An arena only gets trimmed if it had too many free pools at two sweeps
+ * in a row:  when a big structure is torn down, most of its arenas become
+ * wholly free soon enough (see keep_arena()), and returning their pools one
+ * by one on the way would be wasted effort.  The gap between the two limits
+ * keeps a process whose heap merely breathes from calling madvise() over and
+ * over.
  */
+#define MAX_CACHED_POOLS        16
+#define KEEP_CACHED_POOLS       8
+#define TRIM_INTERVAL           (4 * ARENA_POOLS)
+
+/* Number of pools freed since the last trim_arenas(). */
+static uint npools_freed = 0;
+
+#define POOL_INDEX(AO, P) \
+    ((uint)(((uptr)(P) - (AO)->address) / POOL_SIZE))
+#define POOL_RETURNED(AO, I) \
+    ((AO)->returnedpools[(I) >> 5] & (1U << ((I) & 31)))
+
+/* Hand all but the KEEP_CACHED_POOLS first pools of AO's freepools list back
+ * to the OS.  The caller holds the malloc lock.
+ */
+static void
+release_pools(struct arena_object *ao)
+{
+    uint released[ARENA_POOLS_WORDS];
+    poolp pool, next;
+    uint i, j, n;
+
+    pool = ao->freepools;
+    for (i = 1; i < KEEP_CACHED_POOLS; ++i)
+        pool = pool->nextpool;
+    next = pool->nextpool;
+    pool->nextpool = NULL;
+    ao->ncachedpools = KEEP_CACHED_POOLS;
+
+    memset(released, 0, sizeof(released));
+    for (pool = next; pool != NULL; pool = next) {
+        next = pool->nextpool;
+        i = POOL_INDEX(ao, pool);
+        released[i >> 5] |= 1U << (i & 31);
+    }
+
+    /* One call per run of adjacent pools. */
+    n = 0;
+    for (i = 0; i < ARENA_POOLS; i = j) {
+        j = i + 1;
+        if (!(released[i >> 5] & (1U << (i & 31))))
+            continue;
+        while (j < ARENA_POOLS && (released[j >> 5] & (1U << (j & 31))))
+            ++j;
+        (void)madvise((void *)(ao->address + (uptr)i * POOL_SIZE),
+                      (size_t)(j - i) * POOL_SIZE, POOL_MADVISE);
+        n += j - i;
+    }
+    for (i = 0; i < ARENA_POOLS_WORDS; ++i)
+        ao->returnedpools[i] |= released[i];
+    ao->nreturnedpools += n;
+    npools_returned += n;
+    ntimes_pool_returned += n;
+}
+
+/* Release the cached pools of the arenas that had too many of them at this
+ * sweep and the one before.  The caller holds the malloc lock.
+ */
+static void
+trim_arenas(void)
+{
+    uint i;
+
+    for (i = 0; i < maxarenas; ++i) {
+        struct arena_object *ao = &arenas[i];
+
+        if (ao->address == 0)
+            continue;
+        if (ao->ncachedpools <= MAX_CACHED_POOLS)
+            ao->trimpending = 0;
+        else if (!ao->trimpending)
+            ao->trimpending = 1;
+        else {
+            release_pools(ao);
+            ao->trimpending = 0;
+        }
+    }
+}
+
+/* Take a pool handed back to the OS by release_pools() out of AO's bitmap,
+ * and return it.  Its header must be set up from scratch.
+ */
+static poolp
+reclaim_pool(struct arena_object *ao)
+{
+    uint w, i;
+
+    assert(ao->nreturnedpools > 0);
+    for (w = 0; ao->returnedpools[w] == 0; ++w)
+        ;
+    for (i = 0; !(ao->returnedpools[w] & (1U << i)); ++i)
+        ;
+    ao->returnedpools[w] &= ~(1U << i);
+    --ao->nreturnedpools;
+    --npools_returned;
+    return (poolp)(ao->address + (uptr)(w * 32 + i) * POOL_SIZE);
+}
+#endif /* ARENAS_RELEASE_POOLS */
 
 /*
+ * An arena whose pools all fall free is normally given back to the system at
+ * once.  A program that builds and drops a big structure in a loop would then
+ * have every page of it mapped and faulted in afresh each time around, so up
+ * to MAX_KEPT_ARENAS of them are kept instead, on the usable_arenas list, as
+ * if just allocated.  Their pages stay resident:  marking them MADV_FREE
+ * makes the next use fault them all in again on Linux, which is what keeping
+ * them is meant to avoid.
+ */
+#define MAX_KEPT_ARENAS         16
+
+/* Reset the wholly free arena AO for reuse, and return 1; or return 0 if
+ * enough arenas are kept already.  The caller holds the malloc lock.
+ */
+static int
+keep_arena(struct arena_object *ao)
+{
+    assert(ao->nfreepools == ao->ntotalpools);
+    if (narenas_kept >= MAX_KEPT_ARENAS)
+        return 0;
+    ++narenas_kept;
+    ao->freepools = NULL;
+    ao->pool_address = (block *)((ao->address + POOL_SIZE_MASK) &
+                                 ~(uptr)POOL_SIZE_MASK);
+#ifdef ARENAS_RELEASE_POOLS
+    npools_returned -= ao->nreturnedpools;
+    ao->ncachedpools = 0;
+    ao->nreturnedpools = 0;
+    memset(ao->returnedpools, 0, sizeof(ao->returnedpools));
+    ao->trimpending = 0;
+#endif
+    return 1;
+}
+
+/* Allocate a block of size class SIZE from the pools.  Return NULL if that
+ * needs a new arena and none can be had.  The caller holds the malloc lock.
+ *
  * The basic blocks are ordered by decreasing execution frequency,
  * which minimizes the number of jumps in the most common cases,
  * improves branching prediction and instruction scheduling (small
@@ -742,14 +1061,575 @@ int Py_ADDRESS_IN_RANGE(void *P, poolp pool) Py_NO_INLINE;
  * Unless the optimizer reorders everything, being too smart...
  */
 
+Py_LOCAL_INLINE(block *)
+pool_alloc(uint size)
+{
+    block *bp;
+    poolp pool;
+    poolp next;
+
+    /*
+     * Most frequent paths first
+     */
+    pool = usedpools[size + size];
+    if (pool != pool->nextpool) {
+        /*
+         * There is a used pool for this size class.
+         * Pick up the head block of its free list.
+         */
+        ++pool->ref.count;
+        bp = pool->freeblock;
+        assert(bp != NULL);
+        if ((pool->freeblock = *(block **)bp) != NULL)
+            return bp;
+        /*
+         * Reached the end of the free list, try to extend it.
+         */
+        if (pool->nextoffset <= pool->maxnextoffset) {
+            /* There is room for another block. */
+            pool->freeblock = (block*)pool +
+                              pool->nextoffset;
+            pool->nextoffset += INDEX2SIZE(size);
+            *(block **)(pool->freeblock) = NULL;
+            return bp;
+        }
+        /* Pool is full, unlink from used pools. */
+        next = pool->nextpool;
+        pool = pool->prevpool;
+        next->prevpool = pool;
+        pool->nextpool = next;
+        return bp;
+    }
+
+    /* There isn't a pool of the right size class immediately
+     * available:  use a free pool.
+     */
+    if (usable_arenas == NULL) {
+        /* No arena has a free pool:  allocate a new arena. */
+#ifdef WITH_MEMORY_LIMITS
+        if (narenas_currently_allocated >= MAX_ARENAS)
+            return NULL;
+#endif
+        usable_arenas = new_arena();
+        if (usable_arenas == NULL)
+            return NULL;
+        usable_arenas->nextarena =
+            usable_arenas->prevarena = NULL;
+    }
+    else if (usable_arenas->nfreepools == usable_arenas->ntotalpools) {
+        /* Put an arena kept by keep_arena() back to use. */
+        assert(narenas_kept > 0);
+        --narenas_kept;
+    }
+    assert(usable_arenas->address != 0);
+
+    /* Try to get a cached free pool. */
+    pool = usable_arenas->freepools;
+    if (pool != NULL) {
+        /* Unlink from cached pools. */
+        usable_arenas->freepools = pool->nextpool;
+#ifdef ARENAS_RELEASE_POOLS
+        --usable_arenas->ncachedpools;
+#endif
+
+        /* This arena already had the smallest nfreepools
+         * value, so decreasing nfreepools doesn't change
+         * that, and we don't need to rearrange the
+         * usable_arenas list.  However, if the arena has
+         * become wholly allocated, we need to remove its
+         * arena_object from usable_arenas.
+         */
+        --usable_arenas->nfreepools;
+        if (usable_arenas->nfreepools == 0) {
+            /* Wholly allocated:  remove. */
+            assert(usable_arenas->freepools == NULL);
+            assert(usable_arenas->nextarena == NULL ||
+                   usable_arenas->nextarena->prevarena ==
+                   usable_arenas);
+
+            usable_arenas = usable_arenas->nextarena;
+            if (usable_arenas != NULL) {
+                usable_arenas->prevarena = NULL;
+                assert(usable_arenas->address != 0);
+            }
+        }
+        else {
+            /* nfreepools > 0:  it must be that freepools
+             * isn't NULL, that some pools were handed back
+             * to the OS, or that we haven't yet carved off
+             * all the arena's pools for the first time.
+             */
+            assert(usable_arenas->freepools != NULL ||
+#ifdef ARENAS_RELEASE_POOLS
+                   usable_arenas->nreturnedpools != 0 ||
+#endif
+                   usable_arenas->pool_address <=
+                   (block*)usable_arenas->address +
+                       arena_size - POOL_SIZE);
+        }
+    init_pool:
+        /* Frontlink to used pools. */
+        next = usedpools[size + size]; /* == prev */
+        pool->nextpool = next;
+        pool->prevpool = next;
+        next->nextpool = pool;
+        next->prevpool = pool;
+        pool->ref.count = 1;
+        if (pool->szidx == size) {
+            /* Luckily, this pool last contained blocks
+             * of the same size class, so its header
+             * and free list are already initialized.
+             */
+            bp = pool->freeblock;
+            pool->freeblock = *(block **)bp;
+            return bp;
+        }
+        /*
+         * Initialize the pool header, set up the free list to
+         * contain just the second block, and return the first
+         * block.
+         */
+        pool->szidx = size;
+        size = INDEX2SIZE(size);
+        bp = (block *)pool + POOL_OVERHEAD;
+        pool->nextoffset = POOL_OVERHEAD + (size << 1);
+        pool->maxnextoffset = POOL_SIZE - size;
+        pool->freeblock = bp + size;
+        *(block **)(pool->freeblock) = NULL;
+        return bp;
+    }
+
+    /* Take back a pool handed to the OS, or else carve off a new pool. */
+    assert(usable_arenas->nfreepools > 0);
+    assert(usable_arenas->freepools == NULL);
+#ifdef ARENAS_RELEASE_POOLS
+    if (usable_arenas->nreturnedpools != 0)
+        pool = reclaim_pool(usable_arenas);
+    else
+#endif
+    {
+        pool = (poolp)usable_arenas->pool_address;
+        assert((block*)pool <= (block*)usable_arenas->address +
+                               arena_size - POOL_SIZE);
+        usable_arenas->pool_address += POOL_SIZE;
+    }
+    pool->arenaindex = usable_arenas - arenas;
+    assert(&arenas[pool->arenaindex] == usable_arenas);
+    pool->szidx = DUMMY_SIZE_IDX;
+    --usable_arenas->nfreepools;
+
+    if (usable_arenas->nfreepools == 0) {
+        assert(usable_arenas->nextarena == NULL ||
+               usable_arenas->nextarena->prevarena ==
+               usable_arenas);
+        /* Unlink the arena:  it is completely allocated. */
+        usable_arenas = usable_arenas->nextarena;
+        if (usable_arenas != NULL) {
+            usable_arenas->prevarena = NULL;
+            assert(usable_arenas->address != 0);
+        }
+    }
+
+    goto init_pool;
+}
+
+/* Give block P, which lives in POOL, back to its pool.  The caller holds
+ * the malloc lock.
+ */
+Py_LOCAL_INLINE(void)
+pool_free(poolp pool, block *p)
+{
+    block *lastfree;
+    poolp next, prev;
+    uint size;
+
+    /* Link p to the start of the pool's freeblock list.  Since
+     * the pool had at least the p block outstanding, the pool
+     * wasn't empty (so it's already in a usedpools[] list, or
+     * was full and is in no list -- it's not in the freeblocks
+     * list in any case).
+     */
+    assert(pool->ref.count > 0);            /* else it was empty */
+    *(block **)p = lastfree = pool->freeblock;
+    pool->freeblock = p;
+    if (lastfree) {
+        struct arena_object* ao;
+        uint nf;  /* ao->nfreepools */
+
+        /* freeblock wasn't NULL, so the pool wasn't full,
+         * and the pool is in a usedpools[] list.
+         */
+        if (--pool->ref.count != 0) {
+            /* pool isn't empty:  leave it in usedpools */
+            return;
+        }
+        /* Pool is now empty:  unlink from usedpools, and
+         * link to the front of freepools.  This ensures that
+         * previously freed pools will be allocated later
+         * (being not referenced, they are perhaps paged out).
+         */
+        next = pool->nextpool;
+        prev = pool->prevpool;
+        next->prevpool = prev;
+        prev->nextpool = next;
+
+        /* Link the pool to freepools.  This is a singly-linked
+         * list, and pool->prevpool isn't used there.
+         */
+        ao = &arenas[pool->arenaindex];
+        pool->nextpool = ao->freepools;
+        ao->freepools = pool;
+        nf = ++ao->nfreepools;
+#ifdef ARENAS_RELEASE_POOLS
+        ++ao->ncachedpools;
+        if (!huge_arenas && ++npools_freed >= TRIM_INTERVAL) {
+            npools_freed = 0;
+            trim_arenas();
+        }
+#endif
+
+        /* All the rest is arena management.  We just freed
+         * a pool, and there are 4 cases for arena mgmt:
+         * 1. If all the pools are free, return the arena to
+         *    the system free(), unless keep_arena() keeps it
+         *    (then it is handled like cases 2 to 4).
+         * 2. If this is the only free pool in the arena,
+         *    add the arena back to the `usable_arenas` list.
+         * 3. If the "next" arena has a smaller count of free
+         *    pools, we have to "slide this arena right" to
+         *    restore that usable_arenas is sorted in order of
+         *    nfreepools.
+         * 4. Else there's nothing more to do.
+         */
+        if (nf == ao->ntotalpools && !keep_arena(ao)) {
+            /* Case 1.  First unlink ao from usable_arenas.
+             */
+            assert(ao->prevarena == NULL ||
+                   ao->prevarena->address != 0);
+            assert(ao ->nextarena == NULL ||
+                   ao->nextarena->address != 0);
+
+            /* Fix the pointer in the prevarena, or the
+             * usable_arenas pointer.
+             */
+            if (ao->prevarena == NULL) {
+                usable_arenas = ao->nextarena;
+                assert(usable_arenas == NULL ||
+                       usable_arenas->address != 0);
+            }
+            else {
+                assert(ao->prevarena->nextarena == ao);
+                ao->prevarena->nextarena =
+                    ao->nextarena;
+            }
+            /* Fix the pointer in the nextarena. */
+            if (ao->nextarena != NULL) {
+                assert(ao->nextarena->prevarena == ao);
+                ao->nextarena->prevarena =
+                    ao->prevarena;
+            }
+            /* Record that this arena_object slot is
+             * available to be reused.
+             */
+            ao->nextarena = unused_arena_objects;
+            unused_arena_objects = ao;
+
+            /* Free the entire arena. */
+#ifdef ARENAS_RELEASE_POOLS
+            npools_returned -= ao->nreturnedpools;
+#endif
+            arena_unmap(ao->address);
+            ao->address = 0;                        /* mark unassociated */
+            --narenas_currently_allocated;
+            return;
+        }
+        if (nf == 1) {
+            /* Case 2.  Put ao at the head of
+             * usable_arenas.  Note that because
+             * ao->nfreepools was 0 before, ao isn't
+             * currently on the usable_arenas list.
+             */
+            ao->nextarena = usable_arenas;
+            ao->prevarena = NULL;
+            if (usable_arenas)
+                usable_arenas->prevarena = ao;
+            usable_arenas = ao;
+            assert(usable_arenas->address != 0);
+            return;
+        }
+        /* If this arena is now out of order, we need to keep
+         * the list sorted.  The list is kept sorted so that
+         * the "most full" arenas are used first, which allows
+         * the nearly empty arenas to be completely freed.  In
+         * a few un-scientific tests, it seems like this
+         * approach allowed a lot more memory to be freed.
+         */
+        if (ao->nextarena == NULL ||
+                     nf <= ao->nextarena->nfreepools) {
+            /* Case 4.  Nothing to do. */
+            return;
+        }
+        /* Case 3:  We have to move the arena towards the end
+         * of the list, because it has more free pools than
+         * the arena to its right.
+         * First unlink ao from usable_arenas.
+         */
+        if (ao->prevarena != NULL) {
+            /* ao isn't at the head of the list */
+            assert(ao->prevarena->nextarena == ao);
+            ao->prevarena->nextarena = ao->nextarena;
+        }
+        else {
+            /* ao is at the head of the list */
+            assert(usable_arenas == ao);
+            usable_arenas = ao->nextarena;
+        }
+        ao->nextarena->prevarena = ao->prevarena;
+
+        /* Locate the new insertion point by iterating over
+         * the list, using our nextarena pointer.
+         */
+        while (ao->nextarena != NULL &&
+                        nf > ao->nextarena->nfreepools) {
+            ao->prevarena = ao->nextarena;
+            ao->nextarena = ao->nextarena->nextarena;
+        }
+
+        /* Insert ao at this point. */
+        assert(ao->nextarena == NULL ||
+            ao->prevarena == ao->nextarena->prevarena);
+        assert(ao->prevarena->nextarena == ao->nextarena);
+
+        ao->prevarena->nextarena = ao;
+        if (ao->nextarena != NULL)
+            ao->nextarena->prevarena = ao;
+
+        /* Verify that the swaps worked. */
+        assert(ao->nextarena == NULL ||
+                  nf <= ao->nextarena->nfreepools);
+        assert(ao->prevarena == NULL ||
+                  nf > ao->prevarena->nfreepools);
+        assert(ao->nextarena == NULL ||
+            ao->nextarena->prevarena == ao);
+        assert((usable_arenas == ao &&
+            ao->prevarena == NULL) ||
+            ao->prevarena->nextarena == ao);
+        return;
+    }
+    /* Pool was full, so doesn't currently live in any list:
+     * link it to the front of the appropriate usedpools[] list.
+     * This mimics LRU pool usage for new allocations and
+     * targets optimal filling when several pools contain
+     * blocks of the same size class.
+     */
+    --pool->ref.count;
+    assert(pool->ref.count > 0);            /* else the pool is empty */
+    size = pool->szidx;
+    next = usedpools[size + size];
+    prev = next->prevpool;
+    /* insert pool before next:   prev <-> pool <-> next */
+    pool->nextpool = next;
+    pool->prevpool = prev;
+    next->prevpool = pool;
+    prev->nextpool = pool;
+}
+
+#ifdef PYMALLOC_TCACHE
+/*==========================================================================*/
+
+/*
+ * Per-thread caches
+ *
+ * Every thread keeps a small stack of free blocks for each size class.  The
+ * blocks on it still count as allocated in their pools, so malloc and free
+ * are served from the stack without taking the malloc lock, touching
+ * usedpools, or even touching the block itself.  An empty stack is refilled
+ * with a batch of blocks, and a full one hands half of its blocks back to
+ * the pools, each time under a single acquisition of the lock.  Larger classes
+ * get shallower stacks, so that a thread never sits on much memory.
+ *
+ * The stacks are malloc'ed when a thread first needs them, and freed by a
+ * pthread key destructor when it exits, after their blocks went back to the
+ * pools.  Until then and after that, the thread's `tcache` points at
+ * tcache_off, whose limits are all 0, so every call falls through to the
+ * slow paths and goes to the pools directly.
+ */
+
+#define TCACHE_SLOTS            64
+#define TCACHE_LIMIT(I)         (INDEX2SIZE(I) <= 128 ? TCACHE_SLOTS \
+                                                      : TCACHE_SLOTS / 2)
+
+struct tcache {
+    uint count[NB_SMALL_SIZE_CLASSES];  /* blocks on each stack */
+    uint limit[NB_SMALL_SIZE_CLASSES];  /* max count[i], 0 = off */
+    block *slots[NB_SMALL_SIZE_CLASSES][TCACHE_SLOTS];
+};
+
+static struct tcache tcache_off;        /* all zeroes, never written */
+static __thread struct tcache *tcache = &tcache_off;
+/* 0: no stacks yet, 1: registered, -1: released or unavailable */
+static __thread int tcache_state = 0;
+
+static pthread_key_t tcache_key;
+static pthread_once_t tcache_once = PTHREAD_ONCE_INIT;
+static int tcache_key_created = 0;
+
+/* Thread exit:  give every cached block back to its pool. */
+static void
+tcache_release(void *arg)
+{
+    struct tcache *tc = (struct tcache *)arg;
+    block *bp;
+    uint i;
+
+    tcache = &tcache_off;
+    tcache_state = -1;
+    LOCK();
+    for (i = 0; i < NB_SMALL_SIZE_CLASSES; ++i) {
+        while (tc->count[i] != 0) {
+            bp = tc->slots[i][--tc->count[i]];
+            pool_free(POOL_ADDR(bp), bp);
+        }
+    }
+    UNLOCK();
+    free(tc);
+}
+
+/* A fork() must not catch another thread inside the allocator. */
+static void
+tcache_atfork_prepare(void)
+{
+    LOCK();
+}
+
+static void
+tcache_atfork_release(void)
+{
+    UNLOCK();
+}
+
+static void
+tcache_init(void)
+{
+    if (pthread_key_create(&tcache_key, tcache_release) != 0)
+        return;
+    if (pthread_atfork(tcache_atfork_prepare, tcache_atfork_release,
+                       tcache_atfork_release) != 0)
+        return;
+    tcache_key_created = 1;
+}
+
+/* Give the calling thread its stacks.  If there's no way to give them back
+ * at thread exit, the thread goes without.
+ */
+static void
+tcache_register(void)
+{
+    struct tcache *tc;
+    uint i;
+
+    assert(tcache_state == 0);
+    tcache_state = -1;
+    pthread_once(&tcache_once, tcache_init);
+    if (!tcache_key_created)
+        return;
+    tc = (struct tcache *)malloc(sizeof(struct tcache));
+    if (tc == NULL)
+        return;
+    if (pthread_setspecific(tcache_key, tc) != 0) {
+        free(tc);
+        return;
+    }
+    for (i = 0; i < NB_SMALL_SIZE_CLASSES; ++i) {
+        tc->count[i] = 0;
+        tc->limit[i] = TCACHE_LIMIT(i);
+    }
+    tcache = tc;
+    tcache_state = 1;
+}
+
+/* The stack for SIZE is empty:  take a batch of blocks from the pools and
+ * return one more.  Return NULL if the pools are out of memory.
+ */
+static block *
+tcache_refill(uint size)
+{
+    struct tcache *tc;
+    block *bp, *p;
+    uint n, batch;
+
+    if (tcache_state == 0)
+        tcache_register();
+    tc = tcache;
+    batch = tc->limit[size] / 2;
+    assert(tc->count[size] == 0);
+    LOCK();
+    bp = pool_alloc(size);
+    if (bp != NULL && batch != 0) {
+        for (n = 0; n < batch; ++n) {
+            p = pool_alloc(size);
+            if (p == NULL)
+                break;
+            tc->slots[size][n] = p;
+        }
+        tc->count[size] = n;
+    }
+    UNLOCK();
+    return bp;
+}
+
+/* Free P, a block of size class SIZE in POOL, when the stack for SIZE is
+ * full or off.  A full stack gives P and its top half back to the pools.
+ */
+static void
+tcache_flush(uint size, poolp pool, block *p)
+{
+    struct tcache *tc;
+    block *bp;
+    uint i, n;
+
+    if (tcache_state == 0)
+        tcache_register();
+    tc = tcache;
+    if (tc->count[size] < tc->limit[size]) {
+        tc->slots[size][tc->count[size]++] = p;
+        return;
+    }
+    if (tc->limit[size] == 0) {
+        LOCK();
+        pool_free(pool, p);
+        UNLOCK();
+        return;
+    }
+
+    n = tc->limit[size] / 2;
+    LOCK();
+    pool_free(pool, p);
+    for (i = tc->count[size] - n; i < tc->count[size]; ++i) {
+        bp = tc->slots[size][i];
+        pool_free(POOL_ADDR(bp), bp);
+    }
+    UNLOCK();
+    tc->count[size] -= n;
+}
+
+#endif /* PYMALLOC_TCACHE */
+
+/*==========================================================================*/
+
+/* malloc.  Note that nbytes==0 tries to return a non-NULL pointer, distinct
+ * from all other currently live pointers.  This may not be possible.
+ */
+
 #undef PyObject_Malloc
 void *
 PyObject_Malloc(size_t nbytes)
 {
     block *bp;
-    poolp pool;
-    poolp next;
     uint size;
+#ifdef PYMALLOC_TCACHE
+    struct tcache *tc;
+#endif
 
 #ifdef WITH_VALGRIND
     if (UNLIKELY(running_on_valgrind == -1))
@@ -771,168 +1651,26 @@ PyObject_Malloc(size_t nbytes)
      * This implicitly redirects malloc(0).
      */
     if ((nbytes - 1) < SMALL_REQUEST_THRESHOLD) {
-        LOCK();
-        /*
-         * Most frequent paths first
-         */
         size = (uint)(nbytes - 1) >> ALIGNMENT_SHIFT;
-        pool = usedpools[size + size];
-        if (pool != pool->nextpool) {
-            /*
-             * There is a used pool for this size class.
-             * Pick up the head block of its free list.
-             */
-            ++pool->ref.count;
-            bp = pool->freeblock;
-            assert(bp != NULL);
-            if ((pool->freeblock = *(block **)bp) != NULL) {
-                UNLOCK();
-                return (void *)bp;
-            }
-            /*
-             * Reached the end of the free list, try to extend it.
-             */
-            if (pool->nextoffset <= pool->maxnextoffset) {
-                /* There is room for another block. */
-                pool->freeblock = (block*)pool +
-                                  pool->nextoffset;
-                pool->nextoffset += INDEX2SIZE(size);
-                *(block **)(pool->freeblock) = NULL;
-                UNLOCK();
-                return (void *)bp;
-            }
-            /* Pool is full, unlink from used pools. */
-            next = pool->nextpool;
-            pool = pool->prevpool;
-            next->prevpool = pool;
-            pool->nextpool = next;
-            UNLOCK();
-            return (void *)bp;
-        }
-
-        /* There isn't a pool of the right size class immediately
-         * available:  use a free pool.
-         */
-        if (usable_arenas == NULL) {
-            /* No arena has a free pool:  allocate a new arena. */
-#ifdef WITH_MEMORY_LIMITS
-            if (narenas_currently_allocated >= MAX_ARENAS) {
-                UNLOCK();
-                goto redirect;
-            }
+#ifdef PYMALLOC_TCACHE
+        tc = tcache;
+        if (tc->count[size] != 0)
+            return (void *)tc->slots[size][--tc->count[size]];
+        bp = tcache_refill(size);
+#else
+        LOCK();
+        bp = pool_alloc(size);
+        UNLOCK();
 #endif
-            usable_arenas = new_arena();
-            if (usable_arenas == NULL) {
-                UNLOCK();
-                goto redirect;
-            }
-            usable_arenas->nextarena =
-                usable_arenas->prevarena = NULL;
-        }
-        assert(usable_arenas->address != 0);
-
-        /* Try to get a cached free pool. */
-        pool = usable_arenas->freepools;
-        if (pool != NULL) {
-            /* Unlink from cached pools. */
-            usable_arenas->freepools = pool->nextpool;
-
-            /* This arena already had the smallest nfreepools
-             * value, so decreasing nfreepools doesn't change
-             * that, and we don't need to rearrange the
-             * usable_arenas list.  However, if the arena has
-             * become wholly allocated, we need to remove its
-             * arena_object from usable_arenas.
-             */
-            --usable_arenas->nfreepools;
-            if (usable_arenas->nfreepools == 0) {
-                /* Wholly allocated:  remove. */
-                assert(usable_arenas->freepools == NULL);
-                assert(usable_arenas->nextarena == NULL ||
-                       usable_arenas->nextarena->prevarena ==
-                       usable_arenas);
-
-                usable_arenas = usable_arenas->nextarena;
-                if (usable_arenas != NULL) {
-                    usable_arenas->prevarena = NULL;
-                    assert(usable_arenas->address != 0);
-                }
-            }
-            else {
-                /* nfreepools > 0:  it must be that freepools
-                 * isn't NULL, or that we haven't yet carved
-                 * off all the arena's pools for the first
-                 * time.
-                 */
-                assert(usable_arenas->freepools != NULL ||
-                       usable_arenas->pool_address <=
-                       (block*)usable_arenas->address +
-                           ARENA_SIZE - POOL_SIZE);
-            }
-        init_pool:
-            /* Frontlink to used pools. */
-            next = usedpools[size + size]; /* == prev */
-            pool->nextpool = next;
-            pool->prevpool = next;
-            next->nextpool = pool;
-            next->prevpool = pool;
-            pool->ref.count = 1;
-            if (pool->szidx == size) {
-                /* Luckily, this pool last contained blocks
-                 * of the same size class, so its header
-                 * and free list are already initialized.
-                 */
-                bp = pool->freeblock;
-                pool->freeblock = *(block **)bp;
-                UNLOCK();
-                return (void *)bp;
-            }
-            /*
-             * Initialize the pool header, set up the free list to
-             * contain just the second block, and return the first
-             * block.
-             */
-            pool->szidx = size;
-            size = INDEX2SIZE(size);
-            bp = (block *)pool + POOL_OVERHEAD;
-            pool->nextoffset = POOL_OVERHEAD + (size << 1);
-            pool->maxnextoffset = POOL_SIZE - size;
-            pool->freeblock = bp + size;
-            *(block **)(pool->freeblock) = NULL;
-            UNLOCK();
+        if (bp != NULL)
             return (void *)bp;
-        }
-
-        /* Carve off a new pool. */
-        assert(usable_arenas->nfreepools > 0);
-        assert(usable_arenas->freepools == NULL);
-        pool = (poolp)usable_arenas->pool_address;
-        assert((block*)pool <= (block*)usable_arenas->address +
-                               ARENA_SIZE - POOL_SIZE);
-        pool->arenaindex = usable_arenas - arenas;
-        assert(&arenas[pool->arenaindex] == usable_arenas);
-        pool->szidx = DUMMY_SIZE_IDX;
-        usable_arenas->pool_address += POOL_SIZE;
-        --usable_arenas->nfreepools;
-
-        if (usable_arenas->nfreepools == 0) {
-            assert(usable_arenas->nextarena == NULL ||
-                   usable_arenas->nextarena->prevarena ==
-                   usable_arenas);
-            /* Unlink the arena:  it is completely allocated. */
-            usable_arenas = usable_arenas->nextarena;
-            if (usable_arenas != NULL) {
-                usable_arenas->prevarena = NULL;
-                assert(usable_arenas->address != 0);
-            }
-        }
-
-        goto init_pool;
     }
 
     /* The small block allocator ends here. */
 
+#ifdef WITH_VALGRIND
 redirect:
+#endif
     /* Redirect the original request to the underlying (libc) allocator.
      * We jump here on bigger requests, on error in the code above (as a
      * last chance to serve the request) or when the max memory limit
@@ -950,9 +1688,10 @@ void
 PyObject_Free(void *p)
 {
     poolp pool;
-    block *lastfree;
-    poolp next, prev;
+#ifdef PYMALLOC_TCACHE
+    struct tcache *tc;
     uint size;
+#endif
 #ifndef Py_USING_MEMORY_DEBUGGER
     uint arenaindex_temp;
 #endif
@@ -968,194 +1707,19 @@ PyObject_Free(void *p)
     pool = POOL_ADDR(p);
     if (Py_ADDRESS_IN_RANGE(p, pool)) {
         /* We allocated this address. */
-        LOCK();
-        /* Link p to the start of the pool's freeblock list.  Since
-         * the pool had at least the p block outstanding, the pool
-         * wasn't empty (so it's already in a usedpools[] list, or
-         * was full and is in no list -- it's not in the freeblocks
-         * list in any case).
-         */
-        assert(pool->ref.count > 0);            /* else it was empty */
-        *(block **)p = lastfree = pool->freeblock;
-        pool->freeblock = (block *)p;
-        if (lastfree) {
-            struct arena_object* ao;
-            uint nf;  /* ao->nfreepools */
-
-            /* freeblock wasn't NULL, so the pool wasn't full,
-             * and the pool is in a usedpools[] list.
-             */
-            if (--pool->ref.count != 0) {
-                /* pool isn't empty:  leave it in usedpools */
-                UNLOCK();
-                return;
-            }
-            /* Pool is now empty:  unlink from usedpools, and
-             * link to the front of freepools.  This ensures that
-             * previously freed pools will be allocated later
-             * (being not referenced, they are perhaps paged out).
-             */
-            next = pool->nextpool;
-            prev = pool->prevpool;
-            next->prevpool = prev;
-            prev->nextpool = next;
-
-            /* Link the pool to freepools.  This is a singly-linked
-             * list, and pool->prevpool isn't used there.
-             */
-            ao = &arenas[pool->arenaindex];
-            pool->nextpool = ao->freepools;
-            ao->freepools = pool;
-            nf = ++ao->nfreepools;
-
-            /* All the rest is arena management.  We just freed
-             * a pool, and there are 4 cases for arena mgmt:
-             * 1. If all the pools are free, return the arena to
-             *    the system free().
-             * 2. If this is the only free pool in the arena,
-             *    add the arena back to the `usable_arenas` list.
-             * 3. If the "next" arena has a smaller count of free
-             *    pools, we have to "slide this arena right" to
-             *    restore that usable_arenas is sorted in order of
-             *    nfreepools.
-             * 4. Else there's nothing more to do.
-             */
-            if (nf == ao->ntotalpools) {
-                /* Case 1.  First unlink ao from usable_arenas.
-                 */
-                assert(ao->prevarena == NULL ||
-                       ao->prevarena->address != 0);
-                assert(ao ->nextarena == NULL ||
-                       ao->nextarena->address != 0);
-
-                /* Fix the pointer in the prevarena, or the
-                 * usable_arenas pointer.
-                 */
-                if (ao->prevarena == NULL) {
-                    usable_arenas = ao->nextarena;
-                    assert(usable_arenas == NULL ||
-                           usable_arenas->address != 0);
-                }
-                else {
-                    assert(ao->prevarena->nextarena == ao);
-                    ao->prevarena->nextarena =
-                        ao->nextarena;
-                }
-                /* Fix the pointer in the nextarena. */
-                if (ao->nextarena != NULL) {
-                    assert(ao->nextarena->prevarena == ao);
-                    ao->nextarena->prevarena =
-                        ao->prevarena;
-                }
-                /* Record that this arena_object slot is
-                 * available to be reused.
-                 */
-                ao->nextarena = unused_arena_objects;
-                unused_arena_objects = ao;
-
-                /* Free the entire arena. */
-                free((void *)ao->address);
-                ao->address = 0;                        /* mark unassociated */
-                --narenas_currently_allocated;
-
-                UNLOCK();
-                return;
-            }
-            if (nf == 1) {
-                /* Case 2.  Put ao at the head of
-                 * usable_arenas.  Note that because
-                 * ao->nfreepools was 0 before, ao isn't
-                 * currently on the usable_arenas list.
-                 */
-                ao->nextarena = usable_arenas;
-                ao->prevarena = NULL;
-                if (usable_arenas)
-                    usable_arenas->prevarena = ao;
-                usable_arenas = ao;
-                assert(usable_arenas->address != 0);
-
-                UNLOCK();
-                return;
-            }
-            /* If this arena is now out of order, we need to keep
-             * the list sorted.  The list is kept sorted so that
-             * the "most full" arenas are used first, which allows
-             * the nearly empty arenas to be completely freed.  In
-             * a few un-scientific tests, it seems like this
-             * approach allowed a lot more memory to be freed.
-             */
-            if (ao->nextarena == NULL ||
-                         nf <= ao->nextarena->nfreepools) {
-                /* Case 4.  Nothing to do. */
-                UNLOCK();
-                return;
-            }
-            /* Case 3:  We have to move the arena towards the end
-             * of the list, because it has more free pools than
-             * the arena to its right.
-             * First unlink ao from usable_arenas.
-             */
-            if (ao->prevarena != NULL) {
-                /* ao isn't at the head of the list */
-                assert(ao->prevarena->nextarena == ao);
-                ao->prevarena->nextarena = ao->nextarena;
-            }
-            else {
-                /* ao is at the head of the list */
-                assert(usable_arenas == ao);
-                usable_arenas = ao->nextarena;
-            }
-            ao->nextarena->prevarena = ao->prevarena;
-
-            /* Locate the new insertion point by iterating over
-             * the list, using our nextarena pointer.
-             */
-            while (ao->nextarena != NULL &&
-                            nf > ao->nextarena->nfreepools) {
-                ao->prevarena = ao->nextarena;
-                ao->nextarena = ao->nextarena->nextarena;
-            }
-
-            /* Insert ao at this point. */
-            assert(ao->nextarena == NULL ||
-                ao->prevarena == ao->nextarena->prevarena);
-            assert(ao->prevarena->nextarena == ao->nextarena);
-
-            ao->prevarena->nextarena = ao;
-            if (ao->nextarena != NULL)
-                ao->nextarena->prevarena = ao;
-
-            /* Verify that the swaps worked. */
-            assert(ao->nextarena == NULL ||
-                      nf <= ao->nextarena->nfreepools);
-            assert(ao->prevarena == NULL ||
-                      nf > ao->prevarena->nfreepools);
-            assert(ao->nextarena == NULL ||
-                ao->nextarena->prevarena == ao);
-            assert((usable_arenas == ao &&
-                ao->prevarena == NULL) ||
-                ao->prevarena->nextarena == ao);
-
-            UNLOCK();
+#ifdef PYMALLOC_TCACHE
+        tc = tcache;
+        size = pool->szidx;
+        if (tc->count[size] < tc->limit[size]) {
+            tc->slots[size][tc->count[size]++] = (block *)p;
             return;
         }
-        /* Pool was full, so doesn't currently live in any list:
-         * link it to the front of the appropriate usedpools[] list.
-         * This mimics LRU pool usage for new allocations and
-         * targets optimal filling when several pools contain
-         * blocks of the same size class.
-         */
-        --pool->ref.count;
-        assert(pool->ref.count > 0);            /* else the pool is empty */
-        size = pool->szidx;
-        next = usedpools[size + size];
-        prev = next->prevpool;
-        /* insert pool before next:   prev <-> pool <-> next */
-        pool->nextpool = next;
-        pool->prevpool = prev;
-        next->prevpool = pool;
-        prev->nextpool = pool;
+        tcache_flush(size, pool, (block *)p);
+#else
+        LOCK();
+        pool_free(pool, (block *)p);
         UNLOCK();
+#endif
         return;
     }
 
@@ -1694,6 +2258,9 @@ _PyObject_DebugDumpAddress(const void *p)
     }
 }
 
+#endif  /* PYMALLOC_DEBUG */
+
+#ifdef WITH_PYMALLOC
 static size_t
 printone(const char* msg, size_t value)
 {
@@ -1736,6 +2303,17 @@ printone(const char* msg, size_t value)
  */
 void
 _PyObject_DebugMallocStats(void)
+{
+    LOCK();
+    malloc_stats();
+    UNLOCK();
+}
+
+/* The body of _PyObject_DebugMallocStats.  The caller holds the malloc
+ * lock.
+ */
+static void
+malloc_stats(void)
 {
     uint i;
     const uint numclasses = SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT;
@@ -1749,6 +2327,8 @@ _PyObject_DebugMallocStats(void)
     size_t available_bytes = 0;
     /* # of free pools + pools not yet carved out of current arena */
     uint numfreepools = 0;
+    /* # of free pools handed back to the OS */
+    uint numreturnedpools = 0;
     /* # of bytes for arena alignment padding */
     size_t arena_alignment = 0;
     /* # of bytes in used and full pools used for pool_headers */
@@ -1760,7 +2340,7 @@ _PyObject_DebugMallocStats(void)
     size_t quantization = 0;
     /* # of arenas actually allocated. */
     size_t narenas = 0;
-    /* running total -- should equal narenas * ARENA_SIZE */
+    /* running total -- should equal narenas * arena_size */
     size_t total;
     char buf[128];
 
@@ -1784,6 +2364,10 @@ _PyObject_DebugMallocStats(void)
         narenas += 1;
 
         numfreepools += arenas[i].nfreepools;
+#ifdef ARENAS_RELEASE_POOLS
+        numfreepools -= arenas[i].nreturnedpools;
+        numreturnedpools += arenas[i].nreturnedpools;
+#endif
 
         /* round up to pool alignment */
         if (base & (uptr)POOL_SIZE_MASK) {
@@ -1798,9 +2382,15 @@ _PyObject_DebugMallocStats(void)
                     base < (uptr) arenas[i].pool_address;
                     ++j, base += POOL_SIZE) {
             poolp p = (poolp)base;
-            const uint sz = p->szidx;
+            uint sz;
             uint freeblocks;
 
+#ifdef ARENAS_RELEASE_POOLS
+            /* don't fault the pages of returned pools back in */
+            if (!huge_arenas && POOL_RETURNED(&arenas[i], j))
+                continue;
+#endif
+            sz = p->szidx;
             if (p->ref.count == 0) {
                 /* currently unused */
                 assert(pool_is_in_list(p, arenas[i].freepools));
@@ -1843,34 +2433,59 @@ _PyObject_DebugMallocStats(void)
         quantization += p * ((POOL_SIZE - POOL_OVERHEAD) % size);
     }
     fputc('\n', stderr);
+#ifdef PYMALLOC_DEBUG
     (void)printone("# times object malloc called", serialno);
+#endif
 
     (void)printone("# arenas allocated total", ntimes_arena_allocated);
     (void)printone("# arenas reclaimed", ntimes_arena_allocated - narenas);
     (void)printone("# arenas highwater mark", narenas_highwater);
     (void)printone("# arenas allocated current", narenas);
+    (void)printone("# of those kept empty", narenas_kept);
 
     PyOS_snprintf(buf, sizeof(buf),
-        "%" PY_FORMAT_SIZE_T "u arenas * %d bytes/arena",
-        narenas, ARENA_SIZE);
-    (void)printone(buf, narenas * ARENA_SIZE);
+        "%" PY_FORMAT_SIZE_T "u arenas * %u bytes/arena",
+        narenas, arena_size);
+    (void)printone(buf, narenas * arena_size);
+#ifdef ARENAS_RELEASE_POOLS
+    (void)printone("# pools returned to the OS total",
+                   ntimes_pool_returned);
+#endif
 
     fputc('\n', stderr);
 
     total = printone("# bytes in allocated blocks", allocated_bytes);
+#ifdef PYMALLOC_TCACHE
+    /* Cached blocks count as allocated above; other threads' caches
+     * can't be looked at safely.
+     */
+    {
+        size_t cached_bytes = 0;
+        for (i = 0; i < numclasses; ++i)
+            cached_bytes += (size_t)tcache->count[i] * INDEX2SIZE(i);
+        (void)printone("# bytes cached by this thread",
+                       cached_bytes);
+    }
+#endif
     total += printone("# bytes in available blocks", available_bytes);
 
     PyOS_snprintf(buf, sizeof(buf),
         "%u unused pools * %d bytes", numfreepools, POOL_SIZE);
     total += printone(buf, (size_t)numfreepools * POOL_SIZE);
+    PyOS_snprintf(buf, sizeof(buf),
+        "%u returned pools * %d bytes", numreturnedpools, POOL_SIZE);
+    total += printone(buf, (size_t)numreturnedpools * POOL_SIZE);
 
     total += printone("# bytes lost to pool headers", pool_header_bytes);
     total += printone("# bytes lost to quantization", quantization);
     total += printone("# bytes lost to arena alignment", arena_alignment);
     (void)printone("Total", total);
+#ifdef ARENAS_RELEASE_POOLS
+    assert(numreturnedpools == npools_returned);
+#endif
 }
 
-#endif  /* PYMALLOC_DEBUG */
+#endif  /* WITH_PYMALLOC */
 
 #ifdef Py_USING_MEMORY_DEBUGGER
 /* Make this function last so gcc won't inline it since the definition is
@@ -1882,7 +2497,7 @@ Py_ADDRESS_IN_RANGE(void *P, poolp pool)
     uint arenaindex_temp = pool->arenaindex;
 
     return arenaindex_temp < maxarenas &&
-           (uptr)P - arenas[arenaindex_temp].address < (uptr)ARENA_SIZE &&
+           (uptr)P - arenas[arenaindex_temp].address < (uptr)arena_size &&
            arenas[arenaindex_temp].address != 0;
 }
 #endif
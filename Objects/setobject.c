@@ -63,8 +63,16 @@ This is based on Algorithm D from Knuth Vol. 3, Sec. 6.4.
 Open addressing is preferred over chaining since the link overhead for
 chaining would be substantial (100% with typical malloc overhead).
 
-The initial probe index is computed as hash mod the table size. Subsequent
-probe indices are computed as explained in Objects/dictobject.c.
+The initial probe index is computed as hash mod the table size.  That
+entry and the LINEAR_PROBES entries after it are probed in turn: they are
+next to each other in memory, so a group costs about one cache miss, and
+a hash that doesn't match is turned down without looking at the key.
+Only then does the search jump to the next group, computed from the
+perturbed hash much as explained in Objects/dictobject.c, except that each
+jump shifts in as many new hash bits as the mask has.  Hashes that share
+their low bits, such as those of i << 20, all start in the same group, and
+shifting by PERTURB_SHIFT would lead them through several more groups
+together, each of which they would scan in full.
 
 All arithmetic on hash should ignore overflow.
 
@@ -72,81 +80,103 @@ Unlike the dictionary implementation, the lookkey functions can return
 NULL if the rich comparison returns an error.
 */
 
+/* Number of entries probed after the home entry before jumping.  The group
+   of 10 is 160 bytes of 16-byte setentries on 64-bit platforms: three or four
+   64-byte cache lines, read in order, which costs little more than the miss
+   on the first.  A group that would run past the end of the table is
+   skipped: the jump is taken straight from the home entry. */
+#define LINEAR_PROBES 9
+
+/* Compare key with the key of an active entry of the same hash.  Returns
+ * 1 if they are equal, 0 if not, -1 on error, or 2 if the comparison
+ * changed the table, and the lookup must start over.
+ */
+Py_LOCAL_INLINE(int)
+set_compare_key(PySetObject *so, setentry *entry, PyObject *key)
+{
+    setentry *table = so->table;
+    PyObject *startkey = entry->key;
+    int cmp;
+
+    /* comparing two ints runs no code that could change the set */
+    if (PyInt_CheckExact(startkey) && PyInt_CheckExact(key))
+        return PyInt_AS_LONG(startkey) == PyInt_AS_LONG(key);
+
+    Py_INCREF(startkey);
+    cmp = PyObject_RichCompareBool(startkey, key, Py_EQ);
+    Py_DECREF(startkey);
+    if (cmp < 0)
+        return -1;
+    if (table == so->table && entry->key == startkey)
+        return cmp > 0;
+    /* The compare did major nasty stuff to the set */
+    return 2;
+}
+
 static setentry *
 set_lookkey(PySetObject *so, PyObject *key, register long hash)
 {
-    register Py_ssize_t i;
-    register size_t perturb;
-    register setentry *freeslot;
-    register size_t mask = so->mask;
     setentry *table = so->table;
+    setentry *freeslot = NULL;
     register setentry *entry;
-    register int cmp;
-    PyObject *startkey;
+    register size_t perturb = hash;
+    int shift = 0;
+    register size_t mask = so->mask;
+    size_t i = (size_t)hash & mask;
+    size_t j;
+    int cmp;
 
-    i = hash & mask;
     entry = &table[i];
-    if (entry->key == NULL || entry->key == key)
+    if (entry->key == NULL)
         return entry;
 
-    if (entry->key == dummy)
-        freeslot = entry;
-    else {
-        if (entry->hash == hash) {
-            startkey = entry->key;
-            Py_INCREF(startkey);
-            cmp = PyObject_RichCompareBool(startkey, key, Py_EQ);
-            Py_DECREF(startkey);
-            if (cmp < 0)
-                return NULL;
-            if (table == so->table && entry->key == startkey) {
-                if (cmp > 0)
-                    return entry;
-            }
-            else {
-                /* The compare did major nasty stuff to the
-                 * set:  start over.
-                 */
-                return set_lookkey(so, key, hash);
-            }
-        }
-        freeslot = NULL;
-    }
-
-    /* In the loop, key == dummy is by far (factor of 100s) the
-       least likely outcome, so test for that last. */
-    for (perturb = hash; ; perturb >>= PERTURB_SHIFT) {
-        i = (i << 2) + i + perturb + 1;
-        entry = &table[i & mask];
-        if (entry->key == NULL) {
-            if (freeslot != NULL)
-                entry = freeslot;
-            break;
-        }
+    for (;;) {
         if (entry->key == key)
-            break;
+            return entry;
         if (entry->hash == hash && entry->key != dummy) {
-            startkey = entry->key;
-            Py_INCREF(startkey);
-            cmp = PyObject_RichCompareBool(startkey, key, Py_EQ);
-            Py_DECREF(startkey);
+            cmp = set_compare_key(so, entry, key);
             if (cmp < 0)
                 return NULL;
-            if (table == so->table && entry->key == startkey) {
-                if (cmp > 0)
-                    break;
-            }
-            else {
-                /* The compare did major nasty stuff to the
-                 * set:  start over.
-                 */
+            if (cmp == 2)
                 return set_lookkey(so, key, hash);
-            }
+            if (cmp)
+                return entry;
         }
         else if (entry->key == dummy && freeslot == NULL)
             freeslot = entry;
+
+        if (i + LINEAR_PROBES <= mask) {
+            for (j = 0; j < LINEAR_PROBES; j++) {
+                entry++;
+                if (entry->key == NULL)
+                    goto found_null;
+                if (entry->key == key)
+                    return entry;
+                if (entry->hash == hash && entry->key != dummy) {
+                    cmp = set_compare_key(so, entry, key);
+                    if (cmp < 0)
+                        return NULL;
+                    if (cmp == 2)
+                        return set_lookkey(so, key, hash);
+                    if (cmp)
+                        return entry;
+                }
+                else if (entry->key == dummy && freeslot == NULL)
+                    freeslot = entry;
+            }
+        }
+
+        if (shift == 0)
+            while ((mask >> ++shift) != 0)
+                ;
+        perturb >>= shift;
+        i = (i * 5 + 1 + perturb) & mask;
+        entry = &table[i];
+        if (entry->key == NULL)
+            goto found_null;
     }
-    return entry;
+  found_null:
+    return freeslot == NULL ? entry : freeslot;
 }
 
 /*
@@ -157,12 +187,14 @@ set_lookkey(PySetObject *so, PyObject *key, register long hash)
 static setentry *
 set_lookkey_string(PySetObject *so, PyObject *key, register long hash)
 {
-    register Py_ssize_t i;
-    register size_t perturb;
-    register setentry *freeslot;
-    register size_t mask = so->mask;
     setentry *table = so->table;
+    setentry *freeslot = NULL;
     register setentry *entry;
+    register size_t perturb = hash;
+    int shift = 0;
+    register size_t mask = so->mask;
+    size_t i = (size_t)hash & mask;
+    size_t j;
 
     /* Make sure this function doesn't have to handle non-string keys,
        including subclasses of str; e.g., one reason to subclass
@@ -172,25 +204,12 @@ set_lookkey_string(PySetObject *so, PyObject *key, register long hash)
         so->lookup = set_lookkey;
         return set_lookkey(so, key, hash);
     }
-    i = hash & mask;
+
     entry = &table[i];
-    if (entry->key == NULL || entry->key == key)
+    if (entry->key == NULL)
         return entry;
-    if (entry->key == dummy)
-        freeslot = entry;
-    else {
-        if (entry->hash == hash && _PyString_Eq(entry->key, key))
-            return entry;
-        freeslot = NULL;
-    }
 
-    /* In the loop, key == dummy is by far (factor of 100s) the
-       least likely outcome, so test for that last. */
-    for (perturb = hash; ; perturb >>= PERTURB_SHIFT) {
-        i = (i << 2) + i + perturb + 1;
-        entry = &table[i & mask];
-        if (entry->key == NULL)
-            return freeslot == NULL ? entry : freeslot;
+    for (;;) {
         if (entry->key == key
             || (entry->hash == hash
             && entry->key != dummy
@@ -198,9 +217,33 @@ set_lookkey_string(PySetObject *so, PyObject *key, register long hash)
             return entry;
         if (entry->key == dummy && freeslot == NULL)
             freeslot = entry;
+
+        if (i + LINEAR_PROBES <= mask) {
+            for (j = 0; j < LINEAR_PROBES; j++) {
+                entry++;
+                if (entry->key == NULL)
+                    goto found_null;
+                if (entry->key == key
+                    || (entry->hash == hash
+                    && entry->key != dummy
+                    && _PyString_Eq(entry->key, key)))
+                    return entry;
+                if (entry->key == dummy && freeslot == NULL)
+                    freeslot = entry;
+            }
+        }
+
+        if (shift == 0)
+            while ((mask >> ++shift) != 0)
+                ;
+        perturb >>= shift;
+        i = (i * 5 + 1 + perturb) & mask;
+        entry = &table[i];
+        if (entry->key == NULL)
+            goto found_null;
     }
-    assert(0);          /* NOT REACHED */
-    return 0;
+  found_null:
+    return freeslot == NULL ? entry : freeslot;
 }
 
 /*
@@ -248,18 +291,33 @@ is responsible for incref'ing `key`.
 static void
 set_insert_clean(register PySetObject *so, PyObject *key, long hash)
 {
-    register size_t i;
-    register size_t perturb;
-    register size_t mask = (size_t)so->mask;
     setentry *table = so->table;
     register setentry *entry;
+    register size_t perturb = hash;
+    int shift = 0;
+    register size_t mask = (size_t)so->mask;
+    size_t i = (size_t)hash & mask;
+    size_t j;
 
-    i = hash & mask;
-    entry = &table[i];
-    for (perturb = hash; entry->key != NULL; perturb >>= PERTURB_SHIFT) {
-        i = (i << 2) + i + perturb + 1;
-        entry = &table[i & mask];
+    /* the same probes as set_lookkey() */
+    for (;;) {
+        entry = &table[i];
+        if (entry->key == NULL)
+            goto found_null;
+        if (i + LINEAR_PROBES <= mask) {
+            for (j = 0; j < LINEAR_PROBES; j++) {
+                entry++;
+                if (entry->key == NULL)
+                    goto found_null;
+            }
+        }
+        if (shift == 0)
+            while ((mask >> ++shift) != 0)
+                ;
+        perturb >>= shift;
+        i = (i * 5 + 1 + perturb) & mask;
     }
+  found_null:
     so->fill++;
     entry->key = key;
     entry->hash = hash;
@@ -669,6 +727,38 @@ set_merge(PySetObject *so, PyObject *otherset)
        if (set_table_resize(so, (so->used + other->used)*2) != 0)
            return -1;
     }
+    if (so->fill == 0) {
+        /* Nothing to compare against, and the keys of other are distinct,
+         * so they can go straight into free slots with their stored
+         * hashes.
+         */
+        if (other->lookup != set_lookkey_string)
+            so->lookup = set_lookkey;
+        if (so->mask == other->mask && other->fill == other->used) {
+            /* Same table size and no dummies to drop (as for copies of
+             * a frozenset): each key lands in the slot it has in other.
+             */
+            for (i = 0; i <= other->mask; i++) {
+                entry = &other->table[i];
+                if (entry->key != NULL) {
+                    Py_INCREF(entry->key);
+                    so->table[i] = *entry;
+                }
+            }
+            so->fill = other->fill;
+            so->used = other->used;
+            return 0;
+        }
+        for (i = 0; i <= other->mask; i++) {
+            entry = &other->table[i];
+            key = entry->key;
+            if (key != NULL && key != dummy) {
+                Py_INCREF(key);
+                set_insert_clean(so, key, entry->hash);
+            }
+        }
+        return 0;
+    }
     for (i = 0; i <= other->mask; i++) {
         entry = &other->table[i];
         key = entry->key;
@@ -1039,6 +1129,23 @@ make_new_set(PyTypeObject *type, PyObject *iterable)
     return (PyObject *)so;
 }
 
+/* A frozenset never grows, so its table needs no room to grow into.
+ * Rebuild the table of a new one, when that at least halves its size, to
+ * be at most half full, as set_merge() presizes tables.  Sets of many small
+ * ints or strings take little memory besides their tables.
+ */
+static PyObject *
+frozenset_compact(PyObject *result)
+{
+    PySetObject *so = (PySetObject *)result;
+
+    if (so != NULL && (so->mask + 1) / 2 > so->used * 2 &&
+        set_table_resize(so, so->used * 2) != 0)
+        /* keep the larger table */
+        PyErr_Clear();
+    return result;
+}
+
 /* The empty frozenset is a singleton */
 static PyObject *emptyfrozenset = NULL;
 
@@ -1054,7 +1161,7 @@ frozenset_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
         return NULL;
 
     if (type != &PyFrozenSet_Type)
-        return make_new_set(type, iterable);
+        return frozenset_compact(make_new_set(type, iterable));
 
     if (iterable != NULL) {
         /* frozenset(f) is idempotent */
@@ -1062,7 +1169,7 @@ frozenset_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
             Py_INCREF(iterable);
             return iterable;
         }
-        result = make_new_set(type, iterable);
+        result = frozenset_compact(make_new_set(type, iterable));
         if (result == NULL || PySet_GET_SIZE(result))
             return result;
         Py_DECREF(result);
@@ -1175,19 +1282,51 @@ set_clear(PySetObject *so)
 
 PyDoc_STRVAR(clear_doc, "Remove all elements from this set.");
 
+/* A union of several operands is presized for the most keys it can get,
+ * which may be far more than it ends up with.  Give such a table back once
+ * it is sparser than growing one key at a time would have left it.
+ */
+static void
+set_trim_result(PySetObject *so)
+{
+    if (so->mask + 1 > PySet_MINSIZE && so->mask + 1 > so->used * 8 &&
+        set_table_resize(so, so->used * 4) != 0)
+        /* keep the larger table */
+        PyErr_Clear();
+}
+
+/* Build the union of so and others[0:n] in a single table, sized up front
+ * for all operands whose length is known without iterating them.
+ */
 static PyObject *
-set_union(PySetObject *so, PyObject *args)
+set_union_internal(PySetObject *so, PyObject **others, Py_ssize_t n)
 {
     PySetObject *result;
     PyObject *other;
-    Py_ssize_t i;
+    Py_ssize_t i, size = so->used;
+
+    for (i = 0; i < n; i++) {
+        other = others[i];
+        if (PyAnySet_Check(other) && other != (PyObject *)so)
+            size += PySet_GET_SIZE(other);
+        else if (PyDict_CheckExact(other))
+            size += PyDict_Size(other);
+    }
 
-    result = (PySetObject *)set_copy(so);
+    result = (PySetObject *)make_new_set(Py_TYPE(so), NULL);
     if (result == NULL)
         return NULL;
-
-    for (i=0 ; i<PyTuple_GET_SIZE(args) ; i++) {
-        other = PyTuple_GET_ITEM(args, i);
+    if (size*3 >= (result->mask+1)*2 &&
+        set_table_resize(result, size*2) != 0) {
+        Py_DECREF(result);
+        return NULL;
+    }
+    if (set_merge(result, (PyObject *)so) == -1) {
+        Py_DECREF(result);
+        return NULL;
+    }
+    for (i = 0; i < n; i++) {
+        other = others[i];
         if ((PyObject *)so == other)
             continue;
         if (set_update_internal(result, other) == -1) {
@@ -1195,9 +1334,18 @@ set_union(PySetObject *so, PyObject *args)
             return NULL;
         }
     }
+    if (n > 1)
+        set_trim_result(result);
     return (PyObject *)result;
 }
 
+static PyObject *
+set_union(PySetObject *so, PyObject *args)
+{
+    return set_union_internal(so, &PyTuple_GET_ITEM(args, 0),
+                              PyTuple_GET_SIZE(args));
+}
+
 PyDoc_STRVAR(union_doc,
  "Return the union of sets as a new set.\n\
 \n\
@@ -1206,23 +1354,11 @@ PyDoc_STRVAR(union_doc,
 static PyObject *
 set_or(PySetObject *so, PyObject *other)
 {
-    PySetObject *result;
-
     if (!PyAnySet_Check(so) || !PyAnySet_Check(other)) {
         Py_INCREF(Py_NotImplemented);
         return Py_NotImplemented;
     }
-
-    result = (PySetObject *)set_copy(so);
-    if (result == NULL)
-        return NULL;
-    if ((PyObject *)so == other)
-        return (PyObject *)result;
-    if (set_update_internal(result, other) == -1) {
-        Py_DECREF(result);
-        return NULL;
-    }
-    return (PyObject *)result;
+    return set_union_internal(so, &other, 1);
 }
 
 static PyObject *
@@ -1238,37 +1374,105 @@ set_ior(PySetObject *so, PyObject *other)
     return (PyObject *)so;
 }
 
+/* Intersect so with the sets others[0:n].  The smallest operand is walked
+ * once, and each of its keys is looked up in the others with the hash it
+ * has stored, so no key is hashed again.  The result grows as keys are
+ * added: a table sized for the smallest operand costs more to clear and
+ * walk than growing does, unless nearly every key is shared.
+ */
+static PyObject *
+set_intersection_sets(PySetObject *so, PyObject **others, Py_ssize_t n)
+{
+    PySetObject *result, *smallest = so, *other;
+    Py_ssize_t i, pos = 0;
+    setentry *entry;
+    int rv;
+
+    /* Of equal keys, the one kept is from the operand walked.  As with
+       pairwise intersections, that is the last of the smallest ones. */
+    for (i = 0; i < n; i++) {
+        other = (PySetObject *)others[i];
+        if (other->used <= smallest->used)
+            smallest = other;
+    }
+
+    result = (PySetObject *)make_new_set(Py_TYPE(so), NULL);
+    if (result == NULL)
+        return NULL;
+
+    while (set_next(smallest, &pos, &entry)) {
+        rv = 1;
+        if (smallest != so)
+            rv = set_contains_entry(so, entry);
+        for (i = 0; rv == 1 && i < n; i++) {
+            other = (PySetObject *)others[i];
+            if (other != smallest)
+                rv = set_contains_entry(other, entry);
+        }
+        if (rv == 1)
+            rv = set_add_entry(result, entry);
+        if (rv == -1)
+            goto error;
+    }
+    return (PyObject *)result;
+
+  error:
+    Py_DECREF(result);
+    return NULL;
+}
+
 static PyObject *
 set_intersection(PySetObject *so, PyObject *other)
 {
     PySetObject *result;
-    PyObject *key, *it, *tmp;
+    PyObject *key, *value, *it;
+    Py_ssize_t pos = 0;
+    long hash;
 
     if ((PyObject *)so == other)
         return set_copy(so);
 
+    if (PyAnySet_Check(other))
+        return set_intersection_sets(so, &other, 1);
+
     result = (PySetObject *)make_new_set(Py_TYPE(so), NULL);
     if (result == NULL)
         return NULL;
 
-    if (PyAnySet_Check(other)) {
-        Py_ssize_t pos = 0;
-        setentry *entry;
-
-        if (PySet_GET_SIZE(other) > PySet_GET_SIZE(so)) {
-            tmp = (PyObject *)so;
-            so = (PySetObject *)other;
-            other = tmp;
-        }
+    if (PyDict_CheckExact(other)) {
+        /* Walk the smaller of the two, reusing the hashes both keep.
+           Either way, of equal keys the dict's is kept. */
+        setentry *entry, found;
+        int rv;
 
-        while (set_next((PySetObject *)other, &pos, &entry)) {
-            int rv = set_contains_entry(so, entry);
-            if (rv == -1) {
-                Py_DECREF(result);
-                return NULL;
+        if (PyDict_Size(other) < so->used) {
+            while (_PyDict_Next(other, &pos, &key, &value, &hash)) {
+                found.key = key;
+                found.hash = hash;
+                rv = set_contains_entry(so, &found);
+                if (rv == 1)
+                    rv = set_add_entry(result, &found);
+                if (rv == -1) {
+                    Py_DECREF(result);
+                    return NULL;
+                }
             }
-            if (rv) {
-                if (set_add_entry(result, entry) == -1) {
+        }
+        else {
+            while (set_next(so, &pos, &entry)) {
+                found.key = _PyDict_GetStoredKey(other, entry->key,
+                                                 entry->hash);
+                found.hash = entry->hash;
+                rv = 0;
+                if (found.key != NULL) {
+                    /* the compares of set_add_entry() may change other */
+                    Py_INCREF(found.key);
+                    rv = set_add_entry(result, &found);
+                    Py_DECREF(found.key);
+                }
+                else if (PyErr_Occurred())
+                    rv = -1;
+                if (rv == -1) {
                     Py_DECREF(result);
                     return NULL;
                 }
@@ -1286,8 +1490,8 @@ set_intersection(PySetObject *so, PyObject *other)
     while ((key = PyIter_Next(it)) != NULL) {
         int rv;
         setentry entry;
-        long hash = PyObject_Hash(key);
 
+        hash = PyObject_Hash(key);
         if (hash == -1) {
             Py_DECREF(it);
             Py_DECREF(result);
@@ -1330,6 +1534,14 @@ set_intersection_multi(PySetObject *so, PyObject *args)
     if (PyTuple_GET_SIZE(args) == 0)
         return set_copy(so);
 
+    /* Sets are intersected all at once, into a single new table. */
+    for (i=0 ; i<PyTuple_GET_SIZE(args) ; i++)
+        if (!PyAnySet_Check(PyTuple_GET_ITEM(args, i)))
+            break;
+    if (i == PyTuple_GET_SIZE(args))
+        return set_intersection_sets(so, &PyTuple_GET_ITEM(args, 0),
+                                     PyTuple_GET_SIZE(args));
+
     Py_INCREF(so);
     for (i=0 ; i<PyTuple_GET_SIZE(args) ; i++) {
         PyObject *other = PyTuple_GET_ITEM(args, i);
@@ -1482,9 +1694,31 @@ set_difference_update_internal(PySetObject *so, PyObject *other)
         setentry *entry;
         Py_ssize_t pos = 0;
 
+        /* When other is much larger, only the keys it shares with so
+           need removing, and those are found by walking so. */
+        if (PySet_GET_SIZE(other) / 8 > so->used) {
+            other = set_intersection_sets(so, &other, 1);
+            if (other == NULL)
+                return -1;
+        }
+        else
+            Py_INCREF(other);
         while (set_next((PySetObject *)other, &pos, &entry))
-            if (set_discard_entry(so, entry) == -1)
+            if (set_discard_entry(so, entry) == -1) {
+                Py_DECREF(other);
+                return -1;
+            }
+        Py_DECREF(other);
+    } else if (PyDict_CheckExact(other)) {
+        PyObject *key, *value;
+        Py_ssize_t pos = 0;
+        setentry an_entry;
+
+        while (_PyDict_Next(other, &pos, &key, &value, &an_entry.hash)) {
+            an_entry.key = key;
+            if (set_discard_entry(so, &an_entry) == -1)
                 return -1;
+        }
     } else {
         PyObject *key, *it;
         it = PyObject_GetIter(other);
@@ -1528,53 +1762,47 @@ PyDoc_STRVAR(difference_update_doc,
 static PyObject *
 set_difference(PySetObject *so, PyObject *other)
 {
-    PyObject *result;
+    PySetObject *result;
     setentry *entry;
-    Py_ssize_t pos = 0;
+    Py_ssize_t pos = 0, other_size;
+    int rv;
+
+    if (PyAnySet_Check(other))
+        other_size = PySet_GET_SIZE(other);
+    else if (PyDict_CheckExact(other))
+        other_size = PyDict_Size(other);
+    else
+        other_size = -1;
 
-    if (!PyAnySet_Check(other)  && !PyDict_CheckExact(other)) {
-        result = set_copy(so);
+    /* Unless other is comparable in size to so, copying so (which needs
+       no lookups) and removing other's keys from the copy is cheaper than
+       looking every key of so up in other. */
+    if (other_size < 0 || other_size < so->used / 4) {
+        result = (PySetObject *)set_copy(so);
         if (result == NULL)
             return NULL;
-        if (set_difference_update_internal((PySetObject *)result, other) != -1)
-            return result;
+        if (set_difference_update_internal(result, other) != -1)
+            return (PyObject *)result;
         Py_DECREF(result);
         return NULL;
     }
 
-    result = make_new_set(Py_TYPE(so), NULL);
+    result = (PySetObject *)make_new_set(Py_TYPE(so), NULL);
     if (result == NULL)
         return NULL;
-
-    if (PyDict_CheckExact(other)) {
-        while (set_next(so, &pos, &entry)) {
-            setentry entrycopy;
-            entrycopy.hash = entry->hash;
-            entrycopy.key = entry->key;
-            if (!_PyDict_Contains(other, entry->key, entry->hash)) {
-                if (set_add_entry((PySetObject *)result, &entrycopy) == -1) {
-                    Py_DECREF(result);
-                    return NULL;
-                }
-            }
-        }
-        return result;
-    }
-
     while (set_next(so, &pos, &entry)) {
-        int rv = set_contains_entry((PySetObject *)other, entry);
+        if (PyDict_CheckExact(other))
+            rv = _PyDict_Contains(other, entry->key, entry->hash);
+        else
+            rv = set_contains_entry((PySetObject *)other, entry);
+        if (rv == 0)
+            rv = set_add_entry(result, entry);
         if (rv == -1) {
             Py_DECREF(result);
             return NULL;
         }
-        if (!rv) {
-            if (set_add_entry((PySetObject *)result, entry) == -1) {
-                Py_DECREF(result);
-                return NULL;
-            }
-        }
     }
-    return result;
+    return (PyObject *)result;
 }
 
 static PyObject *
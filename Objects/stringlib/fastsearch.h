@@ -18,6 +18,8 @@
 #define FAST_SEARCH 1
 #define FAST_RSEARCH 2
 
+#include "vecsearch.h"
+
 #if LONG_BIT >= 128
 #define STRINGLIB_BLOOM_WIDTH 128
 #elif LONG_BIT >= 64
@@ -52,26 +54,25 @@ fastsearch(const STRINGLIB_CHAR* s, Py_ssize_t n,
         if (m <= 0)
             return -1;
         /* use special case for 1-character strings */
-        if (mode == FAST_COUNT) {
-            for (i = 0; i < n; i++)
-                if (s[i] == p[0]) {
-                    count++;
-                    if (count == maxcount)
-                        return maxcount;
-                }
-            return count;
-        } else if (mode == FAST_SEARCH) {
-            for (i = 0; i < n; i++)
-                if (s[i] == p[0])
-                    return i;
-        } else {    /* FAST_RSEARCH */
-            for (i = n - 1; i > -1; i--)
-                if (s[i] == p[0])
-                    return i;
-        }
-        return -1;
+        if (mode == FAST_COUNT)
+            return stringlib_count_char(s, n, p[0], maxcount);
+        else if (mode == FAST_SEARCH)
+            return stringlib_find_char(s, n, p[0]);
+        else    /* FAST_RSEARCH */
+            return stringlib_rfind_char(s, n, p[0]);
     }
 
+#ifdef STRINGLIB_VECSEARCH
+    if (m <= STRINGLIB_VECSEARCH_MAXLEN) {
+        if (mode == FAST_COUNT)
+            return stringlib_vec_count(s, n, p, m, maxcount);
+        else if (mode == FAST_SEARCH)
+            return stringlib_vec_find(s, n, p, m);
+        else    /* FAST_RSEARCH */
+            return stringlib_vec_rfind(s, n, p, m);
+    }
+#endif
+
     mlast = m - 1;
     skip = mlast - 1;
     mask = 0;
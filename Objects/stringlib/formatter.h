@@ -710,6 +710,9 @@ format_string_internal(PyObject *value, const InternalFormatSpec *format)
 
     calc_padding(len, format->width, format->align, &lpad, &rpad, &total);
 
+    if (STRINGLIB_STR(value) == NULL)
+        goto done;
+
     /* allocate the resulting string */
     result = STRINGLIB_NEW(NULL, total);
     if (result == NULL)
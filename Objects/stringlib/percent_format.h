@@ -0,0 +1,403 @@
+/* stringlib: parsing of printf-style format strings, with a cache */
+
+#ifndef STRINGLIB_PERCENT_FORMAT_H
+#define STRINGLIB_PERCENT_FORMAT_H
+
+/* format % args used to parse the format string again on every call, a
+   character at a time, while converting the arguments.  Instead, the
+   format is split once into its conversion specifiers, each with the
+   literal text before it, and the result is kept in a small cache keyed
+   by the format object, so that formatting with the same string
+   constant again only walks the list.
+
+   The parse error of a malformed specifier is recorded in it, and
+   raised only when the formatting gets there, at the same point as
+   before: a format string that is cut short still reports a missing
+   argument or a failed mapping lookup before it.
+
+   The including file defines getnextarg() and the F_* flags, and calls
+   stringlib_format_forget() whenever a string object goes away or has
+   its characters changed in place. */
+
+/* width or precision given as '*' */
+#define FORMAT_STAR (-2)
+
+/* status of a specifier */
+#define FORMAT_CONVERT 0        /* the usual */
+#define FORMAT_END 1            /* the literal text after the last one */
+#define FORMAT_BAD_KEY 2        /* '(' without the matching ')' */
+#define FORMAT_BIG_WIDTH 3      /* width overflows */
+#define FORMAT_BIG_PREC 4       /* precision overflows */
+#define FORMAT_INCOMPLETE 5     /* the format ends within the specifier */
+
+typedef struct {
+    Py_ssize_t lit;             /* the literal text before the specifier */
+    Py_ssize_t litlen;
+    Py_ssize_t start;           /* index of the '%' */
+    Py_ssize_t pos;             /* index of the type character */
+    PyObject *key;              /* mapping key, or NULL */
+    Py_ssize_t width;           /* -1 if none */
+    int prec;                   /* -1 if none */
+    int flags;
+    int status;
+    int c;                      /* the type character */
+} StringlibFormatSpec;
+
+typedef struct {
+    Py_ssize_t refcnt;          /* the cache and the calls using it */
+    Py_ssize_t size_hint;       /* the length of the last result */
+    Py_ssize_t nspecs;          /* including the FORMAT_END one */
+    StringlibFormatSpec specs[1];
+} StringlibFormatCode;
+
+/* the digits of a width or precision are read as unsigned characters,
+   the flags and the type character as they are: in a str format, the
+   error message shows a byte over 0x7f as a negative number unless it
+   comes after digits */
+#if STRINGLIB_IS_UNICODE
+#define FORMAT_CHARMASK(c) (c)
+#else
+#define FORMAT_CHARMASK(c) Py_CHARMASK(c)
+#endif
+
+#define FORMAT_CACHE_SIZE 64
+#define FORMAT_CACHE_SLOT(op) \
+    ((((size_t)(op) >> 4) ^ ((size_t)(op) >> 10)) & (FORMAT_CACHE_SIZE - 1))
+
+/* the format objects are borrowed references, which the deallocator
+   clears through stringlib_format_forget() */
+static struct {
+    PyObject *format;
+    StringlibFormatCode *code;
+} stringlib_format_cache[FORMAT_CACHE_SIZE];
+
+static void
+stringlib_format_release(StringlibFormatCode *code)
+{
+    Py_ssize_t i;
+
+    if (--code->refcnt > 0)
+        return;
+    for (i = 0; i < code->nspecs; i++)
+        Py_XDECREF(code->specs[i].key);
+    PyMem_FREE(code);
+}
+
+Py_LOCAL_INLINE(void)
+stringlib_format_forget(PyObject *format)
+{
+    size_t slot = FORMAT_CACHE_SLOT(format);
+    StringlibFormatCode *code;
+
+    if (stringlib_format_cache[slot].format == format) {
+        code = stringlib_format_cache[slot].code;
+        stringlib_format_cache[slot].format = NULL;
+        stringlib_format_cache[slot].code = NULL;
+        stringlib_format_release(code);
+    }
+}
+
+static void
+stringlib_format_clear_cache(void)
+{
+    size_t slot;
+
+    for (slot = 0; slot < FORMAT_CACHE_SIZE; slot++)
+        if (stringlib_format_cache[slot].format != NULL)
+            stringlib_format_forget(stringlib_format_cache[slot].format);
+}
+
+/* Split fmt[0:length] into specifiers.  This follows the old loop of
+   PyString_Format() character by character, so that it accepts and
+   rejects the same strings. */
+static StringlibFormatCode *
+stringlib_format_compile(const STRINGLIB_CHAR *format, Py_ssize_t length)
+{
+    StringlibFormatCode *code;
+    StringlibFormatSpec *spec;
+    const STRINGLIB_CHAR *fmt, *keystart;
+    Py_ssize_t fmtcnt, n, lit, litlen = 0;
+    int c, pcount;
+
+    n = 1;
+    for (fmtcnt = 0; fmtcnt < length; fmtcnt++)
+        if (format[fmtcnt] == '%')
+            n++;
+    if (n > (PY_SSIZE_T_MAX - sizeof(StringlibFormatCode)) /
+        sizeof(StringlibFormatSpec)) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    code = (StringlibFormatCode *)PyMem_MALLOC(
+        sizeof(StringlibFormatCode) + (n - 1) * sizeof(StringlibFormatSpec));
+    if (code == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    code->refcnt = 1;
+    code->nspecs = 0;
+
+    fmt = format;
+    fmtcnt = length;
+    lit = 0;
+    while (--fmtcnt >= 0) {
+        if (*fmt != '%') {
+            fmt++;
+            continue;
+        }
+        spec = &code->specs[code->nspecs++];
+        spec->lit = lit;
+        spec->litlen = (fmt - format) - lit;
+        litlen += spec->litlen;
+        spec->start = fmt - format;
+        spec->pos = -1;
+        spec->key = NULL;
+        spec->width = -1;
+        spec->prec = -1;
+        spec->flags = 0;
+        spec->status = FORMAT_CONVERT;
+        c = '\0';
+
+        fmt++;
+        if (*fmt == '(') {
+            pcount = 1;
+            ++fmt;
+            --fmtcnt;
+            keystart = fmt;
+            /* Skip over balanced parentheses */
+            while (pcount > 0 && --fmtcnt >= 0) {
+                if (*fmt == ')')
+                    --pcount;
+                else if (*fmt == '(')
+                    ++pcount;
+                fmt++;
+            }
+            if (fmtcnt < 0 || pcount > 0) {
+                spec->status = FORMAT_BAD_KEY;
+                break;
+            }
+            spec->key = STRINGLIB_NEW(keystart, fmt - keystart - 1);
+            if (spec->key == NULL)
+                goto error;
+        }
+        while (--fmtcnt >= 0) {
+            switch (c = *fmt++) {
+            case '-': spec->flags |= F_LJUST; continue;
+            case '+': spec->flags |= F_SIGN; continue;
+            case ' ': spec->flags |= F_BLANK; continue;
+            case '#': spec->flags |= F_ALT; continue;
+            case '0': spec->flags |= F_ZERO; continue;
+            }
+            break;
+        }
+        if (c == '*') {
+            spec->width = FORMAT_STAR;
+            if (--fmtcnt >= 0)
+                c = *fmt++;
+        }
+        else if (c >= '0' && c <= '9') {
+            spec->width = c - '0';
+            while (--fmtcnt >= 0) {
+                c = FORMAT_CHARMASK(*fmt++);
+                if (c < '0' || c > '9')
+                    break;
+                if ((spec->width*10) / 10 != spec->width) {
+                    spec->status = FORMAT_BIG_WIDTH;
+                    break;
+                }
+                spec->width = spec->width*10 + (c - '0');
+            }
+            if (spec->status != FORMAT_CONVERT)
+                break;
+        }
+        if (c == '.') {
+            spec->prec = 0;
+            if (--fmtcnt >= 0)
+                c = *fmt++;
+            if (c == '*') {
+                spec->prec = FORMAT_STAR;
+                if (--fmtcnt >= 0)
+                    c = *fmt++;
+            }
+            else if (c >= '0' && c <= '9') {
+                spec->prec = c - '0';
+                while (--fmtcnt >= 0) {
+                    c = FORMAT_CHARMASK(*fmt++);
+                    if (c < '0' || c > '9')
+                        break;
+                    if ((spec->prec*10) / 10 != spec->prec) {
+                        spec->status = FORMAT_BIG_PREC;
+                        break;
+                    }
+                    spec->prec = spec->prec*10 + (c - '0');
+                }
+                if (spec->status != FORMAT_CONVERT)
+                    break;
+            }
+        }
+        if (fmtcnt >= 0) {
+            if (c == 'h' || c == 'l' || c == 'L') {
+                if (--fmtcnt >= 0)
+                    c = *fmt++;
+            }
+        }
+        if (fmtcnt < 0) {
+            spec->status = FORMAT_INCOMPLETE;
+            break;
+        }
+        spec->c = c;
+        spec->pos = fmt - 1 - format;
+        lit = fmt - format;
+    }
+    if (fmtcnt < 0 && (code->nspecs == 0 ||
+                       code->specs[code->nspecs - 1].status ==
+                       FORMAT_CONVERT)) {
+        spec = &code->specs[code->nspecs++];
+        spec->lit = lit;
+        spec->litlen = length - lit;
+        litlen += spec->litlen;
+        spec->key = NULL;
+        spec->status = FORMAT_END;
+    }
+    /* a first guess, corrected after every use */
+    code->size_hint = litlen + 8 * code->nspecs;
+    return code;
+
+  error:
+    stringlib_format_release(code);
+    return NULL;
+}
+
+/* Return the parsed format, with a new reference to it that the caller
+   gives back with stringlib_format_release(). */
+static StringlibFormatCode *
+stringlib_format_code(PyObject *format)
+{
+    size_t slot = FORMAT_CACHE_SLOT(format);
+    StringlibFormatCode *code;
+
+    if (stringlib_format_cache[slot].format == format) {
+        code = stringlib_format_cache[slot].code;
+        code->refcnt++;
+        return code;
+    }
+    code = stringlib_format_compile(STRINGLIB_STR(format),
+                                    STRINGLIB_LEN(format));
+    if (code == NULL)
+        return NULL;
+    if (stringlib_format_cache[slot].format != NULL)
+        stringlib_format_forget(stringlib_format_cache[slot].format);
+    stringlib_format_cache[slot].format = format;
+    stringlib_format_cache[slot].code = code;
+    code->refcnt++;
+    return code;
+}
+
+/* Do what the specifier asks for before the conversion, in the order
+   of the old loop: look up the mapping key, take a '*' width and
+   precision from the arguments, raise the parse error if there is one,
+   and take the value to convert.  Return -1 on error. */
+typedef struct {
+    PyObject *args;
+    Py_ssize_t arglen;
+    Py_ssize_t argidx;
+    int args_owned;
+    PyObject *dict;
+} StringlibFormatArgs;
+
+static int
+stringlib_format_getargs(StringlibFormatSpec *spec, StringlibFormatArgs *fa,
+                         Py_ssize_t *pwidth, int *pprec, int *pflags,
+                         PyObject **pv)
+{
+    PyObject *v;
+
+    *pwidth = spec->width;
+    *pprec = spec->prec;
+    *pflags = spec->flags;
+    *pv = NULL;
+    if (spec->key != NULL || spec->status == FORMAT_BAD_KEY) {
+        if (fa->dict == NULL) {
+            PyErr_SetString(PyExc_TypeError,
+                            "format requires a mapping");
+            return -1;
+        }
+        if (spec->status == FORMAT_BAD_KEY) {
+            PyErr_SetString(PyExc_ValueError,
+                            "incomplete format key");
+            return -1;
+        }
+        if (fa->args_owned) {
+            Py_DECREF(fa->args);
+            fa->args_owned = 0;
+        }
+        fa->args = PyObject_GetItem(fa->dict, spec->key);
+        if (fa->args == NULL)
+            return -1;
+        fa->args_owned = 1;
+        fa->arglen = -1;
+        fa->argidx = -2;
+    }
+    if (spec->width == FORMAT_STAR) {
+        v = getnextarg(fa->args, fa->arglen, &fa->argidx);
+        if (v == NULL)
+            return -1;
+        if (!PyInt_Check(v)) {
+            PyErr_SetString(PyExc_TypeError, "* wants int");
+            return -1;
+        }
+        *pwidth = PyInt_AsLong(v);
+        if (*pwidth < 0) {
+            *pflags |= F_LJUST;
+            *pwidth = -*pwidth;
+        }
+    }
+    if (spec->status == FORMAT_BIG_WIDTH) {
+        PyErr_SetString(PyExc_ValueError, "width too big");
+        return -1;
+    }
+    if (spec->prec == FORMAT_STAR) {
+        v = getnextarg(fa->args, fa->arglen, &fa->argidx);
+        if (v == NULL)
+            return -1;
+        if (!PyInt_Check(v)) {
+            PyErr_SetString(PyExc_TypeError, "* wants int");
+            return -1;
+        }
+        *pprec = PyInt_AsLong(v);
+        if (*pprec < 0)
+            *pprec = 0;
+    }
+    if (spec->status == FORMAT_BIG_PREC) {
+        PyErr_SetString(PyExc_ValueError, "prec too big");
+        return -1;
+    }
+    if (spec->status == FORMAT_INCOMPLETE) {
+        PyErr_SetString(PyExc_ValueError, "incomplete format");
+        return -1;
+    }
+    if (spec->c != '%') {
+        *pv = getnextarg(fa->args, fa->arglen, &fa->argidx);
+        if (*pv == NULL)
+            return -1;
+    }
+    return 0;
+}
+
+/* Write the decimal digits of x so that they end at end, and return
+   where they start */
+Py_LOCAL_INLINE(STRINGLIB_CHAR *)
+stringlib_format_decimal(STRINGLIB_CHAR *end, long x)
+{
+    unsigned long ux = x < 0 ? 0UL - (unsigned long)x : (unsigned long)x;
+
+    do {
+        *--end = (STRINGLIB_CHAR)('0' + ux % 10);
+        ux /= 10;
+    } while (ux);
+    if (x < 0)
+        *--end = '-';
+    return end;
+}
+
+#endif /* !STRINGLIB_PERCENT_FORMAT_H */
@@ -0,0 +1,250 @@
+/* stringlib: vectorized search kernels */
+
+#ifndef STRINGLIB_VECSEARCH_H
+#define STRINGLIB_VECSEARCH_H
+
+/* the innermost loops of fastsearch and split: looking for one
+   character, counting it, looking for the first and last characters
+   of a longer pattern at once, and looking for line breaks.  instead of
+   testing one character per step, a kernel compares a whole vector of
+   characters (16 bytes with SSE2, 32 with AVX2), turns the result into
+   a bit mask with movemask, and locates the hits with a bit scan.
+
+   the kernels are written once, in vecsearch_impl.h, and instantiated
+   for each instruction set.  SSE2 is part of every x86-64 processor and
+   is used whenever the compiler targets it.  the AVX2 versions are
+   compiled with a target attribute, so the rest of the interpreter
+   doesn't need -mavx2, and are picked at run time when the processor
+   supports them.  elsewhere the plain loops below are used, and
+   fastsearch keeps its boyer-moore/horspool loop for all patterns. */
+
+#if defined(STRINGLIB_IS_UNICODE) && STRINGLIB_IS_UNICODE
+#define STRINGLIB_SIZEOF_CHAR Py_UNICODE_SIZE
+#else
+#define STRINGLIB_SIZEOF_CHAR 1
+#endif
+
+#if (defined(__SSE2__) || defined(_M_X64) ||                   \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) &&              \
+    (STRINGLIB_SIZEOF_CHAR == 1 || STRINGLIB_SIZEOF_CHAR == 2 || \
+     STRINGLIB_SIZEOF_CHAR == 4)
+#define STRINGLIB_VECSEARCH 1
+#include <emmintrin.h>
+#endif
+
+#if defined(STRINGLIB_VECSEARCH) && defined(__GNUC__) &&       \
+    (defined(__x86_64__) || defined(__i386__)) &&               \
+    (defined(__clang__) ? __clang_major__ >= 8 :                \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define STRINGLIB_VECSEARCH_AVX2 1
+#include <immintrin.h>
+#endif
+
+/* longest pattern for which fastsearch uses the first/last character
+   filter; longer patterns mostly let horspool skip a whole pattern
+   length per step, which beats testing every position */
+#define STRINGLIB_VECSEARCH_MAXLEN 32
+
+#ifdef STRINGLIB_VECSEARCH
+
+#ifdef _MSC_VER
+#include <intrin.h>
+
+Py_LOCAL_INLINE(int)
+stringlib_ctz(unsigned int x)
+{
+    unsigned long r;
+    _BitScanForward(&r, x);
+    return (int)r;
+}
+
+Py_LOCAL_INLINE(int)
+stringlib_bsr(unsigned int x)
+{
+    unsigned long r;
+    _BitScanReverse(&r, x);
+    return (int)r;
+}
+#else
+#define stringlib_ctz(x) __builtin_ctz(x)
+#define stringlib_bsr(x) (31 - __builtin_clz(x))
+#endif
+
+/* without the popcnt instruction, __builtin_popcount is a call to a
+   table lookup in libgcc, several times slower than this */
+#ifdef __POPCNT__
+#define stringlib_popcount(x) __builtin_popcount(x)
+#else
+Py_LOCAL_INLINE(int)
+stringlib_popcount(unsigned int x)
+{
+    x = x - ((x >> 1) & 0x55555555U);
+    x = (x & 0x33333333U) + ((x >> 2) & 0x33333333U);
+    x = (x + (x >> 4)) & 0x0f0f0f0fU;
+    return (int)((x * 0x01010101U) >> 24);
+}
+#endif
+
+/* movemask yields one bit per byte, so a character that matches sets
+   STRINGLIB_SIZEOF_CHAR adjacent bits, the lane */
+#define VS_LANE ((1U << STRINGLIB_SIZEOF_CHAR) - 1)
+
+#if STRINGLIB_SIZEOF_CHAR == 1
+#define VS_SSE2_SET1(c) _mm_set1_epi8((char)(c))
+#define VS_SSE2_CMPEQ _mm_cmpeq_epi8
+#define VS_AVX2_SET1(c) _mm256_set1_epi8((char)(c))
+#define VS_AVX2_CMPEQ _mm256_cmpeq_epi8
+#elif STRINGLIB_SIZEOF_CHAR == 2
+#define VS_SSE2_SET1(c) _mm_set1_epi16((short)(c))
+#define VS_SSE2_CMPEQ _mm_cmpeq_epi16
+#define VS_AVX2_SET1(c) _mm256_set1_epi16((short)(c))
+#define VS_AVX2_CMPEQ _mm256_cmpeq_epi16
+#else
+#define VS_SSE2_SET1(c) _mm_set1_epi32((int)(c))
+#define VS_SSE2_CMPEQ _mm_cmpeq_epi32
+#define VS_AVX2_SET1(c) _mm256_set1_epi32((int)(c))
+#define VS_AVX2_CMPEQ _mm256_cmpeq_epi32
+#endif
+
+#define VS_NAME(name) stringlib_sse2_##name
+#define VS_TARGET
+#define VS_VEC __m128i
+#define VS_CHARS (16 / STRINGLIB_SIZEOF_CHAR)
+#define VS_LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define VS_SET1 VS_SSE2_SET1
+#define VS_CMPEQ VS_SSE2_CMPEQ
+#define VS_OR _mm_or_si128
+#define VS_AND _mm_and_si128
+#define VS_ZERO _mm_setzero_si128()
+#define VS_MASK(v) ((unsigned int)_mm_movemask_epi8(v))
+#define VS_POPCOUNT stringlib_popcount
+#include "vecsearch_impl.h"
+
+#ifdef STRINGLIB_VECSEARCH_AVX2
+#define VS_NAME(name) stringlib_avx2_##name
+#define VS_TARGET __attribute__((target("avx2,popcnt")))
+#define VS_VEC __m256i
+#define VS_CHARS (32 / STRINGLIB_SIZEOF_CHAR)
+#define VS_LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define VS_SET1 VS_AVX2_SET1
+#define VS_CMPEQ VS_AVX2_CMPEQ
+#define VS_OR _mm256_or_si256
+#define VS_AND _mm256_and_si256
+#define VS_ZERO _mm256_setzero_si256()
+#define VS_MASK(v) ((unsigned int)_mm256_movemask_epi8(v))
+#define VS_POPCOUNT __builtin_popcount
+#include "vecsearch_impl.h"
+
+/* the check reads a flag that libgcc fills in at startup */
+#define VS_CALL(name, args)                             \
+    (__builtin_cpu_supports("avx2") ?                   \
+     stringlib_avx2_##name args : stringlib_sse2_##name args)
+#else
+#define VS_CALL(name, args) stringlib_sse2_##name args
+#endif
+
+/* first occurrence of a pattern of 2 or more characters, or -1 */
+Py_LOCAL_INLINE(Py_ssize_t)
+stringlib_vec_find(const STRINGLIB_CHAR* s, Py_ssize_t n,
+                   const STRINGLIB_CHAR* p, Py_ssize_t m)
+{
+    return VS_CALL(find, (s, n, p, m));
+}
+
+/* last occurrence of a pattern of 2 or more characters, or -1 */
+Py_LOCAL_INLINE(Py_ssize_t)
+stringlib_vec_rfind(const STRINGLIB_CHAR* s, Py_ssize_t n,
+                    const STRINGLIB_CHAR* p, Py_ssize_t m)
+{
+    return VS_CALL(rfind, (s, n, p, m));
+}
+
+/* non-overlapping occurrences of a pattern of 2 or more characters,
+   stopping at maxcount */
+Py_LOCAL_INLINE(Py_ssize_t)
+stringlib_vec_count(const STRINGLIB_CHAR* s, Py_ssize_t n,
+                    const STRINGLIB_CHAR* p, Py_ssize_t m,
+                    Py_ssize_t maxcount)
+{
+    Py_ssize_t pos, count = 0;
+
+    while (n >= m && (pos = stringlib_vec_find(s, n, p, m)) >= 0) {
+        if (++count == maxcount)
+            break;
+        s += pos + m;
+        n -= pos + m;
+    }
+    return count;
+}
+
+#endif
+
+Py_LOCAL_INLINE(Py_ssize_t)
+stringlib_find_char(const STRINGLIB_CHAR* s, Py_ssize_t n,
+                    STRINGLIB_CHAR ch)
+{
+#ifdef STRINGLIB_VECSEARCH
+    return VS_CALL(find_char, (s, n, ch));
+#else
+    Py_ssize_t i;
+
+    for (i = 0; i < n; i++)
+        if (s[i] == ch)
+            return i;
+    return -1;
+#endif
+}
+
+Py_LOCAL_INLINE(Py_ssize_t)
+stringlib_rfind_char(const STRINGLIB_CHAR* s, Py_ssize_t n,
+                     STRINGLIB_CHAR ch)
+{
+#ifdef STRINGLIB_VECSEARCH
+    return VS_CALL(rfind_char, (s, n, ch));
+#else
+    Py_ssize_t i;
+
+    for (i = n - 1; i > -1; i--)
+        if (s[i] == ch)
+            return i;
+    return -1;
+#endif
+}
+
+/* occurrences of ch, stopping at maxcount (which must be positive) */
+Py_LOCAL_INLINE(Py_ssize_t)
+stringlib_count_char(const STRINGLIB_CHAR* s, Py_ssize_t n,
+                     STRINGLIB_CHAR ch, Py_ssize_t maxcount)
+{
+#ifdef STRINGLIB_VECSEARCH
+    return VS_CALL(count_char, (s, n, ch, maxcount));
+#else
+    Py_ssize_t i, count = 0;
+
+    for (i = 0; i < n; i++)
+        if (s[i] == ch) {
+            count++;
+            if (count == maxcount)
+                return maxcount;
+        }
+    return count;
+#endif
+}
+
+/* index of the first STRINGLIB_ISLINEBREAK character, or n */
+Py_LOCAL_INLINE(Py_ssize_t)
+stringlib_find_linebreak(const STRINGLIB_CHAR* s, Py_ssize_t n)
+{
+#ifdef STRINGLIB_VECSEARCH
+    return VS_CALL(find_linebreak, (s, n));
+#else
+    Py_ssize_t i;
+
+    for (i = 0; i < n; i++)
+        if (STRINGLIB_ISLINEBREAK(s[i]))
+            break;
+    return i;
+#endif
+}
+
+#endif
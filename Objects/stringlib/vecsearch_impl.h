@@ -0,0 +1,260 @@
+/* stringlib: vectorized search kernels, one instruction set */
+
+/* included by vecsearch.h once per instruction set, with VS_NAME,
+   VS_TARGET, the vector type VS_VEC holding VS_CHARS characters, and
+   the VS_LOAD, VS_SET1, VS_CMPEQ, VS_OR, VS_AND, VS_ZERO, VS_MASK and
+   VS_POPCOUNT operations on it defined.  unaligned loads are used
+   throughout, and no kernel reads outside s[0:n]: when the length isn't
+   a multiple of the vector size, the last vector is loaded so that it
+   ends at s[n], overlapping characters that have been looked at
+   already. */
+
+VS_TARGET Py_LOCAL(Py_ssize_t)
+VS_NAME(find_char)(const STRINGLIB_CHAR* s, Py_ssize_t n,
+                   STRINGLIB_CHAR ch)
+{
+    const VS_VEC c = VS_SET1(ch);
+    unsigned int mask;
+    Py_ssize_t i;
+
+    if (n < VS_CHARS) {
+        for (i = 0; i < n; i++)
+            if (s[i] == ch)
+                return i;
+        return -1;
+    }
+    /* skip four vectors at a time until one of them has a match */
+    for (i = 0; i + 4 * VS_CHARS <= n; i += 4 * VS_CHARS) {
+        VS_VEC e0 = VS_CMPEQ(VS_LOAD(s + i), c);
+        VS_VEC e1 = VS_CMPEQ(VS_LOAD(s + i + VS_CHARS), c);
+        VS_VEC e2 = VS_CMPEQ(VS_LOAD(s + i + 2 * VS_CHARS), c);
+        VS_VEC e3 = VS_CMPEQ(VS_LOAD(s + i + 3 * VS_CHARS), c);
+        if (VS_MASK(VS_OR(VS_OR(e0, e1), VS_OR(e2, e3))))
+            break;
+    }
+    for (;; i += VS_CHARS) {
+        if (i > n - VS_CHARS) {
+            if (i == n)
+                return -1;
+            i = n - VS_CHARS;
+        }
+        mask = VS_MASK(VS_CMPEQ(VS_LOAD(s + i), c));
+        if (mask)
+            return i + stringlib_ctz(mask) / STRINGLIB_SIZEOF_CHAR;
+    }
+}
+
+VS_TARGET Py_LOCAL(Py_ssize_t)
+VS_NAME(rfind_char)(const STRINGLIB_CHAR* s, Py_ssize_t n,
+                    STRINGLIB_CHAR ch)
+{
+    const VS_VEC c = VS_SET1(ch);
+    unsigned int mask;
+    Py_ssize_t i;
+
+    if (n < VS_CHARS) {
+        for (i = n - 1; i > -1; i--)
+            if (s[i] == ch)
+                return i;
+        return -1;
+    }
+    /* i is the end of the part still to be searched */
+    for (i = n; i >= 4 * VS_CHARS; i -= 4 * VS_CHARS) {
+        VS_VEC e0 = VS_CMPEQ(VS_LOAD(s + i - VS_CHARS), c);
+        VS_VEC e1 = VS_CMPEQ(VS_LOAD(s + i - 2 * VS_CHARS), c);
+        VS_VEC e2 = VS_CMPEQ(VS_LOAD(s + i - 3 * VS_CHARS), c);
+        VS_VEC e3 = VS_CMPEQ(VS_LOAD(s + i - 4 * VS_CHARS), c);
+        if (VS_MASK(VS_OR(VS_OR(e0, e1), VS_OR(e2, e3))))
+            break;
+    }
+    for (;; i -= VS_CHARS) {
+        if (i < VS_CHARS) {
+            if (i == 0)
+                return -1;
+            i = VS_CHARS;
+        }
+        mask = VS_MASK(VS_CMPEQ(VS_LOAD(s + i - VS_CHARS), c));
+        if (mask)
+            return i - VS_CHARS +
+                stringlib_bsr(mask) / STRINGLIB_SIZEOF_CHAR;
+    }
+}
+
+VS_TARGET Py_LOCAL(Py_ssize_t)
+VS_NAME(count_char)(const STRINGLIB_CHAR* s, Py_ssize_t n,
+                    STRINGLIB_CHAR ch, Py_ssize_t maxcount)
+{
+    const VS_VEC c = VS_SET1(ch);
+    unsigned int mask;
+    Py_ssize_t i, count = 0;
+
+    if (n < VS_CHARS) {
+        for (i = 0; i < n; i++)
+            if (s[i] == ch) {
+                count++;
+                if (count == maxcount)
+                    return maxcount;
+            }
+        return count;
+    }
+    for (i = 0; i + 4 * VS_CHARS <= n; i += 4 * VS_CHARS) {
+        VS_VEC e0 = VS_CMPEQ(VS_LOAD(s + i), c);
+        VS_VEC e1 = VS_CMPEQ(VS_LOAD(s + i + VS_CHARS), c);
+        VS_VEC e2 = VS_CMPEQ(VS_LOAD(s + i + 2 * VS_CHARS), c);
+        VS_VEC e3 = VS_CMPEQ(VS_LOAD(s + i + 3 * VS_CHARS), c);
+        if (VS_MASK(VS_OR(VS_OR(e0, e1), VS_OR(e2, e3)))) {
+            count += (VS_POPCOUNT(VS_MASK(e0)) +
+                      VS_POPCOUNT(VS_MASK(e1)) +
+                      VS_POPCOUNT(VS_MASK(e2)) +
+                      VS_POPCOUNT(VS_MASK(e3))) /
+                STRINGLIB_SIZEOF_CHAR;
+            if (count >= maxcount)
+                return maxcount;
+        }
+    }
+    for (; i + VS_CHARS <= n; i += VS_CHARS) {
+        mask = VS_MASK(VS_CMPEQ(VS_LOAD(s + i), c));
+        if (mask)
+            count += VS_POPCOUNT(mask) / STRINGLIB_SIZEOF_CHAR;
+    }
+    if (i < n) {
+        /* drop the lanes of the characters counted already */
+        mask = VS_MASK(VS_CMPEQ(VS_LOAD(s + n - VS_CHARS), c));
+        mask >>= (i - (n - VS_CHARS)) * STRINGLIB_SIZEOF_CHAR;
+        count += VS_POPCOUNT(mask) / STRINGLIB_SIZEOF_CHAR;
+    }
+    return count < maxcount ? count : maxcount;
+}
+
+/* the next two look for positions where both the first and the last
+   character of the pattern match, which is rare enough in real text
+   that the rest of the pattern is compared only for a few of them.
+   they require 2 <= m <= n. */
+
+VS_TARGET Py_LOCAL(Py_ssize_t)
+VS_NAME(find)(const STRINGLIB_CHAR* s, Py_ssize_t n,
+              const STRINGLIB_CHAR* p, Py_ssize_t m)
+{
+    const VS_VEC first = VS_SET1(p[0]);
+    const VS_VEC last = VS_SET1(p[m - 1]);
+    const size_t rest = (m - 2) * sizeof(STRINGLIB_CHAR);
+    Py_ssize_t i, w = n - m;
+    unsigned int mask;
+    int b;
+
+    if (w + 1 < VS_CHARS) {
+        for (i = 0; i <= w; i++)
+            if (s[i] == p[0] && s[i + m - 1] == p[m - 1] &&
+                memcmp(s + i + 1, p + 1, rest) == 0)
+                return i;
+        return -1;
+    }
+    /* the candidates are s[i:i+VS_CHARS], i <= w */
+    for (i = 0;; i += VS_CHARS) {
+        if (i > w + 1 - VS_CHARS) {
+            if (i > w)
+                return -1;
+            i = w + 1 - VS_CHARS;
+        }
+        mask = VS_MASK(VS_AND(VS_CMPEQ(VS_LOAD(s + i), first),
+                              VS_CMPEQ(VS_LOAD(s + i + m - 1), last)));
+        while (mask) {
+            b = stringlib_ctz(mask);
+            if (memcmp(s + i + b / STRINGLIB_SIZEOF_CHAR + 1,
+                       p + 1, rest) == 0)
+                return i + b / STRINGLIB_SIZEOF_CHAR;
+            mask &= ~(VS_LANE << b);
+        }
+    }
+}
+
+VS_TARGET Py_LOCAL(Py_ssize_t)
+VS_NAME(rfind)(const STRINGLIB_CHAR* s, Py_ssize_t n,
+               const STRINGLIB_CHAR* p, Py_ssize_t m)
+{
+    const VS_VEC first = VS_SET1(p[0]);
+    const VS_VEC last = VS_SET1(p[m - 1]);
+    const size_t rest = (m - 2) * sizeof(STRINGLIB_CHAR);
+    Py_ssize_t i, w = n - m;
+    unsigned int mask;
+    int b;
+
+    if (w + 1 < VS_CHARS) {
+        for (i = w; i >= 0; i--)
+            if (s[i] == p[0] && s[i + m - 1] == p[m - 1] &&
+                memcmp(s + i + 1, p + 1, rest) == 0)
+                return i;
+        return -1;
+    }
+    /* the candidates are s[i-VS_CHARS:i], i > 0 */
+    for (i = w + 1;; i -= VS_CHARS) {
+        if (i < VS_CHARS) {
+            if (i == 0)
+                return -1;
+            i = VS_CHARS;
+        }
+        mask = VS_MASK(
+            VS_AND(VS_CMPEQ(VS_LOAD(s + i - VS_CHARS), first),
+                   VS_CMPEQ(VS_LOAD(s + i - VS_CHARS + m - 1), last)));
+        while (mask) {
+            b = stringlib_bsr(mask) & ~(STRINGLIB_SIZEOF_CHAR - 1);
+            if (memcmp(s + i - VS_CHARS + b / STRINGLIB_SIZEOF_CHAR + 1,
+                       p + 1, rest) == 0)
+                return i - VS_CHARS + b / STRINGLIB_SIZEOF_CHAR;
+            mask &= ~(VS_LANE << b);
+        }
+    }
+}
+
+VS_TARGET Py_LOCAL(Py_ssize_t)
+VS_NAME(find_linebreak)(const STRINGLIB_CHAR* s, Py_ssize_t n)
+{
+#if STRINGLIB_SIZEOF_CHAR == 1
+    /* only \n and \r are line breaks in 8-bit strings */
+    const VS_VEC lf = VS_SET1('\n');
+    const VS_VEC cr = VS_SET1('\r');
+#define VS_LINEBREAKS(v) VS_OR(VS_CMPEQ(v, lf), VS_CMPEQ(v, cr))
+#else
+    /* the unicode line breaks are all below 0x20, or 0x85, 0x2028 and
+       0x2029; the candidates found here get checked one by one */
+    const VS_VEC high = VS_SET1(~0x1f);
+    const VS_VEC nel = VS_SET1(0x85);
+    const VS_VEC even = VS_SET1(~1);
+    const VS_VEC ls = VS_SET1(0x2028);
+#define VS_LINEBREAKS(v)                                        \
+    VS_OR(VS_OR(VS_CMPEQ(VS_AND(v, high), VS_ZERO),             \
+                VS_CMPEQ(v, nel)),                              \
+          VS_CMPEQ(VS_AND(v, even), ls))
+#endif
+    unsigned int mask;
+    Py_ssize_t i;
+    int b;
+
+    for (i = 0; i + VS_CHARS <= n; i += VS_CHARS) {
+        mask = VS_MASK(VS_LINEBREAKS(VS_LOAD(s + i)));
+        while (mask) {
+            b = stringlib_ctz(mask);
+            if (STRINGLIB_ISLINEBREAK(s[i + b / STRINGLIB_SIZEOF_CHAR]))
+                return i + b / STRINGLIB_SIZEOF_CHAR;
+            mask &= ~(VS_LANE << b);
+        }
+    }
+    for (; i < n; i++)
+        if (STRINGLIB_ISLINEBREAK(s[i]))
+            break;
+    return i;
+#undef VS_LINEBREAKS
+}
+
+#undef VS_NAME
+#undef VS_TARGET
+#undef VS_VEC
+#undef VS_CHARS
+#undef VS_LOAD
+#undef VS_SET1
+#undef VS_CMPEQ
+#undef VS_OR
+#undef VS_AND
+#undef VS_ZERO
+#undef VS_MASK
+#undef VS_POPCOUNT
@@ -23,6 +23,10 @@ static PyStringObject *nullstring;
 */
 static PyObject *interned;
 
+/* PyString_Format() keeps the parsed form of recent format strings,
+   which must be dropped when they go away or get resized */
+Py_LOCAL_INLINE(void) stringlib_format_forget(PyObject *format);
+
 /* PyStringObject_SIZE gives the basic size of a string; any memory allocation
    for a string of length n should request PyStringObject_SIZE + n bytes.
 
@@ -576,6 +580,12 @@ PyObject *PyString_AsEncodedString(PyObject *str,
 static void
 string_dealloc(PyObject *op)
 {
+    stringlib_format_forget(op);
+    if (PyString_CHECK_LAZY(op)) {
+        PyStringLazyHeader h;
+        Py_MEMCPY(&h, ((PyStringObject *)op)->ob_sval, sizeof(h));
+        Py_DECREF(h.pieces);
+    }
     switch (PyString_CHECK_INTERNED(op)) {
         case SSTATE_NOT_INTERNED:
             break;
@@ -788,7 +798,7 @@ PyString_AsString(register PyObject *op)
 {
     if (!PyString_Check(op))
         return string_getbuffer(op);
-    return ((PyStringObject *)op) -> ob_sval;
+    return PyString_AS_STRING(op);
 }
 
 int
@@ -843,6 +853,14 @@ PyString_AsStringAndSize(register PyObject *obj,
 #define _Py_InsertThousandsGrouping _PyString_InsertThousandsGrouping
 #include "stringlib/localeutil.h"
 
+/* for the unicode objects that keep one byte per character */
+Py_ssize_t
+_PyString_FastSearch(const char *s, Py_ssize_t n,
+                     const char *p, Py_ssize_t m,
+                     Py_ssize_t maxcount, int mode)
+{
+    return fastsearch(s, n, p, m, maxcount, mode);
+}
 
 
 static int
@@ -864,7 +882,7 @@ string_print(PyStringObject *op, FILE *fp, int flags)
         return ret;
     }
     if (flags & Py_PRINT_RAW) {
-        char *data = op->ob_sval;
+        char *data = PyString_AS_STRING(op);
         Py_ssize_t size = Py_SIZE(op);
         Py_BEGIN_ALLOW_THREADS
         while (size > INT_MAX) {
@@ -886,6 +904,9 @@ string_print(PyStringObject *op, FILE *fp, int flags)
         return 0;
     }
 
+    if (PyString_CHECK_LAZY(op))
+        _PyString_Flatten((PyObject *)op);
+
     /* figure out which quote to use; single is preferred */
     quote = '\'';
     if (memchr(op->ob_sval, '\'', Py_SIZE(op)) &&
@@ -939,6 +960,9 @@ PyString_Repr(PyObject *obj, int smartquotes)
         register char *p;
         int quote;
 
+        if (PyString_CHECK_LAZY(op))
+            _PyString_Flatten((PyObject *)op);
+
         /* figure out which quote to use; single is preferred */
         quote = '\'';
         if (smartquotes &&
@@ -997,7 +1021,8 @@ string_str(PyObject *s)
     else {
         /* Subtype -- return genuine string with the same value. */
         PyStringObject *t = (PyStringObject *) s;
-        return PyString_FromStringAndSize(t->ob_sval, Py_SIZE(t));
+        return PyString_FromStringAndSize(PyString_AS_STRING(t),
+                                          Py_SIZE(t));
     }
 }
 
@@ -1059,13 +1084,112 @@ string_concat(register PyStringObject *a, register PyObject *bb)
     PyObject_INIT_VAR(op, &PyString_Type, size);
     op->ob_shash = -1;
     op->ob_sstate = SSTATE_NOT_INTERNED;
-    Py_MEMCPY(op->ob_sval, a->ob_sval, Py_SIZE(a));
-    Py_MEMCPY(op->ob_sval + Py_SIZE(a), b->ob_sval, Py_SIZE(b));
+    Py_MEMCPY(op->ob_sval, PyString_AS_STRING(a), Py_SIZE(a));
+    Py_MEMCPY(op->ob_sval + Py_SIZE(a), PyString_AS_STRING(b), Py_SIZE(b));
     op->ob_sval[size] = '\0';
     return (PyObject *) op;
 #undef b
 }
 
+/* Deferred concatenation.  ceval's string_concatenate() resizes the left
+   operand of s += t in place when nothing else refers to it, but when
+   something does, every += used to copy all of s, and building a string
+   in a loop took quadratic time.  Instead, a long enough result only
+   records its pieces, in a list that the results of the following +=
+   share and append to, and the characters are copied into it once, when
+   something first looks at them.  The object is allocated at its full
+   size from the start, so that step can't fail, and the pieces list
+   and its length are kept in ob_sval until then. */
+
+/* shorter results are copied right away */
+#define LAZY_CONCAT_MIN 1024
+
+PyObject *
+_PyString_ConcatLazy(PyObject *v, PyObject *w)
+{
+    PyStringLazyHeader h, vh;
+    PyStringObject *op;
+    Py_ssize_t size;
+
+    assert(PyString_CheckExact(v) && PyString_CheckExact(w));
+    if (Py_SIZE(v) == 0 || Py_SIZE(w) == 0 ||
+        Py_SIZE(v) > PY_SSIZE_T_MAX - PyStringObject_SIZE - Py_SIZE(w) ||
+        (!PyString_CHECK_LAZY(v) &&
+         Py_SIZE(v) + Py_SIZE(w) < LAZY_CONCAT_MIN))
+        return string_concat((PyStringObject *)v, w);
+    size = Py_SIZE(v) + Py_SIZE(w);
+
+    /* the pieces themselves are never lazy */
+    if (PyString_CHECK_LAZY(w))
+        _PyString_Flatten(w);
+    if (PyString_CHECK_LAZY(v)) {
+        Py_MEMCPY(&vh, ((PyStringObject *)v)->ob_sval, sizeof(vh));
+        if (PyList_GET_SIZE(vh.pieces) == vh.count) {
+            /* nothing was appended after v's pieces yet */
+            h.pieces = vh.pieces;
+            Py_INCREF(h.pieces);
+        }
+        else {
+            h.pieces = PyList_GetSlice(vh.pieces, 0, vh.count);
+            if (h.pieces == NULL)
+                return NULL;
+        }
+        if (PyList_Append(h.pieces, w) < 0) {
+            Py_DECREF(h.pieces);
+            return NULL;
+        }
+        h.count = vh.count + 1;
+    }
+    else {
+        h.pieces = PyList_New(2);
+        if (h.pieces == NULL)
+            return NULL;
+        Py_INCREF(v);
+        PyList_SET_ITEM(h.pieces, 0, v);
+        Py_INCREF(w);
+        PyList_SET_ITEM(h.pieces, 1, w);
+        h.count = 2;
+    }
+
+    op = (PyStringObject *)PyObject_MALLOC(PyStringObject_SIZE + size);
+    if (op == NULL) {
+        Py_DECREF(h.pieces);
+        return PyErr_NoMemory();
+    }
+    PyObject_INIT_VAR(op, &PyString_Type, size);
+    op->ob_shash = -1;
+    op->ob_sstate = SSTATE_LAZY;
+    Py_MEMCPY(op->ob_sval, &h, sizeof(h));
+    return (PyObject *) op;
+}
+
+/* Copy the pieces of a lazy string into it, and return ob_sval.  This
+   is what PyString_AS_STRING() calls the first time it's given a lazy
+   string. */
+char *
+_PyString_Flatten(PyObject *op)
+{
+    PyStringObject *s = (PyStringObject *)op;
+    PyStringLazyHeader h;
+    PyObject *piece;
+    char *p = s->ob_sval;
+    Py_ssize_t i;
+
+    assert(PyString_CHECK_LAZY(s));
+    Py_MEMCPY(&h, s->ob_sval, sizeof(h));
+    for (i = 0; i < h.count; i++) {
+        piece = PyList_GET_ITEM(h.pieces, i);
+        assert(!PyString_CHECK_LAZY(piece));
+        Py_MEMCPY(p, ((PyStringObject *)piece)->ob_sval, Py_SIZE(piece));
+        p += Py_SIZE(piece);
+    }
+    assert(p == s->ob_sval + Py_SIZE(s));
+    *p = '\0';
+    s->ob_sstate = SSTATE_NOT_INTERNED;
+    Py_DECREF(h.pieces);
+    return s->ob_sval;
+}
+
 static PyObject *
 string_repeat(register PyStringObject *a, register Py_ssize_t n)
 {
@@ -1103,12 +1227,12 @@ string_repeat(register PyStringObject *a, register Py_ssize_t n)
     op->ob_sstate = SSTATE_NOT_INTERNED;
     op->ob_sval[size] = '\0';
     if (Py_SIZE(a) == 1 && n > 0) {
-        memset(op->ob_sval, a->ob_sval[0] , n);
+        memset(op->ob_sval, PyString_AS_STRING(a)[0] , n);
         return (PyObject *) op;
     }
     i = 0;
     if (i < size) {
-        Py_MEMCPY(op->ob_sval, a->ob_sval, Py_SIZE(a));
+        Py_MEMCPY(op->ob_sval, PyString_AS_STRING(a), Py_SIZE(a));
         i = Py_SIZE(a);
     }
     while (i < size) {
@@ -1139,7 +1263,7 @@ string_slice(register PyStringObject *a, register Py_ssize_t i,
     }
     if (j < i)
         j = i;
-    return PyString_FromStringAndSize(a->ob_sval + i, j-i);
+    return PyString_FromStringAndSize(PyString_AS_STRING(a) + i, j-i);
 }
 
 static int
@@ -1170,7 +1294,7 @@ string_item(PyStringObject *a, register Py_ssize_t i)
         PyErr_SetString(PyExc_IndexError, "string index out of range");
         return NULL;
     }
-    pchar = a->ob_sval[i];
+    pchar = PyString_AS_STRING(a)[i];
     v = (PyObject *)characters[pchar & UCHAR_MAX];
     if (v == NULL)
         v = PyString_FromStringAndSize(&pchar, 1);
@@ -1206,6 +1330,10 @@ string_richcompare(PyStringObject *a, PyStringObject *b, int op)
             goto out;
         }
     }
+    if (PyString_CHECK_LAZY(a))
+        _PyString_Flatten((PyObject *)a);
+    if (PyString_CHECK_LAZY(b))
+        _PyString_Flatten((PyObject *)b);
     if (op == Py_EQ) {
         /* Supporting Py_NE here as well does not save
            much time, since Py_NE is rarely used.  */
@@ -1250,43 +1378,23 @@ _PyString_Eq(PyObject *o1, PyObject *o2)
 {
     PyStringObject *a = (PyStringObject*) o1;
     PyStringObject *b = (PyStringObject*) o2;
-    return Py_SIZE(a) == Py_SIZE(b)
-      && *a->ob_sval == *b->ob_sval
+    if (Py_SIZE(a) != Py_SIZE(b))
+        return 0;
+    if (PyString_CHECK_LAZY(a))
+        _PyString_Flatten(o1);
+    if (PyString_CHECK_LAZY(b))
+        _PyString_Flatten(o2);
+    return *a->ob_sval == *b->ob_sval
       && memcmp(a->ob_sval, b->ob_sval, Py_SIZE(a)) == 0;
 }
 
 static long
 string_hash(PyStringObject *a)
 {
-    register Py_ssize_t len;
-    register unsigned char *p;
-    register long x;
-
-#ifdef Py_DEBUG
-    assert(_Py_HashSecret_Initialized);
-#endif
     if (a->ob_shash != -1)
         return a->ob_shash;
-    len = Py_SIZE(a);
-    /*
-      We make the hash of the empty string be 0, rather than using
-      (prefix ^ suffix), since this slightly obfuscates the hash secret
-    */
-    if (len == 0) {
-        a->ob_shash = 0;
-        return 0;
-    }
-    p = (unsigned char *) a->ob_sval;
-    x = _Py_HashSecret.prefix;
-    x ^= *p << 7;
-    while (--len >= 0)
-        x = (1000003*x) ^ *p++;
-    x ^= Py_SIZE(a);
-    x ^= _Py_HashSecret.suffix;
-    if (x == -1)
-        x = -2;
-    a->ob_shash = x;
-    return x;
+    a->ob_shash = _Py_HashBytes(PyString_AS_STRING(a), Py_SIZE(a));
+    return a->ob_shash;
 }
 
 static PyObject*
@@ -1359,7 +1467,7 @@ string_buffer_getreadbuf(PyStringObject *self, Py_ssize_t index, const void **pt
                         "accessing non-existent string segment");
         return -1;
     }
-    *ptr = (void *)self->ob_sval;
+    *ptr = (void *)PyString_AS_STRING(self);
     return Py_SIZE(self);
 }
 
@@ -1387,7 +1495,7 @@ string_buffer_getcharbuf(PyStringObject *self, Py_ssize_t index, const char **pt
                         "accessing non-existent string segment");
         return -1;
     }
-    *ptr = self->ob_sval;
+    *ptr = PyString_AS_STRING(self);
     return Py_SIZE(self);
 }
 
@@ -1395,7 +1503,7 @@ static int
 string_buffer_getbuffer(PyStringObject *self, Py_buffer *view, int flags)
 {
     return PyBuffer_FillInfo(view, (PyObject*)self,
-                             (void *)self->ob_sval, Py_SIZE(self),
+                             (void *)PyString_AS_STRING(self), Py_SIZE(self),
                              1, flags);
 }
 
@@ -2328,19 +2436,9 @@ return_self(PyStringObject *self)
 }
 
 Py_LOCAL_INLINE(Py_ssize_t)
-countchar(const char *target, int target_len, char c, Py_ssize_t maxcount)
+countchar(const char *target, Py_ssize_t target_len, char c, Py_ssize_t maxcount)
 {
-    Py_ssize_t count=0;
-    const char *start=target;
-    const char *end=target+target_len;
-
-    while ( (start=findchar(start, end-start, c)) != NULL ) {
-        count++;
-        if (count >= maxcount)
-            break;
-        start += 1;
-    }
-    return count;
+    return stringlib_count_char(target, target_len, c, maxcount);
 }
 
 
@@ -3001,13 +3099,14 @@ codecs.register_error that is able to handle UnicodeEncodeErrors.");
 static PyObject *
 string_encode(PyStringObject *self, PyObject *args, PyObject *kwargs)
 {
-    static char *kwlist[] = {"encoding", "errors", 0};
+    static const char * const kwlist[] = {"encoding", "errors", 0};
+    static _PyArg_Parser _parser = {"|ss:encode", kwlist, 0};
     char *encoding = NULL;
     char *errors = NULL;
     PyObject *v;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ss:encode",
-                                     kwlist, &encoding, &errors))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwargs, &_parser,
+                                          &encoding, &errors))
         return NULL;
     v = PyString_AsEncodedObject((PyObject *)self, encoding, errors);
     if (v == NULL)
@@ -3040,13 +3139,14 @@ able to handle UnicodeDecodeErrors.");
 static PyObject *
 string_decode(PyStringObject *self, PyObject *args, PyObject *kwargs)
 {
-    static char *kwlist[] = {"encoding", "errors", 0};
+    static const char * const kwlist[] = {"encoding", "errors", 0};
+    static _PyArg_Parser _parser = {"|ss:decode", kwlist, 0};
     char *encoding = NULL;
     char *errors = NULL;
     PyObject *v;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ss:decode",
-                                     kwlist, &encoding, &errors))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwargs, &_parser,
+                                          &encoding, &errors))
         return NULL;
     v = PyString_AsDecodedObject((PyObject *)self, encoding, errors);
     if (v == NULL)
@@ -3579,7 +3679,7 @@ string_sizeof(PyStringObject *v)
 static PyObject *
 string_getnewargs(PyStringObject *v)
 {
-    return Py_BuildValue("(s#)", v->ob_sval, Py_SIZE(v));
+    return Py_BuildValue("(s#)", PyString_AS_STRING(v), Py_SIZE(v));
 }
 
 
@@ -3692,11 +3792,12 @@ static PyObject *
 string_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
     PyObject *x = NULL;
-    static char *kwlist[] = {"object", 0};
+    static const char * const kwlist[] = {"object", 0};
+    static _PyArg_Parser _parser = {"|O:str", kwlist, 0};
 
     if (type != &PyString_Type)
         return str_subtype_new(type, args, kwds);
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:str", kwlist, &x))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser, &x))
         return NULL;
     if (x == NULL)
         return PyString_FromString("");
@@ -3899,6 +4000,9 @@ _PyString_Resize(PyObject **pv, Py_ssize_t newsize)
         PyErr_BadInternalCall();
         return -1;
     }
+    if (PyString_CHECK_LAZY(v))
+        _PyString_Flatten(v);
+    stringlib_format_forget(v);
     /* XXX UNREF/NEWREF interface should be more symmetrical */
     _Py_DEC_REFTOTAL;
     _Py_ForgetReference(v);
@@ -4222,60 +4326,78 @@ formatchar(char *buf, size_t buflen, PyObject *v)
 */
 #define FORMATBUFLEN (size_t)120
 
+#include "stringlib/percent_format.h"
+
 PyObject *
 PyString_Format(PyObject *format, PyObject *args)
 {
     char *fmt, *res;
-    Py_ssize_t arglen, argidx;
-    Py_ssize_t reslen, rescnt, fmtcnt;
-    int args_owned = 0;
+    Py_ssize_t reslen, rescnt;
+    StringlibFormatCode *code;
+    StringlibFormatSpec *spec;
+    StringlibFormatArgs fa;
     PyObject *result, *orig_args;
 #ifdef Py_USING_UNICODE
     PyObject *v, *w;
 #endif
-    PyObject *dict = NULL;
     if (format == NULL || !PyString_Check(format) || args == NULL) {
         PyErr_BadInternalCall();
         return NULL;
     }
+    code = stringlib_format_code(format);
+    if (code == NULL)
+        return NULL;
     orig_args = args;
     fmt = PyString_AS_STRING(format);
-    fmtcnt = PyString_GET_SIZE(format);
-    reslen = rescnt = fmtcnt + 100;
+    /* a little more than last time, so that one more digit or so
+       doesn't need a resize */
+    reslen = rescnt = code->size_hint + (code->size_hint >> 3) + 16;
     result = PyString_FromStringAndSize((char *)NULL, reslen);
-    if (result == NULL)
+    if (result == NULL) {
+        stringlib_format_release(code);
         return NULL;
-    res = PyString_AsString(result);
+    }
+    res = PyString_AS_STRING(result);
+    fa.args = args;
+    fa.args_owned = 0;
     if (PyTuple_Check(args)) {
-        arglen = PyTuple_GET_SIZE(args);
-        argidx = 0;
+        fa.arglen = PyTuple_GET_SIZE(args);
+        fa.argidx = 0;
     }
     else {
-        arglen = -1;
-        argidx = -2;
+        fa.arglen = -1;
+        fa.argidx = -2;
     }
+    fa.dict = NULL;
     if (Py_TYPE(args)->tp_as_mapping && !PyTuple_Check(args) &&
         !PyObject_TypeCheck(args, &PyBaseString_Type))
-        dict = args;
-    while (--fmtcnt >= 0) {
-        if (*fmt != '%') {
-            if (--rescnt < 0) {
-                rescnt = fmtcnt + 100;
-                reslen += rescnt;
-                if (_PyString_Resize(&result, reslen))
-                    return NULL;
-                res = PyString_AS_STRING(result)
-                    + reslen - rescnt;
-                --rescnt;
+        fa.dict = args;
+    for (spec = code->specs;; spec++) {
+        if (rescnt < spec->litlen) {
+            reslen -= rescnt;
+            rescnt = spec->litlen + (reslen >> 1) + 100;
+            reslen += rescnt;
+            if (reslen < 0) {
+                Py_DECREF(result);
+                PyErr_NoMemory();
+                result = NULL;
+                goto error;
             }
-            *res++ = *fmt++;
+            if (_PyString_Resize(&result, reslen))
+                goto error;
+            res = PyString_AS_STRING(result) + reslen - rescnt;
         }
-        else {
+        Py_MEMCPY(res, fmt + spec->lit, spec->litlen);
+        res += spec->litlen;
+        rescnt -= spec->litlen;
+        if (spec->status == FORMAT_END)
+            break;
+        {
             /* Got a format specifier */
-            int flags = 0;
-            Py_ssize_t width = -1;
-            int prec = -1;
-            int c = '\0';
+            int flags;
+            Py_ssize_t width;
+            int prec;
+            int c;
             int fill;
             int isnumok;
             PyObject *v = NULL;
@@ -4286,150 +4408,13 @@ PyString_Format(PyObject *format, PyObject *args)
             char formatbuf[FORMATBUFLEN];
                  /* For format{int,char}() */
 #ifdef Py_USING_UNICODE
-            char *fmt_start = fmt;
-            Py_ssize_t argidx_start = argidx;
+            Py_ssize_t argidx_start = fa.argidx;
 #endif
 
-            fmt++;
-            if (*fmt == '(') {
-                char *keystart;
-                Py_ssize_t keylen;
-                PyObject *key;
-                int pcount = 1;
-
-                if (dict == NULL) {
-                    PyErr_SetString(PyExc_TypeError,
-                             "format requires a mapping");
-                    goto error;
-                }
-                ++fmt;
-                --fmtcnt;
-                keystart = fmt;
-                /* Skip over balanced parentheses */
-                while (pcount > 0 && --fmtcnt >= 0) {
-                    if (*fmt == ')')
-                        --pcount;
-                    else if (*fmt == '(')
-                        ++pcount;
-                    fmt++;
-                }
-                keylen = fmt - keystart - 1;
-                if (fmtcnt < 0 || pcount > 0) {
-                    PyErr_SetString(PyExc_ValueError,
-                               "incomplete format key");
-                    goto error;
-                }
-                key = PyString_FromStringAndSize(keystart,
-                                                 keylen);
-                if (key == NULL)
-                    goto error;
-                if (args_owned) {
-                    Py_DECREF(args);
-                    args_owned = 0;
-                }
-                args = PyObject_GetItem(dict, key);
-                Py_DECREF(key);
-                if (args == NULL) {
-                    goto error;
-                }
-                args_owned = 1;
-                arglen = -1;
-                argidx = -2;
-            }
-            while (--fmtcnt >= 0) {
-                switch (c = *fmt++) {
-                case '-': flags |= F_LJUST; continue;
-                case '+': flags |= F_SIGN; continue;
-                case ' ': flags |= F_BLANK; continue;
-                case '#': flags |= F_ALT; continue;
-                case '0': flags |= F_ZERO; continue;
-                }
-                break;
-            }
-            if (c == '*') {
-                v = getnextarg(args, arglen, &argidx);
-                if (v == NULL)
-                    goto error;
-                if (!PyInt_Check(v)) {
-                    PyErr_SetString(PyExc_TypeError,
-                                    "* wants int");
-                    goto error;
-                }
-                width = PyInt_AsLong(v);
-                if (width < 0) {
-                    flags |= F_LJUST;
-                    width = -width;
-                }
-                if (--fmtcnt >= 0)
-                    c = *fmt++;
-            }
-            else if (c >= 0 && isdigit(c)) {
-                width = c - '0';
-                while (--fmtcnt >= 0) {
-                    c = Py_CHARMASK(*fmt++);
-                    if (!isdigit(c))
-                        break;
-                    if ((width*10) / 10 != width) {
-                        PyErr_SetString(
-                            PyExc_ValueError,
-                            "width too big");
-                        goto error;
-                    }
-                    width = width*10 + (c - '0');
-                }
-            }
-            if (c == '.') {
-                prec = 0;
-                if (--fmtcnt >= 0)
-                    c = *fmt++;
-                if (c == '*') {
-                    v = getnextarg(args, arglen, &argidx);
-                    if (v == NULL)
-                        goto error;
-                    if (!PyInt_Check(v)) {
-                        PyErr_SetString(
-                            PyExc_TypeError,
-                            "* wants int");
-                        goto error;
-                    }
-                    prec = PyInt_AsLong(v);
-                    if (prec < 0)
-                        prec = 0;
-                    if (--fmtcnt >= 0)
-                        c = *fmt++;
-                }
-                else if (c >= 0 && isdigit(c)) {
-                    prec = c - '0';
-                    while (--fmtcnt >= 0) {
-                        c = Py_CHARMASK(*fmt++);
-                        if (!isdigit(c))
-                            break;
-                        if ((prec*10) / 10 != prec) {
-                            PyErr_SetString(
-                                PyExc_ValueError,
-                                "prec too big");
-                            goto error;
-                        }
-                        prec = prec*10 + (c - '0');
-                    }
-                }
-            } /* prec */
-            if (fmtcnt >= 0) {
-                if (c == 'h' || c == 'l' || c == 'L') {
-                    if (--fmtcnt >= 0)
-                        c = *fmt++;
-                }
-            }
-            if (fmtcnt < 0) {
-                PyErr_SetString(PyExc_ValueError,
-                                "incomplete format");
+            if (stringlib_format_getargs(spec, &fa, &width, &prec,
+                                         &flags, &v) < 0)
                 goto error;
-            }
-            if (c != '%') {
-                v = getnextarg(args, arglen, &argidx);
-                if (v == NULL)
-                    goto error;
-            }
+            c = spec->c;
             sign = 0;
             fill = ' ';
             switch (c) {
@@ -4438,10 +4423,25 @@ PyString_Format(PyObject *format, PyObject *args)
                 len = 1;
                 break;
             case 's':
+                if (PyString_CheckExact(v)) {
+                    pbuf = PyString_AS_STRING(v);
+                    len = PyString_GET_SIZE(v);
+                    if (prec >= 0 && len > prec)
+                        len = prec;
+                    break;
+                }
+                if (PyInt_CheckExact(v)) {
+                    pbuf = stringlib_format_decimal(
+                        formatbuf + FORMATBUFLEN, PyInt_AS_LONG(v));
+                    len = formatbuf + FORMATBUFLEN - pbuf;
+                    if (prec >= 0 && len > prec)
+                        len = prec;
+                    break;
+                }
 #ifdef Py_USING_UNICODE
                 if (PyUnicode_Check(v)) {
-                    fmt = fmt_start;
-                    argidx = argidx_start;
+                    fmt += spec->start;
+                    fa.argidx = argidx_start;
                     goto unicode;
                 }
 #endif
@@ -4449,8 +4449,8 @@ PyString_Format(PyObject *format, PyObject *args)
 #ifdef Py_USING_UNICODE
                 if (temp != NULL && PyUnicode_Check(temp)) {
                     Py_DECREF(temp);
-                    fmt = fmt_start;
-                    argidx = argidx_start;
+                    fmt += spec->start;
+                    fa.argidx = argidx_start;
                     goto unicode;
                 }
 #endif
@@ -4479,6 +4479,18 @@ PyString_Format(PyObject *format, PyObject *args)
             case 'X':
                 if (c == 'i')
                     c = 'd';
+                if ((c == 'd' || c == 'u') && PyInt_CheckExact(v) &&
+                    prec < 0 && !(flags & F_ALT)) {
+                    /* what formatint() makes of it, without the
+                       snprintf() */
+                    pbuf = stringlib_format_decimal(
+                        formatbuf + FORMATBUFLEN, PyInt_AS_LONG(v));
+                    len = formatbuf + FORMATBUFLEN - pbuf;
+                    sign = 1;
+                    if (flags & F_ZERO)
+                        fill = '0';
+                    break;
+                }
                 isnumok = 0;
                 if (PyNumber_Check(v)) {
                     PyObject *iobj=NULL;
@@ -4547,8 +4559,8 @@ PyString_Format(PyObject *format, PyObject *args)
             case 'c':
 #ifdef Py_USING_UNICODE
                 if (PyUnicode_Check(v)) {
-                    fmt = fmt_start;
-                    argidx = argidx_start;
+                    fmt += spec->start;
+                    fa.argidx = argidx_start;
                     goto unicode;
                 }
 #endif
@@ -4561,9 +4573,7 @@ PyString_Format(PyObject *format, PyObject *args)
                 PyErr_Format(PyExc_ValueError,
                   "unsupported format character '%c' (0x%x) "
                   "at index %zd",
-                  c, c,
-                  (Py_ssize_t)(fmt - 1 -
-                               PyString_AsString(format)));
+                  c, c, spec->pos);
                 goto error;
             }
             if (sign) {
@@ -4582,16 +4592,18 @@ PyString_Format(PyObject *format, PyObject *args)
                 width = len;
             if (rescnt - (sign != 0) < width) {
                 reslen -= rescnt;
-                rescnt = width + fmtcnt + 100;
+                rescnt = width + (reslen >> 1) + 100;
                 reslen += rescnt;
                 if (reslen < 0) {
                     Py_DECREF(result);
                     Py_XDECREF(temp);
-                    return PyErr_NoMemory();
+                    PyErr_NoMemory();
+                    result = NULL;
+                    goto error;
                 }
                 if (_PyString_Resize(&result, reslen)) {
                     Py_XDECREF(temp);
-                    return NULL;
+                    goto error;
                 }
                 res = PyString_AS_STRING(result)
                     + reslen - rescnt;
@@ -4640,7 +4652,7 @@ PyString_Format(PyObject *format, PyObject *args)
                 --rescnt;
                 *res++ = ' ';
             }
-            if (dict && (argidx < arglen) && c != '%') {
+            if (fa.dict && (fa.argidx < fa.arglen) && c != '%') {
                 PyErr_SetString(PyExc_TypeError,
                            "not all arguments converted during string formatting");
                 Py_XDECREF(temp);
@@ -4649,33 +4661,35 @@ PyString_Format(PyObject *format, PyObject *args)
             Py_XDECREF(temp);
         } /* '%' */
     } /* until end */
-    if (argidx < arglen && !dict) {
+    if (fa.argidx < fa.arglen && !fa.dict) {
         PyErr_SetString(PyExc_TypeError,
                         "not all arguments converted during string formatting");
         goto error;
     }
-    if (args_owned) {
-        Py_DECREF(args);
+    if (fa.args_owned) {
+        Py_DECREF(fa.args);
     }
+    code->size_hint = reslen - rescnt;
+    stringlib_format_release(code);
     if (_PyString_Resize(&result, reslen - rescnt))
         return NULL;
     return result;
 
 #ifdef Py_USING_UNICODE
  unicode:
-    if (args_owned) {
-        Py_DECREF(args);
-        args_owned = 0;
+    if (fa.args_owned) {
+        Py_DECREF(fa.args);
+        fa.args_owned = 0;
     }
     /* Fiddle args right (remove the first argidx arguments) */
-    if (PyTuple_Check(orig_args) && argidx > 0) {
+    if (PyTuple_Check(orig_args) && fa.argidx > 0) {
         PyObject *v;
-        Py_ssize_t n = PyTuple_GET_SIZE(orig_args) - argidx;
+        Py_ssize_t n = PyTuple_GET_SIZE(orig_args) - fa.argidx;
         v = PyTuple_New(n);
         if (v == NULL)
             goto error;
         while (--n >= 0) {
-            PyObject *w = PyTuple_GET_ITEM(orig_args, n + argidx);
+            PyObject *w = PyTuple_GET_ITEM(orig_args, n + fa.argidx);
             Py_INCREF(w);
             PyTuple_SET_ITEM(v, n, w);
         }
@@ -4684,21 +4698,29 @@ PyString_Format(PyObject *format, PyObject *args)
         Py_INCREF(orig_args);
         args = orig_args;
     }
-    args_owned = 1;
+    stringlib_format_release(code);
     /* Take what we have of the result and let the Unicode formatting
        function format the rest of the input. */
     rescnt = res - PyString_AS_STRING(result);
-    if (_PyString_Resize(&result, rescnt))
-        goto error;
-    fmtcnt = PyString_GET_SIZE(format) - \
-             (fmt - PyString_AS_STRING(format));
-    format = PyUnicode_Decode(fmt, fmtcnt, NULL, NULL);
-    if (format == NULL)
-        goto error;
+    if (_PyString_Resize(&result, rescnt)) {
+        Py_DECREF(args);
+        return NULL;
+    }
+    format = PyUnicode_Decode(fmt, PyString_GET_SIZE(format) -
+                              (fmt - PyString_AS_STRING(format)),
+                              NULL, NULL);
+    if (format == NULL) {
+        Py_DECREF(result);
+        Py_DECREF(args);
+        return NULL;
+    }
     v = PyUnicode_Format(format, args);
     Py_DECREF(format);
-    if (v == NULL)
-        goto error;
+    if (v == NULL) {
+        Py_DECREF(result);
+        Py_DECREF(args);
+        return NULL;
+    }
     /* Paste what we have (result) to what the Unicode formatting
        function returned (v) and return the result (or error) */
     w = PyUnicode_Concat(result, v);
@@ -4709,10 +4731,11 @@ PyString_Format(PyObject *format, PyObject *args)
 #endif /* Py_USING_UNICODE */
 
  error:
-    Py_DECREF(result);
-    if (args_owned) {
-        Py_DECREF(args);
+    Py_XDECREF(result);
+    if (fa.args_owned) {
+        Py_DECREF(fa.args);
     }
+    stringlib_format_release(code);
     return NULL;
 }
 
@@ -4729,6 +4752,8 @@ PyString_InternInPlace(PyObject **p)
         return;
     if (PyString_CHECK_INTERNED(s))
         return;
+    if (PyString_CHECK_LAZY(s))
+        _PyString_Flatten((PyObject *)s);
     if (interned == NULL) {
         interned = PyDict_New();
         if (interned == NULL) {
@@ -4751,7 +4776,7 @@ PyString_InternInPlace(PyObject **p)
     /* The two references in interned are not counted by refcnt.
        The string deallocator will take care of this */
     Py_REFCNT(s) -= 2;
-    PyString_CHECK_INTERNED(s) = SSTATE_INTERNED_MORTAL;
+    s->ob_sstate = SSTATE_INTERNED_MORTAL;
 }
 
 void
@@ -4759,7 +4784,7 @@ PyString_InternImmortal(PyObject **p)
 {
     PyString_InternInPlace(p);
     if (PyString_CHECK_INTERNED(*p) != SSTATE_INTERNED_IMMORTAL) {
-        PyString_CHECK_INTERNED(*p) = SSTATE_INTERNED_IMMORTAL;
+        ((PyStringObject *)(*p))->ob_sstate = SSTATE_INTERNED_IMMORTAL;
         Py_INCREF(*p);
     }
 }
@@ -4785,6 +4810,7 @@ PyString_Fini(void)
     }
     Py_XDECREF(nullstring);
     nullstring = NULL;
+    stringlib_format_clear_cache();
 }
 
 void _Py_ReleaseInternedStrings(void)
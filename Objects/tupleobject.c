@@ -643,11 +643,12 @@ static PyObject *
 tuple_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
     PyObject *arg = NULL;
-    static char *kwlist[] = {"sequence", 0};
+    static const char * const kwlist[] = {"sequence", 0};
+    static _PyArg_Parser _parser = {"|O:tuple", kwlist, 0};
 
     if (type != &PyTuple_Type)
         return tuple_subtype_new(type, args, kwds);
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:tuple", kwlist, &arg))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser, &arg))
         return NULL;
 
     if (arg == NULL)
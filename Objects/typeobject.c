@@ -1186,6 +1186,63 @@ type_call(PyTypeObject *type, PyObject *args, PyObject *kwds)
     return obj;
 }
 
+// 数据类型（对象）自调用的快速调用版本，参数以数组方式传递
+// + 对于最常见的单参数形式，如 type(x)、int(x)、str(x)，直接转换，无需创建实例后再初始化
+//   其余情况仍然打包成 tuple 和 dict 后交由 type_call 处理
+static PyObject *
+type_fastcall(PyTypeObject *type, PyObject **args, Py_ssize_t nargs,
+              PyObject *kwnames)
+{   // @ PyType_Type.tp_fastcall
+
+    PyObject *callargs, *kwargs = NULL, *result;
+
+    if (nargs == 1 && (kwnames == NULL || PyTuple_GET_SIZE(kwnames) == 0)) {
+        PyObject *x = args[0];
+        int istrue;
+
+        /* These give the same result as the tp_new/tp_init pair of the
+           exact type would; subclasses take the general path. */
+        if (type == &PyType_Type) {
+            Py_INCREF(Py_TYPE(x));
+            return (PyObject *)Py_TYPE(x);
+        }
+        if (type == &PyInt_Type)
+            return PyNumber_Int(x);
+        if (type == &PyFloat_Type) {
+            if (PyString_CheckExact(x))
+                return PyFloat_FromString(x, NULL);
+            return PyNumber_Float(x);
+        }
+        if (type == &PyBool_Type) {
+            istrue = PyObject_IsTrue(x);
+            if (istrue < 0)
+                return NULL;
+            return PyBool_FromLong(istrue);
+        }
+        if (type == &PyString_Type)
+            return PyObject_Str(x);
+        if (type == &PyTuple_Type)
+            return PySequence_Tuple(x);
+        if (type == &PyList_Type)
+            return PySequence_List(x);
+    }
+
+    callargs = _PyStack_AsTuple(args, nargs);
+    if (callargs == NULL)
+        return NULL;
+    if (kwnames != NULL && PyTuple_GET_SIZE(kwnames) > 0) {
+        kwargs = _PyStack_AsDict(args + nargs, kwnames);
+        if (kwargs == NULL) {
+            Py_DECREF(callargs);
+            return NULL;
+        }
+    }
+    result = type_call(type, callargs, kwargs);
+    Py_DECREF(callargs);
+    Py_XDECREF(kwargs);
+    return result;
+}
+
 // 所有数据类型（对象）的 {动态分配一个实例（对象）} 的通用处理
 PyObject *
 PyType_GenericAlloc(PyTypeObject *type, Py_ssize_t nitems)
@@ -2043,7 +2100,7 @@ subtype_dict(PyObject *obj, void *context)
     }
     dict = *dictptr;
     if (dict == NULL)
-        *dictptr = dict = PyDict_New();
+        *dictptr = dict = _PyObjectDict_New(Py_TYPE(obj));
     Py_XINCREF(dict);
     return dict;
 }
@@ -2730,6 +2787,10 @@ type_new(PyTypeObject *metatype, PyObject *args, PyObject *kwds)
     // 初始化该动态数据类型（对象）的（所有）slot 接口的实现
     fixup_slot_dispatchers(type);
 
+    /* Let the instance dicts share their keys */
+    if (type->tp_dictoffset)
+        et->ht_cached_keys = _PyDict_NewKeysForClass();
+
     return (PyObject *)type;
 }
 
@@ -2905,6 +2966,8 @@ type_dealloc(PyTypeObject *type)
     PyObject_Free((char *)type->tp_doc);
     Py_XDECREF(et->ht_name);
     Py_XDECREF(et->ht_slots);
+    if (et->ht_cached_keys)
+        _PyDictKeys_DecRef(et->ht_cached_keys);
     Py_TYPE(type)->tp_free((PyObject *)type);
 }
 
@@ -3054,6 +3117,14 @@ PyTypeObject PyType_Type = {
     type_new,                                   /* tp_new               【重载了 PyBaseObject_Type 的默认实现】*/
     PyObject_GC_Del,                            /* tp_free              【重载了 PyBaseObject_Type 的默认实现】*/
     (inquiry)type_is_gc,                        /* tp_is_gc             【PyBaseObject_Type 未实现过】*/
+    0,                                          /* tp_bases */
+    0,                                          /* tp_mro */
+    0,                                          /* tp_cache */
+    0,                                          /* tp_subclasses */
+    0,                                          /* tp_weaklist */
+    0,                                          /* tp_del */
+    0,                                          /* tp_version_tag */
+    (fastcallfunc)type_fastcall,                /* tp_fastcall          【PyBaseObject_Type 未实现过】*/
 };
 
 ///////////////////////////////////////////////////////////////////////////////
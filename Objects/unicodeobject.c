@@ -103,6 +103,10 @@ static PyUnicodeObject *unicode_empty;
    shared as well. */
 static PyUnicodeObject *unicode_latin1[256];
 
+/* PyUnicode_Format() keeps the parsed form of recent format strings,
+   which must be dropped when they go away or get resized */
+Py_LOCAL_INLINE(void) stringlib_format_forget(PyObject *format);
+
 /* Default encoding to use and assume when NULL is passed as encoding
    parameter; it is initialized by _PyUnicode_Init().
 
@@ -249,6 +253,11 @@ int unicode_resize(register PyUnicodeObject *unicode,
 {
     void *oldstr;
 
+    /* The reset below would drop the pieces of a lazy object */
+    if (PyUnicode_CHECK_LAZY(unicode))
+        _PyUnicode_Flatten((PyObject *)unicode);
+    stringlib_format_forget((PyObject *)unicode);
+
     /* Shortcut if there's nothing much to do. */
     if (unicode->length == length)
         goto reset;
@@ -361,6 +370,7 @@ PyUnicodeObject *_PyUnicode_New(Py_ssize_t length)
     unicode->length = length;
     unicode->hash = -1;
     unicode->defenc = NULL;
+    unicode->kind = 0;
     return unicode;
 
   onError:
@@ -374,7 +384,16 @@ PyUnicodeObject *_PyUnicode_New(Py_ssize_t length)
 static
 void unicode_dealloc(register PyUnicodeObject *unicode)
 {
-    if (PyUnicode_CheckExact(unicode) &&
+    stringlib_format_forget((PyObject *)unicode);
+    if (_PyUnicode_KIND(unicode)) {
+        /* the characters are part of the object, which can't be kept
+           for the free list of the others */
+        if (unicode->str)
+            PyObject_DEL(unicode->str);
+        Py_XDECREF(unicode->defenc);
+        PyObject_Del(unicode);
+    }
+    else if (PyUnicode_CheckExact(unicode) &&
         numfree < PyUnicode_MAXFREELIST) {
         /* Keep-Alive optimization */
         if (unicode->length >= KEEPALIVE_SIZE_LIMIT) {
@@ -397,6 +416,205 @@ void unicode_dealloc(register PyUnicodeObject *unicode)
     }
 }
 
+/* Compact objects.  They are only made by the functions below, always
+   of the exact type, and their characters never change once they are
+   in: _PyUnicode_Resize() turns them into ordinary objects first. */
+
+/* an object with room for length characters of kind bytes each, and a
+   NUL after them; length must be 2 or more, since the empty and the
+   one-character objects are shared */
+static
+PyUnicodeObject *unicode_new_compact(Py_ssize_t length, int kind)
+{
+    PyUnicodeObject *unicode;
+
+    assert(length > 1 && (kind == 1 || kind == 2));
+    if (length > ((PY_SSIZE_T_MAX - sizeof(PyUnicodeObject)) / kind) - 1)
+        return (PyUnicodeObject *)PyErr_NoMemory();
+    unicode = (PyUnicodeObject *)PyObject_MALLOC(
+        sizeof(PyUnicodeObject) + (length + 1) * kind);
+    if (unicode == NULL)
+        return (PyUnicodeObject *)PyErr_NoMemory();
+    PyObject_INIT(unicode, &PyUnicode_Type);
+    unicode->length = length;
+    unicode->str = NULL;
+    unicode->hash = -1;
+    unicode->defenc = NULL;
+    unicode->kind = kind;
+    memset((char *)_PyUnicode_COMPACT_DATA(unicode) + length * kind, 0, kind);
+    return unicode;
+}
+
+/* the object holding the Latin-1 characters s[0:size] */
+static
+PyObject *unicode_fromlatin1(const char *s, Py_ssize_t size)
+{
+    PyUnicodeObject *unicode;
+
+    if (size < 2) {
+        Py_UNICODE c = size ? (unsigned char)*s : 0;
+        return PyUnicode_FromUnicode(&c, size);
+    }
+    unicode = unicode_new_compact(size, 1);
+    if (unicode == NULL)
+        return NULL;
+    Py_MEMCPY(_PyUnicode_COMPACT_DATA(unicode), s, size);
+    return (PyObject *)unicode;
+}
+
+/* Replace unicode, a new object that only the caller refers to, by a
+   compact copy when its characters fit in fewer bytes.  Steals the
+   reference. */
+static
+PyObject *unicode_compact(PyUnicodeObject *unicode)
+{
+    PyUnicodeObject *v;
+    const Py_UNICODE *s;
+    Py_ssize_t i, n;
+    Py_UNICODE bits = 0;
+    int kind;
+
+    if (unicode == NULL || unicode->length < 2 ||
+        !PyUnicode_CheckExact(unicode) || _PyUnicode_KIND(unicode) ||
+        PyUnicode_CHECK_LAZY(unicode))
+        return (PyObject *)unicode;
+    s = unicode->str;
+    n = unicode->length;
+    for (i = 0; i < n; i++)
+        bits |= s[i];
+    if (bits < 256)
+        kind = 1;
+#ifdef Py_UNICODE_WIDE
+    else if (bits < 0x10000)
+        kind = 2;
+#endif
+    else
+        return (PyObject *)unicode;
+
+    v = unicode_new_compact(n, kind);
+    if (v != NULL) {
+        if (kind == 1) {
+            unsigned char *p = _PyUnicode_COMPACT_DATA(v);
+            for (i = 0; i < n; i++)
+                p[i] = (unsigned char)s[i];
+        }
+        else {
+            unsigned short *p = _PyUnicode_COMPACT_DATA(v);
+            for (i = 0; i < n; i++)
+                p[i] = (unsigned short)s[i];
+        }
+    }
+    Py_DECREF(unicode);
+    return (PyObject *)v;
+}
+
+/* ASCII text is scanned a long at a time, from an aligned address */
+#if SIZEOF_LONG == 8
+# define ASCII_CHAR_MASK 0x8080808080808080UL
+#elif SIZEOF_LONG == 4
+# define ASCII_CHAR_MASK 0x80808080UL
+#else
+# error C 'long' size should be either 4 or 8!
+#endif
+#define LONG_PTR_MASK ((size_t)(SIZEOF_LONG - 1))
+
+/* the number of bytes at the start of s[0:size] below 128 */
+Py_LOCAL_INLINE(Py_ssize_t)
+ascii_length(const char *s, Py_ssize_t size)
+{
+    const unsigned char *p = (const unsigned char *)s;
+    const unsigned char *end = p + size;
+
+    while (p < end && ((size_t)p & LONG_PTR_MASK)) {
+        if (*p & 0x80)
+            return p - (const unsigned char *)s;
+        p++;
+    }
+    while (end - p >= SIZEOF_LONG &&
+           !(*(const unsigned long *)p & ASCII_CHAR_MASK))
+        p += SIZEOF_LONG;
+    while (p < end && !(*p & 0x80))
+        p++;
+    return p - (const unsigned char *)s;
+}
+
+/* the number of characters at the start of s[0:size] below limit,
+   which is 128 or 256: a power of two, so that four characters are
+   tested at once by or-ing them */
+Py_LOCAL_INLINE(Py_ssize_t)
+wide_run_length(const Py_UNICODE *s, Py_ssize_t size, Py_UNICODE limit)
+{
+    Py_ssize_t i = 0;
+
+    while (i + 4 <= size && (s[i] | s[i+1] | s[i+2] | s[i+3]) < limit)
+        i += 4;
+    while (i < size && s[i] < limit)
+        i++;
+    return i;
+}
+
+/* Copy the n characters below 256 at s to p, narrowing them */
+Py_LOCAL_INLINE(void)
+latin1_narrow(char *p, const Py_UNICODE *s, Py_ssize_t n)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < n; i++)
+        p[i] = (char)s[i];
+}
+
+/* Copy the n ASCII or Latin-1 characters at s to p; a plain loop,
+   which the compiler can vectorize */
+Py_LOCAL_INLINE(void)
+latin1_widen(Py_UNICODE *p, const char *s, Py_ssize_t n)
+{
+    const unsigned char *q = (const unsigned char *)s;
+    Py_ssize_t i;
+
+    for (i = 0; i < n; i++)
+        p[i] = q[i];
+}
+
+/* The characters of a compact or ordinary object, charsize bytes each.
+   A wide str takes no memory to get, but a lazy one is flattened. */
+#define UNICODE_CHARSIZE(op) \
+    (_PyUnicode_KIND(op) ? _PyUnicode_KIND(op) : (int)sizeof(Py_UNICODE))
+#define UNICODE_DATA(op) \
+    (_PyUnicode_KIND(op) ? _PyUnicode_COMPACT_DATA(op) \
+                         : (void *)PyUnicode_AS_UNICODE(op))
+#define UNICODE_READ(charsize, data, i)                                 \
+    ((charsize) == 1 ? (Py_UNICODE)((const unsigned char *)(data))[i] : \
+     (charsize) == 2 ? (Py_UNICODE)((const unsigned short *)(data))[i] : \
+     ((const Py_UNICODE *)(data))[i])
+
+/* Copy the characters of unicode to p; unlike PyUnicode_AS_UNICODE(),
+   this never allocates, and so never fails */
+static
+void unicode_copy_wide(Py_UNICODE *p, PyUnicodeObject *unicode)
+{
+    Py_ssize_t i, n = unicode->length;
+
+    if (PyUnicode_CHECK_LAZY(unicode))
+        _PyUnicode_Flatten((PyObject *)unicode);
+    switch (_PyUnicode_KIND(unicode)) {
+    case 0:
+        Py_UNICODE_COPY(p, unicode->str, n);
+        break;
+    case 1: {
+        const unsigned char *s = _PyUnicode_COMPACT_DATA(unicode);
+        for (i = 0; i < n; i++)
+            p[i] = s[i];
+        break;
+    }
+    default: {
+        const unsigned short *s = _PyUnicode_COMPACT_DATA(unicode);
+        for (i = 0; i < n; i++)
+            p[i] = s[i];
+        break;
+    }
+    }
+}
+
 static
 int _PyUnicode_Resize(PyUnicodeObject **unicode, Py_ssize_t length)
 {
@@ -428,6 +646,22 @@ int _PyUnicode_Resize(PyUnicodeObject **unicode, Py_ssize_t length)
         return 0;
     }
 
+    /* The caller is about to change the characters, so a compact
+       object is replaced with an ordinary copy. */
+    if (_PyUnicode_KIND(v)) {
+        PyUnicodeObject *w = _PyUnicode_New(length);
+        Py_ssize_t i, n = length < v->length ? length : v->length;
+        int kind = _PyUnicode_KIND(v);
+        void *data = _PyUnicode_COMPACT_DATA(v);
+        if (w == NULL)
+            return -1;
+        for (i = 0; i < n; i++)
+            w->str[i] = UNICODE_READ(kind, data, i);
+        Py_DECREF(*unicode);
+        *unicode = w;
+        return 0;
+    }
+
     /* Note that we don't have to modify *unicode for unshared Unicode
        objects, since we can modify them in-place. */
     return unicode_resize(v, length);
@@ -916,8 +1150,7 @@ PyUnicode_FromFormatV(const char *format, va_list vargs)
             {
                 /* unused, since we already have the result */
                 (void) va_arg(vargs, char *);
-                Py_UNICODE_COPY(s, PyUnicode_AS_UNICODE(*callresult),
-                                PyUnicode_GET_SIZE(*callresult));
+                unicode_copy_wide(s, (PyUnicodeObject *)*callresult);
                 s += PyUnicode_GET_SIZE(*callresult);
                 /* We're done with the unicode()/repr() => forget it */
                 Py_DECREF(*callresult);
@@ -928,9 +1161,8 @@ PyUnicode_FromFormatV(const char *format, va_list vargs)
             case 'U':
             {
                 PyObject *obj = va_arg(vargs, PyObject *);
-                Py_ssize_t size = PyUnicode_GET_SIZE(obj);
-                Py_UNICODE_COPY(s, PyUnicode_AS_UNICODE(obj), size);
-                s += size;
+                unicode_copy_wide(s, (PyUnicodeObject *)obj);
+                s += PyUnicode_GET_SIZE(obj);
                 break;
             }
             case 'V':
@@ -938,9 +1170,8 @@ PyUnicode_FromFormatV(const char *format, va_list vargs)
                 PyObject *obj = va_arg(vargs, PyObject *);
                 const char *str = va_arg(vargs, const char *);
                 if (obj) {
-                    Py_ssize_t size = PyUnicode_GET_SIZE(obj);
-                    Py_UNICODE_COPY(s, PyUnicode_AS_UNICODE(obj), size);
-                    s += size;
+                    unicode_copy_wide(s, (PyUnicodeObject *)obj);
+                    s += PyUnicode_GET_SIZE(obj);
                 } else {
                     appendstring(str);
                 }
@@ -949,15 +1180,10 @@ PyUnicode_FromFormatV(const char *format, va_list vargs)
             case 'S':
             case 'R':
             {
-                Py_UNICODE *ucopy;
-                Py_ssize_t usize;
-                Py_ssize_t upos;
                 /* unused, since we already have the result */
                 (void) va_arg(vargs, PyObject *);
-                ucopy = PyUnicode_AS_UNICODE(*callresult);
-                usize = PyUnicode_GET_SIZE(*callresult);
-                for (upos = 0; upos<usize;)
-                    *s++ = ucopy[upos++];
+                unicode_copy_wide(s, (PyUnicodeObject *)*callresult);
+                s += PyUnicode_GET_SIZE(*callresult);
                 /* We're done with the unicode()/repr() => forget it */
                 Py_DECREF(*callresult);
                 /* switch to next unicode()/repr() result */
@@ -1030,22 +1256,25 @@ Py_ssize_t PyUnicode_AsWideChar(PyUnicodeObject *unicode,
                                 wchar_t *w,
                                 Py_ssize_t size)
 {
+    register Py_UNICODE *u;
+
     if (unicode == NULL) {
         PyErr_BadInternalCall();
         return -1;
     }
+    u = PyUnicode_AS_UNICODE(unicode);
+    if (u == NULL)
+        return -1;
 
     /* If possible, try to copy the 0-termination as well */
     if (size > PyUnicode_GET_SIZE(unicode))
         size = PyUnicode_GET_SIZE(unicode) + 1;
 
 #ifdef HAVE_USABLE_WCHAR_T
-    memcpy(w, unicode->str, size * sizeof(wchar_t));
+    memcpy(w, u, size * sizeof(wchar_t));
 #else
     {
-        register Py_UNICODE *u;
         register Py_ssize_t i;
-        u = PyUnicode_AS_UNICODE(unicode);
         for (i = size; i > 0; i--)
             *w++ = *u++;
     }
@@ -1330,8 +1559,11 @@ PyObject *PyUnicode_AsEncodedString(PyObject *unicode,
 PyObject *_PyUnicode_AsDefaultEncodedString(PyObject *unicode,
                                             const char *errors)
 {
-    PyObject *v = ((PyUnicodeObject *)unicode)->defenc;
+    PyObject *v;
 
+    if (PyUnicode_CHECK_LAZY(unicode))
+        _PyUnicode_Flatten(unicode);
+    v = ((PyUnicodeObject *)unicode)->defenc;
     if (v)
         return v;
     v = PyUnicode_AsEncodedString(unicode, NULL, errors);
@@ -1409,7 +1641,6 @@ int unicode_decode_call_errorhandler(const char *errors, PyObject **errorHandler
     Py_ssize_t outsize = PyUnicode_GET_SIZE(*output);
     Py_ssize_t requiredsize;
     Py_ssize_t newpos;
-    Py_UNICODE *repptr;
     Py_ssize_t repsize;
     int res = -1;
 
@@ -1454,7 +1685,6 @@ int unicode_decode_call_errorhandler(const char *errors, PyObject **errorHandler
        have+the replacement+the rest of the string (starting
        at the new input position), so we won't have to check space
        when there are no errors in the rest of the string) */
-    repptr = PyUnicode_AS_UNICODE(repunicode);
     repsize = PyUnicode_GET_SIZE(repunicode);
     requiredsize = *outpos + repsize + insize-newpos;
     if (requiredsize > outsize) {
@@ -1466,7 +1696,7 @@ int unicode_decode_call_errorhandler(const char *errors, PyObject **errorHandler
     }
     *endinpos = newpos;
     *inptr = input + newpos;
-    Py_UNICODE_COPY(*outptr, repptr, repsize);
+    unicode_copy_wide(*outptr, (PyUnicodeObject *)repunicode);
     *outptr += repsize;
     *outpos += repsize;
     /* we made it! */
@@ -1877,6 +2107,98 @@ char utf8_code_length[256] = {
     4, 4, 4, 4, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0  /* F0-F4 + F5-FF */
 };
 
+/* Runs of 2- and 3-byte sequences are validated a C long of input at a
+   time.  The mask keeps the top bits of each byte, which must be those of
+   a lead byte followed by continuation bytes (10xxxxxx).  UTF8_2_* cover
+   2-byte sequences filling the long, UTF8_3_* the 3-byte sequences that
+   fit whole in it. */
+#if SIZEOF_LONG == 8
+# ifdef BYTEORDER_IS_LITTLE_ENDIAN
+#  define UTF8_2_MASK 0xC0E0C0E0C0E0C0E0UL
+#  define UTF8_2_BITS 0x80C080C080C080C0UL
+#  define UTF8_3_MASK 0x0000C0C0F0C0C0F0UL
+#  define UTF8_3_BITS 0x00008080E08080E0UL
+# else
+#  define UTF8_2_MASK 0xE0C0E0C0E0C0E0C0UL
+#  define UTF8_2_BITS 0xC080C080C080C080UL
+#  define UTF8_3_MASK 0xF0C0C0F0C0C00000UL
+#  define UTF8_3_BITS 0xE08080E080800000UL
+# endif
+#else
+# ifdef BYTEORDER_IS_LITTLE_ENDIAN
+#  define UTF8_2_MASK 0xC0E0C0E0UL
+#  define UTF8_2_BITS 0x80C080C0UL
+#  define UTF8_3_MASK 0x00C0C0F0UL
+#  define UTF8_3_BITS 0x008080E0UL
+# else
+#  define UTF8_2_MASK 0xE0C0E0C0UL
+#  define UTF8_2_BITS 0xC080C080UL
+#  define UTF8_3_MASK 0xF0C0C000UL
+#  define UTF8_3_BITS 0xE0808000UL
+# endif
+#endif
+
+/* Decode the 2-byte sequences at the start of s[0:size] to p, a long at
+   a time, and return the number of bytes decoded.  The run ends at the
+   first long that holds anything else, or an overlong sequence; the
+   caller takes it from there one sequence at a time. */
+Py_LOCAL_INLINE(Py_ssize_t)
+utf8_2byte_run(const char *s, Py_ssize_t size, Py_UNICODE *p)
+{
+    const unsigned char *q = (const unsigned char *)s;
+    const unsigned char *end = q + size;
+    unsigned long w;
+    Py_UCS4 ch, overlong;
+    int k;
+
+    while (end - q >= SIZEOF_LONG) {
+        memcpy(&w, q, SIZEOF_LONG);
+        if ((w & UTF8_2_MASK) != UTF8_2_BITS)
+            break;
+        overlong = 0;
+        for (k = 0; k < SIZEOF_LONG / 2; k++) {
+            ch = ((q[2*k] & 0x1f) << 6) + (q[2*k+1] & 0x3f);
+            overlong |= ch < 0x80;
+            p[k] = (Py_UNICODE)ch;
+        }
+        if (overlong)
+            break;
+        q += SIZEOF_LONG;
+        p += SIZEOF_LONG / 2;
+    }
+    return q - (const unsigned char *)s;
+}
+
+/* The same for 3-byte sequences, SIZEOF_LONG / 3 of them per long read.
+   Surrogates are let through, as in PyUnicode_DecodeUTF8Stateful(). */
+Py_LOCAL_INLINE(Py_ssize_t)
+utf8_3byte_run(const char *s, Py_ssize_t size, Py_UNICODE *p)
+{
+    const unsigned char *q = (const unsigned char *)s;
+    const unsigned char *end = q + size;
+    unsigned long w;
+    Py_UCS4 ch, overlong;
+    int k;
+
+    while (end - q >= SIZEOF_LONG) {
+        memcpy(&w, q, SIZEOF_LONG);
+        if ((w & UTF8_3_MASK) != UTF8_3_BITS)
+            break;
+        overlong = 0;
+        for (k = 0; k < SIZEOF_LONG / 3; k++) {
+            ch = ((q[3*k] & 0x0f) << 12) + ((q[3*k+1] & 0x3f) << 6) +
+                 (q[3*k+2] & 0x3f);
+            overlong |= ch < 0x800;
+            p[k] = (Py_UNICODE)ch;
+        }
+        if (overlong)
+            break;
+        q += SIZEOF_LONG / 3 * 3;
+        p += SIZEOF_LONG / 3;
+    }
+    return q - (const unsigned char *)s;
+}
+
 PyObject *PyUnicode_DecodeUTF8(const char *s,
                                Py_ssize_t size,
                                const char *errors)
@@ -1901,31 +2223,59 @@ PyObject *PyUnicode_DecodeUTF8Stateful(const char *s,
     const char *errmsg = "";
     PyObject *errorHandler = NULL;
     PyObject *exc = NULL;
+    Py_ssize_t run;
+
+    run = ascii_length(s, size);
+    if (run == size) {
+        if (consumed)
+            *consumed = size;
+        return unicode_fromlatin1(s, size);
+    }
 
     /* Note: size will always be longer than the resulting Unicode
        character count */
     unicode = _PyUnicode_New(size);
     if (!unicode)
         return NULL;
-    if (size == 0) {
-        if (consumed)
-            *consumed = 0;
-        return (PyObject *)unicode;
-    }
 
-    /* Unpack UTF-8 encoded data */
+    /* Unpack UTF-8 encoded data, starting after the ASCII already seen */
     p = unicode->str;
     e = s + size;
+    latin1_widen(p, s, run);
+    p += run;
+    s += run;
 
     while (s < e) {
         Py_UCS4 ch = (unsigned char)*s;
 
         if (ch < 0x80) {
-            *p++ = (Py_UNICODE)ch;
-            s++;
+            /* copy the whole run of ASCII */
+            run = ascii_length(s, e - s);
+            latin1_widen(p, s, run);
+            p += run;
+            s += run;
             continue;
         }
 
+        /* validate and decode runs of 2- and 3-byte sequences in blocks,
+           unless the sequence is alone among ASCII */
+        if (e - s >= SIZEOF_LONG) {
+            if (ch < 0xE0 && (s[2] & 0x80)) {
+                run = utf8_2byte_run(s, e - s, p);
+                p += run / 2;
+                s += run;
+                if (run > 0)
+                    continue;
+            }
+            else if (ch >= 0xE0 && ch < 0xF0 && (s[3] & 0x80)) {
+                run = utf8_3byte_run(s, e - s, p);
+                p += run / 3;
+                s += run;
+                if (run > 0)
+                    continue;
+            }
+        }
+
         n = utf8_code_length[ch];
 
         if (s + n > e) {
@@ -2055,7 +2405,7 @@ PyObject *PyUnicode_DecodeUTF8Stateful(const char *s,
 
     Py_XDECREF(errorHandler);
     Py_XDECREF(exc);
-    return (PyObject *)unicode;
+    return unicode_compact(unicode);
 
   onError:
     Py_XDECREF(errorHandler);
@@ -2081,11 +2431,21 @@ PyUnicode_EncodeUTF8(const Py_UNICODE *s,
     char *p;            /* next free byte in output buffer */
     Py_ssize_t nallocated;  /* number of result bytes allocated */
     Py_ssize_t nneeded;        /* number of result bytes needed */
+    Py_ssize_t nascii;      /* length of the ASCII prefix */
     char stackbuf[MAX_SHORT_UNICHARS * 4];
 
     assert(s != NULL);
     assert(size >= 0);
 
+    /* ASCII text is its own encoding, and takes exactly size bytes */
+    nascii = wide_run_length(s, size, 0x80);
+    if (nascii == size) {
+        v = PyString_FromStringAndSize(NULL, size);
+        if (v != NULL)
+            latin1_narrow(PyString_AS_STRING(v), s, size);
+        return v;
+    }
+
     if (size <= MAX_SHORT_UNICHARS) {
         /* Write into the stack buffer; nallocated can't overflow.
          * At the end, we'll allocate exactly as much heap space as it
@@ -2106,7 +2466,9 @@ PyUnicode_EncodeUTF8(const Py_UNICODE *s,
         p = PyString_AS_STRING(v);
     }
 
-    for (i = 0; i < size;) {
+    latin1_narrow(p, s, nascii);
+    p += nascii;
+    for (i = nascii; i < size;) {
         Py_UCS4 ch = s[i++];
 
         if (ch < 0x80)
@@ -2165,13 +2527,53 @@ PyUnicode_EncodeUTF8(const Py_UNICODE *s,
 #undef MAX_SHORT_UNICHARS
 }
 
+/* The UTF-8 encoding of a compact object of Latin-1 characters: ASCII
+   is copied as is, and the others take two bytes */
+static
+PyObject *latin1_encode_utf8(PyUnicodeObject *unicode)
+{
+    const unsigned char *s = _PyUnicode_COMPACT_DATA(unicode);
+    Py_ssize_t i, n = unicode->length, nascii, nhigh = 0;
+    PyObject *v;
+    char *p;
+
+    nascii = ascii_length((const char *)s, n);
+    if (nascii == n)
+        return PyString_FromStringAndSize((const char *)s, n);
+    for (i = nascii; i < n; i++)
+        nhigh += s[i] >> 7;
+    /* n + nhigh <= 2 * n, which fits since the object does */
+    v = PyString_FromStringAndSize(NULL, n + nhigh);
+    if (v == NULL)
+        return NULL;
+    p = PyString_AS_STRING(v);
+    Py_MEMCPY(p, s, nascii);
+    p += nascii;
+    for (i = nascii; i < n; i++) {
+        if (s[i] < 0x80)
+            *p++ = s[i];
+        else {
+            *p++ = (char)(0xc0 | (s[i] >> 6));
+            *p++ = (char)(0x80 | (s[i] & 0x3f));
+        }
+    }
+    return v;
+}
+
 PyObject *PyUnicode_AsUTF8String(PyObject *unicode)
 {
+    Py_UNICODE *u;
+
     if (!PyUnicode_Check(unicode)) {
         PyErr_BadArgument();
         return NULL;
     }
-    return PyUnicode_EncodeUTF8(PyUnicode_AS_UNICODE(unicode),
+    if (_PyUnicode_KIND(unicode) == 1)
+        return latin1_encode_utf8((PyUnicodeObject *)unicode);
+    u = PyUnicode_AS_UNICODE(unicode);
+    if (u == NULL)
+        return NULL;
+    return PyUnicode_EncodeUTF8(u,
                                 PyUnicode_GET_SIZE(unicode),
                                 NULL);
 }
@@ -2439,11 +2841,16 @@ PyUnicode_EncodeUTF32(const Py_UNICODE *s,
 
 PyObject *PyUnicode_AsUTF32String(PyObject *unicode)
 {
+    Py_UNICODE *u;
+
     if (!PyUnicode_Check(unicode)) {
         PyErr_BadArgument();
         return NULL;
     }
-    return PyUnicode_EncodeUTF32(PyUnicode_AS_UNICODE(unicode),
+    u = PyUnicode_AS_UNICODE(unicode);
+    if (u == NULL)
+        return NULL;
+    return PyUnicode_EncodeUTF32(u,
                                  PyUnicode_GET_SIZE(unicode),
                                  NULL,
                                  0);
@@ -2707,11 +3114,16 @@ PyUnicode_EncodeUTF16(const Py_UNICODE *s,
 
 PyObject *PyUnicode_AsUTF16String(PyObject *unicode)
 {
+    Py_UNICODE *u;
+
     if (!PyUnicode_Check(unicode)) {
         PyErr_BadArgument();
         return NULL;
     }
-    return PyUnicode_EncodeUTF16(PyUnicode_AS_UNICODE(unicode),
+    u = PyUnicode_AS_UNICODE(unicode);
+    if (u == NULL)
+        return NULL;
+    return PyUnicode_EncodeUTF16(u,
                                  PyUnicode_GET_SIZE(unicode),
                                  NULL,
                                  0);
@@ -3134,11 +3546,16 @@ PyObject *PyUnicode_EncodeUnicodeEscape(const Py_UNICODE *s,
 
 PyObject *PyUnicode_AsUnicodeEscapeString(PyObject *unicode)
 {
+    Py_UNICODE *u;
+
     if (!PyUnicode_Check(unicode)) {
         PyErr_BadArgument();
         return NULL;
     }
-    return PyUnicode_EncodeUnicodeEscape(PyUnicode_AS_UNICODE(unicode),
+    u = PyUnicode_AS_UNICODE(unicode);
+    if (u == NULL)
+        return NULL;
+    return PyUnicode_EncodeUnicodeEscape(u,
                                          PyUnicode_GET_SIZE(unicode));
 }
 
@@ -3350,11 +3767,16 @@ PyObject *PyUnicode_EncodeRawUnicodeEscape(const Py_UNICODE *s,
 
 PyObject *PyUnicode_AsRawUnicodeEscapeString(PyObject *unicode)
 {
+    Py_UNICODE *u;
+
     if (!PyUnicode_Check(unicode)) {
         PyErr_BadArgument();
         return NULL;
     }
-    return PyUnicode_EncodeRawUnicodeEscape(PyUnicode_AS_UNICODE(unicode),
+    u = PyUnicode_AS_UNICODE(unicode);
+    if (u == NULL)
+        return NULL;
+    return PyUnicode_EncodeRawUnicodeEscape(u,
                                             PyUnicode_GET_SIZE(unicode));
 }
 
@@ -3442,28 +3864,8 @@ PyObject *PyUnicode_DecodeLatin1(const char *s,
                                  Py_ssize_t size,
                                  const char *errors)
 {
-    PyUnicodeObject *v;
-    Py_UNICODE *p;
-
     /* Latin-1 is equivalent to the first 256 ordinals in Unicode. */
-    if (size == 1) {
-        Py_UNICODE r = *(unsigned char*)s;
-        return PyUnicode_FromUnicode(&r, 1);
-    }
-
-    v = _PyUnicode_New(size);
-    if (v == NULL)
-        goto onError;
-    if (size == 0)
-        return (PyObject *)v;
-    p = PyUnicode_AS_UNICODE(v);
-    while (size-- > 0)
-        *p++ = (unsigned char)*s++;
-    return (PyObject *)v;
-
-  onError:
-    Py_XDECREF(v);
-    return NULL;
+    return unicode_fromlatin1(s, size);
 }
 
 /* create or adjust a UnicodeEncodeError */
@@ -3552,6 +3954,11 @@ static PyObject *unicode_encode_call_errorhandler(const char *errors,
         Py_DECREF(restuple);
         return NULL;
     }
+    /* the callers walk the replacement as Py_UNICODE */
+    if (PyUnicode_AS_UNICODE(resunicode) == NULL) {
+        Py_DECREF(restuple);
+        return NULL;
+    }
     Py_INCREF(resunicode);
     Py_DECREF(restuple);
     return resunicode;
@@ -3597,9 +4004,12 @@ static PyObject *unicode_encode_ucs1(const Py_UNICODE *p,
 
         /* can we encode this? */
         if (c<limit) {
-            /* no overflow check, because we know that the space is enough */
-            *str++ = (char)c;
-            ++p;
+            /* no overflow check, because we know that the space is enough;
+               the whole run of encodable characters is copied */
+            Py_ssize_t run = wide_run_length(p, endp - p, (Py_UNICODE)limit);
+            latin1_narrow(str, p, run);
+            str += run;
+            p += run;
         }
         else {
             Py_ssize_t unicodepos = p-startp;
@@ -3741,11 +4151,20 @@ PyObject *PyUnicode_EncodeLatin1(const Py_UNICODE *p,
 
 PyObject *PyUnicode_AsLatin1String(PyObject *unicode)
 {
+    Py_UNICODE *u;
+
     if (!PyUnicode_Check(unicode)) {
         PyErr_BadArgument();
         return NULL;
     }
-    return PyUnicode_EncodeLatin1(PyUnicode_AS_UNICODE(unicode),
+    if (_PyUnicode_KIND(unicode) == 1)
+        return PyString_FromStringAndSize(
+            _PyUnicode_COMPACT_DATA(unicode),
+            PyUnicode_GET_SIZE(unicode));
+    u = PyUnicode_AS_UNICODE(unicode);
+    if (u == NULL)
+        return NULL;
+    return PyUnicode_EncodeLatin1(u,
                                   PyUnicode_GET_SIZE(unicode),
                                   NULL);
 }
@@ -3767,10 +4186,8 @@ PyObject *PyUnicode_DecodeASCII(const char *s,
     PyObject *exc = NULL;
 
     /* ASCII is equivalent to the first 128 ordinals in Unicode. */
-    if (size == 1 && *(unsigned char*)s < 128) {
-        Py_UNICODE r = *(unsigned char*)s;
-        return PyUnicode_FromUnicode(&r, 1);
-    }
+    if (ascii_length(s, size) == size)
+        return unicode_fromlatin1(s, size);
 
     v = _PyUnicode_New(size);
     if (v == NULL)
@@ -3782,8 +4199,10 @@ PyObject *PyUnicode_DecodeASCII(const char *s,
     while (s < e) {
         register unsigned char c = (unsigned char)*s;
         if (c < 128) {
-            *p++ = c;
-            ++s;
+            Py_ssize_t run = ascii_length(s, e - s);
+            latin1_widen(p, s, run);
+            p += run;
+            s += run;
         }
         else {
             startinpos = s-starts;
@@ -3820,11 +4239,23 @@ PyObject *PyUnicode_EncodeASCII(const Py_UNICODE *p,
 
 PyObject *PyUnicode_AsASCIIString(PyObject *unicode)
 {
+    Py_UNICODE *u;
+
     if (!PyUnicode_Check(unicode)) {
         PyErr_BadArgument();
         return NULL;
     }
-    return PyUnicode_EncodeASCII(PyUnicode_AS_UNICODE(unicode),
+    if (_PyUnicode_KIND(unicode) == 1) {
+        /* the error, if any, is raised from the wide characters */
+        const char *s = _PyUnicode_COMPACT_DATA(unicode);
+        Py_ssize_t n = PyUnicode_GET_SIZE(unicode);
+        if (ascii_length(s, n) == n)
+            return PyString_FromStringAndSize(s, n);
+    }
+    u = PyUnicode_AS_UNICODE(unicode);
+    if (u == NULL)
+        return NULL;
+    return PyUnicode_EncodeASCII(u,
                                  PyUnicode_GET_SIZE(unicode),
                                  NULL);
 }
@@ -4031,11 +4462,16 @@ PyObject *PyUnicode_EncodeMBCS(const Py_UNICODE *p,
 
 PyObject *PyUnicode_AsMBCSString(PyObject *unicode)
 {
+    Py_UNICODE *u;
+
     if (!PyUnicode_Check(unicode)) {
         PyErr_BadArgument();
         return NULL;
     }
-    return PyUnicode_EncodeMBCS(PyUnicode_AS_UNICODE(unicode),
+    u = PyUnicode_AS_UNICODE(unicode);
+    if (u == NULL)
+        return NULL;
+    return PyUnicode_EncodeMBCS(u,
                                 PyUnicode_GET_SIZE(unicode),
                                 NULL);
 }
@@ -4061,7 +4497,8 @@ PyObject *PyUnicode_DecodeCharmap(const char *s,
     Py_ssize_t extrachars = 0;
     PyObject *errorHandler = NULL;
     PyObject *exc = NULL;
-    Py_UNICODE *mapstring = NULL;
+    const void *mapdata;
+    int mapkind;
     Py_ssize_t maplen = 0;
 
     /* Default to Latin-1 */
@@ -4076,14 +4513,16 @@ PyObject *PyUnicode_DecodeCharmap(const char *s,
     p = PyUnicode_AS_UNICODE(v);
     e = s + size;
     if (PyUnicode_CheckExact(mapping)) {
-        mapstring = PyUnicode_AS_UNICODE(mapping);
+        /* read the table where it is, compact or not */
+        mapkind = UNICODE_CHARSIZE(mapping);
+        mapdata = UNICODE_DATA(mapping);
         maplen = PyUnicode_GET_SIZE(mapping);
         while (s < e) {
             unsigned char ch = *s;
             Py_UNICODE x = 0xfffe; /* illegal value */
 
             if (ch < maplen)
-                x = mapstring[ch];
+                x = UNICODE_READ(mapkind, mapdata, ch);
 
             if (x == 0xfffe) {
                 /* undefined mapping */
@@ -4156,7 +4595,8 @@ PyObject *PyUnicode_DecodeCharmap(const char *s,
 
                 if (targetsize == 1)
                     /* 1-1 mapping */
-                    *p++ = *PyUnicode_AS_UNICODE(x);
+                    *p++ = UNICODE_READ(UNICODE_CHARSIZE(x),
+                                        UNICODE_DATA(x), 0);
 
                 else if (targetsize > 1) {
                     /* 1-n mapping */
@@ -4174,9 +4614,7 @@ PyObject *PyUnicode_DecodeCharmap(const char *s,
                         }
                         p = PyUnicode_AS_UNICODE(v) + oldpos;
                     }
-                    Py_UNICODE_COPY(p,
-                                    PyUnicode_AS_UNICODE(x),
-                                    targetsize);
+                    unicode_copy_wide(p, (PyUnicodeObject *)x);
                     p += targetsize;
                     extrachars -= targetsize;
                 }
@@ -4298,6 +4736,8 @@ PyUnicode_BuildEncodingMap(PyObject* string)
         return NULL;
     }
     decode = PyUnicode_AS_UNICODE(string);
+    if (decode == NULL)
+        return NULL;
     memset(level1, 0xFF, sizeof level1);
     memset(level2, 0xFF, sizeof level2);
 
@@ -4729,11 +5169,16 @@ PyObject *PyUnicode_EncodeCharmap(const Py_UNICODE *p,
 PyObject *PyUnicode_AsCharmapString(PyObject *unicode,
                                     PyObject *mapping)
 {
+    Py_UNICODE *u;
+
     if (!PyUnicode_Check(unicode) || mapping == NULL) {
         PyErr_BadArgument();
         return NULL;
     }
-    return PyUnicode_EncodeCharmap(PyUnicode_AS_UNICODE(unicode),
+    u = PyUnicode_AS_UNICODE(unicode);
+    if (u == NULL)
+        return NULL;
+    return PyUnicode_EncodeCharmap(u,
                                    PyUnicode_GET_SIZE(unicode),
                                    mapping,
                                    NULL);
@@ -4826,6 +5271,11 @@ static PyObject *unicode_translate_call_errorhandler(const char *errors,
         Py_DECREF(restuple);
         return NULL;
     }
+    /* the callers walk the replacement as Py_UNICODE */
+    if (PyUnicode_AS_UNICODE(resunicode) == NULL) {
+        Py_DECREF(restuple);
+        return NULL;
+    }
     Py_INCREF(resunicode);
     Py_DECREF(restuple);
     return resunicode;
@@ -4928,7 +5378,8 @@ int charmaptranslate_output(const Py_UNICODE *startinp, const Py_UNICODE *curinp
         Py_ssize_t repsize = PyUnicode_GET_SIZE(*res);
         if (repsize==1) {
             /* no overflow check, because we know that the space is enough */
-            *(*outp)++ = *PyUnicode_AS_UNICODE(*res);
+            *(*outp)++ = UNICODE_READ(UNICODE_CHARSIZE(*res),
+                                      UNICODE_DATA(*res), 0);
         }
         else if (repsize!=0) {
             /* more than one character */
@@ -4937,7 +5388,7 @@ int charmaptranslate_output(const Py_UNICODE *startinp, const Py_UNICODE *curinp
                 repsize - 1;
             if (charmaptranslate_makespace(outobj, outp, requiredsize))
                 return -1;
-            memcpy(*outp, PyUnicode_AS_UNICODE(*res), sizeof(Py_UNICODE)*repsize);
+            unicode_copy_wide(*outp, (PyUnicodeObject *)*res);
             *outp += repsize;
         }
     }
@@ -5097,6 +5548,10 @@ PyObject *PyUnicode_Translate(PyObject *str,
     str = PyUnicode_FromObject(str);
     if (str == NULL)
         goto onError;
+    if (PyUnicode_AS_UNICODE(str) == NULL) {
+        Py_DECREF(str);
+        goto onError;
+    }
     result = PyUnicode_TranslateCharmap(PyUnicode_AS_UNICODE(str),
                                         PyUnicode_GET_SIZE(str),
                                         mapping,
@@ -5264,6 +5719,54 @@ int PyUnicode_EncodeDecimal(Py_UNICODE *s,
             start = 0;                          \
     }
 
+/* find, rfind or count (as given by mode) sub in s[start:end] with the
+   8-bit fastsearch(), when s keeps one byte per character and sub is
+   one too or a single character below 256.  Returns 0, without
+   touching *result, when the wide characters must be used instead. */
+static int
+latin1_search(PyUnicodeObject *s, PyUnicodeObject *sub,
+              Py_ssize_t start, Py_ssize_t end, int mode,
+              Py_ssize_t maxcount, Py_ssize_t *result)
+{
+    const char *p;
+    char c;
+    Py_ssize_t pos, m = sub->length;
+
+    if (_PyUnicode_KIND(s) != 1)
+        return 0;
+    if (_PyUnicode_KIND(sub) == 1)
+        p = _PyUnicode_COMPACT_DATA(sub);
+    else if (m == 0)
+        p = "";
+    else if (m == 1 && !_PyUnicode_KIND(sub) &&
+             PyUnicode_AS_UNICODE(sub)[0] < 256) {
+        c = (char)PyUnicode_AS_UNICODE(sub)[0];
+        p = &c;
+    }
+    else
+        return 0;
+
+    /* the same results as stringlib_find_slice() and the others */
+    ADJUST_INDICES(start, end, s->length);
+    if (end - start < 0)
+        *result = mode == FAST_COUNT ? 0 : -1;
+    else if (m == 0) {
+        if (mode == FAST_COUNT)
+            *result = end - start < maxcount ? end - start + 1 : maxcount;
+        else
+            *result = mode == FAST_SEARCH ? start : end;
+    }
+    else {
+        pos = _PyString_FastSearch((char *)_PyUnicode_COMPACT_DATA(s) + start,
+                                   end - start, p, m, maxcount, mode);
+        if (mode == FAST_COUNT)
+            *result = pos < 0 ? 0 : pos;
+        else
+            *result = pos < 0 ? -1 : pos + start;
+    }
+    return 1;
+}
+
 Py_ssize_t PyUnicode_Count(PyObject *str,
                            PyObject *substr,
                            Py_ssize_t start,
@@ -5282,11 +5785,21 @@ Py_ssize_t PyUnicode_Count(PyObject *str,
         return -1;
     }
 
-    ADJUST_INDICES(start, end, str_obj->length);
-    result = stringlib_count(
-        str_obj->str + start, end - start, sub_obj->str, sub_obj->length,
-        PY_SSIZE_T_MAX
-        );
+    if (latin1_search(str_obj, sub_obj, start, end, FAST_COUNT,
+                      PY_SSIZE_T_MAX, &result)) {
+        /* done */
+    }
+    else if (PyUnicode_AS_UNICODE(str_obj) == NULL ||
+             PyUnicode_AS_UNICODE(sub_obj) == NULL)
+        result = -1;
+    else {
+        ADJUST_INDICES(start, end, str_obj->length);
+        result = stringlib_count(
+            PyUnicode_AS_UNICODE(str_obj) + start, end - start,
+            PyUnicode_AS_UNICODE(sub_obj), sub_obj->length,
+            PY_SSIZE_T_MAX
+            );
+    }
 
     Py_DECREF(sub_obj);
     Py_DECREF(str_obj);
@@ -5311,7 +5824,16 @@ Py_ssize_t PyUnicode_Find(PyObject *str,
         return -2;
     }
 
-    if (direction > 0)
+    if (latin1_search((PyUnicodeObject *)str, (PyUnicodeObject *)sub,
+                      start, end,
+                      direction > 0 ? FAST_SEARCH : FAST_RSEARCH, -1,
+                      &result)) {
+        /* done */
+    }
+    else if (PyUnicode_AS_UNICODE(str) == NULL ||
+             PyUnicode_AS_UNICODE(sub) == NULL)
+        result = -2;
+    else if (direction > 0)
         result = stringlib_find_slice(
             PyUnicode_AS_UNICODE(str), PyUnicode_GET_SIZE(str),
             PyUnicode_AS_UNICODE(sub), PyUnicode_GET_SIZE(sub),
@@ -5345,6 +5867,23 @@ int tailmatch(PyUnicodeObject *self,
     if (end < start)
         return 0;
 
+    if (_PyUnicode_KIND(self) || _PyUnicode_KIND(substring)) {
+        /* read compact characters where they are */
+        Py_ssize_t i, offset = direction > 0 ? end : start;
+        int size1 = UNICODE_CHARSIZE(self);
+        int size2 = UNICODE_CHARSIZE(substring);
+        const void *s1 = UNICODE_DATA(self);
+        const void *s2 = UNICODE_DATA(substring);
+        if (size1 == 1 && size2 == 1)
+            return !memcmp((const char *)s1 + offset, s2,
+                           substring->length);
+        for (i = 0; i < substring->length; i++)
+            if (UNICODE_READ(size1, s1, offset + i) !=
+                UNICODE_READ(size2, s2, i))
+                return 0;
+        return 1;
+    }
+
     if (direction > 0) {
         if (Py_UNICODE_MATCH(self, end, substring))
             return 1;
@@ -5395,7 +5934,9 @@ PyObject *fixup(PyUnicodeObject *self,
     if (u == NULL)
         return NULL;
 
-    Py_UNICODE_COPY(u->str, self->str, self->length);
+    if (PyUnicode_CHECK_LAZY(self))
+        _PyUnicode_Flatten((PyObject *)self);
+    unicode_copy_wide(u->str, self);
 
     if (!fixfct(u) && PyUnicode_CheckExact(self)) {
         /* fixfct should return TRUE if it modified the buffer. If
@@ -5589,6 +6130,8 @@ PyUnicode_Join(PyObject *separator, PyObject *seq)
             if (internal_separator == NULL)
                 goto onError;
             sep = PyUnicode_AS_UNICODE(internal_separator);
+            if (sep == NULL)
+                goto onError;
             seplen = PyUnicode_GET_SIZE(internal_separator);
             /* In case PyUnicode_FromObject() mutated seq. */
             seqlen = PySequence_Fast_GET_SIZE(fseq);
@@ -5648,7 +6191,9 @@ PyUnicode_Join(PyObject *separator, PyObject *seq)
         }
 
         /* Copy item, and maybe the separator. */
-        Py_UNICODE_COPY(res_p, PyUnicode_AS_UNICODE(item), itemlen);
+        if (PyUnicode_CHECK_LAZY(item))
+            _PyUnicode_Flatten(item);
+        unicode_copy_wide(res_p, (PyUnicodeObject *)item);
         res_p += itemlen;
         if (i < seqlen - 1) {
             Py_UNICODE_COPY(res_p, sep, seplen);
@@ -5709,7 +6254,7 @@ PyUnicodeObject *pad(PyUnicodeObject *self,
     if (u) {
         if (left)
             Py_UNICODE_FILL(u->str, fill, left);
-        Py_UNICODE_COPY(u->str + left, self->str, self->length);
+        unicode_copy_wide(u->str + left, self);
         if (right)
             Py_UNICODE_FILL(u->str + left + self->length, fill, right);
     }
@@ -5724,6 +6269,10 @@ PyObject *PyUnicode_Splitlines(PyObject *string, int keepends)
     string = PyUnicode_FromObject(string);
     if (string == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(string) == NULL) {
+        Py_DECREF(string);
+        return NULL;
+    }
 
     list = stringlib_splitlines(
         (PyObject*) string, PyUnicode_AS_UNICODE(string),
@@ -5740,15 +6289,19 @@ PyObject *split(PyUnicodeObject *self,
 {
     if (maxcount < 0)
         maxcount = PY_SSIZE_T_MAX;
+    if (PyUnicode_AS_UNICODE(self) == NULL ||
+        (substring != NULL && PyUnicode_AS_UNICODE(substring) == NULL))
+        return NULL;
 
     if (substring == NULL)
         return stringlib_split_whitespace(
-            (PyObject*) self,  self->str, self->length, maxcount
+            (PyObject*) self,  PyUnicode_AS_UNICODE(self), self->length,
+            maxcount
             );
 
     return stringlib_split(
-        (PyObject*) self,  self->str, self->length,
-        substring->str, substring->length,
+        (PyObject*) self,  PyUnicode_AS_UNICODE(self), self->length,
+        PyUnicode_AS_UNICODE(substring), substring->length,
         maxcount
         );
 }
@@ -5760,15 +6313,19 @@ PyObject *rsplit(PyUnicodeObject *self,
 {
     if (maxcount < 0)
         maxcount = PY_SSIZE_T_MAX;
+    if (PyUnicode_AS_UNICODE(self) == NULL ||
+        (substring != NULL && PyUnicode_AS_UNICODE(substring) == NULL))
+        return NULL;
 
     if (substring == NULL)
         return stringlib_rsplit_whitespace(
-            (PyObject*) self,  self->str, self->length, maxcount
+            (PyObject*) self,  PyUnicode_AS_UNICODE(self), self->length,
+            maxcount
             );
 
     return stringlib_rsplit(
-        (PyObject*) self,  self->str, self->length,
-        substring->str, substring->length,
+        (PyObject*) self,  PyUnicode_AS_UNICODE(self), self->length,
+        PyUnicode_AS_UNICODE(substring), substring->length,
         maxcount
         );
 }
@@ -5786,6 +6343,12 @@ PyObject *replace(PyUnicodeObject *self,
     else if (maxcount == 0 || self->length == 0)
         goto nothing;
 
+    /* the code below reads str directly */
+    if (PyUnicode_AS_UNICODE(self) == NULL ||
+        PyUnicode_AS_UNICODE(str1) == NULL ||
+        PyUnicode_AS_UNICODE(str2) == NULL)
+        return NULL;
+
     if (str1->length == str2->length) {
         Py_ssize_t i;
         /* same length */
@@ -5984,7 +6547,6 @@ convert_uc(PyObject *obj, void *addr)
 {
     Py_UNICODE *fillcharloc = (Py_UNICODE *)addr;
     PyObject *uniobj;
-    Py_UNICODE *unistr;
 
     uniobj = PyUnicode_FromObject(obj);
     if (uniobj == NULL) {
@@ -5998,8 +6560,8 @@ convert_uc(PyObject *obj, void *addr)
         Py_DECREF(uniobj);
         return 0;
     }
-    unistr = PyUnicode_AS_UNICODE(uniobj);
-    *fillcharloc = unistr[0];
+    *fillcharloc = UNICODE_READ(UNICODE_CHARSIZE(uniobj),
+                                UNICODE_DATA(uniobj), 0);
     Py_DECREF(uniobj);
     return 1;
 }
@@ -6050,12 +6612,12 @@ static short utf16Fixup[32] =
 };
 
 static int
-unicode_compare(PyUnicodeObject *str1, PyUnicodeObject *str2)
+unicode_compare_wide(PyUnicodeObject *str1, PyUnicodeObject *str2)
 {
     Py_ssize_t len1, len2;
 
-    Py_UNICODE *s1 = str1->str;
-    Py_UNICODE *s2 = str2->str;
+    Py_UNICODE *s1 = PyUnicode_AS_UNICODE(str1);
+    Py_UNICODE *s2 = PyUnicode_AS_UNICODE(str2);
 
     len1 = str1->length;
     len2 = str2->length;
@@ -6084,12 +6646,12 @@ unicode_compare(PyUnicodeObject *str1, PyUnicodeObject *str2)
 #else
 
 static int
-unicode_compare(PyUnicodeObject *str1, PyUnicodeObject *str2)
+unicode_compare_wide(PyUnicodeObject *str1, PyUnicodeObject *str2)
 {
     register Py_ssize_t len1, len2;
 
-    Py_UNICODE *s1 = str1->str;
-    Py_UNICODE *s2 = str2->str;
+    Py_UNICODE *s1 = PyUnicode_AS_UNICODE(str1);
+    Py_UNICODE *s2 = PyUnicode_AS_UNICODE(str2);
 
     len1 = str1->length;
     len2 = str2->length;
@@ -6111,6 +6673,40 @@ unicode_compare(PyUnicodeObject *str1, PyUnicodeObject *str2)
 
 #endif
 
+/* compact objects are compared without making their wide copy */
+static int
+unicode_compare(PyUnicodeObject *str1, PyUnicodeObject *str2)
+{
+    Py_ssize_t i, n, len1, len2;
+    const void *s1, *s2;
+    int size1, size2;
+
+    if (!_PyUnicode_KIND(str1) && !_PyUnicode_KIND(str2))
+        return unicode_compare_wide(str1, str2);
+
+    len1 = str1->length;
+    len2 = str2->length;
+    n = len1 < len2 ? len1 : len2;
+    s1 = UNICODE_DATA(str1);
+    s2 = UNICODE_DATA(str2);
+    size1 = UNICODE_CHARSIZE(str1);
+    size2 = UNICODE_CHARSIZE(str2);
+    if (size1 == 1 && size2 == 1) {
+        int r = memcmp(s1, s2, n);
+        if (r != 0)
+            return r < 0 ? -1 : 1;
+    }
+    else {
+        for (i = 0; i < n; i++) {
+            Py_UNICODE c1 = UNICODE_READ(size1, s1, i);
+            Py_UNICODE c2 = UNICODE_READ(size2, s2, i);
+            if (c1 != c2)
+                return (c1 < c2) ? -1 : 1;
+        }
+    }
+    return (len1 < len2) ? -1 : (len1 != len2);
+}
+
 int PyUnicode_Compare(PyObject *left,
                       PyObject *right)
 {
@@ -6224,6 +6820,7 @@ int PyUnicode_Contains(PyObject *container,
                        PyObject *element)
 {
     PyObject *str, *sub;
+    Py_ssize_t pos;
     int result;
 
     /* Coerce the two arguments */
@@ -6238,7 +6835,14 @@ int PyUnicode_Contains(PyObject *container,
         return -1;
     }
 
-    result = stringlib_contains_obj(str, sub);
+    if (latin1_search((PyUnicodeObject *)str, (PyUnicodeObject *)sub,
+                      0, PY_SSIZE_T_MAX, FAST_SEARCH, -1, &pos))
+        result = pos != -1;
+    else if (PyUnicode_AS_UNICODE(str) == NULL ||
+             PyUnicode_AS_UNICODE(sub) == NULL)
+        result = -1;
+    else
+        result = stringlib_contains_obj(str, sub);
 
     Py_DECREF(str);
     Py_DECREF(sub);
@@ -6272,11 +6876,31 @@ PyObject *PyUnicode_Concat(PyObject *left,
     }
 
     /* Concat the two Unicode strings */
-    w = _PyUnicode_New(u->length + v->length);
-    if (w == NULL)
+    if (u->length > PY_SSIZE_T_MAX - v->length) {
+        PyErr_SetString(PyExc_OverflowError,
+                        "strings are too large to concat");
         goto onError;
-    Py_UNICODE_COPY(w->str, u->str, u->length);
-    Py_UNICODE_COPY(w->str + u->length, v->str, v->length);
+    }
+    if (_PyUnicode_KIND(u) == 1 && _PyUnicode_KIND(v) == 1) {
+        w = unicode_new_compact(u->length + v->length, 1);
+        if (w == NULL)
+            goto onError;
+        Py_MEMCPY(_PyUnicode_COMPACT_DATA(w),
+                  _PyUnicode_COMPACT_DATA(u), u->length);
+        Py_MEMCPY((char *)_PyUnicode_COMPACT_DATA(w) + u->length,
+                  _PyUnicode_COMPACT_DATA(v), v->length);
+    }
+    else {
+        if (PyUnicode_CHECK_LAZY(u))
+            _PyUnicode_Flatten((PyObject *)u);
+        if (PyUnicode_CHECK_LAZY(v))
+            _PyUnicode_Flatten((PyObject *)v);
+        w = _PyUnicode_New(u->length + v->length);
+        if (w == NULL)
+            goto onError;
+        unicode_copy_wide(w->str, u);
+        unicode_copy_wide(w->str + u->length, v);
+    }
 
     Py_DECREF(u);
     Py_DECREF(v);
@@ -6288,6 +6912,116 @@ PyObject *PyUnicode_Concat(PyObject *left,
     return NULL;
 }
 
+/* Deferred concatenation, the unicode version of _PyString_ConcatLazy():
+   a long enough result of u += v keeps the list of its pieces in defenc
+   and their number at the start of str, and the characters are copied
+   in when PyUnicode_AS_UNICODE() is first used on it. */
+
+/* shorter results are copied right away */
+#define LAZY_CONCAT_MIN 512
+
+PyObject *
+_PyUnicode_ConcatLazy(PyObject *left, PyObject *right)
+{
+    PyUnicodeObject *u = (PyUnicodeObject *)left;
+    PyUnicodeObject *v = (PyUnicodeObject *)right;
+    PyUnicodeObject *w;
+    PyObject *pieces;
+    Py_ssize_t count;
+
+    assert(PyUnicode_CheckExact(u) && PyUnicode_CheckExact(v));
+    if (u->length == 0 || v->length == 0 ||
+        u->length > PY_SSIZE_T_MAX - v->length ||
+        (!PyUnicode_CHECK_LAZY(u) &&
+         u->length + v->length < LAZY_CONCAT_MIN))
+        return PyUnicode_Concat(left, right);
+
+    /* the pieces themselves are never lazy */
+    if (PyUnicode_CHECK_LAZY(v))
+        _PyUnicode_Flatten(right);
+    if (PyUnicode_CHECK_LAZY(u)) {
+        Py_MEMCPY(&count, u->str, sizeof(count));
+        if (PyList_GET_SIZE(u->defenc) == count) {
+            /* nothing was appended after u's pieces yet */
+            pieces = u->defenc;
+            Py_INCREF(pieces);
+        }
+        else {
+            pieces = PyList_GetSlice(u->defenc, 0, count);
+            if (pieces == NULL)
+                return NULL;
+        }
+        if (PyList_Append(pieces, right) < 0) {
+            Py_DECREF(pieces);
+            return NULL;
+        }
+        count++;
+    }
+    else {
+        pieces = PyList_New(2);
+        if (pieces == NULL)
+            return NULL;
+        Py_INCREF(left);
+        PyList_SET_ITEM(pieces, 0, left);
+        Py_INCREF(right);
+        PyList_SET_ITEM(pieces, 1, right);
+        count = 2;
+    }
+
+    w = _PyUnicode_New(u->length + v->length);
+    if (w == NULL) {
+        Py_DECREF(pieces);
+        return NULL;
+    }
+    Py_MEMCPY(w->str, &count, sizeof(count));
+    w->defenc = pieces;
+    return (PyObject *)w;
+}
+
+/* Copy the pieces of a lazy unicode object into it, and return str */
+Py_UNICODE *
+_PyUnicode_Flatten(PyObject *op)
+{
+    PyUnicodeObject *u = (PyUnicodeObject *)op;
+    PyUnicodeObject *piece;
+    PyObject *pieces = u->defenc;
+    Py_UNICODE *p = u->str;
+    Py_ssize_t i, count;
+
+    assert(PyUnicode_CHECK_LAZY(u));
+    Py_MEMCPY(&count, u->str, sizeof(count));
+    for (i = 0; i < count; i++) {
+        piece = (PyUnicodeObject *)PyList_GET_ITEM(pieces, i);
+        unicode_copy_wide(p, piece);
+        p += piece->length;
+    }
+    assert(p == u->str + u->length);
+    *p = 0;
+    u->defenc = NULL;
+    Py_DECREF(pieces);
+    return u->str;
+}
+
+/* Return str, after copying in the pieces of a lazy object, or the
+   characters of a compact one, for which str is allocated */
+Py_UNICODE *
+_PyUnicode_AsWide(PyObject *op)
+{
+    PyUnicodeObject *u = (PyUnicodeObject *)op;
+
+    if (PyUnicode_CHECK_LAZY(u))
+        return _PyUnicode_Flatten(op);
+    assert(_PyUnicode_KIND(u) && u->str == NULL);
+    u->str = PyObject_MALLOC(sizeof(Py_UNICODE) * (u->length + 1));
+    if (u->str == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    unicode_copy_wide(u->str, u);
+    u->str[u->length] = 0;
+    return u->str;
+}
+
 PyDoc_STRVAR(count__doc__,
              "S.count(sub[, start[, end]]) -> int\n\
 \n\
@@ -6301,18 +7035,27 @@ unicode_count(PyUnicodeObject *self, PyObject *args)
     PyUnicodeObject *substring;
     Py_ssize_t start = 0;
     Py_ssize_t end = PY_SSIZE_T_MAX;
+    Py_ssize_t count;
     PyObject *result;
 
     if (!stringlib_parse_args_finds_unicode("count", args, &substring,
                                             &start, &end))
         return NULL;
 
-    ADJUST_INDICES(start, end, self->length);
-    result = PyInt_FromSsize_t(
-        stringlib_count(self->str + start, end - start,
-                        substring->str, substring->length,
-                        PY_SSIZE_T_MAX)
-        );
+    if (latin1_search(self, substring, start, end, FAST_COUNT,
+                      PY_SSIZE_T_MAX, &count))
+        result = PyInt_FromSsize_t(count);
+    else if (PyUnicode_AS_UNICODE(self) == NULL ||
+             PyUnicode_AS_UNICODE(substring) == NULL)
+        result = NULL;
+    else {
+        ADJUST_INDICES(start, end, self->length);
+        result = PyInt_FromSsize_t(
+            stringlib_count(PyUnicode_AS_UNICODE(self) + start, end - start,
+                            PyUnicode_AS_UNICODE(substring),
+                            substring->length, PY_SSIZE_T_MAX)
+            );
+    }
 
     Py_DECREF(substring);
 
@@ -6332,13 +7075,14 @@ codecs.register_error that can handle UnicodeEncodeErrors.");
 static PyObject *
 unicode_encode(PyUnicodeObject *self, PyObject *args, PyObject *kwargs)
 {
-    static char *kwlist[] = {"encoding", "errors", 0};
+    static const char * const kwlist[] = {"encoding", "errors", 0};
+    static _PyArg_Parser _parser = {"|ss:encode", kwlist, 0};
     char *encoding = NULL;
     char *errors = NULL;
     PyObject *v;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ss:encode",
-                                     kwlist, &encoding, &errors))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwargs, &_parser,
+                                          &encoding, &errors))
         return NULL;
     v = PyUnicode_AsEncodedObject((PyObject *)self, encoding, errors);
     if (v == NULL)
@@ -6370,13 +7114,14 @@ able to handle UnicodeDecodeErrors.");
 static PyObject *
 unicode_decode(PyUnicodeObject *self, PyObject *args, PyObject *kwargs)
 {
-    static char *kwlist[] = {"encoding", "errors", 0};
+    static const char * const kwlist[] = {"encoding", "errors", 0};
+    static _PyArg_Parser _parser = {"|ss:decode", kwlist, 0};
     char *encoding = NULL;
     char *errors = NULL;
     PyObject *v;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ss:decode",
-                                     kwlist, &encoding, &errors))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwargs, &_parser,
+                                          &encoding, &errors))
         return NULL;
     v = PyUnicode_AsDecodedObject((PyObject *)self, encoding, errors);
     if (v == NULL)
@@ -6414,11 +7159,13 @@ unicode_expandtabs(PyUnicodeObject *self, PyObject *args)
 
     if (!PyArg_ParseTuple(args, "|i:expandtabs", &tabsize))
         return NULL;
+    if (PyUnicode_AS_UNICODE(self) == NULL)
+        return NULL;
 
     /* First pass: determine size of output string */
     i = 0; /* chars up to and including most recent \n or \r */
     j = 0; /* chars since most recent \n or \r (use in tab calculations) */
-    e = self->str + self->length; /* end of input */
+    e = PyUnicode_AS_UNICODE(self) + self->length; /* end of input */
     for (p = self->str; p < e; p++)
         if (*p == '\t') {
             if (tabsize > 0) {
@@ -6503,11 +7250,18 @@ unicode_find(PyUnicodeObject *self, PyObject *args)
                                             &start, &end))
         return NULL;
 
-    result = stringlib_find_slice(
-        PyUnicode_AS_UNICODE(self), PyUnicode_GET_SIZE(self),
-        PyUnicode_AS_UNICODE(substring), PyUnicode_GET_SIZE(substring),
-        start, end
-        );
+    if (!latin1_search(self, substring, start, end, FAST_SEARCH, -1, &result)) {
+        if (PyUnicode_AS_UNICODE(self) == NULL ||
+            PyUnicode_AS_UNICODE(substring) == NULL) {
+            Py_DECREF(substring);
+            return NULL;
+        }
+        result = stringlib_find_slice(
+            PyUnicode_AS_UNICODE(self), PyUnicode_GET_SIZE(self),
+            PyUnicode_AS_UNICODE(substring), PyUnicode_GET_SIZE(substring),
+            start, end
+            );
+    }
 
     Py_DECREF(substring);
 
@@ -6522,7 +7276,13 @@ unicode_getitem(PyUnicodeObject *self, Py_ssize_t index)
         return NULL;
     }
 
-    return (PyObject*) PyUnicode_FromUnicode(&self->str[index], 1);
+    if (_PyUnicode_KIND(self)) {
+        Py_UNICODE c = UNICODE_READ(_PyUnicode_KIND(self),
+                                    _PyUnicode_COMPACT_DATA(self), index);
+        return PyUnicode_FromUnicode(&c, 1);
+    }
+    return (PyObject*) PyUnicode_FromUnicode(
+        &PyUnicode_AS_UNICODE(self)[index], 1);
 }
 
 static long
@@ -6534,35 +7294,12 @@ unicode_hash(PyUnicodeObject *self)
        strings and Unicode objects behave in the same way as
        dictionary keys. */
 
-    register Py_ssize_t len;
-    register Py_UNICODE *p;
-    register long x;
-
-#ifdef Py_DEBUG
-    assert(_Py_HashSecret_Initialized);
-#endif
     if (self->hash != -1)
         return self->hash;
-    len = PyUnicode_GET_SIZE(self);
-    /*
-      We make the hash of the empty string be 0, rather than using
-      (prefix ^ suffix), since this slightly obfuscates the hash secret
-    */
-    if (len == 0) {
-        self->hash = 0;
-        return 0;
-    }
-    p = PyUnicode_AS_UNICODE(self);
-    x = _Py_HashSecret.prefix;
-    x ^= *p << 7;
-    while (--len >= 0)
-        x = (1000003*x) ^ *p++;
-    x ^= PyUnicode_GET_SIZE(self);
-    x ^= _Py_HashSecret.suffix;
-    if (x == -1)
-        x = -2;
-    self->hash = x;
-    return x;
+    self->hash = _Py_HashChars(UNICODE_DATA(self),
+                               PyUnicode_GET_SIZE(self),
+                               UNICODE_CHARSIZE(self));
+    return self->hash;
 }
 
 PyDoc_STRVAR(index__doc__,
@@ -6582,11 +7319,18 @@ unicode_index(PyUnicodeObject *self, PyObject *args)
                                             &start, &end))
         return NULL;
 
-    result = stringlib_find_slice(
-        PyUnicode_AS_UNICODE(self), PyUnicode_GET_SIZE(self),
-        PyUnicode_AS_UNICODE(substring), PyUnicode_GET_SIZE(substring),
-        start, end
-        );
+    if (!latin1_search(self, substring, start, end, FAST_SEARCH, -1, &result)) {
+        if (PyUnicode_AS_UNICODE(self) == NULL ||
+            PyUnicode_AS_UNICODE(substring) == NULL) {
+            Py_DECREF(substring);
+            return NULL;
+        }
+        result = stringlib_find_slice(
+            PyUnicode_AS_UNICODE(self), PyUnicode_GET_SIZE(self),
+            PyUnicode_AS_UNICODE(substring), PyUnicode_GET_SIZE(substring),
+            start, end
+            );
+    }
 
     Py_DECREF(substring);
 
@@ -6611,6 +7355,9 @@ unicode_islower(PyUnicodeObject *self)
     register const Py_UNICODE *e;
     int cased;
 
+    if (p == NULL)
+        return NULL;
+
     /* Shortcut for single character strings */
     if (PyUnicode_GET_SIZE(self) == 1)
         return PyBool_FromLong(Py_UNICODE_ISLOWER(*p));
@@ -6645,6 +7392,9 @@ unicode_isupper(PyUnicodeObject *self)
     register const Py_UNICODE *e;
     int cased;
 
+    if (p == NULL)
+        return NULL;
+
     /* Shortcut for single character strings */
     if (PyUnicode_GET_SIZE(self) == 1)
         return PyBool_FromLong(Py_UNICODE_ISUPPER(*p) != 0);
@@ -6681,6 +7431,9 @@ unicode_istitle(PyUnicodeObject *self)
     register const Py_UNICODE *e;
     int cased, previous_is_cased;
 
+    if (p == NULL)
+        return NULL;
+
     /* Shortcut for single character strings */
     if (PyUnicode_GET_SIZE(self) == 1)
         return PyBool_FromLong((Py_UNICODE_ISTITLE(*p) != 0) ||
@@ -6726,6 +7479,9 @@ unicode_isspace(PyUnicodeObject *self)
     register const Py_UNICODE *p = PyUnicode_AS_UNICODE(self);
     register const Py_UNICODE *e;
 
+    if (p == NULL)
+        return NULL;
+
     /* Shortcut for single character strings */
     if (PyUnicode_GET_SIZE(self) == 1 &&
         Py_UNICODE_ISSPACE(*p))
@@ -6755,6 +7511,9 @@ unicode_isalpha(PyUnicodeObject *self)
     register const Py_UNICODE *p = PyUnicode_AS_UNICODE(self);
     register const Py_UNICODE *e;
 
+    if (p == NULL)
+        return NULL;
+
     /* Shortcut for single character strings */
     if (PyUnicode_GET_SIZE(self) == 1 &&
         Py_UNICODE_ISALPHA(*p))
@@ -6784,6 +7543,9 @@ unicode_isalnum(PyUnicodeObject *self)
     register const Py_UNICODE *p = PyUnicode_AS_UNICODE(self);
     register const Py_UNICODE *e;
 
+    if (p == NULL)
+        return NULL;
+
     /* Shortcut for single character strings */
     if (PyUnicode_GET_SIZE(self) == 1 &&
         Py_UNICODE_ISALNUM(*p))
@@ -6813,6 +7575,9 @@ unicode_isdecimal(PyUnicodeObject *self)
     register const Py_UNICODE *p = PyUnicode_AS_UNICODE(self);
     register const Py_UNICODE *e;
 
+    if (p == NULL)
+        return NULL;
+
     /* Shortcut for single character strings */
     if (PyUnicode_GET_SIZE(self) == 1 &&
         Py_UNICODE_ISDECIMAL(*p))
@@ -6842,6 +7607,9 @@ unicode_isdigit(PyUnicodeObject *self)
     register const Py_UNICODE *p = PyUnicode_AS_UNICODE(self);
     register const Py_UNICODE *e;
 
+    if (p == NULL)
+        return NULL;
+
     /* Shortcut for single character strings */
     if (PyUnicode_GET_SIZE(self) == 1 &&
         Py_UNICODE_ISDIGIT(*p))
@@ -6871,6 +7639,9 @@ unicode_isnumeric(PyUnicodeObject *self)
     register const Py_UNICODE *p = PyUnicode_AS_UNICODE(self);
     register const Py_UNICODE *e;
 
+    if (p == NULL)
+        return NULL;
+
     /* Shortcut for single character strings */
     if (PyUnicode_GET_SIZE(self) == 1 &&
         Py_UNICODE_ISNUMERIC(*p))
@@ -6958,8 +7729,11 @@ _PyUnicode_XStrip(PyUnicodeObject *self, int striptype, PyObject *sepobj)
     Py_UNICODE *sep = PyUnicode_AS_UNICODE(sepobj);
     Py_ssize_t seplen = PyUnicode_GET_SIZE(sepobj);
     Py_ssize_t i, j;
+    BLOOM_MASK sepmask;
 
-    BLOOM_MASK sepmask = make_bloom_mask(sep, seplen);
+    if (s == NULL || sep == NULL)
+        return NULL;
+    sepmask = make_bloom_mask(sep, seplen);
 
     i = 0;
     if (striptype != RIGHTSTRIP) {
@@ -6991,6 +7765,8 @@ do_strip(PyUnicodeObject *self, int striptype)
     Py_UNICODE *s = PyUnicode_AS_UNICODE(self);
     Py_ssize_t len = PyUnicode_GET_SIZE(self), i, j;
 
+    if (s == NULL)
+        return NULL;
     i = 0;
     if (striptype != RIGHTSTRIP) {
         while (i < len && Py_UNICODE_ISSPACE(s[i])) {
@@ -7138,11 +7914,12 @@ unicode_repeat(PyUnicodeObject *str, Py_ssize_t len)
     p = u->str;
 
     if (str->length == 1 && len > 0) {
-        Py_UNICODE_FILL(p, str->str[0], len);
+        Py_UNICODE_FILL(p, UNICODE_READ(UNICODE_CHARSIZE(str),
+                                        UNICODE_DATA(str), 0), len);
     } else {
         Py_ssize_t done = 0; /* number of characters copied this far */
         if (done < nchars) {
-            Py_UNICODE_COPY(p, str->str, str->length);
+            unicode_copy_wide(p, str);
             done = str->length;
         }
         while (done < nchars) {
@@ -7225,6 +8002,8 @@ unicode_replace(PyUnicodeObject *self, PyObject *args)
 static
 PyObject *unicode_repr(PyObject *unicode)
 {
+    if (PyUnicode_AS_UNICODE(unicode) == NULL)
+        return NULL;
     return unicodeescape_string(PyUnicode_AS_UNICODE(unicode),
                                 PyUnicode_GET_SIZE(unicode),
                                 1);
@@ -7251,11 +8030,18 @@ unicode_rfind(PyUnicodeObject *self, PyObject *args)
                                             &start, &end))
         return NULL;
 
-    result = stringlib_rfind_slice(
-        PyUnicode_AS_UNICODE(self), PyUnicode_GET_SIZE(self),
-        PyUnicode_AS_UNICODE(substring), PyUnicode_GET_SIZE(substring),
-        start, end
-        );
+    if (!latin1_search(self, substring, start, end, FAST_RSEARCH, -1, &result)) {
+        if (PyUnicode_AS_UNICODE(self) == NULL ||
+            PyUnicode_AS_UNICODE(substring) == NULL) {
+            Py_DECREF(substring);
+            return NULL;
+        }
+        result = stringlib_rfind_slice(
+            PyUnicode_AS_UNICODE(self), PyUnicode_GET_SIZE(self),
+            PyUnicode_AS_UNICODE(substring), PyUnicode_GET_SIZE(substring),
+            start, end
+            );
+    }
 
     Py_DECREF(substring);
 
@@ -7279,11 +8065,18 @@ unicode_rindex(PyUnicodeObject *self, PyObject *args)
                                             &start, &end))
         return NULL;
 
-    result = stringlib_rfind_slice(
-        PyUnicode_AS_UNICODE(self), PyUnicode_GET_SIZE(self),
-        PyUnicode_AS_UNICODE(substring), PyUnicode_GET_SIZE(substring),
-        start, end
-        );
+    if (!latin1_search(self, substring, start, end, FAST_RSEARCH, -1, &result)) {
+        if (PyUnicode_AS_UNICODE(self) == NULL ||
+            PyUnicode_AS_UNICODE(substring) == NULL) {
+            Py_DECREF(substring);
+            return NULL;
+        }
+        result = stringlib_rfind_slice(
+            PyUnicode_AS_UNICODE(self), PyUnicode_GET_SIZE(self),
+            PyUnicode_AS_UNICODE(substring), PyUnicode_GET_SIZE(substring),
+            start, end
+            );
+    }
 
     Py_DECREF(substring);
 
@@ -7335,8 +8128,13 @@ unicode_slice(PyUnicodeObject *self, Py_ssize_t start, Py_ssize_t end)
     if (start > end)
         start = end;
     /* copy slice */
-    return (PyObject*) PyUnicode_FromUnicode(self->str + start,
-                                             end - start);
+    if (_PyUnicode_KIND(self) == 1)
+        return unicode_fromlatin1(
+            (char *)_PyUnicode_COMPACT_DATA(self) + start, end - start);
+    if (PyUnicode_AS_UNICODE(self) == NULL)
+        return NULL;
+    return (PyObject*) PyUnicode_FromUnicode(
+        PyUnicode_AS_UNICODE(self) + start, end - start);
 }
 
 PyObject *PyUnicode_Split(PyObject *s,
@@ -7404,6 +8202,12 @@ PyUnicode_Partition(PyObject *str_in, PyObject *sep_in)
         Py_DECREF(str_obj);
         return NULL;
     }
+    if (PyUnicode_AS_UNICODE(str_obj) == NULL ||
+        PyUnicode_AS_UNICODE(sep_obj) == NULL) {
+        Py_DECREF(sep_obj);
+        Py_DECREF(str_obj);
+        return NULL;
+    }
 
     out = stringlib_partition(
         str_obj, PyUnicode_AS_UNICODE(str_obj), PyUnicode_GET_SIZE(str_obj),
@@ -7432,6 +8236,12 @@ PyUnicode_RPartition(PyObject *str_in, PyObject *sep_in)
         Py_DECREF(str_obj);
         return NULL;
     }
+    if (PyUnicode_AS_UNICODE(str_obj) == NULL ||
+        PyUnicode_AS_UNICODE(sep_obj) == NULL) {
+        Py_DECREF(sep_obj);
+        Py_DECREF(str_obj);
+        return NULL;
+    }
 
     out = stringlib_rpartition(
         str_obj, PyUnicode_AS_UNICODE(str_obj), PyUnicode_GET_SIZE(str_obj),
@@ -7568,7 +8378,9 @@ are deleted.");
 static PyObject*
 unicode_translate(PyUnicodeObject *self, PyObject *table)
 {
-    return PyUnicode_TranslateCharmap(self->str,
+    if (PyUnicode_AS_UNICODE(self) == NULL)
+        return NULL;
+    return PyUnicode_TranslateCharmap(PyUnicode_AS_UNICODE(self),
                                       self->length,
                                       table,
                                       "ignore");
@@ -7763,6 +8575,8 @@ unicode__format__(PyObject *self, PyObject *args)
     if (tmp == NULL)
         goto done;
     format_spec = tmp;
+    if (PyUnicode_AS_UNICODE(format_spec) == NULL)
+        goto done;
 
     result = _PyUnicode_FormatAdvanced(self,
                                        PyUnicode_AS_UNICODE(format_spec),
@@ -7780,8 +8594,13 @@ Return a formatted version of S as described by format_spec.");
 static PyObject *
 unicode__sizeof__(PyUnicodeObject *v)
 {
-    return PyInt_FromSsize_t(sizeof(PyUnicodeObject) +
-                             sizeof(Py_UNICODE) * (v->length + 1));
+    Py_ssize_t size = sizeof(PyUnicodeObject);
+
+    if (_PyUnicode_KIND(v))
+        size += _PyUnicode_KIND(v) * (v->length + 1);
+    if (!_PyUnicode_KIND(v) || v->str != NULL)
+        size += sizeof(Py_UNICODE) * (v->length + 1);
+    return PyInt_FromSsize_t(size);
 }
 
 PyDoc_STRVAR(sizeof__doc__,
@@ -7792,7 +8611,9 @@ PyDoc_STRVAR(sizeof__doc__,
 static PyObject *
 unicode_getnewargs(PyUnicodeObject *v)
 {
-    return Py_BuildValue("(u#)", v->str, v->length);
+    if (PyUnicode_AS_UNICODE(v) == NULL)
+        return NULL;
+    return Py_BuildValue("(u#)", PyUnicode_AS_UNICODE(v), v->length);
 }
 
 
@@ -7915,8 +8736,14 @@ unicode_subscript(PyUnicodeObject* self, PyObject* item)
                    PyUnicode_CheckExact(self)) {
             Py_INCREF(self);
             return (PyObject *)self;
+        } else if (step == 1 && _PyUnicode_KIND(self) == 1) {
+            return unicode_fromlatin1(
+                (char *)_PyUnicode_COMPACT_DATA(self) + start, slicelength);
+        } else if (PyUnicode_AS_UNICODE(self) == NULL) {
+            return NULL;
         } else if (step == 1) {
-            return PyUnicode_FromUnicode(self->str + start, slicelength);
+            return PyUnicode_FromUnicode(PyUnicode_AS_UNICODE(self) + start,
+                                         slicelength);
         } else {
             source_buf = PyUnicode_AS_UNICODE((PyObject*)self);
             result_buf = (Py_UNICODE *)PyObject_MALLOC(slicelength*
@@ -7955,7 +8782,9 @@ unicode_buffer_getreadbuf(PyUnicodeObject *self,
                         "accessing non-existent unicode segment");
         return -1;
     }
-    *ptr = (void *) self->str;
+    *ptr = (void *) PyUnicode_AS_UNICODE(self);
+    if (*ptr == NULL)
+        return -1;
     return PyUnicode_GET_DATA_SIZE(self);
 }
 
@@ -8179,7 +9008,7 @@ formatchar(Py_UNICODE *buf,
     if (PyUnicode_Check(v)) {
         if (PyUnicode_GET_SIZE(v) != 1)
             goto onError;
-        buf[0] = PyUnicode_AS_UNICODE(v)[0];
+        buf[0] = UNICODE_READ(UNICODE_CHARSIZE(v), UNICODE_DATA(v), 0);
     }
 
     else if (PyString_Check(v)) {
@@ -8196,7 +9025,8 @@ formatchar(Py_UNICODE *buf,
             unistr = PyUnicode_Decode(str, 1, NULL, "strict");
             if (unistr == NULL)
                 return -1;
-            buf[0] = PyUnicode_AS_UNICODE(unistr)[0];
+            buf[0] = UNICODE_READ(UNICODE_CHARSIZE(unistr),
+                                  UNICODE_DATA(unistr), 0);
             Py_DECREF(unistr);
         }
         else
@@ -8245,14 +9075,17 @@ formatchar(Py_UNICODE *buf,
 */
 #define FORMATBUFLEN (size_t)120
 
+#include "stringlib/percent_format.h"
+
 PyObject *PyUnicode_Format(PyObject *format,
                            PyObject *args)
 {
     Py_UNICODE *fmt, *res;
-    Py_ssize_t fmtcnt, rescnt, reslen, arglen, argidx;
-    int args_owned = 0;
+    Py_ssize_t rescnt, reslen;
+    StringlibFormatCode *code;
+    StringlibFormatSpec *spec;
+    StringlibFormatArgs fa;
     PyUnicodeObject *result = NULL;
-    PyObject *dict = NULL;
     PyObject *uformat;
 
     if (format == NULL || args == NULL) {
@@ -8262,45 +9095,70 @@ PyObject *PyUnicode_Format(PyObject *format,
     uformat = PyUnicode_FromObject(format);
     if (uformat == NULL)
         return NULL;
+    if (PyUnicode_AS_UNICODE(uformat) == NULL) {
+        Py_DECREF(uformat);
+        return NULL;
+    }
+    /* only keep the parsed form of a format that lives on */
+    if (uformat == format)
+        code = stringlib_format_code(uformat);
+    else
+        code = stringlib_format_compile(PyUnicode_AS_UNICODE(uformat),
+                                        PyUnicode_GET_SIZE(uformat));
+    if (code == NULL) {
+        Py_DECREF(uformat);
+        return NULL;
+    }
     fmt = PyUnicode_AS_UNICODE(uformat);
-    fmtcnt = PyUnicode_GET_SIZE(uformat);
+    fa.args = args;
+    fa.args_owned = 0;
 
-    reslen = rescnt = fmtcnt + 100;
+    /* a little more than last time, so that one more digit or so
+       doesn't need a resize */
+    reslen = rescnt = code->size_hint + (code->size_hint >> 3) + 16;
     result = _PyUnicode_New(reslen);
     if (result == NULL)
         goto onError;
     res = PyUnicode_AS_UNICODE(result);
 
     if (PyTuple_Check(args)) {
-        arglen = PyTuple_Size(args);
-        argidx = 0;
+        fa.arglen = PyTuple_Size(args);
+        fa.argidx = 0;
     }
     else {
-        arglen = -1;
-        argidx = -2;
+        fa.arglen = -1;
+        fa.argidx = -2;
     }
+    fa.dict = NULL;
     if (Py_TYPE(args)->tp_as_mapping && !PyTuple_Check(args) &&
         !PyObject_TypeCheck(args, &PyBaseString_Type))
-        dict = args;
-
-    while (--fmtcnt >= 0) {
-        if (*fmt != '%') {
-            if (--rescnt < 0) {
-                rescnt = fmtcnt + 100;
-                reslen += rescnt;
-                if (_PyUnicode_Resize(&result, reslen) < 0)
-                    goto onError;
-                res = PyUnicode_AS_UNICODE(result) + reslen - rescnt;
-                --rescnt;
+        fa.dict = args;
+
+    for (spec = code->specs;; spec++) {
+        if (rescnt < spec->litlen) {
+            reslen -= rescnt;
+            rescnt = spec->litlen + (reslen >> 1) + 100;
+            reslen += rescnt;
+            if (reslen < 0 ||
+                reslen > (PY_SSIZE_T_MAX / sizeof(Py_UNICODE)) - 1) {
+                PyErr_NoMemory();
+                goto onError;
             }
-            *res++ = *fmt++;
+            if (_PyUnicode_Resize(&result, reslen) < 0)
+                goto onError;
+            res = PyUnicode_AS_UNICODE(result) + reslen - rescnt;
         }
-        else {
+        Py_UNICODE_COPY(res, fmt + spec->lit, spec->litlen);
+        res += spec->litlen;
+        rescnt -= spec->litlen;
+        if (spec->status == FORMAT_END)
+            break;
+        {
             /* Got a format specifier */
-            int flags = 0;
-            Py_ssize_t width = -1;
-            int prec = -1;
-            Py_UNICODE c = '\0';
+            int flags;
+            Py_ssize_t width;
+            int prec;
+            Py_UNICODE c;
             Py_UNICODE fill;
             int isnumok;
             PyObject *v = NULL;
@@ -8310,152 +9168,10 @@ PyObject *PyUnicode_Format(PyObject *format,
             Py_ssize_t len;
             Py_UNICODE formatbuf[FORMATBUFLEN]; /* For format{int,char}() */
 
-            fmt++;
-            if (*fmt == '(') {
-                Py_UNICODE *keystart;
-                Py_ssize_t keylen;
-                PyObject *key;
-                int pcount = 1;
-
-                if (dict == NULL) {
-                    PyErr_SetString(PyExc_TypeError,
-                                    "format requires a mapping");
-                    goto onError;
-                }
-                ++fmt;
-                --fmtcnt;
-                keystart = fmt;
-                /* Skip over balanced parentheses */
-                while (pcount > 0 && --fmtcnt >= 0) {
-                    if (*fmt == ')')
-                        --pcount;
-                    else if (*fmt == '(')
-                        ++pcount;
-                    fmt++;
-                }
-                keylen = fmt - keystart - 1;
-                if (fmtcnt < 0 || pcount > 0) {
-                    PyErr_SetString(PyExc_ValueError,
-                                    "incomplete format key");
-                    goto onError;
-                }
-#if 0
-                /* keys are converted to strings using UTF-8 and
-                   then looked up since Python uses strings to hold
-                   variables names etc. in its namespaces and we
-                   wouldn't want to break common idioms. */
-                key = PyUnicode_EncodeUTF8(keystart,
-                                           keylen,
-                                           NULL);
-#else
-                key = PyUnicode_FromUnicode(keystart, keylen);
-#endif
-                if (key == NULL)
-                    goto onError;
-                if (args_owned) {
-                    Py_DECREF(args);
-                    args_owned = 0;
-                }
-                args = PyObject_GetItem(dict, key);
-                Py_DECREF(key);
-                if (args == NULL) {
-                    goto onError;
-                }
-                args_owned = 1;
-                arglen = -1;
-                argidx = -2;
-            }
-            while (--fmtcnt >= 0) {
-                switch (c = *fmt++) {
-                case '-': flags |= F_LJUST; continue;
-                case '+': flags |= F_SIGN; continue;
-                case ' ': flags |= F_BLANK; continue;
-                case '#': flags |= F_ALT; continue;
-                case '0': flags |= F_ZERO; continue;
-                }
-                break;
-            }
-            if (c == '*') {
-                v = getnextarg(args, arglen, &argidx);
-                if (v == NULL)
-                    goto onError;
-                if (!PyInt_Check(v)) {
-                    PyErr_SetString(PyExc_TypeError,
-                                    "* wants int");
-                    goto onError;
-                }
-                width = PyInt_AsLong(v);
-                if (width < 0) {
-                    flags |= F_LJUST;
-                    width = -width;
-                }
-                if (--fmtcnt >= 0)
-                    c = *fmt++;
-            }
-            else if (c >= '0' && c <= '9') {
-                width = c - '0';
-                while (--fmtcnt >= 0) {
-                    c = *fmt++;
-                    if (c < '0' || c > '9')
-                        break;
-                    if ((width*10) / 10 != width) {
-                        PyErr_SetString(PyExc_ValueError,
-                                        "width too big");
-                        goto onError;
-                    }
-                    width = width*10 + (c - '0');
-                }
-            }
-            if (c == '.') {
-                prec = 0;
-                if (--fmtcnt >= 0)
-                    c = *fmt++;
-                if (c == '*') {
-                    v = getnextarg(args, arglen, &argidx);
-                    if (v == NULL)
-                        goto onError;
-                    if (!PyInt_Check(v)) {
-                        PyErr_SetString(PyExc_TypeError,
-                                        "* wants int");
-                        goto onError;
-                    }
-                    prec = PyInt_AsLong(v);
-                    if (prec < 0)
-                        prec = 0;
-                    if (--fmtcnt >= 0)
-                        c = *fmt++;
-                }
-                else if (c >= '0' && c <= '9') {
-                    prec = c - '0';
-                    while (--fmtcnt >= 0) {
-                        c = *fmt++;
-                        if (c < '0' || c > '9')
-                            break;
-                        if ((prec*10) / 10 != prec) {
-                            PyErr_SetString(PyExc_ValueError,
-                                            "prec too big");
-                            goto onError;
-                        }
-                        prec = prec*10 + (c - '0');
-                    }
-                }
-            } /* prec */
-            if (fmtcnt >= 0) {
-                if (c == 'h' || c == 'l' || c == 'L') {
-                    if (--fmtcnt >= 0)
-                        c = *fmt++;
-                }
-            }
-            if (fmtcnt < 0) {
-                PyErr_SetString(PyExc_ValueError,
-                                "incomplete format");
+            if (stringlib_format_getargs(spec, &fa, &width, &prec,
+                                         &flags, &v) < 0)
                 goto onError;
-            }
-            if (c != '%') {
-                v = getnextarg(args, arglen, &argidx);
-                if (v == NULL)
-                    goto onError;
-            }
+            c = (Py_UNICODE)spec->c;
             sign = 0;
             fill = ' ';
             switch (c) {
@@ -8473,6 +9189,14 @@ PyObject *PyUnicode_Format(PyObject *format,
                     temp = v;
                     Py_INCREF(temp);
                 }
+                else if (PyInt_CheckExact(v) && c == 's') {
+                    pbuf = stringlib_format_decimal(
+                        formatbuf + FORMATBUFLEN, PyInt_AS_LONG(v));
+                    len = formatbuf + FORMATBUFLEN - pbuf;
+                    if (prec >= 0 && len > prec)
+                        len = prec;
+                    break;
+                }
                 else {
                     PyObject *unicode;
                     if (c == 's')
@@ -8502,6 +9226,10 @@ PyObject *PyUnicode_Format(PyObject *format,
                     }
                 }
                 pbuf = PyUnicode_AS_UNICODE(temp);
+                if (pbuf == NULL) {
+                    Py_DECREF(temp);
+                    goto onError;
+                }
                 len = PyUnicode_GET_SIZE(temp);
                 if (prec >= 0 && len > prec)
                     len = prec;
@@ -8515,6 +9243,18 @@ PyObject *PyUnicode_Format(PyObject *format,
             case 'X':
                 if (c == 'i')
                     c = 'd';
+                if ((c == 'd' || c == 'u') && PyInt_CheckExact(v) &&
+                    prec < 0 && !(flags & F_ALT)) {
+                    /* what formatint() makes of it, without the
+                       sprintf() */
+                    pbuf = stringlib_format_decimal(
+                        formatbuf + FORMATBUFLEN, PyInt_AS_LONG(v));
+                    len = formatbuf + FORMATBUFLEN - pbuf;
+                    sign = 1;
+                    if (flags & F_ZERO)
+                        fill = '0';
+                    break;
+                }
                 isnumok = 0;
                 if (PyNumber_Check(v)) {
                     PyObject *iobj=NULL;
@@ -8573,6 +9313,10 @@ PyObject *PyUnicode_Format(PyObject *format,
                 if (temp == NULL)
                     goto onError;
                 pbuf = PyUnicode_AS_UNICODE(temp);
+                if (pbuf == NULL) {
+                    Py_DECREF(temp);
+                    goto onError;
+                }
                 len = PyUnicode_GET_SIZE(temp);
                 sign = 1;
                 if (flags & F_ZERO)
@@ -8591,9 +9335,7 @@ PyObject *PyUnicode_Format(PyObject *format,
                              "unsupported format character '%c' (0x%x) "
                              "at index %zd",
                              (31<=c && c<=126) ? (char)c : '?',
-                             (int)c,
-                             (Py_ssize_t)(fmt - 1 -
-                                          PyUnicode_AS_UNICODE(uformat)));
+                             (int)c, spec->pos);
                 goto onError;
             }
             if (sign) {
@@ -8612,9 +9354,10 @@ PyObject *PyUnicode_Format(PyObject *format,
                 width = len;
             if (rescnt - (sign != 0) < width) {
                 reslen -= rescnt;
-                rescnt = width + fmtcnt + 100;
+                rescnt = width + (reslen >> 1) + 100;
                 reslen += rescnt;
-                if (reslen < 0) {
+                if (reslen < 0 ||
+                    reslen > (PY_SSIZE_T_MAX / sizeof(Py_UNICODE)) - 1) {
                     Py_XDECREF(temp);
                     PyErr_NoMemory();
                     goto onError;
@@ -8669,7 +9412,7 @@ PyObject *PyUnicode_Format(PyObject *format,
                 --rescnt;
                 *res++ = ' ';
             }
-            if (dict && (argidx < arglen) && c != '%') {
+            if (fa.dict && (fa.argidx < fa.arglen) && c != '%') {
                 PyErr_SetString(PyExc_TypeError,
                                 "not all arguments converted during string formatting");
                 Py_XDECREF(temp);
@@ -8678,7 +9421,7 @@ PyObject *PyUnicode_Format(PyObject *format,
             Py_XDECREF(temp);
         } /* '%' */
     } /* until end */
-    if (argidx < arglen && !dict) {
+    if (fa.argidx < fa.arglen && !fa.dict) {
         PyErr_SetString(PyExc_TypeError,
                         "not all arguments converted during string formatting");
         goto onError;
@@ -8686,18 +9429,21 @@ PyObject *PyUnicode_Format(PyObject *format,
 
     if (_PyUnicode_Resize(&result, reslen - rescnt) < 0)
         goto onError;
-    if (args_owned) {
-        Py_DECREF(args);
+    if (fa.args_owned) {
+        Py_DECREF(fa.args);
     }
+    code->size_hint = reslen - rescnt;
+    stringlib_format_release(code);
     Py_DECREF(uformat);
     return (PyObject *)result;
 
   onError:
     Py_XDECREF(result);
     Py_DECREF(uformat);
-    if (args_owned) {
-        Py_DECREF(args);
+    if (fa.args_owned) {
+        Py_DECREF(fa.args);
     }
+    stringlib_format_release(code);
     return NULL;
 }
 
@@ -8715,14 +9461,15 @@ static PyObject *
 unicode_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
     PyObject *x = NULL;
-    static char *kwlist[] = {"string", "encoding", "errors", 0};
+    static const char * const kwlist[] = {"string", "encoding", "errors", 0};
+    static _PyArg_Parser _parser = {"|Oss:unicode", kwlist, 0};
     char *encoding = NULL;
     char *errors = NULL;
 
     if (type != &PyUnicode_Type)
         return unicode_subtype_new(type, args, kwds);
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Oss:unicode",
-                                     kwlist, &x, &encoding, &errors))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &x, &encoding, &errors))
         return NULL;
     if (x == NULL)
         return (PyObject *)_PyUnicode_New(0);
@@ -8755,7 +9502,10 @@ unicode_subtype_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
         Py_DECREF(tmp);
         return PyErr_NoMemory();
     }
-    Py_UNICODE_COPY(pnew->str, tmp->str, n+1);
+    if (PyUnicode_CHECK_LAZY(tmp))
+        _PyUnicode_Flatten((PyObject *)tmp);
+    unicode_copy_wide(pnew->str, tmp);
+    pnew->str[n] = 0;
     pnew->length = n;
     pnew->hash = tmp->hash;
     Py_DECREF(tmp);
@@ -8889,6 +9639,7 @@ _PyUnicode_Fini(void)
         }
     }
     (void)PyUnicode_ClearFreeList();
+    stringlib_format_clear_cache();
 }
 
 #ifdef __cplusplus
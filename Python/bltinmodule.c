@@ -35,16 +35,17 @@ static PyObject *filtertuple (PyObject *, PyObject *);
 static PyObject *
 builtin___import__(PyObject *self, PyObject *args, PyObject *kwds)
 {
-    static char *kwlist[] = {"name", "globals", "locals", "fromlist",
-                             "level", 0};
+    static const char * const kwlist[] = {"name", "globals", "locals",
+                                          "fromlist", "level", 0};
+    static _PyArg_Parser _parser = {"s|OOOi:__import__", kwlist, 0};
     char *name;
     PyObject *globals = NULL;
     PyObject *locals = NULL;
     PyObject *fromlist = NULL;
     int level = -1;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|OOOi:__import__",
-                    kwlist, &name, &globals, &locals, &fromlist, &level))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                    &name, &globals, &locals, &fromlist, &level))
         return NULL;
     return PyImport_ImportModuleLevel(name, globals, locals,
                                       fromlist, level);
@@ -410,12 +411,14 @@ Return a Unicode string of one character with ordinal i; 0 <= i <= 0x10ffff.");
 
 
 static PyObject *
-builtin_cmp(PyObject *self, PyObject *args)
+builtin_cmp(PyObject *self, PyObject **args, Py_ssize_t nargs,
+            PyObject *kwnames)
 {
     PyObject *a, *b;
     int c;
 
-    if (!PyArg_UnpackTuple(args, "cmp", 2, 2, &a, &b))
+    if (!_PyArg_NoStackKeywords("cmp", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "cmp", 2, 2, &a, &b))
         return NULL;
     if (PyObject_Cmp(a, b, &c) < 0)
         return NULL;
@@ -467,13 +470,14 @@ builtin_compile(PyObject *self, PyObject *args, PyObject *kwds)
     PyCompilerFlags cf;
     PyObject *result = NULL, *cmd, *tmp = NULL;
     Py_ssize_t length;
-    static char *kwlist[] = {"source", "filename", "mode", "flags",
-                             "dont_inherit", NULL};
+    static const char * const kwlist[] = {"source", "filename", "mode",
+                                          "flags", "dont_inherit", NULL};
+    static _PyArg_Parser _parser = {"Oss|ii:compile", kwlist, 0};
     int start[] = {Py_file_input, Py_eval_input, Py_single_input};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Oss|ii:compile",
-                                     kwlist, &cmd, &filename, &startstr,
-                                     &supplied_flags, &dont_inherit))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+                                          &cmd, &filename, &startstr,
+                                          &supplied_flags, &dont_inherit))
         return NULL;
 
     cf.cf_flags = supplied_flags;
@@ -591,11 +595,13 @@ PyDoc_STRVAR(dir_doc,
 "    recursively the attributes of its class's base classes.");
 
 static PyObject *
-builtin_divmod(PyObject *self, PyObject *args)
+builtin_divmod(PyObject *self, PyObject **args, Py_ssize_t nargs,
+               PyObject *kwnames)
 {
     PyObject *v, *w;
 
-    if (!PyArg_UnpackTuple(args, "divmod", 2, 2, &v, &w))
+    if (!_PyArg_NoStackKeywords("divmod", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "divmod", 2, 2, &v, &w))
         return NULL;
     return PyNumber_Divmod(v, w);
 }
@@ -803,12 +809,14 @@ globals and locals.  If only globals is given, locals defaults to it.");
 
 
 static PyObject *
-builtin_getattr(PyObject *self, PyObject *args)
+builtin_getattr(PyObject *self, PyObject **args, Py_ssize_t nargs,
+                PyObject *kwnames)
 {
     PyObject *v, *result, *dflt = NULL;
     PyObject *name;
 
-    if (!PyArg_UnpackTuple(args, "getattr", 2, 3, &v, &name, &dflt))
+    if (!_PyArg_NoStackKeywords("getattr", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "getattr", 2, 3, &v, &name, &dflt))
         return NULL;
 #ifdef Py_USING_UNICODE
     if (PyUnicode_Check(name)) {
@@ -859,12 +867,14 @@ Return the dictionary containing the current scope's global variables.");
 
 
 static PyObject *
-builtin_hasattr(PyObject *self, PyObject *args)
+builtin_hasattr(PyObject *self, PyObject **args, Py_ssize_t nargs,
+                PyObject *kwnames)
 {
     PyObject *v;
     PyObject *name;
 
-    if (!PyArg_UnpackTuple(args, "hasattr", 2, 2, &v, &name))
+    if (!_PyArg_NoStackKeywords("hasattr", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "hasattr", 2, 2, &v, &name))
         return NULL;
 #ifdef Py_USING_UNICODE
     if (PyUnicode_Check(name)) {
@@ -1079,12 +1089,14 @@ the items of the sequence (or a list of tuples if more than one sequence).");
 
 
 static PyObject *
-builtin_next(PyObject *self, PyObject *args)
+builtin_next(PyObject *self, PyObject **args, Py_ssize_t nargs,
+             PyObject *kwnames)
 {
     PyObject *it, *res;
     PyObject *def = NULL;
 
-    if (!PyArg_UnpackTuple(args, "next", 1, 2, &it, &def))
+    if (!_PyArg_NoStackKeywords("next", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "next", 1, 2, &it, &def))
         return NULL;
     if (!PyIter_Check(it)) {
         PyErr_Format(PyExc_TypeError,
@@ -1120,13 +1132,15 @@ is exhausted, it is returned instead of raising StopIteration.");
 
 
 static PyObject *
-builtin_setattr(PyObject *self, PyObject *args)
+builtin_setattr(PyObject *self, PyObject **args, Py_ssize_t nargs,
+                PyObject *kwnames)
 {
     PyObject *v;
     PyObject *name;
     PyObject *value;
 
-    if (!PyArg_UnpackTuple(args, "setattr", 3, 3, &v, &name, &value))
+    if (!_PyArg_NoStackKeywords("setattr", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "setattr", 3, 3, &v, &name, &value))
         return NULL;
     if (PyObject_SetAttr(v, name, value) != 0)
         return NULL;
@@ -1142,12 +1156,14 @@ Set a named attribute on an object; setattr(x, 'y', v) is equivalent to\n\
 
 
 static PyObject *
-builtin_delattr(PyObject *self, PyObject *args)
+builtin_delattr(PyObject *self, PyObject **args, Py_ssize_t nargs,
+                PyObject *kwnames)
 {
     PyObject *v;
     PyObject *name;
 
-    if (!PyArg_UnpackTuple(args, "delattr", 2, 2, &v, &name))
+    if (!_PyArg_NoStackKeywords("delattr", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "delattr", 2, 2, &v, &name))
         return NULL;
     if (PyObject_SetAttr(v, name, (PyObject *)NULL) != 0)
         return NULL;
@@ -1273,11 +1289,13 @@ same value.");
 
 
 static PyObject *
-builtin_iter(PyObject *self, PyObject *args)
+builtin_iter(PyObject *self, PyObject **args, Py_ssize_t nargs,
+             PyObject *kwnames)
 {
     PyObject *v, *w = NULL;
 
-    if (!PyArg_UnpackTuple(args, "iter", 1, 2, &v, &w))
+    if (!_PyArg_NoStackKeywords("iter", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "iter", 1, 2, &v, &w))
         return NULL;
     if (w == NULL)
         return PyObject_GetIter(v);
@@ -1513,7 +1531,10 @@ builtin_ord(PyObject *self, PyObject* obj)
     } else if (PyUnicode_Check(obj)) {
         size = PyUnicode_GET_SIZE(obj);
         if (size == 1) {
-            ord = (long)*PyUnicode_AS_UNICODE(obj);
+            Py_UNICODE *u = PyUnicode_AS_UNICODE(obj);
+            if (u == NULL)
+                return NULL;
+            ord = (long)*u;
             return PyInt_FromLong(ord);
         }
 #endif
@@ -1538,11 +1559,13 @@ Return the integer ordinal of a one-character string.");
 
 
 static PyObject *
-builtin_pow(PyObject *self, PyObject *args)
+builtin_pow(PyObject *self, PyObject **args, Py_ssize_t nargs,
+            PyObject *kwnames)
 {
     PyObject *v, *w, *z = Py_None;
 
-    if (!PyArg_UnpackTuple(args, "pow", 2, 3, &v, &w, &z))
+    if (!_PyArg_NoStackKeywords("pow", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "pow", 2, 3, &v, &w, &z))
         return NULL;
     return PyNumber_Power(v, w, z);
 }
@@ -1557,7 +1580,8 @@ equivalent to (x**y) % z, but may be more efficient (e.g. for longs).");
 static PyObject *
 builtin_print(PyObject *self, PyObject *args, PyObject *kwds)
 {
-    static char *kwlist[] = {"sep", "end", "file", 0};
+    static const char * const kwlist[] = {"sep", "end", "file", 0};
+    static _PyArg_Parser _parser = {"|OOO:print", kwlist, 0};
     static PyObject *dummy_args = NULL;
     static PyObject *unicode_newline = NULL, *unicode_space = NULL;
     static PyObject *str_newline = NULL, *str_space = NULL;
@@ -1592,8 +1616,8 @@ builtin_print(PyObject *self, PyObject *args, PyObject *kwds)
             return NULL;
         }
     }
-    if (!PyArg_ParseTupleAndKeywords(dummy_args, kwds, "|OOO:print",
-                                     kwlist, &sep, &end, &file))
+    if (!_PyArg_ParseTupleAndKeywordsFast(dummy_args, kwds, &_parser,
+                                          &sep, &end, &file))
         return NULL;
     if (file == NULL || file == Py_None) {
         file = PySys_GetObject("stdout");
@@ -2152,10 +2176,11 @@ builtin_round(PyObject *self, PyObject *args, PyObject *kwds)
     double x;
     PyObject *o_ndigits = NULL;
     Py_ssize_t ndigits;
-    static char *kwlist[] = {"number", "ndigits", 0};
+    static const char * const kwlist[] = {"number", "ndigits", 0};
+    static _PyArg_Parser _parser = {"d|O:round", kwlist, 0};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "d|O:round",
-        kwlist, &x, &o_ndigits))
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+        &x, &o_ndigits))
         return NULL;
 
     if (o_ndigits == NULL) {
@@ -2203,12 +2228,14 @@ builtin_sorted(PyObject *self, PyObject *args, PyObject *kwds)
 {
     PyObject *newlist, *v, *seq, *compare=NULL, *keyfunc=NULL, *newargs;
     PyObject *callable;
-    static char *kwlist[] = {"iterable", "cmp", "key", "reverse", 0};
-    int reverse;
+    static const char * const kwlist[] = {"iterable", "cmp", "key",
+                                          "reverse", "parallel", 0};
+    static _PyArg_Parser _parser = {"O|OOii:sorted", kwlist, 0};
+    int reverse, parallel;
 
-    /* args 1-4 should match listsort in Objects/listobject.c */
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OOi:sorted",
-        kwlist, &seq, &compare, &keyfunc, &reverse))
+    /* args 1-5 should match listsort in Objects/listobject.c */
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser,
+        &seq, &compare, &keyfunc, &reverse, &parallel))
         return NULL;
 
     newlist = PySequence_List(seq);
@@ -2221,7 +2248,7 @@ builtin_sorted(PyObject *self, PyObject *args, PyObject *kwds)
         return NULL;
     }
 
-    newargs = PyTuple_GetSlice(args, 1, 4);
+    newargs = PyTuple_GetSlice(args, 1, 5);
     if (newargs == NULL) {
         Py_DECREF(newlist);
         Py_DECREF(callable);
@@ -2240,7 +2267,8 @@ builtin_sorted(PyObject *self, PyObject *args, PyObject *kwds)
 }
 
 PyDoc_STRVAR(sorted_doc,
-"sorted(iterable, cmp=None, key=None, reverse=False) --> new sorted list");
+"sorted(iterable, cmp=None, key=None, reverse=False, parallel=False)\n\
+--> new sorted list");
 
 static PyObject *
 builtin_vars(PyObject *self, PyObject *args)
@@ -2426,13 +2454,15 @@ empty, returns start.");
 
 
 static PyObject *
-builtin_isinstance(PyObject *self, PyObject *args)
+builtin_isinstance(PyObject *self, PyObject **args, Py_ssize_t nargs,
+                   PyObject *kwnames)
 {
     PyObject *inst;
     PyObject *cls;
     int retval;
 
-    if (!PyArg_UnpackTuple(args, "isinstance", 2, 2, &inst, &cls))
+    if (!_PyArg_NoStackKeywords("isinstance", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "isinstance", 2, 2, &inst, &cls))
         return NULL;
 
     retval = PyObject_IsInstance(inst, cls);
@@ -2451,13 +2481,15 @@ isinstance(x, A) or isinstance(x, B) or ... (etc.).");
 
 
 static PyObject *
-builtin_issubclass(PyObject *self, PyObject *args)
+builtin_issubclass(PyObject *self, PyObject **args, Py_ssize_t nargs,
+                   PyObject *kwnames)
 {
     PyObject *derived;
     PyObject *cls;
     int retval;
 
-    if (!PyArg_UnpackTuple(args, "issubclass", 2, 2, &derived, &cls))
+    if (!_PyArg_NoStackKeywords("issubclass", kwnames) ||
+        !_PyArg_UnpackStack(args, nargs, "issubclass", 2, 2, &derived, &cls))
         return NULL;
 
     retval = PyObject_IsSubclass(derived, cls);
@@ -2595,37 +2627,37 @@ static PyMethodDef builtin_methods[] = {
     {"bin",             builtin_bin,        METH_O, bin_doc},
     {"callable",        builtin_callable,   METH_O, callable_doc},
     {"chr",             builtin_chr,        METH_VARARGS, chr_doc},
-    {"cmp",             builtin_cmp,        METH_VARARGS, cmp_doc},
+    {"cmp",             (PyCFunction)builtin_cmp,        METH_FASTCALL, cmp_doc},
     {"coerce",          builtin_coerce,     METH_VARARGS, coerce_doc},
     {"compile",         (PyCFunction)builtin_compile,    METH_VARARGS | METH_KEYWORDS, compile_doc},
-    {"delattr",         builtin_delattr,    METH_VARARGS, delattr_doc},
+    {"delattr",         (PyCFunction)builtin_delattr,    METH_FASTCALL, delattr_doc},
     {"dir",             builtin_dir,        METH_VARARGS, dir_doc},
-    {"divmod",          builtin_divmod,     METH_VARARGS, divmod_doc},
+    {"divmod",          (PyCFunction)builtin_divmod,     METH_FASTCALL, divmod_doc},
     {"eval",            builtin_eval,       METH_VARARGS, eval_doc},
     {"execfile",        builtin_execfile,   METH_VARARGS, execfile_doc},
     {"filter",          builtin_filter,     METH_VARARGS, filter_doc},
     {"format",          builtin_format,     METH_VARARGS, format_doc},
-    {"getattr",         builtin_getattr,    METH_VARARGS, getattr_doc},
+    {"getattr",         (PyCFunction)builtin_getattr,    METH_FASTCALL, getattr_doc},
     {"globals",         (PyCFunction)builtin_globals,    METH_NOARGS, globals_doc},
-    {"hasattr",         builtin_hasattr,    METH_VARARGS, hasattr_doc},
+    {"hasattr",         (PyCFunction)builtin_hasattr,    METH_FASTCALL, hasattr_doc},
     {"hash",            builtin_hash,       METH_O, hash_doc},
     {"hex",             builtin_hex,        METH_O, hex_doc},
     {"id",              builtin_id,         METH_O, id_doc},
     {"input",           builtin_input,      METH_VARARGS, input_doc},
     {"intern",          builtin_intern,     METH_VARARGS, intern_doc},
-    {"isinstance",  builtin_isinstance, METH_VARARGS, isinstance_doc},
-    {"issubclass",  builtin_issubclass, METH_VARARGS, issubclass_doc},
-    {"iter",            builtin_iter,       METH_VARARGS, iter_doc},
+    {"isinstance",  (PyCFunction)builtin_isinstance, METH_FASTCALL, isinstance_doc},
+    {"issubclass",  (PyCFunction)builtin_issubclass, METH_FASTCALL, issubclass_doc},
+    {"iter",            (PyCFunction)builtin_iter,       METH_FASTCALL, iter_doc},
     {"len",             builtin_len,        METH_O, len_doc},
     {"locals",          (PyCFunction)builtin_locals,     METH_NOARGS, locals_doc},
     {"map",             builtin_map,        METH_VARARGS, map_doc},
     {"max",             (PyCFunction)builtin_max,        METH_VARARGS | METH_KEYWORDS, max_doc},
     {"min",             (PyCFunction)builtin_min,        METH_VARARGS | METH_KEYWORDS, min_doc},
-    {"next",            builtin_next,       METH_VARARGS, next_doc},
+    {"next",            (PyCFunction)builtin_next,       METH_FASTCALL, next_doc},
     {"oct",             builtin_oct,        METH_O, oct_doc},
     {"open",            (PyCFunction)builtin_open,       METH_VARARGS | METH_KEYWORDS, open_doc},
     {"ord",             builtin_ord,        METH_O, ord_doc},
-    {"pow",             builtin_pow,        METH_VARARGS, pow_doc},
+    {"pow",             (PyCFunction)builtin_pow,        METH_FASTCALL, pow_doc},
     {"print",           (PyCFunction)builtin_print,      METH_VARARGS | METH_KEYWORDS, print_doc},
     {"range",           builtin_range,      METH_VARARGS, range_doc},
     {"raw_input",       builtin_raw_input,  METH_VARARGS, raw_input_doc},
@@ -2633,7 +2665,7 @@ static PyMethodDef builtin_methods[] = {
     {"reload",          builtin_reload,     METH_O, reload_doc},
     {"repr",            builtin_repr,       METH_O, repr_doc},
     {"round",           (PyCFunction)builtin_round,      METH_VARARGS | METH_KEYWORDS, round_doc},
-    {"setattr",         builtin_setattr,    METH_VARARGS, setattr_doc},
+    {"setattr",         (PyCFunction)builtin_setattr,    METH_FASTCALL, setattr_doc},
     {"sorted",          (PyCFunction)builtin_sorted,     METH_VARARGS | METH_KEYWORDS, sorted_doc},
     {"sum",             builtin_sum,        METH_VARARGS, sum_doc},
 #ifdef Py_USING_UNICODE
@@ -2980,6 +3012,10 @@ filterunicode(PyObject *func, PyObject *strobj)
                 Py_DECREF(item);
                 goto Fail_1;
             }
+            if (PyUnicode_AS_UNICODE(item) == NULL) {
+                Py_DECREF(item);
+                goto Fail_1;
+            }
             reslen = PyUnicode_GET_SIZE(item);
             if (reslen == 1)
                 PyUnicode_AS_UNICODE(result)[j++] =
@@ -104,6 +104,37 @@ void dump_tsc(int opcode, int ticked, uint64 inst0, uint64 inst1,
 
 typedef PyObject *(*callproc)(PyObject *, PyObject *, PyObject *);
 
+/* Inline caches for LOAD_GLOBAL and LOAD_ATTR.  A code object that has
+   been called or gone around a loop OPCACHE_MIN_RUNS times gets one
+   _PyOpcache entry per such instruction (see _PyCode_InitOpcache()).
+   Entries hold borrowed references and are only trusted while the
+   version tags they recorded still match: ma_version_tag of the globals
+   and builtins dicts for LOAD_GLOBAL, tp_version_tag of the owner's type
+   for LOAD_ATTR.  A LOAD_ATTR entry that misses OPCACHE_MAX_MISSES times
+   (say, because the instruction sees many different types) is disabled
+   for good. */
+#define OPCACHE_MIN_RUNS 1024
+#define OPCACHE_MAX_MISSES 20
+
+/* Quickening.  When a code object gets hot (at the same time as its
+   inline caches), it also gets a private copy of co_code, co_quickened,
+   which PyEval_EvalFrameEx then runs instead.  In that copy, a generic
+   instruction that sees operands of a type it has a specialized form for
+   rewrites itself in place into that form:
+
+       BINARY_ADD      int + int, float + float
+       BINARY_SUBSCR   list[int]
+       COMPARE_OP      int < == ... int
+       CALL_FUNCTION   plain Python function, straight to fast_function()
+
+   A specialized instruction checks its guard and, when it fails, turns
+   itself back into the generic form (deoptimizes) and runs that.  An
+   instruction that has been deoptimized QUICKEN_MAX_DEOPTS times stays
+   generic.  Rewrites keep the length of each instruction, so f_lasti
+   and line numbers are the same as for co_code, and co_code itself,
+   which is what marshal and dis look at, never changes. */
+#define QUICKEN_MAX_DEOPTS 8
+
 /* Forward declarations */
 #ifdef WITH_TSC
 static PyObject * call_function(PyObject ***, int, uint64*, uint64*);
@@ -117,6 +148,7 @@ static PyObject * update_keyword_args(PyObject *, int, PyObject ***,
                                       PyObject *);
 static PyObject * update_star_args(int, int, PyObject *, PyObject ***);
 static PyObject * load_args(PyObject ***, int);
+static int load_method(PyObject *, PyObject *, PyObject **);
 #define CALL_FLAG_VAR 1
 #define CALL_FLAG_KW 2
 
@@ -136,6 +168,7 @@ static PyObject * apply_slice(PyObject *, PyObject *, PyObject *);
 static int assign_slice(PyObject *, PyObject *,
                         PyObject *, PyObject *);
 static PyObject * cmp_outcome(int, PyObject *, PyObject *);
+static PyObject * load_attr_cached(PyObject *, PyObject *, _PyOpcache *);
 static PyObject * import_from(PyObject *, PyObject *);
 static int import_all_from(PyObject *, PyObject *);
 static PyObject * build_class(PyObject *, PyObject *, PyObject *);
@@ -144,8 +177,14 @@ static int exec_statement(PyFrameObject *,
 static void set_exc_info(PyThreadState *, PyObject *, PyObject *, PyObject *);
 static void reset_exc_info(PyThreadState *);
 static void format_exc_check_arg(PyObject *, char *, PyObject *);
+static void release_concat_target(PyObject *, PyFrameObject *,
+                                  unsigned char *);
 static PyObject * string_concatenate(PyObject *, PyObject *,
                                      PyFrameObject *, unsigned char *);
+#ifdef Py_USING_UNICODE
+static PyObject * unicode_concatenate(PyObject *, PyObject *,
+                                      PyFrameObject *, unsigned char *);
+#endif
 static PyObject * kwd_as_string(PyObject *);
 static PyObject * special_lookup(PyObject *, char *, PyObject **);
 
@@ -233,36 +272,42 @@ PyEval_GetCallStats(PyObject *self)
 #endif
 #include "pythread.h"
 
-static PyThread_type_lock interpreter_lock = 0; /* This is the GIL */
+#include "ceval_gil.h"
+
 static PyThread_type_lock pending_lock = 0; /* for pending calls */
 static long main_thread = 0;
 
 int
 PyEval_ThreadsInitialized(void)
 {
-    return interpreter_lock != 0;
+    return gil_created();
 }
 
 void
 PyEval_InitThreads(void)
 {
-    if (interpreter_lock)
+    if (gil_created())
         return;
-    interpreter_lock = PyThread_allocate_lock();
-    PyThread_acquire_lock(interpreter_lock, 1);
+    create_gil();
+    take_gil(_PyThreadState_Current);
     main_thread = PyThread_get_thread_ident();
 }
 
 void
 PyEval_AcquireLock(void)
 {
-    PyThread_acquire_lock(interpreter_lock, 1);
+    /* The current thread state may be NULL here, as in the old
+       PyEval_AcquireLock(); PyThreadState_Swap(tstate) idiom */
+    take_gil(_PyThreadState_Current);
 }
 
 void
 PyEval_ReleaseLock(void)
 {
-    PyThread_release_lock(interpreter_lock);
+    /* This function must succeed when the current thread state is NULL.
+       We therefore avoid PyThreadState_GET() which dumps a fatal error
+       in debug mode. */
+    drop_gil(_PyThreadState_Current);
 }
 
 void
@@ -271,8 +316,8 @@ PyEval_AcquireThread(PyThreadState *tstate)
     if (tstate == NULL)
         Py_FatalError("PyEval_AcquireThread: NULL new thread state");
     /* Check someone has called PyEval_InitThreads() to create the lock */
-    assert(interpreter_lock);
-    PyThread_acquire_lock(interpreter_lock, 1);
+    assert(gil_created());
+    take_gil(tstate);
     if (PyThreadState_Swap(tstate) != NULL)
         Py_FatalError(
             "PyEval_AcquireThread: non-NULL old thread state");
@@ -285,7 +330,7 @@ PyEval_ReleaseThread(PyThreadState *tstate)
         Py_FatalError("PyEval_ReleaseThread: NULL thread state");
     if (PyThreadState_Swap(NULL) != tstate)
         Py_FatalError("PyEval_ReleaseThread: wrong thread state");
-    PyThread_release_lock(interpreter_lock);
+    drop_gil(tstate);
 }
 
 /* This function is called from PyOS_AfterFork to ensure that newly
@@ -299,20 +344,20 @@ PyEval_ReInitThreads(void)
     PyObject *threading, *result;
     PyThreadState *tstate;
 
-    if (!interpreter_lock)
+    if (!gil_created())
         return;
     /*XXX Can't use PyThread_free_lock here because it does too
       much error-checking.  Doing this cleanly would require
       adding a new function to each thread_*.h.  Instead, just
       create a new lock and waste a little bit of memory */
-    interpreter_lock = PyThread_allocate_lock();
+    recreate_gil();
     pending_lock = PyThread_allocate_lock();
-    PyThread_acquire_lock(interpreter_lock, 1);
+    tstate = PyThreadState_GET();
+    take_gil(tstate);
     main_thread = PyThread_get_thread_ident();
 
     /* Update the threading module with the new state.
      */
-    tstate = PyThreadState_GET();
     threading = PyMapping_GetItemString(tstate->interp->modules,
                                         "threading");
     if (threading == NULL) {
@@ -340,8 +385,8 @@ PyEval_SaveThread(void)
     if (tstate == NULL)
         Py_FatalError("PyEval_SaveThread: NULL tstate");
 #ifdef WITH_THREAD
-    if (interpreter_lock)
-        PyThread_release_lock(interpreter_lock);
+    if (gil_created())
+        drop_gil(tstate);
 #endif
     return tstate;
 }
@@ -352,9 +397,9 @@ PyEval_RestoreThread(PyThreadState *tstate)
     if (tstate == NULL)
         Py_FatalError("PyEval_RestoreThread: NULL tstate");
 #ifdef WITH_THREAD
-    if (interpreter_lock) {
+    if (gil_created()) {
         int err = errno;
-        PyThread_acquire_lock(interpreter_lock, 1);
+        take_gil(tstate);
         errno = err;
     }
 #endif
@@ -717,6 +762,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 
     PyThreadState *tstate = PyThreadState_GET();
     PyCodeObject *co;
+    _PyOpcache *co_opcache;             /* cache entry of the current instruction */
 
     /* when tracing we set things up so that
 
@@ -804,6 +850,66 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 #define JUMPTO(x)       (next_instr = first_instr + (x))
 #define JUMPBY(x)       (next_instr += (x))
 
+/* Count a run of the code object (a call, or a trip around a loop) and
+   allocate its inline caches once it has become hot. */
+#define OPCACHE_WARMUP() \
+    do { \
+        if (co->co_opcache_flag < OPCACHE_MIN_RUNS && \
+            ++co->co_opcache_flag == OPCACHE_MIN_RUNS) { \
+            _PyCode_InitOpcache(co); \
+            _PyCode_Quicken(co); \
+        } \
+    } while (0)
+
+/* Switch a running frame over to the quickened code, if there is some */
+#define USE_QUICKENED() \
+    do { \
+        if (co->co_quickened != NULL && first_instr != co->co_quickened) { \
+            next_instr = co->co_quickened + INSTR_OFFSET(); \
+            first_instr = co->co_quickened; \
+        } \
+    } while (0)
+
+/* Size of the instruction op, with its argument */
+#define INSTR_SIZE(op)  (HAS_ARG(op) ? 3 : 1)
+
+/* Rewrite the instruction being executed (already fetched) into its
+   specialized form op, unless it has been deoptimized too often. */
+#define QUICKEN(op) \
+    do { \
+        if (first_instr == co->co_quickened && \
+            co->co_quickened_deopts[INSTR_OFFSET() - INSTR_SIZE(op)] < \
+                QUICKEN_MAX_DEOPTS) \
+            next_instr[-INSTR_SIZE(op)] = (op); \
+    } while (0)
+
+/* Turn a specialized instruction whose guard failed back into its
+   generic form op, and run that.  Nothing may have been popped yet.
+   A code object built by hand may hold specialized instructions in its
+   own co_code, which is never rewritten: they just run the generic op. */
+#define DEOPTIMIZE(op) \
+    do { \
+        if (first_instr == co->co_quickened) { \
+            next_instr[-INSTR_SIZE(op)] = (op); \
+            co->co_quickened_deopts[INSTR_OFFSET() - INSTR_SIZE(op)]++; \
+        } \
+        opcode = (op); \
+        goto dispatch_opcode; \
+    } while (0)
+
+/* Look up the cache entry of the instruction being executed.  Only valid
+   right after the opcode and its argument have been fetched. */
+#define OPCACHE_CHECK() \
+    do { \
+        co_opcache = NULL; \
+        if (co->co_opcache != NULL) { \
+            unsigned char co_opt_offset = \
+                co->co_opcache_map[INSTR_OFFSET() - 3]; \
+            if (co_opt_offset > 0) \
+                co_opcache = &co->co_opcache[co_opt_offset - 1]; \
+        } \
+    } while (0)
+
 /* OpCode prediction macros
    操作码预测宏（运行时优化技术）
 
@@ -840,6 +946,96 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 #define PREDICTED(op)           PRED_##op: next_instr++
 #define PREDICTED_WITH_ARG(op)  PRED_##op: oparg = PEEKARG(); next_instr += 3
 
+/* Opcode dispatch macros（操作码派发宏）
+
+   Computed GOTOs, or
+       the-optimization-commonly-but-improperly-known-as-"threaded code"
+   using gcc's labels-as-values extension
+   (http://gcc.gnu.org/onlinedocs/gcc/Labels-as-Values.html).
+
+   The traditional bytecode evaluation loop uses a "switch" statement, which
+   decent compilers will optimize as a single indirect branch instruction
+   combined with a lookup table of jump addresses.  However, since the
+   indirect jump instruction is shared by all opcodes, the CPU will have a
+   hard time making the right prediction for where to jump next (actually,
+   it will be always wrong except in the uncommon case of a sequence of
+   several identical opcodes).
+
+   "Threaded code" in contrast, uses an explicit jump table and an explicit
+   indirect jump instruction at the end of each opcode.  Since the jump
+   instruction is at a different address for each opcode, the CPU will make
+   a separate prediction for each of these instructions, which is
+   equivalent to predicting the second opcode of each opcode pair.  These
+   predictions have a much better chance to turn out valid, especially in
+   small bytecode loops.
+   每个操作码的末尾都有自己的间接跳转指令，CPU 可以为每个操作码分别做分支预测。
+
+   Unlike the switch, the dispatch at the tail of each handler reads the
+   next opcode and its argument itself, so that the TARGET() labels are
+   entered with opcode/oparg already set.  This is what keeps PREDICT()
+   and PREDICTED() working unchanged: a predicted pair still jumps straight
+   to the PRED_ label, which consumes the instruction and falls through
+   into the handler.
+
+   The jump table (Python/opcode_targets.h) is generated from Lib/opcode.py
+   by Python/makeopcodetargets.py.  The switch is kept in both builds: it is
+   still the entry point after the periodic checks, line tracing and
+   EXTENDED_ARG.
+
+   Threaded dispatch is opt-in: configure --with-computed-gotos.
+*/
+
+#if defined(DYNAMIC_EXECUTION_PROFILE)
+/* The opcode (pair) counters live at the top of the switch. */
+#undef USE_COMPUTED_GOTOS
+#endif
+
+#ifdef USE_COMPUTED_GOTOS
+/* Import the static jump table */
+#include "opcode_targets.h"
+
+#define TARGET(op)              TARGET_##op: case op:
+/* For the SLICE+n family, whose names are not C identifiers */
+#define TARGET_PLUS(op, n)      TARGET_##op##_##n: case op+n:
+
+#ifdef LLTRACE
+#define DISPATCH_ALLOWED()      (!lltrace && !_Py_TracingPossible)
+#else
+#define DISPATCH_ALLOWED()      (!_Py_TracingPossible)
+#endif
+
+/* Jump to the next opcode without going back to the top of the loop */
+#define FAST_DISPATCH() \
+    { \
+        if (DISPATCH_ALLOWED()) { \
+            f->f_lasti = INSTR_OFFSET(); \
+            opcode = NEXTOP(); \
+            oparg = 0; \
+            if (HAS_ARG(opcode)) \
+                oparg = NEXTARG(); \
+            goto *opcode_targets[opcode]; \
+        } \
+        goto fast_next_opcode; \
+    }
+
+/* Like FAST_DISPATCH(), but counts down _Py_Ticker as the top of the loop
+   does, and goes there when the periodic things are due. */
+#define DISPATCH() \
+    { \
+        if (_Py_Ticker > 0) { \
+            _Py_Ticker--; \
+            FAST_DISPATCH(); \
+        } \
+        continue; \
+    }
+
+#else
+#define TARGET(op)              case op:
+#define TARGET_PLUS(op, n)      case op+n:
+#define DISPATCH()              continue
+#define FAST_DISPATCH()         goto fast_next_opcode
+#endif
+
 /* Stack manipulation macros（栈操作宏） */
 
 /* The stack can grow at most MAXINT deep, as co_nlocals and
@@ -944,11 +1140,15 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 
     // 初始化当前场景的字节（机器）码指令集、命名表、常量对象表、局部变量表、以及指令入口地址
     co = f->f_code;
+    OPCACHE_WARMUP();
     names = co->co_names;
     consts = co->co_consts;
     fastlocals = f->f_localsplus;
     freevars = f->f_localsplus + co->co_nlocals;
-    first_instr = (unsigned char*) PyString_AS_STRING(co->co_code);
+    if (co->co_quickened != NULL)
+        first_instr = co->co_quickened;
+    else
+        first_instr = (unsigned char*) PyString_AS_STRING(co->co_code);
 
     /* An explanation is in order for the next line.
 
@@ -1069,29 +1269,29 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             }
 
 #ifdef WITH_THREAD
-            if (interpreter_lock) {
+            if (gil_drop_request) {
                 /* Give another thread a chance */
 
                 if (PyThreadState_Swap(NULL) != tstate)
                     Py_FatalError("ceval: tstate mix-up");
-                PyThread_release_lock(interpreter_lock);
+                drop_gil(tstate);
 
                 /* Other threads may run now */
 
-                PyThread_acquire_lock(interpreter_lock, 1);
+                take_gil(tstate);
                 if (PyThreadState_Swap(tstate) != NULL)
                     Py_FatalError("ceval: orphan tstate");
+            }
 
-                /* Check for thread interrupts */
+            /* Check for thread interrupts */
 
-                if (tstate->async_exc != NULL) {
-                    x = tstate->async_exc;
-                    tstate->async_exc = NULL;
-                    PyErr_SetNone(x);
-                    Py_DECREF(x);
-                    why = WHY_EXCEPTION;
-                    goto on_error;
-                }
+            if (tstate->async_exc != NULL) {
+                x = tstate->async_exc;
+                tstate->async_exc = NULL;
+                PyErr_SetNone(x);
+                Py_DECREF(x);
+                why = WHY_EXCEPTION;
+                goto on_error;
             }
 #endif
         } // if (--_Py_Ticker < 0)
@@ -1178,55 +1378,55 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 
         /* case STOP_CODE: this is an error! */
 
-        case NOP:
-            goto fast_next_opcode;
+        TARGET(NOP)
+            FAST_DISPATCH();
 
-        case LOAD_FAST:
+        TARGET(LOAD_FAST)
             x = GETLOCAL(oparg);
             if (x != NULL) {
                 Py_INCREF(x);
                 PUSH(x);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             format_exc_check_arg(PyExc_UnboundLocalError,
                 UNBOUNDLOCAL_ERROR_MSG,
                 PyTuple_GetItem(co->co_varnames, oparg));
             break;
 
-        case LOAD_CONST:
+        TARGET(LOAD_CONST)
             x = GETITEM(consts, oparg);
             Py_INCREF(x);
             PUSH(x);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
         PREDICTED_WITH_ARG(STORE_FAST);
-        case STORE_FAST:
+        TARGET(STORE_FAST)
             v = POP();
             SETLOCAL(oparg, v);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
-        case POP_TOP:
+        TARGET(POP_TOP)
             v = POP();
             Py_DECREF(v);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
-        case ROT_TWO:
+        TARGET(ROT_TWO)
             v = TOP();
             w = SECOND();
             SET_TOP(w);
             SET_SECOND(v);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
-        case ROT_THREE:
+        TARGET(ROT_THREE)
             v = TOP();
             w = SECOND();
             x = THIRD();
             SET_TOP(w);
             SET_SECOND(x);
             SET_THIRD(v);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
-        case ROT_FOUR:
+        TARGET(ROT_FOUR)
             u = TOP();
             v = SECOND();
             w = THIRD();
@@ -1235,15 +1435,15 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             SET_SECOND(w);
             SET_THIRD(x);
             SET_FOURTH(u);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
-        case DUP_TOP:
+        TARGET(DUP_TOP)
             v = TOP();
             Py_INCREF(v);
             PUSH(v);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
-        case DUP_TOPX:
+        TARGET(DUP_TOPX)
             if (oparg == 2) {
                 x = TOP();
                 Py_INCREF(x);
@@ -1252,7 +1452,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 STACKADJ(2);
                 SET_TOP(x);
                 SET_SECOND(w);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             } else if (oparg == 3) {
                 x = TOP();
                 Py_INCREF(x);
@@ -1264,84 +1464,84 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 SET_TOP(x);
                 SET_SECOND(w);
                 SET_THIRD(v);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             Py_FatalError("invalid argument to DUP_TOPX"
                           " (bytecode corruption?)");
             /* Never returns, so don't bother to set why. */
             break;
 
-        case UNARY_POSITIVE:
+        TARGET(UNARY_POSITIVE)
             v = TOP();
             x = PyNumber_Positive(v);
             Py_DECREF(v);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case UNARY_NEGATIVE:
+        TARGET(UNARY_NEGATIVE)
             v = TOP();
             x = PyNumber_Negative(v);
             Py_DECREF(v);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case UNARY_NOT:
+        TARGET(UNARY_NOT)
             v = TOP();
             err = PyObject_IsTrue(v);
             Py_DECREF(v);
             if (err == 0) {
                 Py_INCREF(Py_True);
                 SET_TOP(Py_True);
-                continue;
+                DISPATCH();
             }
             else if (err > 0) {
                 Py_INCREF(Py_False);
                 SET_TOP(Py_False);
                 err = 0;
-                continue;
+                DISPATCH();
             }
             STACKADJ(-1);
             break;
 
-        case UNARY_CONVERT:
+        TARGET(UNARY_CONVERT)
             v = TOP();
             x = PyObject_Repr(v);
             Py_DECREF(v);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case UNARY_INVERT:
+        TARGET(UNARY_INVERT)
             v = TOP();
             x = PyNumber_Invert(v);
             Py_DECREF(v);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_POWER:
+        TARGET(BINARY_POWER)
             w = POP();
             v = TOP();
             x = PyNumber_Power(v, w, Py_None);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_MULTIPLY:
+        TARGET(BINARY_MULTIPLY)
             w = POP();
             v = TOP();
             x = PyNumber_Multiply(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_DIVIDE:
+        TARGET(BINARY_DIVIDE)
             if (!_Py_QnewFlag) {
                 w = POP();
                 v = TOP();
@@ -1349,32 +1549,32 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 Py_DECREF(v);
                 Py_DECREF(w);
                 SET_TOP(x);
-                if (x != NULL) continue;
+                if (x != NULL) DISPATCH();
                 break;
             }
             /* -Qnew is in effect:  fall through to
                BINARY_TRUE_DIVIDE */
-        case BINARY_TRUE_DIVIDE:
+        TARGET(BINARY_TRUE_DIVIDE)
             w = POP();
             v = TOP();
             x = PyNumber_TrueDivide(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_FLOOR_DIVIDE:
+        TARGET(BINARY_FLOOR_DIVIDE)
             w = POP();
             v = TOP();
             x = PyNumber_FloorDivide(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_MODULO:
+        TARGET(BINARY_MODULO)
             w = POP();
             v = TOP();
             if (PyString_CheckExact(v))
@@ -1384,10 +1584,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_ADD:
+        TARGET(BINARY_ADD)
             w = POP();
             v = TOP();
             if (PyInt_CheckExact(v) && PyInt_CheckExact(w)) {
@@ -1400,6 +1600,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 i = (long)((unsigned long)a + b);
                 if ((i^a) < 0 && (i^b) < 0)
                     goto slow_add;
+                QUICKEN(BINARY_ADD_INT);
                 x = PyInt_FromLong(i);
             }
             else if (PyString_CheckExact(v) &&
@@ -1408,7 +1609,17 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 /* string_concatenate consumed the ref to v */
                 goto skip_decref_vx;
             }
+#ifdef Py_USING_UNICODE
+            else if (PyUnicode_CheckExact(v) &&
+                     PyUnicode_CheckExact(w)) {
+                x = unicode_concatenate(v, w, f, next_instr);
+                /* unicode_concatenate consumed the ref to v */
+                goto skip_decref_vx;
+            }
+#endif
             else {
+                if (PyFloat_CheckExact(v) && PyFloat_CheckExact(w))
+                    QUICKEN(BINARY_ADD_FLOAT);
               slow_add:
                 x = PyNumber_Add(v, w);
             }
@@ -1416,10 +1627,45 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
           skip_decref_vx:
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_SUBTRACT:
+        TARGET(BINARY_ADD_INT)
+            w = TOP();
+            v = SECOND();
+            if (PyInt_CheckExact(v) && PyInt_CheckExact(w)) {
+                register long a, b, i;
+                a = PyInt_AS_LONG(v);
+                b = PyInt_AS_LONG(w);
+                i = (long)((unsigned long)a + b);
+                if ((i^a) >= 0 || (i^b) >= 0) {
+                    x = PyInt_FromLong(i);
+                    STACKADJ(-1);
+                    Py_DECREF(v);
+                    Py_DECREF(w);
+                    SET_TOP(x);
+                    if (x != NULL) DISPATCH();
+                    break;
+                }
+            }
+            DEOPTIMIZE(BINARY_ADD);
+
+        TARGET(BINARY_ADD_FLOAT)
+            w = TOP();
+            v = SECOND();
+            if (PyFloat_CheckExact(v) && PyFloat_CheckExact(w)) {
+                x = PyFloat_FromDouble(PyFloat_AS_DOUBLE(v) +
+                                       PyFloat_AS_DOUBLE(w));
+                STACKADJ(-1);
+                Py_DECREF(v);
+                Py_DECREF(w);
+                SET_TOP(x);
+                if (x != NULL) DISPATCH();
+                break;
+            }
+            DEOPTIMIZE(BINARY_ADD);
+
+        TARGET(BINARY_SUBTRACT)
             w = POP();
             v = TOP();
             if (PyInt_CheckExact(v) && PyInt_CheckExact(w)) {
@@ -1441,10 +1687,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_SUBSCR:
+        TARGET(BINARY_SUBSCR)
             w = POP();
             v = TOP();
             if (PyList_CheckExact(v) && PyInt_CheckExact(w)) {
@@ -1453,6 +1699,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 if (i < 0)
                     i += PyList_GET_SIZE(v);
                 if (i >= 0 && i < PyList_GET_SIZE(v)) {
+                    QUICKEN(BINARY_SUBSCR_LIST_INT);
                     x = PyList_GET_ITEM(v, i);
                     Py_INCREF(x);
                 }
@@ -1465,102 +1712,121 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_LSHIFT:
+        TARGET(BINARY_SUBSCR_LIST_INT)
+            w = TOP();
+            v = SECOND();
+            if (PyList_CheckExact(v) && PyInt_CheckExact(w)) {
+                Py_ssize_t i = PyInt_AS_LONG(w);
+                if (i < 0)
+                    i += PyList_GET_SIZE(v);
+                if (i >= 0 && i < PyList_GET_SIZE(v)) {
+                    x = PyList_GET_ITEM(v, i);
+                    Py_INCREF(x);
+                    STACKADJ(-1);
+                    Py_DECREF(v);
+                    Py_DECREF(w);
+                    SET_TOP(x);
+                    DISPATCH();
+                }
+            }
+            DEOPTIMIZE(BINARY_SUBSCR);
+
+        TARGET(BINARY_LSHIFT)
             w = POP();
             v = TOP();
             x = PyNumber_Lshift(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_RSHIFT:
+        TARGET(BINARY_RSHIFT)
             w = POP();
             v = TOP();
             x = PyNumber_Rshift(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_AND:
+        TARGET(BINARY_AND)
             w = POP();
             v = TOP();
             x = PyNumber_And(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_XOR:
+        TARGET(BINARY_XOR)
             w = POP();
             v = TOP();
             x = PyNumber_Xor(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case BINARY_OR:
+        TARGET(BINARY_OR)
             w = POP();
             v = TOP();
             x = PyNumber_Or(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case LIST_APPEND:
+        TARGET(LIST_APPEND)
             w = POP();
             v = PEEK(oparg);
             err = PyList_Append(v, w);
             Py_DECREF(w);
             if (err == 0) {
                 PREDICT(JUMP_ABSOLUTE);
-                continue;
+                DISPATCH();
             }
             break;
 
-        case SET_ADD:
+        TARGET(SET_ADD)
             w = POP();
             v = stack_pointer[-oparg];
             err = PySet_Add(v, w);
             Py_DECREF(w);
             if (err == 0) {
                 PREDICT(JUMP_ABSOLUTE);
-                continue;
+                DISPATCH();
             }
             break;
 
-        case INPLACE_POWER:
+        TARGET(INPLACE_POWER)
             w = POP();
             v = TOP();
             x = PyNumber_InPlacePower(v, w, Py_None);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_MULTIPLY:
+        TARGET(INPLACE_MULTIPLY)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceMultiply(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_DIVIDE:
+        TARGET(INPLACE_DIVIDE)
             if (!_Py_QnewFlag) {
                 w = POP();
                 v = TOP();
@@ -1568,42 +1834,42 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 Py_DECREF(v);
                 Py_DECREF(w);
                 SET_TOP(x);
-                if (x != NULL) continue;
+                if (x != NULL) DISPATCH();
                 break;
             }
             /* -Qnew is in effect:  fall through to
                INPLACE_TRUE_DIVIDE */
-        case INPLACE_TRUE_DIVIDE:
+        TARGET(INPLACE_TRUE_DIVIDE)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceTrueDivide(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_FLOOR_DIVIDE:
+        TARGET(INPLACE_FLOOR_DIVIDE)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceFloorDivide(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_MODULO:
+        TARGET(INPLACE_MODULO)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceRemainder(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_ADD:
+        TARGET(INPLACE_ADD)
             w = POP();
             v = TOP();
             if (PyInt_CheckExact(v) && PyInt_CheckExact(w)) {
@@ -1622,6 +1888,14 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 /* string_concatenate consumed the ref to v */
                 goto skip_decref_v;
             }
+#ifdef Py_USING_UNICODE
+            else if (PyUnicode_CheckExact(v) &&
+                     PyUnicode_CheckExact(w)) {
+                x = unicode_concatenate(v, w, f, next_instr);
+                /* unicode_concatenate consumed the ref to v */
+                goto skip_decref_v;
+            }
+#endif
             else {
               slow_iadd:
                 x = PyNumber_InPlaceAdd(v, w);
@@ -1630,10 +1904,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
           skip_decref_v:
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_SUBTRACT:
+        TARGET(INPLACE_SUBTRACT)
             w = POP();
             v = TOP();
             if (PyInt_CheckExact(v) && PyInt_CheckExact(w)) {
@@ -1653,63 +1927,63 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_LSHIFT:
+        TARGET(INPLACE_LSHIFT)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceLshift(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_RSHIFT:
+        TARGET(INPLACE_RSHIFT)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceRshift(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_AND:
+        TARGET(INPLACE_AND)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceAnd(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_XOR:
+        TARGET(INPLACE_XOR)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceXor(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case INPLACE_OR:
+        TARGET(INPLACE_OR)
             w = POP();
             v = TOP();
             x = PyNumber_InPlaceOr(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case SLICE+0:
-        case SLICE+1:
-        case SLICE+2:
-        case SLICE+3:
+        TARGET_PLUS(SLICE, 0)
+        TARGET_PLUS(SLICE, 1)
+        TARGET_PLUS(SLICE, 2)
+        TARGET_PLUS(SLICE, 3)
             if ((opcode-SLICE) & 2)
                 w = POP();
             else
@@ -1724,13 +1998,13 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_XDECREF(v);
             Py_XDECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case STORE_SLICE+0:
-        case STORE_SLICE+1:
-        case STORE_SLICE+2:
-        case STORE_SLICE+3:
+        TARGET_PLUS(STORE_SLICE, 0)
+        TARGET_PLUS(STORE_SLICE, 1)
+        TARGET_PLUS(STORE_SLICE, 2)
+        TARGET_PLUS(STORE_SLICE, 3)
             if ((opcode-STORE_SLICE) & 2)
                 w = POP();
             else
@@ -1746,13 +2020,13 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(u);
             Py_XDECREF(v);
             Py_XDECREF(w);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case DELETE_SLICE+0:
-        case DELETE_SLICE+1:
-        case DELETE_SLICE+2:
-        case DELETE_SLICE+3:
+        TARGET_PLUS(DELETE_SLICE, 0)
+        TARGET_PLUS(DELETE_SLICE, 1)
+        TARGET_PLUS(DELETE_SLICE, 2)
+        TARGET_PLUS(DELETE_SLICE, 3)
             if ((opcode-DELETE_SLICE) & 2)
                 w = POP();
             else
@@ -1767,10 +2041,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(u);
             Py_XDECREF(v);
             Py_XDECREF(w);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case STORE_SUBSCR:
+        TARGET(STORE_SUBSCR)
             w = TOP();
             v = SECOND();
             u = THIRD();
@@ -1780,10 +2054,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(u);
             Py_DECREF(v);
             Py_DECREF(w);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case DELETE_SUBSCR:
+        TARGET(DELETE_SUBSCR)
             w = TOP();
             v = SECOND();
             STACKADJ(-2);
@@ -1791,10 +2065,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             err = PyObject_DelItem(v, w);
             Py_DECREF(v);
             Py_DECREF(w);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case PRINT_EXPR:
+        TARGET(PRINT_EXPR)
             v = POP();
             w = PySys_GetObject("displayhook");
             if (w == NULL) {
@@ -1818,11 +2092,11 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_XDECREF(x);
             break;
 
-        case PRINT_ITEM_TO:
+        TARGET(PRINT_ITEM_TO)
             w = stream = POP();
             /* fall through to PRINT_ITEM */
 
-        case PRINT_ITEM:
+        TARGET(PRINT_ITEM)
             v = POP();
             if (stream == NULL || stream == Py_None) {
                 w = PySys_GetObject("stdout");
@@ -1855,7 +2129,9 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 else if (PyUnicode_Check(v)) {
                     Py_UNICODE *s = PyUnicode_AS_UNICODE(v);
                     Py_ssize_t len = PyUnicode_GET_SIZE(v);
-                    if (len == 0 ||
+                    if (s == NULL)
+                        err = -1;
+                    else if (len == 0 ||
                         !Py_UNICODE_ISSPACE(s[len-1]) ||
                         s[len-1] == ' ')
                         PyFile_SoftSpace(w, 1);
@@ -1869,14 +2145,14 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_XDECREF(stream);
             stream = NULL;
             if (err == 0)
-                continue;
+                DISPATCH();
             break;
 
-        case PRINT_NEWLINE_TO:
+        TARGET(PRINT_NEWLINE_TO)
             w = stream = POP();
             /* fall through to PRINT_NEWLINE */
 
-        case PRINT_NEWLINE:
+        TARGET(PRINT_NEWLINE)
             if (stream == NULL || stream == Py_None) {
                 w = PySys_GetObject("stdout");
                 if (w == NULL) {
@@ -1902,7 +2178,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 #ifdef CASE_TOO_BIG
         default: switch (opcode) {
 #endif
-        case RAISE_VARARGS:
+        TARGET(RAISE_VARARGS)
             u = v = w = NULL;
             switch (oparg) {
             case 3:
@@ -1924,27 +2200,27 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             }
             break;
 
-        case LOAD_LOCALS:
+        TARGET(LOAD_LOCALS)
             if ((x = f->f_locals) != NULL) {
                 Py_INCREF(x);
                 PUSH(x);
-                continue;
+                DISPATCH();
             }
             PyErr_SetString(PyExc_SystemError, "no locals");
             break;
 
-        case RETURN_VALUE:
+        TARGET(RETURN_VALUE)
             retval = POP();
             why = WHY_RETURN;
             goto fast_block_end;
 
-        case YIELD_VALUE:
+        TARGET(YIELD_VALUE)
             retval = POP();
             f->f_stacktop = stack_pointer;
             why = WHY_YIELD;
             goto fast_yield;
 
-        case EXEC_STMT:
+        TARGET(EXEC_STMT)
             w = TOP();
             v = SECOND();
             u = THIRD();
@@ -1957,7 +2233,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(w);
             break;
 
-        case POP_BLOCK:
+        TARGET(POP_BLOCK)
             {
                 PyTryBlock *b = PyFrame_BlockPop(f);
                 while (STACK_LEVEL() > b->b_level) {
@@ -1965,10 +2241,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                     Py_DECREF(v);
                 }
             }
-            continue;
+            DISPATCH();
 
         PREDICTED(END_FINALLY);
-        case END_FINALLY:
+        TARGET(END_FINALLY)
             v = POP();
             if (PyInt_Check(v)) {
                 why = (enum why_code) PyInt_AS_LONG(v);
@@ -1993,7 +2269,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(v);
             break;
 
-        case BUILD_CLASS:
+        TARGET(BUILD_CLASS)
             u = TOP();
             v = SECOND();
             w = THIRD();
@@ -2005,7 +2281,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(w);
             break;
 
-        case STORE_NAME:
+        TARGET(STORE_NAME)
             w = GETITEM(names, oparg);
             v = POP();
             if ((x = f->f_locals) != NULL) {
@@ -2014,7 +2290,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 else
                     err = PyObject_SetItem(x, w, v);
                 Py_DECREF(v);
-                if (err == 0) continue;
+                if (err == 0) DISPATCH();
                 break;
             }
             PyErr_Format(PyExc_SystemError,
@@ -2022,7 +2298,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                          PyObject_REPR(w));
             break;
 
-        case DELETE_NAME:
+        TARGET(DELETE_NAME)
             w = GETITEM(names, oparg);
             if ((x = f->f_locals) != NULL) {
                 if ((err = PyObject_DelItem(x, w)) != 0)
@@ -2037,7 +2313,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             break;
 
         PREDICTED_WITH_ARG(UNPACK_SEQUENCE);
-        case UNPACK_SEQUENCE:
+        TARGET(UNPACK_SEQUENCE)
             v = POP();
             if (PyTuple_CheckExact(v) &&
                 PyTuple_GET_SIZE(v) == oparg) {
@@ -2049,7 +2325,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                     PUSH(w);
                 }
                 Py_DECREF(v);
-                continue;
+                DISPATCH();
             } else if (PyList_CheckExact(v) &&
                        PyList_GET_SIZE(v) == oparg) {
                 PyObject **items = \
@@ -2069,7 +2345,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(v);
             break;
 
-        case STORE_ATTR:
+        TARGET(STORE_ATTR)
             w = GETITEM(names, oparg);
             v = TOP();
             u = SECOND();
@@ -2077,10 +2353,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             err = PyObject_SetAttr(v, w, u); /* v.w = u */
             Py_DECREF(v);
             Py_DECREF(u);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case DELETE_ATTR:
+        TARGET(DELETE_ATTR)
             w = GETITEM(names, oparg);
             v = POP();
             err = PyObject_SetAttr(v, w, (PyObject *)NULL);
@@ -2088,22 +2364,22 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(v);
             break;
 
-        case STORE_GLOBAL:
+        TARGET(STORE_GLOBAL)
             w = GETITEM(names, oparg);
             v = POP();
             err = PyDict_SetItem(f->f_globals, w, v);
             Py_DECREF(v);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case DELETE_GLOBAL:
+        TARGET(DELETE_GLOBAL)
             w = GETITEM(names, oparg);
             if ((err = PyDict_DelItem(f->f_globals, w)) != 0)
                 format_exc_check_arg(
                     PyExc_NameError, GLOBAL_NAME_ERROR_MSG, w);
             break;
 
-        case LOAD_NAME:
+        TARGET(LOAD_NAME)
             w = GETITEM(names, oparg);
             if ((v = f->f_locals) == NULL) {
                 PyErr_Format(PyExc_SystemError,
@@ -2139,10 +2415,23 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 Py_INCREF(x);
             }
             PUSH(x);
-            continue;
+            DISPATCH();
 
-        case LOAD_GLOBAL:
+        TARGET(LOAD_GLOBAL)
             w = GETITEM(names, oparg);
+            OPCACHE_CHECK();
+            if (co_opcache != NULL && co_opcache->optimized > 0) {
+                _PyOpcache_LoadGlobal *lg = &co_opcache->u.lg;
+                if (lg->globals_ver ==
+                        ((PyDictObject *)f->f_globals)->ma_version_tag &&
+                    lg->builtins_ver ==
+                        ((PyDictObject *)f->f_builtins)->ma_version_tag) {
+                    x = lg->ptr;
+                    Py_INCREF(x);
+                    PUSH(x);
+                    DISPATCH();
+                }
+            }
             if (PyString_CheckExact(w)) {
                 /* Inline the PyDict_GetItem() calls.
                    WARNING: this is an extreme speed hack.
@@ -2150,31 +2439,25 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 long hash = ((PyStringObject *)w)->ob_shash;
                 if (hash != -1) {
                     PyDictObject *d;
-                    PyDictEntry *e;
+                    Py_ssize_t ix;
                     d = (PyDictObject *)(f->f_globals);
-                    e = d->ma_lookup(d, w, hash);
-                    if (e == NULL) {
+                    ix = d->ma_lookup(d, w, hash, NULL);
+                    if (ix == DKIX_ERROR) {
                         x = NULL;
                         break;
                     }
-                    x = e->me_value;
-                    if (x != NULL) {
-                        Py_INCREF(x);
-                        PUSH(x);
-                        continue;
-                    }
+                    x = ix >= 0 ? _PyDict_VALUE(d, ix) : NULL;
+                    if (x != NULL)
+                        goto load_global_found;
                     d = (PyDictObject *)(f->f_builtins);
-                    e = d->ma_lookup(d, w, hash);
-                    if (e == NULL) {
+                    ix = d->ma_lookup(d, w, hash, NULL);
+                    if (ix == DKIX_ERROR) {
                         x = NULL;
                         break;
                     }
-                    x = e->me_value;
-                    if (x != NULL) {
-                        Py_INCREF(x);
-                        PUSH(x);
-                        continue;
-                    }
+                    x = ix >= 0 ? _PyDict_VALUE(d, ix) : NULL;
+                    if (x != NULL)
+                        goto load_global_found;
                     goto load_global_error;
                 }
             }
@@ -2190,15 +2473,25 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                     break;
                 }
             }
+          load_global_found:
+            if (co_opcache != NULL) {
+                _PyOpcache_LoadGlobal *lg = &co_opcache->u.lg;
+                lg->ptr = x;
+                lg->globals_ver =
+                    ((PyDictObject *)f->f_globals)->ma_version_tag;
+                lg->builtins_ver =
+                    ((PyDictObject *)f->f_builtins)->ma_version_tag;
+                co_opcache->optimized = 1;
+            }
             Py_INCREF(x);
             PUSH(x);
-            continue;
+            DISPATCH();
 
-        case DELETE_FAST:
+        TARGET(DELETE_FAST)
             x = GETLOCAL(oparg);
             if (x != NULL) {
                 SETLOCAL(oparg, NULL);
-                continue;
+                DISPATCH();
             }
             format_exc_check_arg(
                 PyExc_UnboundLocalError,
@@ -2207,19 +2500,19 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 );
             break;
 
-        case LOAD_CLOSURE:
+        TARGET(LOAD_CLOSURE)
             x = freevars[oparg];
             Py_INCREF(x);
             PUSH(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case LOAD_DEREF:
+        TARGET(LOAD_DEREF)
             x = freevars[oparg];
             w = PyCell_Get(x);
             if (w != NULL) {
                 PUSH(w);
-                continue;
+                DISPATCH();
             }
             err = -1;
             /* Don't stomp existing exception */
@@ -2240,14 +2533,14 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             }
             break;
 
-        case STORE_DEREF:
+        TARGET(STORE_DEREF)
             w = POP();
             x = freevars[oparg];
             PyCell_Set(x, w);
             Py_DECREF(w);
-            continue;
+            DISPATCH();
 
-        case BUILD_TUPLE:
+        TARGET(BUILD_TUPLE)
             x = PyTuple_New(oparg);
             if (x != NULL) {
                 for (; --oparg >= 0;) {
@@ -2255,11 +2548,11 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                     PyTuple_SET_ITEM(x, oparg, w);
                 }
                 PUSH(x);
-                continue;
+                DISPATCH();
             }
             break;
 
-        case BUILD_LIST:
+        TARGET(BUILD_LIST)
             x =  PyList_New(oparg);
             if (x != NULL) {
                 for (; --oparg >= 0;) {
@@ -2267,11 +2560,11 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                     PyList_SET_ITEM(x, oparg, w);
                 }
                 PUSH(x);
-                continue;
+                DISPATCH();
             }
             break;
 
-        case BUILD_SET:
+        TARGET(BUILD_SET)
             x = PySet_New(NULL);
             if (x != NULL) {
                 for (; --oparg >= 0;) {
@@ -2285,18 +2578,18 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                     break;
                 }
                 PUSH(x);
-                continue;
+                DISPATCH();
             }
             break;
 
 
-        case BUILD_MAP:
+        TARGET(BUILD_MAP)
             x = _PyDict_NewPresized((Py_ssize_t)oparg);
             PUSH(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case STORE_MAP:
+        TARGET(STORE_MAP)
             w = TOP();     /* key */
             u = SECOND();  /* value */
             v = THIRD();   /* dict */
@@ -2305,10 +2598,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             err = PyDict_SetItem(v, w, u);  /* v[w] = u */
             Py_DECREF(u);
             Py_DECREF(w);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case MAP_ADD:
+        TARGET(MAP_ADD)
             w = TOP();     /* key */
             u = SECOND();  /* value */
             STACKADJ(-2);
@@ -2319,20 +2612,47 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(w);
             if (err == 0) {
                 PREDICT(JUMP_ABSOLUTE);
-                continue;
+                DISPATCH();
             }
             break;
 
-        case LOAD_ATTR:
+        TARGET(LOAD_ATTR)
             w = GETITEM(names, oparg);
             v = TOP();
-            x = PyObject_GetAttr(v, w);
+            OPCACHE_CHECK();
+            if (co_opcache != NULL && co_opcache->optimized >= 0)
+                x = load_attr_cached(v, w, co_opcache);
+            else
+                x = PyObject_GetAttr(v, w);
             Py_DECREF(v);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
+            break;
+
+        TARGET(LOAD_METHOD)
+        {
+            /* Leaves the unbound method and the object on the stack
+               when load_method() finds one, NULL and the attribute
+               otherwise; CALL_METHOD handles both layouts. */
+            PyObject *meth;
+            w = GETITEM(names, oparg);
+            v = TOP();
+            if (load_method(v, w, &meth)) {
+                SET_TOP(meth);
+                PUSH(v);
+                DISPATCH();
+            }
+            Py_DECREF(v);
+            SET_TOP(NULL);
+            x = meth;
+            if (x != NULL) {
+                PUSH(x);
+                DISPATCH();
+            }
             break;
+        }
 
-        case COMPARE_OP:
+        TARGET(COMPARE_OP)
             w = POP();
             v = TOP();
             if (PyInt_CheckExact(w) && PyInt_CheckExact(v)) {
@@ -2352,6 +2672,8 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 case PyCmp_IS_NOT: res = v != w; break;
                 default: goto slow_compare;
                 }
+                if (oparg <= PyCmp_GE)
+                    QUICKEN(COMPARE_OP_INT);
                 x = res ? Py_True : Py_False;
                 Py_INCREF(x);
             }
@@ -2365,9 +2687,37 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             if (x == NULL) break;
             PREDICT(POP_JUMP_IF_FALSE);
             PREDICT(POP_JUMP_IF_TRUE);
-            continue;
+            DISPATCH();
+
+        TARGET(COMPARE_OP_INT)
+            w = TOP();
+            v = SECOND();
+            if (PyInt_CheckExact(w) && PyInt_CheckExact(v)) {
+                register long a, b;
+                register int res;
+                a = PyInt_AS_LONG(v);
+                b = PyInt_AS_LONG(w);
+                switch (oparg) {
+                case PyCmp_LT: res = a <  b; break;
+                case PyCmp_LE: res = a <= b; break;
+                case PyCmp_EQ: res = a == b; break;
+                case PyCmp_NE: res = a != b; break;
+                case PyCmp_GT: res = a >  b; break;
+                default:       res = a >= b; break;
+                }
+                x = res ? Py_True : Py_False;
+                Py_INCREF(x);
+                STACKADJ(-1);
+                Py_DECREF(v);
+                Py_DECREF(w);
+                SET_TOP(x);
+                PREDICT(POP_JUMP_IF_FALSE);
+                PREDICT(POP_JUMP_IF_TRUE);
+                DISPATCH();
+            }
+            DEOPTIMIZE(COMPARE_OP);
 
-        case IMPORT_NAME:
+        TARGET(IMPORT_NAME)
             w = GETITEM(names, oparg);
             x = PyDict_GetItemString(f->f_builtins, "__import__");
             if (x == NULL) {
@@ -2408,10 +2758,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             READ_TIMESTAMP(intr1);
             Py_DECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case IMPORT_STAR:
+        TARGET(IMPORT_STAR)
             v = POP();
             PyFrame_FastToLocals(f);
             if ((x = f->f_locals) == NULL) {
@@ -2424,34 +2774,34 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             READ_TIMESTAMP(intr1);
             PyFrame_LocalsToFast(f, 0);
             Py_DECREF(v);
-            if (err == 0) continue;
+            if (err == 0) DISPATCH();
             break;
 
-        case IMPORT_FROM:
+        TARGET(IMPORT_FROM)
             w = GETITEM(names, oparg);
             v = TOP();
             READ_TIMESTAMP(intr0);
             x = import_from(v, w);
             READ_TIMESTAMP(intr1);
             PUSH(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case JUMP_FORWARD:
+        TARGET(JUMP_FORWARD)
             JUMPBY(oparg);
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 
         PREDICTED_WITH_ARG(POP_JUMP_IF_FALSE);
-        case POP_JUMP_IF_FALSE:
+        TARGET(POP_JUMP_IF_FALSE)
             w = POP();
             if (w == Py_True) {
                 Py_DECREF(w);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             if (w == Py_False) {
                 Py_DECREF(w);
                 JUMPTO(oparg);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             err = PyObject_IsTrue(w);
             Py_DECREF(w);
@@ -2461,19 +2811,19 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 JUMPTO(oparg);
             else
                 break;
-            continue;
+            DISPATCH();
 
         PREDICTED_WITH_ARG(POP_JUMP_IF_TRUE);
-        case POP_JUMP_IF_TRUE:
+        TARGET(POP_JUMP_IF_TRUE)
             w = POP();
             if (w == Py_False) {
                 Py_DECREF(w);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             if (w == Py_True) {
                 Py_DECREF(w);
                 JUMPTO(oparg);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             err = PyObject_IsTrue(w);
             Py_DECREF(w);
@@ -2485,18 +2835,18 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 ;
             else
                 break;
-            continue;
+            DISPATCH();
 
-        case JUMP_IF_FALSE_OR_POP:
+        TARGET(JUMP_IF_FALSE_OR_POP)
             w = TOP();
             if (w == Py_True) {
                 STACKADJ(-1);
                 Py_DECREF(w);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             if (w == Py_False) {
                 JUMPTO(oparg);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             err = PyObject_IsTrue(w);
             if (err > 0) {
@@ -2508,18 +2858,18 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 JUMPTO(oparg);
             else
                 break;
-            continue;
+            DISPATCH();
 
-        case JUMP_IF_TRUE_OR_POP:
+        TARGET(JUMP_IF_TRUE_OR_POP)
             w = TOP();
             if (w == Py_False) {
                 STACKADJ(-1);
                 Py_DECREF(w);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             if (w == Py_True) {
                 JUMPTO(oparg);
-                goto fast_next_opcode;
+                FAST_DISPATCH();
             }
             err = PyObject_IsTrue(w);
             if (err > 0) {
@@ -2532,11 +2882,13 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             }
             else
                 break;
-            continue;
+            DISPATCH();
 
         PREDICTED_WITH_ARG(JUMP_ABSOLUTE);
-        case JUMP_ABSOLUTE:
+        TARGET(JUMP_ABSOLUTE)
             JUMPTO(oparg);
+            OPCACHE_WARMUP();
+            USE_QUICKENED();
 #if FAST_LOOPS
             /* Enabling this path speeds-up all while and for-loops by bypassing
                the per-loop checks for signals.  By default, this should be turned-off
@@ -2545,12 +2897,12 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                the speed-up and do not need break checking inside tight loops (ones
                that contain only instructions ending with goto fast_next_opcode).
             */
-            goto fast_next_opcode;
+            FAST_DISPATCH();
 #else
-            continue;
+            DISPATCH();
 #endif
 
-        case GET_ITER:
+        TARGET(GET_ITER)
             /* before: [obj]; after [getiter(obj)] */
             v = TOP();
             x = PyObject_GetIter(v);
@@ -2558,13 +2910,13 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             if (x != NULL) {
                 SET_TOP(x);
                 PREDICT(FOR_ITER);
-                continue;
+                DISPATCH();
             }
             STACKADJ(-1);
             break;
 
         PREDICTED_WITH_ARG(FOR_ITER);
-        case FOR_ITER:
+        TARGET(FOR_ITER)
             /* before: [iter]; after: [iter, iter()] *or* [] */
             v = TOP();
             x = (*v->ob_type->tp_iternext)(v);
@@ -2572,7 +2924,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 PUSH(x);
                 PREDICT(STORE_FAST);
                 PREDICT(UNPACK_SEQUENCE);
-                continue;
+                DISPATCH();
             }
             if (PyErr_Occurred()) {
                 if (!PyErr_ExceptionMatches(
@@ -2584,13 +2936,13 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             x = v = POP();
             Py_DECREF(v);
             JUMPBY(oparg);
-            continue;
+            DISPATCH();
 
-        case BREAK_LOOP:
+        TARGET(BREAK_LOOP)
             why = WHY_BREAK;
             goto fast_block_end;
 
-        case CONTINUE_LOOP:
+        TARGET(CONTINUE_LOOP)
             retval = PyInt_FromLong(oparg);
             if (!retval) {
                 x = NULL;
@@ -2599,9 +2951,9 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             why = WHY_CONTINUE;
             goto fast_block_end;
 
-        case SETUP_LOOP:
-        case SETUP_EXCEPT:
-        case SETUP_FINALLY:
+        TARGET(SETUP_LOOP)
+        TARGET(SETUP_EXCEPT)
+        TARGET(SETUP_FINALLY)
             /* NOTE: If you add any new block-setup opcodes that
                are not try/except/finally handlers, you may need
                to update the PyGen_NeedsFinalizing() function.
@@ -2609,9 +2961,9 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 
             PyFrame_BlockSetup(f, opcode, INSTR_OFFSET() + oparg,
                                STACK_LEVEL());
-            continue;
+            DISPATCH();
 
-        case SETUP_WITH:
+        TARGET(SETUP_WITH)
         {
             static PyObject *exit, *enter;
             w = TOP();
@@ -2637,10 +2989,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                                STACK_LEVEL());
 
             PUSH(x);
-            continue;
+            DISPATCH();
         }
 
-        case WITH_CLEANUP:
+        TARGET(WITH_CLEANUP)
         {
             /* At the top of the stack are 1-3 values indicating
                how/why we entered the finally clause:
@@ -2728,11 +3080,14 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             break;
         }
 
-        case CALL_FUNCTION:
+        TARGET(CALL_FUNCTION)
         {
             PyObject **sp;
             PCALL(PCALL_ALL);
             sp = stack_pointer;
+            if (PyFunction_Check(
+                    sp[-(oparg & 0xff) - 2*((oparg>>8) & 0xff) - 1]))
+                QUICKEN(CALL_FUNCTION_PY);
 #ifdef WITH_TSC
             x = call_function(&sp, oparg, &intr0, &intr1);
 #else
@@ -2741,13 +3096,78 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             stack_pointer = sp;
             PUSH(x);
             if (x != NULL)
-                continue;
+                DISPATCH();
+            break;
+        }
+
+        TARGET(CALL_METHOD)
+        {
+            PyObject **sp, *meth;
+            int nargs = oparg;
+            PCALL(PCALL_ALL);
+            meth = PEEK(oparg + 2);
+            if (meth != NULL && Py_TYPE(meth) == &PyMethodDescr_Type &&
+                tstate->use_tracing && tstate->c_profilefunc) {
+                /* Profilers want the builtin method in c_call events,
+                   so bind it and call it the usual way */
+                v = PEEK(oparg + 1);
+                x = Py_TYPE(meth)->tp_descr_get(meth, v,
+                                                (PyObject *)Py_TYPE(v));
+                if (x == NULL)
+                    break;
+                stack_pointer[-(oparg + 2)] = NULL;
+                stack_pointer[-(oparg + 1)] = x;
+                Py_DECREF(meth);
+                Py_DECREF(v);
+                meth = NULL;
+            }
+            sp = stack_pointer;
+            /* With an unbound method, the object is its first argument */
+            if (meth != NULL)
+                nargs++;
+#ifdef WITH_TSC
+            x = call_function(&sp, nargs, &intr0, &intr1);
+#else
+            x = call_function(&sp, nargs);
+#endif
+            stack_pointer = sp;
+            if (nargs == oparg)
+                STACKADJ(-1);       /* the NULL below the callable */
+            PUSH(x);
+            if (x != NULL)
+                DISPATCH();
+            break;
+        }
+
+        TARGET(CALL_FUNCTION_PY)
+        {
+            int na = oparg & 0xff;
+            int nk = (oparg>>8) & 0xff;
+            int n = na + 2 * nk;
+            PyObject **pfunc = stack_pointer - n - 1;
+            PyObject **sp;
+            if (!PyFunction_Check(*pfunc))
+                DEOPTIMIZE(CALL_FUNCTION);
+            PCALL(PCALL_ALL);
+            sp = stack_pointer;
+            READ_TIMESTAMP(intr0);
+            x = fast_function(*pfunc, &sp, n, na, nk);
+            READ_TIMESTAMP(intr1);
+            /* fast_function() may leave the arguments on the stack */
+            while (sp > pfunc) {
+                w = EXT_POP(sp);
+                Py_DECREF(w);
+            }
+            stack_pointer = sp;
+            PUSH(x);
+            if (x != NULL)
+                DISPATCH();
             break;
         }
 
-        case CALL_FUNCTION_VAR:
-        case CALL_FUNCTION_KW:
-        case CALL_FUNCTION_VAR_KW:
+        TARGET(CALL_FUNCTION_VAR)
+        TARGET(CALL_FUNCTION_KW)
+        TARGET(CALL_FUNCTION_VAR_KW)
         {
             int na = oparg & 0xff;
             int nk = (oparg>>8) & 0xff;
@@ -2786,11 +3206,11 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             }
             PUSH(x);
             if (x != NULL)
-                continue;
+                DISPATCH();
             break;
         }
 
-        case MAKE_FUNCTION:
+        TARGET(MAKE_FUNCTION)
             v = POP(); /* code object */
             x = PyFunction_New(v, f->f_globals);
             Py_DECREF(v);
@@ -2812,7 +3232,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             PUSH(x);
             break;
 
-        case MAKE_CLOSURE:
+        TARGET(MAKE_CLOSURE)
         {
             v = POP(); /* code object */
             x = PyFunction_New(v, f->f_globals);
@@ -2847,7 +3267,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             break;
         }
 
-        case BUILD_SLICE:
+        TARGET(BUILD_SLICE)
             if (oparg == 3)
                 w = POP();
             else
@@ -2859,14 +3279,17 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             Py_DECREF(v);
             Py_XDECREF(w);
             SET_TOP(x);
-            if (x != NULL) continue;
+            if (x != NULL) DISPATCH();
             break;
 
-        case EXTENDED_ARG:
+        TARGET(EXTENDED_ARG)
             opcode = NEXTOP();
             oparg = oparg<<16 | NEXTARG();
             goto dispatch_opcode;
 
+#ifdef USE_COMPUTED_GOTOS
+        _unknown_opcode:
+#endif
         default:
             fprintf(stderr,
                 "XXX lineno: %d, opcode: %d\n",
@@ -4021,21 +4444,6 @@ PyEval_GetFuncDesc(PyObject *func)
     }
 }
 
-static void
-err_args(PyObject *func, int flags, int nargs)
-{
-    if (flags & METH_NOARGS)
-        PyErr_Format(PyExc_TypeError,
-                     "%.200s() takes no arguments (%d given)",
-                     ((PyCFunctionObject *)func)->m_ml->ml_name,
-                     nargs);
-    else
-        PyErr_Format(PyExc_TypeError,
-                     "%.200s() takes exactly one argument (%d given)",
-                     ((PyCFunctionObject *)func)->m_ml->ml_name,
-                     nargs);
-}
-
 #define C_TRACE(x, call) \
 if (tstate->use_tracing && tstate->c_profilefunc) { \
     if (call_trace(tstate->c_profilefunc, \
@@ -4086,34 +4494,12 @@ call_function(PyObject ***pp_stack, int oparg
        presumed to be the most frequent callable object.
     */
     if (PyCFunction_Check(func) && nk == 0) {
-        int flags = PyCFunction_GET_FLAGS(func);
         PyThreadState *tstate = PyThreadState_GET();
 
         PCALL(PCALL_CFUNCTION);
-        if (flags & (METH_NOARGS | METH_O)) {
-            PyCFunction meth = PyCFunction_GET_FUNCTION(func);
-            PyObject *self = PyCFunction_GET_SELF(func);
-            if (flags & METH_NOARGS && na == 0) {
-                C_TRACE(x, (*meth)(self,NULL));
-            }
-            else if (flags & METH_O && na == 1) {
-                PyObject *arg = EXT_POP(*pp_stack);
-                C_TRACE(x, (*meth)(self,arg));
-                Py_DECREF(arg);
-            }
-            else {
-                err_args(func, flags, na);
-                x = NULL;
-            }
-        }
-        else {
-            PyObject *callargs;
-            callargs = load_args(pp_stack, na);
-            READ_TIMESTAMP(*pintr0);
-            C_TRACE(x, PyCFunction_Call(func,callargs,NULL));
-            READ_TIMESTAMP(*pintr1);
-            Py_XDECREF(callargs);
-        }
+        READ_TIMESTAMP(*pintr0);
+        C_TRACE(x, _PyCFunction_FastCall(func, pfunc + 1, na, NULL));
+        READ_TIMESTAMP(*pintr1);
     } else {
         if (PyMethod_Check(func) && PyMethod_GET_SELF(func) != NULL) {
             /* optimize access to bound methods */
@@ -4143,7 +4529,7 @@ call_function(PyObject ***pp_stack, int oparg
 
     /* Clear the stack of the function object.  Also removes
        the arguments in case they weren't consumed already
-       (fast_function() and err_args() leave them on the stack).
+       (calls without keyword arguments leave them on the stack).
      */
     while ((*pp_stack) > pfunc) {
         w = EXT_POP(*pp_stack);
@@ -4162,6 +4548,42 @@ call_function(PyObject ***pp_stack, int oparg
    done before evaluating the frame.
 */
 
+/* Run co, which only has n positional arguments and no free or cell
+   variables, with the arguments in args */
+static PyObject *
+function_code_fastcall(PyCodeObject *co, PyObject **args, int n,
+                       PyObject *globals)
+{
+    PyFrameObject *f;
+    PyObject *retval = NULL;
+    PyThreadState *tstate = PyThreadState_GET();
+    PyObject **fastlocals;
+    int i;
+
+    PCALL(PCALL_FASTER_FUNCTION);
+    assert(globals != NULL);
+    /* XXX Perhaps we should create a specialized
+       PyFrame_New() that doesn't take locals, but does
+       take builtins without sanity checking them.
+    */
+    assert(tstate != NULL);
+    f = PyFrame_New(tstate, co, globals, NULL);
+    if (f == NULL)
+        return NULL;
+
+    fastlocals = f->f_localsplus;
+
+    for (i = 0; i < n; i++) {
+        Py_INCREF(*args);
+        fastlocals[i] = *args++;
+    }
+    retval = PyEval_EvalFrameEx(f,0);
+    ++tstate->recursion_depth;
+    Py_DECREF(f);
+    --tstate->recursion_depth;
+    return retval;
+}
+
 static PyObject *
 fast_function(PyObject *func, PyObject ***pp_stack, int n, int na, int nk)
 {
@@ -4174,37 +4596,8 @@ fast_function(PyObject *func, PyObject ***pp_stack, int n, int na, int nk)
     PCALL(PCALL_FUNCTION);
     PCALL(PCALL_FAST_FUNCTION);
     if (argdefs == NULL && co->co_argcount == n && nk==0 &&
-        co->co_flags == (CO_OPTIMIZED | CO_NEWLOCALS | CO_NOFREE)) {
-        PyFrameObject *f;
-        PyObject *retval = NULL;
-        PyThreadState *tstate = PyThreadState_GET();
-        PyObject **fastlocals, **stack;
-        int i;
-
-        PCALL(PCALL_FASTER_FUNCTION);
-        assert(globals != NULL);
-        /* XXX Perhaps we should create a specialized
-           PyFrame_New() that doesn't take locals, but does
-           take builtins without sanity checking them.
-        */
-        assert(tstate != NULL);
-        f = PyFrame_New(tstate, co, globals, NULL);
-        if (f == NULL)
-            return NULL;
-
-        fastlocals = f->f_localsplus;
-        stack = (*pp_stack) - n;
-
-        for (i = 0; i < n; i++) {
-            Py_INCREF(*stack);
-            fastlocals[i] = *stack++;
-        }
-        retval = PyEval_EvalFrameEx(f,0);
-        ++tstate->recursion_depth;
-        Py_DECREF(f);
-        --tstate->recursion_depth;
-        return retval;
-    }
+        co->co_flags == (CO_OPTIMIZED | CO_NEWLOCALS | CO_NOFREE))
+        return function_code_fastcall(co, (*pp_stack) - n, n, globals);
     if (argdefs != NULL) {
         d = &PyTuple_GET_ITEM(argdefs, 0);
         nd = Py_SIZE(argdefs);
@@ -4215,6 +4608,52 @@ fast_function(PyObject *func, PyObject ***pp_stack, int n, int na, int nk)
                              PyFunction_GET_CLOSURE(func));
 }
 
+/* fast_function() for calls from C (PyFunction_Type.tp_fastcall).  The
+   keyword arguments come as a tuple of names and an array of values,
+   which PyEval_EvalCodeEx() wants as (name, value) pairs. */
+PyObject *
+_PyFunction_FastCall(PyObject *func, PyObject **args, Py_ssize_t nargs,
+                     PyObject *kwnames)
+{
+    PyCodeObject *co = (PyCodeObject *)PyFunction_GET_CODE(func);
+    PyObject *globals = PyFunction_GET_GLOBALS(func);
+    PyObject *argdefs = PyFunction_GET_DEFAULTS(func);
+    PyObject **d = NULL, **kws = NULL, *result;
+    Py_ssize_t nk, i;
+    int nd = 0;
+
+    nk = (kwnames == NULL) ? 0 : PyTuple_GET_SIZE(kwnames);
+    if (nargs > INT_MAX || nk > INT_MAX / 2) {
+        PyErr_SetString(PyExc_OverflowError, "too many arguments");
+        return NULL;
+    }
+    PCALL(PCALL_FUNCTION);
+    PCALL(PCALL_FAST_FUNCTION);
+    if (argdefs == NULL && co->co_argcount == nargs && nk == 0 &&
+        co->co_flags == (CO_OPTIMIZED | CO_NEWLOCALS | CO_NOFREE))
+        return function_code_fastcall(co, args, (int)nargs, globals);
+    if (argdefs != NULL) {
+        d = &PyTuple_GET_ITEM(argdefs, 0);
+        nd = Py_SIZE(argdefs);
+    }
+    if (nk > 0) {
+        kws = PyMem_NEW(PyObject *, 2 * nk);
+        if (kws == NULL)
+            return PyErr_NoMemory();
+        for (i = 0; i < nk; i++) {
+            kws[2*i] = PyTuple_GET_ITEM(kwnames, i);
+            kws[2*i + 1] = args[nargs + i];
+        }
+    }
+    result = PyEval_EvalCodeEx(co, globals,
+                               (PyObject *)NULL, args, (int)nargs,
+                               kws, (int)nk, d, nd,
+                               PyFunction_GET_CLOSURE(func));
+    if (kws != NULL)
+        PyMem_FREE(kws);
+    return result;
+}
+
 static PyObject *
 update_keyword_args(PyObject *orig_kwdict, int nk, PyObject ***pp_stack,
                     PyObject *func)
@@ -4302,14 +4741,6 @@ do_call(PyObject *func, PyObject ***pp_stack, int na, int nk)
     PyObject *kwdict = NULL;
     PyObject *result = NULL;
 
-    if (nk > 0) {
-        kwdict = update_keyword_args(NULL, nk, pp_stack, func);
-        if (kwdict == NULL)
-            goto call_fail;
-    }
-    callargs = load_args(pp_stack, na);
-    if (callargs == NULL)
-        goto call_fail;
 #ifdef CALL_PROFILE
     /* At this point, we have to look at the type of func to
        update the call stats properly.  Do it here so as to avoid
@@ -4326,6 +4757,24 @@ do_call(PyObject *func, PyObject ***pp_stack, int na, int nk)
     else
         PCALL(PCALL_OTHER);
 #endif
+    /* Without keyword arguments the callee can take the arguments
+       straight from the stack; call_function() pops them afterwards. */
+    if (nk == 0) {
+        if (PyCFunction_Check(func)) {
+            PyThreadState *tstate = PyThreadState_GET();
+            C_TRACE(result, _PyCFunction_FastCall(func, (*pp_stack) - na,
+                                                  na, NULL));
+        }
+        else
+            result = _PyObject_FastCall(func, (*pp_stack) - na, na, NULL);
+        return result;
+    }
+    kwdict = update_keyword_args(NULL, nk, pp_stack, func);
+    if (kwdict == NULL)
+        goto call_fail;
+    callargs = load_args(pp_stack, na);
+    if (callargs == NULL)
+        goto call_fail;
     if (PyCFunction_Check(func)) {
         PyThreadState *tstate = PyThreadState_GET();
         C_TRACE(result, PyCFunction_Call(func, callargs, kwdict));
@@ -4543,6 +4992,146 @@ assign_slice(PyObject *u, PyObject *v, PyObject *w, PyObject *x)
 #define CANNOT_CATCH_MSG "catching classes that don't inherit from " \
                          "BaseException is not allowed in 3.x"
 
+/* LOAD_ATTR through the instruction's inline cache.  This is
+   PyObject_GenericGetAttr() with the _PyType_Lookup() result remembered
+   for one type, plus a hint telling where the name sat in the instance
+   dict last time.  Anything that is not a plain generic getattr on a
+   string name goes through PyObject_GetAttr(). */
+static PyObject *
+load_attr_cached(PyObject *owner, PyObject *name, _PyOpcache *oc)
+{
+    _PyOpcache_LoadAttr *la = &oc->u.la;
+    PyTypeObject *tp = Py_TYPE(owner);
+    PyObject *descr, *res, **dictptr;
+    descrgetfunc f = NULL;
+
+    if (oc->optimized <= 0 || la->type != tp ||
+        la->tp_version != tp->tp_version_tag ||
+        !PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG)) {
+        /* Miss: refill the entry, or give up on it */
+        if (oc->optimized > 0 && ++oc->misses >= OPCACHE_MAX_MISSES)
+            goto disable;
+        oc->optimized = 0;
+        if (tp->tp_getattro != PyObject_GenericGetAttr ||
+            !PyString_CheckExact(name) || tp->tp_dict == NULL)
+            goto uncacheable;
+        descr = _PyType_Lookup(tp, name);
+        if (!PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG))
+            goto uncacheable;
+        la->type = tp;
+        la->tp_version = tp->tp_version_tag;
+        la->descr = descr;
+        la->hint = -1;
+        oc->optimized = 1;
+    }
+    else
+        descr = la->descr;
+
+    if (descr != NULL &&
+        PyType_HasFeature(descr->ob_type, Py_TPFLAGS_HAVE_CLASS)) {
+        f = descr->ob_type->tp_descr_get;
+        if (f != NULL && PyDescr_IsData(descr)) {
+            Py_INCREF(descr);
+            res = f(descr, owner, (PyObject *)tp);
+            Py_DECREF(descr);
+            return res;
+        }
+    }
+
+    dictptr = _PyObject_GetDictPtr(owner);
+    if (dictptr != NULL && *dictptr != NULL) {
+        PyDictObject *mp = (PyDictObject *)*dictptr;
+        Py_ssize_t hint = la->hint;
+        Py_ssize_t ix;
+        long hash;
+
+        if (hint >= 0 && hint < mp->ma_fill &&
+            mp->ma_table[hint].me_key == name) {
+            res = _PyDict_VALUE(mp, hint);
+            if (res != NULL) {
+                Py_INCREF(res);
+                return res;
+            }
+        }
+        hash = ((PyStringObject *)name)->ob_shash;
+        if (hash == -1)
+            hash = PyObject_Hash(name);
+        ix = mp->ma_lookup(mp, name, hash, NULL);
+        if (ix == DKIX_ERROR)
+            /* Like PyDict_GetItem(), ignore errors from __eq__ */
+            PyErr_Clear();
+        else if (ix >= 0 && (res = _PyDict_VALUE(mp, ix)) != NULL) {
+            la->hint = ix;
+            Py_INCREF(res);
+            return res;
+        }
+    }
+
+    if (f != NULL) {
+        Py_INCREF(descr);
+        res = f(descr, owner, (PyObject *)tp);
+        Py_DECREF(descr);
+        return res;
+    }
+    if (descr != NULL) {
+        Py_INCREF(descr);
+        return descr;
+    }
+    PyErr_Format(PyExc_AttributeError,
+                 "'%.50s' object has no attribute '%.400s'",
+                 tp->tp_name, PyString_AS_STRING(name));
+    return NULL;
+
+  uncacheable:
+    if (++oc->misses < OPCACHE_MAX_MISSES)
+        return PyObject_GetAttr(owner, name);
+  disable:
+    oc->optimized = -1;
+    return PyObject_GetAttr(owner, name);
+}
+
+/* LOAD_METHOD.  When looking name up on owner would find a Python
+   function or a method descriptor on its type, and only have to bind
+   it to owner, store that unbound method in *pmeth and return 1; the
+   call then passes owner as the first argument and no bound method is
+   ever created.  Otherwise store what PyObject_GetAttr() returns (NULL
+   on error) and return 0. */
+static int
+load_method(PyObject *owner, PyObject *name, PyObject **pmeth)
+{
+    PyTypeObject *tp = Py_TYPE(owner);
+    PyObject *descr, *attr, **dictptr;
+
+    if (tp->tp_getattro != PyObject_GenericGetAttr ||
+        !PyString_CheckExact(name) || tp->tp_dict == NULL)
+        goto getattr;
+    descr = _PyType_Lookup(tp, name);
+    if (descr != NULL && !PyFunction_Check(descr) &&
+        Py_TYPE(descr) != &PyMethodDescr_Type)
+        goto getattr;
+
+    /* Neither kind of method is a data descriptor, so an attribute
+       of the same name in the instance dict wins */
+    dictptr = _PyObject_GetDictPtr(owner);
+    if (dictptr != NULL && *dictptr != NULL) {
+        attr = PyDict_GetItem(*dictptr, name);
+        if (attr != NULL) {
+            Py_INCREF(attr);
+            *pmeth = attr;
+            return 0;
+        }
+    }
+    if (descr == NULL)
+        goto getattr;
+    Py_INCREF(descr);
+    *pmeth = descr;
+    return 1;
+
+  getattr:
+    *pmeth = PyObject_GetAttr(owner, name);
+    return 0;
+}
+
 static PyObject *
 cmp_outcome(int op, register PyObject *v, register PyObject *w)
 {
@@ -4892,21 +5481,10 @@ format_exc_check_arg(PyObject *exc, char *format_str, PyObject *obj)
     PyErr_Format(exc, format_str, obj_str);
 }
 
-static PyObject *
-string_concatenate(PyObject *v, PyObject *w,
-                   PyFrameObject *f, unsigned char *next_instr)
+static void
+release_concat_target(PyObject *v, PyFrameObject *f,
+                      unsigned char *next_instr)
 {
-    /* This function implements 'variable += expr' when both arguments
-       are strings. */
-    Py_ssize_t v_len = PyString_GET_SIZE(v);
-    Py_ssize_t w_len = PyString_GET_SIZE(w);
-    Py_ssize_t new_len = v_len + w_len;
-    if (new_len < 0) {
-        PyErr_SetString(PyExc_OverflowError,
-                        "strings are too large to concat");
-        return NULL;
-    }
-
     if (v->ob_refcnt == 2) {
         /* In the common case, there are 2 references to the value
          * stored in 'variable' when the += is performed: one on the
@@ -4947,8 +5525,28 @@ string_concatenate(PyObject *v, PyObject *w,
         }
         }
     }
+}
+
+static PyObject *
+string_concatenate(PyObject *v, PyObject *w,
+                   PyFrameObject *f, unsigned char *next_instr)
+{
+    /* This function implements 'variable += expr' when both arguments
+       are strings. */
+    PyObject *x;
+    Py_ssize_t v_len = PyString_GET_SIZE(v);
+    Py_ssize_t w_len = PyString_GET_SIZE(w);
+    Py_ssize_t new_len = v_len + w_len;
+    if (new_len < 0) {
+        PyErr_SetString(PyExc_OverflowError,
+                        "strings are too large to concat");
+        return NULL;
+    }
 
-    if (v->ob_refcnt == 1 && !PyString_CHECK_INTERNED(v)) {
+    release_concat_target(v, f, next_instr);
+
+    if (v->ob_refcnt == 1 && !PyString_CHECK_INTERNED(v) &&
+        !PyString_CHECK_LAZY(v)) {
         /* Now we own the last reference to 'v', so we can resize it
          * in-place.
          */
@@ -4967,11 +5565,51 @@ string_concatenate(PyObject *v, PyObject *w,
         return v;
     }
     else {
-        /* When in-place resizing is not an option. */
-        PyString_Concat(&v, w);
+        /* When in-place resizing is not an option, a long result only
+           records its pieces, so that a loop of += copies the
+           characters just once. */
+        x = _PyString_ConcatLazy(v, w);
+        Py_DECREF(v);
+        return x;
+    }
+}
+
+#ifdef Py_USING_UNICODE
+static PyObject *
+unicode_concatenate(PyObject *v, PyObject *w,
+                    PyFrameObject *f, unsigned char *next_instr)
+{
+    /* The same as string_concatenate(), for unicode objects. */
+    PyObject *x;
+    Py_ssize_t v_len = PyUnicode_GET_SIZE(v);
+    Py_ssize_t w_len = PyUnicode_GET_SIZE(w);
+    Py_ssize_t new_len = v_len + w_len;
+    if (new_len < 0) {
+        PyErr_SetString(PyExc_OverflowError,
+                        "strings are too large to concat");
+        return NULL;
+    }
+
+    release_concat_target(v, f, next_instr);
+
+    /* the empty and one-character objects may be shared; the others
+       have their buffer reallocated in place, unless their characters
+       are compact, which the lazy concatenation keeps as they are */
+    if (v->ob_refcnt == 1 && v_len > 1 && !PyUnicode_CHECK_LAZY(v) &&
+        !_PyUnicode_KIND(v) && !_PyUnicode_KIND(w)) {
+        Py_UNICODE *w_str = PyUnicode_AS_UNICODE(w);
+        if (w_str == NULL || PyUnicode_Resize(&v, new_len) != 0) {
+            Py_DECREF(v);
+            return NULL;
+        }
+        Py_UNICODE_COPY(PyUnicode_AS_UNICODE(v) + v_len, w_str, w_len);
         return v;
     }
+    x = _PyUnicode_ConcatLazy(v, w);
+    Py_DECREF(v);
+    return x;
 }
+#endif
 
 #ifdef DYNAMIC_EXECUTION_PROFILE
 
@@ -897,6 +897,8 @@ opcode_stack_effect(int opcode, int oparg)
             return 1;
         case LOAD_ATTR:
             return 0;
+        case LOAD_METHOD:
+            return 1;
         case COMPARE_OP:
             return -1;
         case IMPORT_NAME:
@@ -942,6 +944,8 @@ opcode_stack_effect(int opcode, int oparg)
         case CALL_FUNCTION_VAR_KW:
             return -NARGS(oparg)-2;
 #undef NARGS
+        case CALL_METHOD:
+            return -oparg-1;
         case MAKE_FUNCTION:
             return -oparg;
         case BUILD_SLICE:
@@ -2640,8 +2644,24 @@ static int
 compiler_call(struct compiler *c, expr_ty e)
 {
     int n, code = 0;
+    expr_ty func = e->v.Call.func;
+
+    /* obj.name(args) with positional arguments only: fetch the method
+       without binding it to obj (see LOAD_METHOD in ceval.c).  obj then
+       counts as one more argument, which must still fit in the low byte
+       of the oparg of call_function(). */
+    if (func->kind == Attribute_kind && func->v.Attribute.ctx == Load &&
+        asdl_seq_LEN(e->v.Call.args) < 255 &&
+        asdl_seq_LEN(e->v.Call.keywords) == 0 &&
+        e->v.Call.starargs == NULL && e->v.Call.kwargs == NULL) {
+        VISIT(c, expr, func->v.Attribute.value);
+        ADDOP_NAME(c, LOAD_METHOD, func->v.Attribute.attr, names);
+        VISIT_SEQ(c, expr, e->v.Call.args);
+        ADDOP_I(c, CALL_METHOD, asdl_seq_LEN(e->v.Call.args));
+        return 1;
+    }
 
-    VISIT(c, expr, e->v.Call.func);
+    VISIT(c, expr, func);
     n = asdl_seq_LEN(e->v.Call.args);
     VISIT_SEQ(c, expr, e->v.Call.args);
 
@@ -28,6 +28,10 @@ PyAPI_FUNC(PyObject *) _Py_BuildValue_SizeT(const char *, ...);
 PyAPI_FUNC(int) _PyArg_VaParse_SizeT(PyObject *, char *, va_list);
 PyAPI_FUNC(int) _PyArg_VaParseTupleAndKeywords_SizeT(PyObject *, PyObject *,
                                               const char *, char **, va_list);
+PyAPI_FUNC(int) _PyArg_ParseTupleAndKeywordsFast_SizeT(PyObject *, PyObject *,
+                                            struct _PyArg_Parser *, ...);
+PyAPI_FUNC(int) _PyArg_ParseStack_SizeT(PyObject **, Py_ssize_t, PyObject *,
+                                        struct _PyArg_Parser *, ...);
 #endif
 
 #define FLAG_COMPAT 1
@@ -48,6 +52,9 @@ static int getbuffer(PyObject *, Py_buffer *, char**);
 
 static int vgetargskeywords(PyObject *, PyObject *,
                             const char *, char **, va_list *, int);
+static int vgetargskeywordsfast(PyObject **, Py_ssize_t, PyObject *,
+                                PyObject *, struct _PyArg_Parser *,
+                                va_list *, int);
 static char *skipitem(const char **, va_list *, int);
 
 int
@@ -1183,6 +1190,9 @@ convertsimple(PyObject *arg, const char **p_format, va_list *p_va, int flags,
             FETCH_SIZE;
             if (PyUnicode_Check(arg)) {
                 *p = PyUnicode_AS_UNICODE(arg);
+                if (*p == NULL)
+                    return converterr("(memory error)",
+                                      arg, msgbuf, bufsize);
                 STORE_SIZE(PyUnicode_GET_SIZE(arg));
             }
             else {
@@ -1192,10 +1202,12 @@ convertsimple(PyObject *arg, const char **p_format, va_list *p_va, int flags,
             format++;
         } else {
             Py_UNICODE **p = va_arg(*p_va, Py_UNICODE **);
-            if (PyUnicode_Check(arg))
-                *p = PyUnicode_AS_UNICODE(arg);
-            else
+            if (!PyUnicode_Check(arg))
                 return converterr("unicode", arg, msgbuf, bufsize);
+            *p = PyUnicode_AS_UNICODE(arg);
+            if (*p == NULL)
+                return converterr("(memory error)",
+                                  arg, msgbuf, bufsize);
         }
         break;
     }
@@ -1533,6 +1545,97 @@ _PyArg_VaParseTupleAndKeywords_SizeT(PyObject *args,
     return retval;
 }
 
+/* The same with a static parser, for arguments in a tuple and a dict */
+int
+_PyArg_ParseTupleAndKeywordsFast(PyObject *args, PyObject *keywords,
+                                 struct _PyArg_Parser *parser, ...)
+{
+    int retval;
+    va_list va;
+
+    if ((args == NULL || !PyTuple_Check(args)) ||
+        (keywords != NULL && !PyDict_Check(keywords)) ||
+        parser == NULL)
+    {
+        PyErr_BadInternalCall();
+        return 0;
+    }
+
+    va_start(va, parser);
+    retval = vgetargskeywordsfast(&PyTuple_GET_ITEM(args, 0),
+                                  PyTuple_GET_SIZE(args), keywords, NULL,
+                                  parser, &va, 0);
+    va_end(va);
+    return retval;
+}
+
+int
+_PyArg_ParseTupleAndKeywordsFast_SizeT(PyObject *args, PyObject *keywords,
+                                       struct _PyArg_Parser *parser, ...)
+{
+    int retval;
+    va_list va;
+
+    if ((args == NULL || !PyTuple_Check(args)) ||
+        (keywords != NULL && !PyDict_Check(keywords)) ||
+        parser == NULL)
+    {
+        PyErr_BadInternalCall();
+        return 0;
+    }
+
+    va_start(va, parser);
+    retval = vgetargskeywordsfast(&PyTuple_GET_ITEM(args, 0),
+                                  PyTuple_GET_SIZE(args), keywords, NULL,
+                                  parser, &va, FLAG_SIZE_T);
+    va_end(va);
+    return retval;
+}
+
+/* The same for the arguments of a METH_FASTCALL function: nargs positional
+   arguments, followed by the values of the keywords named in kwnames */
+int
+_PyArg_ParseStack(PyObject **args, Py_ssize_t nargs, PyObject *kwnames,
+                  struct _PyArg_Parser *parser, ...)
+{
+    int retval;
+    va_list va;
+
+    if ((kwnames != NULL && !PyTuple_Check(kwnames)) ||
+        parser == NULL)
+    {
+        PyErr_BadInternalCall();
+        return 0;
+    }
+
+    va_start(va, parser);
+    retval = vgetargskeywordsfast(args, nargs, NULL, kwnames,
+                                  parser, &va, 0);
+    va_end(va);
+    return retval;
+}
+
+int
+_PyArg_ParseStack_SizeT(PyObject **args, Py_ssize_t nargs, PyObject *kwnames,
+                        struct _PyArg_Parser *parser, ...)
+{
+    int retval;
+    va_list va;
+
+    if ((kwnames != NULL && !PyTuple_Check(kwnames)) ||
+        parser == NULL)
+    {
+        PyErr_BadInternalCall();
+        return 0;
+    }
+
+    va_start(va, parser);
+    retval = vgetargskeywordsfast(args, nargs, NULL, kwnames,
+                                  parser, &va, FLAG_SIZE_T);
+    va_end(va);
+    return retval;
+}
+
 #define IS_END_OF_FORMAT(c) (c == '\0' || c == ';' || c == ':')
 
 static int
@@ -1687,6 +1790,296 @@ vgetargskeywords(PyObject *args, PyObject *keywords, const char *format,
 }
 
 
+/* Static parsers that have been used, so that their kwtuple can be
+   released by _PyArg_Fini() */
+static struct _PyArg_Parser *static_arg_parsers = NULL;
+
+/* Analyse the format of a parser on its first use.  This checks it against
+   the keywords once, instead of on each call, and finds the function name
+   or custom error message.  Return false (0) for error, else true. */
+static int
+parser_init(struct _PyArg_Parser *parser)
+{
+    const char * const *keywords;
+    const char *format, *msg;
+    int i, len, min;
+    PyObject *kwtuple;
+
+    assert(parser->format != NULL);
+    assert(parser->keywords != NULL);
+    if (parser->kwtuple != NULL)
+        return 1;
+
+    keywords = parser->keywords;
+    for (len = 0; keywords[len]; len++)
+        continue;
+
+    format = parser->format;
+    min = INT_MAX;
+    for (i = 0; i < len; i++) {
+        if (*format == '|') {
+            if (min != INT_MAX) {
+                PyErr_SetString(PyExc_RuntimeError,
+                                "Invalid format string "
+                                "(| specified twice)");
+                return 0;
+            }
+            min = i;
+            format++;
+        }
+        if (IS_END_OF_FORMAT(*format)) {
+            PyErr_Format(PyExc_RuntimeError,
+                         "More keyword list entries (%d) than "
+                         "format specifiers (%d)", len, i);
+            return 0;
+        }
+        msg = skipitem(&format, NULL, 0);
+        if (msg) {
+            PyErr_Format(PyExc_RuntimeError, "%s: '%s'", msg,
+                         format);
+            return 0;
+        }
+    }
+    if (*format == '|' && min == INT_MAX) {
+        min = len;
+        format++;
+    }
+    if (!IS_END_OF_FORMAT(*format)) {
+        PyErr_Format(PyExc_RuntimeError,
+            "more argument specifiers than keyword list entries "
+            "(remaining format:'%s')", format);
+        return 0;
+    }
+
+    parser->fname = NULL;
+    parser->custom_msg = NULL;
+    if (*format == ':')
+        parser->fname = format + 1;
+    else if (*format == ';')
+        parser->custom_msg = format + 1;
+    parser->min = (min < len) ? min : len;
+    parser->max = len;
+
+    kwtuple = PyTuple_New(len);
+    if (kwtuple == NULL)
+        return 0;
+    for (i = 0; i < len; i++) {
+        PyObject *str = PyString_InternFromString(keywords[i]);
+        if (str == NULL) {
+            Py_DECREF(kwtuple);
+            return 0;
+        }
+        PyTuple_SET_ITEM(kwtuple, i, str);
+    }
+    if (parser->kwtuple != NULL) {
+        /* another thread initialized it while a finalizer ran */
+        Py_DECREF(kwtuple);
+        return 1;
+    }
+    parser->kwtuple = kwtuple;
+
+    assert(parser->next == NULL);
+    parser->next = static_arg_parsers;
+    static_arg_parsers = parser;
+    return 1;
+}
+
+/* Return the value of the keyword key among kwnames, or NULL.  The names
+   are usually interned like the keys, so that they match by identity. */
+static PyObject *
+find_keyword(PyObject *kwnames, PyObject **kwstack, PyObject *key)
+{
+    Py_ssize_t i, nkwargs;
+
+    nkwargs = PyTuple_GET_SIZE(kwnames);
+    for (i = 0; i < nkwargs; i++) {
+        if (PyTuple_GET_ITEM(kwnames, i) == key)
+            return kwstack[i];
+    }
+    for (i = 0; i < nkwargs; i++) {
+        PyObject *kwname = PyTuple_GET_ITEM(kwnames, i);
+        int cmp;
+        if (PyString_CheckExact(kwname)) {
+            if (_PyString_Eq(kwname, key))
+                return kwstack[i];
+            continue;
+        }
+        /* like a dict lookup, which ignores errors */
+        cmp = PyObject_RichCompareBool(kwname, key, Py_EQ);
+        if (cmp > 0)
+            return kwstack[i];
+        if (cmp < 0)
+            PyErr_Clear();
+    }
+    return NULL;
+}
+
+/* Check that the name of a keyword argument matches a keyword of the
+   parser.  Return false (0) after setting TypeError, else true. */
+static int
+check_keyword(PyObject *kwtuple, PyObject *key)
+{
+    Py_ssize_t i, len;
+    char *ks;
+
+    if (!PyString_Check(key)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "keywords must be strings");
+        return 0;
+    }
+    len = PyTuple_GET_SIZE(kwtuple);
+    for (i = 0; i < len; i++) {
+        if (PyTuple_GET_ITEM(kwtuple, i) == key)
+            return 1;
+    }
+    ks = PyString_AS_STRING(key);
+    for (i = 0; i < len; i++) {
+        if (!strcmp(ks, PyString_AS_STRING(PyTuple_GET_ITEM(kwtuple, i))))
+            return 1;
+    }
+    PyErr_Format(PyExc_TypeError,
+                 "'%s' is an invalid keyword "
+                 "argument for this function",
+                 ks);
+    return 0;
+}
+
+/* vgetargskeywords() with a static parser.  The keyword arguments are
+   either in the dict keywords, or named by kwnames with their values after
+   the nargs positional arguments in args. */
+static int
+vgetargskeywordsfast(PyObject **args, Py_ssize_t nargs,
+                     PyObject *keywords, PyObject *kwnames,
+                     struct _PyArg_Parser *parser,
+                     va_list *p_va, int flags)
+{
+    char msgbuf[512];
+    int levels[32];
+    const char *format, *msg;
+    PyObject *kwtuple, *keyword;
+    int i, len;
+    Py_ssize_t nkeywords;
+    PyObject *freelist = NULL, *current_arg;
+    PyObject **kwstack = NULL;
+
+    assert(keywords == NULL || PyDict_Check(keywords));
+    assert(keywords == NULL || kwnames == NULL);
+    assert(p_va != NULL);
+
+    if (!parser_init(parser))
+        return 0;
+    kwtuple = parser->kwtuple;
+    len = parser->max;
+
+    if (keywords != NULL)
+        nkeywords = PyDict_Size(keywords);
+    else if (kwnames != NULL) {
+        nkeywords = PyTuple_GET_SIZE(kwnames);
+        kwstack = args + nargs;
+    }
+    else
+        nkeywords = 0;
+    if (nargs + nkeywords > len) {
+        PyErr_Format(PyExc_TypeError, "%s%s takes at most %d "
+                     "argument%s (%zd given)",
+                     (parser->fname == NULL) ? "function" : parser->fname,
+                     (parser->fname == NULL) ? "" : "()",
+                     len,
+                     (len == 1) ? "" : "s",
+                     nargs + nkeywords);
+        return 0;
+    }
+
+    format = parser->format;
+    for (i = 0; i < len; i++) {
+        if (*format == '|')
+            format++;
+        current_arg = NULL;
+        if (nkeywords) {
+            keyword = PyTuple_GET_ITEM(kwtuple, i);
+            if (keywords != NULL)
+                current_arg = PyDict_GetItem(keywords, keyword);
+            else
+                current_arg = find_keyword(kwnames, kwstack, keyword);
+        }
+        if (current_arg) {
+            --nkeywords;
+            if (i < nargs) {
+                /* arg present in tuple and in dict */
+                PyErr_Format(PyExc_TypeError,
+                             "Argument given by name ('%s') "
+                             "and position (%d)",
+                             parser->keywords[i], i+1);
+                return cleanreturn(0, freelist);
+            }
+        }
+        else if (i < nargs)
+            current_arg = args[i];
+
+        if (current_arg) {
+            msg = convertitem(current_arg, &format, p_va, flags,
+                levels, msgbuf, sizeof(msgbuf), &freelist);
+            if (msg) {
+                seterror(i+1, msg, levels, parser->fname,
+                         parser->custom_msg);
+                return cleanreturn(0, freelist);
+            }
+            continue;
+        }
+
+        if (i < parser->min) {
+            PyErr_Format(PyExc_TypeError, "Required argument "
+                         "'%s' (pos %d) not found",
+                         parser->keywords[i], i+1);
+            return cleanreturn(0, freelist);
+        }
+        if (!nkeywords)
+            return cleanreturn(1, freelist);
+
+        /* We are into optional args, skip thru to any remaining
+         * keyword args; parser_init() checked the format */
+        msg = skipitem(&format, p_va, flags);
+        assert(msg == NULL);
+    }
+
+    /* make sure there are no extraneous keyword arguments */
+    if (nkeywords > 0) {
+        if (keywords != NULL) {
+            PyObject *key, *value;
+            Py_ssize_t pos = 0;
+            while (PyDict_Next(keywords, &pos, &key, &value)) {
+                if (!check_keyword(kwtuple, key))
+                    return cleanreturn(0, freelist);
+            }
+        }
+        else {
+            Py_ssize_t j;
+            for (j = 0; j < PyTuple_GET_SIZE(kwnames); j++) {
+                if (!check_keyword(kwtuple, PyTuple_GET_ITEM(kwnames, j)))
+                    return cleanreturn(0, freelist);
+            }
+        }
+    }
+
+    return cleanreturn(1, freelist);
+}
+
+void
+_PyArg_Fini(void)
+{
+    struct _PyArg_Parser *parser, *next;
+
+    for (parser = static_arg_parsers; parser != NULL; parser = next) {
+        next = parser->next;
+        Py_CLEAR(parser->kwtuple);
+        parser->next = NULL;
+    }
+    static_arg_parsers = NULL;
+}
+
+
+/* Skip the format unit at *p_format, and its arguments in *p_va, or only
+   check its syntax if p_va is NULL */
 static char *
 skipitem(const char **p_format, va_list *p_va, int flags)
 {
@@ -1717,13 +2110,15 @@ skipitem(const char **p_format, va_list *p_va, int flags)
 #endif
     case 'c': /* char */
         {
-            (void) va_arg(*p_va, void *);
+            if (p_va != NULL)
+                (void) va_arg(*p_va, void *);
             break;
         }
 
     case 'n': /* Py_ssize_t */
         {
-            (void) va_arg(*p_va, Py_ssize_t *);
+            if (p_va != NULL)
+                (void) va_arg(*p_va, Py_ssize_t *);
             break;
         }
 
@@ -1731,7 +2126,8 @@ skipitem(const char **p_format, va_list *p_va, int flags)
 
     case 'e': /* string with encoding */
         {
-            (void) va_arg(*p_va, const char *);
+            if (p_va != NULL)
+                (void) va_arg(*p_va, const char *);
             if (!(*format == 's' || *format == 't'))
                 /* after 'e', only 's' and 't' is allowed */
                 goto err;
@@ -1747,14 +2143,18 @@ skipitem(const char **p_format, va_list *p_va, int flags)
     case 't': /* buffer, read-only */
     case 'w': /* buffer, read-write */
         {
-            (void) va_arg(*p_va, char **);
+            if (p_va != NULL)
+                (void) va_arg(*p_va, char **);
             if (*format == '#') {
-                if (flags & FLAG_SIZE_T)
-                    (void) va_arg(*p_va, Py_ssize_t *);
-                else
-                    (void) va_arg(*p_va, int *);
+                if (p_va != NULL) {
+                    if (flags & FLAG_SIZE_T)
+                        (void) va_arg(*p_va, Py_ssize_t *);
+                    else
+                        (void) va_arg(*p_va, int *);
+                }
                 format++;
-            } else if ((c == 's' || c == 'z') && *format == '*') {
+            } else if ((c == 's' || c == 'z' || c == 'w') &&
+                       *format == '*') {
                 format++;
             }
             break;
@@ -1767,7 +2167,8 @@ skipitem(const char **p_format, va_list *p_va, int flags)
     case 'U': /* unicode string object */
 #endif
         {
-            (void) va_arg(*p_va, PyObject **);
+            if (p_va != NULL)
+                (void) va_arg(*p_va, PyObject **);
             break;
         }
 
@@ -1775,17 +2176,22 @@ skipitem(const char **p_format, va_list *p_va, int flags)
         {
             if (*format == '!') {
                 format++;
-                (void) va_arg(*p_va, PyTypeObject*);
-                (void) va_arg(*p_va, PyObject **);
+                if (p_va != NULL) {
+                    (void) va_arg(*p_va, PyTypeObject*);
+                    (void) va_arg(*p_va, PyObject **);
+                }
             }
             else if (*format == '&') {
                 typedef int (*converter)(PyObject *, void *);
-                (void) va_arg(*p_va, converter);
-                (void) va_arg(*p_va, void *);
+                if (p_va != NULL) {
+                    (void) va_arg(*p_va, converter);
+                    (void) va_arg(*p_va, void *);
+                }
                 format++;
             }
             else {
-                (void) va_arg(*p_va, PyObject **);
+                if (p_va != NULL)
+                    (void) va_arg(*p_va, PyObject **);
             }
             break;
         }
@@ -1821,27 +2227,15 @@ err:
 }
 
 
-int
-PyArg_UnpackTuple(PyObject *args, const char *name, Py_ssize_t min, Py_ssize_t max, ...)
+static int
+unpack_stack(PyObject **args, Py_ssize_t l, const char *name,
+             Py_ssize_t min, Py_ssize_t max, va_list vargs)
 {
-    Py_ssize_t i, l;
+    Py_ssize_t i;
     PyObject **o;
-    va_list vargs;
-
-#ifdef HAVE_STDARG_PROTOTYPES
-    va_start(vargs, max);
-#else
-    va_start(vargs);
-#endif
 
     assert(min >= 0);
     assert(min <= max);
-    if (!PyTuple_Check(args)) {
-        PyErr_SetString(PyExc_SystemError,
-            "PyArg_UnpackTuple() argument list is not a tuple");
-        return 0;
-    }
-    l = PyTuple_GET_SIZE(args);
     if (l < min) {
         if (name != NULL)
             PyErr_Format(
@@ -1854,7 +2248,6 @@ PyArg_UnpackTuple(PyObject *args, const char *name, Py_ssize_t min, Py_ssize_t m
                 "unpacked tuple should have %s%zd elements,"
                 " but has %zd",
                 (min == max ? "" : "at least "), min, l);
-        va_end(vargs);
         return 0;
     }
     if (l > max) {
@@ -1869,17 +2262,56 @@ PyArg_UnpackTuple(PyObject *args, const char *name, Py_ssize_t min, Py_ssize_t m
                 "unpacked tuple should have %s%zd elements,"
                 " but has %zd",
                 (min == max ? "" : "at most "), max, l);
-        va_end(vargs);
         return 0;
     }
     for (i = 0; i < l; i++) {
         o = va_arg(vargs, PyObject **);
-        *o = PyTuple_GET_ITEM(args, i);
+        *o = args[i];
     }
-    va_end(vargs);
     return 1;
 }
 
+int
+PyArg_UnpackTuple(PyObject *args, const char *name, Py_ssize_t min, Py_ssize_t max, ...)
+{
+    int retval;
+    va_list vargs;
+
+    if (!PyTuple_Check(args)) {
+        PyErr_SetString(PyExc_SystemError,
+            "PyArg_UnpackTuple() argument list is not a tuple");
+        return 0;
+    }
+
+#ifdef HAVE_STDARG_PROTOTYPES
+    va_start(vargs, max);
+#else
+    va_start(vargs);
+#endif
+    retval = unpack_stack(&PyTuple_GET_ITEM(args, 0), PyTuple_GET_SIZE(args),
+                          name, min, max, vargs);
+    va_end(vargs);
+    return retval;
+}
+
+/* PyArg_UnpackTuple() for the argument array of a METH_FASTCALL function */
+int
+_PyArg_UnpackStack(PyObject **args, Py_ssize_t nargs, const char *name,
+                   Py_ssize_t min, Py_ssize_t max, ...)
+{
+    int retval;
+    va_list vargs;
+
+#ifdef HAVE_STDARG_PROTOTYPES
+    va_start(vargs, max);
+#else
+    va_start(vargs);
+#endif
+    retval = unpack_stack(args, nargs, name, min, max, vargs);
+    va_end(vargs);
+    return retval;
+}
+
 
 /* For type constructors that don't take keyword args
  *
@@ -1902,6 +2334,22 @@ _PyArg_NoKeywords(const char *funcname, PyObject *kw)
                     funcname);
     return 0;
 }
+
+/* The same for the kwnames of a METH_FASTCALL function */
+int
+_PyArg_NoStackKeywords(const char *funcname, PyObject *kwnames)
+{
+    if (kwnames == NULL)
+        return 1;
+    assert(PyTuple_CheckExact(kwnames));
+    if (PyTuple_GET_SIZE(kwnames) == 0)
+        return 1;
+
+    /* the wording of the METH_VARARGS builtins these replace */
+    PyErr_Format(PyExc_TypeError, "%.200s() takes no keyword arguments",
+                 funcname);
+    return 0;
+}
 #ifdef __cplusplus
 };
 #endif
@@ -77,9 +77,10 @@ typedef unsigned short mode_t;
        Python 2.7a0  62191 (introduce SETUP_WITH)
        Python 2.7a0  62201 (introduce BUILD_SET)
        Python 2.7a0  62211 (introduce MAP_ADD and SET_ADD)
+       Python 2.7.4  62221 (introduce LOAD_METHOD and CALL_METHOD)
 .
 */
-#define MAGIC (62211 | ((long)'\r'<<16) | ((long)'\n'<<24))
+#define MAGIC (62221 | ((long)'\r'<<16) | ((long)'\n'<<24))
 
 /* Magic word as global; note that _PyImport_Init() can change the
    value of this global to accommodate for alterations of how the
@@ -1407,6 +1408,8 @@ find_module(char *fullname, char *subname, PyObject *path, char *buf,
             return NULL;
 #ifdef Py_USING_UNICODE
         if (PyUnicode_Check(v)) {
+            if (PyUnicode_AS_UNICODE(v) == NULL)
+                return NULL;
             copy = PyUnicode_Encode(PyUnicode_AS_UNICODE(v),
                 PyUnicode_GET_SIZE(v), Py_FileSystemDefaultEncoding, NULL);
             if (copy == NULL)
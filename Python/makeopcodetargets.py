@@ -0,0 +1,56 @@
+#! /usr/bin/env python
+"""Generate C code for the jump table of the threaded code interpreter
+(for compilers supporting computed gotos or "labels-as-values", such as gcc).
+"""
+
+# This code should stay compatible with Python 2.3, at least while
+# some of the buildbots have Python 2.3 as their system Python.
+
+import os
+
+
+def load_opcode():
+    """Load Lib/opcode.py from the local dist/checkout, without importing
+    whatever opcode module the running interpreter happens to have.
+    """
+    path = os.path.join(
+        os.path.dirname(os.path.dirname(os.path.abspath(__file__))),
+        "Lib", "opcode.py")
+    ns = {}
+    f = open(path)
+    try:
+        exec(compile(f.read(), path, "exec"), ns)
+    finally:
+        f.close()
+    return ns
+
+def write_contents(f):
+    """Write C code contents to the target file object.
+    """
+    opcode = load_opcode()
+    targets = ['_unknown_opcode'] * 256
+    for opname, op in opcode["opmap"].items():
+        if opname == "STOP_CODE":
+            # STOP_CODE is never executed; treat it as an unknown opcode.
+            continue
+        # SLICE+1 and friends become TARGET_SLICE_1 (see TARGET_PLUS).
+        targets[op] = "TARGET_%s" % opname.replace("+", "_")
+    for opname, op in opcode["_specialized_opmap"].items():
+        targets[op] = "TARGET_%s" % opname
+    f.write("static void *opcode_targets[256] = {\n")
+    f.write(",\n".join(["    &&%s" % s for s in targets]))
+    f.write("\n};\n")
+
+
+if __name__ == "__main__":
+    import sys
+    assert len(sys.argv) < 3, "Too many arguments"
+    if len(sys.argv) == 2:
+        target = sys.argv[1]
+    else:
+        target = "Python/opcode_targets.h"
+    f = open(target, "w")
+    try:
+        write_contents(f)
+    finally:
+        f.close()
@@ -137,11 +137,16 @@ fold_binops_on_constants(unsigned char *codestr, PyObject *consts)
              */
             if (newconst != NULL &&
                 PyUnicode_Check(v) && PyUnicode_Check(newconst)) {
-                Py_UNICODE ch = PyUnicode_AS_UNICODE(newconst)[0];
+                Py_UNICODE *p = PyUnicode_AS_UNICODE(newconst);
+                if (p == NULL) {
+                    PyErr_Clear();
+                    Py_DECREF(newconst);
+                    return 0;
+                }
 #ifdef Py_UNICODE_WIDE
-                if (ch > 0xFFFF) {
+                if (p[0] > 0xFFFF) {
 #else
-                if (ch >= 0xD800 && ch <= 0xDFFF) {
+                if (p[0] >= 0xD800 && p[0] <= 0xDFFF) {
 #endif
                     Py_DECREF(newconst);
                     return 0;
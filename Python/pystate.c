@@ -2,6 +2,7 @@
 /* Thread and interpreter state structures and their interfaces */
 
 #include "Python.h"
+#include "frameobject.h"
 
 /* --------------------------------------------------------------------------
 CAUTION
@@ -172,6 +173,7 @@ new_threadstate(PyInterpreterState *interp, int init)
         tstate->tick_counter = 0;
         tstate->gilstate_counter = 0;
         tstate->async_exc = NULL;
+        tstate->frame_chunk = NULL;
 #ifdef WITH_THREAD
         tstate->thread_id = PyThread_get_thread_ident();
 #else
@@ -249,6 +251,8 @@ PyThreadState_Clear(PyThreadState *tstate)
     tstate->c_tracefunc = NULL;
     Py_CLEAR(tstate->c_profileobj);
     Py_CLEAR(tstate->c_traceobj);
+
+    _PyFrame_DetachArena(tstate);
 }
 
 
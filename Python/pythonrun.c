@@ -536,6 +536,7 @@ Py_Finalize(void)
     PyInterpreterState_Delete(interp);
 
     /* Sundry finalizers */
+    _PyArg_Fini();
     PyMethod_Fini();
     PyFrame_Fini();
     PyCFunction_Fini();
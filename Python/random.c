@@ -259,8 +259,13 @@ _PyRandom_Init(void)
     /*
       By default, hash randomization is disabled, and only
       enabled if PYTHONHASHSEED is set to non-empty or if
-      "-R" is provided at the command line:
+      "-R" is provided at the command line.  SipHash is only
+      worth its cost with a secret key, so a build using it
+      always randomizes, unless PYTHONHASHSEED is 0:
     */
+#if Py_HASH_ALGORITHM == Py_HASH_SIPHASH24
+    Py_HashRandomizationFlag = 1;
+#endif
     if (!Py_HashRandomizationFlag) {
         /* Disable the randomized hash: */
         memset(secret, 0, secret_size);
@@ -0,0 +1,117 @@
+# -*- coding: utf-8 -*-
+# This file should be kept compatible with both Python 2.6 and Python >= 3.0.
+
+"""
+Time the hashing of str, unicode and buffer objects, for lengths from two
+characters to a megabyte.  A string caches its hash, so each measurement
+hashes fresh copies of the same text.  Run the same tests with
+interpreters built with different --with-hash-algorithm options to compare
+them.
+"""
+
+import time
+import sys
+from optparse import OptionParser
+
+out = sys.stdout
+
+# Compatibility
+try:
+    xrange
+except NameError:
+    xrange = range
+try:
+    unicode
+except NameError:
+    unicode = str
+try:
+    unichr
+except NameError:
+    unichr = chr
+try:
+    buffer
+except NameError:
+    buffer = memoryview
+
+# strings of one character are shared, with their hash computed once
+SIZES = [2, 4, 8, 15, 16, 32, 64, 256, 1024, 16 * 1024, 1024 * 1024]
+
+TEXT = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
+
+
+def make_text(size):
+    return (TEXT * (size // len(TEXT) + 1))[:size]
+
+
+# Here begin the tests.  Each returns a function making a new copy of a
+# string of the given size, whose hash hasn't been computed yet.
+
+def bench_str(size):
+    """ hash(str) """
+    s = make_text(size)
+    return lambda: (s + " ")[:-1]
+
+def bench_unicode_ascii(size):
+    """ hash(unicode), ASCII characters """
+    s = unicode(make_text(size))
+    return lambda: (s + unicode(" "))[:-1]
+
+def bench_unicode_bmp(size):
+    """ hash(unicode), one character above 255 """
+    s = unicode(make_text(size - 1)) + unichr(0x20ac)
+    return lambda: (s + unicode(" "))[:-1]
+
+def bench_buffer(size):
+    """ hash(buffer) """
+    s = make_text(size).encode("ascii")
+    return lambda: buffer(s)
+
+all_tests = [bench_str, bench_unicode_ascii, bench_unicode_bmp, bench_buffer]
+
+
+def run_during(duration, make_copy):
+    _t = time.time
+    # enough copies to make the timer resolution negligible, without
+    # using more than a few megabytes
+    ncopies = max(1, min(1000, (4 << 20) // len(make_copy())))
+    n = 0
+    elapsed = 0.0
+    while elapsed < duration:
+        copies = [make_copy() for i in xrange(ncopies)]
+        start = _t()
+        for s in copies:
+            hash(s)
+        elapsed += _t() - start
+        n += ncopies
+    return n, elapsed
+
+def run_all_tests(tests, duration):
+    for test in tests:
+        out.write("\n** %s **\n\n" % test.__doc__.strip())
+        for size in SIZES:
+            out.write(("%9d chars... " % size).ljust(24))
+            out.flush()
+            n, elapsed = run_during(duration, test(size))
+            per_call = elapsed / n
+            out.write("%10.1f ns %10.1f MB/s\n"
+                      % (1e9 * per_call, size / per_call / 1e6))
+
+def main():
+    usage = "usage: %prog [-h|--help] [options] [test names]"
+    parser = OptionParser(usage=usage)
+    parser.add_option("-d", "--duration",
+                      action="store", type="float", dest="duration",
+                      default=0.5,
+                      help="seconds to spend on each size "
+                           "(default: %default)")
+    options, args = parser.parse_args()
+    names = dict((t.__name__[len("bench_"):], t) for t in all_tests)
+    for name in args:
+        if name not in names:
+            parser.error("unknown test %r (choose from %s)"
+                         % (name, ", ".join(sorted(names))))
+    tests = [names[name] for name in args] or all_tests
+    run_all_tests(tests, options.duration)
+
+if __name__ == "__main__":
+    main()
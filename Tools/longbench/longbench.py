@@ -0,0 +1,128 @@
+# -*- coding: utf-8 -*-
+# This file should be kept compatible with both Python 2.6 and Python >= 3.0.
+
+"""
+Time multiplication, division, and conversions between long integers and
+decimal strings, for numbers from a thousand digits up to several millions.
+The quadratic-time algorithms show up as a factor of 100 between two
+sizes that are 10 times apart, and Karatsuba as a factor of 38.  Run the
+same tests with two interpreters to compare them.
+"""
+
+import time
+import random
+import sys
+from optparse import OptionParser
+
+out = sys.stdout
+
+# Compatibility
+try:
+    xrange
+except NameError:
+    xrange = range
+try:
+    long
+except NameError:
+    long = int
+
+
+def get_sizes(max_digits):
+    n = 1000
+    while n <= max_digits:
+        yield n
+        yield 3 * n
+        n *= 10
+
+def make_number(ndigits):
+    rnd = random.Random(ndigits)
+    s = str(rnd.randint(1, 9)) + ''.join(
+        [str(rnd.randint(0, 9)) for i in xrange(ndigits - 1)])
+    return s
+
+
+# Here begin the tests.  Each returns a function running the operation
+# once, for numbers of the given size.
+
+def bench_mul(s):
+    """ n * m, n and m of the same size """
+    n = long(s)
+    m = long(s[::-1])
+    return lambda: n * m
+
+def bench_square(s):
+    """ n * n """
+    n = long(s)
+    return lambda: n * n
+
+def bench_str(s):
+    """ str(n) """
+    n = long(s)
+    return lambda: str(n)
+
+def bench_long(s):
+    """ long(s) """
+    return lambda: long(s)
+
+def bench_divmod(s):
+    """ divmod(n, m), n of 2x the size of m """
+    n = long(s + s)
+    m = long(s) + 12345
+    return lambda: divmod(n, m)
+
+def bench_pow(s):
+    """ pow(n, 3, m), n and m of the same size """
+    n = long(s)
+    m = long(s[::-1]) | 1
+    return lambda: pow(n, 3, m)
+
+all_tests = [bench_mul, bench_square, bench_str, bench_long, bench_divmod,
+             bench_pow]
+
+
+def run_during(duration, func):
+    _t = time.time
+    n = 0
+    start = _t()
+    while True:
+        func()
+        n += 1
+        elapsed = _t() - start
+        if elapsed > duration:
+            break
+    return n, elapsed
+
+def run_all_tests(tests, max_digits, duration):
+    for test in tests:
+        out.write("\n** %s **\n\n" % test.__doc__.strip())
+        for ndigits in get_sizes(max_digits):
+            out.write(("%9d digits... " % ndigits).ljust(24))
+            out.flush()
+            func = test(make_number(ndigits))
+            n, elapsed = run_during(duration, func)
+            out.write("%10.3f ms\n" % (1e3 * elapsed / n))
+
+def main():
+    usage = "usage: %prog [-h|--help] [options] [test names]"
+    parser = OptionParser(usage=usage)
+    parser.add_option("-m", "--max-digits",
+                      action="store", type="int", dest="max_digits",
+                      default=10 ** 6,
+                      help="largest number of decimal digits to try "
+                           "(default: %default; up to 10000000)")
+    parser.add_option("-d", "--duration",
+                      action="store", type="float", dest="duration",
+                      default=0.5,
+                      help="seconds to spend on each size "
+                           "(default: %default)")
+    options, args = parser.parse_args()
+    names = dict((t.__name__[len("bench_"):], t) for t in all_tests)
+    for name in args:
+        if name not in names:
+            parser.error("unknown test %r (choose from %s)"
+                         % (name, ", ".join(sorted(names))))
+    tests = [names[name] for name in args] or all_tests
+    run_all_tests(tests, options.max_digits, options.duration)
+
+if __name__ == "__main__":
+    main()